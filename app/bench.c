@@ -0,0 +1,1114 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*************************************************************************
+ * Includes
+ *************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bplib.h"
+#include "bplib_store_ram.h"
+#include "bplib_store_ring.h"
+#include "bplib_store_file.h"
+#include "bplib_store_flash.h"
+#include "bplib_flash_sim.h"
+#include "bplib_store_tier.h"
+
+#include "crc.h"
+#include "rb_tree.h"
+#include "cbitmap.h"
+#include "rh_hash.h"
+#include "cbuf.h"
+#include "v6.h"
+#include "sdnv.h"
+#include "lrc.h"
+
+/*************************************************************************
+ * Defines
+ *************************************************************************/
+
+#define BENCH_DEFAULT_COUNT   10000
+#define BENCH_DEFAULT_PAYLOAD 128
+#define BENCH_MAX_PAYLOAD     4000
+#define BENCH_MIN_SLOT_LENGTH 512 /* also holds the DACS records generated by the process benchmark */
+#define BENCH_SLOT_LENGTH     (bench_payload > BENCH_MIN_SLOT_LENGTH ? bench_payload : BENCH_MIN_SLOT_LENGTH)
+#define BENCH_CRC_BUFFER_SIZE 4096
+#define BENCH_SDNV_FIELDS     16
+#define BENCH_SDNV_SETS       1024
+#define BENCH_LRC_FRAME_SIZE  FLASH_SIM_PAGE_SIZE
+#define BENCH_DESTINATIONS    12
+#define BENCH_TABLE_SIZE      16384
+#define BENCH_DACS_FILLS      64
+#define BENCH_DACS_BUFFER     (sizeof(bp_val_t) * BENCH_DACS_FILLS + 6)
+
+/*************************************************************************
+ * Typedefs
+ *************************************************************************/
+
+typedef struct
+{
+    const char *name;
+    void (*init)(void);
+    void (*deinit)(void);
+    void      *parm;
+    bp_store_t store;
+} bench_store_t;
+
+/*************************************************************************
+ * File Data
+ *************************************************************************/
+
+static int         bench_count   = BENCH_DEFAULT_COUNT;
+static int         bench_payload = BENCH_DEFAULT_PAYLOAD;
+static const char *bench_filter  = NULL;
+
+static char bench_file_root[] = "/tmp/bplib_bench.XXXXXX";
+
+static bp_ram_attr_t  bench_ram_attr  = {.slab_count = 0, .slab_size = 0};
+static bp_ring_attr_t bench_ring_attr = {.slot_count = 0, .slot_size = 0};
+
+static bp_file_attr_t bench_file_attr = {.root_path = bench_file_root, .flush_on_write = true};
+static bp_file_attr_t bench_file_map_attr = {
+    .root_path = bench_file_root, .flush_on_write = true, .map_segments = true};
+static bp_file_attr_t bench_file_prefetch_attr = {
+    .root_path = bench_file_root, .flush_on_write = true, .prefetch_count = 16};
+
+static bp_flash_attr_t bench_flash_combine_attr = {.max_data_size = FLASH_SIM_PAGE_SIZE, .write_combine = true};
+
+/* Timing of a typical SLC NAND part, accounted in virtual time so the run is not slowed down */
+static bp_flash_sim_config_t bench_flash_timing = {.read_latency_us    = 25,
+                                                   .program_latency_us = 250,
+                                                   .erase_latency_us   = 2000,
+                                                   .bus_bytes_per_us   = 40,
+                                                   .virtual_time       = true};
+
+/* RAM in front of the timed flash store, written behind as soon as possible */
+static bp_tier_attr_t bench_tier_attr = {.cold        = {.create     = bplib_store_flash_create,
+                                                         .destroy    = bplib_store_flash_destroy,
+                                                         .enqueue    = bplib_store_flash_enqueue,
+                                                         .dequeue    = bplib_store_flash_dequeue,
+                                                         .retrieve   = bplib_store_flash_retrieve,
+                                                         .release    = bplib_store_flash_release,
+                                                         .relinquish = bplib_store_flash_relinquish,
+                                                         .getcount   = bplib_store_flash_getcount},
+                                         .cold_parm   = &bench_flash_combine_attr,
+                                         .hot_size    = 0,
+                                         .write_delay = 1000};
+
+static void bench_slab_init(void);
+static void bench_ring_init(void);
+static void bench_file_init(void);
+static void bench_file_deinit(void);
+static void bench_flash_init(void);
+static void bench_flash_deinit(void);
+static void bench_flash_timed_init(void);
+static void bench_flash_timed_deinit(void);
+static void bench_tier_init(void);
+static void bench_tier_deinit(void);
+
+static bench_store_t bench_stores[] = {
+    {.name   = "ram",
+     .init   = bplib_store_ram_init,
+     .deinit = NULL,
+     .store  = {.create           = bplib_store_ram_create,
+                .destroy          = bplib_store_ram_destroy,
+                .enqueue          = bplib_store_ram_enqueue,
+                .dequeue          = bplib_store_ram_dequeue,
+                .retrieve         = bplib_store_ram_retrieve,
+                .release          = bplib_store_ram_release,
+                .relinquish       = bplib_store_ram_relinquish,
+                .getcount         = bplib_store_ram_getcount,
+                .allocate         = bplib_store_ram_allocate,
+                .post             = bplib_store_ram_post,
+                .discard          = bplib_store_ram_discard,
+                .enqueue_batch    = bplib_store_ram_enqueue_batch,
+                .dequeue_batch    = bplib_store_ram_dequeue_batch,
+                .relinquish_batch = bplib_store_ram_relinquish_batch}},
+    {.name   = "ram_slab",
+     .init   = bench_slab_init,
+     .deinit = NULL,
+     .parm   = &bench_ram_attr,
+     .store  = {.create           = bplib_store_ram_create,
+                .destroy          = bplib_store_ram_destroy,
+                .enqueue          = bplib_store_ram_enqueue,
+                .dequeue          = bplib_store_ram_dequeue,
+                .retrieve         = bplib_store_ram_retrieve,
+                .release          = bplib_store_ram_release,
+                .relinquish       = bplib_store_ram_relinquish,
+                .getcount         = bplib_store_ram_getcount,
+                .allocate         = bplib_store_ram_allocate,
+                .post             = bplib_store_ram_post,
+                .discard          = bplib_store_ram_discard,
+                .enqueue_batch    = bplib_store_ram_enqueue_batch,
+                .dequeue_batch    = bplib_store_ram_dequeue_batch,
+                .relinquish_batch = bplib_store_ram_relinquish_batch}},
+    {.name   = "ring",
+     .init   = bench_ring_init,
+     .deinit = NULL,
+     .parm   = &bench_ring_attr,
+     .store  = {.create     = bplib_store_ring_create,
+                .destroy    = bplib_store_ring_destroy,
+                .enqueue    = bplib_store_ring_enqueue,
+                .dequeue    = bplib_store_ring_dequeue,
+                .retrieve   = bplib_store_ring_retrieve,
+                .release    = bplib_store_ring_release,
+                .relinquish = bplib_store_ring_relinquish,
+                .getcount   = bplib_store_ring_getcount,
+                .allocate   = bplib_store_ring_allocate,
+                .post       = bplib_store_ring_post,
+                .discard    = bplib_store_ring_discard}},
+    {.name   = "file",
+     .init   = bench_file_init,
+     .deinit = bench_file_deinit,
+     .parm   = &bench_file_attr,
+     .store  = {.create           = bplib_store_file_create,
+                .destroy          = bplib_store_file_destroy,
+                .enqueue          = bplib_store_file_enqueue,
+                .dequeue          = bplib_store_file_dequeue,
+                .retrieve         = bplib_store_file_retrieve,
+                .release          = bplib_store_file_release,
+                .relinquish       = bplib_store_file_relinquish,
+                .getcount         = bplib_store_file_getcount,
+                .relinquish_batch = bplib_store_file_relinquish_batch}},
+    {.name   = "file_mmap",
+     .init   = bench_file_init,
+     .deinit = bench_file_deinit,
+     .parm   = &bench_file_map_attr,
+     .store  = {.create           = bplib_store_file_create,
+                .destroy          = bplib_store_file_destroy,
+                .enqueue          = bplib_store_file_enqueue,
+                .dequeue          = bplib_store_file_dequeue,
+                .retrieve         = bplib_store_file_retrieve,
+                .release          = bplib_store_file_release,
+                .relinquish       = bplib_store_file_relinquish,
+                .getcount         = bplib_store_file_getcount,
+                .relinquish_batch = bplib_store_file_relinquish_batch}},
+    {.name   = "file_prefetch",
+     .init   = bench_file_init,
+     .deinit = bench_file_deinit,
+     .parm   = &bench_file_prefetch_attr,
+     .store  = {.create           = bplib_store_file_create,
+                .destroy          = bplib_store_file_destroy,
+                .enqueue          = bplib_store_file_enqueue,
+                .dequeue          = bplib_store_file_dequeue,
+                .retrieve         = bplib_store_file_retrieve,
+                .release          = bplib_store_file_release,
+                .relinquish       = bplib_store_file_relinquish,
+                .getcount         = bplib_store_file_getcount,
+                .relinquish_batch = bplib_store_file_relinquish_batch}},
+    {.name   = "flash",
+     .init   = bench_flash_init,
+     .deinit = bench_flash_deinit,
+     .store  = {.create           = bplib_store_flash_create,
+                .destroy          = bplib_store_flash_destroy,
+                .enqueue          = bplib_store_flash_enqueue,
+                .dequeue          = bplib_store_flash_dequeue,
+                .retrieve         = bplib_store_flash_retrieve,
+                .release          = bplib_store_flash_release,
+                .relinquish       = bplib_store_flash_relinquish,
+                .getcount         = bplib_store_flash_getcount,
+                .relinquish_batch = bplib_store_flash_relinquish_batch}},
+    {.name   = "flash_combine",
+     .init   = bench_flash_init,
+     .deinit = bench_flash_deinit,
+     .parm   = &bench_flash_combine_attr,
+     .store  = {.create           = bplib_store_flash_create,
+                .destroy          = bplib_store_flash_destroy,
+                .enqueue          = bplib_store_flash_enqueue,
+                .dequeue          = bplib_store_flash_dequeue,
+                .retrieve         = bplib_store_flash_retrieve,
+                .release          = bplib_store_flash_release,
+                .relinquish       = bplib_store_flash_relinquish,
+                .getcount         = bplib_store_flash_getcount,
+                .relinquish_batch = bplib_store_flash_relinquish_batch}},
+    {.name   = "flash_timed",
+     .init   = bench_flash_timed_init,
+     .deinit = bench_flash_timed_deinit,
+     .parm   = &bench_flash_combine_attr,
+     .store  = {.create           = bplib_store_flash_create,
+                .destroy          = bplib_store_flash_destroy,
+                .enqueue          = bplib_store_flash_enqueue,
+                .dequeue          = bplib_store_flash_dequeue,
+                .retrieve         = bplib_store_flash_retrieve,
+                .release          = bplib_store_flash_release,
+                .relinquish       = bplib_store_flash_relinquish,
+                .getcount         = bplib_store_flash_getcount,
+                .relinquish_batch = bplib_store_flash_relinquish_batch}},
+    {.name   = "tier",
+     .init   = bench_tier_init,
+     .deinit = bench_tier_deinit,
+     .parm   = &bench_tier_attr,
+     .store  = {.create     = bplib_store_tier_create,
+                .destroy    = bplib_store_tier_destroy,
+                .enqueue    = bplib_store_tier_enqueue,
+                .dequeue    = bplib_store_tier_dequeue,
+                .retrieve   = bplib_store_tier_retrieve,
+                .release    = bplib_store_tier_release,
+                .relinquish = bplib_store_tier_relinquish,
+                .getcount   = bplib_store_tier_getcount}},
+};
+
+static bp_flash_driver_t bench_flash_driver = {.num_blocks      = FLASH_SIM_NUM_BLOCKS,
+                                               .pages_per_block = FLASH_SIM_PAGES_PER_BLOCK,
+                                               .page_size       = FLASH_SIM_PAGE_SIZE,
+                                               .read            = bplib_flash_sim_page_read,
+                                               .write           = bplib_flash_sim_page_write,
+                                               .erase           = bplib_flash_sim_block_erase,
+                                               .isbad           = bplib_flash_sim_block_is_bad,
+                                               .phyblk          = bplib_flash_sim_physical_block};
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/*
+ * bench_now - monotonic time in nanoseconds
+ */
+static uint64_t bench_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000) + (uint64_t)now.tv_nsec;
+}
+
+/*
+ * bench_report - prints one result line; bytes is zero when throughput does not apply
+ */
+static void bench_report(const char *name, const char *variant, int ops, uint64_t nsecs, uint64_t bytes)
+{
+    char label[64];
+    snprintf(label, sizeof(label), "%s/%s", name, variant);
+
+    double ns_per_op = (double)nsecs / (double)(ops > 0 ? ops : 1);
+    double ops_per_s = nsecs ? ((double)ops * 1e9) / (double)nsecs : 0.0;
+    if (bytes)
+    {
+        double mb_per_s = nsecs ? ((double)bytes * 1e3) / (double)nsecs : 0.0;
+        printf("%-28s %10d ops %12.1f ns/op %14.0f ops/s %10.1f MB/s\n", label, ops, ns_per_op, ops_per_s, mb_per_s);
+    }
+    else
+    {
+        printf("%-28s %10d ops %12.1f ns/op %14.0f ops/s\n", label, ops, ns_per_op, ops_per_s);
+    }
+}
+
+/*
+ * bench_selected - checks benchmark name against the command line filter
+ */
+static bool bench_selected(const char *name)
+{
+    return bench_filter == NULL || strstr(name, bench_filter) != NULL;
+}
+
+/*
+ * bench_slab_init - ram store with a slab large enough for every bundle stored
+ */
+static void bench_slab_init(void)
+{
+    bench_ram_attr.slab_count = bench_count + 1;
+    bench_ram_attr.slab_size  = BP_RAM_SLAB_SIZE(BENCH_SLOT_LENGTH);
+    bplib_store_ram_init();
+}
+
+/*
+ * bench_ring_init - ring store with a slot for every bundle stored
+ */
+static void bench_ring_init(void)
+{
+    bench_ring_attr.slot_count = bench_count + 1;
+    bench_ring_attr.slot_size  = BP_RING_SLOT_SIZE(BENCH_SLOT_LENGTH);
+    bplib_store_ring_init();
+}
+
+/*
+ * bench_file_init - file store in a temporary directory
+ */
+static void bench_file_init(void)
+{
+    bplib_store_file_init(NULL);
+}
+
+/*
+ * bench_file_deinit - removes temporary directory
+ */
+static void bench_file_deinit(void)
+{
+    rmdir(bench_file_root);
+}
+
+/*
+ * bench_flash_init - flash store on top of the flash simulator
+ */
+static void bench_flash_init(void)
+{
+    bplib_flash_sim_initialize();
+    bplib_store_flash_init(bench_flash_driver, true);
+}
+
+/*
+ * bench_flash_deinit -
+ */
+static void bench_flash_deinit(void)
+{
+    bplib_store_flash_uninit();
+    bplib_flash_sim_uninitialize();
+}
+
+/*
+ * bench_flash_timed_init - flash store on top of the flash simulator with device timing
+ */
+static void bench_flash_timed_init(void)
+{
+    bplib_flash_sim_initialize();
+    bplib_flash_sim_configure(&bench_flash_timing);
+    bplib_store_flash_init(bench_flash_driver, true);
+}
+
+/*
+ * bench_flash_device - reports the device operations against the time the device was busy
+ */
+static void bench_flash_device(const char *variant)
+{
+    bp_flash_sim_stats_t stats;
+
+    bplib_flash_sim_stats(&stats, false);
+    bench_report("device", variant, (int)(stats.reads + stats.programs + stats.erases), (uint64_t)stats.busy_us * 1000,
+                 (uint64_t)(stats.reads + stats.programs) * FLASH_SIM_PAGE_SIZE);
+}
+
+/*
+ * bench_flash_timed_deinit -
+ */
+static void bench_flash_timed_deinit(void)
+{
+    bplib_store_flash_uninit();
+    bench_flash_device("flash_timed");
+    bplib_flash_sim_uninitialize();
+}
+
+/*
+ * bench_tier_init - tiered store over the timed flash store
+ */
+static void bench_tier_init(void)
+{
+    bench_flash_timed_init();
+    bplib_store_tier_init();
+}
+
+/*
+ * bench_tier_deinit - device time left is that of the objects written behind and read back
+ */
+static void bench_tier_deinit(void)
+{
+    bplib_store_flash_uninit();
+    bench_flash_device("tier");
+    bplib_flash_sim_uninitialize();
+}
+
+/*
+ * bench_open - opens a channel from node 4 to node 5 or back
+ */
+static bp_desc_t *bench_open(bench_store_t *service, bool sender, bool custody)
+{
+    bp_route_t route = {sender ? 4 : 5, 1, sender ? 5 : 4, 1, 0, 0};
+    bp_attr_t  attr;
+
+    bplib_attrinit(&attr);
+    attr.request_custody      = custody;
+    attr.timeout              = 0;
+    attr.storage_service_parm = service->parm;
+
+    return bplib_open(route, service->store, attr);
+}
+
+/*
+ * bench_store_load - stores payloads and loads the resulting bundles
+ */
+static void bench_store_load(bench_store_t *service)
+{
+    uint8_t    payload[BENCH_MAX_PAYLOAD];
+    uint32_t   flags = 0;
+    int        i, stored = 0, loaded = 0;
+    bp_desc_t *desc = bench_open(service, true, false);
+
+    if (desc == NULL)
+    {
+        printf("%-28s failed to open channel\n", service->name);
+        return;
+    }
+
+    memset(payload, 0xA5, sizeof(payload));
+
+    /* Store */
+    uint64_t start = bench_now();
+    for (i = 0; i < bench_count; i++)
+    {
+        if (bplib_store(desc, payload, bench_payload, BP_CHECK, &flags) == BP_SUCCESS)
+        {
+            stored++;
+        }
+    }
+    uint64_t stop = bench_now();
+    bench_report("store", service->name, stored, stop - start, (uint64_t)stored * bench_payload);
+
+    /* Load */
+    start = bench_now();
+    for (i = 0; i < stored; i++)
+    {
+        void  *bundle;
+        size_t size;
+        if (bplib_load(desc, &bundle, &size, BP_CHECK, &flags) == BP_SUCCESS)
+        {
+            bplib_ackbundle(desc, bundle);
+            loaded++;
+        }
+    }
+    stop = bench_now();
+    bench_report("load", service->name, loaded, stop - start, (uint64_t)loaded * bench_payload);
+
+    bplib_close(desc);
+}
+
+/*
+ * bench_process - processes and accepts pre-encoded bundles
+ */
+static void bench_process(bench_store_t *service)
+{
+    uint8_t    payload[BENCH_MAX_PAYLOAD];
+    uint32_t   flags   = 0;
+    int        i, num  = 0, processed = 0, accepted = 0;
+    uint8_t  **bundles = (uint8_t **)calloc(bench_count, sizeof(uint8_t *));
+    size_t    *sizes   = (size_t *)calloc(bench_count, sizeof(size_t));
+    bp_desc_t *tx      = bench_open(service, true, true);
+    bp_desc_t *rx      = bench_open(service, false, false);
+
+    if (bundles == NULL || sizes == NULL || tx == NULL || rx == NULL)
+    {
+        printf("%-28s failed to setup\n", service->name);
+        goto cleanup;
+    }
+
+    /* Pre-encode Bundles */
+    memset(payload, 0x5A, sizeof(payload));
+    for (i = 0; i < bench_count; i++)
+    {
+        void  *bundle;
+        size_t size;
+        if (bplib_store(tx, payload, bench_payload, BP_CHECK, &flags) != BP_SUCCESS ||
+            bplib_load(tx, &bundle, &size, BP_CHECK, &flags) != BP_SUCCESS)
+        {
+            break;
+        }
+        bundles[num] = (uint8_t *)malloc(size);
+        if (bundles[num] == NULL)
+        {
+            bplib_ackbundle(tx, bundle);
+            break;
+        }
+        memcpy(bundles[num], bundle, size);
+        sizes[num++] = size;
+        bplib_ackbundle(tx, bundle);
+        bplib_flush(tx);
+    }
+
+    /* Process */
+    uint64_t start = bench_now();
+    for (i = 0; i < num; i++)
+    {
+        if (bplib_process(rx, bundles[i], sizes[i], BP_CHECK, &flags) == BP_SUCCESS)
+        {
+            processed++;
+        }
+    }
+    uint64_t stop = bench_now();
+    bench_report("process", service->name, processed, stop - start, (uint64_t)processed * bench_payload);
+
+    /* Accept */
+    start = bench_now();
+    for (i = 0; i < processed; i++)
+    {
+        void  *data;
+        size_t size;
+        if (bplib_accept(rx, &data, &size, BP_CHECK, &flags) == BP_SUCCESS)
+        {
+            bplib_ackpayload(rx, data);
+            accepted++;
+        }
+    }
+    stop = bench_now();
+    bench_report("accept", service->name, accepted, stop - start, (uint64_t)accepted * bench_payload);
+
+cleanup:
+    if (bundles)
+    {
+        for (i = 0; i < num; i++)
+        {
+            free(bundles[i]);
+        }
+    }
+    free(bundles);
+    free(sizes);
+    if (tx)
+        bplib_close(tx);
+    if (rx)
+        bplib_close(rx);
+}
+
+/*
+ * bench_dacs - generates aggregate custody signals from the custody tree (rb_tree) or bitmap (cbitmap)
+ */
+static void bench_dacs(const char *variant, int gap, bool bitmap)
+{
+    uint8_t      rec[BENCH_DACS_BUFFER];
+    uint32_t     flags = 0;
+    rb_tree_t    tree;
+    bp_custody_t custody;
+    bp_val_t     cid  = 0;
+    int          acks = 0;
+    int          i;
+
+    if (bitmap)
+    {
+        custody.insert     = (bp_custody_insert_t)cbitmap_insert;
+        custody.is_empty   = (bp_custody_is_empty_t)cbitmap_is_empty;
+        custody.goto_first = (bp_custody_goto_first_t)cbitmap_goto_first;
+        custody.get_next   = (bp_custody_get_next_t)cbitmap_get_next;
+        if (cbitmap_create((cbitmap_t **)&custody.tree, BENCH_DACS_FILLS) != BP_SUCCESS)
+        {
+            printf("%-28s failed to create bitmap\n", variant);
+            return;
+        }
+    }
+    else
+    {
+        custody.tree       = &tree;
+        custody.insert     = (bp_custody_insert_t)rb_tree_insert;
+        custody.is_empty   = (bp_custody_is_empty_t)rb_tree_is_empty;
+        custody.goto_first = (bp_custody_goto_first_t)rb_tree_goto_first;
+        custody.get_next   = (bp_custody_get_next_t)rb_tree_get_next;
+        if (rb_tree_create(BENCH_DACS_FILLS, &tree) != BP_SUCCESS)
+        {
+            printf("%-28s failed to create tree\n", variant);
+            return;
+        }
+    }
+
+    uint64_t start = bench_now();
+    while (acks < bench_count)
+    {
+        for (i = 0; i < BENCH_DACS_FILLS / 2 && custody.insert(cid, custody.tree) == BP_SUCCESS; i++)
+        {
+            cid += gap;
+            acks++;
+        }
+        custody.goto_first(custody.tree);
+        while (!custody.is_empty(custody.tree))
+        {
+            v6_populate_acknowledgment(rec, sizeof(rec), BENCH_DACS_FILLS, &custody, &flags);
+        }
+    }
+    uint64_t stop = bench_now();
+    bench_report("dacs", variant, acks, stop - start, 0);
+
+    if (bitmap)
+    {
+        cbitmap_destroy((cbitmap_t *)custody.tree);
+    }
+    else
+    {
+        rb_tree_destroy(&tree);
+    }
+}
+
+/*
+ * bench_header - builds the headers of bundles addressed to each of a dozen destinations in turn
+ */
+static void bench_header(const char *variant, int templates)
+{
+    bp_route_t  route = {4, 1, 0, 1, 0, 0};
+    bp_bundle_t bundle;
+    bp_attr_t   attr;
+    uint32_t    flags = 0;
+    int         i;
+
+    bplib_attrinit(&attr);
+    attr.admin_record    = true;
+    attr.request_custody = false;
+    if (v6_create(&bundle, route, attr, templates) != BP_SUCCESS)
+    {
+        printf("%-28s failed to create bundle\n", variant);
+        v6_destroy(&bundle);
+        return;
+    }
+
+    uint64_t start = bench_now();
+    for (i = 0; i < bench_count; i++)
+    {
+        bundle.route.destination_node = 10 + (i % BENCH_DESTINATIONS);
+        v6_populate_bundle(&bundle, &flags);
+    }
+    uint64_t stop = bench_now();
+    bench_report("header", variant, bench_count, stop - start, 0);
+
+    v6_destroy(&bundle);
+}
+
+/*
+ * bench_route - reads the destination of a pre-encoded bundle, optionally dispatching it through a dozen rules
+ */
+static void bench_route(const char *variant, bool lookup)
+{
+    uint8_t    payload[BENCH_MAX_PAYLOAD];
+    uint8_t    encoded[BENCH_MAX_PAYLOAD + BENCH_MIN_SLOT_LENGTH];
+    size_t     encoded_size = 0;
+    uint32_t   flags        = 0;
+    int        i, found = 0;
+    bp_desc_t *desc = bench_open(&bench_stores[0], true, false);
+
+    if (desc == NULL)
+    {
+        printf("%-28s failed to open channel\n", variant);
+        return;
+    }
+
+    /* Encode Bundle */
+    void *bundle;
+    memset(payload, 0xA5, sizeof(payload));
+    if (bplib_store(desc, payload, bench_payload, BP_CHECK, &flags) != BP_SUCCESS ||
+        bplib_load(desc, &bundle, &encoded_size, BP_CHECK, &flags) != BP_SUCCESS)
+    {
+        printf("%-28s failed to encode bundle\n", variant);
+        bplib_close(desc);
+        return;
+    }
+    memcpy(encoded, bundle, encoded_size);
+    bplib_ackbundle(desc, bundle);
+
+    /* Single Node Rules Ahead of the Default Rule */
+    if (lookup)
+    {
+        for (i = 0; i < BENCH_DESTINATIONS; i++)
+        {
+            bplib_addroute(desc, 10 + i, 10 + i, 0, BP_MAX_ENCODED_VALUE);
+        }
+        bplib_addroute(desc, 0, BP_MAX_ENCODED_VALUE, 0, BP_MAX_ENCODED_VALUE);
+    }
+
+    uint64_t start = bench_now();
+    for (i = 0; i < bench_count; i++)
+    {
+        bp_route_t route;
+        if (lookup)
+        {
+            found += bplib_lookup(encoded, encoded_size) == desc;
+        }
+        else
+        {
+            found += bplib_routeinfo(encoded, encoded_size, &route) == BP_SUCCESS;
+        }
+    }
+    uint64_t stop = bench_now();
+    bench_report("route", variant, found, stop - start, 0);
+
+    bplib_close(desc);
+}
+
+/*
+ * bench_table_rh_hash - steady state add and remove of in order custody ids
+ */
+static void bench_table_rh_hash(void)
+{
+    rh_hash_t         *table;
+    bp_active_bundle_t bundle = {0, 0, 0, 0};
+    int                i;
+
+    if (rh_hash_create(&table, BENCH_TABLE_SIZE) != BP_SUCCESS)
+    {
+        return;
+    }
+
+    uint64_t start = bench_now();
+    for (i = 0; i < bench_count; i++)
+    {
+        bundle.cid = i;
+        bundle.sid = (bp_sid_t)(uintptr_t)(i + 1);
+        rh_hash_add(table, bundle, false);
+        if (i >= BENCH_TABLE_SIZE / 2)
+        {
+            rh_hash_remove(table, i - (BENCH_TABLE_SIZE / 2), NULL);
+        }
+    }
+    uint64_t stop = bench_now();
+    bench_report("table", "rh_hash", bench_count, stop - start, 0);
+
+    rh_hash_destroy(table);
+}
+
+/*
+ * bench_table_cbuf - steady state add and remove of in order custody ids
+ */
+static void bench_table_cbuf(void)
+{
+    cbuf_t            *table;
+    bp_active_bundle_t bundle = {0, 0, 0, 0};
+    int                i;
+
+    if (cbuf_create(&table, BENCH_TABLE_SIZE) != BP_SUCCESS)
+    {
+        return;
+    }
+
+    uint64_t start = bench_now();
+    for (i = 0; i < bench_count; i++)
+    {
+        bundle.cid = i;
+        bundle.sid = (bp_sid_t)(uintptr_t)(i + 1);
+        if (cbuf_available(table, bundle.cid) == BP_SUCCESS)
+        {
+            cbuf_add(table, bundle, false);
+        }
+        if (i >= BENCH_TABLE_SIZE / 2)
+        {
+            cbuf_remove(table, i - (BENCH_TABLE_SIZE / 2), NULL);
+        }
+    }
+    uint64_t stop = bench_now();
+    bench_report("table", "cbuf", bench_count, stop - start, 0);
+
+    cbuf_destroy(table);
+}
+
+/*
+ * bench_table_rh_hash_range - adds in order custody ids and removes them a DACS fill at a time
+ */
+static void bench_table_rh_hash_range(void)
+{
+    rh_hash_t         *table;
+    bp_active_bundle_t bundle = {0, 0, 0, 0};
+    int                i;
+
+    if (rh_hash_create(&table, BENCH_TABLE_SIZE) != BP_SUCCESS)
+    {
+        return;
+    }
+
+    uint64_t start = bench_now();
+    for (i = 0; i < bench_count; i++)
+    {
+        bundle.cid = i;
+        bundle.sid = (bp_sid_t)(uintptr_t)(i + 1);
+        rh_hash_add(table, bundle, false);
+        if ((i + 1) % (BENCH_TABLE_SIZE / 2) == 0)
+        {
+            rh_hash_remove_range(table, i + 1 - (BENCH_TABLE_SIZE / 2), BENCH_TABLE_SIZE / 2, NULL, NULL);
+        }
+    }
+    uint64_t stop = bench_now();
+    bench_report("table", "rh_hash_range", bench_count, stop - start, 0);
+
+    rh_hash_destroy(table);
+}
+
+/*
+ * bench_table_cbuf_range - adds in order custody ids and removes them a DACS fill at a time
+ */
+static void bench_table_cbuf_range(void)
+{
+    cbuf_t            *table;
+    bp_active_bundle_t bundle = {0, 0, 0, 0};
+    int                i;
+
+    if (cbuf_create(&table, BENCH_TABLE_SIZE) != BP_SUCCESS)
+    {
+        return;
+    }
+
+    uint64_t start = bench_now();
+    for (i = 0; i < bench_count; i++)
+    {
+        bundle.cid = i;
+        bundle.sid = (bp_sid_t)(uintptr_t)(i + 1);
+        if (cbuf_available(table, bundle.cid) == BP_SUCCESS)
+        {
+            cbuf_add(table, bundle, false);
+        }
+        if ((i + 1) % (BENCH_TABLE_SIZE / 2) == 0)
+        {
+            cbuf_remove_range(table, i + 1 - (BENCH_TABLE_SIZE / 2), BENCH_TABLE_SIZE / 2, NULL, NULL);
+        }
+    }
+    uint64_t stop = bench_now();
+    bench_report("table", "cbuf_range", bench_count, stop - start, 0);
+
+    cbuf_destroy(table);
+}
+
+/*
+ * bench_crc - computes CRCs over a fixed size buffer
+ */
+static void bench_crc(const char *variant, bplib_crc_parameters_t *params)
+{
+    static uint8_t  buffer[BENCH_CRC_BUFFER_SIZE];
+    volatile uint32_t sink = 0;
+    int             i;
+
+    for (i = 0; i < BENCH_CRC_BUFFER_SIZE; i++)
+    {
+        buffer[i] = (uint8_t)(i * 31);
+    }
+
+    uint64_t start = bench_now();
+    for (i = 0; i < bench_count; i++)
+    {
+        sink ^= bplib_crc_get(buffer, BENCH_CRC_BUFFER_SIZE, params);
+    }
+    uint64_t stop = bench_now();
+    bench_report("crc", variant, bench_count, stop - start, (uint64_t)bench_count * BENCH_CRC_BUFFER_SIZE);
+
+    (void)sink;
+}
+
+/*
+ * bench_sdnv - writes and reads back a primary block's worth of SDNV fields
+ */
+static void bench_sdnv(const char *variant, int width)
+{
+    static uint8_t    blocks[BENCH_SDNV_SETS][BENCH_SDNV_FIELDS * 10];
+    static bp_field_t fields[BENCH_SDNV_SETS][BENCH_SDNV_FIELDS];
+    volatile bp_val_t sink  = 0;
+    uint32_t          flags = 0;
+    uint32_t          seed  = 1;
+    int               i, f, s;
+
+    /* Field Values Spread Randomly over One to Five Bytes, like Node Numbers, Times, and Lengths */
+    for (s = 0; s < BENCH_SDNV_SETS; s++)
+    {
+        for (f = 0; f < BENCH_SDNV_FIELDS; f++)
+        {
+            seed               = (seed * 1103515245) + 12345;
+            fields[s][f].value = (((bp_val_t)1 << ((seed >> 16) % 32)) - 1) & (bp_val_t)seed;
+            fields[s][f].width = width;
+        }
+    }
+
+    uint64_t start = bench_now();
+    for (i = 0; i < bench_count; i++)
+    {
+        uint8_t    *block = blocks[i % BENCH_SDNV_SETS];
+        bp_field_t *set   = fields[i % BENCH_SDNV_SETS];
+        int         index = 0;
+        for (f = 0; f < BENCH_SDNV_FIELDS; f++)
+        {
+            set[f].index = index;
+            index        = sdnv_write(block, sizeof(blocks[0]), set[f], &flags);
+        }
+        for (f = 0; f < BENCH_SDNV_FIELDS; f++)
+        {
+            bp_field_t field = {0, set[f].index, width};
+            sdnv_read(block, sizeof(blocks[0]), &field, &flags);
+            sink ^= field.value;
+        }
+    }
+    uint64_t stop = bench_now();
+    bench_report("sdnv", variant, bench_count, stop - start, 0);
+
+    (void)sink;
+}
+
+/*
+ * bench_lrc - encodes or checks the software EDAC codes of a flash page
+ */
+static void bench_lrc(const char *variant, bool decode)
+{
+    static uint8_t frame[BENCH_LRC_FRAME_SIZE];
+    volatile int   sink      = 0;
+    int            data_size = lrc_init(BENCH_LRC_FRAME_SIZE);
+    int            i;
+
+    for (i = 0; i < data_size; i++)
+    {
+        frame[i] = (uint8_t)(i * 31);
+    }
+    lrc_encode(frame, data_size);
+
+    uint64_t start = bench_now();
+    for (i = 0; i < bench_count; i++)
+    {
+        if (decode)
+        {
+            sink ^= lrc_decode(frame, data_size);
+        }
+        else
+        {
+            lrc_encode(frame, data_size);
+        }
+    }
+    uint64_t stop = bench_now();
+    bench_report("lrc", variant, bench_count, stop - start, (uint64_t)bench_count * data_size);
+
+    lrc_uninit();
+    (void)sink;
+}
+
+/*
+ * print_usage -
+ */
+static void print_usage(const char *prog)
+{
+    printf("Usage: %s [-n count] [-s payload size] [benchmark filter]\n", prog);
+    printf("    benchmarks: store, load, process, accept, dacs, table, crc, sdnv, lrc\n");
+    printf("    filter matches any part of \"<benchmark>/<variant>\", e.g. \"ram\" or \"crc\"\n");
+}
+
+/******************************************************************************
+ * Main
+ ******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    int opt;
+    int s;
+
+    /* Parse Command Line */
+    while ((opt = getopt(argc, argv, "n:s:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                bench_count = atoi(optarg);
+                break;
+            case 's':
+                bench_payload = atoi(optarg);
+                break;
+            default:
+                print_usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (optind < argc)
+    {
+        bench_filter = argv[optind];
+    }
+    if (bench_count <= 0 || bench_payload <= 0 || bench_payload > BENCH_MAX_PAYLOAD)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    /* Initialize Library */
+    bplib_init();
+    if (mkdtemp(bench_file_root) == NULL)
+    {
+        printf("Failed to create directory for file store\n");
+        return 1;
+    }
+
+    printf("bplib benchmarks: count=%d, payload=%d bytes\n", bench_count, bench_payload);
+
+    /* Storage Services */
+    for (s = 0; s < (int)(sizeof(bench_stores) / sizeof(bench_stores[0])); s++)
+    {
+        bench_store_t *service = &bench_stores[s];
+        char           name[64];
+        bool           store_load, process;
+
+        snprintf(name, sizeof(name), "store/%s load/%s", service->name, service->name);
+        store_load = bench_selected(name);
+        snprintf(name, sizeof(name), "process/%s accept/%s", service->name, service->name);
+        process = bench_selected(name);
+
+        if (store_load || process)
+        {
+            service->init();
+            if (store_load)
+                bench_store_load(service);
+            if (process)
+                bench_process(service);
+            if (service->deinit)
+                service->deinit();
+        }
+    }
+
+    /* Custody Signals */
+    if (bench_selected("dacs/contiguous"))
+        bench_dacs("contiguous", 1, false);
+    if (bench_selected("dacs/gaps"))
+        bench_dacs("gaps", 2, false);
+    if (bench_selected("dacs/bitmap_contiguous"))
+        bench_dacs("bitmap_contiguous", 1, true);
+    if (bench_selected("dacs/bitmap_gaps"))
+        bench_dacs("bitmap_gaps", 2, true);
+
+    /* Bundle Headers */
+    if (bench_selected("header/rebuild"))
+        bench_header("rebuild", 0);
+    if (bench_selected("header/templates"))
+        bench_header("templates", BENCH_DESTINATIONS);
+
+    /* Routing */
+    if (bench_selected("route/peek") || bench_selected("route/lookup"))
+    {
+        bench_stores[0].init();
+        if (bench_selected("route/peek"))
+            bench_route("peek", false);
+        if (bench_selected("route/lookup"))
+            bench_route("lookup", true);
+    }
+
+    /* Active Tables */
+    if (bench_selected("table/rh_hash"))
+        bench_table_rh_hash();
+    if (bench_selected("table/cbuf"))
+        bench_table_cbuf();
+    if (bench_selected("table/rh_hash_range"))
+        bench_table_rh_hash_range();
+    if (bench_selected("table/cbuf_range"))
+        bench_table_cbuf_range();
+
+    /* CRCs */
+    if (bench_selected("crc/crc16_x25"))
+        bench_crc("crc16_x25", &BPLIB_CRC16_X25);
+    if (bench_selected("crc/crc32_castagnoli"))
+        bench_crc("crc32_castagnoli", &BPLIB_CRC32_CASTAGNOLI);
+
+    /* SDNVs */
+    if (bench_selected("sdnv/variable"))
+        bench_sdnv("variable", 0);
+    if (bench_selected("sdnv/fixed"))
+        bench_sdnv("fixed", 5);
+
+    /* Software EDAC */
+    if (bench_selected("lrc/encode"))
+        bench_lrc("encode", false);
+    if (bench_selected("lrc/decode"))
+        bench_lrc("decode", true);
+
+    bplib_deinit();
+    rmdir(bench_file_root);
+
+    return 0;
+}
@@ -39,6 +39,13 @@
 #define DFLT_DACS_IP_ADDR "127.0.0.1"
 #define DFLT_DACS_PORT    34501
 #define BPLIB_TIMEOUT     1000
+#define BUNDLE_BATCH_SIZE 64
+#define DFLT_PAYLOAD_SIZE 1024
+
+/* Payload Formats */
+#define FORMAT_TEXT    0 /* lines of text */
+#define FORMAT_CHUNKED 1 /* binary data in payloads of a fixed size */
+#define FORMAT_FRAMED  2 /* binary records each prefixed with a 4-byte network order length */
 
 /*************************************************************************
  * Typedefs
@@ -46,11 +53,15 @@
 
 typedef struct
 {
-    bp_desc_t *bpc;
-    char       data_ip_addr[PARM_STR_SIZE];
-    int        data_port;
-    char       dacs_ip_addr[PARM_STR_SIZE];
-    int        dacs_port;
+    bp_desc_t  *bpc;
+    char        data_ip_addr[PARM_STR_SIZE];
+    int         data_port;
+    char        dacs_ip_addr[PARM_STR_SIZE];
+    int         dacs_port;
+    int         offload;      /* use UDP segmentation (send) or receive (recv) offload */
+    int         format;       /* format of payloads read (send) or written (recv) */
+    int         payload_size; /* bytes per chunk, or largest record, of binary input */
+    const char *input_file;   /* binary input read from a file instead of stdin */
 } thread_parm_t;
 
 #endif /* BPIO_H */
@@ -37,6 +37,7 @@
 
 #include "sock.h"
 #include "bpio.h"
+#include "report.h"
 
 /*************************************************************************
  * File Data
@@ -47,16 +48,25 @@ static bool app_signal_abort    = false;
 static bool app_running         = true;
 
 static bp_store_t storage_service = {
-    .create     = bplib_store_ram_create,
-    .destroy    = bplib_store_ram_destroy,
-    .enqueue    = bplib_store_ram_enqueue,
-    .dequeue    = bplib_store_ram_dequeue,
-    .retrieve   = bplib_store_ram_retrieve,
-    .release    = bplib_store_ram_release,
-    .relinquish = bplib_store_ram_relinquish,
-    .getcount   = bplib_store_ram_getcount,
+    .create           = bplib_store_ram_create,
+    .destroy          = bplib_store_ram_destroy,
+    .enqueue          = bplib_store_ram_enqueue,
+    .dequeue          = bplib_store_ram_dequeue,
+    .retrieve         = bplib_store_ram_retrieve,
+    .release          = bplib_store_ram_release,
+    .relinquish       = bplib_store_ram_relinquish,
+    .getcount         = bplib_store_ram_getcount,
+    .allocate         = bplib_store_ram_allocate,
+    .post             = bplib_store_ram_post,
+    .discard          = bplib_store_ram_discard,
+    .enqueue_batch    = bplib_store_ram_enqueue_batch,
+    .dequeue_batch    = bplib_store_ram_dequeue_batch,
+    .relinquish_batch = bplib_store_ram_relinquish_batch,
 };
 
+static report_op_t process_report = {.name = "process"};
+static report_op_t accept_report  = {.name = "accept"};
+
 /******************************************************************************
  * Local Functions
  ******************************************************************************/
@@ -71,7 +81,7 @@ static void app_quick_exit(int parm)
     {
         exit(0);
     }
-    printf("\n...Shutting down!\n");
+    fprintf(stderr, "\n...Shutting down!\n");
     app_running         = false;
     app_immediate_abort = true; // multiple control-c will exit immediately
 }
@@ -109,9 +119,15 @@ static void *signal_thread(void *parm)
 /*
  * reader_thread - Reads bundles from socket and processes them
  */
+#define RECV_BUFFER_SIZE   (BUNDLE_BATCH_SIZE * BP_DEFAULT_MAX_LENGTH)
+#define RECV_MAX_DATAGRAMS ((RECV_BUFFER_SIZE / SOCK_GRO_SIZE) * SOCK_GRO_SEGMENTS)
+
 static void *reader_thread(void *parm)
 {
-    static uint8_t bundle[BP_DEFAULT_MAX_LENGTH];
+    static uint8_t buffer[RECV_BUFFER_SIZE];
+    static void   *datagrams[RECV_MAX_DATAGRAMS];
+    static int     datagram_sizes[RECV_MAX_DATAGRAMS];
+    static size_t  bundle_sizes[RECV_MAX_DATAGRAMS];
 
     thread_parm_t *info = (thread_parm_t *)parm;
 
@@ -123,24 +139,53 @@ static void *reader_thread(void *parm)
         return NULL;
     }
 
+    /* Absorb Bursts of Bundles */
+    sockbuffers(sock, SOCK_BUFFER_SIZE);
+
+    /* Enable Receive Offload */
+    int slot_size = BP_DEFAULT_MAX_LENGTH;
+    if (info->offload)
+    {
+        if (sockgro(sock) == 0)
+        {
+            slot_size = SOCK_GRO_SIZE;
+        }
+        else
+        {
+            fprintf(stderr, "UDP receive offload unavailable: %s\n", strerror(errno));
+        }
+    }
+
     /* Write Loop */
     while (app_running && sock != SOCK_INVALID)
     {
         uint32_t flags = 0;
+        int      i;
 
         /* Read Socket */
-        int bytes_recv = sockrecv(sock, bundle, BP_DEFAULT_MAX_LENGTH, SOCK_TIMEOUT);
-        if (bytes_recv > 0)
+        int count = sockrecvbatch(sock, buffer, RECV_BUFFER_SIZE, slot_size, datagrams, datagram_sizes,
+                                  RECV_MAX_DATAGRAMS, SOCK_TIMEOUT);
+        if (count > 0)
         {
-            int lib_status = bplib_process(info->bpc, bundle, bytes_recv, BP_CHECK, &flags);
-            if (lib_status != BP_SUCCESS)
+            size_t bytes = 0;
+            for (i = 0; i < count; i++)
+            {
+                bundle_sizes[i] = datagram_sizes[i];
+                bytes += bundle_sizes[i];
+            }
+
+            uint64_t start     = report_now();
+            int      processed = bplib_process_batch(info->bpc, (const void **)datagrams, bundle_sizes, count,
+                                                     BP_CHECK, &flags);
+            report_record(&process_report, start, count, bytes);
+            if (processed != count)
             {
-                fprintf(stderr, "Failed (%d) to process bundle [%08X]\n", lib_status, flags);
+                fprintf(stderr, "Failed (%d of %d) to process bundles [%08X]\n", processed, count, flags);
             }
         }
-        else if (bytes_recv != 0)
+        else if (count != 0)
         {
-            fprintf(stderr, "Failed (%d) to receive bundle over socket: %s\n", bytes_recv, strerror(errno));
+            fprintf(stderr, "Failed (%d) to receive bundles over socket: %s\n", count, strerror(errno));
         }
     }
 
@@ -167,17 +212,52 @@ static void *writer_thread(void *parm)
         size_t   payload_size = 0;
         uint32_t flags        = 0;
 
-        /* Accept Payload */
-        int lib_status = bplib_accept(info->bpc, (void **)&payload, &payload_size, BPLIB_TIMEOUT, &flags);
+        /* Accept Payload (only timed when one is ready) */
+        bool     timed      = true;
+        uint64_t start      = report_now();
+        int      lib_status = bplib_accept(info->bpc, (void **)&payload, &payload_size, BP_CHECK, &flags);
+        if (lib_status == BP_TIMEOUT)
+        {
+            timed      = false;
+            lib_status = bplib_accept(info->bpc, (void **)&payload, &payload_size, BPLIB_TIMEOUT, &flags);
+        }
+
         if (lib_status == BP_SUCCESS)
         {
-            /* Write Line */
-            fprintf(stdout, "%s", payload);
+            if (timed)
+            {
+                report_record(&accept_report, start, 1, payload_size);
+            }
+            else
+            {
+                report_count(&accept_report, 1, payload_size);
+            }
+
+            /* Write Payload */
+            if (info->format == FORMAT_TEXT)
+            {
+                fprintf(stdout, "%.*s", (int)payload_size, payload);
+            }
+            else
+            {
+                if (info->format == FORMAT_FRAMED)
+                {
+                    uint8_t prefix[4] = {(uint8_t)(payload_size >> 24), (uint8_t)(payload_size >> 16),
+                                         (uint8_t)(payload_size >> 8), (uint8_t)payload_size};
+                    fwrite(prefix, 1, sizeof(prefix), stdout);
+                }
+                fwrite(payload, 1, payload_size, stdout);
+            }
 
             /* Acknowledge PAyload */
             bplib_ackpayload(info->bpc, payload);
         }
-        else if (lib_status != BP_TIMEOUT)
+        else if (lib_status == BP_TIMEOUT)
+        {
+            /* Idle - Flush Payloads Written So Far */
+            fflush(stdout);
+        }
+        else
         {
             fprintf(stderr, "Failed (%d) to accept payload [%08X]\n", lib_status, flags);
         }
@@ -246,11 +326,14 @@ int main(int argc, char *argv[])
     int src_node = DFLT_SRC_NODE, src_serv = DFLT_SRC_SERV;
     int dacs_rate = BP_DEFAULT_DACS_RATE;
 
+    int report_secs = 0;
+
     thread_parm_t info = {.bpc          = NULL,
                           .data_ip_addr = DFLT_DATA_IP_ADDR,
                           .data_port    = DFLT_DATA_PORT,
                           .dacs_ip_addr = DFLT_DACS_IP_ADDR,
-                          .dacs_port    = DFLT_DACS_PORT};
+                          .dacs_port    = DFLT_DACS_PORT,
+                          .format       = FORMAT_TEXT};
 
     int  i;
     char parm[PARM_STR_SIZE];
@@ -275,6 +358,10 @@ int main(int argc, char *argv[])
     fprintf(stderr, "\n*********************************************************************************************");
     fprintf(stderr, "\n bprecv [options] ipn:<node>.<service> data://<ip address>:<port> dacs://<ip address>:<port> ");
     fprintf(stderr, "\n   --dacsrate <r>: sets DACS rate of BP agent to r                                           ");
+    fprintf(stderr, "\n   --gro: receives bundles using UDP receive offload                                         ");
+    fprintf(stderr, "\n   --chunked: writes payloads to stdout as raw binary data                                   ");
+    fprintf(stderr, "\n   --framed: writes payloads to stdout each prefixed with a 4-byte network order length      ");
+    fprintf(stderr, "\n   --report <s>: prints throughput and process/accept latency every s seconds                ");
     fprintf(stderr, "\n                                                                                             ");
     fprintf(stderr, "\n   Creates a local BP agent with a local endpoint ID of:                                     ");
     fprintf(stderr, "\n                                                                                             ");
@@ -300,6 +387,22 @@ int main(int argc, char *argv[])
         {
             dacs_rate = (int)strtol(argv[++i], NULL, 0);
         }
+        else if (strcmp(argv[i], "--gro") == 0)
+        {
+            info.offload = true;
+        }
+        else if (strcmp(argv[i], "--chunked") == 0)
+        {
+            info.format = FORMAT_CHUNKED;
+        }
+        else if (strcmp(argv[i], "--framed") == 0)
+        {
+            info.format = FORMAT_FRAMED;
+        }
+        else if (strcmp(argv[i], "--report") == 0)
+        {
+            report_secs = (int)strtol(argv[++i], NULL, 0);
+        }
         else if (strstr(argv[i], "ipn") != NULL)
         {
             char *serv_str = strrchr(parm, '.');
@@ -373,10 +476,34 @@ int main(int argc, char *argv[])
     pthread_t custody_pid;
     pthread_create(&custody_pid, NULL, &custody_thread, &info);
 
-    /* Idle Loop */
+    /* Idle Loop - Sends Custody Signals When Due (loaded by custody thread) and Reports Throughput */
+    report_op_t *reports[]   = {&process_report, &accept_report};
+    uint64_t     start_time  = report_now();
+    uint64_t     report_time = start_time;
     while (app_running)
     {
-        sleep(1);
+        uint64_t now = report_now();
+        if (report_secs > 0 && (now - report_time) >= ((uint64_t)report_secs * 1000000000))
+        {
+            report_interval(reports, 2, now - report_time);
+            report_time = now;
+        }
+
+        int      timeout = BP_PEND;
+        uint32_t flags   = 0;
+
+        int lib_status = bplib_tick(&timeout, &flags);
+        if (lib_status != BP_SUCCESS)
+        {
+            fprintf(stderr, "Failed (%d) to send dacs [%08X]\n", lib_status, flags);
+        }
+
+        /* Wait Until Next Deadline (but no longer than a second) */
+        if (timeout < 0 || timeout > 1000)
+        {
+            timeout = 1000;
+        }
+        usleep(timeout * 1000);
     }
 
     /* Join Threads */
@@ -392,6 +519,12 @@ int main(int argc, char *argv[])
         fprintf(stderr, "Failed (%d) to join writer thread: %s\n", write_rc, strerror(write_rc));
     }
 
+    /* Report Totals */
+    if (report_secs > 0)
+    {
+        report_summary(reports, 2, report_now() - start_time);
+    }
+
     /* Close bplib Channel */
     bplib_close(info.bpc);
 
@@ -31,12 +31,16 @@
 #include <unistd.h>
 #include <errno.h>
 #include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "bplib.h"
 #include "bplib_store_ram.h"
 
 #include "sock.h"
 #include "bpio.h"
+#include "report.h"
 
 /*************************************************************************
  * File Data
@@ -47,19 +51,30 @@ static bool app_signal_abort    = false;
 static bool app_running         = true;
 
 static bp_store_t storage_service = {
-    .create     = bplib_store_ram_create,
-    .destroy    = bplib_store_ram_destroy,
-    .enqueue    = bplib_store_ram_enqueue,
-    .dequeue    = bplib_store_ram_dequeue,
-    .retrieve   = bplib_store_ram_retrieve,
-    .release    = bplib_store_ram_release,
-    .relinquish = bplib_store_ram_relinquish,
-    .getcount   = bplib_store_ram_getcount,
+    .create           = bplib_store_ram_create,
+    .destroy          = bplib_store_ram_destroy,
+    .enqueue          = bplib_store_ram_enqueue,
+    .dequeue          = bplib_store_ram_dequeue,
+    .retrieve         = bplib_store_ram_retrieve,
+    .release          = bplib_store_ram_release,
+    .relinquish       = bplib_store_ram_relinquish,
+    .getcount         = bplib_store_ram_getcount,
+    .allocate         = bplib_store_ram_allocate,
+    .post             = bplib_store_ram_post,
+    .discard          = bplib_store_ram_discard,
+    .enqueue_batch    = bplib_store_ram_enqueue_batch,
+    .dequeue_batch    = bplib_store_ram_dequeue_batch,
+    .relinquish_batch = bplib_store_ram_relinquish_batch,
 };
 
 static int msgs = 0;
 static int acks = 0;
 
+static bool input_done = false;
+
+static report_op_t store_report = {.name = "store"};
+static report_op_t load_report  = {.name = "load"};
+
 /******************************************************************************
  * Local Functions
  ******************************************************************************/
@@ -109,6 +124,164 @@ static void *signal_thread(void *parm)
     return NULL;
 }
 
+/*
+ * binary_reader - Reads fixed size chunks or length prefixed records and stores them as bundles
+ */
+static void binary_reader(thread_parm_t *info)
+{
+    FILE    *input    = stdin;
+    uint8_t *map      = NULL;
+    size_t   map_size = 0;
+    size_t   offset   = 0;
+    uint8_t *buffer   = NULL;
+
+    /* Open Input File (memory mapped when it is a regular file) */
+    if (info->input_file)
+    {
+        struct stat st;
+        int         fd = open(info->input_file, O_RDONLY);
+        if (fd < 0)
+        {
+            fprintf(stderr, "Failed to open %s: %s\n", info->input_file, strerror(errno));
+            return;
+        }
+
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+        {
+            map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map == MAP_FAILED)
+            {
+                map = NULL;
+            }
+            else
+            {
+                map_size = st.st_size;
+                madvise(map, map_size, MADV_SEQUENTIAL);
+            }
+        }
+
+        if (map)
+        {
+            close(fd);
+        }
+        else
+        {
+            input = fdopen(fd, "rb");
+            if (input == NULL)
+            {
+                fprintf(stderr, "Failed to read %s: %s\n", info->input_file, strerror(errno));
+                close(fd);
+                return;
+            }
+        }
+    }
+
+    /* Allocate Read Buffer */
+    if (map == NULL)
+    {
+        buffer = malloc(info->payload_size);
+        if (buffer == NULL)
+        {
+            fprintf(stderr, "Failed to allocate %d byte payload buffer\n", info->payload_size);
+            if (input != stdin)
+            {
+                fclose(input);
+            }
+            return;
+        }
+    }
+
+    /* Reader Loop */
+    while (app_running)
+    {
+        const uint8_t *payload = NULL;
+        size_t         size    = info->payload_size;
+        size_t         bytes   = 0;
+
+        /* Read Record Length */
+        if (info->format == FORMAT_FRAMED)
+        {
+            uint8_t prefix[4];
+            if (map)
+            {
+                if (map_size - offset < sizeof(prefix))
+                {
+                    break;
+                }
+                memcpy(prefix, map + offset, sizeof(prefix));
+                offset += sizeof(prefix);
+            }
+            else if (fread(prefix, 1, sizeof(prefix), input) != sizeof(prefix))
+            {
+                break;
+            }
+
+            size = ((size_t)prefix[0] << 24) | ((size_t)prefix[1] << 16) | ((size_t)prefix[2] << 8) | prefix[3];
+            if (size > (size_t)info->payload_size)
+            {
+                fprintf(stderr, "Record of %zu bytes is larger than payload size of %d bytes\n", size,
+                        info->payload_size);
+                break;
+            }
+            else if (size == 0)
+            {
+                continue;
+            }
+        }
+
+        /* Read Payload */
+        if (map)
+        {
+            bytes   = size < (map_size - offset) ? size : (map_size - offset);
+            payload = map + offset;
+            offset += bytes;
+        }
+        else
+        {
+            bytes   = fread(buffer, 1, size, input);
+            payload = buffer;
+        }
+
+        if (bytes == 0)
+        {
+            break;
+        }
+        else if (bytes < size && info->format == FORMAT_FRAMED)
+        {
+            fprintf(stderr, "Truncated record of %zu bytes\n", size);
+            break;
+        }
+
+        /* Store Payload */
+        uint32_t flags      = 0;
+        uint64_t start      = report_now();
+        int      lib_status = bplib_store(info->bpc, payload, bytes, BPLIB_TIMEOUT, &flags);
+        if (lib_status == BP_SUCCESS)
+        {
+            report_record(&store_report, start, 1, bytes);
+            msgs++;
+        }
+        else
+        {
+            fprintf(stderr, "Failed (%d) to store payload [%08X]\n", lib_status, flags);
+        }
+    }
+
+    /* Close Input */
+    if (map)
+    {
+        munmap(map, map_size);
+    }
+    else if (input != stdin)
+    {
+        fclose(input);
+    }
+    free(buffer);
+
+    fprintf(stderr, "End of input after %d payloads... exiting reader thread\n", msgs);
+    input_done = true;
+}
+
 /*
  * reader_thread - Reads data from stdin and stores as bundles
  */
@@ -119,6 +292,13 @@ static void *reader_thread(void *parm)
 
     thread_parm_t *info = (thread_parm_t *)parm;
 
+    /* Binary Input */
+    if (info->format != FORMAT_TEXT)
+    {
+        binary_reader(info);
+        return NULL;
+    }
+
     /* Reader Loop */
     while (app_running)
     {
@@ -128,9 +308,11 @@ static void *reader_thread(void *parm)
         {
             uint32_t flags;
             int      payload_len = strnlen(line_buffer, LINE_STR_SIZE);
+            uint64_t start       = report_now();
             int      lib_status  = bplib_store(info->bpc, payload, payload_len, BP_CHECK, &flags);
             if (lib_status == BP_SUCCESS)
             {
+                report_record(&store_report, start, 1, payload_len);
                 msgs++;
             }
             else
@@ -164,30 +346,65 @@ static void *writer_thread(void *parm)
         return NULL;
     }
 
+    /* Absorb Bursts of Bundles */
+    sockbuffers(sock, SOCK_BUFFER_SIZE);
+
     /* Write Loop */
     while (app_running && sock != SOCK_INVALID)
     {
-        uint8_t *bundle      = NULL;
-        size_t   bundle_size = 0;
-        uint32_t flags       = 0;
+        void       *bundles[BUNDLE_BATCH_SIZE];
+        size_t      bundle_sizes[BUNDLE_BATCH_SIZE];
+        const void *bufs[BUNDLE_BATCH_SIZE];
+        int         sizes[BUNDLE_BATCH_SIZE];
+        uint32_t    flags = 0;
+        int         i;
+
+        /* Load Bundles (only timed when they are ready) */
+        bool     timed = true;
+        uint64_t start = report_now();
+        int      count = bplib_load_batch(info->bpc, bundles, bundle_sizes, BUNDLE_BATCH_SIZE, BP_CHECK, &flags);
+        if (count == BP_TIMEOUT)
+        {
+            timed = false;
+            count = bplib_load_batch(info->bpc, bundles, bundle_sizes, BUNDLE_BATCH_SIZE, BPLIB_TIMEOUT, &flags);
+        }
 
-        /* Load Bundle */
-        int lib_status = bplib_load(info->bpc, (void **)&bundle, &bundle_size, BPLIB_TIMEOUT, &flags);
-        if (lib_status == BP_SUCCESS)
+        if (count > 0)
         {
-            /* Send Bundle */
-            int bytes_sent = socksend(sock, bundle, bundle_size, SOCK_TIMEOUT);
-            if (bytes_sent != bundle_size)
+            size_t bytes = 0;
+
+            /* Send Bundles */
+            for (i = 0; i < count; i++)
+            {
+                bufs[i]  = bundles[i];
+                sizes[i] = (int)bundle_sizes[i];
+                bytes += bundle_sizes[i];
+            }
+
+            if (timed)
+            {
+                report_record(&load_report, start, count, bytes);
+            }
+            else
+            {
+                report_count(&load_report, count, bytes);
+            }
+
+            int sent = socksendbatch(sock, bufs, sizes, count, info->offload, SOCK_TIMEOUT);
+            if (sent != count)
             {
-                fprintf(stderr, "Failed (%d) to send bundle over socket: %s\n", bytes_sent, strerror(errno));
+                fprintf(stderr, "Failed (%d of %d) to send bundles over socket: %s\n", sent, count, strerror(errno));
             }
 
-            /* Acknowledge bundle */
-            bplib_ackbundle(info->bpc, bundle);
+            /* Acknowledge Bundles */
+            for (i = 0; i < count; i++)
+            {
+                bplib_ackbundle(info->bpc, bundles[i]);
+            }
         }
-        else if (lib_status != BP_TIMEOUT)
+        else if (count != BP_TIMEOUT)
         {
-            fprintf(stderr, "Failed (%d) to load bundle [%08X]\n", lib_status, flags);
+            fprintf(stderr, "Failed (%d) to load bundle [%08X]\n", count, flags);
         }
     }
 
@@ -264,11 +481,16 @@ int main(int argc, char *argv[])
     int timeout  = BP_DEFAULT_TIMEOUT;
     int lifetime = BP_DEFAULT_LIFETIME;
 
+    int report_secs = 0;
+
     thread_parm_t info = {.bpc          = NULL,
                           .data_ip_addr = DFLT_DATA_IP_ADDR,
                           .data_port    = DFLT_DATA_PORT,
                           .dacs_ip_addr = DFLT_DACS_IP_ADDR,
-                          .dacs_port    = DFLT_DACS_PORT};
+                          .dacs_port    = DFLT_DACS_PORT,
+                          .format       = FORMAT_TEXT,
+                          .payload_size = DFLT_PAYLOAD_SIZE,
+                          .input_file   = NULL};
 
     int  i;
     char parm[PARM_STR_SIZE];
@@ -305,6 +527,12 @@ int main(int argc, char *argv[])
     fprintf(stderr, "\n   --service <s>: overrides local service number of BP agent to s                            ");
     fprintf(stderr, "\n   --timeout <t>: sets timeout of BP agent to t                                              ");
     fprintf(stderr, "\n   --lifetime <l>: sets lifetime of BP agent to l                                            ");
+    fprintf(stderr, "\n   --gso: sends runs of equal sized bundles using UDP segmentation offload                   ");
+    fprintf(stderr, "\n   --chunked: bundles binary input in fixed size payloads of --size bytes                    ");
+    fprintf(stderr, "\n   --framed: bundles binary input records each prefixed with a 4-byte network order length   ");
+    fprintf(stderr, "\n   --size <n>: sets the payload size (or largest record) of binary input to n bytes          ");
+    fprintf(stderr, "\n   --file <path>: reads binary input from a (memory mapped) file instead of stdin            ");
+    fprintf(stderr, "\n   --report <s>: prints throughput and store/load latency every s seconds                    ");
     fprintf(stderr, "\n                                                                                             ");
     fprintf(stderr, "\n   Creates a local BP agent with a source endpoint ID of:                                    ");
     fprintf(stderr, "\n                                                                                             ");
@@ -337,6 +565,34 @@ int main(int argc, char *argv[])
         {
             src_serv = (int)strtol(argv[++i], NULL, 0);
         }
+        else if (strcmp(argv[i], "--gso") == 0)
+        {
+            info.offload = true;
+        }
+        else if (strcmp(argv[i], "--chunked") == 0)
+        {
+            info.format = FORMAT_CHUNKED;
+        }
+        else if (strcmp(argv[i], "--framed") == 0)
+        {
+            info.format = FORMAT_FRAMED;
+        }
+        else if (strcmp(argv[i], "--size") == 0)
+        {
+            info.payload_size = (int)strtol(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--file") == 0)
+        {
+            info.input_file = argv[++i];
+            if (info.format == FORMAT_TEXT)
+            {
+                info.format = FORMAT_CHUNKED;
+            }
+        }
+        else if (strcmp(argv[i], "--report") == 0)
+        {
+            report_secs = (int)strtol(argv[++i], NULL, 0);
+        }
         else if (strstr(argv[i], "ipn") != NULL)
         {
             char *serv_str = strrchr(parm, '.');
@@ -393,6 +649,20 @@ int main(int argc, char *argv[])
     attributes.timeout   = timeout;
     attributes.cid_reuse = true;
 
+    /* Binary Input */
+    if (info.format != FORMAT_TEXT)
+    {
+        if (info.payload_size <= 0)
+        {
+            fprintf(stderr, "Invalid payload size %d... exiting\n", info.payload_size);
+            return -1;
+        }
+        else if (info.payload_size > attributes.max_length)
+        {
+            attributes.allow_fragmentation = true;
+        }
+    }
+
     info.bpc = bplib_open(route, storage_service, attributes);
     if (info.bpc == NULL)
     {
@@ -412,11 +682,32 @@ int main(int argc, char *argv[])
     pthread_t custody_pid;
     pthread_create(&custody_pid, NULL, &custody_thread, &info);
 
-    /* Idle Loop */
+    /* Idle Loop - Reports Throughput and Exits Once All Binary Input Is Acknowledged */
+    report_op_t *reports[]   = {&store_report, &load_report};
+    uint64_t     start_time  = report_now();
+    uint64_t     report_time = start_time;
     while (app_running)
     {
         sleep(1);
+
+        uint64_t now = report_now();
+        if (report_secs > 0 && (now - report_time) >= ((uint64_t)report_secs * 1000000000))
+        {
+            report_interval(reports, 2, now - report_time);
+            report_time = now;
+        }
+
+        if (input_done)
+        {
+            bp_stats_t stats;
+            bplib_latchstats(info.bpc, &stats);
+            if (stats.stored_bundles == 0 && stats.active_bundles == 0)
+            {
+                app_running = false;
+            }
+        }
     }
+    uint64_t run_time = report_now() - start_time;
 
     /* Join Threads */
     int read_rc = pthread_join(read_pid, NULL);
@@ -431,6 +722,12 @@ int main(int argc, char *argv[])
         fprintf(stderr, "Failed (%d) to join writer thread: %s\n", write_rc, strerror(write_rc));
     }
 
+    /* Report Totals */
+    if (report_secs > 0 || info.format != FORMAT_TEXT)
+    {
+        report_summary(reports, 2, run_time);
+    }
+
     /* Close bplib Channel */
     bplib_close(info.bpc);
 
@@ -0,0 +1,175 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <time.h>
+
+#include "report.h"
+
+/******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------*
+ * report_get - reads a counter updated by another thread
+ *----------------------------------------------------------------------------*/
+static uint64_t report_get(const uint64_t *counter)
+{
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+/*----------------------------------------------------------------------------*
+ * report_percentile - estimates a call latency percentile in nanoseconds
+ *
+ *  The estimate is interpolated within the log2 bucket holding the rank, and
+ *  is never more than the longest call recorded.
+ *----------------------------------------------------------------------------*/
+static double report_percentile(const report_op_t *op, uint64_t calls, double percent)
+{
+    uint64_t max  = report_get(&op->max);
+    uint64_t rank = (uint64_t)((percent * (double)calls) / 100.0);
+    uint64_t seen = 0;
+    int      b;
+
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+
+    for (b = 0; b < REPORT_BUCKETS; b++)
+    {
+        uint64_t n = report_get(&op->buckets[b]);
+        if (n > 0 && seen + n >= rank)
+        {
+            double low      = b > 0 ? (double)(1ULL << (b - 1)) : 0.0;
+            double high     = b < (REPORT_BUCKETS - 1) ? (double)(1ULL << b) : (double)max;
+            double estimate = low + ((high - low) * (double)(rank - seen)) / (double)n;
+            return estimate < (double)max ? estimate : (double)max;
+        }
+        seen += n;
+    }
+
+    return (double)max;
+}
+
+/*----------------------------------------------------------------------------*
+ * report_line - prints the throughput over an interval and the call latencies
+ *----------------------------------------------------------------------------*/
+static void report_line(const report_op_t *op, const char *label, uint64_t items, uint64_t bytes, uint64_t nsecs)
+{
+    uint64_t calls = report_get(&op->calls);
+    double   secs  = (double)nsecs / 1e9;
+    double   rate  = secs > 0.0 ? (double)items / secs : 0.0;
+    double   mbps  = secs > 0.0 ? (double)bytes / (secs * 1e6) : 0.0;
+
+    if (calls == 0)
+    {
+        fprintf(stderr, "%-8s %-6s %12llu items %12.0f/s %9.1f MB/s\n", op->name, label, (unsigned long long)items,
+                rate, mbps);
+        return;
+    }
+
+    fprintf(stderr, "%-8s %-6s %12llu items %12.0f/s %9.1f MB/s  p50 %9.1f  p99 %9.1f  p99.9 %9.1f  max %9.1f us\n",
+            op->name, label, (unsigned long long)items, rate, mbps, report_percentile(op, calls, 50.0) / 1e3,
+            report_percentile(op, calls, 99.0) / 1e3, report_percentile(op, calls, 99.9) / 1e3,
+            (double)report_get(&op->max) / 1e3);
+}
+
+/******************************************************************************
+ * Exported Functions
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------*
+ * report_now - monotonic time in nanoseconds
+ *----------------------------------------------------------------------------*/
+uint64_t report_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000) + (uint64_t)now.tv_nsec;
+}
+
+/*----------------------------------------------------------------------------*
+ * report_record - records one call that started at start (see report_now)
+ *----------------------------------------------------------------------------*/
+void report_record(report_op_t *op, uint64_t start, int items, size_t bytes)
+{
+    uint64_t nsecs  = report_now() - start;
+    int      bucket = 0;
+
+    /* Find Log2 Bucket */
+    while (bucket < (REPORT_BUCKETS - 1) && (nsecs >> bucket) != 0)
+    {
+        bucket++;
+    }
+
+    /* Update Latency */
+    __atomic_fetch_add(&op->buckets[bucket], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&op->calls, 1, __ATOMIC_RELAXED);
+    if (nsecs > report_get(&op->max))
+    {
+        __atomic_store_n(&op->max, nsecs, __ATOMIC_RELAXED);
+    }
+
+    report_count(op, items, bytes);
+}
+
+/*----------------------------------------------------------------------------*
+ * report_count - counts items without timing the call (e.g. one that pended)
+ *----------------------------------------------------------------------------*/
+void report_count(report_op_t *op, int items, size_t bytes)
+{
+    __atomic_fetch_add(&op->items, (uint64_t)items, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&op->bytes, (uint64_t)bytes, __ATOMIC_RELAXED);
+}
+
+/*----------------------------------------------------------------------------*
+ * report_interval - prints the throughput since the previous interval report
+ *----------------------------------------------------------------------------*/
+void report_interval(report_op_t **ops, int num_ops, uint64_t nsecs)
+{
+    int i;
+    for (i = 0; i < num_ops; i++)
+    {
+        uint64_t items = report_get(&ops[i]->items);
+        uint64_t bytes = report_get(&ops[i]->bytes);
+
+        report_line(ops[i], "", items - ops[i]->last_items, bytes - ops[i]->last_bytes, nsecs);
+
+        ops[i]->last_items = items;
+        ops[i]->last_bytes = bytes;
+    }
+}
+
+/*----------------------------------------------------------------------------*
+ * report_summary - prints the throughput over the whole run
+ *----------------------------------------------------------------------------*/
+void report_summary(report_op_t **ops, int num_ops, uint64_t nsecs)
+{
+    int i;
+    for (i = 0; i < num_ops; i++)
+    {
+        report_line(ops[i], "total", report_get(&ops[i]->items), report_get(&ops[i]->bytes), nsecs);
+    }
+}
@@ -0,0 +1,65 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef REPORT_H
+#define REPORT_H
+
+/******************************************************************************
+ * Includes
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+
+/******************************************************************************
+ * Defines
+ ******************************************************************************/
+
+#define REPORT_BUCKETS 40 // log2 buckets of nanoseconds (last bucket holds everything above ~9 minutes)
+
+/******************************************************************************
+ * Typedefs
+ ******************************************************************************/
+
+/* Throughput and Latency of One Operation
+ *  updated by a single thread with report_record, read by the thread printing the report */
+typedef struct
+{
+    const char *name;
+    uint64_t    calls;                   /* calls timed */
+    uint64_t    items;
+    uint64_t    bytes;
+    uint64_t    max;                     /* longest call (nanoseconds) */
+    uint64_t    buckets[REPORT_BUCKETS]; /* bucket n counts calls shorter than 2^n nanoseconds */
+    uint64_t    last_items;              /* items at the previous interval report */
+    uint64_t    last_bytes;              /* bytes at the previous interval report */
+} report_op_t;
+
+/******************************************************************************
+ * Exported Functions
+ ******************************************************************************/
+
+uint64_t report_now(void);
+void     report_record(report_op_t *op, uint64_t start, int items, size_t bytes);
+void     report_count(report_op_t *op, int items, size_t bytes);
+void     report_interval(report_op_t **ops, int num_ops, uint64_t nsecs);
+void     report_summary(report_op_t **ops, int num_ops, uint64_t nsecs);
+
+#endif /* REPORT_H */
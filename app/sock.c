@@ -22,7 +22,12 @@
  * Includes
  *************************************************************************/
 
+#ifdef __linux__
+#define _GNU_SOURCE /* sendmmsg and recvmmsg */
+#endif
+
 #include <stdlib.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
@@ -43,6 +48,10 @@
 #include <errno.h>
 #include <poll.h>
 
+#ifdef __linux__
+#include <netinet/udp.h>
+#endif
+
 #include "sock.h"
 
 /******************************************************************************
@@ -53,6 +62,20 @@
 #define SOCK_PORT_STR_LEN 16
 #define SOCK_HOST_STR_LEN 64
 #define SOCK_SERV_STR_LEN 64
+#define SOCK_GSO_MAX_BYTES 65000 /* UDP payload limit of a segmentation offload send */
+
+/* Batched I/O */
+#ifdef __linux__
+#define SOCK_MMSG 1
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#else
+#define SOCK_MMSG 0
+#endif
 
 /* Macros */
 #if SOCK_VERBOSE
@@ -138,6 +161,31 @@ static int socknonblock(int socket_fd)
     return 0;
 }
 
+/*----------------------------------------------------------------------------*
+ * sockwait - returns the poll events raised on the socket within the timeout
+ *----------------------------------------------------------------------------*/
+static int sockwait(int fd, int events, int timeout)
+{
+    struct pollfd polllist[1];
+    polllist[0].fd      = fd;
+    polllist[0].events  = events | POLLHUP;
+    polllist[0].revents = 0;
+
+    int activity = 1;
+    do
+    {
+        activity = poll(polllist, 1, timeout);
+    }
+    while (activity == -1 && (errno == EINTR || errno == EAGAIN));
+
+    if (activity > 0)
+    {
+        return polllist[0].revents;
+    }
+
+    return 0;
+}
+
 /******************************************************************************
  * Exported Functions
  ******************************************************************************/
@@ -470,6 +518,331 @@ int sockrecv(int fd, void *buf, int size, int timeout)
     return c;
 }
 
+/*----------------------------------------------------------------------------*
+ * sockbuffers - the kernel caps the size at its configured maximum
+ *----------------------------------------------------------------------------*/
+int sockbuffers(int fd, int size)
+{
+    if (setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size)) < 0 ||
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)) < 0)
+    {
+        display_error("Failed to set socket buffer size to %d, %s\n", size, strerror(errno));
+        return SOCK_INVALID;
+    }
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*
+ * sockgro
+ *----------------------------------------------------------------------------*/
+int sockgro(int fd)
+{
+#if SOCK_MMSG
+    int optval = 1;
+    if (setsockopt(fd, SOL_UDP, UDP_GRO, &optval, sizeof(optval)) < 0)
+    {
+        display_error("Failed to set UDP_GRO option on socket, %s\n", strerror(errno));
+        return SOCK_INVALID;
+    }
+
+    return 0;
+#else
+    (void)fd;
+    return SOCK_INVALID;
+#endif
+}
+
+/*----------------------------------------------------------------------------*
+ * socksendbatch
+ *
+ *  Sends the datagrams with as few system calls as possible and returns the
+ *  number of datagrams sent.  When gso is set, runs of equal sized datagrams
+ *  (optionally ending in a shorter one) are handed to the kernel as a single
+ *  UDP segmentation offload message.
+ *----------------------------------------------------------------------------*/
+int socksendbatch(int fd, const void **bufs, const int *sizes, int count, int gso, int timeout)
+{
+    int sent = 0;
+
+    /* Check Sock */
+    if (fd == SOCK_INVALID)
+    {
+        if (timeout != SOCK_CHECK)
+        {
+            sleep(1);
+        }
+
+        return sent;
+    }
+
+#if SOCK_MMSG
+    struct mmsghdr msgs[SOCK_MAX_BATCH];
+    struct iovec   iov[SOCK_MAX_BATCH];
+    int            segments[SOCK_MAX_BATCH];
+    union
+    {
+        char           buf[CMSG_SPACE(sizeof(uint16_t))];
+        struct cmsghdr align;
+    } ctrl[SOCK_MAX_BATCH];
+
+    while (sent < count)
+    {
+        /* Build Messages */
+        int i = sent;
+        int n = 0;
+        int v = 0;
+        while (i < count && v < SOCK_MAX_BATCH)
+        {
+            int seg   = sizes[i];
+            int num   = 1;
+            int total = seg;
+
+            iov[v].iov_base = (void *)bufs[i];
+            iov[v].iov_len  = seg;
+
+            if (gso)
+            {
+                while (i + num < count && v + num < SOCK_MAX_BATCH && sizes[i + num] <= seg &&
+                       total + sizes[i + num] <= SOCK_GSO_MAX_BYTES)
+                {
+                    iov[v + num].iov_base = (void *)bufs[i + num];
+                    iov[v + num].iov_len  = sizes[i + num];
+                    total += sizes[i + num];
+                    num++;
+
+                    /* Only the last segment may be shorter */
+                    if (sizes[i + num - 1] < seg)
+                    {
+                        break;
+                    }
+                }
+            }
+
+            memset(&msgs[n], 0, sizeof(msgs[n]));
+            msgs[n].msg_hdr.msg_iov    = &iov[v];
+            msgs[n].msg_hdr.msg_iovlen = num;
+            if (num > 1)
+            {
+                struct cmsghdr *cm             = (struct cmsghdr *)ctrl[n].buf;
+                msgs[n].msg_hdr.msg_control    = ctrl[n].buf;
+                msgs[n].msg_hdr.msg_controllen = sizeof(ctrl[n].buf);
+                cm->cmsg_level                 = SOL_UDP;
+                cm->cmsg_type                  = UDP_SEGMENT;
+                cm->cmsg_len                   = CMSG_LEN(sizeof(uint16_t));
+                *(uint16_t *)CMSG_DATA(cm)     = (uint16_t)seg;
+            }
+
+            segments[n++] = num;
+            i += num;
+            v += num;
+        }
+
+        /* Send Messages */
+        int c = sendmmsg(fd, msgs, n, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (c > 0)
+        {
+            int m;
+            for (m = 0; m < c; m++)
+            {
+                sent += segments[m];
+            }
+        }
+        else if (c < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (c < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS))
+        {
+            int revents = sockwait(fd, POLLOUT, timeout);
+            if (revents & POLLHUP)
+            {
+                return sent > 0 ? sent : SOCK_INVALID;
+            }
+            else if (!(revents & POLLOUT))
+            {
+                break; // timeout
+            }
+        }
+        else if (c < 0 && gso && (errno == EINVAL || errno == EIO))
+        {
+            /* Segmentation offload not supported for this path */
+            display_error("Failed to send with UDP segmentation offload, %s\n", strerror(errno));
+            gso = 0;
+        }
+        else
+        {
+            display_error("Failed (%d) to send batch to socket: %s\n", c, strerror(errno));
+            return sent > 0 ? sent : SOCK_INVALID;
+        }
+    }
+#else
+    (void)gso;
+    while (sent < count)
+    {
+        int c = socksend(fd, bufs[sent], sizes[sent], timeout);
+        if (c == SOCK_INVALID)
+        {
+            return sent > 0 ? sent : SOCK_INVALID;
+        }
+        else if (c == 0)
+        {
+            break; // timeout
+        }
+
+        sent++;
+    }
+#endif
+
+    /* Return Results */
+    return sent;
+}
+
+/*----------------------------------------------------------------------------*
+ * sockrecvbatch
+ *
+ *  Receives as many datagrams as are ready (waiting up to the timeout for the
+ *  first) into slots of slot_size bytes carved out of buf, and returns the
+ *  number of datagrams.  Datagrams coalesced by UDP GRO (see sockgro) are
+ *  split back apart, so with GRO enabled slot_size should be SOCK_GRO_SIZE and
+ *  max should allow for SOCK_GRO_SEGMENTS datagrams per slot; segments that
+ *  do not fit in max are dropped.
+ *----------------------------------------------------------------------------*/
+int sockrecvbatch(int fd, void *buf, int size, int slot_size, void **datagrams, int *sizes, int max, int timeout)
+{
+    int slots = size / slot_size;
+    int count = 0;
+
+    if (slots > max)
+    {
+        slots = max;
+    }
+    if (slots > SOCK_MAX_BATCH)
+    {
+        slots = SOCK_MAX_BATCH;
+    }
+    if (slots <= 0)
+    {
+        return count;
+    }
+
+#if SOCK_MMSG
+    struct mmsghdr msgs[SOCK_MAX_BATCH];
+    struct iovec   iov[SOCK_MAX_BATCH];
+    union
+    {
+        char           buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } ctrl[SOCK_MAX_BATCH];
+
+    /* Build Messages */
+    int i;
+    for (i = 0; i < slots; i++)
+    {
+        memset(&msgs[i], 0, sizeof(msgs[i]));
+        iov[i].iov_base                = (uint8_t *)buf + (i * slot_size);
+        iov[i].iov_len                 = slot_size;
+        msgs[i].msg_hdr.msg_iov        = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen     = 1;
+        msgs[i].msg_hdr.msg_control    = ctrl[i].buf;
+        msgs[i].msg_hdr.msg_controllen = sizeof(ctrl[i].buf);
+    }
+
+    /* Perform Receive */
+    int c;
+    do
+    {
+        c = recvmmsg(fd, msgs, slots, MSG_DONTWAIT, NULL);
+        if (c < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            int revents = sockwait(fd, POLLIN, timeout);
+            if (revents & POLLIN)
+            {
+                c = recvmmsg(fd, msgs, slots, MSG_DONTWAIT, NULL);
+            }
+            else if (revents & POLLHUP)
+            {
+                return SOCK_INVALID;
+            }
+            else
+            {
+                return count; // timeout
+            }
+        }
+    }
+    while (c < 0 && errno == EINTR);
+
+    if (c < 0)
+    {
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            return count;
+        }
+
+        display_error("Failed (%d) to receive batch from socket: %s\n", c, strerror(errno));
+        return SOCK_INVALID;
+    }
+
+    /* Split Coalesced Datagrams */
+    int m;
+    for (m = 0; m < c; m++)
+    {
+        uint8_t *data = iov[m].iov_base;
+        int      len  = msgs[m].msg_len;
+        int      seg  = len;
+        int      offset;
+
+        struct cmsghdr *cm;
+        for (cm = CMSG_FIRSTHDR(&msgs[m].msg_hdr); cm != NULL; cm = CMSG_NXTHDR(&msgs[m].msg_hdr, cm))
+        {
+            if (cm->cmsg_level == SOL_UDP && cm->cmsg_type == UDP_GRO)
+            {
+                memcpy(&seg, CMSG_DATA(cm), sizeof(seg));
+            }
+        }
+
+        if (seg <= 0)
+        {
+            continue; // empty datagram
+        }
+
+        for (offset = 0; offset < len; offset += seg)
+        {
+            if (count >= max)
+            {
+                display_error("Dropped %d bytes of coalesced datagrams\n", len - offset);
+                break;
+            }
+
+            datagrams[count] = data + offset;
+            sizes[count]     = (len - offset) < seg ? (len - offset) : seg;
+            count++;
+        }
+    }
+#else
+    while (count < slots)
+    {
+        uint8_t *data = (uint8_t *)buf + (count * slot_size);
+        int      c    = sockrecv(fd, data, slot_size, count == 0 ? timeout : SOCK_CHECK);
+        if (c == SOCK_INVALID)
+        {
+            return count > 0 ? count : SOCK_INVALID;
+        }
+        else if (c == 0)
+        {
+            break;
+        }
+
+        datagrams[count] = data;
+        sizes[count]     = c;
+        count++;
+    }
+#endif
+
+    /* Return Results */
+    return count;
+}
+
 /*----------------------------------------------------------------------------*
  * sockclose
  *----------------------------------------------------------------------------*/
@@ -30,6 +30,11 @@
 #define SOCK_TIMEOUT 1000 // milliseconds
 #define SOCK_INVALID (-1)
 
+#define SOCK_MAX_BATCH    64      // datagrams per batched system call
+#define SOCK_BUFFER_SIZE  4194304 // socket buffer that absorbs bursts of batched datagrams
+#define SOCK_GRO_SIZE     65536   // receive slot size needed for UDP GRO
+#define SOCK_GRO_SEGMENTS 64      // maximum datagrams coalesced by UDP GRO
+
 /******************************************************************************
  * Exported Functions
  ******************************************************************************/
@@ -39,6 +44,10 @@ int  sockstream(const char *ip_addr, int port, int is_server, int *block);
 int  sockdatagram(const char *ip_addr, int port, int is_server, int *block);
 int  socksend(int fd, const void *buf, int size, int timeout);
 int  sockrecv(int fd, void *buf, int size, int timeout);
+int  sockbuffers(int fd, int size);
+int  sockgro(int fd);
+int  socksendbatch(int fd, const void **bufs, const int *sizes, int count, int gso, int timeout);
+int  sockrecvbatch(int fd, void *buf, int size, int slot_size, void **datagrams, int *sizes, int max, int timeout);
 void sockclose(int fd);
 
 #endif /* SOCK_H */
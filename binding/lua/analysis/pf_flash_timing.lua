@@ -0,0 +1,87 @@
+local bplib = require("bplib")
+local runner = require("bptest")
+local src = runner.srcscript()
+
+-- Parameters --
+
+local num_bundles        = tonumber(arg[1]) or 2000 -- bundles per run
+local payload_size       = tonumber(arg[2]) or 1000 -- bytes
+local read_latency       = tonumber(arg[3]) or 25 -- microseconds (datasheet tR)
+local erase_latency      = tonumber(arg[4]) or 2000 -- microseconds (datasheet tBERS)
+local bus_bandwidth      = tonumber(arg[5]) or 40 -- bytes per microsecond
+local bit_error_interval = tonumber(arg[6]) or 0 -- page reads per injected bit error
+local perf_filename      = arg[7] or 'flash_timing.csv'
+
+-- program latencies swept, in microseconds (datasheet tPROG) --
+local program_latencies = {100, 200, 300, 400, 600, 800}
+
+-- Write Meta File --
+
+local meta = io.open(perf_filename .. '.meta', 'w')
+meta:write('Bundles: ' .. num_bundles .. '\n')
+meta:write('Payload Size: ' .. payload_size .. '\n')
+meta:write('Read Latency: ' .. read_latency .. '\n')
+meta:write('Erase Latency: ' .. erase_latency .. '\n')
+meta:write('Bus Bandwidth: ' .. bus_bandwidth .. '\n')
+meta:write('Bit Error Interval: ' .. bit_error_interval .. '\n')
+
+-- Start Performance File --
+
+local perf = io.open(perf_filename, 'w')
+perf:write('program_us,busy_us,reads,programs,erases,bit_errors,store_rate,load_rate\n')
+
+-- Create Sender --
+
+bplib.flashsim("INIT")
+local sender = bplib.open(4, 3, 72, 43, "FLASH", {timeout=0})
+local payload = string.rep('X', payload_size)
+
+-- Sweep Program Latency --
+
+for _,program_latency in ipairs(program_latencies) do
+
+    print(string.format('FLASH/%s: program latency of %d us', src, program_latency))
+
+    -- configure device in virtual time --
+    bplib.flashsim("CONFIG", {read_latency_us=read_latency, program_latency_us=program_latency,
+                              erase_latency_us=erase_latency, bus_bytes_per_us=bus_bandwidth,
+                              bit_error_interval=bit_error_interval, virtual_time=true})
+
+    -- store bundles --
+    for i=1,num_bundles do
+        rc, flags = sender:store(payload, 0)
+        runner.check(rc)
+    end
+    local store_stats = bplib.flashsim("SIM", true)
+
+    -- load bundles --
+    for i=1,num_bundles do
+        rc, bundle, flags = sender:load(0)
+        runner.check(rc)
+    end
+    local load_stats = bplib.flashsim("SIM", true)
+
+    -- device bound bundle rates --
+    local store_rate = num_bundles * 1000000 / math.max(store_stats["busy_us"], 1)
+    local load_rate = num_bundles * 1000000 / math.max(load_stats["busy_us"], 1)
+    perf:write(string.format('%d,%d,%d,%d,%d,%d,%.1f,%.1f\n', program_latency,
+                             store_stats["busy_us"] + load_stats["busy_us"],
+                             store_stats["reads"] + load_stats["reads"],
+                             store_stats["programs"] + load_stats["programs"],
+                             store_stats["erases"] + load_stats["erases"],
+                             store_stats["bit_errors"] + load_stats["bit_errors"],
+                             store_rate, load_rate))
+    perf:flush()
+end
+
+-- Clean Up --
+
+sender:close()
+bplib.flashsim("DEINIT")
+
+meta:close()
+perf:close()
+
+-- Report Results --
+
+runner.report()
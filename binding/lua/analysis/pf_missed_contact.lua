@@ -59,33 +59,33 @@ perf:write('time,bidir,new,retran,ack,bundles,bid\n')
 
 bundle_id = 0
 
+-- bundles and payloads are moved a buffer at a time so the binding does not make a Lua string of each --
+local orbit = bplib.buffer(bundles_per_orbit)
+local bundles = bplib.buffer(bundle_tx_rate)
+local payloads = bplib.buffer(bundle_tx_rate)
+
 local function simulate_back_orbit() 
+	orbit:clear()
 	for i=1,bundles_per_orbit do
-		payload = string.format('%d', bundle_id)
-		rc, flags = sender:store(payload, 0)
+		orbit:add(string.format('%d', bundle_id))
 		bundle_id = bundle_id + 1
 	end
+	rc, count, flags = sender:store_batch(orbit, 0)
 end
 
 local function simulate_contact(bidirectional)
-	now = os.time()
+	now = bplib.time()
 	for i=1,contact_time do
         smallest_bundle_id = bundle_id
-		for j=1,bundle_tx_rate do
-			rc, bundle, flags = sender:load(0)
-			if bundle then
-				if bidirectional then
-					rc, flags = receiver:process(bundle, 0)
-					rc, payload, flags = receiver:accept(0)
-				else
-					rc, flags = bitbucket:process(bundle, 0)
-					rc, payload, flags = bitbucket:accept(0)
-				end
-				if payload then
-					payload_bundle_id = tonumber(payload)
-					if payload_bundle_id < smallest_bundle_id then 
-						smallest_bundle_id = payload_bundle_id
-					end
+		rc, count, flags = sender:load_batch(bundles, 0)
+		if count > 0 then
+			local node = bidirectional and receiver or bitbucket
+			rc, count, flags = node:process_batch(bundles, 0)
+			rc, count, flags = node:accept_batch(payloads, 0)
+			for j=1,count do
+				payload_bundle_id = tonumber(payloads:get(j))
+				if payload_bundle_id < smallest_bundle_id then 
+					smallest_bundle_id = payload_bundle_id
 				end
 			end
 		end
@@ -103,13 +103,13 @@ local function simulate_contact(bidirectional)
 
 		-- collect stats --
 		rc, stats = sender:stats()
-		perf:write(string.format('%d,%d,%d,%d,%d,%d,%d\n', os.time() - start, bidirectional and 1 or 0, stats["transmitted_bundles"], stats["retransmitted_bundles"], stats["acknowledged_bundles"], stats["stored_bundles"], smallest_bundle_id))
+		perf:write(string.format('%d,%d,%d,%d,%d,%d,%d\n', math.floor(bplib.time() - start), bidirectional and 1 or 0, stats["transmitted_bundles"], stats["retransmitted_bundles"], stats["acknowledged_bundles"], stats["stored_bundles"], smallest_bundle_id))
 		perf:flush()
 
 		-- synchronize time to 1 execution per second --
-		time_adjust = (now + i) - os.time()
+		time_adjust = (now + i) - bplib.time()
 		if time_adjust > 0 then bplib.sleep(time_adjust)
-	 	elseif time_adjust < 0 then print(string.format('Simulation slower than real-time by %d seconds', time_adjust)) end
+	 	elseif time_adjust <= -1 then print(string.format('Simulation slower than real-time by %d seconds', math.floor(-time_adjust))) end
 	end
 end
 
@@ -118,7 +118,7 @@ end
 -----------------------------------------------------------------------
 print(string.format('%s/%s: Step 1 - store first orbit of bundles (orbit 1)', store, src))
 simulate_back_orbit()
-start = os.time()
+start = bplib.time()
 
 -----------------------------------------------------------------------
 print(string.format('%s/%s: Step 2 - send bundles with no acknowledgments (missed contact 1)', store, src))
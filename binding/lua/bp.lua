@@ -2,7 +2,8 @@ local all_flags = {   "noncompliant", "incomplete", "unreliabletime", "dropped",
                       "failedintegritycheck", "bundletoolarge", "routeneeded", "storefailure",
                       "sdnvoverflow", "sdnincomplete", "activetablewrap",
                       "duplicates", "custodyfull", "unknownrec", "invalidciphersuite",
-                      "invalidbibresulttype", "invalidbibtargettype", "failedtoparse"  }
+                      "invalidbibresulttype", "invalidbibtargettype", "failedtoparse",
+                      "noroute"  }
 
 --------------------------------------------------------------------------------------
 -- check_flags  -
@@ -126,7 +127,15 @@ local package = {
     BIB_CRC16_X25 = 1,
     BIB_CRC32_CASTAGNOLI = 2,
     RETX_OLDEST_BUNDLE = 0,
-    RETX_SMALLEST_CID = 1
+    RETX_SMALLEST_CID = 1,
+    CUSTODY_RANGES = 0,
+    CUSTODY_BITMAP = 1,
+    COS_BULK = 0,
+    COS_NORMAL = 1,
+    COS_EXPEDITED = 2,
+    SCHEDULE_FIFO = 0,
+    SCHEDULE_STRICT = 1,
+    SCHEDULE_WEIGHTED = 2
 }
 
 return package
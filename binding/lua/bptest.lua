@@ -170,7 +170,7 @@ local function setup(bplib, store)
     if store == "FILE" then
         os.execute("rm -Rf .pfile")
         os.execute("mkdir -p .pfile")
-    elseif store == "FLASH" then
+    elseif store == "FLASH" or store == "TIER" then
         bplib.flashsim("INIT")
     end
 end
@@ -183,7 +183,7 @@ Function:   cleanup
 local function cleanup(bplib, store, full)
     if store == "FILE" then
         os.execute("rm -Rf .pfile")
-    elseif store == "FLASH" then
+    elseif store == "FLASH" or store == "TIER" then
         bplib.flashsim("DEINIT")
     end
     bplib.shutdown(full); 
@@ -25,25 +25,24 @@
 #include "lua_bplib.h"
 
 #include "bplib.h"
+#include "bplib_os.h"
+#include "bplib_lz.h"
 #include "bplib_store_ram.h"
+#include "bplib_store_ring.h"
 #include "bplib_store_file.h"
 #include "bplib_store_flash.h"
 #include "bplib_flash_sim.h"
+#include "bplib_store_tier.h"
 
 #include "unittest.h"
 
-#ifdef _WINDOWS_
-#include <windows.h>
-#else
-#include <time.h>
-#endif
-
 #include <lua.h>
 #include <lauxlib.h>
 #include <lualib.h>
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdarg.h>
 #include <stddef.h>
 #include <errno.h>
@@ -56,6 +55,7 @@
 
 #define lualog(m, ...)       log_message(__FILE__, __LINE__, m, ##__VA_ARGS__)
 #define LBPLIB_MAX_LOG_ENTRY 128
+#define LBPLIB_BUFFER_BYTES  256 /* bytes allocated per entry of a new buffer, before it grows */
 
 /******************************************************************************
  TYPEDEFS
@@ -66,6 +66,19 @@ typedef struct
     bp_desc_t *desc;
 } lbplib_user_data_t;
 
+/* Reusable Buffer of Bundles or Payloads (moved by the batch functions without a Lua string each) */
+typedef struct
+{
+    int          max_entries; /* objects the buffer can hold */
+    int          count;       /* objects held */
+    size_t       capacity;    /* bytes allocated for data, grows as needed */
+    size_t       used;        /* bytes of data holding objects */
+    size_t      *offsets;     /* of each object into data */
+    size_t      *sizes;       /* of each object */
+    const void **pointers;    /* to each object, for bplib_process_batch */
+    uint8_t     *data;
+} lbplib_buffer_t;
+
 typedef struct
 {
     const char *name;
@@ -73,6 +86,7 @@ typedef struct
     void (*initfunc)(void);
     void (*deinitfunc)(void);
     bp_store_t store;
+    void      *parm;
 } lbplib_store_t;
 
 /******************************************************************************
@@ -82,14 +96,18 @@ typedef struct
 /* Bundle Protocol Library */
 int lbplib_open(lua_State *L);
 int lbplib_route(lua_State *L);
+int lbplib_dispatch(lua_State *L);
 int lbplib_display(lua_State *L);
 int lbplib_eid2ipn(lua_State *L);
 int lbplib_ipn2eid(lua_State *L);
 int lbplib_unittest(lua_State *L);
 int lbplib_sleep(lua_State *L);
+int lbplib_time(lua_State *L);
 int lbplib_flashsim(lua_State *L);
 int lbplib_memstat(lua_State *L);
 int lbplib_shutdown(lua_State *L);
+int lbplib_tick(lua_State *L);
+int lbplib_buffer(lua_State *L);
 
 /* Bundle Protocol Meta Functions */
 int lbplib_delete(lua_State *L);
@@ -97,36 +115,59 @@ int lbplib_getopt(lua_State *L);
 int lbplib_setopt(lua_State *L);
 int lbplib_stats(lua_State *L);
 int lbplib_store(lua_State *L);
+int lbplib_stream_open(lua_State *L);
+int lbplib_stream_write(lua_State *L);
+int lbplib_stream_close(lua_State *L);
 int lbplib_load(lua_State *L);
 int lbplib_process(lua_State *L);
+int lbplib_addroute(lua_State *L);
+int lbplib_delroute(lua_State *L);
 int lbplib_accept(lua_State *L);
 int lbplib_flush(lua_State *L);
+int lbplib_store_batch(lua_State *L);
+int lbplib_load_batch(lua_State *L);
+int lbplib_process_batch(lua_State *L);
+int lbplib_accept_batch(lua_State *L);
+
+/* Buffer Meta Functions */
+int lbplib_buffer_delete(lua_State *L);
+int lbplib_buffer_add(lua_State *L);
+int lbplib_buffer_get(lua_State *L);
+int lbplib_buffer_count(lua_State *L);
+int lbplib_buffer_clear(lua_State *L);
 
 /* Storage Service Initialization Functions */
 static void local_store_ram_init(void);
+static void local_store_ring_init(void);
 static void local_store_file_init(void);
 static void local_store_flash_init(void);
 static void local_store_flash_deinit(void);
+static void local_store_tier_init(void);
 
 /******************************************************************************
  FILE DATA
  ******************************************************************************/
 
 /* Lua Environment Variables */
-static const char *LUA_BPLIBMETANAME = "Lua.bplib";
-static const char *LUA_ERRNO         = "errno";
+static const char *LUA_BPLIBMETANAME  = "Lua.bplib";
+static const char *LUA_BUFFERMETANAME = "Lua.bplib.buffer";
+static const char *LUA_ERRNO          = "errno";
 
 /* Lua Bplib Library Functions */
 static const struct luaL_Reg lbplib_functions[] = {{"open", lbplib_open},
                                                    {"route", lbplib_route},
+                                                   {"dispatch", lbplib_dispatch},
                                                    {"display", lbplib_display},
                                                    {"eid2ipn", lbplib_eid2ipn},
                                                    {"ipn2eid", lbplib_ipn2eid},
                                                    {"unittest", lbplib_unittest},
                                                    {"sleep", lbplib_sleep},
+                                                   {"time", lbplib_time},
                                                    {"flashsim", lbplib_flashsim},
                                                    {"memstat", lbplib_memstat},
                                                    {"shutdown", lbplib_shutdown},
+                                                   {"tick", lbplib_tick},
+                                                   {"buffer", lbplib_buffer},
                                                    {NULL, NULL}};
 
 /* Lua Bplib Channel Meta Data */
@@ -134,14 +175,52 @@ static const struct luaL_Reg lbplib_metadata[] = {{"getopt", lbplib_getopt},
                                                   {"setopt", lbplib_setopt},
                                                   {"stats", lbplib_stats},
                                                   {"store", lbplib_store},
+                                                  {"stream_open", lbplib_stream_open},
+                                                  {"stream_write", lbplib_stream_write},
+                                                  {"stream_close", lbplib_stream_close},
                                                   {"load", lbplib_load},
                                                   {"process", lbplib_process},
+                                                  {"addroute", lbplib_addroute},
+                                                  {"delroute", lbplib_delroute},
                                                   {"accept", lbplib_accept},
                                                   {"flush", lbplib_flush},
+                                                  {"store_batch", lbplib_store_batch},
+                                                  {"load_batch", lbplib_load_batch},
+                                                  {"process_batch", lbplib_process_batch},
+                                                  {"accept_batch", lbplib_accept_batch},
                                                   {"close", lbplib_delete},
                                                   {"__gc", lbplib_delete},
                                                   {NULL, NULL}};
 
+/* Lua Bplib Buffer Meta Data */
+static const struct luaL_Reg lbplib_buffer_metadata[] = {{"add", lbplib_buffer_add},
+                                                         {"get", lbplib_buffer_get},
+                                                         {"count", lbplib_buffer_count},
+                                                         {"clear", lbplib_buffer_clear},
+                                                         {"__len", lbplib_buffer_count},
+                                                         {"__gc", lbplib_buffer_delete},
+                                                         {NULL, NULL}};
+
+/* Lua Bplib Tiered Storage (RAM over flash) */
+static bp_tier_attr_t lbplib_tier_attr = {.cold =
+                                              {
+                                                  .create     = bplib_store_flash_create,
+                                                  .destroy    = bplib_store_flash_destroy,
+                                                  .enqueue    = bplib_store_flash_enqueue,
+                                                  .dequeue    = bplib_store_flash_dequeue,
+                                                  .retrieve   = bplib_store_flash_retrieve,
+                                                  .release    = bplib_store_flash_release,
+                                                  .relinquish = bplib_store_flash_relinquish,
+                                                  .getcount   = bplib_store_flash_getcount,
+                                              },
+                                          .cold_parm   = NULL,
+                                          .hot_size    = 0,
+                                          .write_delay = 100};
+
+/* Lua Bplib Payload Compressor */
+static const bp_compressor_t lbplib_lz_compressor = {
+    .id = BP_LZ_COMPRESSOR_ID, .compress = bplib_lz_compress, .decompress = bplib_lz_decompress};
+
 /* Lua Bplib Storage Services */
 static lbplib_store_t lbplib_stores[] = {{.name        = "RAM",
                                           .initialized = false,
@@ -149,14 +228,38 @@ static lbplib_store_t lbplib_stores[] = {{.name        = "RAM",
                                           .deinitfunc  = NULL,
                                           .store =
                                               {
-                                                  .create     = bplib_store_ram_create,
-                                                  .destroy    = bplib_store_ram_destroy,
-                                                  .enqueue    = bplib_store_ram_enqueue,
-                                                  .dequeue    = bplib_store_ram_dequeue,
-                                                  .retrieve   = bplib_store_ram_retrieve,
-                                                  .release    = bplib_store_ram_release,
-                                                  .relinquish = bplib_store_ram_relinquish,
-                                                  .getcount   = bplib_store_ram_getcount,
+                                                  .create           = bplib_store_ram_create,
+                                                  .destroy          = bplib_store_ram_destroy,
+                                                  .enqueue          = bplib_store_ram_enqueue,
+                                                  .dequeue          = bplib_store_ram_dequeue,
+                                                  .retrieve         = bplib_store_ram_retrieve,
+                                                  .release          = bplib_store_ram_release,
+                                                  .relinquish       = bplib_store_ram_relinquish,
+                                                  .getcount         = bplib_store_ram_getcount,
+                                                  .allocate         = bplib_store_ram_allocate,
+                                                  .post             = bplib_store_ram_post,
+                                                  .discard          = bplib_store_ram_discard,
+                                                  .enqueue_batch    = bplib_store_ram_enqueue_batch,
+                                                  .dequeue_batch    = bplib_store_ram_dequeue_batch,
+                                                  .relinquish_batch = bplib_store_ram_relinquish_batch,
+                                              }},
+                                         {.name        = "RING",
+                                          .initialized = false,
+                                          .initfunc    = local_store_ring_init,
+                                          .deinitfunc  = NULL,
+                                          .store =
+                                              {
+                                                  .create     = bplib_store_ring_create,
+                                                  .destroy    = bplib_store_ring_destroy,
+                                                  .enqueue    = bplib_store_ring_enqueue,
+                                                  .dequeue    = bplib_store_ring_dequeue,
+                                                  .retrieve   = bplib_store_ring_retrieve,
+                                                  .release    = bplib_store_ring_release,
+                                                  .relinquish = bplib_store_ring_relinquish,
+                                                  .getcount   = bplib_store_ring_getcount,
+                                                  .allocate   = bplib_store_ring_allocate,
+                                                  .post       = bplib_store_ring_post,
+                                                  .discard    = bplib_store_ring_discard,
                                               }},
                                          {.name        = "FILE",
                                           .initialized = false,
@@ -164,29 +267,47 @@ static lbplib_store_t lbplib_stores[] = {{.name        = "RAM",
                                           .deinitfunc  = NULL,
                                           .store =
                                               {
-                                                  .create     = bplib_store_file_create,
-                                                  .destroy    = bplib_store_file_destroy,
-                                                  .enqueue    = bplib_store_file_enqueue,
-                                                  .dequeue    = bplib_store_file_dequeue,
-                                                  .retrieve   = bplib_store_file_retrieve,
-                                                  .release    = bplib_store_file_release,
-                                                  .relinquish = bplib_store_file_relinquish,
-                                                  .getcount   = bplib_store_file_getcount,
+                                                  .create           = bplib_store_file_create,
+                                                  .destroy          = bplib_store_file_destroy,
+                                                  .enqueue          = bplib_store_file_enqueue,
+                                                  .dequeue          = bplib_store_file_dequeue,
+                                                  .retrieve         = bplib_store_file_retrieve,
+                                                  .release          = bplib_store_file_release,
+                                                  .relinquish       = bplib_store_file_relinquish,
+                                                  .getcount         = bplib_store_file_getcount,
+                                                  .relinquish_batch = bplib_store_file_relinquish_batch,
                                               }},
                                          {.name        = "FLASH",
                                           .initialized = false,
                                           .initfunc    = local_store_flash_init,
                                           .deinitfunc  = local_store_flash_deinit,
                                           .store       = {
-                                                    .create     = bplib_store_flash_create,
-                                                    .destroy    = bplib_store_flash_destroy,
-                                                    .enqueue    = bplib_store_flash_enqueue,
-                                                    .dequeue    = bplib_store_flash_dequeue,
-                                                    .retrieve   = bplib_store_flash_retrieve,
-                                                    .release    = bplib_store_flash_release,
-                                                    .relinquish = bplib_store_flash_relinquish,
-                                                    .getcount   = bplib_store_flash_getcount,
-                                          }}};
+                                                    .create           = bplib_store_flash_create,
+                                                    .destroy          = bplib_store_flash_destroy,
+                                                    .enqueue          = bplib_store_flash_enqueue,
+                                                    .dequeue          = bplib_store_flash_dequeue,
+                                                    .retrieve         = bplib_store_flash_retrieve,
+                                                    .release          = bplib_store_flash_release,
+                                                    .relinquish       = bplib_store_flash_relinquish,
+                                                    .getcount         = bplib_store_flash_getcount,
+                                                    .relinquish_batch = bplib_store_flash_relinquish_batch,
+                                          }},
+                                         {.name        = "TIER",
+                                          .initialized = false,
+                                          .initfunc    = local_store_tier_init,
+                                          .deinitfunc  = NULL,
+                                          .store =
+                                              {
+                                                  .create     = bplib_store_tier_create,
+                                                  .destroy    = bplib_store_tier_destroy,
+                                                  .enqueue    = bplib_store_tier_enqueue,
+                                                  .dequeue    = bplib_store_tier_dequeue,
+                                                  .retrieve   = bplib_store_tier_retrieve,
+                                                  .release    = bplib_store_tier_release,
+                                                  .relinquish = bplib_store_tier_relinquish,
+                                                  .getcount   = bplib_store_tier_getcount,
+                                              },
+                                          .parm = &lbplib_tier_attr}};
 
 #define LBPLIB_NUM_STORES (sizeof(lbplib_stores) / sizeof(lbplib_store_t))
 
@@ -246,6 +367,74 @@ void log_message(const char *file_name, unsigned int line_number, const char *fo
     printf("%s", entry_log_msg);
 }
 
+/*----------------------------------------------------------------------------
+ * push_histogram - sets field of table at top of stack to latency histogram
+ *----------------------------------------------------------------------------*/
+static void push_histogram(lua_State *L, const char *name, const bp_histogram_t *hist)
+{
+    int i;
+
+    lua_pushstring(L, name);
+    lua_newtable(L);
+
+    lua_pushstring(L, "count");
+    lua_pushnumber(L, hist->count);
+    lua_settable(L, -3);
+
+    lua_pushstring(L, "max");
+    lua_pushnumber(L, hist->max);
+    lua_settable(L, -3);
+
+    lua_pushstring(L, "buckets");
+    lua_newtable(L);
+    for (i = 0; i < BP_LATENCY_BUCKETS; i++)
+    {
+        lua_pushnumber(L, hist->buckets[i]);
+        lua_rawseti(L, -2, i + 1);
+    }
+    lua_settable(L, -3);
+
+    lua_settable(L, -3);
+}
+
+/*----------------------------------------------------------------------------
+ * push_memstats - pushes table of memory statistics
+ *
+ *  {used=, high=, <subsystem>={used=, high=}, ...}
+ *----------------------------------------------------------------------------*/
+static void push_memstats(lua_State *L, const bp_memstats_t *mem)
+{
+    static const char *tags[BP_NUM_MEM_TAGS] = {"other", "channel", "active", "custody", "dacs",   "reasm", "ram",
+                                                "file",  "flash",   "tier",   "v7",      "engine", "dedup"};
+    int                i;
+
+    lua_newtable(L);
+
+    lua_pushstring(L, "used");
+    lua_pushnumber(L, mem->used);
+    lua_settable(L, -3);
+
+    lua_pushstring(L, "high");
+    lua_pushnumber(L, mem->high);
+    lua_settable(L, -3);
+
+    for (i = 0; i < BP_NUM_MEM_TAGS; i++)
+    {
+        lua_pushstring(L, tags[i]);
+        lua_newtable(L);
+
+        lua_pushstring(L, "used");
+        lua_pushnumber(L, mem->tag_used[i]);
+        lua_settable(L, -3);
+
+        lua_pushstring(L, "high");
+        lua_pushnumber(L, mem->tag_high[i]);
+        lua_settable(L, -3);
+
+        lua_settable(L, -3);
+    }
+}
+
 /*----------------------------------------------------------------------------
  * set_errno
  *----------------------------------------------------------------------------*/
@@ -255,6 +444,45 @@ static void set_errno(lua_State *L, int error_code)
     lua_setglobal(L, LUA_ERRNO);
 }
 
+/*----------------------------------------------------------------------------
+ * buffer_append - copies an object to the end of a buffer, growing its data as needed
+ *----------------------------------------------------------------------------*/
+static bool buffer_append(lbplib_buffer_t *buffer, const void *object, size_t size)
+{
+    if (buffer->count >= buffer->max_entries)
+    {
+        return false;
+    }
+
+    /* Grow Data - kept for the life of the buffer, so reuse does not allocate */
+    if (buffer->used + size > buffer->capacity)
+    {
+        size_t capacity = buffer->capacity * 2;
+        if (capacity < buffer->used + size)
+        {
+            capacity = buffer->used + size;
+        }
+
+        uint8_t *data = (uint8_t *)realloc(buffer->data, capacity);
+        if (data == NULL)
+        {
+            lualog("unable to grow buffer to %lu bytes\n", (unsigned long)capacity);
+            return false;
+        }
+
+        buffer->data     = data;
+        buffer->capacity = capacity;
+    }
+
+    memcpy(&buffer->data[buffer->used], object, size);
+    buffer->offsets[buffer->count] = buffer->used;
+    buffer->sizes[buffer->count]   = size;
+    buffer->used += size;
+    buffer->count++;
+
+    return true;
+}
+
 /*----------------------------------------------------------------------------
  * push_flag_table
  *----------------------------------------------------------------------------*/
@@ -337,6 +565,10 @@ static void push_flag_table(lua_State *L, uint16_t flags)
     lua_pushstring(L, "failedtoparse");
     lua_pushboolean(L, (flags & BP_FLAG_FAILED_TO_PARSE) != 0);
     lua_settable(L, -3);
+
+    lua_pushstring(L, "noroute");
+    lua_pushboolean(L, (flags & BP_FLAG_NO_ROUTE) != 0);
+    lua_settable(L, -3);
 }
 
 /*----------------------------------------------------------------------------
@@ -347,6 +579,14 @@ static void local_store_ram_init(void)
     bplib_store_ram_init();
 }
 
+/*----------------------------------------------------------------------------
+ * local_store_ring_init
+ *----------------------------------------------------------------------------*/
+static void local_store_ring_init(void)
+{
+    bplib_store_ring_init();
+}
+
 /*----------------------------------------------------------------------------
  * local_store_file_init
  *----------------------------------------------------------------------------*/
@@ -371,6 +611,26 @@ static void local_store_flash_deinit(void)
     bplib_store_flash_uninit();
 }
 
+/*----------------------------------------------------------------------------
+ * local_store_tier_init
+ *----------------------------------------------------------------------------*/
+static void local_store_tier_init(void)
+{
+    unsigned int i;
+
+    /* Initialize Flash Storage Service Written Behind To */
+    for (i = 0; i < LBPLIB_NUM_STORES; i++)
+    {
+        if (lbplib_stores[i].store.create == lbplib_tier_attr.cold.create && lbplib_stores[i].initialized == false)
+        {
+            lbplib_stores[i].initialized = true;
+            lbplib_stores[i].initfunc();
+        }
+    }
+
+    bplib_store_tier_init();
+}
+
 /******************************************************************************
  LIBRARY FUNCTIONS
  ******************************************************************************/
@@ -393,6 +653,14 @@ int luaopen_bplib(lua_State *L)
 
     /* Associate Meta Data */
     luaL_setfuncs(L, lbplib_metadata, 0);
+    lua_pop(L, 1);
+
+    /* Create Buffer User Data */
+    luaL_newmetatable(L, LUA_BUFFERMETANAME);
+    lua_pushvalue(L, -1);
+    lua_setfield(L, -2, "__index");
+    luaL_setfuncs(L, lbplib_buffer_metadata, 0);
+    lua_pop(L, 1);
 
     /* Create Functions */
     luaL_newlib(L, lbplib_functions);
@@ -490,26 +758,73 @@ int lbplib_open(lua_State *L)
         lua_getfield(L, 6, "persistent_storage");
 
         /* Get Attributes from Stack */
-        attributes.lifetime             = luaL_optnumber(L, -17, attributes.lifetime);
-        attributes.request_custody      = luaL_optnumber(L, -16, attributes.request_custody) != 0.0;
-        attributes.admin_record         = luaL_optnumber(L, -15, attributes.admin_record) != 0.0;
-        attributes.integrity_check      = luaL_optnumber(L, -14, attributes.integrity_check) != 0.0;
-        attributes.allow_fragmentation  = luaL_optnumber(L, -13, attributes.allow_fragmentation) != 0.0;
-        attributes.ignore_expiration    = luaL_optnumber(L, -12, attributes.ignore_expiration) != 0.0;
-        attributes.cipher_suite         = luaL_optnumber(L, -11, attributes.cipher_suite);
-        attributes.timeout              = luaL_optnumber(L, -10, attributes.timeout);
-        attributes.max_length           = luaL_optnumber(L, -9, attributes.max_length);
-        attributes.cid_reuse            = luaL_optnumber(L, -8, attributes.cid_reuse);
-        attributes.dacs_rate            = luaL_optnumber(L, -7, attributes.dacs_rate);
-        attributes.protocol_version     = luaL_optnumber(L, -6, attributes.protocol_version);
-        attributes.retransmit_order     = luaL_optnumber(L, -5, attributes.retransmit_order);
-        attributes.active_table_size    = luaL_optnumber(L, -4, attributes.active_table_size);
-        attributes.max_fills_per_dacs   = luaL_optnumber(L, -3, attributes.max_fills_per_dacs);
-        attributes.max_gaps_per_dacs    = luaL_optnumber(L, -2, attributes.max_gaps_per_dacs);
-        attributes.persistent_storage   = luaL_optnumber(L, -1, attributes.persistent_storage) != 0.0;
-        attributes.storage_service_parm = NULL;
+        attributes.lifetime            = luaL_optnumber(L, -17, attributes.lifetime);
+        attributes.request_custody     = luaL_optnumber(L, -16, attributes.request_custody) != 0.0;
+        attributes.admin_record        = luaL_optnumber(L, -15, attributes.admin_record) != 0.0;
+        attributes.integrity_check     = luaL_optnumber(L, -14, attributes.integrity_check) != 0.0;
+        attributes.allow_fragmentation = luaL_optnumber(L, -13, attributes.allow_fragmentation) != 0.0;
+        attributes.ignore_expiration   = luaL_optnumber(L, -12, attributes.ignore_expiration) != 0.0;
+        attributes.cipher_suite        = luaL_optnumber(L, -11, attributes.cipher_suite);
+        attributes.timeout             = luaL_optnumber(L, -10, attributes.timeout);
+        attributes.max_length          = luaL_optnumber(L, -9, attributes.max_length);
+        attributes.cid_reuse           = luaL_optnumber(L, -8, attributes.cid_reuse);
+        attributes.dacs_rate           = luaL_optnumber(L, -7, attributes.dacs_rate);
+        attributes.protocol_version    = luaL_optnumber(L, -6, attributes.protocol_version);
+        attributes.retransmit_order    = luaL_optnumber(L, -5, attributes.retransmit_order);
+        attributes.active_table_size   = luaL_optnumber(L, -4, attributes.active_table_size);
+        attributes.max_fills_per_dacs  = luaL_optnumber(L, -3, attributes.max_fills_per_dacs);
+        attributes.max_gaps_per_dacs   = luaL_optnumber(L, -2, attributes.max_gaps_per_dacs);
+        attributes.persistent_storage  = luaL_optnumber(L, -1, attributes.persistent_storage) != 0.0;
+
+        /* Payload Compression */
+        lua_getfield(L, 6, "compress_payloads");
+        if (luaL_optnumber(L, -1, 0) != 0.0)
+        {
+            attributes.payload_compressor = &lbplib_lz_compressor;
+        }
+
+        /* Custody Aggregation */
+        lua_getfield(L, 6, "custody_aggregation");
+        attributes.custody_aggregation = luaL_optnumber(L, -1, attributes.custody_aggregation);
+
+        /* Custody Sources */
+        lua_getfield(L, 6, "max_custody_sources");
+        attributes.max_custody_sources = luaL_optnumber(L, -1, attributes.max_custody_sources);
+
+        /* Class of Service Scheduling */
+        lua_getfield(L, 6, "cos_scheduling");
+        attributes.cos_scheduling = luaL_optnumber(L, -1, attributes.cos_scheduling);
+
+        /* Fragment Reassembly */
+        lua_getfield(L, 6, "reassembly_slots");
+        lua_getfield(L, 6, "max_adu_length");
+        attributes.reassembly_slots = luaL_optnumber(L, -2, attributes.reassembly_slots);
+        attributes.max_adu_length   = luaL_optnumber(L, -1, attributes.max_adu_length);
+
+        /* Duplicate Detection */
+        lua_getfield(L, 6, "duplicate_window");
+        attributes.duplicate_window = luaL_optnumber(L, -1, attributes.duplicate_window);
+
+        /* Expiration Sweep */
+        lua_getfield(L, 6, "sweep_rate");
+        attributes.sweep_rate = luaL_optnumber(L, -1, attributes.sweep_rate);
+
+        /* Adaptive DACS */
+        lua_getfield(L, 6, "adaptive_dacs");
+        attributes.adaptive_dacs = luaL_optnumber(L, -1, attributes.adaptive_dacs) != 0.0;
+
+        /* Pacing */
+        lua_getfield(L, 6, "load_rate_bytes");
+        lua_getfield(L, 6, "load_rate_bundles");
+        lua_getfield(L, 6, "retx_share");
+        attributes.load_rate_bytes   = luaL_optnumber(L, -3, attributes.load_rate_bytes);
+        attributes.load_rate_bundles = luaL_optnumber(L, -2, attributes.load_rate_bundles);
+        attributes.retx_share        = luaL_optnumber(L, -1, attributes.retx_share);
     }
 
+    /* Storage Service Parameter */
+    attributes.storage_service_parm = service->parm;
+
     /* Create Bplib Channel */
     bp_desc_t *desc = bplib_open(route, service->store, attributes);
     if (desc == NULL)
@@ -564,6 +879,43 @@ int lbplib_route(lua_State *L)
     return 3;
 }
 
+/*----------------------------------------------------------------------------
+ * lbplib_dispatch - bplib.dispatch(<bundle>, <timeout>) --> return code, flags
+ *----------------------------------------------------------------------------*/
+int lbplib_dispatch(lua_State *L)
+{
+    /* Check Number of Parameters */
+    int minargs = 2;
+    if (lua_gettop(L) != minargs)
+    {
+        lualog("incorrect number of parameters - expected %d\n", minargs);
+        lua_pushboolean(L, false); /* push result as fail */
+        return 1;
+    }
+
+    /* Type Check Parameters */
+    if (!lua_isstring(L, 1) || /* bundle */
+        !lua_isnumber(L, 2))   /* timeout */
+    {
+        lualog("incorrect parameter types\n");
+        lua_pushboolean(L, false); /* push result as fail */
+        return 1;
+    }
+
+    /* Dispatch Bundle */
+    uint32_t    procflags = 0;
+    size_t      size      = 0;
+    const char *bundle    = lua_tolstring(L, 1, &size);
+    int         timeout   = (int)lua_tonumber(L, 2);
+    int         status    = bplib_dispatch((void *)bundle, size, timeout, &procflags);
+    set_errno(L, status);
+
+    /* Return Status */
+    lua_pushboolean(L, status == BP_SUCCESS);
+    push_flag_table(L, procflags);
+    return 2;
+}
+
 /*----------------------------------------------------------------------------
  * lbplib_display - bplib.lbplib_display(<bundle>,<ascii flag>) --> return code, flags
  *----------------------------------------------------------------------------*/
@@ -761,10 +1113,55 @@ int lbplib_unittest(lua_State *L)
                 failures += bplib_unittest_rh_hash();
             }
 
+            if ((strcmp("ALL", test) == 0) || (strcmp("WHEEL", test) == 0))
+            {
+                failures += bplib_unittest_twheel();
+            }
+
             if ((strcmp("ALL", test) == 0) || (strcmp("FLASH", test) == 0))
             {
                 failures += bplib_unittest_flash();
             }
+
+            if ((strcmp("ALL", test) == 0) || (strcmp("LZ", test) == 0))
+            {
+                failures += bplib_unittest_lz();
+            }
+
+            if ((strcmp("ALL", test) == 0) || (strcmp("BITMAP", test) == 0))
+            {
+                failures += bplib_unittest_cbitmap();
+            }
+
+            if ((strcmp("ALL", test) == 0) || (strcmp("SDNV", test) == 0))
+            {
+                failures += bplib_unittest_sdnv();
+            }
+
+            if ((strcmp("ALL", test) == 0) || (strcmp("LRC", test) == 0))
+            {
+                failures += bplib_unittest_lrc();
+            }
+
+            if ((strcmp("ALL", test) == 0) || (strcmp("REASM", test) == 0))
+            {
+                failures += bplib_unittest_reasm();
+            }
+
+            if ((strcmp("ALL", test) == 0) || (strcmp("DEDUP", test) == 0))
+            {
+                failures += bplib_unittest_dedup();
+            }
+
+            if ((strcmp("ALL", test) == 0) || (strcmp("RING", test) == 0))
+            {
+                failures += bplib_unittest_ring();
+            }
+
+            if ((strcmp("ALL", test) == 0) || (strcmp("FILE", test) == 0))
+            {
+                failures += bplib_unittest_file();
+            }
         }
     }
 
@@ -775,21 +1172,19 @@ int lbplib_unittest(lua_State *L)
 
 /*----------------------------------------------------------------------------
  * lbplib_sleep - bplib.sleep(s) --> sleeps for 's' number of seconds
+ *
+ *  Uses the OS layer so that with the virtual time layer (sim.mk) the sleep
+ *  advances the library's clock and returns immediately
  *----------------------------------------------------------------------------*/
 int lbplib_sleep(lua_State *L)
 {
     if (lua_isnumber(L, 1))
     {
         double wait_time = lua_tonumber(L, 1); /* seconds */
-#ifdef _WINDOWS_
-        int wait_msecs = (int)(wait_time * 1000);
-        Sleep(wait_msecs); /* milliseconds */
-#else
-        struct timespec req;
-        req.tv_sec  = (time_t)wait_time;
-        req.tv_nsec = wait_time - (double)req.tv_sec;
-        nanosleep(&req, NULL);
-#endif
+        if (wait_time > 0)
+        {
+            bplib_os_sleep_us((unsigned long)(wait_time * 1000000));
+        }
     }
     else
     {
@@ -799,12 +1194,29 @@ int lbplib_sleep(lua_State *L)
     return 0;
 }
 
+/*----------------------------------------------------------------------------
+ * lbplib_time - bplib.time() --> seconds of the library's monotonic clock
+ *
+ *  Only differences are meaningful; follows bplib.sleep under virtual time
+ *----------------------------------------------------------------------------*/
+int lbplib_time(lua_State *L)
+{
+    unsigned long usnow = 0;
+    bplib_os_monotime_us(&usnow);
+    lua_pushnumber(L, (double)usnow / 1000000.0);
+    return 1;
+}
+
 /*----------------------------------------------------------------------------
  * lbplib_flashstats - bplib.flashsim("STAT", l, r) -->     flash statistics
  *                                                          l is boolean for logging
  *                                                          r is boolean for resetting
  *                          .flashsim("INIT") -->           flash initialization
  *                          .flashsim("DEINIT") -->         flash cleanup
+ *                          .flashsim("CONFIG", t) -->      flash simulation timing and errors
+ *                                                          t is table of bp_flash_sim_config_t fields
+ *                          .flashsim("SIM", r) -->         flash simulation statistics
+ *                                                          r is boolean for resetting
  *----------------------------------------------------------------------------*/
 int lbplib_flashsim(lua_State *L)
 {
@@ -849,6 +1261,18 @@ int lbplib_flashsim(lua_State *L)
             lua_pushstring(L, "errors");
             lua_pushnumber(L, stats.error_count);
             lua_settable(L, -3);
+            lua_pushstring(L, "writes");
+            lua_pushnumber(L, stats.page_writes);
+            lua_settable(L, -3);
+            lua_pushstring(L, "erased");
+            lua_pushnumber(L, stats.num_erased_blocks);
+            lua_settable(L, -3);
+            lua_pushstring(L, "min_erases");
+            lua_pushnumber(L, stats.min_erase_count);
+            lua_settable(L, -3);
+            lua_pushstring(L, "max_erases");
+            lua_pushnumber(L, stats.max_erase_count);
+            lua_settable(L, -3);
             return 1;
         }
         else if (strcmp(cmdstr, "INIT") == 0)
@@ -860,6 +1284,82 @@ int lbplib_flashsim(lua_State *L)
             }
             return 0;
         }
+        else if (strcmp(cmdstr, "CONFIG") == 0)
+        {
+            bp_flash_sim_config_t config;
+            memset(&config, 0, sizeof(config));
+
+            /* Override if Configuration Table Provided */
+            if (lua_type(L, 2) == LUA_TTABLE)
+            {
+                /* Set Configuration on Stack */
+                lua_getfield(L, 2, "read_latency_us");
+                lua_getfield(L, 2, "program_latency_us");
+                lua_getfield(L, 2, "erase_latency_us");
+                lua_getfield(L, 2, "bus_bytes_per_us");
+                lua_getfield(L, 2, "bit_error_interval");
+                lua_getfield(L, 2, "program_fail_interval");
+                lua_getfield(L, 2, "erase_fail_interval");
+                lua_getfield(L, 2, "bad_blocks");
+                lua_getfield(L, 2, "seed");
+                lua_getfield(L, 2, "virtual_time");
+
+                /* Get Configuration from Stack */
+                config.read_latency_us       = luaL_optnumber(L, -10, 0);
+                config.program_latency_us    = luaL_optnumber(L, -9, 0);
+                config.erase_latency_us      = luaL_optnumber(L, -8, 0);
+                config.bus_bytes_per_us      = luaL_optnumber(L, -7, 0);
+                config.bit_error_interval    = luaL_optnumber(L, -6, 0);
+                config.program_fail_interval = luaL_optnumber(L, -5, 0);
+                config.erase_fail_interval   = luaL_optnumber(L, -4, 0);
+                config.bad_blocks            = luaL_optnumber(L, -3, 0);
+                config.seed                  = luaL_optnumber(L, -2, 0);
+                config.virtual_time          = lua_toboolean(L, -1);
+                lua_pop(L, 10);
+            }
+
+            /* Configure Simulation */
+            lua_pushboolean(L, bplib_flash_sim_configure(&config) == BP_SUCCESS);
+            return 1;
+        }
+        else if (strcmp(cmdstr, "SIM") == 0)
+        {
+            bool reset_stats = false;
+            if (lua_isboolean(L, 2))
+            {
+                reset_stats = lua_toboolean(L, 2);
+            }
+
+            /* Get Simulation Stats */
+            bp_flash_sim_stats_t stats;
+            if (bplib_flash_sim_stats(&stats, reset_stats) != BP_SUCCESS)
+            {
+                lua_pushnil(L);
+                return 1;
+            }
+
+            /* Return Simulation Stats */
+            lua_newtable(L);
+            lua_pushstring(L, "reads");
+            lua_pushnumber(L, stats.reads);
+            lua_settable(L, -3);
+            lua_pushstring(L, "programs");
+            lua_pushnumber(L, stats.programs);
+            lua_settable(L, -3);
+            lua_pushstring(L, "erases");
+            lua_pushnumber(L, stats.erases);
+            lua_settable(L, -3);
+            lua_pushstring(L, "bit_errors");
+            lua_pushnumber(L, stats.bit_errors);
+            lua_settable(L, -3);
+            lua_pushstring(L, "failures");
+            lua_pushnumber(L, stats.failures);
+            lua_settable(L, -3);
+            lua_pushstring(L, "busy_us");
+            lua_pushnumber(L, stats.busy_us);
+            lua_settable(L, -3);
+            return 1;
+        }
         else if (strcmp(cmdstr, "DEINIT") == 0)
         {
             if (lbplib_flash_sim_initialized == true)
@@ -878,13 +1378,19 @@ int lbplib_flashsim(lua_State *L)
 }
 
 /*----------------------------------------------------------------------------
- * lbplib_memstat - bplib.memstat() --> current, high water
+ * lbplib_memstat - bplib.memstat() --> current, high water, {by subsystem}
  *----------------------------------------------------------------------------*/
 int lbplib_memstat(lua_State *L)
 {
-    lua_pushnumber(L, bplib_os_memused());
-    lua_pushnumber(L, bplib_os_memhigh());
-    return 2;
+    bp_memstats_t mem;
+    bplib_memstats(NULL, &mem);
+
+    lua_pushnumber(L, mem.used);
+    lua_pushnumber(L, mem.high);
+
+    push_memstats(L, &mem);
+
+    return 3;
 }
 
 /*----------------------------------------------------------------------------
@@ -921,6 +1427,68 @@ int lbplib_shutdown(lua_State *L)
     return 0;
 }
 
+/*----------------------------------------------------------------------------
+ * lbplib_tick - bplib.tick() --> result, timeout, flags
+ *                                  timeout is milliseconds until next DACS or sweep due (BP_PEND when none)
+ *----------------------------------------------------------------------------*/
+int lbplib_tick(lua_State *L)
+{
+    int      timeout   = BP_PEND;
+    uint32_t tickflags = 0;
+
+    /* Send Due Custody Signals */
+    int status = bplib_tick(&timeout, &tickflags);
+
+    /* Push Results */
+    lua_pushboolean(L, status == BP_SUCCESS);
+    lua_pushinteger(L, timeout);
+    push_flag_table(L, tickflags);
+
+    /* Return Number of Results */
+    return 3;
+}
+
+/*----------------------------------------------------------------------------
+ * lbplib_buffer - bplib.buffer(<entries>, [<bytes>]) --> buffer
+ *                   holds up to <entries> bundles or payloads for the batch functions;
+ *                   its data starts at <bytes> and grows as needed
+ *----------------------------------------------------------------------------*/
+int lbplib_buffer(lua_State *L)
+{
+    /* Get Parameters */
+    int    max_entries = (int)luaL_checknumber(L, 1);
+    size_t capacity    = (size_t)luaL_optnumber(L, 2, (lua_Number)max_entries * LBPLIB_BUFFER_BYTES);
+    if (max_entries <= 0)
+    {
+        lualog("buffer must hold at least one entry\n");
+        lua_pushnil(L);
+        return 1;
+    }
+
+    /* Create Lua User Data Object */
+    lbplib_buffer_t *buffer = (lbplib_buffer_t *)lua_newuserdata(L, sizeof(lbplib_buffer_t));
+    memset(buffer, 0, sizeof(lbplib_buffer_t));
+    luaL_getmetatable(L, LUA_BUFFERMETANAME);
+    lua_setmetatable(L, -2); /* frees the allocations below when collected */
+
+    /* Allocate Buffer */
+    buffer->max_entries = max_entries;
+    buffer->capacity    = capacity > 0 ? capacity : 1;
+    buffer->offsets     = (size_t *)malloc(sizeof(size_t) * max_entries);
+    buffer->sizes       = (size_t *)malloc(sizeof(size_t) * max_entries);
+    buffer->pointers    = (const void **)malloc(sizeof(void *) * max_entries);
+    buffer->data        = (uint8_t *)malloc(buffer->capacity);
+    if (!buffer->offsets || !buffer->sizes || !buffer->pointers || !buffer->data)
+    {
+        lualog("unable to allocate buffer of %d entries\n", max_entries);
+        lua_pop(L, 1);
+        lua_pushnil(L);
+        return 1;
+    }
+
+    return 1;
+}
+
 /******************************************************************************
  BUNDLE PROTOCOL META FUNCTIONS
  ******************************************************************************/
@@ -1049,6 +1617,16 @@ int lbplib_getopt(lua_State *L)
         lua_pushnumber(L, lua_paycrc);
         return 2;
     }
+    else if (strcmp(optstr, "CLASS_OF_SERVICE") == 0)
+    {
+        int cos;
+        int status = bplib_config(bplib_data->desc, BP_OPT_MODE_READ, BP_OPT_CLASS_OF_SERVICE, &cos);
+        lua_pushboolean(L, status == BP_SUCCESS);
+        set_errno(L, status);
+        double lua_cos = (double)cos;
+        lua_pushnumber(L, lua_cos);
+        return 2;
+    }
     else if (strcmp(optstr, "TIMEOUT") == 0)
     {
         int timeout;
@@ -1089,20 +1667,80 @@ int lbplib_getopt(lua_State *L)
         lua_pushnumber(L, lua_rate);
         return 2;
     }
-
-    /* Unrecognized Option */
-    lualog("unrecognized option: %s\n", optstr);
-    lua_pushboolean(L, false);
-    return 1;
-}
-
-/*----------------------------------------------------------------------------
- * lbplib_config - channel:setopt(<option>, <value>) --> return code
- *----------------------------------------------------------------------------*/
-int lbplib_setopt(lua_State *L)
-{
-    /* Get User Data */
-    lbplib_user_data_t *bplib_data = (lbplib_user_data_t *)luaL_checkudata(L, 1, LUA_BPLIBMETANAME);
+    else if (strcmp(optstr, "TIMEOUT_MS") == 0)
+    {
+        int timeout;
+        int status = bplib_config(bplib_data->desc, BP_OPT_MODE_READ, BP_OPT_TIMEOUT_MS, &timeout);
+        set_errno(L, status);
+        lua_pushboolean(L, status == BP_SUCCESS);
+        double lua_timeout = (double)timeout;
+        lua_pushnumber(L, lua_timeout);
+        return 2;
+    }
+    else if (strcmp(optstr, "DACS_RATE_MS") == 0)
+    {
+        int rate;
+        int status = bplib_config(bplib_data->desc, BP_OPT_MODE_READ, BP_OPT_DACS_RATE_MS, &rate);
+        set_errno(L, status);
+        lua_pushboolean(L, status == BP_SUCCESS);
+        double lua_rate = (double)rate;
+        lua_pushnumber(L, lua_rate);
+        return 2;
+    }
+    else if (strcmp(optstr, "LOAD_RATE_BYTES") == 0)
+    {
+        int rate;
+        int status = bplib_config(bplib_data->desc, BP_OPT_MODE_READ, BP_OPT_LOAD_RATE_BYTES, &rate);
+        set_errno(L, status);
+        lua_pushboolean(L, status == BP_SUCCESS);
+        double lua_rate = (double)rate;
+        lua_pushnumber(L, lua_rate);
+        return 2;
+    }
+    else if (strcmp(optstr, "LOAD_RATE_BUNDLES") == 0)
+    {
+        int rate;
+        int status = bplib_config(bplib_data->desc, BP_OPT_MODE_READ, BP_OPT_LOAD_RATE_BUNDLES, &rate);
+        set_errno(L, status);
+        lua_pushboolean(L, status == BP_SUCCESS);
+        double lua_rate = (double)rate;
+        lua_pushnumber(L, lua_rate);
+        return 2;
+    }
+    else if (strcmp(optstr, "ACTIVE_TABLE_SIZE") == 0)
+    {
+        int size;
+        int status = bplib_config(bplib_data->desc, BP_OPT_MODE_READ, BP_OPT_ACTIVE_TABLE_SIZE, &size);
+        set_errno(L, status);
+        lua_pushboolean(L, status == BP_SUCCESS);
+        double lua_size = (double)size;
+        lua_pushnumber(L, lua_size);
+        return 2;
+    }
+    else if (strcmp(optstr, "RETX_SHARE") == 0)
+    {
+        int share;
+        int status = bplib_config(bplib_data->desc, BP_OPT_MODE_READ, BP_OPT_RETX_SHARE, &share);
+        set_errno(L, status);
+        lua_pushboolean(L, status == BP_SUCCESS);
+        double lua_share = (double)share;
+        lua_pushnumber(L, lua_share);
+        return 2;
+    }
+
+    /* Unrecognized Option */
+    lualog("unrecognized option: %s\n", optstr);
+    lua_pushboolean(L, false);
+    return 1;
+}
+
+/*----------------------------------------------------------------------------
+ * lbplib_config - channel:setopt(<option>, <value>) --> return code
+ *----------------------------------------------------------------------------*/
+int lbplib_setopt(lua_State *L)
+{
+    /* Get User Data */
+    lbplib_user_data_t *bplib_data = (lbplib_user_data_t *)luaL_checkudata(L, 1, LUA_BPLIBMETANAME);
     if (!bplib_data)
     {
         lualog("unable to retrieve user data object: %s\n", LUA_BPLIBMETANAME);
@@ -1170,6 +1808,11 @@ int lbplib_setopt(lua_State *L)
         int timeout = (int)lua_tonumber(L, 3);
         status      = bplib_config(bplib_data->desc, BP_OPT_MODE_WRITE, BP_OPT_TIMEOUT, &timeout);
     }
+    else if ((strcmp(optstr, "CLASS_OF_SERVICE") == 0) && lua_isnumber(L, 3))
+    {
+        int cos = (int)lua_tonumber(L, 3);
+        status  = bplib_config(bplib_data->desc, BP_OPT_MODE_WRITE, BP_OPT_CLASS_OF_SERVICE, &cos);
+    }
     else if ((strcmp(optstr, "MAX_LENGTH") == 0) && lua_isnumber(L, 3))
     {
         int len = (int)lua_tonumber(L, 3);
@@ -1185,6 +1828,36 @@ int lbplib_setopt(lua_State *L)
         int rate = (int)lua_tonumber(L, 3);
         status   = bplib_config(bplib_data->desc, BP_OPT_MODE_WRITE, BP_OPT_DACS_RATE, &rate);
     }
+    else if ((strcmp(optstr, "TIMEOUT_MS") == 0) && lua_isnumber(L, 3))
+    {
+        int timeout = (int)lua_tonumber(L, 3);
+        status      = bplib_config(bplib_data->desc, BP_OPT_MODE_WRITE, BP_OPT_TIMEOUT_MS, &timeout);
+    }
+    else if ((strcmp(optstr, "DACS_RATE_MS") == 0) && lua_isnumber(L, 3))
+    {
+        int rate = (int)lua_tonumber(L, 3);
+        status   = bplib_config(bplib_data->desc, BP_OPT_MODE_WRITE, BP_OPT_DACS_RATE_MS, &rate);
+    }
+    else if ((strcmp(optstr, "LOAD_RATE_BYTES") == 0) && lua_isnumber(L, 3))
+    {
+        int rate = (int)lua_tonumber(L, 3);
+        status   = bplib_config(bplib_data->desc, BP_OPT_MODE_WRITE, BP_OPT_LOAD_RATE_BYTES, &rate);
+    }
+    else if ((strcmp(optstr, "LOAD_RATE_BUNDLES") == 0) && lua_isnumber(L, 3))
+    {
+        int rate = (int)lua_tonumber(L, 3);
+        status   = bplib_config(bplib_data->desc, BP_OPT_MODE_WRITE, BP_OPT_LOAD_RATE_BUNDLES, &rate);
+    }
+    else if ((strcmp(optstr, "ACTIVE_TABLE_SIZE") == 0) && lua_isnumber(L, 3))
+    {
+        int size = (int)lua_tonumber(L, 3);
+        status   = bplib_config(bplib_data->desc, BP_OPT_MODE_WRITE, BP_OPT_ACTIVE_TABLE_SIZE, &size);
+    }
+    else if ((strcmp(optstr, "RETX_SHARE") == 0) && lua_isnumber(L, 3))
+    {
+        int share = (int)lua_tonumber(L, 3);
+        status    = bplib_config(bplib_data->desc, BP_OPT_MODE_WRITE, BP_OPT_RETX_SHARE, &share);
+    }
 
     /* Return Status */
     set_errno(L, status);
@@ -1255,6 +1928,18 @@ int lbplib_stats(lua_State *L)
     lua_pushnumber(L, stats.received_dacs);
     lua_settable(L, -3);
 
+    lua_pushstring(L, "compressed_payloads");
+    lua_pushnumber(L, stats.compressed_payloads);
+    lua_settable(L, -3);
+
+    lua_pushstring(L, "reassembled_payloads");
+    lua_pushnumber(L, stats.reassembled_payloads);
+    lua_settable(L, -3);
+
+    lua_pushstring(L, "duplicate_bundles");
+    lua_pushnumber(L, stats.duplicate_bundles);
+    lua_settable(L, -3);
+
     lua_pushstring(L, "stored_bundles");
     lua_pushnumber(L, stats.stored_bundles);
     lua_settable(L, -3);
@@ -1275,6 +1960,18 @@ int lbplib_stats(lua_State *L)
     lua_pushnumber(L, stats.active_bundles);
     lua_settable(L, -3);
 
+    push_histogram(L, "store_to_load", &stats.store_to_load);
+    push_histogram(L, "load_to_ack", &stats.load_to_ack);
+    push_histogram(L, "enqueue", &stats.enqueue);
+    push_histogram(L, "dequeue", &stats.dequeue);
+    push_histogram(L, "retrieve", &stats.retrieve);
+
+    bp_memstats_t mem;
+    bplib_memstats(bplib_data->desc, &mem);
+    lua_pushstring(L, "memory");
+    push_memstats(L, &mem);
+    lua_settable(L, -3);
+
     return 2;
 }
 
@@ -1323,6 +2020,119 @@ int lbplib_store(lua_State *L)
     return 2;
 }
 
+/*----------------------------------------------------------------------------
+ * lbplib_stream_open - channel:stream_open(<size>) --> return code, flags
+ *----------------------------------------------------------------------------*/
+int lbplib_stream_open(lua_State *L)
+{
+    /* Get User Data */
+    lbplib_user_data_t *bplib_data = (lbplib_user_data_t *)luaL_checkudata(L, 1, LUA_BPLIBMETANAME);
+    if (!bplib_data)
+    {
+        lualog("unable to retrieve user data object: %s\n", LUA_BPLIBMETANAME);
+        lua_pushboolean(L, false); /* push result as fail */
+        return 1;
+    }
+
+    /* Check Number of Parameters */
+    int minargs = 2;
+    if (lua_gettop(L) != minargs)
+    {
+        lualog("incorrect number of parameters - expected %d\n", minargs);
+        lua_pushboolean(L, false); /* push result as fail */
+        return 1;
+    }
+
+    /* Type Check Parameters */
+    if (!lua_isnumber(L, 2))
+    {
+        lualog("incorrect parameter types\n");
+        lua_pushboolean(L, false); /* push result as fail */
+        return 1;
+    }
+
+    /* Open Stream */
+    uint32_t storflags = 0;
+    size_t   size      = (size_t)lua_tonumber(L, 2);
+    int      status    = bplib_stream_open(bplib_data->desc, size, &storflags);
+    set_errno(L, status);
+
+    /* Return Status */
+    lua_pushboolean(L, status == BP_SUCCESS);
+    push_flag_table(L, storflags);
+    return 2;
+}
+
+/*----------------------------------------------------------------------------
+ * lbplib_stream_write - channel:stream_write(<data>, <timeout>) --> return code, flags
+ *----------------------------------------------------------------------------*/
+int lbplib_stream_write(lua_State *L)
+{
+    /* Get User Data */
+    lbplib_user_data_t *bplib_data = (lbplib_user_data_t *)luaL_checkudata(L, 1, LUA_BPLIBMETANAME);
+    if (!bplib_data)
+    {
+        lualog("unable to retrieve user data object: %s\n", LUA_BPLIBMETANAME);
+        lua_pushboolean(L, false); /* push result as fail */
+        return 1;
+    }
+
+    /* Check Number of Parameters */
+    int minargs = 3;
+    if (lua_gettop(L) != minargs)
+    {
+        lualog("incorrect number of parameters - expected %d\n", minargs);
+        lua_pushboolean(L, false); /* push result as fail */
+        return 1;
+    }
+
+    /* Type Check Parameters */
+    if (!lua_isstring(L, 2) || !lua_isnumber(L, 3))
+    {
+        lualog("incorrect parameter types\n");
+        lua_pushboolean(L, false); /* push result as fail */
+        return 1;
+    }
+
+    /* Write Data */
+    uint32_t    storflags = 0;
+    size_t      size      = 0;
+    const char *data      = lua_tolstring(L, 2, &size);
+    int         timeout   = (int)lua_tonumber(L, 3);
+    int         status    = bplib_stream_write(bplib_data->desc, data, size, timeout, &storflags);
+    set_errno(L, status);
+
+    /* Return Status */
+    lua_pushboolean(L, status == BP_SUCCESS);
+    push_flag_table(L, storflags);
+    return 2;
+}
+
+/*----------------------------------------------------------------------------
+ * lbplib_stream_close - channel:stream_close() --> return code, flags
+ *----------------------------------------------------------------------------*/
+int lbplib_stream_close(lua_State *L)
+{
+    /* Get User Data */
+    lbplib_user_data_t *bplib_data = (lbplib_user_data_t *)luaL_checkudata(L, 1, LUA_BPLIBMETANAME);
+    if (!bplib_data)
+    {
+        lualog("unable to retrieve user data object: %s\n", LUA_BPLIBMETANAME);
+        lua_pushboolean(L, false); /* push result as fail */
+        return 1;
+    }
+
+    /* Close Stream */
+    uint32_t storflags = 0;
+    int      status    = bplib_stream_close(bplib_data->desc, &storflags);
+    set_errno(L, status);
+
+    /* Return Status */
+    lua_pushboolean(L, status == BP_SUCCESS);
+    push_flag_table(L, storflags);
+    return 2;
+}
+
 /*----------------------------------------------------------------------------
  * lbplib_load - channel:load(<timeout>) --> return code, bundle, flags
  *----------------------------------------------------------------------------*/
@@ -1357,7 +2167,7 @@ int lbplib_load(lua_State *L)
     /* Load Bundle */
     uint32_t loadflags = 0;
     char    *bundle    = NULL;
-    int      size      = 0;
+    size_t   size      = 0;
     int      timeout   = (int)lua_tonumber(L, 2);
     int      status    = bplib_load(bplib_data->desc, (void **)&bundle, &size, timeout, &loadflags);
     set_errno(L, status);
@@ -1429,6 +2239,78 @@ int lbplib_process(lua_State *L)
     return 2;
 }
 
+/*----------------------------------------------------------------------------
+ * lbplib_addroute - channel:addroute(<first node>, <last node>, [<first serv>, <last serv>]) --> return code
+ *----------------------------------------------------------------------------*/
+int lbplib_addroute(lua_State *L)
+{
+    /* Get User Data */
+    lbplib_user_data_t *bplib_data = (lbplib_user_data_t *)luaL_checkudata(L, 1, LUA_BPLIBMETANAME);
+    if (!bplib_data)
+    {
+        lualog("unable to retrieve user data object: %s\n", LUA_BPLIBMETANAME);
+        lua_pushboolean(L, false); /* push result as fail */
+        return 1;
+    }
+
+    /* Check Number of Parameters */
+    int minargs = 3;
+    int maxargs = 5;
+    if (lua_gettop(L) != minargs && lua_gettop(L) != maxargs)
+    {
+        lualog("incorrect number of parameters - expected %d or %d\n", minargs, maxargs);
+        lua_pushboolean(L, false); /* push result as fail */
+        return 1;
+    }
+
+    /* Type Check Parameters */
+    int i;
+    for (i = 2; i <= lua_gettop(L); i++)
+    {
+        if (!lua_isnumber(L, i))
+        {
+            lualog("incorrect parameter types\n");
+            lua_pushboolean(L, false); /* push result as fail */
+            return 1;
+        }
+    }
+
+    /* Add Route (all services when no service range is given) */
+    bp_ipn_t first_node    = (bp_ipn_t)lua_tonumber(L, 2);
+    bp_ipn_t last_node     = (bp_ipn_t)lua_tonumber(L, 3);
+    bp_ipn_t first_service = lua_gettop(L) == maxargs ? (bp_ipn_t)lua_tonumber(L, 4) : 0;
+    bp_ipn_t last_service  = lua_gettop(L) == maxargs ? (bp_ipn_t)lua_tonumber(L, 5) : BP_MAX_ENCODED_VALUE;
+    int      status        = bplib_addroute(bplib_data->desc, first_node, last_node, first_service, last_service);
+    set_errno(L, status);
+
+    /* Return Status */
+    lua_pushboolean(L, status == BP_SUCCESS);
+    return 1;
+}
+
+/*----------------------------------------------------------------------------
+ * lbplib_delroute - channel:delroute() --> return code
+ *----------------------------------------------------------------------------*/
+int lbplib_delroute(lua_State *L)
+{
+    /* Get User Data */
+    lbplib_user_data_t *bplib_data = (lbplib_user_data_t *)luaL_checkudata(L, 1, LUA_BPLIBMETANAME);
+    if (!bplib_data)
+    {
+        lualog("unable to retrieve user data object: %s\n", LUA_BPLIBMETANAME);
+        lua_pushboolean(L, false); /* push result as fail */
+        return 1;
+    }
+
+    /* Remove Routes */
+    int status = bplib_delroute(bplib_data->desc);
+    set_errno(L, status);
+
+    /* Return Status */
+    lua_pushboolean(L, status == BP_SUCCESS);
+    return 1;
+}
+
 /*----------------------------------------------------------------------------
  * lbplib_accept - channel:accept(<timeout>) --> return code, data, flags
  *----------------------------------------------------------------------------*/
@@ -1463,7 +2345,7 @@ int lbplib_accept(lua_State *L)
     /* Accept Payload */
     uint32_t acptflags = 0;
     char    *payload   = NULL;
-    int      size      = 0;
+    size_t   size      = 0;
     int      timeout   = (int)lua_tonumber(L, 2);
     int      status    = bplib_accept(bplib_data->desc, (void **)&payload, &size, timeout, &acptflags);
     set_errno(L, status);
@@ -1508,3 +2390,281 @@ int lbplib_flush(lua_State *L)
 
     return 0;
 }
+
+/*----------------------------------------------------------------------------
+ * lbplib_store_batch - channel:store_batch(<buffer>, <timeout>) --> return code, count, flags
+ *                        stores each payload in the buffer, stopping at the first failure
+ *----------------------------------------------------------------------------*/
+int lbplib_store_batch(lua_State *L)
+{
+    /* Get User Data */
+    lbplib_user_data_t *bplib_data = (lbplib_user_data_t *)luaL_checkudata(L, 1, LUA_BPLIBMETANAME);
+    lbplib_buffer_t    *buffer     = (lbplib_buffer_t *)luaL_checkudata(L, 2, LUA_BUFFERMETANAME);
+    int                 timeout    = (int)luaL_checknumber(L, 3);
+
+    /* Store Payloads */
+    uint32_t storflags = 0;
+    int      status    = BP_SUCCESS;
+    int      count;
+    for (count = 0; count < buffer->count; count++)
+    {
+        status = bplib_store(bplib_data->desc, &buffer->data[buffer->offsets[count]], buffer->sizes[count], timeout,
+                             &storflags);
+        if (status != BP_SUCCESS)
+        {
+            break;
+        }
+    }
+    set_errno(L, status);
+
+    /* Return Status */
+    lua_pushboolean(L, status == BP_SUCCESS);
+    lua_pushinteger(L, count);
+    push_flag_table(L, storflags);
+    return 3;
+}
+
+/*----------------------------------------------------------------------------
+ * lbplib_load_batch - channel:load_batch(<buffer>, <timeout>) --> return code, count, flags
+ *                       replaces the contents of the buffer with as many loaded bundles as it holds;
+ *                       only the first load waits for the timeout
+ *----------------------------------------------------------------------------*/
+int lbplib_load_batch(lua_State *L)
+{
+    /* Get User Data */
+    lbplib_user_data_t *bplib_data = (lbplib_user_data_t *)luaL_checkudata(L, 1, LUA_BPLIBMETANAME);
+    lbplib_buffer_t    *buffer     = (lbplib_buffer_t *)luaL_checkudata(L, 2, LUA_BUFFERMETANAME);
+    int                 timeout    = (int)luaL_checknumber(L, 3);
+
+    /* Load Bundles */
+    uint32_t loadflags = 0;
+    int      status    = BP_SUCCESS;
+    buffer->count      = 0;
+    buffer->used       = 0;
+    while (buffer->count < buffer->max_entries)
+    {
+        void  *bundles[BPLIB_MAX_LOAD_BATCH];
+        size_t sizes[BPLIB_MAX_LOAD_BATCH];
+        int    max = buffer->max_entries - buffer->count;
+        int    loaded;
+        int    i;
+
+        if (max > BPLIB_MAX_LOAD_BATCH)
+        {
+            max = BPLIB_MAX_LOAD_BATCH;
+        }
+
+        loaded = bplib_load_batch(bplib_data->desc, bundles, sizes, max, buffer->count == 0 ? timeout : BP_CHECK,
+                                  &loadflags);
+        if (loaded <= 0)
+        {
+            status = loaded;
+            break;
+        }
+
+        /* Copy Bundles into Buffer and Release Them */
+        for (i = 0; i < loaded; i++)
+        {
+            if (!buffer_append(buffer, bundles[i], sizes[i]))
+            {
+                status = BP_ERROR;
+            }
+            bplib_ackbundle(bplib_data->desc, bundles[i]);
+        }
+
+        if (status != BP_SUCCESS)
+        {
+            break;
+        }
+    }
+
+    /* Loading Stops when no More Bundles are Ready */
+    if (buffer->count > 0 && status == BP_TIMEOUT)
+    {
+        status = BP_SUCCESS;
+    }
+    set_errno(L, status);
+
+    /* Return Status */
+    lua_pushboolean(L, status == BP_SUCCESS);
+    lua_pushinteger(L, buffer->count);
+    push_flag_table(L, loadflags);
+    return 3;
+}
+
+/*----------------------------------------------------------------------------
+ * lbplib_process_batch - channel:process_batch(<buffer>, <timeout>) --> return code, count, flags
+ *                          processes every bundle in the buffer, count is the number successfully processed
+ *----------------------------------------------------------------------------*/
+int lbplib_process_batch(lua_State *L)
+{
+    /* Get User Data */
+    lbplib_user_data_t *bplib_data = (lbplib_user_data_t *)luaL_checkudata(L, 1, LUA_BPLIBMETANAME);
+    lbplib_buffer_t    *buffer     = (lbplib_buffer_t *)luaL_checkudata(L, 2, LUA_BUFFERMETANAME);
+    int                 timeout    = (int)luaL_checknumber(L, 3);
+
+    /* Point to Bundles - the data is not moved while they are processed */
+    int i;
+    for (i = 0; i < buffer->count; i++)
+    {
+        buffer->pointers[i] = &buffer->data[buffer->offsets[i]];
+    }
+
+    /* Process Bundles */
+    uint32_t procflags = 0;
+    int      processed = 0;
+    int      status    = BP_SUCCESS;
+    if (buffer->count > 0)
+    {
+        processed = bplib_process_batch(bplib_data->desc, buffer->pointers, buffer->sizes, buffer->count, timeout,
+                                        &procflags);
+        if (processed < 0)
+        {
+            status    = processed;
+            processed = 0;
+        }
+        else if (processed < buffer->count)
+        {
+            status = BP_ERROR;
+        }
+    }
+    set_errno(L, status);
+
+    /* Return Status */
+    lua_pushboolean(L, status == BP_SUCCESS);
+    lua_pushinteger(L, processed);
+    push_flag_table(L, procflags);
+    return 3;
+}
+
+/*----------------------------------------------------------------------------
+ * lbplib_accept_batch - channel:accept_batch(<buffer>, <timeout>) --> return code, count, flags
+ *                         replaces the contents of the buffer with as many accepted payloads as it holds;
+ *                         only the first accept waits for the timeout
+ *----------------------------------------------------------------------------*/
+int lbplib_accept_batch(lua_State *L)
+{
+    /* Get User Data */
+    lbplib_user_data_t *bplib_data = (lbplib_user_data_t *)luaL_checkudata(L, 1, LUA_BPLIBMETANAME);
+    lbplib_buffer_t    *buffer     = (lbplib_buffer_t *)luaL_checkudata(L, 2, LUA_BUFFERMETANAME);
+    int                 timeout    = (int)luaL_checknumber(L, 3);
+
+    /* Accept Payloads */
+    uint32_t acptflags = 0;
+    int      status    = BP_SUCCESS;
+    buffer->count      = 0;
+    buffer->used       = 0;
+    while (buffer->count < buffer->max_entries)
+    {
+        void  *payload = NULL;
+        size_t size    = 0;
+
+        status = bplib_accept(bplib_data->desc, &payload, &size, buffer->count == 0 ? timeout : BP_CHECK, &acptflags);
+        if (status != BP_SUCCESS)
+        {
+            break;
+        }
+
+        /* Copy Payload into Buffer and Release It */
+        if (!buffer_append(buffer, payload, size))
+        {
+            status = BP_ERROR;
+        }
+        bplib_ackpayload(bplib_data->desc, payload);
+
+        if (status != BP_SUCCESS)
+        {
+            break;
+        }
+    }
+
+    /* Accepting Stops when no More Payloads are Ready */
+    if (buffer->count > 0 && status == BP_TIMEOUT)
+    {
+        status = BP_SUCCESS;
+    }
+    set_errno(L, status);
+
+    /* Return Status */
+    lua_pushboolean(L, status == BP_SUCCESS);
+    lua_pushinteger(L, buffer->count);
+    push_flag_table(L, acptflags);
+    return 3;
+}
+
+/******************************************************************************
+ BUFFER META FUNCTIONS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * lbplib_buffer_delete
+ *----------------------------------------------------------------------------*/
+int lbplib_buffer_delete(lua_State *L)
+{
+    lbplib_buffer_t *buffer = (lbplib_buffer_t *)luaL_checkudata(L, 1, LUA_BUFFERMETANAME);
+
+    free(buffer->offsets);
+    free(buffer->sizes);
+    free(buffer->pointers);
+    free(buffer->data);
+    memset(buffer, 0, sizeof(lbplib_buffer_t));
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------
+ * lbplib_buffer_add - buffer:add(<data>) --> return code
+ *----------------------------------------------------------------------------*/
+int lbplib_buffer_add(lua_State *L)
+{
+    lbplib_buffer_t *buffer = (lbplib_buffer_t *)luaL_checkudata(L, 1, LUA_BUFFERMETANAME);
+    size_t           size   = 0;
+    const char      *data   = luaL_checklstring(L, 2, &size);
+
+    lua_pushboolean(L, buffer_append(buffer, data, size));
+    return 1;
+}
+
+/*----------------------------------------------------------------------------
+ * lbplib_buffer_get - buffer:get(<index>) --> data (nil when out of range)
+ *----------------------------------------------------------------------------*/
+int lbplib_buffer_get(lua_State *L)
+{
+    lbplib_buffer_t *buffer = (lbplib_buffer_t *)luaL_checkudata(L, 1, LUA_BUFFERMETANAME);
+    int              index  = (int)luaL_checknumber(L, 2);
+
+    if (index < 1 || index > buffer->count)
+    {
+        lua_pushnil(L);
+    }
+    else
+    {
+        lua_pushlstring(L, (const char *)&buffer->data[buffer->offsets[index - 1]], buffer->sizes[index - 1]);
+    }
+
+    return 1;
+}
+
+/*----------------------------------------------------------------------------
+ * lbplib_buffer_count - buffer:count() or #buffer --> number of entries
+ *----------------------------------------------------------------------------*/
+int lbplib_buffer_count(lua_State *L)
+{
+    lbplib_buffer_t *buffer = (lbplib_buffer_t *)luaL_checkudata(L, 1, LUA_BUFFERMETANAME);
+
+    lua_pushinteger(L, buffer->count);
+    return 1;
+}
+
+/*----------------------------------------------------------------------------
+ * lbplib_buffer_clear - buffer:clear()
+ *----------------------------------------------------------------------------*/
+int lbplib_buffer_clear(lua_State *L)
+{
+    lbplib_buffer_t *buffer = (lbplib_buffer_t *)luaL_checkudata(L, 1, LUA_BUFFERMETANAME);
+
+    buffer->count = 0;
+    buffer->used  = 0;
+
+    return 0;
+}
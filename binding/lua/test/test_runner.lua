@@ -11,6 +11,8 @@ start_currmem, start_highmem = bplib.memstat()
 runner.script(rd .. "ut_open_close.lua", {"RAM"})
 runner.script(rd .. "ut_open_close.lua", {"FILE"})
 runner.script(rd .. "ut_open_close.lua", {"FLASH"})
+runner.script(rd .. "ut_open_close.lua", {"RING"})
+runner.script(rd .. "ut_open_close.lua", {"TIER"})
 runner.script(rd .. "ut_attributes.lua")
 runner.script(rd .. "ut_getset_opt.lua")
 runner.script(rd .. "ut_eid2ipn.lua")
@@ -18,7 +20,9 @@ runner.script(rd .. "ut_ipn2eid.lua")
 runner.script(rd .. "ut_route.lua")
 runner.script(rd .. "ut_expiration.lua")
 runner.script(rd .. "ut_expiration.lua", {"FLASH"})
+runner.script(rd .. "ut_recover.lua", {"FILE"})
 runner.script(rd .. "ut_recover.lua", {"FLASH"})
+runner.script(rd .. "ut_recover.lua", {"TIER"})
 runner.script(rd .. "ut_memusage.lua", {"RAM"})
 runner.script(rd .. "ut_active_table.lua", {"RAM", "SMALLEST"})
 runner.script(rd .. "ut_active_table.lua", {"RAM", "OLDEST"})
@@ -33,12 +37,36 @@ runner.script(rd .. "ut_wrap_response.lua", {"FLASH"})
 runner.script(rd .. "ut_dacs_continuous.lua", {"RAM"})
 runner.script(rd .. "ut_dacs_continuous.lua", {"FILE"})
 runner.script(rd .. "ut_dacs_continuous.lua", {"FLASH"})
+runner.script(rd .. "ut_dacs_continuous.lua", {"RING"})
+runner.script(rd .. "ut_dacs_continuous.lua", {"TIER"})
 runner.script(rd .. "ut_dacs_skip.lua", {"RAM"})
 runner.script(rd .. "ut_dacs_skip.lua", {"FILE"})
 runner.script(rd .. "ut_dacs_skip.lua", {"FLASH"})
+runner.script(rd .. "ut_dacs_skip.lua", {"RAM", "ADAPTIVE"})
+runner.script(rd .. "ut_dacs_sources.lua", {"RAM"})
+runner.script(rd .. "ut_dacs_sources.lua", {"FILE"})
+runner.script(rd .. "ut_forward.lua", {"RAM"})
+runner.script(rd .. "ut_forward.lua", {"FILE"})
+runner.script(rd .. "ut_dispatch.lua", {"RAM"})
+runner.script(rd .. "ut_dispatch.lua", {"FILE"})
+runner.script(rd .. "ut_cos_scheduling.lua", {"RAM"})
+runner.script(rd .. "ut_cos_scheduling.lua", {"FILE"})
+runner.script(rd .. "ut_pacing.lua", {"RAM"})
+runner.script(rd .. "ut_pacing.lua", {"FILE"})
+runner.script(rd .. "ut_compression.lua", {"RAM"})
+runner.script(rd .. "ut_compression.lua", {"FLASH"})
+runner.script(rd .. "ut_reassembly.lua", {"RAM"})
+runner.script(rd .. "ut_reassembly.lua", {"FILE"})
+runner.script(rd .. "ut_duplicates.lua", {"RAM"})
+runner.script(rd .. "ut_duplicates.lua", {"FILE"})
+runner.script(rd .. "ut_stream.lua", {"RAM"})
+runner.script(rd .. "ut_stream.lua", {"FILE"})
+runner.script(rd .. "ut_batch.lua", {"RAM"})
+runner.script(rd .. "ut_batch.lua", {"FILE"})
 runner.script(rd .. "ut_high_loss.lua", {"RAM"})
 runner.script(rd .. "ut_high_loss.lua", {"FILE"})
 runner.script(rd .. "ut_high_loss.lua", {"FLASH", 100})
+runner.script(rd .. "ut_high_loss.lua", {"RAM", 256, "BITMAP"})
 runner.script(rd .. "ut_unittest.lua")
 
 -- Check for Memory Leaks --
@@ -67,6 +67,50 @@ for i=1,num_bundles do
 	end
 end
 
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 2 - resize with active bundles', store, src))
+
+-- table is full --
+rc, flags = sender:store('HELLO AGAIN 1', 1000)
+runner.check(rc)
+rc, bundle, flags = sender:load(0)
+runner.check(rc == false)
+
+-- grow table --
+rc = sender:setopt("ACTIVE_TABLE_SIZE", num_bundles * 2)
+runner.check(rc)
+rc, size = sender:getopt("ACTIVE_TABLE_SIZE")
+runner.check(rc)
+runner.check(size == num_bundles * 2)
+
+-- fill grown table --
+for i=1,num_bundles do
+	if i > 1 then
+		rc, flags = sender:store(string.format('HELLO AGAIN %d', i), 1000)
+		runner.check(rc)
+	end
+	rc, bundle, flags = sender:load(1000)
+	runner.check(rc)
+	runner.check(bp.find_payload(bundle, string.format('HELLO AGAIN %d', i)))
+end
+
+-- cannot shrink below active bundles --
+rc = sender:setopt("ACTIVE_TABLE_SIZE", num_bundles)
+runner.check(rc == false)
+
+-- all active bundles kept --
+bplib.sleep(timeout + 1)
+for i=1,num_bundles do
+	rc, bundle, flags = sender:load(1000)
+	runner.check(rc)
+	runner.check(bp.find_payload(bundle, string.format('HELLO WORLD %d', i)))
+end
+for i=1,num_bundles do
+	rc, bundle, flags = sender:load(1000)
+	runner.check(rc)
+	runner.check(bp.find_payload(bundle, string.format('HELLO AGAIN %d', i)))
+end
+
 -- Clean Up --
 
 sender:flush()
@@ -0,0 +1,99 @@
+local bplib = require("bplib")
+local runner = require("bptest")
+local bp = require("bp")
+local rd = runner.rootdir(arg[0])
+local src = runner.srcscript()
+
+-- Setup --
+
+local store = arg[1] or "RAM"
+runner.setup(bplib, store)
+
+local src_node = 4
+local src_serv = 3
+local dst_node = 72
+local dst_serv = 43
+
+local num_payloads = 100
+local batch_size = 32
+local timeout = 1
+
+local sender = bplib.open(src_node, src_serv, dst_node, dst_serv, store)
+local receiver = bplib.open(dst_node, dst_serv, src_node, src_serv, store)
+
+rc = receiver:setopt("DACS_RATE", timeout)
+runner.check(rc)
+
+local payloads = bplib.buffer(num_payloads)
+local bundles = bplib.buffer(batch_size)
+
+-- Test --
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 1 - buffer entries', store, src))
+runner.check(payloads:count() == 0)
+for i=1,num_payloads do
+    runner.check(payloads:add(string.format('BATCH %d', i)))
+end
+runner.check(payloads:add('ONE TOO MANY') == false, 'Error - buffer holds more than its entries')
+runner.check(#payloads == num_payloads)
+runner.check(payloads:get(1) == 'BATCH 1')
+runner.check(payloads:get(num_payloads) == string.format('BATCH %d', num_payloads))
+runner.check(payloads:get(0) == nil and payloads:get(num_payloads + 1) == nil)
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 2 - store, load, process, and accept batches', store, src))
+rc, count, flags = sender:store_batch(payloads, 1000)
+runner.check(rc)
+runner.check(count == num_payloads, string.format('Error - stored %d payloads', count))
+runner.check(bp.check_flags(flags, {}), "Flags set on store batch")
+
+-- move bundles a buffer at a time --
+local loaded = 0
+while loaded < num_payloads do
+    rc, count, flags = sender:load_batch(bundles, 1000)
+    runner.check(rc)
+    runner.check(count == math.min(batch_size, num_payloads - loaded), string.format('Error - loaded %d bundles', count))
+    runner.check(bp.check_flags(flags, {}), "Flags set on load batch")
+    loaded = loaded + count
+
+    rc, count, flags = receiver:process_batch(bundles, 1000)
+    runner.check(rc)
+    runner.check(count == #bundles, string.format('Error - processed %d bundles', count))
+end
+rc, count, flags = sender:load_batch(bundles, 0)
+runner.check(rc == false and count == 0, 'Error - bundle loaded after all were loaded')
+
+-- accept every payload in order --
+payloads:clear()
+runner.check(#payloads == 0)
+rc, count, flags = receiver:accept_batch(payloads, 1000)
+runner.check(rc)
+runner.check(count == num_payloads, string.format('Error - accepted %d payloads', count))
+for i=1,num_payloads do
+    runner.check(payloads:get(i) == string.format('BATCH %d', i), string.format('Error - payload %d did not match', i))
+end
+
+-- acknowledge all bundles --
+bplib.sleep(timeout)
+rc, count, flags = receiver:load_batch(bundles, 1000)
+runner.check(rc)
+runner.check(bp.check_flags(flags, {"routeneeded"}))
+rc, count, flags = sender:process_batch(bundles, 1000)
+runner.check(rc)
+
+-- check stats --
+rc, stats = sender:stats()
+runner.check(bp.check_stats(stats, {transmitted_bundles=num_payloads, acknowledged_bundles=num_payloads, active_bundles=0}))
+rc, stats = receiver:stats()
+runner.check(bp.check_stats(stats, {received_bundles=num_payloads, delivered_payloads=num_payloads, stored_payloads=0}))
+
+-- Clean Up --
+
+sender:close()
+receiver:close()
+runner.cleanup(bplib, store)
+
+-- Report Results --
+
+runner.report(bplib)
@@ -0,0 +1,96 @@
+local bplib = require("bplib")
+local runner = require("bptest")
+local bp = require("bp")
+local rd = runner.rootdir(arg[0])
+local src = runner.srcscript()
+
+-- Setup --
+
+local store = arg[1] or "RAM"
+runner.setup(bplib, store)
+
+local src_node = 4
+local src_serv = 3
+local dst_node = 72
+local dst_serv = 43
+
+local num_bundles = 20
+
+local sender = bplib.open(src_node, src_serv, dst_node, dst_serv, store, {compress_payloads=1})
+local receiver = bplib.open(dst_node, dst_serv, src_node, src_serv, store, {compress_payloads=1})
+local plain = bplib.open(dst_node, dst_serv, src_node, src_serv, store)
+
+-- Test --
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 1 - compressed round trip', store, src))
+for i=1,num_bundles do
+    payload = string.rep(string.format('TELEMETRY FRAME %d ', i), 50)
+
+    -- store payload --
+    rc, flags = sender:store(payload, 1000)
+    runner.check(rc)
+    runner.check(bp.check_flags(flags, {}), "flags set on store")
+
+    -- load bundle --
+    rc, bundle, flags = sender:load(1000)
+    runner.check(rc)
+    runner.check(bundle ~= nil)
+    runner.check(#bundle < #payload, string.format('Error - bundle of %d bytes not compressed', #bundle))
+
+    -- process bundle --
+    rc, flags = receiver:process(bundle, 1000)
+    runner.check(rc)
+    runner.check(bp.check_flags(flags, {}), "flags set on process")
+
+    -- accept payload --
+    rc, app_payload, flags = receiver:accept(1000)
+    runner.check(rc)
+    runner.check(app_payload == payload, string.format('Error - payload %d did not match', i))
+end
+
+-- check stats --
+rc, stats = sender:stats()
+runner.check(bp.check_stats(stats, {compressed_payloads=num_bundles}))
+rc, stats = receiver:stats()
+runner.check(bp.check_stats(stats, {received_bundles=num_bundles, delivered_payloads=num_bundles}))
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 2 - incompressible payload', store, src))
+payload = ''
+for i=1,64 do
+    payload = payload .. string.char((i * 37) % 256)
+end
+rc, flags = sender:store(payload, 1000)
+runner.check(rc)
+rc, bundle, flags = sender:load(1000)
+runner.check(rc)
+rc, flags = plain:process(bundle, 1000)
+runner.check(rc, "Error - uncompressed payload rejected by channel without compressor")
+rc, app_payload, flags = plain:accept(1000)
+runner.check(rc)
+runner.check(app_payload == payload, 'Error - incompressible payload did not match')
+rc, stats = sender:stats()
+runner.check(bp.check_stats(stats, {compressed_payloads=num_bundles}))
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 3 - compressed payload without compressor', store, src))
+payload = string.rep('X', 500)
+rc, flags = sender:store(payload, 1000)
+runner.check(rc)
+rc, bundle, flags = sender:load(1000)
+runner.check(rc)
+rc, flags = plain:process(bundle, 1000)
+runner.check(rc == false, "Error - compressed payload accepted by channel without compressor")
+runner.check(bp.check_flags(flags, {"dropped"}))
+
+-- Clean Up --
+
+sender:close()
+receiver:close()
+plain:close()
+runner.cleanup(bplib, store)
+
+-- Report Results --
+
+runner.report(bplib)
@@ -0,0 +1,71 @@
+local bplib = require("bplib")
+local runner = require("bptest")
+local bp = require("bp")
+local rd = runner.rootdir(arg[0])
+local src = runner.srcscript()
+
+-- Setup --
+
+local store = arg[1] or "RAM"
+runner.setup(bplib, store)
+
+local num_bundles = 16
+local order = {bp.COS_EXPEDITED, bp.COS_NORMAL, bp.COS_BULK}
+
+local sender = bplib.open(4, 3, 72, 43, store, {cos_scheduling=bp.SCHEDULE_STRICT})
+
+-- Test --
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 1 - store bulk first, load expedited first', store, src))
+for _,cos in ipairs({bp.COS_BULK, bp.COS_NORMAL, bp.COS_EXPEDITED}) do
+    rc = sender:setopt("CLASS_OF_SERVICE", cos)
+    runner.check(rc)
+    rc, value = sender:getopt("CLASS_OF_SERVICE")
+    runner.check(rc)
+    runner.check(value == cos)
+    for i=1,num_bundles do
+        payload = string.format('COS %d BUNDLE %d', cos, i)
+        rc, flags = sender:store(payload, 1000)
+        runner.check(rc)
+        runner.check(bp.check_flags(flags, {}), "flags set on store")
+    end
+end
+
+rc, stats = sender:stats()
+runner.check(bp.check_stats(stats, {stored_bundles=num_bundles * 3}))
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 2 - bundles loaded in priority order', store, src))
+for _,cos in ipairs(order) do
+    for i=1,num_bundles do
+        rc, bundle, flags = sender:load(1000)
+        runner.check(rc)
+        runner.check(bundle ~= nil)
+        runner.check(bp.check_flags(flags, {}), "flags set on load")
+        local expected = string.format('COS %d BUNDLE %d', cos, i)
+        runner.check(string.find(bundle, expected, 1, true) ~= nil, string.format('Error - expected %s', expected))
+    end
+end
+
+-- nothing left to load --
+rc, bundle, flags = sender:load(0)
+runner.check(rc == false)
+
+rc, stats = sender:stats()
+runner.check(bp.check_stats(stats, {active_bundles=num_bundles * 3}))
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 3 - reject unknown scheduling', store, src))
+local invalid = bplib.open(4, 3, 72, 43, store, {cos_scheduling=3})
+runner.check(invalid == nil)
+
+-- Clean Up --
+
+sender:close()
+
+runner.cleanup(bplib, store)
+
+-- Report Results --
+
+runner.report(bplib)
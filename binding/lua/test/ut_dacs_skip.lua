@@ -10,6 +10,7 @@ local store = arg[1] or "RAM"
 runner.setup(bplib, store)
 
 local cidreuse = (arg[2] == "CID_REUSE") or false
+local adaptive = (arg[2] == "ADAPTIVE") or false
 
 local src_node = 4
 local src_serv = 3
@@ -20,7 +21,7 @@ local num_bundles = 512
 local timeout = 5
 
 local sender = bplib.open(src_node, src_serv, dst_node, dst_serv, store)
-local receiver = bplib.open(dst_node, dst_serv, src_node, src_serv, store)
+local receiver = bplib.open(dst_node, dst_serv, src_node, src_serv, store, {adaptive_dacs=(adaptive and 1 or 0)})
 
 runner.check(sender:setopt("TIMEOUT", timeout))
 runner.check(sender:setopt("CID_REUSE", cidreuse))
@@ -94,7 +95,8 @@ end
 
 -- check stats --
 rc, stats = receiver:stats()
-runner.check(bp.check_stats(stats, {stored_dacs=0, transmitted_dacs=8}))
+-- (an adaptive DACS fits all 512 fills in one bundle instead of 64 fills in each of 8)
+runner.check(bp.check_stats(stats, {stored_dacs=0, transmitted_dacs=(adaptive and 1 or 8)}))
 
 -- reload timed out bundles --
 for i=1,num_bundles do
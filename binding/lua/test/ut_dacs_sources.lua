@@ -0,0 +1,110 @@
+local bplib = require("bplib")
+local runner = require("bptest")
+local bp = require("bp")
+local rd = runner.rootdir(arg[0])
+local src = runner.srcscript()
+
+-- Setup --
+
+local store = arg[1] or "RAM"
+runner.setup(bplib, store)
+
+local num_sources = 3
+local src_node = 4
+local src_serv = 3
+local dst_node = 72
+local dst_serv = 43
+
+local num_bundles = 128
+local timeout = 2
+
+local senders = {}
+for s=1,num_sources do
+    senders[s] = bplib.open(src_node + s, src_serv, dst_node, dst_serv, store)
+end
+local receiver = bplib.open(dst_node, dst_serv, src_node, src_serv, store, {max_custody_sources=num_sources})
+
+rc = receiver:setopt("DACS_RATE", timeout)
+runner.check(rc)
+
+-- Test --
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 1 - interleaved sources', store, src))
+for i=1,num_bundles do
+    for s=1,num_sources do
+        payload = string.format('HELLO WORLD %d.%d', s, i)
+
+        -- store payload --
+        rc, flags = senders[s]:store(payload, 1000)
+        runner.check(rc)
+        runner.check(bp.check_flags(flags, {}), "flags set on store")
+
+        -- load bundle --
+        rc, bundle, flags = senders[s]:load(1000)
+        runner.check(rc)
+        runner.check(bundle ~= nil)
+        runner.check(bp.check_flags(flags, {}), "flags set on load")
+
+        -- process bundle --
+        rc, flags = receiver:process(bundle, 1000)
+        runner.check(rc)
+        runner.check(bp.check_flags(flags, {}), "flags set on process")
+    end
+end
+
+-- check stats: no custody signal sent while sources are interleaved --
+rc, stats = receiver:stats()
+runner.check(bp.check_stats(stats, {received_bundles=num_bundles * num_sources, transmitted_dacs=0}))
+
+-- load one DACS per source --
+bplib.sleep(timeout)
+for s=1,num_sources do
+    rc, bundle, flags = receiver:load(1000)
+    runner.check(rc)
+    runner.check(bundle ~= nil)
+    runner.check(bp.check_flags(flags, {"routeneeded"}))
+
+    -- route DACS to its source --
+    rc, node, service = bplib.route(bundle)
+    runner.check(rc)
+    runner.check(node > src_node and node <= src_node + num_sources, string.format('Error - DACS sent to %d', node))
+    runner.check(service == src_serv)
+
+    -- process DACS --
+    rc, flags = senders[node - src_node]:process(bundle, 1000)
+    runner.check(rc, string.format('Error - failed to process DACS: %s', rc))
+    runner.check(bp.check_flags(flags, {}))
+end
+
+-- no more DACS --
+rc, bundle, flags = receiver:load(0)
+runner.check(rc == false)
+
+-- check stats --
+for s=1,num_sources do
+    rc, stats = senders[s]:stats()
+    runner.check(bp.check_stats(stats, {stored_bundles=0, active_bundles=0, acknowledged_bundles=num_bundles, received_dacs=1}))
+end
+rc, stats = receiver:stats()
+runner.check(bp.check_stats(stats, {transmitted_dacs=num_sources}))
+
+-- drain payloads --
+for i=1,num_bundles * num_sources do
+    rc, payload, flags = receiver:accept(1000)
+    runner.check(rc)
+    runner.check(bp.check_flags(flags, {}))
+end
+
+-- Clean Up --
+
+for s=1,num_sources do
+    senders[s]:close()
+end
+receiver:close()
+
+runner.cleanup(bplib, store)
+
+-- Report Results --
+
+runner.report(bplib)
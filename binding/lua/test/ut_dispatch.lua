@@ -0,0 +1,105 @@
+local bplib = require("bplib")
+local runner = require("bptest")
+local bp = require("bp")
+local rd = runner.rootdir(arg[0])
+local src = runner.srcscript()
+
+-- Setup --
+
+local store = arg[1] or "RAM"
+runner.setup(bplib, store)
+
+local src_node = 4
+local dst_node = 6
+local far_node = 7
+local relay_node = 5
+
+local num_bundles = 20
+
+local sender3 = bplib.open(src_node, 3, dst_node, 3, store, {request_custody=false})
+local sender4 = bplib.open(src_node, 4, dst_node, 4, store, {request_custody=false})
+local sender7 = bplib.open(src_node, 5, far_node, 3, store, {request_custody=false})
+local node_rx = bplib.open(dst_node, 3, src_node, 3, store, {request_custody=false})
+local serv_rx = bplib.open(dst_node, 4, src_node, 4, store, {request_custody=false})
+local relay = bplib.open(relay_node, 3, far_node, 3, store, {request_custody=false})
+
+-- Helpers --
+
+local function dispatch(sender, payload)
+    rc, flags = sender:store(payload, 1000)
+    runner.check(rc)
+    rc, bundle, flags = sender:load(1000)
+    runner.check(rc)
+    runner.check(bundle ~= nil)
+    return bundle, bplib.dispatch(bundle, 1000)
+end
+
+-- Test --
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 1 - narrowest rule wins', store, src))
+runner.check(relay:addroute(0, 0xFFFFFFFF))
+runner.check(node_rx:addroute(dst_node, dst_node))
+runner.check(serv_rx:addroute(dst_node, dst_node, 4, 4))
+for i=1,num_bundles do
+    bundle, rc, flags = dispatch(sender3, string.format('SERVICE 3 %d', i))
+    runner.check(rc)
+    runner.check(bp.check_flags(flags, {}), "flags set on dispatch")
+    bundle, rc, flags = dispatch(sender4, string.format('SERVICE 4 %d', i))
+    runner.check(rc)
+    runner.check(bp.check_flags(flags, {}), "flags set on dispatch")
+end
+for i=1,num_bundles do
+    rc, payload, flags = node_rx:accept(1000)
+    runner.check(rc)
+    runner.check(payload == string.format('SERVICE 3 %d', i), string.format('Error - received %s', tostring(payload)))
+    rc, payload, flags = serv_rx:accept(1000)
+    runner.check(rc)
+    runner.check(payload == string.format('SERVICE 4 %d', i), string.format('Error - received %s', tostring(payload)))
+end
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 2 - default rule forwards other nodes', store, src))
+for i=1,num_bundles do
+    bundle, rc, flags = dispatch(sender7, string.format('FORWARDED %d', i))
+    runner.check(rc)
+    runner.check(bp.check_flags(flags, {}), "flags set on dispatch")
+    rc, bundle, flags = relay:load(1000)
+    runner.check(rc)
+    rc, node, service = bplib.route(bundle)
+    runner.check(rc)
+    runner.check(node == far_node, string.format('Error - bundle %d sent to %d', i, node))
+end
+rc, stats = relay:stats()
+runner.check(bp.check_stats(stats, {forwarded_bundles=num_bundles}))
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 3 - no route', store, src))
+runner.check(relay:delroute())
+bundle, rc, flags = dispatch(sender7, 'UNROUTED')
+runner.check(rc == false)
+runner.check(bp.check_flags(flags, {"noroute"}), "no route flag not set")
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 4 - closing a channel removes its rules', store, src))
+serv_rx:close()
+bundle, rc, flags = dispatch(sender4, 'CLOSED')
+runner.check(rc == false)
+runner.check(bp.check_flags(flags, {"routeneeded"}), "bundle not dispatched to node rule")
+node_rx:close()
+rc, flags = bplib.dispatch(bundle, 1000)
+runner.check(rc == false)
+runner.check(bp.check_flags(flags, {"noroute"}), "no route flag not set")
+
+-- Clean Up --
+
+sender3:close()
+sender4:close()
+sender7:close()
+relay:close()
+
+runner.cleanup(bplib, store)
+
+-- Report Results --
+
+runner.report(bplib)
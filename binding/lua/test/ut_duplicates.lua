@@ -0,0 +1,95 @@
+local bplib = require("bplib")
+local runner = require("bptest")
+local bp = require("bp")
+local rd = runner.rootdir(arg[0])
+local src = runner.srcscript()
+
+-- Setup --
+
+local store = arg[1] or "RAM"
+runner.setup(bplib, store)
+
+local src_node = 4
+local src_serv = 3
+local dst_node = 72
+local dst_serv = 43
+
+local num_payloads = 10
+local timeout = 1
+
+local sender = bplib.open(src_node, src_serv, dst_node, dst_serv, store, {request_custody=1})
+local receiver = bplib.open(dst_node, dst_serv, src_node, src_serv, store, {duplicate_window=64})
+local plain = bplib.open(dst_node, dst_serv, src_node, src_serv, store)
+
+rc = receiver:setopt("DACS_RATE", timeout)
+runner.check(rc)
+
+-- Test --
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 1 - duplicate bundles acknowledged but not stored', store, src))
+local bundles = {}
+for i=1,num_payloads do
+    payload = string.format('DUPLICATE %d', i)
+    rc, flags = sender:store(payload, 1000)
+    runner.check(rc)
+    rc, bundle, flags = sender:load(1000)
+    runner.check(rc)
+    bundles[i] = bundle
+end
+
+-- process every bundle twice --
+for i=1,num_payloads do
+    for copy=1,2 do
+        rc, flags = receiver:process(bundles[i], 1000)
+        runner.check(rc)
+        runner.check(bp.check_flags(flags, {}), "flags set on process")
+    end
+end
+
+-- accept each payload once --
+for i=1,num_payloads do
+    rc, app_payload, flags = receiver:accept(1000)
+    runner.check(rc)
+    runner.check(app_payload == string.format('DUPLICATE %d', i), string.format('Error - payload %d did not match', i))
+end
+rc, app_payload, flags = receiver:accept(0)
+runner.check(rc == false, 'Error - duplicate payload accepted')
+
+-- acknowledge all bundles --
+bplib.sleep(timeout)
+rc, dacs, flags = receiver:load(1000)
+runner.check(rc)
+runner.check(bp.check_flags(flags, {"routeneeded"}))
+rc, flags = sender:process(dacs, 1000)
+runner.check(rc)
+
+-- check stats --
+rc, stats = receiver:stats()
+runner.check(bp.check_stats(stats, {received_bundles=num_payloads, duplicate_bundles=num_payloads,
+                                    delivered_payloads=num_payloads, stored_payloads=0}))
+rc, stats = sender:stats()
+runner.check(bp.check_stats(stats, {acknowledged_bundles=num_payloads, active_bundles=0}))
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 2 - duplicate bundles stored without a duplicate window', store, src))
+for copy=1,2 do
+    rc, flags = plain:process(bundles[1], 1000)
+    runner.check(rc)
+    rc, app_payload, flags = plain:accept(1000)
+    runner.check(rc)
+    runner.check(app_payload == 'DUPLICATE 1', 'Error - payload did not match')
+end
+rc, stats = plain:stats()
+runner.check(bp.check_stats(stats, {received_bundles=2, duplicate_bundles=0, delivered_payloads=2}))
+
+-- Clean Up --
+
+sender:close()
+receiver:close()
+plain:close()
+runner.cleanup(bplib, store)
+
+-- Report Results --
+
+runner.report(bplib)
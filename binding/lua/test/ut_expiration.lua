@@ -19,10 +19,12 @@ local lifetime = 5
 
 local sender = bplib.open(src_node, src_serv, dst_node, dst_serv, store)
 local receiver = bplib.open(dst_node, dst_serv, src_node, src_serv, store)
+local swept = bplib.open(src_node, src_serv + 1, dst_node, dst_serv, store, {sweep_rate=1})
 
 runner.check(sender:setopt("TIMEOUT", timeout))
 runner.check(sender:setopt("LIFETIME", lifetime))
 runner.check(receiver:setopt("DACS_RATE", timeout/2))
+runner.check(swept:setopt("LIFETIME", lifetime))
 
 -- Test --
 
@@ -161,11 +163,39 @@ runner.check(bp.check_flags(flags, {}))
 rc, stats = sender:stats()
 runner.check(bp.check_stats(stats, {expired=6}))
 
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 5 - expired swept', store, src))
+
+-- store payloads, the last outliving the others --
+for i=1,3 do
+    if i == 3 then runner.check(swept:setopt("LIFETIME", lifetime * 10)) end
+    rc, flags = swept:store(string.format('TEST 5.%d', i), 1000)
+    runner.check(rc)
+    runner.check(bp.check_flags(flags, {}))
+end
+
+-- sweep expired bundles without loading --
+bplib.sleep(lifetime)
+rc, tick_timeout, flags = bplib.tick()
+runner.check(rc)
+runner.check(tick_timeout <= 1000, string.format('Error - next tick in %d ms', tick_timeout))
+rc, stats = swept:stats()
+runner.check(bp.check_stats(stats, {expired=2, stored_bundles=1}))
+
+-- load bundle left at head --
+rc, bundle, flags = swept:load(1000)
+runner.check(rc)
+runner.check(bundle ~= nil)
+rc, stats = swept:stats()
+runner.check(bp.check_stats(stats, {expired=2, transmitted_bundles=1}))
+
 -- Clean Up --
 
 sender:flush()
 sender:close()
 receiver:close()
+swept:flush()
+swept:close()
 
 runner.cleanup(bplib, store)
 
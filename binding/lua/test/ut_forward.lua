@@ -0,0 +1,88 @@
+local bplib = require("bplib")
+local runner = require("bptest")
+local bp = require("bp")
+local rd = runner.rootdir(arg[0])
+local src = runner.srcscript()
+
+-- Setup --
+
+local store = arg[1] or "RAM"
+runner.setup(bplib, store)
+
+local src_node = 4
+local relay_node = 5
+local dst_node = 6
+local serv = 3
+
+local num_bundles = 50
+
+local sender = bplib.open(src_node, serv, dst_node, serv, store, {request_custody=false})
+local relay = bplib.open(relay_node, serv, dst_node, serv, store, {request_custody=false})
+local receiver = bplib.open(dst_node, serv, relay_node, serv, store, {request_custody=false})
+
+-- Test --
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 1 - forwarded bundles interleaved with stored payloads', store, src))
+for i=1,num_bundles do
+
+    -- forward bundle through relay --
+    rc, flags = sender:store(string.format('FORWARDED %d', i), 1000)
+    runner.check(rc)
+    rc, bundle, flags = sender:load(1000)
+    runner.check(rc)
+    runner.check(bundle ~= nil)
+    rc, flags = relay:process(bundle, 1000)
+    runner.check(rc)
+    runner.check(bp.check_flags(flags, {}), "flags set on forward")
+
+    -- store payload on relay, changing its bundle attributes half way --
+    rc, flags = relay:store(string.format('LOCAL %d', i), 1000)
+    runner.check(rc)
+    runner.check(bp.check_flags(flags, {}), "flags set on store")
+    if i == num_bundles / 2 then
+        rc = relay:setopt("LIFETIME", 1000)
+        runner.check(rc)
+    end
+end
+
+-- deliver relay bundles --
+for i=1,num_bundles * 2 do
+    rc, bundle, flags = relay:load(1000)
+    runner.check(rc)
+    runner.check(bundle ~= nil)
+    rc, node, service = bplib.route(bundle)
+    runner.check(rc)
+    runner.check(node == dst_node, string.format('Error - bundle %d sent to %d', i, node))
+    rc, flags = receiver:process(bundle, 1000)
+    runner.check(rc)
+    runner.check(bp.check_flags(flags, {}), "flags set on process")
+end
+
+-- accept payloads in order --
+for i=1,num_bundles do
+    rc, payload, flags = receiver:accept(1000)
+    runner.check(rc)
+    runner.check(payload == string.format('FORWARDED %d', i), string.format('Error - received %s', tostring(payload)))
+    rc, payload, flags = receiver:accept(1000)
+    runner.check(rc)
+    runner.check(payload == string.format('LOCAL %d', i), string.format('Error - received %s', tostring(payload)))
+end
+
+-- check stats --
+rc, stats = relay:stats()
+runner.check(bp.check_stats(stats, {forwarded_bundles=num_bundles}))
+rc, stats = receiver:stats()
+runner.check(bp.check_stats(stats, {received_bundles=num_bundles * 2, delivered_payloads=num_bundles * 2}))
+
+-- Clean Up --
+
+sender:close()
+relay:close()
+receiver:close()
+
+runner.cleanup(bplib, store)
+
+-- Report Results --
+
+runner.report(bplib)
@@ -97,6 +97,18 @@ check_option("CID_REUSE", false, true, "organ")
 print(string.format('%s/%s: Test 11 - acs rate', store, src))
 check_option("DACS_RATE", dflt_dacsrate, 60, "tea")
 
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 12 - load rate bytes', store, src))
+check_option("LOAD_RATE_BYTES", 0, 125000, -1)
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 13 - load rate bundles', store, src))
+check_option("LOAD_RATE_BUNDLES", 0, 100, -1)
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 14 - retransmission share', store, src))
+check_option("RETX_SHARE", 50, 25, 0)
+
 -- Clean Up --
 
 ch:close()
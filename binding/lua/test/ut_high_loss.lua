@@ -10,6 +10,7 @@ local store = arg[1] or "RAM"
 runner.setup(bplib, store)
 
 local num_bundles = arg[2] or 256
+local aggregation = arg[3] or "RANGES"
 
 local src_node = 4
 local src_serv = 3
@@ -20,7 +21,11 @@ local timeout = 2
 local cidreuse = false
 
 local sender = bplib.open(src_node, src_serv, dst_node, dst_serv, store)
-local receiver = bplib.open(dst_node, dst_serv, src_node, src_serv, store)
+local receiver_attributes = {custody_aggregation=bp.CUSTODY_RANGES}
+if aggregation == "BITMAP" then
+	receiver_attributes.custody_aggregation = bp.CUSTODY_BITMAP
+end
+local receiver = bplib.open(dst_node, dst_serv, src_node, src_serv, store, receiver_attributes)
 
 runner.check(sender:setopt("TIMEOUT", timeout))
 runner.check(sender:setopt("CID_REUSE", cidreuse))
@@ -32,7 +37,7 @@ local stored_payloads = 0
 -- Test --
 
 -----------------------------------------------------------------------
-print(string.format('%s/%s: Test 1 - higher input rate', store, src))
+print(string.format('%s/%s: Test 1 - higher input rate (%s)', store, src, aggregation))
 for k=1,num_bundles do
 	for i=1,k do
 		payload = string.format('HELLO WORLD %d.%d', k, i)
@@ -47,6 +47,41 @@ print(string.format('After Close: %8d %8d', currmem, highmem))
 runner.check(highmem ~= 0, "No memory allocated")
 runner.check(currmem == start_currmem, "Memory not cleaned up")
 
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 2 - memory charged to channel by subsystem', store, src))
+
+start_currmem, start_highmem, start_subsystems = bplib.memstat()
+
+-- open channel --
+sender = bplib.open(src_node, src_serv, dst_node, dst_serv, store, {timeout=timeout})
+rc, stats = sender:stats()
+opened = stats["memory"]
+runner.check(opened["active"]["used"] > 0, "Active table not charged to channel")
+runner.check(opened["custody"]["used"] > 0, "Custody tree not charged to channel")
+runner.check(opened["dacs"]["used"] > 0, "DACS buffer not charged to channel")
+
+-- store payloads --
+for i=1,num_bundles do
+    payload = string.format('HELLO WORLD %d', i)
+    rc, flags = sender:store(payload, 1000)
+end
+rc, stats = sender:stats()
+stored = stats["memory"]
+runner.check(stored["ram"]["used"] > opened["ram"]["used"], "Stored bundles not charged to channel")
+runner.check(stored["high"] >= stored["used"], "High water mark below memory in use")
+currmem, highmem, subsystems = bplib.memstat()
+runner.check(currmem - start_currmem >= stored["used"], "Channel charged more than was allocated")
+runner.check(subsystems["ram"]["used"] - start_subsystems["ram"]["used"] == stored["ram"]["used"], "Storage not charged to channel")
+
+-- close channel --
+sender:close()
+currmem, highmem, subsystems = bplib.memstat()
+for name,subsystem in pairs(subsystems) do
+    if type(subsystem) == "table" then
+        runner.check(subsystem["used"] == start_subsystems[name]["used"], string.format('Memory of %s not cleaned up', name))
+    end
+end
+
 -- Clean Up --
 
 runner.cleanup(bplib, store)
@@ -0,0 +1,88 @@
+local bplib = require("bplib")
+local runner = require("bptest")
+local bp = require("bp")
+local rd = runner.rootdir(arg[0])
+local src = runner.srcscript()
+
+-- Setup --
+
+local store = arg[1] or "RAM"
+runner.setup(bplib, store)
+
+local rate = 100 -- bundles per second
+local burst = 10 -- bundles loaded in BPLIB_PACING_BURST_MS at rate
+local num_bundles = 20
+local timeout = 1
+
+local sender = bplib.open(4, 3, 72, 43, store, {timeout=timeout, load_rate_bundles=rate, retx_share=25})
+
+-- Test --
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 1 - burst then paced', store, src))
+for i=1,num_bundles do
+    rc, flags = sender:store(string.format('OLD %d', i), 1000)
+    runner.check(rc)
+    runner.check(bp.check_flags(flags, {}), "flags set on store")
+end
+
+-- only a burst can be loaded without waiting --
+for i=1,burst do
+    rc, bundle, flags = sender:load(0)
+    runner.check(rc)
+    runner.check(bundle ~= nil)
+end
+rc, bundle, flags = sender:load(0)
+runner.check(rc == false)
+
+-- the rest are loaded at the rate --
+for i=burst+1,num_bundles do
+    rc, bundle, flags = sender:load(1000)
+    runner.check(rc)
+    runner.check(bundle ~= nil)
+    runner.check(bp.check_flags(flags, {}), "flags set on load")
+end
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 2 - retransmissions share rate with new bundles', store, src))
+bplib.sleep(timeout + 1)
+for i=1,num_bundles do
+    rc, flags = sender:store(string.format('NEW %d', i), 1000)
+    runner.check(rc)
+end
+
+-- new bundles take most of the rate while both are waiting --
+local num_new = 0
+for i=1,num_bundles do
+    rc, bundle, flags = sender:load(1000)
+    runner.check(rc)
+    runner.check(bundle ~= nil)
+    if string.find(bundle, 'NEW', 1, true) then
+        num_new = num_new + 1
+    end
+end
+runner.check(num_new > num_bundles / 2, string.format('Error - only %d new bundles loaded', num_new))
+
+-- timed-out bundles go out once there are no new ones --
+for i=1,num_bundles do
+    rc, bundle, flags = sender:load(1000)
+    runner.check(rc)
+    runner.check(bundle ~= nil)
+end
+rc, stats = sender:stats()
+runner.check(bp.check_stats(stats, {transmitted_bundles=num_bundles * 2, retransmitted_bundles=num_bundles}))
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 3 - reject retransmission share', store, src))
+local invalid = bplib.open(4, 3, 72, 43, store, {retx_share=0})
+runner.check(invalid == nil)
+
+-- Clean Up --
+
+sender:close()
+
+runner.cleanup(bplib, store)
+
+-- Report Results --
+
+runner.report(bplib)
@@ -0,0 +1,91 @@
+local bplib = require("bplib")
+local runner = require("bptest")
+local bp = require("bp")
+local rd = runner.rootdir(arg[0])
+local src = runner.srcscript()
+
+-- Setup --
+
+local store = arg[1] or "RAM"
+runner.setup(bplib, store)
+
+local src_node = 4
+local src_serv = 3
+local dst_node = 72
+local dst_serv = 43
+
+local num_payloads = 5
+
+local sender = bplib.open(src_node, src_serv, dst_node, dst_serv, store, {allow_fragmentation=1, max_length=256})
+local receiver = bplib.open(dst_node, dst_serv, src_node, src_serv, store, {reassembly_slots=2, max_adu_length=4096})
+local plain = bplib.open(dst_node, dst_serv, src_node, src_serv, store)
+
+-- Test --
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 1 - fragments reassembled out of order', store, src))
+local num_fragments = 0
+for i=1,num_payloads do
+    payload = string.rep(string.format('ADU %d ', i), 200)
+
+    -- store payload --
+    rc, flags = sender:store(payload, 1000)
+    runner.check(rc)
+
+    -- load fragments --
+    local bundles = {}
+    while true do
+        rc, bundle, flags = sender:load(0)
+        if not rc then break end
+        runner.check(#bundle <= 256, string.format('Error - fragment of %d bytes', #bundle))
+        table.insert(bundles, bundle)
+    end
+    runner.check(#bundles > 1, 'Error - payload not fragmented')
+    num_fragments = num_fragments + #bundles
+
+    -- process fragments last to first --
+    for j=#bundles,1,-1 do
+        rc, flags = receiver:process(bundles[j], 1000)
+        runner.check(rc)
+        runner.check(bp.check_flags(flags, {}), "flags set on process")
+    end
+
+    -- accept whole payload --
+    rc, app_payload, flags = receiver:accept(1000)
+    runner.check(rc)
+    runner.check(app_payload == payload, string.format('Error - payload %d did not match', i))
+end
+
+-- check stats --
+rc, stats = receiver:stats()
+runner.check(bp.check_stats(stats, {received_bundles=num_fragments, reassembled_payloads=num_payloads,
+                                    delivered_payloads=num_payloads}))
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 2 - fragments accepted without reassembly', store, src))
+payload = string.rep('Z', 600)
+rc, flags = sender:store(payload, 1000)
+runner.check(rc)
+local fragments = ''
+while true do
+    rc, bundle, flags = sender:load(0)
+    if not rc then break end
+    rc, flags = plain:process(bundle, 1000)
+    runner.check(rc)
+    rc, app_payload, flags = plain:accept(1000)
+    runner.check(rc)
+    runner.check(#app_payload < #payload, 'Error - fragment reassembled by channel without reassembly slots')
+    fragments = fragments .. app_payload
+end
+runner.check(fragments == payload, 'Error - fragments did not make up payload')
+
+-- Clean Up --
+
+sender:close()
+receiver:close()
+plain:close()
+runner.cleanup(bplib, store)
+
+-- Report Results --
+
+runner.report(bplib)
@@ -0,0 +1,83 @@
+local bplib = require("bplib")
+local runner = require("bptest")
+local bp = require("bp")
+local rd = runner.rootdir(arg[0])
+local src = runner.srcscript()
+
+-- Setup --
+
+local store = arg[1] or "RAM"
+runner.setup(bplib, store)
+
+local src_node = 4
+local src_serv = 3
+local dst_node = 72
+local dst_serv = 43
+
+local sender = bplib.open(src_node, src_serv, dst_node, dst_serv, store, {allow_fragmentation=1, max_length=512})
+local receiver = bplib.open(dst_node, dst_serv, src_node, src_serv, store, {reassembly_slots=1, max_adu_length=16384})
+
+-- Test --
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 1 - bundles queued as payload is written', store, src))
+local payload = ''
+for i=1,1000 do
+    payload = payload .. string.format('%04d', i)
+end
+
+rc, flags = sender:stream_open(#payload)
+runner.check(rc)
+
+-- first write fills bundles that can be loaded before the payload is finished --
+rc, flags = sender:stream_write(string.sub(payload, 1, 1500), 1000)
+runner.check(rc)
+rc, bundle, flags = sender:load(0)
+runner.check(rc, 'Error - no bundle queued by first write')
+rc, flags = receiver:process(bundle, 1000)
+runner.check(rc)
+
+-- remaining payload in small pieces --
+local offset = 1500
+while offset < #payload do
+    rc, flags = sender:stream_write(string.sub(payload, offset + 1, offset + 97), 1000)
+    runner.check(rc)
+    offset = offset + 97
+end
+rc, flags = sender:stream_close()
+runner.check(rc)
+
+while true do
+    rc, bundle, flags = sender:load(0)
+    if not rc then break end
+    runner.check(#bundle <= 512, string.format('Error - bundle of %d bytes', #bundle))
+    rc, flags = receiver:process(bundle, 1000)
+    runner.check(rc)
+end
+
+rc, app_payload, flags = receiver:accept(1000)
+runner.check(rc)
+runner.check(app_payload == payload, 'Error - streamed payload did not match')
+
+-----------------------------------------------------------------------
+print(string.format('%s/%s: Test 2 - misuse', store, src))
+rc, flags = sender:stream_write('data', 1000)
+runner.check(rc == false, 'Error - write accepted without open stream')
+rc, flags = sender:stream_open(10)
+runner.check(rc)
+rc, flags = sender:stream_write('more than ten bytes', 1000)
+runner.check(rc == false, 'Error - write past end of stream accepted')
+rc, flags = sender:stream_write('short', 1000)
+runner.check(rc)
+rc, flags = sender:stream_close()
+runner.check(rc == false, 'Error - incomplete stream closed without error')
+
+-- Clean Up --
+
+sender:close()
+receiver:close()
+runner.cleanup(bplib, store)
+
+-- Report Results --
+
+runner.report(bplib)
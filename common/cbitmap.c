@@ -0,0 +1,377 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "bplib.h"
+#include "bplib_os.h"
+#include "bundle_types.h"
+#include "cbitmap.h"
+
+/******************************************************************************
+ LOCAL FUNCTIONS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * count_trailing_zeros - word must be non-zero
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int count_trailing_zeros(uint64_t word)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll(word);
+#else
+    int count = 0;
+    while ((word & 1) == 0)
+    {
+        word >>= 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * find_set_bit - returns first set bit at or after from, CBITMAP_BLOCK_BITS if none
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int find_set_bit(cbitmap_block_t *block, int from)
+{
+    int      w    = from / 64;
+    uint64_t word = block->bits[w] & (~(uint64_t)0 << (from % 64));
+    while (word == 0)
+    {
+        if (++w == CBITMAP_BLOCK_WORDS)
+        {
+            return CBITMAP_BLOCK_BITS;
+        }
+        word = block->bits[w];
+    }
+    return (w * 64) + count_trailing_zeros(word);
+}
+
+/*----------------------------------------------------------------------------
+ * find_clear_bit - returns first clear bit at or after from, CBITMAP_BLOCK_BITS if none
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int find_clear_bit(cbitmap_block_t *block, int from)
+{
+    int      w    = from / 64;
+    uint64_t word = ~block->bits[w] & (~(uint64_t)0 << (from % 64));
+    while (word == 0)
+    {
+        if (++w == CBITMAP_BLOCK_WORDS)
+        {
+            return CBITMAP_BLOCK_BITS;
+        }
+        word = ~block->bits[w];
+    }
+    return (w * 64) + count_trailing_zeros(word);
+}
+
+/*----------------------------------------------------------------------------
+ * clear_bits - clears bits in [from, to)
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void clear_bits(cbitmap_block_t *block, int from, int to)
+{
+    while (from < to)
+    {
+        int      w    = from / 64;
+        int      hi   = (to - (w * 64)) < 64 ? (to - (w * 64)) : 64;
+        uint64_t mask = ~(uint64_t)0 << (from % 64);
+        if (hi < 64)
+        {
+            mask &= ((uint64_t)1 << hi) - 1;
+        }
+        block->bits[w] &= ~mask;
+        from = (w * 64) + hi;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * find_block - returns true if block found, position of block or of where it would go
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bool find_block(cbitmap_t *bitmap, bp_val_t key, int *pos)
+{
+    /* Check Last Block Used */
+    if (bitmap->last_block < bitmap->num_blocks && bitmap->keys[bitmap->last_block] == key)
+    {
+        *pos = bitmap->last_block;
+        return true;
+    }
+
+    /* Check Past Newest Block */
+    if (bitmap->num_blocks == 0 || bitmap->keys[bitmap->num_blocks - 1] < key)
+    {
+        *pos = bitmap->num_blocks;
+        return false;
+    }
+
+    /* Binary Search */
+    int lo = 0;
+    int hi = bitmap->num_blocks;
+    while (lo < hi)
+    {
+        int mid = lo + ((hi - lo) / 2);
+        if (bitmap->keys[mid] < key)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    *pos = lo;
+    return bitmap->keys[lo] == key;
+}
+
+/*----------------------------------------------------------------------------
+ * release_block - returns empty block at position to the pool
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void release_block(cbitmap_t *bitmap, int pos)
+{
+    int num_after = bitmap->num_blocks - pos - 1;
+
+    bitmap->free_slots[bitmap->num_free++] = bitmap->slots[pos];
+    memmove(&bitmap->keys[pos], &bitmap->keys[pos + 1], num_after * sizeof(bp_val_t));
+    memmove(&bitmap->slots[pos], &bitmap->slots[pos + 1], num_after * sizeof(int));
+    bitmap->num_blocks--;
+    bitmap->last_block = 0;
+}
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Create - allocates a pool of max_blocks bitmap blocks
+ *----------------------------------------------------------------------------*/
+int cbitmap_create(cbitmap_t **bitmap, int max_blocks)
+{
+    int i;
+
+    /* Check Size */
+    if (max_blocks <= 0)
+    {
+        return BP_ERROR;
+    }
+
+    /* Allocate Structure */
+    *bitmap = (cbitmap_t *)bplib_os_calloc_tag(sizeof(cbitmap_t), BP_MEM_CUSTODY);
+    if (*bitmap == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    /* Allocate Pool (blocks start out cleared and are only released once cleared) */
+    (*bitmap)->blocks     = (cbitmap_block_t *)bplib_os_calloc_tag(max_blocks * sizeof(cbitmap_block_t),
+                                                                   BP_MEM_CUSTODY);
+    (*bitmap)->keys       = (bp_val_t *)bplib_os_calloc_tag(max_blocks * sizeof(bp_val_t), BP_MEM_CUSTODY);
+    (*bitmap)->slots      = (int *)bplib_os_calloc_tag(max_blocks * sizeof(int), BP_MEM_CUSTODY);
+    (*bitmap)->free_slots = (int *)bplib_os_calloc_tag(max_blocks * sizeof(int), BP_MEM_CUSTODY);
+    if ((*bitmap)->blocks == NULL || (*bitmap)->keys == NULL || (*bitmap)->slots == NULL ||
+        (*bitmap)->free_slots == NULL)
+    {
+        cbitmap_destroy(*bitmap);
+        *bitmap = NULL;
+        return BP_ERROR;
+    }
+
+    /* Initialize Free Stack */
+    for (i = 0; i < max_blocks; i++)
+    {
+        (*bitmap)->free_slots[i] = max_blocks - i - 1;
+    }
+
+    /* Initialize Attributes */
+    (*bitmap)->num_free   = max_blocks;
+    (*bitmap)->num_blocks = 0;
+    (*bitmap)->max_blocks = max_blocks;
+    (*bitmap)->last_block = 0;
+    (*bitmap)->iter_block = 0;
+    (*bitmap)->iter_bit   = 0;
+
+    /* Return Success */
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * Destroy - frees memory associated with bitmap
+ *----------------------------------------------------------------------------*/
+int cbitmap_destroy(cbitmap_t *bitmap)
+{
+    if (bitmap)
+    {
+        if (bitmap->blocks)
+            bplib_os_free(bitmap->blocks);
+        if (bitmap->keys)
+            bplib_os_free(bitmap->keys);
+        if (bitmap->slots)
+            bplib_os_free(bitmap->slots);
+        if (bitmap->free_slots)
+            bplib_os_free(bitmap->free_slots);
+        bplib_os_free(bitmap);
+    }
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * Insert - sets the bit of a custody id
+ *
+ *  returns BP_DUPLICATE if already set, and BP_FULL if the custody id needs
+ *  a new block and the pool is empty
+ *----------------------------------------------------------------------------*/
+int cbitmap_insert(bp_val_t value, cbitmap_t *bitmap)
+{
+    bp_val_t key = value - (value % CBITMAP_BLOCK_BITS);
+    int      pos;
+
+    /* Find or Add Block */
+    if (!find_block(bitmap, key, &pos))
+    {
+        if (bitmap->num_free == 0)
+        {
+            return BP_FULL;
+        }
+
+        int num_after = bitmap->num_blocks - pos;
+        memmove(&bitmap->keys[pos + 1], &bitmap->keys[pos], num_after * sizeof(bp_val_t));
+        memmove(&bitmap->slots[pos + 1], &bitmap->slots[pos], num_after * sizeof(int));
+        bitmap->keys[pos]  = key;
+        bitmap->slots[pos] = bitmap->free_slots[--bitmap->num_free];
+        bitmap->num_blocks++;
+    }
+    bitmap->last_block = pos;
+
+    /* Set Bit */
+    cbitmap_block_t *block = &bitmap->blocks[bitmap->slots[pos]];
+    int              bit   = (int)(value - key);
+    uint64_t         mask  = (uint64_t)1 << (bit % 64);
+    if (block->bits[bit / 64] & mask)
+    {
+        return BP_DUPLICATE;
+    }
+    block->bits[bit / 64] |= mask;
+    block->count++;
+
+    /* Return Success */
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * Is Empty
+ *----------------------------------------------------------------------------*/
+bool cbitmap_is_empty(cbitmap_t *bitmap)
+{
+    return bitmap == NULL || bitmap->num_blocks == 0;
+}
+
+/*----------------------------------------------------------------------------
+ * Goto First - points the iterator at the lowest custody id
+ *----------------------------------------------------------------------------*/
+int cbitmap_goto_first(cbitmap_t *bitmap)
+{
+    bitmap->iter_block = 0;
+    bitmap->iter_bit   = 0;
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * Get Next - returns the next range of set bits and advances the iterator
+ *
+ *  a range continues across blocks of consecutive keys; when popping, the
+ *  bits are cleared and blocks left empty are returned to the pool.
+ *  should_rebalance is accepted for compatibility with rb_tree_get_next
+ *----------------------------------------------------------------------------*/
+int cbitmap_get_next(cbitmap_t *bitmap, rb_range_t *range, bool should_pop, bool should_rebalance)
+{
+    (void)should_rebalance;
+
+    /* Find Start of Range */
+    int bit = CBITMAP_BLOCK_BITS;
+    while (bitmap->iter_block < bitmap->num_blocks)
+    {
+        bit = find_set_bit(&bitmap->blocks[bitmap->slots[bitmap->iter_block]], bitmap->iter_bit);
+        if (bit < CBITMAP_BLOCK_BITS)
+        {
+            break;
+        }
+        bitmap->iter_block++;
+        bitmap->iter_bit = 0;
+    }
+
+    /* Check End of Bitmap */
+    if (bitmap->iter_block >= bitmap->num_blocks)
+    {
+        return BP_ERROR;
+    }
+
+    /* Find End of Range */
+    bp_val_t start  = bitmap->keys[bitmap->iter_block] + bit;
+    bp_val_t length = 0;
+    while (true)
+    {
+        cbitmap_block_t *block = &bitmap->blocks[bitmap->slots[bitmap->iter_block]];
+        bp_val_t         key   = bitmap->keys[bitmap->iter_block];
+        int              end   = find_clear_bit(block, bit);
+
+        length += end - bit;
+        bitmap->iter_bit = end;
+        if (should_pop)
+        {
+            clear_bits(block, bit, end);
+            block->count -= end - bit;
+        }
+
+        /* Check if Range Continues in Next Block */
+        int  next       = bitmap->iter_block + 1;
+        bool contiguous = (end == CBITMAP_BLOCK_BITS) && (next < bitmap->num_blocks) &&
+                          (bitmap->keys[next] == key + CBITMAP_BLOCK_BITS) &&
+                          (bitmap->blocks[bitmap->slots[next]].bits[0] & 1);
+
+        /* Advance Iterator */
+        if (should_pop && block->count == 0)
+        {
+            release_block(bitmap, bitmap->iter_block); /* next block moves into position */
+            bitmap->iter_bit = 0;
+        }
+        else if (end == CBITMAP_BLOCK_BITS)
+        {
+            bitmap->iter_block++;
+            bitmap->iter_bit = 0;
+        }
+
+        if (!contiguous)
+        {
+            break;
+        }
+        bit = 0;
+    }
+
+    /* Return Range */
+    range->value  = start;
+    range->offset = length - 1;
+
+    return BP_SUCCESS;
+}
@@ -0,0 +1,93 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef CBITMAP_H
+#define CBITMAP_H
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include "bplib.h"
+#include "rb_tree.h"
+
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+/* Number of Custody IDs per Bitmap Block (Compile-Time Option): must be a multiple of 64 */
+#ifndef CBITMAP_BLOCK_BITS
+#define CBITMAP_BLOCK_BITS 1024
+#endif
+
+#define CBITMAP_BLOCK_WORDS (CBITMAP_BLOCK_BITS / 64)
+
+/******************************************************************************
+ TYPEDEFS
+ ******************************************************************************/
+
+/* Bitmap Block - one bit per custody id, set when custody is held */
+typedef struct
+{
+    uint64_t bits[CBITMAP_BLOCK_WORDS];
+    int      count; /* number of bits set */
+} cbitmap_block_t;
+
+/*
+ * Compressed Bitmap
+ *
+ *  only the blocks of custody ids that have been received are allocated, from a
+ *  fixed pool, and the keys of the blocks in use are kept sorted in their own
+ *  array so finding a block is a binary search over contiguous memory (with a
+ *  check of the last block used first since custody ids mostly arrive in order)
+ */
+typedef struct
+{
+    cbitmap_block_t *blocks;     /* pool of bitmap blocks */
+    bp_val_t        *keys;       /* first custody id of each block in use, sorted */
+    int             *slots;      /* pool index of each block in use, same order as keys */
+    int             *free_slots; /* stack of unused pool indices */
+    int              num_free;   /* number of unused blocks on the free stack */
+    int              num_blocks; /* number of blocks in use */
+    int              max_blocks; /* size of the pool */
+    int              last_block; /* position in keys of the block last inserted into */
+    int              iter_block; /* position in keys of the iterator */
+    int              iter_bit;   /* bit in block of the iterator */
+} cbitmap_t;
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+/* Compressed Bitmap API
+ *
+ * NOTE: The insert, iterate, and empty checks mirror the rb_tree API so that either can aggregate custody
+ *       for a DACS; the ranges returned are in the same rb_range_t form.  Inserting while iterating is not
+ *       supported.
+ */
+
+int  cbitmap_create(cbitmap_t **bitmap, int max_blocks);
+int  cbitmap_destroy(cbitmap_t *bitmap);
+int  cbitmap_insert(bp_val_t value, cbitmap_t *bitmap);
+bool cbitmap_is_empty(cbitmap_t *bitmap);
+int  cbitmap_goto_first(cbitmap_t *bitmap);
+int  cbitmap_get_next(cbitmap_t *bitmap, rb_range_t *range, bool should_pop, bool should_rebalance);
+
+#endif /* CBITMAP_H */
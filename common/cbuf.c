@@ -45,10 +45,10 @@ int cbuf_create(cbuf_t **cbuf, int size)
     if (size > 0)
     {
         /* Allocate Structure */
-        *cbuf = (cbuf_t *)bplib_os_calloc(sizeof(cbuf_t));
+        *cbuf = (cbuf_t *)bplib_os_calloc_tag(sizeof(cbuf_t), BP_MEM_ACTIVE);
 
         /* Allocate Circular Buffer */
-        (*cbuf)->table = (bp_active_bundle_t *)bplib_os_calloc(sizeof(bp_active_bundle_t) * size);
+        (*cbuf)->table = (bp_active_bundle_t *)bplib_os_calloc_tag(sizeof(bp_active_bundle_t) * size, BP_MEM_ACTIVE);
         if ((*cbuf)->table == NULL)
             return BP_ERROR;
     }
@@ -147,6 +147,34 @@ int cbuf_remove(cbuf_t *cbuf, bp_val_t cid, bp_active_bundle_t *bundle)
     return BP_ERROR;
 }
 
+/*----------------------------------------------------------------------------
+ * Remove Range - removes bundles with custody ids in [cid, cid + count)
+ *
+ *  each slot is visited at most once, so the cost is bounded by the smaller
+ *  of the range and the size of the buffer; returns number of bundles removed
+ *----------------------------------------------------------------------------*/
+int cbuf_remove_range(cbuf_t *cbuf, bp_val_t cid, bp_val_t count, bp_removed_func_t removed, void *parm)
+{
+    bp_val_t slots       = count < cbuf->size ? count : cbuf->size;
+    int      num_removed = 0;
+    bp_val_t i;
+
+    for (i = 0; i < slots; i++)
+    {
+        bp_index_t ati = (cid + i) % cbuf->size;
+        if ((cbuf->table[ati].sid != BP_SID_VACANT) && (cbuf->table[ati].cid - cid < count))
+        {
+            if (removed)
+                removed(parm, &cbuf->table[ati]);
+            cbuf->table[ati].sid = BP_SID_VACANT;
+            cbuf->num_entries--;
+            num_removed++;
+        }
+    }
+
+    return num_removed;
+}
+
 /*----------------------------------------------------------------------------
  * Available - checks if the provided CID can be added
  *----------------------------------------------------------------------------*/
@@ -170,3 +198,63 @@ int cbuf_count(cbuf_t *cbuf)
 {
     return cbuf->num_entries;
 }
+
+/*----------------------------------------------------------------------------
+ * Resize - lays out the entries in a circular buffer of a new size
+ *
+ *  entries are placed by custody id, so the new size must cover the custody
+ *  ids from the oldest entry to the newest; the buffer is left as it was if
+ *  it does not or the new buffer cannot be allocated
+ *----------------------------------------------------------------------------*/
+int cbuf_resize(cbuf_t *cbuf, int size)
+{
+    bp_index_t i;
+
+    /* Check Buffer Size */
+    if (size <= 0 || (unsigned long)size > BP_MAX_INDEX || cbuf->size == 0)
+    {
+        return BP_ERROR;
+    }
+
+    /* Find Span of Custody IDs from Oldest Entry */
+    bp_val_t span = 0;
+    for (i = 0; i < cbuf->size; i++)
+    {
+        if ((cbuf->table[i].sid != BP_SID_VACANT) && (cbuf->newest_cid - cbuf->table[i].cid > span))
+        {
+            span = cbuf->newest_cid - cbuf->table[i].cid;
+        }
+    }
+
+    /* Check Custody IDs Fit */
+    if (span > (bp_val_t)size)
+    {
+        return BP_ERROR;
+    }
+
+    /* Allocate Resized Circular Buffer */
+    bp_active_bundle_t *table = (bp_active_bundle_t *)bplib_os_calloc_tag(sizeof(bp_active_bundle_t) * size,
+                                                                          BP_MEM_ACTIVE);
+    if (table == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    /* Lay Out Entries by Custody ID */
+    for (i = 0; i < cbuf->size; i++)
+    {
+        if (cbuf->table[i].sid != BP_SID_VACANT)
+        {
+            table[cbuf->table[i].cid % size] = cbuf->table[i];
+        }
+    }
+
+    /* Replace Circular Buffer */
+    bplib_os_free(cbuf->table);
+    cbuf->table      = table;
+    cbuf->size       = size;
+    cbuf->oldest_cid = cbuf->newest_cid - span;
+
+    /* Return Success */
+    return BP_SUCCESS;
+}
@@ -51,7 +51,9 @@ int cbuf_destroy(cbuf_t *cbuf);
 int cbuf_add(cbuf_t *cbuf, bp_active_bundle_t bundle, bool overwrite);
 int cbuf_next(cbuf_t *cbuf, bp_active_bundle_t *bundle);
 int cbuf_remove(cbuf_t *cbuf, bp_val_t cid, bp_active_bundle_t *bundle);
+int cbuf_remove_range(cbuf_t *cbuf, bp_val_t cid, bp_val_t count, bp_removed_func_t removed, void *parm);
 int cbuf_available(cbuf_t *cbuf, bp_val_t cid);
 int cbuf_count(cbuf_t *cbuf);
+int cbuf_resize(cbuf_t *cbuf, int size);
 
 #endif /* CBUF_H */
@@ -22,15 +22,59 @@
  INCLUDES
  ******************************************************************************/
 
+#include <string.h>
+
 #include "bplib.h"
 #include "crc.h"
 
+#if BPLIB_CRC32C_HW && defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+#if BPLIB_CRC16_X25_HW && (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <wmmintrin.h>
+#elif BPLIB_CRC16_X25_HW && defined(__aarch64__) && (defined(__ARM_FEATURE_AES) || defined(__ARM_FEATURE_CRYPTO))
+#include <arm_neon.h>
+#endif
+
 /******************************************************************************
  FILE DATA
  ******************************************************************************/
 
 #define BPLIB_CRC16_X25_POLY 0x1021U
-#define BPLIB_CRC32_C_POLY   0x1EDC6F41U
+
+/* Polynomials Bit Reversed, for Implementations that Operate on the Reflected CRC */
+#define BPLIB_CRC16_X25_REFLECTED_POLY 0x8408U
+#define BPLIB_CRC32_C_REFLECTED_POLY   0x82F63B78U
+
+/* Number of Bytes Folded into the CRC per Step of the Slicing Implementations */
+#define BPLIB_CRC_SLICES 8
+
+/* Hardware CRC32C Instruction Set Available to this Build */
+#if BPLIB_CRC32C_HW && (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define BPLIB_CRC32C_SSE42
+#elif BPLIB_CRC32C_HW && defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define BPLIB_CRC32C_ARMV8
+#endif
+
+/* Carry-Less Multiply Instruction Set Available to this Build */
+#if BPLIB_CRC16_X25_HW && (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define BPLIB_CRC16_X25_PCLMUL
+#elif BPLIB_CRC16_X25_HW && defined(__aarch64__) && (defined(__ARM_FEATURE_AES) || defined(__ARM_FEATURE_CRYPTO))
+#define BPLIB_CRC16_X25_PMULL
+#endif
+
+/* Smallest Buffer for which Folding with Carry-Less Multiplies Beats the Slicing Table */
+#define BPLIB_CRC16_X25_FOLD_MIN 64
+
+/* Bytes Folded per Carry-Less Multiply Step */
+#define BPLIB_CRC16_X25_FOLD_SIZE 16
+
+/* Independent Remainders Folded in Parallel, to Hide the Latency of the Multiplies */
+#define BPLIB_CRC16_X25_FOLD_LANES 4
+
+/* Bytes Copied before being Digested by bplib_crc_copy, Small Enough to Still be in Cache */
+#define BPLIB_CRC_COPY_CHUNK 4096
 
 /*
  * Various lookup and translation tables for CRC calculation
@@ -39,8 +83,8 @@
 static uint8_t BPLIB_CRC_DIRECT_TABLE[256];
 static uint8_t BPLIB_CRC_REFLECT_TABLE[256];
 
-static uint16_t BPLIB_CRC16_X25_TABLE[256];
-static uint32_t BPLIB_CRC32_C_TABLE[256];
+static uint16_t BPLIB_CRC16_X25_TABLE[BPLIB_CRC_SLICES][256];
+static uint32_t BPLIB_CRC32_C_TABLE[BPLIB_CRC_SLICES][256];
 
 /*
  * Definition of generic-ish CRC data digest function.
@@ -63,6 +107,44 @@ static bp_crcval_t bplib_crc_digest_CRC16_X25(bp_crcval_t crc, const void *ptr,
  */
 static bp_crcval_t bplib_crc_digest_CRC32_CASTAGNOLI(bp_crcval_t crc, const void *ptr, size_t size);
 
+/*
+ * Definition of a CRC16 X.25 implementation.
+ * Updates the reflected CRC based on the data in the given buffer.
+ */
+typedef uint16_t (*bplib_crc16_impl_func_t)(uint16_t crc, const uint8_t *ptr, size_t size);
+
+static uint16_t bplib_crc16_x25_slicing_impl(uint16_t crc, const uint8_t *ptr, size_t size);
+
+/*
+ * Implementation used by the CRC16 X.25 digest, selected by bplib_crc_init
+ * based on the instructions supported by the processor it is running on
+ */
+static bplib_crc16_impl_func_t BPLIB_CRC16_X25_IMPL = bplib_crc16_x25_slicing_impl;
+
+/*
+ * Carry-less multiply constants, reflected, that fold the low and high halves
+ * of a 128-bit remainder forward by one block, and by one block per lane;
+ * set by bplib_crc_init
+ */
+static uint64_t BPLIB_CRC16_X25_FOLD_LOW;
+static uint64_t BPLIB_CRC16_X25_FOLD_HIGH;
+static uint64_t BPLIB_CRC16_X25_FOLD_LANES_LOW;
+static uint64_t BPLIB_CRC16_X25_FOLD_LANES_HIGH;
+
+/*
+ * Definition of a CRC32 Castagnoli implementation.
+ * Updates the reflected CRC based on the data in the given buffer.
+ */
+typedef uint32_t (*bplib_crc32c_impl_func_t)(uint32_t crc, const uint8_t *ptr, size_t size);
+
+static uint32_t bplib_crc32c_slicing_impl(uint32_t crc, const uint8_t *ptr, size_t size);
+
+/*
+ * Implementation used by the CRC32 Castagnoli digest, selected by bplib_crc_init
+ * based on the instructions supported by the processor it is running on
+ */
+static bplib_crc32c_impl_func_t BPLIB_CRC32_C_IMPL = bplib_crc32c_slicing_impl;
+
 /*
  * Actual definition of CRC parameters
  */
@@ -118,12 +200,257 @@ bplib_crc_parameters_t BPLIB_CRC32_CASTAGNOLI = {
  STATIC FUNCTIONS
  ******************************************************************************/
 
-static uint16_t bplib_crc_generic16_impl(const uint8_t *input_table, const uint16_t *xor_table, uint16_t crc,
-                                         const uint8_t *ptr, size_t size)
+static uint32_t bplib_crc_reflect32(uint32_t crc)
+{
+    return ((uint32_t)BPLIB_CRC_REFLECT_TABLE[crc & 0xFF] << 24) |
+           ((uint32_t)BPLIB_CRC_REFLECT_TABLE[(crc >> 8) & 0xFF] << 16) |
+           ((uint32_t)BPLIB_CRC_REFLECT_TABLE[(crc >> 16) & 0xFF] << 8) |
+           ((uint32_t)BPLIB_CRC_REFLECT_TABLE[crc >> 24]);
+}
+
+static uint16_t bplib_crc_reflect16(uint16_t crc)
+{
+    return (uint16_t)(((uint16_t)BPLIB_CRC_REFLECT_TABLE[crc & 0xFF] << 8) | BPLIB_CRC_REFLECT_TABLE[crc >> 8]);
+}
+
+static uint32_t bplib_crc_load32(const uint8_t *ptr)
+{
+    /* Assembled a byte at a time so the result is little endian on any host */
+    return (uint32_t)ptr[0] | ((uint32_t)ptr[1] << 8) | ((uint32_t)ptr[2] << 16) | ((uint32_t)ptr[3] << 24);
+}
+
+#ifdef BPLIB_CRC16_X25_PMULL
+static uint64_t bplib_crc_load64(const uint8_t *ptr)
+{
+    return (uint64_t)bplib_crc_load32(ptr) | ((uint64_t)bplib_crc_load32(ptr + 4) << 32);
+}
+#endif
+
+#if defined(BPLIB_CRC16_X25_PCLMUL) || defined(BPLIB_CRC16_X25_PMULL)
+static void bplib_crc_store64(uint8_t *ptr, uint64_t value)
+{
+    int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        ptr[i] = (uint8_t)(value >> (i * 8));
+    }
+}
+
+/*
+ * bplib_crc16_x25_fold_finish - the 128-bit remainder left by folding is congruent to all
+ *  of the data folded into it, so the CRC of the remainder's 16 bytes is the CRC of that data
+ */
+static uint16_t bplib_crc16_x25_fold_finish(uint64_t low, uint64_t high, const uint8_t *ptr, size_t size)
+{
+    uint8_t  remainder[BPLIB_CRC16_X25_FOLD_SIZE];
+    uint16_t crc;
+
+    bplib_crc_store64(remainder, low);
+    bplib_crc_store64(remainder + 8, high);
+    crc = bplib_crc16_x25_slicing_impl(0, remainder, sizeof(remainder));
+    return bplib_crc16_x25_slicing_impl(crc, ptr, size);
+}
+#endif
+
+uint16_t bplib_crc16_x25_slicing_impl(uint16_t crc, const uint8_t *ptr, size_t size)
+{
+    uint32_t low;
+    uint32_t high;
+
+    /* Fold in Eight Bytes at a Time */
+    while (size >= BPLIB_CRC_SLICES)
+    {
+        low  = bplib_crc_load32(ptr) ^ crc;
+        high = bplib_crc_load32(ptr + 4);
+        crc  = BPLIB_CRC16_X25_TABLE[7][low & 0xFF] ^ BPLIB_CRC16_X25_TABLE[6][(low >> 8) & 0xFF] ^
+               BPLIB_CRC16_X25_TABLE[5][(low >> 16) & 0xFF] ^ BPLIB_CRC16_X25_TABLE[4][low >> 24] ^
+               BPLIB_CRC16_X25_TABLE[3][high & 0xFF] ^ BPLIB_CRC16_X25_TABLE[2][(high >> 8) & 0xFF] ^
+               BPLIB_CRC16_X25_TABLE[1][(high >> 16) & 0xFF] ^ BPLIB_CRC16_X25_TABLE[0][high >> 24];
+        ptr += BPLIB_CRC_SLICES;
+        size -= BPLIB_CRC_SLICES;
+    }
+
+    /* Fold in Remaining Bytes */
+    while (size > 0)
+    {
+        crc = BPLIB_CRC16_X25_TABLE[0][(crc ^ *ptr) & 0xFF] ^ (crc >> 8);
+        ++ptr;
+        --size;
+    }
+
+    return crc;
+}
+
+#ifdef BPLIB_CRC16_X25_PCLMUL
+__attribute__((target("sse2,pclmul"))) static __m128i bplib_crc16_x25_pclmul_fold(__m128i remainder, __m128i constants,
+                                                                                  const uint8_t *ptr)
+{
+    __m128i block;
+
+    /* x86 is little endian, so the block can be loaded as it is */
+    block = _mm_loadu_si128((const __m128i *)ptr);
+    return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(remainder, constants, 0x00),
+                                       _mm_clmulepi64_si128(remainder, constants, 0x11)),
+                         block);
+}
+
+__attribute__((target("sse2,pclmul"))) static uint16_t bplib_crc16_x25_pclmul_impl(uint16_t crc, const uint8_t *ptr,
+                                                                                   size_t size)
+{
+    __m128i remainder[BPLIB_CRC16_X25_FOLD_LANES];
+    __m128i constants;
+    uint8_t remainders[BPLIB_CRC16_X25_FOLD_LANES * BPLIB_CRC16_X25_FOLD_SIZE];
+    int     lane;
+
+    if (size < BPLIB_CRC16_X25_FOLD_MIN)
+    {
+        return bplib_crc16_x25_slicing_impl(crc, ptr, size);
+    }
+
+    /* The Running CRC is Absorbed by the First Two Bytes of Data */
+    memcpy(remainders, ptr, sizeof(remainders));
+    remainders[0] ^= (uint8_t)crc;
+    remainders[1] ^= (uint8_t)(crc >> 8);
+    for (lane = 0; lane < BPLIB_CRC16_X25_FOLD_LANES; lane++)
+    {
+        remainder[lane] = _mm_loadu_si128((const __m128i *)&remainders[lane * BPLIB_CRC16_X25_FOLD_SIZE]);
+    }
+    ptr += sizeof(remainders);
+    size -= sizeof(remainders);
+
+    /* Fold Each Lane Forward over the Lanes' Worth of Data that Follows */
+    constants = _mm_set_epi64x((long long)BPLIB_CRC16_X25_FOLD_LANES_HIGH, (long long)BPLIB_CRC16_X25_FOLD_LANES_LOW);
+    while (size >= sizeof(remainders))
+    {
+        for (lane = 0; lane < BPLIB_CRC16_X25_FOLD_LANES; lane++)
+        {
+            remainder[lane] =
+                bplib_crc16_x25_pclmul_fold(remainder[lane], constants, ptr + (lane * BPLIB_CRC16_X25_FOLD_SIZE));
+        }
+        ptr += sizeof(remainders);
+        size -= sizeof(remainders);
+    }
+
+    /* Fold the Lanes into One Another, then on over the Remaining Whole Blocks */
+    for (lane = 0; lane < BPLIB_CRC16_X25_FOLD_LANES; lane++)
+    {
+        _mm_storeu_si128((__m128i *)&remainders[lane * BPLIB_CRC16_X25_FOLD_SIZE], remainder[lane]);
+    }
+    constants = _mm_set_epi64x((long long)BPLIB_CRC16_X25_FOLD_HIGH, (long long)BPLIB_CRC16_X25_FOLD_LOW);
+    for (lane = 1; lane < BPLIB_CRC16_X25_FOLD_LANES; lane++)
+    {
+        remainder[0] =
+            bplib_crc16_x25_pclmul_fold(remainder[0], constants, &remainders[lane * BPLIB_CRC16_X25_FOLD_SIZE]);
+    }
+    while (size >= BPLIB_CRC16_X25_FOLD_SIZE)
+    {
+        remainder[0] = bplib_crc16_x25_pclmul_fold(remainder[0], constants, ptr);
+        ptr += BPLIB_CRC16_X25_FOLD_SIZE;
+        size -= BPLIB_CRC16_X25_FOLD_SIZE;
+    }
+
+    return bplib_crc16_x25_fold_finish((uint64_t)_mm_cvtsi128_si64(remainder[0]),
+                                       (uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(remainder[0], remainder[0])),
+                                       ptr, size);
+}
+#endif
+
+#ifdef BPLIB_CRC16_X25_PMULL
+static uint64x2_t bplib_crc16_x25_pmull_fold(uint64x2_t remainder, uint64_t low, uint64_t high, const uint8_t *ptr)
+{
+    uint64x2_t block;
+    poly128_t  low_product;
+    poly128_t  high_product;
+
+    block        = vcombine_u64(vcreate_u64(bplib_crc_load64(ptr)), vcreate_u64(bplib_crc_load64(ptr + 8)));
+    low_product  = vmull_p64((poly64_t)vgetq_lane_u64(remainder, 0), (poly64_t)low);
+    high_product = vmull_p64((poly64_t)vgetq_lane_u64(remainder, 1), (poly64_t)high);
+    return veorq_u64(veorq_u64(vreinterpretq_u64_p128(low_product), vreinterpretq_u64_p128(high_product)), block);
+}
+
+static uint16_t bplib_crc16_x25_pmull_impl(uint16_t crc, const uint8_t *ptr, size_t size)
+{
+    uint64x2_t remainder[BPLIB_CRC16_X25_FOLD_LANES];
+    uint8_t    remainders[BPLIB_CRC16_X25_FOLD_LANES * BPLIB_CRC16_X25_FOLD_SIZE];
+    uint8_t   *block;
+    int        lane;
+
+    if (size < BPLIB_CRC16_X25_FOLD_MIN)
+    {
+        return bplib_crc16_x25_slicing_impl(crc, ptr, size);
+    }
+
+    /* The Running CRC is Absorbed by the First Two Bytes of Data */
+    memcpy(remainders, ptr, sizeof(remainders));
+    remainders[0] ^= (uint8_t)crc;
+    remainders[1] ^= (uint8_t)(crc >> 8);
+    for (lane = 0; lane < BPLIB_CRC16_X25_FOLD_LANES; lane++)
+    {
+        block           = &remainders[lane * BPLIB_CRC16_X25_FOLD_SIZE];
+        remainder[lane] = vcombine_u64(vcreate_u64(bplib_crc_load64(block)), vcreate_u64(bplib_crc_load64(block + 8)));
+    }
+    ptr += sizeof(remainders);
+    size -= sizeof(remainders);
+
+    /* Fold Each Lane Forward over the Lanes' Worth of Data that Follows */
+    while (size >= sizeof(remainders))
+    {
+        for (lane = 0; lane < BPLIB_CRC16_X25_FOLD_LANES; lane++)
+        {
+            remainder[lane] = bplib_crc16_x25_pmull_fold(remainder[lane], BPLIB_CRC16_X25_FOLD_LANES_LOW,
+                                                         BPLIB_CRC16_X25_FOLD_LANES_HIGH,
+                                                         ptr + (lane * BPLIB_CRC16_X25_FOLD_SIZE));
+        }
+        ptr += sizeof(remainders);
+        size -= sizeof(remainders);
+    }
+
+    /* Fold the Lanes into One Another, then on over the Remaining Whole Blocks */
+    for (lane = 0; lane < BPLIB_CRC16_X25_FOLD_LANES; lane++)
+    {
+        bplib_crc_store64(&remainders[lane * BPLIB_CRC16_X25_FOLD_SIZE], vgetq_lane_u64(remainder[lane], 0));
+        bplib_crc_store64(&remainders[(lane * BPLIB_CRC16_X25_FOLD_SIZE) + 8], vgetq_lane_u64(remainder[lane], 1));
+    }
+    for (lane = 1; lane < BPLIB_CRC16_X25_FOLD_LANES; lane++)
+    {
+        remainder[0] = bplib_crc16_x25_pmull_fold(remainder[0], BPLIB_CRC16_X25_FOLD_LOW, BPLIB_CRC16_X25_FOLD_HIGH,
+                                                  &remainders[lane * BPLIB_CRC16_X25_FOLD_SIZE]);
+    }
+    while (size >= BPLIB_CRC16_X25_FOLD_SIZE)
+    {
+        remainder[0] =
+            bplib_crc16_x25_pmull_fold(remainder[0], BPLIB_CRC16_X25_FOLD_LOW, BPLIB_CRC16_X25_FOLD_HIGH, ptr);
+        ptr += BPLIB_CRC16_X25_FOLD_SIZE;
+        size -= BPLIB_CRC16_X25_FOLD_SIZE;
+    }
+
+    return bplib_crc16_x25_fold_finish(vgetq_lane_u64(remainder[0], 0), vgetq_lane_u64(remainder[0], 1), ptr, size);
+}
+#endif
+
+uint32_t bplib_crc32c_slicing_impl(uint32_t crc, const uint8_t *ptr, size_t size)
 {
+    uint32_t low;
+    uint32_t high;
+
+    /* Fold in Eight Bytes at a Time */
+    while (size >= BPLIB_CRC_SLICES)
+    {
+        low  = bplib_crc_load32(ptr) ^ crc;
+        high = bplib_crc_load32(ptr + 4);
+        crc  = BPLIB_CRC32_C_TABLE[7][low & 0xFF] ^ BPLIB_CRC32_C_TABLE[6][(low >> 8) & 0xFF] ^
+               BPLIB_CRC32_C_TABLE[5][(low >> 16) & 0xFF] ^ BPLIB_CRC32_C_TABLE[4][low >> 24] ^
+               BPLIB_CRC32_C_TABLE[3][high & 0xFF] ^ BPLIB_CRC32_C_TABLE[2][(high >> 8) & 0xFF] ^
+               BPLIB_CRC32_C_TABLE[1][(high >> 16) & 0xFF] ^ BPLIB_CRC32_C_TABLE[0][high >> 24];
+        ptr += BPLIB_CRC_SLICES;
+        size -= BPLIB_CRC_SLICES;
+    }
+
+    /* Fold in Remaining Bytes */
     while (size > 0)
     {
-        crc = xor_table[((crc >> 8) ^ input_table[*ptr]) & 0xFF] ^ (crc << 8);
+        crc = BPLIB_CRC32_C_TABLE[0][(crc ^ *ptr) & 0xFF] ^ (crc >> 8);
         ++ptr;
         --size;
     }
@@ -131,18 +458,77 @@ static uint16_t bplib_crc_generic16_impl(const uint8_t *input_table, const uint1
     return crc;
 }
 
-static uint32_t bplib_crc_generic32_impl(const uint8_t *input_table, const uint32_t *xor_table, uint32_t crc,
-                                         const uint8_t *ptr, size_t size)
+#ifdef BPLIB_CRC32C_SSE42
+__attribute__((target("sse4.2"))) static uint32_t bplib_crc32c_sse42_impl(uint32_t crc, const uint8_t *ptr,
+                                                                          size_t size)
 {
+    uint64_t crc64;
+    uint64_t word;
+
+    /* Fold in Bytes up to an Aligned Word */
+    while (size > 0 && ((uintptr_t)ptr & 7) != 0)
+    {
+        crc = __builtin_ia32_crc32qi(crc, *ptr);
+        ++ptr;
+        --size;
+    }
+
+    /* Fold in Eight Bytes at a Time */
+    crc64 = crc;
+    while (size >= sizeof(word))
+    {
+        memcpy(&word, ptr, sizeof(word));
+        crc64 = __builtin_ia32_crc32di(crc64, word);
+        ptr += sizeof(word);
+        size -= sizeof(word);
+    }
+    crc = (uint32_t)crc64;
+
+    /* Fold in Remaining Bytes */
+    while (size > 0)
+    {
+        crc = __builtin_ia32_crc32qi(crc, *ptr);
+        ++ptr;
+        --size;
+    }
+
+    return crc;
+}
+#endif
+
+#ifdef BPLIB_CRC32C_ARMV8
+static uint32_t bplib_crc32c_armv8_impl(uint32_t crc, const uint8_t *ptr, size_t size)
+{
+    uint64_t word;
+
+    /* Fold in Bytes up to an Aligned Word */
+    while (size > 0 && ((uintptr_t)ptr & 7) != 0)
+    {
+        crc = __crc32cb(crc, *ptr);
+        ++ptr;
+        --size;
+    }
+
+    /* Fold in Eight Bytes at a Time */
+    while (size >= sizeof(word))
+    {
+        memcpy(&word, ptr, sizeof(word));
+        crc = __crc32cd(crc, word);
+        ptr += sizeof(word);
+        size -= sizeof(word);
+    }
+
+    /* Fold in Remaining Bytes */
     while (size > 0)
     {
-        crc = xor_table[((crc >> 24) ^ input_table[*ptr]) & 0xFF] ^ (crc << 8);
+        crc = __crc32cb(crc, *ptr);
         ++ptr;
         --size;
     }
 
     return crc;
 }
+#endif
 
 bp_crcval_t bplib_crc_digest_NOOP(bp_crcval_t crc, const void *ptr, size_t size)
 {
@@ -151,47 +537,51 @@ bp_crcval_t bplib_crc_digest_NOOP(bp_crcval_t crc, const void *ptr, size_t size)
 
 bp_crcval_t bplib_crc_digest_CRC16_X25(bp_crcval_t crc, const void *ptr, size_t size)
 {
-    return bplib_crc_generic16_impl(BPLIB_CRC_REFLECT_TABLE, BPLIB_CRC16_X25_TABLE, crc, ptr, size);
+    /* Reflected on the way in and out, like the CRC32 Castagnoli digest below */
+    return bplib_crc_reflect16(BPLIB_CRC16_X25_IMPL(bplib_crc_reflect16((uint16_t)crc), ptr, size));
 }
 
 bp_crcval_t bplib_crc_digest_CRC32_CASTAGNOLI(bp_crcval_t crc, const void *ptr, size_t size)
 {
-    return bplib_crc_generic32_impl(BPLIB_CRC_REFLECT_TABLE, BPLIB_CRC32_C_TABLE, crc, ptr, size);
+    /*
+     * The running CRC is kept most significant bit first with reflected input bytes,
+     * which is the bit reversal of the CRC the hardware instructions and the slicing
+     * tables operate on; so it is reflected on the way in and on the way out
+     */
+    return bplib_crc_reflect32(BPLIB_CRC32_C_IMPL(bplib_crc_reflect32(crc), ptr, size));
 }
 
-bp_crcval_t bplib_precompute_crc_byte(uint8_t width, uint8_t byte, bp_crcval_t polynomial)
+/*
+ * bplib_crc16_x25_fold_constant - x^(n-1) mod P, bit reversed into 64 bits; the product of
+ *  two reflected operands comes out one bit short of the 128-bit reflected remainder it is
+ *  folded into, which is the same as an extra factor of x, so the constant leaves one out
+ */
+static uint64_t bplib_crc16_x25_fold_constant(int n)
 {
-    uint8_t     mask;
-    bp_crcval_t next_bit;
-    bp_crcval_t crcval;
-
-    /* left-justifies the byte and polynomial in the registers */
-    /* This is based on the "bp_crcval_t" type being 32 bits wide */
-    crcval = (bp_crcval_t)byte << 24;
-    polynomial <<= 32 - width;
+    uint32_t remainder;
+    uint64_t constant;
+    int      degree;
 
-    mask = 0xFF;
-    while (mask != 0)
+    remainder = 1;
+    while (--n > 0)
     {
-        mask <<= 1;
-
-        next_bit = crcval & 0x80000000U;
-        crcval <<= 1;
-
-        if (next_bit)
+        remainder <<= 1;
+        if (remainder & 0x10000)
         {
-            crcval ^= polynomial;
+            remainder ^= 0x10000 | BPLIB_CRC16_X25_POLY;
         }
     }
 
-    /* now align it and mask result based on the width of the CRC */
-    if (width < 32)
+    constant = 0;
+    for (degree = 0; degree < 16; degree++)
     {
-        crcval >>= 32 - width;
-        crcval &= ((bp_crcval_t)1 << width) - 1;
+        if (remainder & ((uint32_t)1 << degree))
+        {
+            constant |= (uint64_t)1 << (63 - degree);
+        }
     }
 
-    return crcval;
+    return constant;
 }
 
 uint8_t bplib_precompute_reflection(uint8_t byte)
@@ -229,7 +619,11 @@ uint8_t bplib_precompute_reflection(uint8_t byte)
  *-------------------------------------------------------------------------------------*/
 void bplib_crc_init(void)
 {
-    uint8_t byte;
+    uint8_t  byte;
+    uint32_t crcval;
+    int      slice;
+    int      bit;
+    int      fold_bits;
 
     byte = 0;
     do
@@ -237,17 +631,69 @@ void bplib_crc_init(void)
         BPLIB_CRC_DIRECT_TABLE[byte]  = byte;
         BPLIB_CRC_REFLECT_TABLE[byte] = bplib_precompute_reflection(byte);
 
-        /*
-         * note that the "width" passed to this function should indicate the
-         * table data type, not necessarily the width of the CRC (although for the
-         * two implemented algorithms, they are the same)
-         */
-        BPLIB_CRC16_X25_TABLE[byte] = bplib_precompute_crc_byte(16, byte, BPLIB_CRC16_X25_POLY);
-        BPLIB_CRC32_C_TABLE[byte]   = bplib_precompute_crc_byte(32, byte, BPLIB_CRC32_C_POLY);
+        /* Reflected tables used directly by the first slice */
+        crcval = byte;
+        for (bit = 0; bit < 8; bit++)
+        {
+            crcval = (crcval & 1) ? (crcval >> 1) ^ BPLIB_CRC16_X25_REFLECTED_POLY : (crcval >> 1);
+        }
+        BPLIB_CRC16_X25_TABLE[0][byte] = (uint16_t)crcval;
+
+        crcval = byte;
+        for (bit = 0; bit < 8; bit++)
+        {
+            crcval = (crcval & 1) ? (crcval >> 1) ^ BPLIB_CRC32_C_REFLECTED_POLY : (crcval >> 1);
+        }
+        BPLIB_CRC32_C_TABLE[0][byte] = crcval;
 
         ++byte;
     }
     while (byte != 0);
+
+    /* Each further slice advances the previous one by another zero byte */
+    for (slice = 1; slice < BPLIB_CRC_SLICES; slice++)
+    {
+        byte = 0;
+        do
+        {
+            crcval                             = BPLIB_CRC16_X25_TABLE[slice - 1][byte];
+            BPLIB_CRC16_X25_TABLE[slice][byte] = BPLIB_CRC16_X25_TABLE[0][crcval & 0xFF] ^ (crcval >> 8);
+
+            crcval                           = BPLIB_CRC32_C_TABLE[slice - 1][byte];
+            BPLIB_CRC32_C_TABLE[slice][byte] = BPLIB_CRC32_C_TABLE[0][crcval & 0xFF] ^ (crcval >> 8);
+            ++byte;
+        }
+        while (byte != 0);
+    }
+
+    /* Carry-less multiply constants folding each half of the remainder forward */
+    fold_bits                       = BPLIB_CRC16_X25_FOLD_SIZE * 8;
+    BPLIB_CRC16_X25_FOLD_LOW        = bplib_crc16_x25_fold_constant(fold_bits + 64);
+    BPLIB_CRC16_X25_FOLD_HIGH       = bplib_crc16_x25_fold_constant(fold_bits);
+    BPLIB_CRC16_X25_FOLD_LANES_LOW  = bplib_crc16_x25_fold_constant((fold_bits * BPLIB_CRC16_X25_FOLD_LANES) + 64);
+    BPLIB_CRC16_X25_FOLD_LANES_HIGH = bplib_crc16_x25_fold_constant(fold_bits * BPLIB_CRC16_X25_FOLD_LANES);
+
+    /* Select the fastest CRC16 X.25 implementation this processor supports */
+    BPLIB_CRC16_X25_IMPL = bplib_crc16_x25_slicing_impl;
+#if defined(BPLIB_CRC16_X25_PCLMUL)
+    if (__builtin_cpu_supports("pclmul"))
+    {
+        BPLIB_CRC16_X25_IMPL = bplib_crc16_x25_pclmul_impl;
+    }
+#elif defined(BPLIB_CRC16_X25_PMULL)
+    BPLIB_CRC16_X25_IMPL = bplib_crc16_x25_pmull_impl;
+#endif
+
+    /* Select the fastest CRC32 Castagnoli implementation this processor supports */
+    BPLIB_CRC32_C_IMPL = bplib_crc32c_slicing_impl;
+#if defined(BPLIB_CRC32C_SSE42)
+    if (__builtin_cpu_supports("sse4.2"))
+    {
+        BPLIB_CRC32_C_IMPL = bplib_crc32c_sse42_impl;
+    }
+#elif defined(BPLIB_CRC32C_ARMV8)
+    BPLIB_CRC32_C_IMPL = bplib_crc32c_armv8_impl;
+#endif
 }
 
 const char *bplib_crc_get_name(bplib_crc_parameters_t *params)
@@ -270,6 +716,31 @@ bp_crcval_t bplib_crc_update(bplib_crc_parameters_t *params, bp_crcval_t crc, co
     return params->digest(crc, data, size);
 }
 
+/*--------------------------------------------------------------------------------------
+ * bplib_crc_copy - Copies data and updates the CRC with it in a single pass over the source
+ *
+ *  Each chunk is digested from the destination right after it is copied, while it is
+ *  still in cache, so the data only makes one trip through memory
+ *-------------------------------------------------------------------------------------*/
+bp_crcval_t bplib_crc_copy(bplib_crc_parameters_t *params, bp_crcval_t crc, void *dest, const void *src, size_t size)
+{
+    uint8_t       *dest_ptr = (uint8_t *)dest;
+    const uint8_t *src_ptr  = (const uint8_t *)src;
+    size_t         chunk;
+
+    while (size > 0)
+    {
+        chunk = size < BPLIB_CRC_COPY_CHUNK ? size : BPLIB_CRC_COPY_CHUNK;
+        memcpy(dest_ptr, src_ptr, chunk);
+        crc = params->digest(crc, dest_ptr, chunk);
+        dest_ptr += chunk;
+        src_ptr += chunk;
+        size -= chunk;
+    }
+
+    return crc;
+}
+
 bp_crcval_t bplib_crc_finalize(bplib_crc_parameters_t *params, bp_crcval_t crc)
 {
     bp_crcval_t crc_final;
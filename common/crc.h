@@ -64,6 +64,7 @@ uint8_t     bplib_crc_get_width(bplib_crc_parameters_t *params);
 bp_crcval_t bplib_crc_initial_value(bplib_crc_parameters_t *params);
 bp_crcval_t bplib_crc_update(bplib_crc_parameters_t *params, bp_crcval_t crc, const void *data, size_t size);
 bp_crcval_t bplib_crc_finalize(bplib_crc_parameters_t *params, bp_crcval_t crc);
+bp_crcval_t bplib_crc_copy(bplib_crc_parameters_t *params, bp_crcval_t crc, void *dest, const void *src, size_t size);
 
 bp_crcval_t bplib_crc_get(const uint8_t *data, const uint32_t length, bplib_crc_parameters_t *params);
 
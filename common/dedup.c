@@ -0,0 +1,240 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include <limits.h>
+
+#include "bplib.h"
+#include "bplib_os.h"
+#include "dedup.h"
+
+/******************************************************************************
+ LOCAL FUNCTIONS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * key_hash - returns hash bucket of a bundle identifier
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int key_hash(dedup_t *dedup, const dedup_key_t *key)
+{
+    uint64_t h = (uint64_t)key->adu.node;
+
+    h = (h * 0x9E3779B97F4A7C15ULL) ^ (uint64_t)key->adu.service;
+    h = (h * 0x9E3779B97F4A7C15ULL) ^ (uint64_t)key->adu.createsec;
+    h = (h * 0x9E3779B97F4A7C15ULL) ^ (uint64_t)key->adu.createseq;
+    h = (h * 0x9E3779B97F4A7C15ULL) ^ (uint64_t)key->fragoffset;
+    h = (h * 0x9E3779B97F4A7C15ULL);
+
+    return (int)((h >> 32) & (uint64_t)(dedup->num_buckets - 1));
+}
+
+/*----------------------------------------------------------------------------
+ * key_equal - checks if two bundle identifiers are the same
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bool key_equal(const dedup_key_t *a, const dedup_key_t *b)
+{
+    return a->adu.node == b->adu.node && a->adu.service == b->adu.service && a->adu.createsec == b->adu.createsec &&
+           a->adu.createseq == b->adu.createseq && a->fragoffset == b->fragoffset;
+}
+
+/*----------------------------------------------------------------------------
+ * entry_unlink - removes an entry from its hash bucket
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void entry_unlink(dedup_t *dedup, int e)
+{
+    int *link = &dedup->buckets[key_hash(dedup, &dedup->entries[e].key)];
+
+    while (*link != BP_ERROR)
+    {
+        if (*link == e)
+        {
+            *link = dedup->entries[e].next;
+            return;
+        }
+        link = &dedup->entries[*link].next;
+    }
+}
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Create - allocates a ring of num_entries identifiers and their hash buckets
+ *----------------------------------------------------------------------------*/
+int dedup_create(dedup_t **dedup, int num_entries)
+{
+    int b;
+
+    /* Check Parameters */
+    if (num_entries <= 0 || num_entries > (INT_MAX / 4))
+    {
+        return BP_ERROR;
+    }
+
+    /* Allocate Structure */
+    *dedup = (dedup_t *)bplib_os_calloc_tag(sizeof(dedup_t), BP_MEM_DEDUP);
+    if (*dedup == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    /* Size Buckets to Keep Chains Short */
+    (*dedup)->num_buckets = 1;
+    while ((*dedup)->num_buckets < num_entries * 2)
+    {
+        (*dedup)->num_buckets <<= 1;
+    }
+
+    /* Allocate Entries and Buckets */
+    (*dedup)->entries = (dedup_entry_t *)bplib_os_calloc_tag(sizeof(dedup_entry_t) * num_entries, BP_MEM_DEDUP);
+    (*dedup)->buckets = (int *)bplib_os_calloc_tag(sizeof(int) * (*dedup)->num_buckets, BP_MEM_DEDUP);
+    if ((*dedup)->entries == NULL || (*dedup)->buckets == NULL)
+    {
+        dedup_destroy(*dedup);
+        *dedup = NULL;
+        return BP_ERROR;
+    }
+
+    /* Initialize Buckets */
+    for (b = 0; b < (*dedup)->num_buckets; b++)
+    {
+        (*dedup)->buckets[b] = BP_ERROR;
+    }
+
+    /* Initialize Attributes */
+    (*dedup)->num_entries = num_entries;
+    (*dedup)->oldest      = 0;
+    (*dedup)->count       = 0;
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * Destroy - frees memory allocated by create
+ *----------------------------------------------------------------------------*/
+int dedup_destroy(dedup_t *dedup)
+{
+    if (dedup)
+    {
+        if (dedup->entries)
+            bplib_os_free(dedup->entries);
+        if (dedup->buckets)
+            bplib_os_free(dedup->buckets);
+        bplib_os_free(dedup);
+    }
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * Find - checks if a bundle identifier is remembered
+ *----------------------------------------------------------------------------*/
+bool dedup_find(dedup_t *dedup, const dedup_key_t *key)
+{
+    int e = dedup->buckets[key_hash(dedup, key)];
+
+    while (e != BP_ERROR)
+    {
+        if (key_equal(&dedup->entries[e].key, key))
+        {
+            return true;
+        }
+        e = dedup->entries[e].next;
+    }
+
+    return false;
+}
+
+/*----------------------------------------------------------------------------
+ * Insert - remembers a bundle identifier, forgetting the oldest when full
+ *
+ *  returns BP_DUPLICATE when the identifier is already remembered
+ *----------------------------------------------------------------------------*/
+int dedup_insert(dedup_t *dedup, const dedup_key_t *key)
+{
+    int e;
+    int b;
+
+    if (dedup_find(dedup, key))
+    {
+        return BP_DUPLICATE;
+    }
+
+    /* Take Next Entry of Ring */
+    if (dedup->count == dedup->num_entries)
+    {
+        e = dedup->oldest;
+        entry_unlink(dedup, e);
+        dedup->oldest = (dedup->oldest + 1) % dedup->num_entries;
+    }
+    else
+    {
+        e = (dedup->oldest + dedup->count) % dedup->num_entries;
+        dedup->count++;
+    }
+
+    /* Add Entry to Front of its Bucket */
+    b                      = key_hash(dedup, key);
+    dedup->entries[e].key  = *key;
+    dedup->entries[e].next = dedup->buckets[b];
+    dedup->buckets[b]      = e;
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * Remove - forgets a bundle identifier, used to back out an insert
+ *
+ *  the newest entry is returned to the ring; an older one is only unlinked
+ *  from its bucket and its slot is reused when the ring comes around to it
+ *----------------------------------------------------------------------------*/
+int dedup_remove(dedup_t *dedup, const dedup_key_t *key)
+{
+    int *link = &dedup->buckets[key_hash(dedup, key)];
+
+    while (*link != BP_ERROR)
+    {
+        int e = *link;
+        if (key_equal(&dedup->entries[e].key, key))
+        {
+            *link = dedup->entries[e].next;
+            if (dedup->count > 0 && e == (dedup->oldest + dedup->count - 1) % dedup->num_entries)
+            {
+                dedup->count--;
+            }
+            return BP_SUCCESS;
+        }
+        link = &dedup->entries[e].next;
+    }
+
+    return BP_ERROR;
+}
+
+/*----------------------------------------------------------------------------
+ * Count - returns number of remembered bundle identifiers
+ *----------------------------------------------------------------------------*/
+int dedup_count(dedup_t *dedup)
+{
+    return dedup->count;
+}
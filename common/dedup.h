@@ -0,0 +1,71 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef DEDUP_H
+#define DEDUP_H
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include "bplib.h"
+#include "bundle_types.h"
+
+/******************************************************************************
+ TYPEDEFS
+ ******************************************************************************/
+
+/* Received Bundle Identifier (a fragment is told apart by its offset) */
+typedef struct
+{
+    bp_adu_id_t adu;        /* source and creation timestamp of the bundle */
+    bp_val_t    fragoffset; /* offset of the payload into the ADU, zero when not a fragment */
+} dedup_key_t;
+
+/* Remembered Bundle */
+typedef struct
+{
+    dedup_key_t key;  /* identifier of the bundle */
+    int         next; /* next entry in the same hash bucket, BP_ERROR at the end */
+} dedup_entry_t;
+
+/* Duplicate Detection Index Control Structure */
+typedef struct
+{
+    dedup_entry_t *entries;     /* ring of remembered bundles, oldest first */
+    int           *buckets;     /* first entry of each hash bucket, BP_ERROR when empty */
+    int            num_entries; /* bundles remembered before the oldest is forgotten */
+    int            num_buckets; /* power of two, at least twice num_entries */
+    int            oldest;      /* index of the oldest entry */
+    int            count;       /* number of entries in use */
+} dedup_t;
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+int  dedup_create(dedup_t **dedup, int num_entries);
+int  dedup_destroy(dedup_t *dedup);
+bool dedup_find(dedup_t *dedup, const dedup_key_t *key);
+int  dedup_insert(dedup_t *dedup, const dedup_key_t *key);
+int  dedup_remove(dedup_t *dedup, const dedup_key_t *key);
+int  dedup_count(dedup_t *dedup);
+
+#endif /* DEDUP_H */
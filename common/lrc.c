@@ -22,10 +22,16 @@
  INCLUDES
  ******************************************************************************/
 
+#include <string.h>
+
 #include "bplib.h"
 #include "bplib_os.h"
 #include "lrc.h"
 
+#if BPLIB_LRC_SIMD && (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
 /******************************************************************************
  DEFINES
  ******************************************************************************/
@@ -33,6 +39,24 @@
 #define LRC_BLOCK_SIZE           7
 #define LRC_CODE_BYTES_PER_BLOCK 2
 
+/* Word Holding a Block in its Low Seven Bytes, First Byte Lowest */
+#define LRC_WORD_SIZE      8
+#define LRC_WORD_BLOCK     0x00FFFFFFFFFFFFFFULL
+#define LRC_WORD_LOW_BITS  0x0101010101010101ULL
+#define LRC_WORD_GATHER    0x0102040810204080ULL /* moves the low bit of byte n to bit 56 + n */
+
+/* Vector Instruction Set Available to this Build */
+#if BPLIB_LRC_SIMD && (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define LRC_AVX2
+#endif
+
+/******************************************************************************
+ TYPEDEFS
+ ******************************************************************************/
+
+/* Encodes (or checks, and corrects) the codes of a number of whole blocks */
+typedef int (*lrc_impl_t)(uint8_t *data, uint8_t *code, int blocks, bool check);
+
 /******************************************************************************
  LOCAL FILE DATA
  ******************************************************************************/
@@ -40,6 +64,8 @@
 static uint8_t *LRC_XOR_TABLE = NULL;
 static int8_t  *LRC_RCI_TABLE = NULL; /* row-column-index */
 
+static lrc_impl_t LRC_IMPL = NULL; /* whole blocks, set in initialization function */
+
 /******************************************************************************
  LOCAL FUNCTIONS
  ******************************************************************************/
@@ -215,6 +241,177 @@ BP_LOCAL_SCOPE int lrc_block_decode(uint8_t *src_block, uint8_t *src_code, uint8
     return BP_ECC_NO_ERRORS;
 }
 
+/*--------------------------------------------------------------------------------------
+ * lrc_block_check -
+ *
+ *  compares the codes calculated for a block with the codes stored for it, and
+ *  corrects the block when they differ by a single bit
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int lrc_block_check(uint8_t *src_block, uint8_t *src_code, uint8_t ecc_col, uint8_t ecc_row)
+{
+    uint8_t calc_code[LRC_CODE_BYTES_PER_BLOCK] = {ecc_col, ecc_row};
+
+    if (ecc_col == src_code[0] && ecc_row == src_code[1])
+    {
+        return BP_ECC_NO_ERRORS;
+    }
+
+    return lrc_block_decode(src_block, src_code, calc_code);
+}
+
+/*--------------------------------------------------------------------------------------
+ * lrc_word_load -
+ *
+ *  loads a whole block into the low seven bytes of a word, first byte lowest; the byte
+ *  after a whole block is always in the frame, since the codes follow the data
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE uint64_t lrc_word_load(const uint8_t *src_block)
+{
+    uint64_t word;
+
+    memcpy(&word, src_block, sizeof(word));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    word = __builtin_bswap64(word);
+#endif
+
+    return word & LRC_WORD_BLOCK;
+}
+
+/*--------------------------------------------------------------------------------------
+ * lrc_word_impl -
+ *
+ *  the column code is the bytes of the block folded together, and the row code is the
+ *  parity of each byte folded into its low bit and then gathered with a multiply
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int lrc_word_impl(uint8_t *data, uint8_t *code, int blocks, bool check)
+{
+    int ret_status = BP_ECC_NO_ERRORS;
+    int b;
+
+    for (b = 0; b < blocks; b++)
+    {
+        uint8_t *src_block = &data[b * LRC_BLOCK_SIZE];
+        uint8_t *src_code  = &code[b * LRC_CODE_BYTES_PER_BLOCK];
+        uint64_t word      = lrc_word_load(src_block);
+
+        /* Column Parity */
+        uint64_t col = word ^ (word >> 32);
+        col ^= col >> 16;
+        col ^= col >> 8;
+        uint8_t ecc_col = (uint8_t)col;
+
+        /* Row Parity */
+        uint64_t row = word ^ (word >> 4);
+        row ^= row >> 2;
+        row ^= row >> 1;
+        uint8_t ecc_row = (uint8_t)(((row & LRC_WORD_LOW_BITS) * LRC_WORD_GATHER) >> 56);
+
+        if (check)
+        {
+            ecc_row |= LRC_XOR_TABLE[src_code[0]] << LRC_BLOCK_SIZE;
+            int status = lrc_block_check(src_block, src_code, ecc_col, ecc_row);
+            if (status == BP_ECC_UNCOR_ERRORS)
+            {
+                return status;
+            }
+            else if (status == BP_ECC_COR_ERRORS)
+            {
+                ret_status = status;
+            }
+        }
+        else
+        {
+            src_code[0] = ecc_col;
+            src_code[1] = ecc_row | (LRC_XOR_TABLE[ecc_col] << LRC_BLOCK_SIZE);
+        }
+    }
+
+    return ret_status;
+}
+
+#ifdef LRC_AVX2
+/*--------------------------------------------------------------------------------------
+ * lrc_avx2_impl -
+ *
+ *  four blocks at a time, each spread into a 64-bit lane and folded as in the word
+ *  implementation, with the parity of the column code folded in as the eighth row
+ *  bit; the row bits are gathered with multiply-adds by their place values.  Reads
+ *  the four bytes after each group, which are in the frame (see above).  A group
+ *  whose codes do not match is checked again by the word implementation, which
+ *  takes the eighth row bit from the stored column code and corrects the error.
+ *-------------------------------------------------------------------------------------*/
+__attribute__((target("avx2"))) static int lrc_avx2_impl(uint8_t *data, uint8_t *code, int blocks, bool check)
+{
+    const __m256i gather = _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+    const __m256i spread = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, -1, 7, 8, 9, 10, 11, 12, 13, -1, 2, 3, 4, 5, 6, 7, 8,
+                                            -1, 9, 10, 11, 12, 13, 14, 15, -1);
+    const __m256i places = _mm256_set1_epi64x(0x8040201008040201LL);
+    const __m256i ones   = _mm256_set1_epi8(1);
+    const __m256i pairs  = _mm256_set1_epi16(1);
+    const __m256i col_lo = _mm256_set1_epi64x(0xFF);
+    const __m256i pack   = _mm256_setr_epi8(0, 1, 8, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 1, 8, 9,
+                                            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    int           ret_status = BP_ECC_NO_ERRORS;
+    int           b;
+
+    for (b = 0; b + 4 <= blocks; b += 4)
+    {
+        uint8_t *src_block = &data[b * LRC_BLOCK_SIZE];
+        uint8_t *src_code  = &code[b * LRC_CODE_BYTES_PER_BLOCK];
+        __m256i  quad      = _mm256_loadu_si256((const __m256i *)src_block);
+        quad               = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(quad, gather), spread);
+
+        /* Column Parity (low byte of each lane) */
+        __m256i col = _mm256_xor_si256(quad, _mm256_srli_epi64(quad, 32));
+        col         = _mm256_xor_si256(col, _mm256_srli_epi64(col, 16));
+        col         = _mm256_xor_si256(col, _mm256_srli_epi64(col, 8));
+
+        /* Row Parity (low bit of each byte, parity of the column code in the empty eighth byte) */
+        __m256i row = _mm256_or_si256(quad, _mm256_slli_epi64(col, 56));
+        row         = _mm256_xor_si256(row, _mm256_srli_epi64(row, 4));
+        row         = _mm256_xor_si256(row, _mm256_srli_epi64(row, 2));
+        row         = _mm256_xor_si256(row, _mm256_srli_epi64(row, 1));
+        row         = _mm256_madd_epi16(_mm256_maddubs_epi16(places, _mm256_and_si256(row, ones)), pairs);
+        row         = _mm256_add_epi32(row, _mm256_srli_epi64(row, 32));
+
+        /* Codes (column then row code in the low two bytes of each lane) */
+        __m256i ecc = _mm256_or_si256(_mm256_and_si256(col, col_lo), _mm256_slli_epi64(row, 8));
+        ecc         = _mm256_shuffle_epi8(ecc, pack);
+        uint64_t codes =
+            (uint32_t)_mm256_cvtsi256_si32(ecc) | ((uint64_t)(uint32_t)_mm256_extract_epi32(ecc, 4) << 32);
+
+        if (!check)
+        {
+            memcpy(src_code, &codes, sizeof(codes));
+        }
+        else if (memcmp(src_code, &codes, sizeof(codes)) != 0)
+        {
+            int status = lrc_word_impl(src_block, src_code, 4, true);
+            if (status == BP_ECC_UNCOR_ERRORS)
+            {
+                return status;
+            }
+            else if (status == BP_ECC_COR_ERRORS)
+            {
+                ret_status = status;
+            }
+        }
+    }
+
+    /* Blocks Left Over */
+    if (b < blocks)
+    {
+        int status = lrc_word_impl(&data[b * LRC_BLOCK_SIZE], &code[b * LRC_CODE_BYTES_PER_BLOCK], blocks - b, check);
+        if (status != BP_ECC_NO_ERRORS)
+        {
+            ret_status = status;
+        }
+    }
+
+    return ret_status;
+}
+#endif
+
 /******************************************************************************
  EXPORTED FUNCTIONS
  ******************************************************************************/
@@ -239,6 +436,15 @@ int lrc_init(int frame_size)
     build_xor_table(LRC_XOR_TABLE);
     build_rci_table(LRC_RCI_TABLE);
 
+    /* Select the fastest implementation this processor supports */
+    LRC_IMPL = lrc_word_impl;
+#ifdef LRC_AVX2
+    if (__builtin_cpu_supports("avx2"))
+    {
+        LRC_IMPL = lrc_avx2_impl;
+    }
+#endif
+
     /* Return Bytes Available for Data */
     return (LRC_BLOCK_SIZE * frame_size) / (LRC_BLOCK_SIZE + LRC_CODE_BYTES_PER_BLOCK);
 }
@@ -266,20 +472,17 @@ void lrc_uninit(void)
  *-------------------------------------------------------------------------------------*/
 void lrc_encode(uint8_t *frame_buffer, int data_size)
 {
-    int data_index = 0;
-    int ecc_index  = data_size;
+    int blocks     = data_size / LRC_BLOCK_SIZE;
+    int data_index = blocks * LRC_BLOCK_SIZE;
+    int ecc_index  = data_size + (blocks * LRC_CODE_BYTES_PER_BLOCK);
+
+    /* Encode ECC for Whole Blocks */
+    LRC_IMPL(frame_buffer, &frame_buffer[data_size], blocks, false);
 
-    /* Loop Through All Data in Page */
-    while (data_index < data_size)
+    /* Encode ECC for Partial Block at End of Page */
+    if (data_index < data_size)
     {
-        /* Encode ECC for Block */
-        int bytes_left   = data_size - data_index;
-        int bytes_to_ecc = bytes_left < LRC_BLOCK_SIZE ? bytes_left : LRC_BLOCK_SIZE;
-        lrc_block_encode(&frame_buffer[data_index], NULL, bytes_to_ecc, &frame_buffer[ecc_index]);
-
-        /* Goto Next Block */
-        data_index += LRC_BLOCK_SIZE;
-        ecc_index += 2;
+        lrc_block_encode(&frame_buffer[data_index], NULL, data_size - data_index, &frame_buffer[ecc_index]);
     }
 }
 
@@ -288,35 +491,23 @@ void lrc_encode(uint8_t *frame_buffer, int data_size)
  *-------------------------------------------------------------------------------------*/
 int lrc_decode(uint8_t *frame_buffer, int data_size)
 {
-    int ret_status = BP_ECC_NO_ERRORS;
-
-    int     data_index = 0;
-    int     ecc_index  = data_size;
+    int     blocks     = data_size / LRC_BLOCK_SIZE;
+    int     data_index = blocks * LRC_BLOCK_SIZE;
+    int     ecc_index  = data_size + (blocks * LRC_CODE_BYTES_PER_BLOCK);
     uint8_t ecc_code[LRC_CODE_BYTES_PER_BLOCK];
 
-    /* Loop Through All Data in Page */
-    while (data_index < data_size)
-    {
-        /* Generate ECC for Block */
-        int bytes_left   = data_size - data_index;
-        int bytes_to_ecc = bytes_left < LRC_BLOCK_SIZE ? bytes_left : LRC_BLOCK_SIZE;
-        lrc_block_encode(&frame_buffer[data_index], &frame_buffer[ecc_index], bytes_to_ecc, ecc_code);
+    /* Check (and correct) ECC for Whole Blocks */
+    int ret_status = LRC_IMPL(frame_buffer, &frame_buffer[data_size], blocks, true);
 
-        /* Check (and correct) ECC for Block */
+    /* Check (and correct) ECC for Partial Block at End of Page */
+    if (ret_status != BP_ECC_UNCOR_ERRORS && data_index < data_size)
+    {
+        lrc_block_encode(&frame_buffer[data_index], &frame_buffer[ecc_index], data_size - data_index, ecc_code);
         int status = lrc_block_decode(&frame_buffer[data_index], &frame_buffer[ecc_index], ecc_code);
-        if (status == BP_ECC_UNCOR_ERRORS)
+        if (status != BP_ECC_NO_ERRORS)
         {
             ret_status = status;
-            break;
         }
-        else if (status == BP_ECC_COR_ERRORS)
-        {
-            ret_status = status;
-        }
-
-        /* Goto Next Block */
-        data_index += LRC_BLOCK_SIZE;
-        ecc_index += 2;
     }
 
     return ret_status;
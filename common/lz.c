@@ -0,0 +1,324 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "bplib.h"
+#include "bplib_lz.h"
+
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+/*
+ * The compressed data is an LZ4 block: a series of sequences, each made up of a
+ * token byte (upper nibble literal count, lower nibble match length minus the
+ * minimum match), any extension bytes of the literal count, the literals, a two
+ * byte little endian match offset, and any extension bytes of the match length.
+ * A count nibble of 15 is followed by extension bytes that are added to it until
+ * one is less than 255.  The last sequence holds only literals.
+ */
+
+#define LZ_MIN_MATCH     4
+#define LZ_MAX_OFFSET    65535
+#define LZ_LAST_LITERALS 5  /* the last bytes of the input are always literals */
+#define LZ_MATCH_LIMIT   12 /* no match starts within this many bytes of the end of the input */
+#define LZ_RUN_MASK      15
+#define LZ_HASH_SIZE     (1 << BP_LZ_HASH_BITS)
+
+/******************************************************************************
+ LOCAL FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * lz_read32 - reads four unaligned bytes
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE uint32_t lz_read32(const uint8_t *p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/*--------------------------------------------------------------------------------------
+ * lz_hash - hashes four bytes into the match finder table
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE uint32_t lz_hash(uint32_t sequence)
+{
+    return (sequence * 2654435761U) >> (32 - BP_LZ_HASH_BITS);
+}
+
+/*--------------------------------------------------------------------------------------
+ * lz_write_count - writes the extension bytes of a literal count or match length
+ *
+ *  Returns pointer past the bytes written, or NULL when they do not fit
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE uint8_t *lz_write_count(uint8_t *op, const uint8_t *oend, int count)
+{
+    if (count >= LZ_RUN_MASK)
+    {
+        count -= LZ_RUN_MASK;
+        if (oend - op < (count / 255) + 1)
+        {
+            return NULL;
+        }
+
+        while (count >= 255)
+        {
+            *op++ = 255;
+            count -= 255;
+        }
+        *op++ = (uint8_t)count;
+    }
+
+    return op;
+}
+
+/*--------------------------------------------------------------------------------------
+ * lz_write_sequence - writes literals followed by a match (no match when match_len is zero)
+ *
+ *  Returns pointer past the sequence written, or NULL when it does not fit
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE uint8_t *lz_write_sequence(uint8_t *op, const uint8_t *oend, const uint8_t *literals, int literal_len,
+                                          int offset, int match_len)
+{
+    int match_code = match_len > 0 ? match_len - LZ_MIN_MATCH : 0;
+
+    /* Write Token */
+    if (op >= oend)
+    {
+        return NULL;
+    }
+    *op++ = (uint8_t)(((literal_len < LZ_RUN_MASK ? literal_len : LZ_RUN_MASK) << 4) |
+                      (match_code < LZ_RUN_MASK ? match_code : LZ_RUN_MASK));
+
+    /* Write Literals */
+    op = lz_write_count(op, oend, literal_len);
+    if (op == NULL || oend - op < literal_len)
+    {
+        return NULL;
+    }
+    memcpy(op, literals, literal_len);
+    op += literal_len;
+
+    /* Write Match */
+    if (match_len > 0)
+    {
+        if (oend - op < 2)
+        {
+            return NULL;
+        }
+        *op++ = (uint8_t)(offset & 0xFF);
+        *op++ = (uint8_t)(offset >> 8);
+        op    = lz_write_count(op, oend, match_code);
+    }
+
+    return op;
+}
+
+/*--------------------------------------------------------------------------------------
+ * lz_read_count - adds the extension bytes of a literal count or match length
+ *
+ *  Returns pointer past the bytes read, or NULL when the input ends first
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE const uint8_t *lz_read_count(const uint8_t *ip, const uint8_t *iend, int *count)
+{
+    if (*count == LZ_RUN_MASK)
+    {
+        uint8_t ext;
+        do
+        {
+            if (ip >= iend)
+            {
+                return NULL;
+            }
+            ext = *ip++;
+            *count += ext;
+        } while (ext == 255);
+    }
+
+    return ip;
+}
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * bplib_lz_compress -
+ *
+ *  src - data to compress [INPUT]
+ *  src_size - number of bytes to compress [INPUT]
+ *  dst - buffer for the compressed data [OUTPUT]
+ *  dst_size - size of the buffer [INPUT]
+ *
+ *  Returns:    Size of compressed data, or zero when it does not fit in the buffer
+ *-------------------------------------------------------------------------------------*/
+int bplib_lz_compress(const void *src, int src_size, void *dst, int dst_size)
+{
+    const uint8_t *in          = (const uint8_t *)src;
+    uint8_t       *op          = (uint8_t *)dst;
+    const uint8_t *oend        = op + dst_size;
+    int            match_limit = src_size - LZ_LAST_LITERALS;
+    int            anchor      = 0;
+    int            i           = 0;
+    uint32_t       table[LZ_HASH_SIZE];
+
+    /* Check Parameters */
+    if (src == NULL || dst == NULL || src_size < 0 || dst_size <= 0)
+    {
+        return 0;
+    }
+
+    /* Find Matches */
+    memset(table, 0, sizeof(table));
+    while (i < src_size - LZ_MATCH_LIMIT)
+    {
+        uint32_t sequence  = lz_read32(&in[i]);
+        uint32_t h         = lz_hash(sequence);
+        int      candidate = (int)table[h];
+        table[h]           = (uint32_t)i;
+
+        if (candidate < i && (i - candidate) <= LZ_MAX_OFFSET && lz_read32(&in[candidate]) == sequence)
+        {
+            int match_len = LZ_MIN_MATCH;
+
+            /* Extend Match Backwards over Pending Literals */
+            while (i > anchor && candidate > 0 && in[i - 1] == in[candidate - 1])
+            {
+                i--;
+                candidate--;
+                match_len++;
+            }
+
+            /* Extend Match Forwards */
+            while (i + match_len < match_limit && in[i + match_len] == in[candidate + match_len])
+            {
+                match_len++;
+            }
+
+            /* Write Sequence */
+            op = lz_write_sequence(op, oend, &in[anchor], i - anchor, i - candidate, match_len);
+            if (op == NULL)
+            {
+                return 0;
+            }
+
+            i += match_len;
+            anchor = i;
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    /* Write Last Literals */
+    op = lz_write_sequence(op, oend, &in[anchor], src_size - anchor, 0, 0);
+    if (op == NULL)
+    {
+        return 0;
+    }
+
+    return (int)(op - (uint8_t *)dst);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_lz_decompress -
+ *
+ *  src - compressed data [INPUT]
+ *  src_size - number of bytes of compressed data [INPUT]
+ *  dst - buffer for the decompressed data [OUTPUT]
+ *  dst_size - size of the buffer [INPUT]
+ *
+ *  Returns:    Size of decompressed data, or BP_ERROR when the data is malformed or does not fit
+ *-------------------------------------------------------------------------------------*/
+int bplib_lz_decompress(const void *src, int src_size, void *dst, int dst_size)
+{
+    const uint8_t *ip   = (const uint8_t *)src;
+    const uint8_t *iend = ip + src_size;
+    uint8_t       *op   = (uint8_t *)dst;
+    const uint8_t *oend = op + dst_size;
+
+    /* Check Parameters */
+    if (src == NULL || dst == NULL || src_size <= 0 || dst_size < 0)
+    {
+        return BP_ERROR;
+    }
+
+    while (ip < iend)
+    {
+        uint8_t token       = *ip++;
+        int     literal_len = token >> 4;
+        int     match_len   = token & LZ_RUN_MASK;
+
+        /* Copy Literals */
+        ip = lz_read_count(ip, iend, &literal_len);
+        if (ip == NULL || literal_len > iend - ip || literal_len > oend - op)
+        {
+            return BP_ERROR;
+        }
+        memcpy(op, ip, literal_len);
+        op += literal_len;
+        ip += literal_len;
+
+        /* Last Sequence has No Match */
+        if (ip == iend)
+        {
+            break;
+        }
+
+        /* Read Match Offset */
+        if (iend - ip < 2)
+        {
+            return BP_ERROR;
+        }
+        int offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > op - (uint8_t *)dst)
+        {
+            return BP_ERROR;
+        }
+
+        /* Copy Match (byte by byte since it may overlap the output) */
+        ip = lz_read_count(ip, iend, &match_len);
+        if (ip == NULL)
+        {
+            return BP_ERROR;
+        }
+        match_len += LZ_MIN_MATCH;
+        if (match_len > oend - op)
+        {
+            return BP_ERROR;
+        }
+
+        const uint8_t *match = op - offset;
+        while (match_len-- > 0)
+        {
+            *op++ = *match++;
+        }
+    }
+
+    return (int)(op - (uint8_t *)dst);
+}
@@ -1138,7 +1138,7 @@ int rb_tree_create(bp_val_t max_size, rb_tree_t *tree)
 
     /* Allocate a block of memory for the nodes in the tree and add them all to the
        the free nodes queue. */
-    tree->node_block = (rb_node_t *)bplib_os_calloc(max_size * sizeof(rb_node_t));
+    tree->node_block = (rb_node_t *)bplib_os_calloc_tag(max_size * sizeof(rb_node_t), BP_MEM_CUSTODY);
     if (tree->node_block == NULL)
     {
         /* If no memory is allocated return an empty tree. */
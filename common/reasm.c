@@ -0,0 +1,315 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "bplib.h"
+#include "bplib_os.h"
+#include "reasm.h"
+
+/******************************************************************************
+ LOCAL FUNCTIONS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * slot_find - returns slot reassembling the ADU, or a free slot when there is none
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int slot_find(reasm_t *reasm, const bp_adu_id_t *adu, int *free_slot)
+{
+    int s;
+
+    *free_slot = BP_ERROR;
+    for (s = 0; s < reasm->num_slots; s++)
+    {
+        reasm_slot_t *slot = &reasm->slots[s];
+        if (!slot->in_use)
+        {
+            if (*free_slot == BP_ERROR)
+                *free_slot = s;
+        }
+        else if (!slot->complete && slot->adu.node == adu->node && slot->adu.service == adu->service &&
+                 slot->adu.createsec == adu->createsec && slot->adu.createseq == adu->createseq)
+        {
+            return s;
+        }
+    }
+
+    return BP_ERROR;
+}
+
+/*----------------------------------------------------------------------------
+ * range_add - merges bytes first through last into the ranges of the slot
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int range_add(reasm_slot_t *slot, int max_ranges, bp_val_t first, bp_val_t last)
+{
+    rb_range_t *ranges = slot->ranges;
+    int         n      = slot->num_ranges;
+    int         i      = 0;
+    int         j;
+
+    /* Skip Ranges Ending Before the New Bytes (and not adjacent to them) */
+    while (i < n && ranges[i].value + ranges[i].offset + 1 < first)
+    {
+        i++;
+    }
+
+    /* Absorb Ranges Overlapping or Adjacent to the New Bytes */
+    for (j = i; j < n && ranges[j].value <= last + 1; j++)
+    {
+        bp_val_t end = ranges[j].value + ranges[j].offset;
+        if (ranges[j].value < first)
+            first = ranges[j].value;
+        if (end > last)
+            last = end;
+    }
+
+    /* Place Merged Range */
+    if (j == i)
+    {
+        if (n >= max_ranges)
+        {
+            return BP_ERROR;
+        }
+        memmove(&ranges[i + 1], &ranges[i], sizeof(rb_range_t) * (n - i));
+        n++;
+    }
+    else if (j > i + 1)
+    {
+        memmove(&ranges[i + 1], &ranges[j], sizeof(rb_range_t) * (n - j));
+        n -= j - i - 1;
+    }
+
+    ranges[i].value  = first;
+    ranges[i].offset = last - first;
+    slot->num_ranges = n;
+
+    return BP_SUCCESS;
+}
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Create - allocates the slots and the one buffer fragments are written into
+ *----------------------------------------------------------------------------*/
+int reasm_create(reasm_t **reasm, int num_slots, int slot_size, int max_ranges)
+{
+    int s;
+
+    /* Check Parameters */
+    if (num_slots <= 0 || slot_size <= 0 || max_ranges <= 0)
+    {
+        return BP_ERROR;
+    }
+
+    /* Allocate Structure */
+    *reasm = (reasm_t *)bplib_os_calloc_tag(sizeof(reasm_t), BP_MEM_REASM);
+    if (*reasm == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    /* Allocate Slots, Ranges, and Buffer */
+    (*reasm)->slots  = (reasm_slot_t *)bplib_os_calloc_tag(sizeof(reasm_slot_t) * num_slots, BP_MEM_REASM);
+    (*reasm)->ranges = (rb_range_t *)bplib_os_calloc_tag(sizeof(rb_range_t) * num_slots * max_ranges, BP_MEM_REASM);
+    (*reasm)->buffer = (uint8_t *)bplib_os_calloc_tag((size_t)num_slots * (size_t)slot_size, BP_MEM_REASM);
+    if ((*reasm)->slots == NULL || (*reasm)->ranges == NULL || (*reasm)->buffer == NULL)
+    {
+        reasm_destroy(*reasm);
+        *reasm = NULL;
+        return BP_ERROR;
+    }
+
+    /* Initialize Slots */
+    for (s = 0; s < num_slots; s++)
+    {
+        (*reasm)->slots[s].ranges = &(*reasm)->ranges[s * max_ranges];
+        (*reasm)->slots[s].buffer = &(*reasm)->buffer[(size_t)s * (size_t)slot_size];
+    }
+
+    /* Initialize Attributes */
+    (*reasm)->num_slots  = num_slots;
+    (*reasm)->slot_size  = slot_size;
+    (*reasm)->max_ranges = max_ranges;
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * Destroy - frees memory allocated by create
+ *----------------------------------------------------------------------------*/
+int reasm_destroy(reasm_t *reasm)
+{
+    if (reasm)
+    {
+        if (reasm->slots)
+            bplib_os_free(reasm->slots);
+        if (reasm->ranges)
+            bplib_os_free(reasm->ranges);
+        if (reasm->buffer)
+            bplib_os_free(reasm->buffer);
+        bplib_os_free(reasm);
+    }
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * Insert - writes fragment into place in the buffer of its ADU
+ *
+ *  returns BP_SUCCESS when the ADU is still missing bytes, BP_PENDING_ACCEPTANCE
+ *  when the fragment completed it (the slot is held until released), BP_FULL when
+ *  no slot is free, and BP_ERROR when the fragment cannot be reassembled
+ *----------------------------------------------------------------------------*/
+int reasm_insert(reasm_t *reasm, const bp_adu_id_t *adu, bp_val_t exprtime, bp_val_t adu_length, bp_val_t offset,
+                 const uint8_t *data, int size, int *slot)
+{
+    reasm_slot_t *rs;
+    int           free_slot;
+    int           s;
+
+    /* Check Fragment Fits in ADU and ADU Fits in Slot */
+    if (size <= 0 || adu_length == 0 || adu_length > (bp_val_t)reasm->slot_size || offset >= adu_length ||
+        (bp_val_t)size > adu_length - offset)
+    {
+        return BP_ERROR;
+    }
+
+    /* Find Slot */
+    s = slot_find(reasm, adu, &free_slot);
+    if (s == BP_ERROR)
+    {
+        if (free_slot == BP_ERROR)
+        {
+            return BP_FULL;
+        }
+
+        s              = free_slot;
+        rs             = &reasm->slots[s];
+        rs->in_use     = true;
+        rs->complete   = false;
+        rs->adu        = *adu;
+        rs->exprtime   = exprtime;
+        rs->adu_length = adu_length;
+        rs->num_ranges = 0;
+    }
+    else
+    {
+        rs = &reasm->slots[s];
+        if (rs->adu_length != adu_length)
+        {
+            return BP_ERROR;
+        }
+    }
+
+    /* Record Bytes Received */
+    if (range_add(rs, reasm->max_ranges, offset, offset + size - 1) != BP_SUCCESS)
+    {
+        return BP_ERROR;
+    }
+
+    /* Write Fragment into Place */
+    memcpy(&rs->buffer[offset], data, size);
+    *slot = s;
+
+    /* Check ADU Complete */
+    if (rs->num_ranges == 1 && rs->ranges[0].value == 0 && rs->ranges[0].offset == adu_length - 1)
+    {
+        rs->complete = true;
+        return BP_PENDING_ACCEPTANCE;
+    }
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * Get - returns the reassembled ADU held in a slot
+ *----------------------------------------------------------------------------*/
+int reasm_get(reasm_t *reasm, int slot, const uint8_t **data, int *size)
+{
+    if (slot < 0 || slot >= reasm->num_slots || !reasm->slots[slot].complete)
+    {
+        return BP_ERROR;
+    }
+
+    *data = reasm->slots[slot].buffer;
+    *size = (int)reasm->slots[slot].adu_length;
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * Release - frees a slot once its reassembled ADU has been taken
+ *----------------------------------------------------------------------------*/
+int reasm_release(reasm_t *reasm, int slot)
+{
+    if (slot < 0 || slot >= reasm->num_slots)
+    {
+        return BP_ERROR;
+    }
+
+    reasm->slots[slot].in_use   = false;
+    reasm->slots[slot].complete = false;
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * Expire - drops partially reassembled ADUs that have expired, returns number dropped
+ *----------------------------------------------------------------------------*/
+int reasm_expire(reasm_t *reasm, reasm_expired_func_t expired, void *parm)
+{
+    int count = 0;
+    int s;
+
+    for (s = 0; s < reasm->num_slots; s++)
+    {
+        reasm_slot_t *rs = &reasm->slots[s];
+        if (rs->in_use && !rs->complete && expired(parm, rs->exprtime))
+        {
+            rs->in_use = false;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/*----------------------------------------------------------------------------
+ * Count - returns number of ADUs being reassembled
+ *----------------------------------------------------------------------------*/
+int reasm_count(reasm_t *reasm)
+{
+    int count = 0;
+    int s;
+
+    for (s = 0; s < reasm->num_slots; s++)
+    {
+        if (reasm->slots[s].in_use)
+            count++;
+    }
+
+    return count;
+}
@@ -0,0 +1,76 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef REASM_H
+#define REASM_H
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include "bplib.h"
+#include "bundle_types.h"
+#include "rb_tree.h"
+
+/******************************************************************************
+ TYPEDEFS
+ ******************************************************************************/
+
+/* Checks if an ADU being reassembled has expired (see reasm_expire) */
+typedef bool (*reasm_expired_func_t)(void *parm, bp_val_t exprtime);
+
+/* ADU Being Reassembled */
+typedef struct
+{
+    bool        in_use;     /* slot holds fragments of an ADU */
+    bool        complete;   /* every byte of the ADU has been received, waiting to be released */
+    bp_adu_id_t adu;        /* source and creation timestamp of the ADU */
+    bp_val_t    exprtime;   /* expiration time of the bundles carrying the ADU */
+    bp_val_t    adu_length; /* size of the whole ADU in bytes */
+    int         num_ranges; /* ranges of bytes received so far */
+    rb_range_t *ranges;     /* sorted, none overlapping or adjacent; offset is the last byte minus the first */
+    uint8_t    *buffer;     /* slot's part of the reassembly buffer, fragments are written into place */
+} reasm_slot_t;
+
+/* Reassembly Control Structure */
+typedef struct
+{
+    reasm_slot_t *slots;      /* ADUs being reassembled */
+    int           num_slots;  /* number of ADUs that can be reassembled at the same time */
+    int           slot_size;  /* largest ADU that can be reassembled */
+    int           max_ranges; /* gaps that can be tracked in each ADU, plus one */
+    uint8_t      *buffer;     /* one allocation holding the buffers of all slots */
+    rb_range_t   *ranges;     /* one allocation holding the ranges of all slots */
+} reasm_t;
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+int reasm_create(reasm_t **reasm, int num_slots, int slot_size, int max_ranges);
+int reasm_destroy(reasm_t *reasm);
+int reasm_insert(reasm_t *reasm, const bp_adu_id_t *adu, bp_val_t exprtime, bp_val_t adu_length, bp_val_t offset,
+                 const uint8_t *data, int size, int *slot);
+int reasm_get(reasm_t *reasm, int slot, const uint8_t **data, int *size);
+int reasm_release(reasm_t *reasm, int slot);
+int reasm_expire(reasm_t *reasm, reasm_expired_func_t expired, void *parm);
+int reasm_count(reasm_t *reasm);
+
+#endif /* REASM_H */
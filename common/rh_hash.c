@@ -38,6 +38,32 @@
  LOCAL FUNCTIONS
  ******************************************************************************/
 
+/*----------------------------------------------------------------------------
+ * set_bundle
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void set_bundle(rh_hash_t *rh_hash, bp_index_t index, bp_active_bundle_t bundle)
+{
+    rh_hash->keys[index].cid    = bundle.cid;
+    rh_hash->keys[index].sid    = bundle.sid;
+    rh_hash->nodes[index].retx  = bundle.retx;
+    rh_hash->nodes[index].timer = bundle.timer;
+    rh_hash->nodes[index].cos   = bundle.cos;
+}
+
+/*----------------------------------------------------------------------------
+ * get_bundle
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bp_active_bundle_t get_bundle(rh_hash_t *rh_hash, bp_index_t index)
+{
+    bp_active_bundle_t bundle;
+    bundle.sid   = rh_hash->keys[index].sid;
+    bundle.retx  = rh_hash->nodes[index].retx;
+    bundle.cid   = rh_hash->keys[index].cid;
+    bundle.timer = rh_hash->nodes[index].timer;
+    bundle.cos   = rh_hash->nodes[index].cos;
+    return bundle;
+}
+
 /*----------------------------------------------------------------------------
  * overwrite_node
  *----------------------------------------------------------------------------*/
@@ -46,15 +72,15 @@ BP_LOCAL_SCOPE int overwrite_node(rh_hash_t *rh_hash, bp_index_t index, bp_activ
     if (overwrite)
     {
         /* Set Data */
-        rh_hash->table[index].bundle = bundle;
+        set_bundle(rh_hash, index, bundle);
 
         /* Bridge Over Entry */
-        bp_index_t before_index = rh_hash->table[index].before;
-        bp_index_t after_index  = rh_hash->table[index].after;
+        bp_index_t before_index = rh_hash->nodes[index].before;
+        bp_index_t after_index  = rh_hash->nodes[index].after;
         if (before_index != NULL_INDEX)
-            rh_hash->table[before_index].after = after_index;
+            rh_hash->nodes[before_index].after = after_index;
         if (after_index != NULL_INDEX)
-            rh_hash->table[after_index].before = before_index;
+            rh_hash->nodes[after_index].before = before_index;
 
         /* Check if Overwriting Oldest/Newest */
         if (index == rh_hash->oldest_entry)
@@ -65,13 +91,13 @@ BP_LOCAL_SCOPE int overwrite_node(rh_hash_t *rh_hash, bp_index_t index, bp_activ
         /* Set Current Entry as Newest */
         bp_index_t oldest_index      = rh_hash->oldest_entry;
         bp_index_t newest_index      = rh_hash->newest_entry;
-        rh_hash->table[index].after  = NULL_INDEX;
-        rh_hash->table[index].before = newest_index;
+        rh_hash->nodes[index].after  = NULL_INDEX;
+        rh_hash->nodes[index].before = newest_index;
         rh_hash->newest_entry        = index;
 
         /* Update Newest/Oldest */
         if (newest_index != NULL_INDEX)
-            rh_hash->table[newest_index].after = index;
+            rh_hash->nodes[newest_index].after = index;
         if (oldest_index == NULL_INDEX)
             rh_hash->oldest_entry = index;
 
@@ -90,11 +116,11 @@ BP_LOCAL_SCOPE int overwrite_node(rh_hash_t *rh_hash, bp_index_t index, bp_activ
  *----------------------------------------------------------------------------*/
 BP_LOCAL_SCOPE void write_node(rh_hash_t *rh_hash, bp_index_t index, bp_active_bundle_t bundle)
 {
-    rh_hash->table[index].bundle = bundle;
-    rh_hash->table[index].next   = NULL_INDEX;
-    rh_hash->table[index].prev   = NULL_INDEX;
-    rh_hash->table[index].after  = NULL_INDEX;
-    rh_hash->table[index].before = rh_hash->newest_entry;
+    set_bundle(rh_hash, index, bundle);
+    rh_hash->keys[index].next    = NULL_INDEX;
+    rh_hash->keys[index].prev    = NULL_INDEX;
+    rh_hash->nodes[index].after  = NULL_INDEX;
+    rh_hash->nodes[index].before = rh_hash->newest_entry;
 
     /* Update Time Order */
     if (rh_hash->oldest_entry == NULL_INDEX)
@@ -106,11 +132,123 @@ BP_LOCAL_SCOPE void write_node(rh_hash_t *rh_hash, bp_index_t index, bp_active_b
     else
     {
         /* Not First Entry */
-        rh_hash->table[rh_hash->newest_entry].after = index;
+        rh_hash->nodes[rh_hash->newest_entry].after = index;
         rh_hash->newest_entry                       = index;
     }
 }
 
+/*----------------------------------------------------------------------------
+ * find_node - returns index of entry holding custody id, or NULL_INDEX
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bp_index_t find_node(rh_hash_t *rh_hash, bp_val_t cid)
+{
+    bp_index_t curr_index = HASH_CID(cid, rh_hash->size);
+
+    while (curr_index != NULL_INDEX)
+    {
+        if (rh_hash->keys[curr_index].sid == BP_SID_VACANT) /* end of chain */
+        {
+            curr_index = NULL_INDEX;
+        }
+        else if (rh_hash->keys[curr_index].cid == cid) /* matched custody ID */
+        {
+            break;
+        }
+        else /* go to next */
+        {
+            curr_index = rh_hash->keys[curr_index].next;
+        }
+    }
+
+    return curr_index;
+}
+
+/*----------------------------------------------------------------------------
+ * remove_node - removes entry, returns index of slot vacated
+ *
+ *  the vacated slot differs from the removed entry when the end of the
+ *  chain is moved into the removed entry's slot
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bp_index_t remove_node(rh_hash_t *rh_hash, bp_index_t curr_index)
+{
+    /* Update Time Order (Bridge) */
+    bp_index_t after_index  = rh_hash->nodes[curr_index].after;
+    bp_index_t before_index = rh_hash->nodes[curr_index].before;
+    if (after_index != NULL_INDEX)
+    {
+        rh_hash->nodes[after_index].before = before_index;
+    }
+    if (before_index != NULL_INDEX)
+    {
+        rh_hash->nodes[before_index].after = after_index;
+    }
+
+    /* Update Newest and Oldest Entry */
+    if (curr_index == rh_hash->newest_entry)
+    {
+        rh_hash->newest_entry = before_index;
+    }
+    if (curr_index == rh_hash->oldest_entry)
+    {
+        rh_hash->oldest_entry = after_index;
+    }
+
+    /* Remove End of Chain */
+    bp_index_t end_index  = curr_index;
+    bp_index_t next_index = rh_hash->keys[curr_index].next;
+    if (next_index != NULL_INDEX)
+    {
+        /* Transverse to End of Chain */
+        end_index = next_index;
+        while (rh_hash->keys[end_index].next != NULL_INDEX)
+        {
+            end_index = rh_hash->keys[end_index].next;
+        }
+
+        /* Copy End of Chain into Removed Slot */
+        set_bundle(rh_hash, curr_index, get_bundle(rh_hash, end_index));
+        rh_hash->nodes[curr_index].before = rh_hash->nodes[end_index].before;
+        rh_hash->nodes[curr_index].after  = rh_hash->nodes[end_index].after;
+
+        /* Update Time Order (Move) */
+        after_index  = rh_hash->nodes[end_index].after;
+        before_index = rh_hash->nodes[end_index].before;
+        if (after_index != NULL_INDEX)
+        {
+            rh_hash->nodes[after_index].before = curr_index;
+        }
+        if (before_index != NULL_INDEX)
+        {
+            rh_hash->nodes[before_index].after = curr_index;
+        }
+
+        /* Update Newest and Oldest Entry */
+        if (end_index == rh_hash->newest_entry)
+        {
+            rh_hash->newest_entry = curr_index;
+        }
+        if (end_index == rh_hash->oldest_entry)
+        {
+            rh_hash->oldest_entry = curr_index;
+        }
+    }
+
+    /* Remove End of Chain */
+    rh_hash->keys[end_index].sid = BP_SID_VACANT;
+
+    /* Update Hash Order */
+    bp_index_t prev_index = rh_hash->keys[end_index].prev;
+    if (prev_index != NULL_INDEX)
+    {
+        rh_hash->keys[prev_index].next = NULL_INDEX;
+    }
+
+    /* Update Statistics */
+    rh_hash->num_entries--;
+
+    return end_index;
+}
+
 /******************************************************************************
  EXPORTED FUNCTIONS
  ******************************************************************************/
@@ -127,33 +265,42 @@ int rh_hash_create(rh_hash_t **rh_hash, int size)
     }
 
     /* Allocate Hash Structure */
-    *rh_hash = (rh_hash_t *)bplib_os_calloc(sizeof(rh_hash_t));
+    *rh_hash = (rh_hash_t *)bplib_os_calloc_tag(sizeof(rh_hash_t), BP_MEM_ACTIVE);
+
+    if (*rh_hash == NULL)
+    {
+        return BP_ERROR;
+    }
 
     if (size > 0)
     {
         int i;
 
-        /* Allocate Hash Table */
-        (*rh_hash)->table = (rh_hash_node_t *)bplib_os_calloc(size * sizeof(rh_hash_node_t));
-        if ((*rh_hash)->table == NULL)
+        /* Allocate Hash Table (keys and nodes are separate arrays) */
+        (*rh_hash)->keys  = (rh_hash_key_t *)bplib_os_calloc_tag(size * sizeof(rh_hash_key_t), BP_MEM_ACTIVE);
+        (*rh_hash)->nodes = (rh_hash_node_t *)bplib_os_calloc_tag(size * sizeof(rh_hash_node_t), BP_MEM_ACTIVE);
+        if ((*rh_hash)->keys == NULL || (*rh_hash)->nodes == NULL)
         {
+            rh_hash_destroy(*rh_hash);
+            *rh_hash = NULL;
             return BP_ERROR;
         }
 
         /* Initialize Hash Table to Empty */
         for (i = 0; i < size; i++)
         {
-            (*rh_hash)->table[i].bundle.sid = BP_SID_VACANT;
-            (*rh_hash)->table[i].next       = NULL_INDEX;
-            (*rh_hash)->table[i].prev       = NULL_INDEX;
-            (*rh_hash)->table[i].before     = NULL_INDEX;
-            (*rh_hash)->table[i].after      = NULL_INDEX;
+            (*rh_hash)->keys[i].sid     = BP_SID_VACANT;
+            (*rh_hash)->keys[i].next    = NULL_INDEX;
+            (*rh_hash)->keys[i].prev    = NULL_INDEX;
+            (*rh_hash)->nodes[i].before = NULL_INDEX;
+            (*rh_hash)->nodes[i].after  = NULL_INDEX;
         }
     }
     else
     {
         /* Empty Table */
-        (*rh_hash)->table = NULL;
+        (*rh_hash)->keys  = NULL;
+        (*rh_hash)->nodes = NULL;
     }
 
     /* Initialize Hash Table Attributes */
@@ -173,9 +320,13 @@ int rh_hash_destroy(rh_hash_t *rh_hash)
 {
     if (rh_hash)
     {
-        if (rh_hash->table)
+        if (rh_hash->keys)
+        {
+            bplib_os_free(rh_hash->keys);
+        }
+        if (rh_hash->nodes)
         {
-            bplib_os_free(rh_hash->table);
+            bplib_os_free(rh_hash->nodes);
         }
         bplib_os_free(rh_hash);
     }
@@ -191,37 +342,37 @@ int rh_hash_add(rh_hash_t *rh_hash, bp_active_bundle_t bundle, bool overwrite)
     bp_index_t curr_index = HASH_CID(bundle.cid, rh_hash->size);
 
     /* Add Entry to Hash */
-    if (rh_hash->table[curr_index].bundle.sid == BP_SID_VACANT)
+    if (rh_hash->keys[curr_index].sid == BP_SID_VACANT)
     {
         write_node(rh_hash, curr_index, bundle);
     }
     else /* collision */
     {
         /* Check Current Slot for Duplicate */
-        if (rh_hash->table[curr_index].bundle.cid == bundle.cid)
+        if (rh_hash->keys[curr_index].cid == bundle.cid)
         {
             return overwrite_node(rh_hash, curr_index, bundle, overwrite);
         }
 
         /* Transverse to End of Chain */
         bp_index_t end_index  = curr_index;
-        bp_index_t scan_index = rh_hash->table[curr_index].next;
+        bp_index_t scan_index = rh_hash->keys[curr_index].next;
         while (scan_index != NULL_INDEX)
         {
             /* Check Slot for Duplicate */
-            if (rh_hash->table[scan_index].bundle.cid == bundle.cid)
+            if (rh_hash->keys[scan_index].cid == bundle.cid)
             {
                 return overwrite_node(rh_hash, scan_index, bundle, overwrite);
             }
 
             /* Go To Next Slot */
             end_index  = scan_index;
-            scan_index = rh_hash->table[scan_index].next;
+            scan_index = rh_hash->keys[scan_index].next;
         }
 
         /* Find First Open Hash Slot */
         bp_index_t open_index = (curr_index + 1) % rh_hash->size;
-        while ((rh_hash->table[open_index].bundle.sid != BP_SID_VACANT) && (open_index != curr_index))
+        while ((rh_hash->keys[open_index].sid != BP_SID_VACANT) && (open_index != curr_index))
         {
             open_index = (open_index + 1) % rh_hash->size;
         }
@@ -233,54 +384,55 @@ int rh_hash_add(rh_hash_t *rh_hash, bp_active_bundle_t bundle, bool overwrite)
         }
 
         /* Insert Node */
-        if (rh_hash->table[curr_index].prev == NULL_INDEX) /* End of Chain Insertion (chain == 1) */
+        if (rh_hash->keys[curr_index].prev == NULL_INDEX) /* End of Chain Insertion (chain == 1) */
         {
             /* Add Entry to Open Slot at End of Chain */
             write_node(rh_hash, open_index, bundle);
-            rh_hash->table[end_index].next  = open_index;
-            rh_hash->table[open_index].prev = end_index;
+            rh_hash->keys[end_index].next  = open_index;
+            rh_hash->keys[open_index].prev = end_index;
         }
         else /* Robin Hood Insertion (chain > 1) */
         {
             /* Copy Current Slot to Open Slot */
-            rh_hash->table[open_index] = rh_hash->table[curr_index];
+            rh_hash->keys[open_index]  = rh_hash->keys[curr_index];
+            rh_hash->nodes[open_index] = rh_hash->nodes[curr_index];
 
             /* Update Hash Links */
-            bp_index_t next_index = rh_hash->table[curr_index].next;
-            bp_index_t prev_index = rh_hash->table[curr_index].prev;
+            bp_index_t next_index = rh_hash->keys[curr_index].next;
+            bp_index_t prev_index = rh_hash->keys[curr_index].prev;
             if (next_index != NULL_INDEX)
             {
-                rh_hash->table[next_index].prev = open_index;
+                rh_hash->keys[next_index].prev = open_index;
             }
             if (prev_index != NULL_INDEX)
             {
-                rh_hash->table[prev_index].next = open_index;
+                rh_hash->keys[prev_index].next = open_index;
             }
 
             /* Update Time Order (Move) */
-            bp_index_t after_index  = rh_hash->table[curr_index].after;
-            bp_index_t before_index = rh_hash->table[curr_index].before;
+            bp_index_t after_index  = rh_hash->nodes[curr_index].after;
+            bp_index_t before_index = rh_hash->nodes[curr_index].before;
             if (after_index != NULL_INDEX)
             {
-                rh_hash->table[after_index].before = open_index;
+                rh_hash->nodes[after_index].before = open_index;
             }
             if (before_index != NULL_INDEX)
             {
-                rh_hash->table[before_index].after = open_index;
+                rh_hash->nodes[before_index].after = open_index;
             }
 
             /* Update Oldest Entry */
             if (rh_hash->oldest_entry == curr_index)
             {
                 rh_hash->oldest_entry                        = open_index;
-                rh_hash->table[rh_hash->oldest_entry].before = NULL_INDEX;
+                rh_hash->nodes[rh_hash->oldest_entry].before = NULL_INDEX;
             }
 
             /* Update Newest Entry */
             if (rh_hash->newest_entry == curr_index)
             {
                 rh_hash->newest_entry                       = open_index;
-                rh_hash->table[rh_hash->newest_entry].after = NULL_INDEX;
+                rh_hash->nodes[rh_hash->newest_entry].after = NULL_INDEX;
             }
 
             /* Add Entry to Current Slot */
@@ -304,7 +456,7 @@ int rh_hash_next(rh_hash_t *rh_hash, bp_active_bundle_t *bundle)
     {
         if (bundle)
         {
-            *bundle = rh_hash->table[rh_hash->oldest_entry].bundle;
+            *bundle = get_bundle(rh_hash, rh_hash->oldest_entry);
         }
         return BP_SUCCESS;
     }
@@ -317,26 +469,8 @@ int rh_hash_next(rh_hash_t *rh_hash, bp_active_bundle_t *bundle)
  *----------------------------------------------------------------------------*/
 int rh_hash_remove(rh_hash_t *rh_hash, bp_val_t cid, bp_active_bundle_t *bundle)
 {
-    bp_index_t curr_index = HASH_CID(cid, rh_hash->size);
-
     /* Find Node to Remove */
-    while (curr_index != NULL_INDEX)
-    {
-        if (rh_hash->table[curr_index].bundle.sid == BP_SID_VACANT) /* end of chain */
-        {
-            curr_index = NULL_INDEX;
-        }
-        else if (rh_hash->table[curr_index].bundle.cid == cid) /* matched custody ID */
-        {
-            break;
-        }
-        else /* go to next */
-        {
-            curr_index = rh_hash->table[curr_index].next;
-        }
-    }
-
-    /* Check if Node Found */
+    bp_index_t curr_index = find_node(rh_hash, cid);
     if (curr_index == NULL_INDEX)
     {
         return BP_ERROR;
@@ -345,86 +479,71 @@ int rh_hash_remove(rh_hash_t *rh_hash, bp_val_t cid, bp_active_bundle_t *bundle)
     /* Return Bundle */
     if (bundle)
     {
-        *bundle = rh_hash->table[curr_index].bundle;
+        *bundle = get_bundle(rh_hash, curr_index);
     }
 
-    /* Update Time Order (Bridge) */
-    bp_index_t after_index  = rh_hash->table[curr_index].after;
-    bp_index_t before_index = rh_hash->table[curr_index].before;
-    if (after_index != NULL_INDEX)
-    {
-        rh_hash->table[after_index].before = before_index;
-    }
-    if (before_index != NULL_INDEX)
-    {
-        rh_hash->table[before_index].after = after_index;
-    }
+    /* Remove Node */
+    remove_node(rh_hash, curr_index);
 
-    /* Update Newest and Oldest Entry */
-    if (curr_index == rh_hash->newest_entry)
-    {
-        rh_hash->newest_entry = before_index;
-    }
-    if (curr_index == rh_hash->oldest_entry)
-    {
-        rh_hash->oldest_entry = after_index;
-    }
-
-    /* Remove End of Chain */
-    bp_index_t end_index  = curr_index;
-    bp_index_t next_index = rh_hash->table[curr_index].next;
-    if (next_index != NULL_INDEX)
-    {
-        /* Transverse to End of Chain */
-        end_index = next_index;
-        while (rh_hash->table[end_index].next != NULL_INDEX)
-        {
-            end_index = rh_hash->table[end_index].next;
-        }
-
-        /* Copy End of Chain into Removed Slot */
-        rh_hash->table[curr_index].bundle = rh_hash->table[end_index].bundle;
-        rh_hash->table[curr_index].before = rh_hash->table[end_index].before;
-        rh_hash->table[curr_index].after  = rh_hash->table[end_index].after;
+    /* Return Success */
+    return BP_SUCCESS;
+}
 
-        /* Update Time Order (Move) */
-        after_index  = rh_hash->table[end_index].after;
-        before_index = rh_hash->table[end_index].before;
-        if (after_index != NULL_INDEX)
-        {
-            rh_hash->table[after_index].before = curr_index;
-        }
-        if (before_index != NULL_INDEX)
-        {
-            rh_hash->table[before_index].after = curr_index;
-        }
+/*----------------------------------------------------------------------------
+ * Remove Range - removes bundles with custody ids in [cid, cid + count)
+ *
+ *  ranges smaller than the table are looked up one custody id at a time,
+ *  larger ranges walk the table in time order instead, so the cost is bounded
+ *  by the smaller of the two; returns number of bundles removed
+ *----------------------------------------------------------------------------*/
+int rh_hash_remove_range(rh_hash_t *rh_hash, bp_val_t cid, bp_val_t count, bp_removed_func_t removed, void *parm)
+{
+    bp_active_bundle_t bundle;
+    int                num_removed = 0;
 
-        /* Update Newest and Oldest Entry */
-        if (end_index == rh_hash->newest_entry)
-        {
-            rh_hash->newest_entry = curr_index;
-        }
-        if (end_index == rh_hash->oldest_entry)
+    if (count < rh_hash->num_entries)
+    {
+        bp_val_t i;
+        for (i = 0; i < count; i++)
         {
-            rh_hash->oldest_entry = curr_index;
+            bp_index_t curr_index = find_node(rh_hash, cid + i);
+            if (curr_index != NULL_INDEX)
+            {
+                bundle = get_bundle(rh_hash, curr_index);
+                remove_node(rh_hash, curr_index);
+                if (removed)
+                {
+                    removed(parm, &bundle);
+                }
+                num_removed++;
+            }
         }
     }
-
-    /* Remove End of Chain */
-    rh_hash->table[end_index].bundle.sid = BP_SID_VACANT;
-
-    /* Update Hash Order */
-    bp_index_t prev_index = rh_hash->table[end_index].prev;
-    if (prev_index != NULL_INDEX)
+    else
     {
-        rh_hash->table[prev_index].next = NULL_INDEX;
+        bp_index_t curr_index = rh_hash->oldest_entry;
+        while (curr_index != NULL_INDEX)
+        {
+            bp_index_t after_index = rh_hash->nodes[curr_index].after;
+            if (rh_hash->keys[curr_index].cid - cid < count)
+            {
+                bundle = get_bundle(rh_hash, curr_index);
+                if (remove_node(rh_hash, curr_index) == after_index)
+                {
+                    /* Next Entry Was Moved Into Removed Slot */
+                    after_index = curr_index;
+                }
+                if (removed)
+                {
+                    removed(parm, &bundle);
+                }
+                num_removed++;
+            }
+            curr_index = after_index;
+        }
     }
 
-    /* Update Statistics */
-    rh_hash->num_entries--;
-
-    /* Return Success */
-    return BP_SUCCESS;
+    return num_removed;
 }
 
 /*----------------------------------------------------------------------------
@@ -450,3 +569,68 @@ int rh_hash_count(rh_hash_t *rh_hash)
 {
     return rh_hash->num_entries;
 }
+
+/*----------------------------------------------------------------------------
+ * Resize - rehashes the entries into a table of a new size
+ *
+ *  entries are added to the new table oldest first, so the time order is
+ *  kept; the table is left as it was if the entries do not fit or the new
+ *  table cannot be allocated
+ *----------------------------------------------------------------------------*/
+int rh_hash_resize(rh_hash_t *rh_hash, int size)
+{
+    rh_hash_t resized;
+    int       i;
+
+    /* Check Hash Size */
+    if (size <= 0 || (unsigned long)size > BP_MAX_INDEX || size < rh_hash->num_entries)
+    {
+        return BP_ERROR;
+    }
+
+    /* Allocate Resized Hash Table */
+    resized.keys  = (rh_hash_key_t *)bplib_os_calloc_tag(size * sizeof(rh_hash_key_t), BP_MEM_ACTIVE);
+    resized.nodes = (rh_hash_node_t *)bplib_os_calloc_tag(size * sizeof(rh_hash_node_t), BP_MEM_ACTIVE);
+    if (resized.keys == NULL || resized.nodes == NULL)
+    {
+        if (resized.keys)
+        {
+            bplib_os_free(resized.keys);
+        }
+        if (resized.nodes)
+        {
+            bplib_os_free(resized.nodes);
+        }
+        return BP_ERROR;
+    }
+
+    /* Initialize Resized Hash Table to Empty */
+    for (i = 0; i < size; i++)
+    {
+        resized.keys[i].sid     = BP_SID_VACANT;
+        resized.keys[i].next    = NULL_INDEX;
+        resized.keys[i].prev    = NULL_INDEX;
+        resized.nodes[i].before = NULL_INDEX;
+        resized.nodes[i].after  = NULL_INDEX;
+    }
+    resized.size         = size;
+    resized.num_entries  = 0;
+    resized.oldest_entry = NULL_INDEX;
+    resized.newest_entry = NULL_INDEX;
+
+    /* Rehash Entries in Time Order */
+    bp_index_t curr_index = rh_hash->oldest_entry;
+    while (curr_index != NULL_INDEX)
+    {
+        rh_hash_add(&resized, get_bundle(rh_hash, curr_index), false);
+        curr_index = rh_hash->nodes[curr_index].after;
+    }
+
+    /* Replace Hash Table */
+    bplib_os_free(rh_hash->keys);
+    bplib_os_free(rh_hash->nodes);
+    *rh_hash = resized;
+
+    /* Return Success */
+    return BP_SUCCESS;
+}
@@ -32,18 +32,33 @@
  TYPEDEFS
  ******************************************************************************/
 
+/*
+ * The table is split into two parallel arrays so that probing a chain only
+ * touches the keys; the rest of the bundle and the time order links are in
+ * the nodes, read once the matching entry is found.
+ */
+
+typedef struct
+{
+    bp_val_t   cid;  /* custody id of active bundle stored at this slot */
+    bp_sid_t   sid;  /* storage id of active bundle, BP_SID_VACANT when slot is empty */
+    bp_index_t next; /* next entry in chain */
+    bp_index_t prev; /* previous entry in chain */
+} rh_hash_key_t;
+
 typedef struct
 {
-    bp_active_bundle_t bundle; /* active bundle stored a this node */
-    bp_index_t         next;   /* next entry in chain */
-    bp_index_t         prev;   /* previous entry in chain */
-    bp_index_t         after;  /* next entry added to hash (time ordered) */
-    bp_index_t         before; /* previous entry added to hash (time ordered) */
+    bp_val_t   retx;   /* retransmit time of active bundle stored at this slot */
+    bp_index_t timer;  /* retransmit timer of active bundle stored at this slot */
+    bp_index_t after;  /* next entry added to hash (time ordered) */
+    bp_index_t before; /* previous entry added to hash (time ordered) */
+    uint8_t    cos;    /* class of service queue of active bundle stored at this slot */
 } rh_hash_node_t;
 
 typedef struct
 {
-    rh_hash_node_t *table;        /* hash table of active bundles */
+    rh_hash_key_t  *keys;         /* hash table of active bundles (probed) */
+    rh_hash_node_t *nodes;        /* hash table of active bundles (time order) */
     bp_index_t      size;         /* maximum (allocated) size of hash table */
     bp_index_t      num_entries;  /* number of active bundles in the hash table */
     bp_index_t      oldest_entry; /* oldest bundle in the hash table */
@@ -59,7 +74,9 @@ int rh_hash_destroy(rh_hash_t *rh_hash);
 int rh_hash_add(rh_hash_t *rh_hash, bp_active_bundle_t bundle, bool overwrite);
 int rh_hash_next(rh_hash_t *rh_hash, bp_active_bundle_t *bundle);
 int rh_hash_remove(rh_hash_t *rh_hash, bp_val_t cid, bp_active_bundle_t *bundle);
+int rh_hash_remove_range(rh_hash_t *rh_hash, bp_val_t cid, bp_val_t count, bp_removed_func_t removed, void *parm);
 int rh_hash_available(rh_hash_t *rh_hash, bp_val_t cid);
 int rh_hash_count(rh_hash_t *rh_hash);
+int rh_hash_resize(rh_hash_t *rh_hash, int size);
 
 #endif /* RH_HASH_H */
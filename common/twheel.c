@@ -0,0 +1,474 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include "bplib.h"
+#include "bplib_os.h"
+#include "twheel.h"
+
+/******************************************************************************
+ LOCAL FUNCTIONS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * timer_push - inserts timer at front of list
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void timer_push(twheel_t *twheel, bp_index_t *head, bp_index_t t)
+{
+    twheel_timer_t *timer = &twheel->timers[t];
+
+    timer->prev = TWHEEL_NULL_TIMER;
+    timer->next = *head;
+    timer->head = head;
+    if (*head != TWHEEL_NULL_TIMER)
+    {
+        twheel->timers[*head].prev = t;
+    }
+    *head = t;
+}
+
+/*----------------------------------------------------------------------------
+ * timer_append - inserts timer at end of expired list
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void timer_append(twheel_t *twheel, bp_index_t t)
+{
+    twheel_timer_t *timer = &twheel->timers[t];
+
+    timer->prev = twheel->expired_tail;
+    timer->next = TWHEEL_NULL_TIMER;
+    timer->head = &twheel->expired;
+    if (twheel->expired_tail != TWHEEL_NULL_TIMER)
+    {
+        twheel->timers[twheel->expired_tail].next = t;
+    }
+    else
+    {
+        twheel->expired = t;
+    }
+    twheel->expired_tail = t;
+}
+
+/*----------------------------------------------------------------------------
+ * timer_unlink - removes timer from the list it is in
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void timer_unlink(twheel_t *twheel, bp_index_t t)
+{
+    twheel_timer_t *timer = &twheel->timers[t];
+
+    if (timer->prev != TWHEEL_NULL_TIMER)
+    {
+        twheel->timers[timer->prev].next = timer->next;
+    }
+    else
+    {
+        *timer->head = timer->next;
+    }
+
+    if (timer->next != TWHEEL_NULL_TIMER)
+    {
+        twheel->timers[timer->next].prev = timer->prev;
+    }
+    else if (timer->head == &twheel->expired)
+    {
+        twheel->expired_tail = timer->prev;
+    }
+
+    timer->head = NULL;
+}
+
+/*----------------------------------------------------------------------------
+ * timer_place - puts timer into the slot of the level that covers its expiration
+ *
+ *  level L holds timers expiring within 2^((L+1)*SLOT_BITS) ticks of the next
+ *  tick to process; timers beyond the last level are placed in its furthest
+ *  slot and re-placed when that slot is cascaded
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void timer_place(twheel_t *twheel, bp_index_t t)
+{
+    bp_val_t expire = twheel->timers[t].expire;
+    bp_val_t tick   = twheel->now + 1;
+    int      level  = 0;
+
+    /* Check Already Expired */
+    if (expire < tick)
+    {
+        timer_append(twheel, t);
+        return;
+    }
+
+    /* Find Level */
+    bp_val_t delta = expire - tick;
+    while (level < (TWHEEL_NUM_LEVELS - 1) && (delta >> ((level + 1) * TWHEEL_SLOT_BITS)) != 0)
+    {
+        level++;
+    }
+
+    /* Clamp to Range of Last Level */
+    if ((delta >> (TWHEEL_NUM_LEVELS * TWHEEL_SLOT_BITS)) != 0)
+    {
+        expire = tick + ((bp_val_t)1 << (TWHEEL_NUM_LEVELS * TWHEEL_SLOT_BITS)) - 1;
+    }
+
+    /* Insert into Slot */
+    int slot = (expire >> (level * TWHEEL_SLOT_BITS)) & TWHEEL_SLOT_MASK;
+    timer_push(twheel, &twheel->slots[level][slot], t);
+    twheel->num_scheduled++;
+    if (level == 0)
+    {
+        twheel->num_level0++;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * timer_cascade - re-places all timers of a slot into lower levels
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void timer_cascade(twheel_t *twheel, int level, int slot)
+{
+    bp_index_t t = twheel->slots[level][slot];
+
+    twheel->slots[level][slot] = TWHEEL_NULL_TIMER;
+    while (t != TWHEEL_NULL_TIMER)
+    {
+        bp_index_t next = twheel->timers[t].next;
+        twheel->num_scheduled--;
+        timer_place(twheel, t);
+        t = next;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * timer_advance - processes all ticks up to and including now
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void timer_advance(twheel_t *twheel, bp_val_t now)
+{
+    while (twheel->now < now)
+    {
+        /* Skip Ahead when Wheel is Empty */
+        if (twheel->num_scheduled == 0)
+        {
+            twheel->now = now;
+            break;
+        }
+
+        /* Skip to Wrap of Lowest Level when it is Empty */
+        if (twheel->num_level0 == 0 && (twheel->now | TWHEEL_SLOT_MASK) != twheel->now)
+        {
+            bp_val_t last = twheel->now | TWHEEL_SLOT_MASK;
+            twheel->now   = last < now ? last : now;
+            continue;
+        }
+
+        /* Next Tick */
+        bp_val_t tick = ++twheel->now;
+        int      slot = tick & TWHEEL_SLOT_MASK;
+
+        /* Cascade Higher Levels on Wrap of Lower Level */
+        if (slot == 0)
+        {
+            int level;
+            for (level = 1; level < TWHEEL_NUM_LEVELS; level++)
+            {
+                int level_slot = (tick >> (level * TWHEEL_SLOT_BITS)) & TWHEEL_SLOT_MASK;
+                timer_cascade(twheel, level, level_slot);
+                if (level_slot != 0)
+                {
+                    break;
+                }
+            }
+        }
+
+        /* Move Timers of Current Tick to Expired List */
+        bp_index_t t = twheel->slots[0][slot];
+
+        twheel->slots[0][slot] = TWHEEL_NULL_TIMER;
+        while (t != TWHEEL_NULL_TIMER)
+        {
+            bp_index_t next = twheel->timers[t].next;
+            twheel->num_scheduled--;
+            twheel->num_level0--;
+            timer_append(twheel, t);
+            t = next;
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * timer_pool - moves the pool of timers into a newly allocated array of count timers
+ *
+ *  timers are referenced by index, and the lists they are in are in the wheel
+ *  structure, so they can be copied as is; timers added to the pool are neither
+ *  free nor running until placed in the free list
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int timer_pool(twheel_t *twheel, bp_index_t count)
+{
+    twheel_timer_t *timers = (twheel_timer_t *)bplib_os_calloc_tag(sizeof(twheel_timer_t) * count, BP_MEM_ACTIVE);
+    if (timers == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    memcpy(timers, twheel->timers, sizeof(twheel_timer_t) * (count < twheel->allocated ? count : twheel->allocated));
+    bplib_os_free(twheel->timers);
+    twheel->timers    = timers;
+    twheel->allocated = count;
+
+    return BP_SUCCESS;
+}
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Create - initializes timer wheel structure with the current tick
+ *----------------------------------------------------------------------------*/
+int twheel_create(twheel_t **twheel, int size, bp_val_t now)
+{
+    int i, j;
+
+    /* Check Size (max index is reserved for null timer) */
+    if (size <= 0 || (unsigned long)size > BP_MAX_INDEX)
+    {
+        return BP_ERROR;
+    }
+
+    /* Allocate Structure */
+    *twheel = (twheel_t *)bplib_os_calloc_tag(sizeof(twheel_t), BP_MEM_ACTIVE);
+    if (*twheel == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    /* Allocate Timers */
+    (*twheel)->timers = (twheel_timer_t *)bplib_os_calloc_tag(sizeof(twheel_timer_t) * size, BP_MEM_ACTIVE);
+    if ((*twheel)->timers == NULL)
+    {
+        bplib_os_free(*twheel);
+        *twheel = NULL;
+        return BP_ERROR;
+    }
+
+    /* Initialize Lists */
+    (*twheel)->free_timers = TWHEEL_NULL_TIMER;
+    for (i = size - 1; i >= 0; i--)
+    {
+        timer_push(*twheel, &(*twheel)->free_timers, i);
+    }
+
+    for (i = 0; i < TWHEEL_NUM_LEVELS; i++)
+    {
+        for (j = 0; j < TWHEEL_NUM_SLOTS; j++)
+        {
+            (*twheel)->slots[i][j] = TWHEEL_NULL_TIMER;
+        }
+    }
+
+    /* Initialize Attributes */
+    (*twheel)->size          = size;
+    (*twheel)->allocated     = size;
+    (*twheel)->num_retired   = 0;
+    (*twheel)->num_entries   = 0;
+    (*twheel)->num_scheduled = 0;
+    (*twheel)->num_level0    = 0;
+    (*twheel)->expired       = TWHEEL_NULL_TIMER;
+    (*twheel)->expired_tail  = TWHEEL_NULL_TIMER;
+    (*twheel)->now           = now;
+
+    /* Return Success */
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * Destroy - frees memory allocated for timer wheel
+ *----------------------------------------------------------------------------*/
+int twheel_destroy(twheel_t *twheel)
+{
+    if (twheel)
+    {
+        if (twheel->timers)
+            bplib_os_free(twheel->timers);
+        bplib_os_free(twheel);
+    }
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * Start - starts a timer for the custody id that expires at the given tick
+ *----------------------------------------------------------------------------*/
+int twheel_start(twheel_t *twheel, bp_val_t cid, bp_val_t expire, bp_index_t *timer)
+{
+    bp_index_t t = twheel->free_timers;
+
+    /* Check Room Available */
+    if (t == TWHEEL_NULL_TIMER)
+    {
+        return BP_FULL;
+    }
+
+    /* Allocate Timer */
+    timer_unlink(twheel, t);
+
+    /* Schedule Timer */
+    twheel->timers[t].cid    = cid;
+    twheel->timers[t].expire = expire;
+    timer_place(twheel, t);
+    twheel->num_entries++;
+
+    /* Return Timer */
+    *timer = t;
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * Stop - stops a running or expired timer
+ *----------------------------------------------------------------------------*/
+int twheel_stop(twheel_t *twheel, bp_index_t timer)
+{
+    /* Check Timer */
+    if (timer >= twheel->allocated || twheel->timers[timer].head == NULL ||
+        twheel->timers[timer].head == &twheel->free_timers)
+    {
+        return BP_ERROR;
+    }
+
+    /* Free Timer */
+    if (twheel->timers[timer].head != &twheel->expired)
+    {
+        twheel->num_scheduled--;
+        if (twheel->timers[timer].head >= &twheel->slots[0][0] &&
+            twheel->timers[timer].head < &twheel->slots[0][TWHEEL_NUM_SLOTS])
+        {
+            twheel->num_level0--;
+        }
+    }
+    timer_unlink(twheel, timer);
+    twheel->num_entries--;
+
+    /* Retire Timer Beyond Size (pool shrinks once all are retired) */
+    if (timer >= twheel->size)
+    {
+        twheel->num_retired--;
+        if (twheel->num_retired == 0)
+        {
+            timer_pool(twheel, twheel->size); /* on failure larger pool is kept */
+        }
+    }
+    else
+    {
+        timer_push(twheel, &twheel->free_timers, timer);
+    }
+
+    /* Return Success */
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * Expired - advances the wheel to now and frees the first expired timer,
+ *           returning its custody id; timers are returned in expiration order
+ *----------------------------------------------------------------------------*/
+int twheel_expired(twheel_t *twheel, bp_val_t now, bp_val_t *cid)
+{
+    /* Process Elapsed Ticks */
+    timer_advance(twheel, now);
+
+    /* Check for Expired Timer */
+    bp_index_t t = twheel->expired;
+    if (t == TWHEEL_NULL_TIMER)
+    {
+        return BP_TIMEOUT;
+    }
+
+    /* Free Timer */
+    if (cid)
+        *cid = twheel->timers[t].cid;
+    twheel_stop(twheel, t);
+
+    /* Return Success */
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * Count - returns number of timers running or expired
+ *----------------------------------------------------------------------------*/
+int twheel_count(twheel_t *twheel)
+{
+    return twheel->num_entries;
+}
+
+/*----------------------------------------------------------------------------
+ * Resize - changes the number of timers the wheel can run
+ *
+ *  running timers keep their index; when shrinking, those at or above the new
+ *  size are retired as they stop or expire, and the pool is reallocated at the
+ *  new size once the last of them is retired
+ *----------------------------------------------------------------------------*/
+int twheel_resize(twheel_t *twheel, int size)
+{
+    int i;
+
+    /* Check Size (max index is reserved for null timer) */
+    if (size <= 0 || (unsigned long)size > BP_MAX_INDEX)
+    {
+        return BP_ERROR;
+    }
+
+    /* Grow Pool */
+    if ((bp_index_t)size > twheel->allocated)
+    {
+        if (timer_pool(twheel, size) != BP_SUCCESS)
+        {
+            return BP_ERROR;
+        }
+    }
+
+    /* Rebuild Free List from Timers Below Size (lowest first) */
+    twheel->free_timers = TWHEEL_NULL_TIMER;
+    twheel->num_retired = 0;
+    for (i = twheel->allocated - 1; i >= 0; i--)
+    {
+        bp_index_t *head = twheel->timers[i].head;
+        if (head == NULL || head == &twheel->free_timers)
+        {
+            twheel->timers[i].head = NULL;
+            if (i < size)
+            {
+                timer_push(twheel, &twheel->free_timers, i);
+            }
+        }
+        else if (i >= size)
+        {
+            twheel->num_retired++;
+        }
+    }
+    twheel->size = size;
+
+    /* Shrink Pool (if no timers to retire) */
+    if (twheel->num_retired == 0 && twheel->allocated > twheel->size)
+    {
+        timer_pool(twheel, twheel->size); /* on failure larger pool is kept */
+    }
+
+    /* Return Success */
+    return BP_SUCCESS;
+}
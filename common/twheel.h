@@ -0,0 +1,84 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef TWHEEL_H
+#define TWHEEL_H
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include "bplib.h"
+#include "bundle_types.h"
+
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+#define TWHEEL_NULL_TIMER BP_MAX_INDEX /* 0 is a valid timer so max_val is used */
+#define TWHEEL_SLOT_BITS  6
+#define TWHEEL_NUM_SLOTS  (1 << TWHEEL_SLOT_BITS)
+#define TWHEEL_SLOT_MASK  (TWHEEL_NUM_SLOTS - 1)
+#define TWHEEL_NUM_LEVELS 4
+
+/******************************************************************************
+ TYPEDEFS
+ ******************************************************************************/
+
+/* Timer */
+typedef struct
+{
+    bp_val_t    cid;    /* custody id of bundle being timed */
+    bp_val_t    expire; /* absolute tick when timer expires */
+    bp_index_t  next;   /* next timer in list */
+    bp_index_t  prev;   /* previous timer in list */
+    bp_index_t *head;   /* head of list timer is in (NULL when free) */
+} twheel_timer_t;
+
+/* Hierarchical Timer Wheel Control Structure */
+typedef struct
+{
+    twheel_timer_t *timers;                                     /* pool of timers */
+    bp_index_t      size;                                       /* maximum number of timers */
+    bp_index_t      allocated;                                  /* timers in pool, above size until retired stop */
+    bp_index_t      num_retired;                                /* running timers at or above size (after resize) */
+    bp_index_t      num_entries;                                /* number of timers running or expired */
+    bp_index_t      num_scheduled;                              /* number of timers in the wheel slots */
+    bp_index_t      num_level0;                                 /* number of timers in the lowest level slots */
+    bp_index_t      free_timers;                                /* list of unused timers */
+    bp_index_t      expired;                                    /* list of expired timers, in expiration order */
+    bp_index_t      expired_tail;                               /* last timer in expired list */
+    bp_val_t        now;                                        /* ticks up to and including now are processed */
+    bp_index_t      slots[TWHEEL_NUM_LEVELS][TWHEEL_NUM_SLOTS]; /* lists of timers per level */
+} twheel_t;
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+int twheel_create(twheel_t **twheel, int size, bp_val_t now);
+int twheel_destroy(twheel_t *twheel);
+int twheel_start(twheel_t *twheel, bp_val_t cid, bp_val_t expire, bp_index_t *timer);
+int twheel_stop(twheel_t *twheel, bp_index_t timer);
+int twheel_expired(twheel_t *twheel, bp_val_t now, bp_val_t *cid);
+int twheel_count(twheel_t *twheel);
+int twheel_resize(twheel_t *twheel, int size);
+
+#endif /* TWHEEL_H */
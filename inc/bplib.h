@@ -55,13 +55,14 @@ extern "C" {
 #define BP_FLAG_SDNV_INCOMPLETE         0x00000400 /* insufficient room in block to read/write value */
 #define BP_FLAG_ACTIVE_TABLE_WRAP       0x00000800 /* the active table wrapped */
 #define BP_FLAG_DUPLICATES              0x00001000 /* multiple bundles on the network have the same custody id */
-#define BP_FLAG_CUSTODY_FULL            0x00002000 /* the dacs rb_tree was full */
+#define BP_FLAG_CUSTODY_FULL            0x00002000 /* the dacs rb_tree (or bitmap) was full */
 #define BP_FLAG_UNKNOWNREC              0x00004000 /* bundle contained unknown adminstrative record */
 #define BP_FLAG_INVALID_CIPHER_SUITEID  0x00008000 /* invalid cipher suite ID found in BIB */
 #define BP_FLAG_INVALID_BIB_RESULT_TYPE 0x00010000 /* invalid result type found in BIB */
 #define BP_FLAG_INVALID_BIB_TARGET_TYPE 0x00020000 /* invalid target type found in BIB */
 #define BP_FLAG_FAILED_TO_PARSE         0x00040000 /* unable to parse bundle due to internal inconsistencies in bundle */
 #define BP_FLAG_API_ERROR               0x00080000 /* calling code incorrectly used library */
+#define BP_FLAG_NO_ROUTE                0x00100000 /* no routing table rule holds the destination of the bundle */
 
 /* Timeouts */
 #define BP_PEND  (-1)
@@ -75,9 +76,11 @@ extern "C" {
 #define BP_SID_VACANT 0
 
 /* Storage Service Types */
-#define BP_STORE_DATA_TYPE    0xB0
-#define BP_STORE_DACS_TYPE    0xB1
-#define BP_STORE_PAYLOAD_TYPE 0xB2
+#define BP_STORE_DATA_TYPE      0xB0 /* also holds normal class of service bundles when scheduled */
+#define BP_STORE_DACS_TYPE      0xB1
+#define BP_STORE_PAYLOAD_TYPE   0xB2
+#define BP_STORE_BULK_TYPE      0xB3 /* bulk class of service bundles when scheduled */
+#define BP_STORE_EXPEDITED_TYPE 0xB4 /* expedited class of service bundles when scheduled */
 
 /* Error Correcting Codes */
 #define BP_ECC_NO_ERRORS    0
@@ -99,6 +102,15 @@ extern "C" {
 #define BP_RETX_OLDEST_BUNDLE 0
 #define BP_RETX_SMALLEST_CID  1
 
+/* Custody Aggregation */
+#define BP_CUSTODY_RANGES 0
+#define BP_CUSTODY_BITMAP 1
+
+/* Class of Service Scheduling */
+#define BP_SCHEDULE_FIFO     0
+#define BP_SCHEDULE_STRICT   1
+#define BP_SCHEDULE_WEIGHTED 2
+
 /* Set/Get Option Modes */
 #define BP_OPT_MODE_READ  0
 #define BP_OPT_MODE_WRITE 1
@@ -116,6 +128,12 @@ extern "C" {
 #define BP_OPT_TIMEOUT             10
 #define BP_OPT_MAX_LENGTH          11
 #define BP_OPT_DACS_RATE           12
+#define BP_OPT_TIMEOUT_MS          13
+#define BP_OPT_DACS_RATE_MS        14
+#define BP_OPT_LOAD_RATE_BYTES     15
+#define BP_OPT_LOAD_RATE_BUNDLES   16
+#define BP_OPT_RETX_SHARE          17
+#define BP_OPT_ACTIVE_TABLE_SIZE   18
 
 /* Default Dynamic Configuration */
 #define BP_DEFAULT_LIFETIME            86400 /* seconds, 1 day */
@@ -130,6 +148,9 @@ extern "C" {
 #define BP_DEFAULT_TIMEOUT             10   /* seconds */
 #define BP_DEFAULT_MAX_LENGTH          4096 /* bytes (must be smaller than BP_MAX_INDEX) */
 #define BP_DEFAULT_DACS_RATE           5    /* period in seconds */
+#define BP_DEFAULT_LOAD_RATE_BYTES     0    /* bytes per second, unpaced */
+#define BP_DEFAULT_LOAD_RATE_BUNDLES   0    /* bundles per second, unpaced */
+#define BP_DEFAULT_RETX_SHARE          50   /* percent of load rate */
 
 /* Default Fixed Configuration */
 #define BP_DEFAULT_PROTOCOL_VERSION     6
@@ -137,14 +158,112 @@ extern "C" {
 #define BP_DEFAULT_ACTIVE_TABLE_SIZE    16384 /* bundles (must be smaller than BP_MAX_INDEX) */
 #define BP_DEFAULT_MAX_FILLS_PER_DACS   64    /* constrains size of DACS bundle */
 #define BP_DEFAULT_MAX_GAPS_PER_DACS    1028  /* sets size of internal memory used to aggregate custody */
+#define BP_DEFAULT_CUSTODY_AGGREGATION  BP_CUSTODY_RANGES
+#define BP_DEFAULT_MAX_CUSTODY_SOURCES  1     /* custodians aggregated concurrently (one DACS timer each) */
+#define BP_DEFAULT_COS_SCHEDULING       BP_SCHEDULE_FIFO
+#define BP_DEFAULT_REASSEMBLY_SLOTS     0     /* received fragments are accepted as they are */
+#define BP_DEFAULT_MAX_ADU_LENGTH       65536 /* bytes, size of each reassembly slot */
+#define BP_DEFAULT_DUPLICATE_WINDOW     0     /* received bundles are not checked for duplicates */
+#define BP_DEFAULT_SWEEP_RATE           0     /* expired bundles are dropped when they are dequeued */
+#define BP_DEFAULT_ADAPTIVE_DACS        false /* DACS bundles sent every dacs_rate seconds with max_fills_per_dacs */
 #define BP_DEFAULT_PERSISTENT_STORAGE   false
 #define BP_DEFAULT_STORAGE_SERVICE_PARM NULL
+#define BP_DEFAULT_PAYLOAD_COMPRESSOR   NULL
 
 /* Global Custody ID (Compile-Time Option) */
 #ifndef BPLIB_GLOBAL_CUSTODY_ID
 #define BPLIB_GLOBAL_CUSTODY_ID true
 #endif
 
+/* Custody IDs Reserved per Channel at a Time from Global Custody ID (Compile-Time Option) */
+#ifndef BPLIB_CUSTODY_ID_BLOCK_SIZE
+#define BPLIB_CUSTODY_ID_BLOCK_SIZE 256
+#endif
+
+/* Maximum Bundles per Batch Load (Compile-Time Option) */
+#ifndef BPLIB_MAX_LOAD_BATCH
+#define BPLIB_MAX_LOAD_BATCH 64
+#endif
+
+/* Bundles Decoded per Batch Process Critical Section (Compile-Time Option) */
+#ifndef BPLIB_MAX_PROCESS_BATCH
+#define BPLIB_MAX_PROCESS_BATCH 64
+#endif
+
+/* Bundles Relinquished per Storage Service Call when Acknowledged (Compile-Time Option) */
+#ifndef BPLIB_MAX_RELINQUISH_BATCH
+#define BPLIB_MAX_RELINQUISH_BATCH 64
+#endif
+
+/* Expired Bundles Relinquished from Each Queue per Sweep (Compile-Time Option) */
+#ifndef BPLIB_MAX_SWEEP
+#define BPLIB_MAX_SWEEP 256
+#endif
+
+/* Factor an Adaptive DACS Period can be Shortened or Lengthened from the DACS Rate (Compile-Time Option) */
+#ifndef BPLIB_DACS_ADAPT_RANGE
+#define BPLIB_DACS_ADAPT_RANGE 4
+#endif
+
+/* Bundles Loaded per Class of Service in a Round of Weighted Scheduling (Compile-Time Option) */
+#ifndef BPLIB_COS_BULK_WEIGHT
+#define BPLIB_COS_BULK_WEIGHT 1
+#endif
+#ifndef BPLIB_COS_NORMAL_WEIGHT
+#define BPLIB_COS_NORMAL_WEIGHT 4
+#endif
+#ifndef BPLIB_COS_EXPEDITED_WEIGHT
+#define BPLIB_COS_EXPEDITED_WEIGHT 16
+#endif
+
+/* Bundles Loaded in a Burst by a Paced Channel, in Milliseconds of its Load Rate (Compile-Time Option) */
+#ifndef BPLIB_PACING_BURST_MS
+#define BPLIB_PACING_BURST_MS 100
+#endif
+
+/* Use Processor CRC32C Instructions (SSE4.2, ARMv8 CRC) when Available (Compile-Time Option) */
+#ifndef BPLIB_CRC32C_HW
+#define BPLIB_CRC32C_HW true
+#endif
+
+/* Use Processor Carry-Less Multiplies (PCLMULQDQ, ARMv8 PMULL) for CRC16 X.25 when Available (Compile-Time Option) */
+#ifndef BPLIB_CRC16_X25_HW
+#define BPLIB_CRC16_X25_HW true
+#endif
+
+/* Use Processor Vector Instructions (AVX2) for Flash EDAC when Available (Compile-Time Option) */
+#ifndef BPLIB_LRC_SIMD
+#define BPLIB_LRC_SIMD true
+#endif
+
+/* Gaps a Fragmented ADU Can Have While it is Reassembled, Plus One (Compile-Time Option) */
+#ifndef BPLIB_REASM_MAX_RANGES
+#define BPLIB_REASM_MAX_RANGES 32
+#endif
+
+/* Create Non-Recursive (Adaptive where Supported) Mutexes for Waitable OS Locks (Compile-Time Option) */
+#ifndef BPLIB_OS_FAST_LOCKS
+#define BPLIB_OS_FAST_LOCKS true
+#endif
+
+/* Rules in the Routing Table used to Dispatch Received Bundles (Compile-Time Option) */
+#ifndef BPLIB_MAX_ROUTES
+#define BPLIB_MAX_ROUTES 64
+#endif
+
+/* Collect Latency Histograms in Channel Statistics (Compile-Time Option) */
+#ifndef BPLIB_LATENCY_STATS
+#define BPLIB_LATENCY_STATS false
+#endif
+
+/* Static Tracepoints (USDT, needs <sys/sdt.h>) on the Bundle Path (Compile-Time Option) */
+#ifndef BPLIB_TRACEPOINTS
+#define BPLIB_TRACEPOINTS false
+#endif
+
+/* Latency Histogram Buckets */
+#define BP_LATENCY_BUCKETS 32
+
 /******************************************************************************
  TYPEDEFS
  ******************************************************************************/
@@ -175,6 +294,15 @@ typedef struct
     char            data[];
 } bp_object_t;
 
+/* Storage Object Data (one object of a batch enqueue) */
+typedef struct
+{
+    const void *data1;
+    size_t      data1_size;
+    const void *data2;
+    size_t      data2_size;
+} bp_store_vec_t;
+
 /* Storage Service */
 typedef struct
 {
@@ -188,8 +316,28 @@ typedef struct
     int (*release)(bp_handle_t h, bp_sid_t sid);
     int (*relinquish)(bp_handle_t h, bp_sid_t sid);
     int (*getcount)(bp_handle_t h);
+
+    /* Zero-Copy Service (optional, may be NULL) */
+    bp_object_t *(*allocate)(bp_handle_t h, size_t size);
+    int (*post)(bp_handle_t h, bp_object_t *object, int timeout);
+    int (*discard)(bp_handle_t h, bp_object_t *object);
+
+    /* Batch Service (optional, may be NULL) */
+    int (*enqueue_batch)(bp_handle_t h, const bp_store_vec_t *objects, int count, int timeout);
+    int (*dequeue_batch)(bp_handle_t h, bp_object_t **objects, int max, int timeout);
+    int (*relinquish_batch)(bp_handle_t h, const bp_sid_t *sids, int count);
 } bp_store_t;
 
+/* Payload Compressor */
+typedef struct
+{
+    int id; /* identifies the compressor in the compression block of bundles (1 - 127) */
+    /* returns size of compressed data, or zero when it does not fit in dst_size bytes */
+    int (*compress)(const void *src, int src_size, void *dst, int dst_size);
+    /* returns size of decompressed data, or error code */
+    int (*decompress)(const void *src, int src_size, void *dst, int dst_size);
+} bp_compressor_t;
+
 /* Channel Attributes */
 typedef struct
 {
@@ -206,16 +354,39 @@ typedef struct
     int      timeout;             /* seconds, zero for infinite */
     int      max_length;          /* maximum size of bundle in bytes */
     int      dacs_rate;           /* number of seconds to wait between sending ACS bundles (<=0: no periodic dacs) */
+    int      load_rate_bytes;     /* bytes per second of bundles loaded (<=0: not paced) */
+    int      load_rate_bundles;   /* bundles per second loaded (<=0: not paced) */
+    int      retx_share;          /* percent of a paced load rate that retransmissions get ahead of new bundles */
     /* Fixed Attributes */
     int   protocol_version;     /* bundle protocol version; currently only version 6 supported */
     int   retransmit_order;     /* determination of which timed-out bundle is retransmitted first */
     int   active_table_size;    /* number of unacknowledged bundles to keep track of */
     int   max_fills_per_dacs;   /* limits the size of the DACS bundle */
     int   max_gaps_per_dacs;    /* number of gaps in custody IDs that can be kept track of */
+    int   custody_aggregation;  /* ranges: gaps limited by max_gaps_per_dacs, bitmap: max_gaps_per_dacs blocks of ids */
+    int   max_custody_sources;  /* number of custodians whose custody signals are aggregated at the same time */
+    int   cos_scheduling;       /* fifo: one queue, strict or weighted: queue per class of service, by priority */
+    int   reassembly_slots;     /* fragmented ADUs reassembled at the same time (0: fragments accepted as they are) */
+    int   max_adu_length;       /* largest fragmented ADU that can be reassembled, in bytes */
+    int   duplicate_window;     /* received bundles remembered to drop duplicates (0: duplicates stored again) */
+    int   sweep_rate;           /* seconds between sweeps of expired bundles by bplib_tick (<=0: not swept) */
+    bool  adaptive_dacs;        /* 0: fixed dacs rate and fills, 1: DACS sized to max length, period follows traffic */
     bool  persistent_storage;   /* attempt to recover bundles and payloads from storage service */
     void *storage_service_parm; /* pass through of parameters needed by storage service */
+    /* compresses stored payloads and decompresses accepted payloads (NULL: no compression) */
+    const bp_compressor_t *payload_compressor;
 } bp_attr_t;
 
+/* Latency Histogram
+ *  bucket n counts latencies of less than 2^n microseconds not counted by a lower bucket;
+ *  the last bucket counts all longer latencies */
+typedef struct
+{
+    uint32_t count;                       /* number of samples */
+    uint32_t max;                         /* longest latency sampled (microseconds) */
+    uint32_t buckets[BP_LATENCY_BUCKETS]; /* log2 buckets of latency (microseconds) */
+} bp_histogram_t;
+
 /* Channel Statistics */
 typedef struct
 {
@@ -231,6 +402,9 @@ typedef struct
     uint32_t received_bundles;      /* bundles destined for local node (process) */
     uint32_t forwarded_bundles;     /* bundles received by local node but destined for another node (process) */
     uint32_t received_dacs;         /* dacs destined for local node (process) */
+    uint32_t compressed_payloads;   /* payloads sent in bundles with a compressed payload block (store) */
+    uint32_t reassembled_payloads;  /* fragmented ADUs reassembled into a single payload (process) */
+    uint32_t duplicate_bundles;     /* bundles already received, acknowledged but not stored again (process) */
     /* Storage */
     uint32_t stored_bundles;  /* number of data bundles currently in storage */
     uint32_t stored_payloads; /* number of payloads currently in storage */
@@ -238,6 +412,12 @@ typedef struct
     /* Active */
     uint32_t acknowledged_bundles; /* freed by custody signal - process */
     uint32_t active_bundles;       /* number of slots in active table in use */
+    /* Latency (only collected when BPLIB_LATENCY_STATS is enabled) */
+    bp_histogram_t store_to_load; /* bundle queued in storage until first loaded (load) */
+    bp_histogram_t load_to_ack;   /* bundle last loaded until acknowledged (process) */
+    bp_histogram_t enqueue;       /* storage service enqueue calls */
+    bp_histogram_t dequeue;       /* storage service dequeue calls that returned a bundle or payload */
+    bp_histogram_t retrieve;      /* storage service retrieve calls */
 } bp_stats_t;
 
 /******************************************************************************
@@ -253,15 +433,36 @@ void       bplib_close(bp_desc_t *desc);
 int bplib_flush(bp_desc_t *desc);
 int bplib_config(bp_desc_t *desc, int mode, int opt, int *val);
 int bplib_latchstats(bp_desc_t *desc, bp_stats_t *stats);
+int bplib_memstats(bp_desc_t *desc, bp_memstats_t *stats);
+int bplib_eventfd(bp_desc_t *desc);
+int bplib_eventclear(bp_desc_t *desc);
+int bplib_tick(int *timeout, uint32_t *flags);
 
 int bplib_store(bp_desc_t *desc, const void *payload, size_t size, int timeout, uint32_t *flags);
 int bplib_load(bp_desc_t *desc, void **bundle, size_t *size, int timeout, uint32_t *flags);
+int bplib_load_batch(bp_desc_t *desc, void **bundles, size_t *sizes, int max, int timeout, uint32_t *flags);
 int bplib_process(bp_desc_t *desc, const void *bundle, size_t size, int timeout, uint32_t *flags);
+int bplib_process_batch(bp_desc_t *desc, const void **bundles, const size_t *sizes, int count, int timeout,
+                        uint32_t *flags);
 int bplib_accept(bp_desc_t *desc, void **payload, size_t *size, int timeout, uint32_t *flags);
 
+int bplib_stream_open(bp_desc_t *desc, size_t size, uint32_t *flags);
+int bplib_stream_write(bp_desc_t *desc, const void *data, size_t size, int timeout, uint32_t *flags);
+int bplib_stream_close(bp_desc_t *desc, uint32_t *flags);
+
+void *bplib_lend(bp_desc_t *desc, size_t size, uint32_t *flags);
+int   bplib_store_lent(bp_desc_t *desc, void *payload, size_t size, int timeout, uint32_t *flags);
+int   bplib_unlend(bp_desc_t *desc, void *payload);
+
 int bplib_ackbundle(bp_desc_t *desc, const void *bundle);
 int bplib_ackpayload(bp_desc_t *desc, const void *payload);
 
+int        bplib_addroute(bp_desc_t *desc, bp_ipn_t first_node, bp_ipn_t last_node, bp_ipn_t first_service,
+                          bp_ipn_t last_service);
+int        bplib_delroute(bp_desc_t *desc);
+bp_desc_t *bplib_lookup(const void *bundle, size_t size);
+int        bplib_dispatch(const void *bundle, size_t size, int timeout, uint32_t *flags);
+
 int bplib_routeinfo(const void *bundle, size_t size, bp_route_t *route);
 int bplib_display(const void *bundle, size_t size, uint32_t *flags);
 int bplib_eid2ipn(const char *eid, size_t len, bp_ipn_t *node, bp_ipn_t *service);
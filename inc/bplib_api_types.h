@@ -41,6 +41,7 @@ extern "C" {
 #define BP_VAL_TYPE unsigned long
 #endif
 
+/* Active Table Index Type (Compile-Time Option): uint32_t allows tables of 65535 or more bundles */
 #ifndef BP_INDEX_TYPE
 #define BP_INDEX_TYPE uint16_t
 #endif
@@ -79,6 +80,31 @@ typedef bp_val_t bp_ipn_t;
 /* Storage ID */
 typedef unsigned long bp_sid_t;
 
+/* Memory Tags - subsystem an allocation is charged to (see bplib_os_calloc_tag) */
+#define BP_MEM_OTHER    0  /* not attributed, including OS layer objects */
+#define BP_MEM_CHANNEL  1  /* channel descriptors, bundle blocks, stream and compression buffers */
+#define BP_MEM_ACTIVE   2  /* active table and retransmit timers */
+#define BP_MEM_CUSTODY  3  /* custody trees and bitmaps */
+#define BP_MEM_DACS     4  /* dacs buffer and custody sources */
+#define BP_MEM_REASM    5  /* fragment reassembly slots */
+#define BP_MEM_RAM      6  /* RAM and ring storage service objects */
+#define BP_MEM_FILE     7  /* file storage service cache and objects */
+#define BP_MEM_FLASH    8  /* flash storage service control blocks and stages */
+#define BP_MEM_TIER     9  /* tiered storage service entries and objects */
+#define BP_MEM_V7       10 /* bpv7 memory pool and buffers */
+#define BP_MEM_ENGINE   11 /* service engine */
+#define BP_MEM_DEDUP    12 /* received bundle duplicate detection index */
+#define BP_NUM_MEM_TAGS 13
+
+/* Memory Statistics - bytes allocated, including allocation headers */
+typedef struct
+{
+    size_t used;                      /* currently allocated */
+    size_t high;                      /* most allocated at once */
+    size_t tag_used[BP_NUM_MEM_TAGS]; /* currently allocated, by subsystem */
+    size_t tag_high[BP_NUM_MEM_TAGS]; /* most allocated at once, by subsystem */
+} bp_memstats_t;
+
 /**
  * Checks for validity of given handle
  *
@@ -177,6 +203,21 @@ static inline bp_handle_t bp_handle_from_serial(int hv, bp_handle_t base)
     {                        \
         0x4000000            \
     }
+#define BPLIB_HANDLE_RING_STORE_BASE \
+    (bp_handle_t)                    \
+    {                                \
+        0x5000000                    \
+    }
+#define BPLIB_HANDLE_THREAD_BASE \
+    (bp_handle_t)                \
+    {                            \
+        0x6000000                \
+    }
+#define BPLIB_HANDLE_TIER_STORE_BASE \
+    (bp_handle_t)                    \
+    {                                \
+        0x7000000                    \
+    }
 
 #ifdef __cplusplus
 } // extern "C"
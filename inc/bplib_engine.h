@@ -0,0 +1,81 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef BPLIB_ENGINE_H
+#define BPLIB_ENGINE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include "bplib.h"
+
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+/* Default Engine Attributes (used for attributes left zero) */
+#define BP_ENGINE_DEFAULT_MAX_CHANNELS 256
+#define BP_ENGINE_DEFAULT_PERIOD       100   /* milliseconds */
+#define BP_ENGINE_DEFAULT_BATCH_SIZE   64    /* bundles and payloads */
+#define BP_ENGINE_DEFAULT_RECEIVE_SIZE 65536 /* bytes */
+
+/******************************************************************************
+ TYPEDEFS
+ ******************************************************************************/
+
+typedef struct bp_engine bp_engine_t;
+
+typedef struct
+{
+    int num_workers;  /* threads servicing channels (0: number of online processors) */
+    int max_channels; /* channels that can be added to the engine */
+    int period;       /* milliseconds between services of a channel with no readiness event, for timeouts */
+    int batch_size;   /* bundles or payloads moved in each direction per service before other channels are served */
+    int receive_size; /* bytes of the buffer each worker passes to receive, the largest bundle received */
+} bp_engine_attr_t;
+
+typedef struct
+{
+    void (*send)(void *parm, const void *bundle, size_t size);     /* transmits a loaded bundle (NULL: no loads) */
+    int (*receive)(void *parm, void *buffer, size_t size);         /* size of bundle copied to buffer, 0 if none */
+    void (*deliver)(void *parm, const void *payload, size_t size); /* takes an accepted payload (NULL: no accepts) */
+    int   receive_fd; /* descriptor that polls readable when receive has a bundle (-1: receive on every service) */
+    void *parm;       /* passed to the functions above */
+} bp_engine_io_t;
+
+/******************************************************************************
+ PROTOTYPES
+ ******************************************************************************/
+
+bp_engine_t *bplib_engine_create(const bp_engine_attr_t *attributes);
+void         bplib_engine_destroy(bp_engine_t *engine);
+int          bplib_engine_add(bp_engine_t *engine, bp_desc_t *desc, const bp_engine_io_t *io);
+int          bplib_engine_remove(bp_engine_t *engine, bp_desc_t *desc);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* BPLIB_ENGINE_H */
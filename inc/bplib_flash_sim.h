@@ -40,6 +40,34 @@ extern "C" {
 #define FLASH_SIM_PAGE_SIZE       4096
 #define FLASH_SIM_SPARE_SIZE      128
 
+/******************************************************************************
+ TYPEDEFS
+ ******************************************************************************/
+
+typedef struct
+{
+    int      read_latency_us;       /* array to register time per page read (datasheet tR) */
+    int      program_latency_us;    /* register to array time per page program (datasheet tPROG) */
+    int      erase_latency_us;      /* time per block erase (datasheet tBERS) */
+    int      bus_bytes_per_us;      /* interface bandwidth for page transfers, zero for instantaneous */
+    uint32_t bit_error_interval;    /* one in this many page reads returns a single flipped bit, zero for never */
+    uint32_t program_fail_interval; /* one in this many page programs fails and marks the block bad, zero for never */
+    uint32_t erase_fail_interval;   /* one in this many block erases fails and marks the block bad, zero for never */
+    int      bad_blocks;            /* number of blocks marked bad when configured (factory bad blocks) */
+    uint32_t seed;                  /* seed for error injection and bad block selection */
+    bool     virtual_time;          /* accumulate device time instead of waiting it out */
+} bp_flash_sim_config_t;
+
+typedef struct
+{
+    unsigned long reads;      /* pages read */
+    unsigned long programs;   /* pages programmed */
+    unsigned long erases;     /* blocks erased */
+    unsigned long bit_errors; /* bit errors injected into page reads */
+    unsigned long failures;   /* program and erase failures injected */
+    unsigned long busy_us;    /* time the device spent busy, real or virtual */
+} bp_flash_sim_stats_t;
+
 /******************************************************************************
  PROTOTYPES
  ******************************************************************************/
@@ -52,6 +80,8 @@ int bplib_flash_sim_block_erase(bp_flash_index_t block);
 int bplib_flash_sim_block_is_bad(bp_flash_index_t block);
 int bplib_flash_sim_physical_block(bp_flash_index_t logblk);
 int bplib_flash_sim_block_mark_bad(bp_flash_index_t block);
+int bplib_flash_sim_configure(const bp_flash_sim_config_t *config);
+int bplib_flash_sim_stats(bp_flash_sim_stats_t *stats, bool reset_stats);
 
 #ifdef __cplusplus
 } // extern "C"
@@ -0,0 +1,58 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef BPLIB_LZ_H
+#define BPLIB_LZ_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include "bplib.h"
+
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+/* Compressor ID Carried in the Compression Block of Bundles */
+#define BP_LZ_COMPRESSOR_ID 1
+
+/* Number of Bits in the Match Finder Hash, 4 bytes of stack per entry (Compile-Time Option) */
+#ifndef BP_LZ_HASH_BITS
+#define BP_LZ_HASH_BITS 12
+#endif
+
+/******************************************************************************
+ PROTOTYPES
+ ******************************************************************************/
+
+/* Payload Compressor API (LZ4 block format) */
+int bplib_lz_compress(const void *src, int src_size, void *dst, int dst_size);
+int bplib_lz_decompress(const void *src, int src_size, void *dst, int dst_size);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* BPLIB_LZ_H */
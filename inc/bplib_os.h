@@ -58,6 +58,12 @@
  TYPEDEFS
  ******************************************************************************/
 
+/* Inline Mutex - non-recursive and cannot be waited on, zero is unlocked */
+typedef struct
+{
+    int state;
+} bplib_os_mutex_t;
+
 /******************************************************************************
  PROTOTYPES
  ******************************************************************************/
@@ -65,20 +71,41 @@
 void bplib_os_init(void);
 int  bplib_os_log(const char *file, unsigned int line, uint32_t *flags, uint32_t event, const char *fmt, ...)
     VARG_CHECK(printf, 5, 6);
-int         bplib_os_systime(unsigned long *sysnow); /* seconds */
-void        bplib_os_sleep(int seconds);
-uint32_t    bplib_os_random(void);
-bp_handle_t bplib_os_createlock(void);
-void        bplib_os_destroylock(bp_handle_t h);
-void        bplib_os_lock(bp_handle_t h);
-void        bplib_os_unlock(bp_handle_t h);
-void        bplib_os_signal(bp_handle_t h);
-int         bplib_os_waiton(bp_handle_t h, int timeout_ms);
-int         bplib_os_format(char *dst, size_t len, const char *fmt, ...) VARG_CHECK(printf, 3, 4);
-int         bplib_os_strnlen(const char *str, int maxlen);
-void       *bplib_os_calloc(size_t size);
-void        bplib_os_free(void *ptr);
-size_t      bplib_os_memused(void);
-size_t      bplib_os_memhigh(void);
+int            bplib_os_systime(unsigned long *sysnow); /* seconds */
+int            bplib_os_monotime(unsigned long *msnow); /* milliseconds */
+int            bplib_os_monotime_us(unsigned long *usnow); /* microseconds */
+void           bplib_os_sleep(int seconds);
+void           bplib_os_sleep_us(unsigned long usecs);
+uint32_t       bplib_os_random(void);
+bp_handle_t    bplib_os_createlock(void);
+void           bplib_os_destroylock(bp_handle_t h);
+void           bplib_os_lock(bp_handle_t h);
+void           bplib_os_unlock(bp_handle_t h);
+void           bplib_os_signal(bp_handle_t h);
+void           bplib_os_broadcast(bp_handle_t h);
+int            bplib_os_waiton(bp_handle_t h, int timeout_ms);
+int            bplib_os_waiton_us(bp_handle_t h, long timeout_us);
+int            bplib_os_waituntil(bp_handle_t h, unsigned long deadline_us); /* bplib_os_monotime_us */
+void           bplib_os_mutex_init(bplib_os_mutex_t *m);
+void           bplib_os_mutex_destroy(bplib_os_mutex_t *m);
+void           bplib_os_mutex_lock(bplib_os_mutex_t *m);
+void           bplib_os_mutex_unlock(bplib_os_mutex_t *m);
+bp_handle_t    bplib_os_createthread(void (*entry)(void *parm), void *parm);
+int            bplib_os_jointhread(bp_handle_t h);
+int            bplib_os_createevent(void); /* pollable descriptor */
+void           bplib_os_destroyevent(int fd);
+void           bplib_os_setevent(int fd);
+void           bplib_os_clearevent(int fd);
+int            bplib_os_waitevents(const int *fds, int num_fds, bool *ready, bool *failed, int timeout_ms);
+int            bplib_os_numcpus(void);
+int            bplib_os_format(char *dst, size_t len, const char *fmt, ...) VARG_CHECK(printf, 3, 4);
+int            bplib_os_strnlen(const char *str, int maxlen);
+void          *bplib_os_calloc(size_t size);
+void          *bplib_os_calloc_tag(size_t size, int tag);
+void           bplib_os_free(void *ptr);
+size_t         bplib_os_memused(void);
+size_t         bplib_os_memhigh(void);
+void           bplib_os_memstats(bp_memstats_t *stats, bp_memstats_t *account);
+bp_memstats_t *bplib_os_memaccount(bp_memstats_t *account);
 
 #endif /* BPLIB_OS_H */
@@ -38,11 +38,28 @@ extern "C" {
 
 typedef struct
 {
-    const char *root_path;      /* local directory used to store bundles as files */
-    int         cache_size;     /* number of bundles to store in cache (data_cache_t) */
-    bool        flush_on_write; /* true: write-through cache */
+    const char *root_path;          /* local directory used to store bundles as files */
+    int         cache_size;         /* number of bundles to store in cache (data_cache_t) */
+    bool        flush_on_write;     /* true: write-through cache */
+    bool        map_segments;       /* true: read segment files through memory mappings instead of the file driver */
+    int         commit_count;       /* group commit: flush and sync after this many objects (0: disabled) */
+    int         commit_period;      /* group commit: milliseconds an object waits (0: waiting enqueues commit now) */
+    bool        write_behind;       /* true: enqueue queues objects in memory for an I/O thread to write */
+    int         write_behind_depth; /* maximum number of objects queued for the I/O thread (0: default) */
+    int         segment_size;       /* number of objects stored per segment file (0: default) */
+    int         compact_threshold;  /* percent of a segment relinquished before it is compacted (0: never) */
+    int         prefetch_count;     /* objects read ahead into the cache on a segment file read (0: none) */
 } bp_file_attr_t;
 
+typedef struct
+{
+    unsigned long hits;           /* dequeues and retrievals served from the data cache */
+    unsigned long misses;         /* dequeues and retrievals read from segment files or the write behind queue */
+    unsigned long evictions;      /* least recently used objects freed to make room in the data cache */
+    unsigned long prefetches;     /* objects read ahead into the data cache */
+    int           cached_objects; /* number of objects currently held in the data cache */
+} bp_file_stats_t;
+
 typedef struct
 {
     FILE *(*open)(const char *filename, const char *modes);
@@ -51,6 +68,7 @@ typedef struct
     size_t (*write)(const void *src, size_t size, size_t n, FILE *stream);
     int (*seek)(FILE *stream, long int offset, int whence);
     int (*flush)(FILE *stream);
+    int (*sync)(FILE *stream); /* optional: commit flushed data to stable storage */
 } bp_file_driver_t;
 
 /******************************************************************************
@@ -59,6 +77,7 @@ typedef struct
 
 /* Application API */
 void bplib_store_file_init(bp_file_driver_t *driver);
+void bplib_store_file_stats(bp_handle_t h, bp_file_stats_t *stats, bool log_stats, bool reset_stats);
 
 /* Service API */
 bp_handle_t bplib_store_file_create(int type, bp_ipn_t node, bp_ipn_t service, bool recover, void *parm);
@@ -71,6 +90,8 @@ int bplib_store_file_release(bp_handle_t h, bp_sid_t sid);
 int bplib_store_file_relinquish(bp_handle_t h, bp_sid_t sid);
 int bplib_store_file_getcount(bp_handle_t h);
 
+int bplib_store_file_relinquish_batch(bp_handle_t h, const bp_sid_t *sids, int count);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -59,6 +59,33 @@ extern "C" {
 #define FLASH_MAX_STORES 24
 #endif
 
+/*
+ * The maximum number of objects that can be packed into a single
+ * page when write combining is enabled; this multiplies the range of
+ * storage IDs, and the per block use count must be able to hold
+ * pages_per_block * (FLASH_MAX_OBJECTS_PER_PAGE + 1)
+ */
+#ifndef FLASH_MAX_OBJECTS_PER_PAGE
+#define FLASH_MAX_OBJECTS_PER_PAGE 16
+#endif
+
+/*
+ * The number of free blocks the background erase thread keeps erased
+ * ahead of allocation; zero erases every block inline when it is allocated
+ */
+#ifndef FLASH_GC_ERASED_BLOCKS
+#define FLASH_GC_ERASED_BLOCKS 4
+#endif
+
+/*
+ * The number of dequeued objects per store whose size and offset in
+ * their page are kept in memory so that retrieving or relinquishing them
+ * does not read their header back from flash; zero disables the cache
+ */
+#ifndef FLASH_SID_CACHE_SIZE
+#define FLASH_SID_CACHE_SIZE 256
+#endif
+
 /******************************************************************************
  TYPEDEFS
  ******************************************************************************/
@@ -91,15 +118,21 @@ typedef struct
 
 typedef struct
 {
-    int num_free_blocks; /* number of free blocks available to driver to store bundles in */
-    int num_used_blocks; /* number of blocks currently used by the driver */
-    int num_fail_blocks; /* number of blocks that have been removed from the free list due to errors */
-    int error_count;     /* number of flash operations that have returned an error */
+    int num_free_blocks;   /* number of free blocks available to driver to store bundles in */
+    int num_erased_blocks; /* number of free blocks that have already been erased */
+    int num_used_blocks;   /* number of blocks currently used by the driver */
+    int num_fail_blocks;   /* number of blocks that have been removed from the free list due to errors */
+    int error_count;       /* number of flash operations that have returned an error */
+    int page_writes;       /* number of pages programmed */
+    int page_reads;        /* number of pages read */
+    int min_erase_count;   /* fewest times any block has been erased since initialization */
+    int max_erase_count;   /* most times any block has been erased since initialization */
 } bp_flash_stats_t;
 
 typedef struct
 {
-    int max_data_size; /* max size of data stored, must exceed page size */
+    int  max_data_size; /* max size of data stored, must exceed page size */
+    bool write_combine; /* true: pack objects smaller than a page into shared pages before programming them */
 } bp_flash_attr_t;
 
 /******************************************************************************
@@ -124,6 +157,8 @@ int bplib_store_flash_release(bp_handle_t h, bp_sid_t sid);
 int bplib_store_flash_relinquish(bp_handle_t h, bp_sid_t sid);
 int bplib_store_flash_getcount(bp_handle_t h);
 
+int bplib_store_flash_relinquish_batch(bp_handle_t h, const bp_sid_t *sids, int count);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -31,6 +31,33 @@ extern "C" {
 
 #include "bplib.h"
 
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+/* Storage Header Overhead of a Bundle or Payload (Compile-Time Option) */
+#ifndef BP_RAM_SLAB_OVERHEAD
+#define BP_RAM_SLAB_OVERHEAD 256
+#endif
+
+/* Objects Copied per Queue Lock by Batch Enqueue and Relinquish (Compile-Time Option) */
+#ifndef BP_RAM_MAX_BATCH
+#define BP_RAM_MAX_BATCH 64
+#endif
+
+/* Slab Size Needed for Bundles of a Channel's Maximum Length */
+#define BP_RAM_SLAB_SIZE(max_length) ((max_length) + BP_RAM_SLAB_OVERHEAD)
+
+/******************************************************************************
+ TYPEDEFS
+ ******************************************************************************/
+
+typedef struct
+{
+    int slab_count; /* number of objects preallocated per store; 0 allocates each object from the heap */
+    int slab_size;  /* largest object in bytes, see BP_RAM_SLAB_SIZE */
+} bp_ram_attr_t;
+
 /******************************************************************************
  PROTOTYPES
  ******************************************************************************/
@@ -50,6 +77,14 @@ int bplib_store_ram_release(bp_handle_t h, bp_sid_t sid);
 int bplib_store_ram_relinquish(bp_handle_t h, bp_sid_t sid);
 int bplib_store_ram_getcount(bp_handle_t h);
 
+bp_object_t *bplib_store_ram_allocate(bp_handle_t h, size_t size);
+int          bplib_store_ram_post(bp_handle_t h, bp_object_t *object, int timeout);
+int          bplib_store_ram_discard(bp_handle_t h, bp_object_t *object);
+
+int bplib_store_ram_enqueue_batch(bp_handle_t h, const bp_store_vec_t *objects, int count, int timeout);
+int bplib_store_ram_dequeue_batch(bp_handle_t h, bp_object_t **objects, int max, int timeout);
+int bplib_store_ram_relinquish_batch(bp_handle_t h, const bp_sid_t *sids, int count);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -0,0 +1,93 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef BPLIB_STORE_RING_H
+#define BPLIB_STORE_RING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include "bplib.h"
+
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+/* Storage Header Overhead of a Bundle or Payload (Compile-Time Option) */
+#ifndef BP_RING_SLOT_OVERHEAD
+#define BP_RING_SLOT_OVERHEAD 256
+#endif
+
+/* Slot Size Needed for Bundles of a Channel's Maximum Length */
+#define BP_RING_SLOT_SIZE(max_length) ((max_length) + BP_RING_SLOT_OVERHEAD)
+
+/* Default Number of Slots per Store (Compile-Time Option) */
+#ifndef BP_RING_DEFAULT_SLOT_COUNT
+#define BP_RING_DEFAULT_SLOT_COUNT 1024
+#endif
+
+/* Default Size of Slots (Compile-Time Option) */
+#ifndef BP_RING_DEFAULT_SLOT_SIZE
+#define BP_RING_DEFAULT_SLOT_SIZE BP_RING_SLOT_SIZE(BP_DEFAULT_MAX_LENGTH)
+#endif
+
+/******************************************************************************
+ TYPEDEFS
+ ******************************************************************************/
+
+typedef struct
+{
+    int slot_count; /* number of objects the store can hold */
+    int slot_size;  /* largest object in bytes, see BP_RING_SLOT_SIZE */
+} bp_ring_attr_t;
+
+/******************************************************************************
+ PROTOTYPES
+ ******************************************************************************/
+
+/* Application API */
+void bplib_store_ring_init(void);
+
+/* Service API */
+bp_handle_t bplib_store_ring_create(int type, bp_ipn_t node, bp_ipn_t service, bool recover, void *parm);
+
+int bplib_store_ring_destroy(bp_handle_t h);
+int bplib_store_ring_enqueue(bp_handle_t h, const void *data1, size_t data1_size, const void *data2, size_t data2_size,
+                             int timeout);
+int bplib_store_ring_dequeue(bp_handle_t h, bp_object_t **object, int timeout);
+int bplib_store_ring_retrieve(bp_handle_t h, bp_sid_t sid, bp_object_t **object, int timeout);
+int bplib_store_ring_release(bp_handle_t h, bp_sid_t sid);
+int bplib_store_ring_relinquish(bp_handle_t h, bp_sid_t sid);
+int bplib_store_ring_getcount(bp_handle_t h);
+
+bp_object_t *bplib_store_ring_allocate(bp_handle_t h, size_t size);
+int          bplib_store_ring_post(bp_handle_t h, bp_object_t *object, int timeout);
+int          bplib_store_ring_discard(bp_handle_t h, bp_object_t *object);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* BPLIB_STORE_RING_H */
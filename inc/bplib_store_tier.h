@@ -0,0 +1,89 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef BPLIB_STORE_TIER_H
+#define BPLIB_STORE_TIER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include "bplib.h"
+
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+/* Default Bytes of Objects Held in RAM per Store (Compile-Time Option) */
+#ifndef BP_TIER_DEFAULT_HOT_SIZE
+#define BP_TIER_DEFAULT_HOT_SIZE 1048576
+#endif
+
+/******************************************************************************
+ TYPEDEFS
+ ******************************************************************************/
+
+typedef struct
+{
+    bp_store_t cold;        /* persistent storage service objects are written behind to */
+    void      *cold_parm;   /* parameter passed to the create function of the persistent storage service */
+    size_t     hot_size;    /* bytes of objects held in RAM (0: BP_TIER_DEFAULT_HOT_SIZE) */
+    int        write_delay; /* milliseconds an object is held only in RAM before it is written behind */
+} bp_tier_attr_t;
+
+typedef struct
+{
+    unsigned long hot_reads;  /* dequeues and retrievals served from RAM */
+    unsigned long cold_reads; /* dequeues and retrievals read back from the persistent storage service */
+    unsigned long writes;     /* objects written to the persistent storage service */
+    unsigned long skips;      /* objects relinquished before they were written, and so never written */
+    unsigned long evictions;  /* written objects dropped from RAM to stay within the hot size */
+    size_t        hot_bytes;  /* bytes of objects currently held in RAM */
+} bp_tier_stats_t;
+
+/******************************************************************************
+ PROTOTYPES
+ ******************************************************************************/
+
+/* Application API */
+void bplib_store_tier_init(void);
+void bplib_store_tier_stats(bp_handle_t h, bp_tier_stats_t *stats, bool log_stats, bool reset_stats);
+
+/* Service API */
+bp_handle_t bplib_store_tier_create(int type, bp_ipn_t node, bp_ipn_t service, bool recover, void *parm);
+
+int bplib_store_tier_destroy(bp_handle_t h);
+int bplib_store_tier_enqueue(bp_handle_t h, const void *data1, size_t data1_size, const void *data2, size_t data2_size,
+                             int timeout);
+int bplib_store_tier_dequeue(bp_handle_t h, bp_object_t **object, int timeout);
+int bplib_store_tier_retrieve(bp_handle_t h, bp_sid_t sid, bp_object_t **object, int timeout);
+int bplib_store_tier_release(bp_handle_t h, bp_sid_t sid);
+int bplib_store_tier_relinquish(bp_handle_t h, bp_sid_t sid);
+int bplib_store_tier_getcount(bp_handle_t h);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* BPLIB_STORE_TIER_H */
@@ -25,11 +25,25 @@
 #include "bplib.h"
 #include "bplib_os.h"
 #include "v6.h"
+#ifdef BPLIB_INCLUDE_BPV7
+#include "v7.h"
+#endif
 #include "rb_tree.h"
+#include "cbitmap.h"
 #include "bundle_types.h"
 #include "cbuf.h"
 #include "rh_hash.h"
+#include "twheel.h"
+#include "reasm.h"
+#include "dedup.h"
 #include "crc.h"
+#include "trace.h"
+
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+#define BP_NUM_COS_QUEUES (BP_COS_EXPEDITED + 1) /* bulk, normal, and expedited bundle queues */
 
 /******************************************************************************
  TYPEDEFS
@@ -41,46 +55,142 @@ typedef int (*bp_table_destroy_t)(void *table);
 typedef int (*bp_table_add_t)(void *table, bp_active_bundle_t bundle, bool overwrite);
 typedef int (*bp_table_next_t)(void *table, bp_active_bundle_t *bundle);
 typedef int (*bp_table_remove_t)(void *table, bp_val_t cid, bp_active_bundle_t *bundle);
+typedef int (*bp_table_remove_range_t)(void *table, bp_val_t cid, bp_val_t count, bp_removed_func_t removed,
+                                       void *parm);
 typedef int (*bp_table_available_t)(void *table, bp_val_t cid);
 typedef int (*bp_table_count_t)(void *table);
+typedef int (*bp_table_resize_t)(void *table, int size);
 
 /* Active Table */
 typedef struct
 {
-    void                *table;
-    bp_table_create_t    create;
-    bp_table_destroy_t   destroy;
-    bp_table_add_t       add;
-    bp_table_next_t      next;
-    bp_table_remove_t    remove;
-    bp_table_available_t available;
-    bp_table_count_t     count;
+    void                   *table;
+    bp_table_create_t       create;
+    bp_table_destroy_t      destroy;
+    bp_table_add_t          add;
+    bp_table_next_t         next;
+    bp_table_remove_t       remove;
+    bp_table_remove_range_t remove_range;
+    bp_table_available_t    available;
+    bp_table_count_t        count;
+    bp_table_resize_t       resize;
 } bp_active_table_t;
 
+/* Custody Source - aggregates custody of bundles received from one custodian */
+typedef struct
+{
+    bp_ipn_t      node;           /* custodian that DACS bundles are sent to */
+    bp_ipn_t      service;        /* custodian service that DACS bundles are sent to */
+    bp_custody_t  custody;        /* ranges (rb_tree) or bitmap (cbitmap), see custody_aggregation attribute */
+    bp_val_t      dacs_last_sent; /* milliseconds */
+    unsigned long last_taken;     /* milliseconds, least recently taken source is reused first */
+    /* Adaptive DACS (see adapt_dacs) */
+    unsigned long taken;     /* custody ids taken since the last DACS */
+    unsigned long rate;      /* average custody ids taken per second */
+    bp_val_t      dacs_wait; /* milliseconds, adapted period (zero until the first DACS is sent) */
+} bp_custody_source_t;
+
+/* Token Bucket - paces bundles loaded at a rate (see pace_load) */
+typedef struct
+{
+    int64_t       tokens; /* thousandths of a byte or bundle, goes negative by the rest of the last bundle loaded */
+    unsigned long filled; /* milliseconds */
+} bp_bucket_t;
+
 /* Channel Control Block */
 typedef struct
 {
     /* Storage Service */
     bp_store_t store;
+    /* Protocol Engine */
+    const bp_protocol_t *proto;
     /* Statistics */
     bp_stats_t stats;
     /* Data Bundles */
     bp_bundle_t       bundle;
-    bp_handle_t       bundle_handle;
+    bp_handle_t       bundle_handles[BP_NUM_COS_QUEUES]; /* by class of service, only normal when not scheduled */
     bp_handle_t       payload_handle;
     bp_val_t          current_active_cid;
+    bp_val_t          reserved_active_cid; /* end of block of custody ids reserved by channel */
     bp_handle_t       active_table_signal;
     bp_active_table_t active_table;
+    twheel_t         *retx_timers[BP_NUM_COS_QUEUES]; /* one per bundle queue */
+    bp_val_t          retx_timeout;                   /* milliseconds */
+    bplib_os_mutex_t  forward_lock;                   /* held while a received bundle is forwarded through bundle */
+    /* Class of Service Scheduling (active table lock must be held) */
+    int           cos_scheduling;
+    int           cos_credits[BP_NUM_COS_QUEUES]; /* bundles left to load from each queue in weighted round */
+    unsigned long load_events;                    /* counts stored and acknowledged bundles to wake scheduled loads */
+    int           load_waiters;                   /* batch loads waiting for a bundle to be stored */
+    /* Pacing of Loaded Bundles (active table lock must be held) */
+    bp_bucket_t pace_bytes; /* all loaded bundles */
+    bp_bucket_t pace_bundles;
+    bp_bucket_t retx_bytes; /* retransmissions, the retx_share of the load rates */
+    bp_bucket_t retx_bundles;
+    /* Readiness Event */
+    int ready_event; /* pollable descriptor set when there may be something to load or accept */
+    /* Fragment Reassembly */
+    reasm_t         *reasm; /* NULL when received fragments are accepted as they are */
+    bplib_os_mutex_t reasm_lock;
+    /* Duplicate Detection */
+    dedup_t         *dedup; /* NULL when received bundles are not checked for duplicates */
+    bplib_os_mutex_t dedup_lock;
+    /* Expiration Sweep (see sweep_expired) */
+    bp_val_t         sweep_period;                   /* milliseconds, zero when not swept */
+    unsigned long    sweep_last;                     /* milliseconds */
+    bp_object_t     *sweep_heads[BP_NUM_COS_QUEUES]; /* unexpired bundle dequeued by a sweep, loaded next */
+    bplib_os_mutex_t sweep_lock;
+    /* Streamed Payload (see bplib_stream_open) */
+    bool     stream_open;
+    bp_val_t stream_size;   /* total size of payload */
+    bp_val_t stream_sent;   /* payload bytes stored in bundles */
+    int      stream_max;    /* payload bytes carried by each bundle */
+    int      stream_fill;   /* payload bytes collected in stream buffer for the next bundle */
+    uint8_t *stream_buffer; /* collects writes smaller than a bundle (payload bytes per bundle) */
+    /* Payload Compression */
+    uint8_t *compress_buffer; /* holds compressed payload being stored (max length of bundle) */
     /* DTN Aggregate Custody Signals */
-    bp_bundle_t dacs;
-    bp_handle_t dacs_handle;
-    uint8_t    *dacs_buffer;
-    int         dacs_size;
-    bp_val_t    dacs_last_sent;
-    bp_handle_t custody_tree_lock;
-    rb_tree_t   custody_tree;
+    bp_bundle_t          dacs;
+    bp_handle_t          dacs_handle;
+    uint8_t             *dacs_buffer;
+    int                  dacs_size;
+    bp_val_t             dacs_period;   /* milliseconds */
+    bool                 dacs_adaptive; /* DACS sized to max length and period adapted to each source */
+    unsigned long        dacs_urgent;   /* custody ids taken from a source that send its DACS at once when adaptive */
+    bplib_os_mutex_t     custody_tree_lock;
+    bp_custody_source_t *custody_sources; /* one custody tree and dacs rate timer per custodian */
+    int                  num_custody_sources;
+    /* Acknowledged Bundles Waiting to be Relinquished (active table lock must be held) */
+    bp_handle_t relinquish_handle; /* bundle queue that relinquish_sids are from */
+    bp_sid_t    relinquish_sids[BPLIB_MAX_RELINQUISH_BATCH];
+    int         relinquish_count;
+    /* Memory Charged to Channel (see bplib_memstats) */
+    bp_memstats_t memory;
 } bp_channel_t;
 
+/* Acknowledged Bundle Parameters (see delete_bundles) */
+typedef struct
+{
+    bp_channel_t *ch;
+    uint32_t     *flags;
+    unsigned long msnow;
+} bp_ack_parm_t;
+
+/* Partially Reassembled ADU Expiration Parameters (see reassembly_expired) */
+typedef struct
+{
+    bp_channel_t *ch;
+    unsigned long sysnow;
+    bool          unrelt;
+} bp_reasm_parm_t;
+
+/* Lent Payload Parameters */
+typedef struct
+{
+    bp_channel_t *ch;
+    bp_object_t  *object;
+} bp_lent_parm_t;
+
 /*
  * Define the external wrapper type (bp_desc).
  * This is an abstract structure externally, so the contents
@@ -88,9 +198,20 @@ typedef struct
  */
 struct bp_desc
 {
-    bp_channel_t channel;
+    bp_channel_t    channel;
+    struct bp_desc *next; /* next open channel (see bplib_tick) */
 };
 
+/* Routing Table Rule - dispatches bundles destined to the ranges to a channel (see bplib_addroute) */
+typedef struct
+{
+    bp_ipn_t   first_node;
+    bp_ipn_t   last_node;
+    bp_ipn_t   first_service;
+    bp_ipn_t   last_service;
+    bp_desc_t *desc;
+} bp_route_rule_t;
+
 /******************************************************************************
  CONSTANT DATA
  ******************************************************************************/
@@ -107,794 +228,4064 @@ static const bp_attr_t default_attributes = {.lifetime             = BP_DEFAULT_
                                              .timeout              = BP_DEFAULT_TIMEOUT,
                                              .max_length           = BP_DEFAULT_MAX_LENGTH,
                                              .dacs_rate            = BP_DEFAULT_DACS_RATE,
+                                             .load_rate_bytes      = BP_DEFAULT_LOAD_RATE_BYTES,
+                                             .load_rate_bundles    = BP_DEFAULT_LOAD_RATE_BUNDLES,
+                                             .retx_share           = BP_DEFAULT_RETX_SHARE,
                                              .protocol_version     = BP_DEFAULT_PROTOCOL_VERSION,
                                              .retransmit_order     = BP_DEFAULT_RETRANSMIT_ORDER,
                                              .active_table_size    = BP_DEFAULT_ACTIVE_TABLE_SIZE,
                                              .max_fills_per_dacs   = BP_DEFAULT_MAX_FILLS_PER_DACS,
                                              .max_gaps_per_dacs    = BP_DEFAULT_MAX_GAPS_PER_DACS,
+                                             .custody_aggregation  = BP_DEFAULT_CUSTODY_AGGREGATION,
+                                             .max_custody_sources  = BP_DEFAULT_MAX_CUSTODY_SOURCES,
+                                             .cos_scheduling       = BP_DEFAULT_COS_SCHEDULING,
+                                             .reassembly_slots     = BP_DEFAULT_REASSEMBLY_SLOTS,
+                                             .max_adu_length       = BP_DEFAULT_MAX_ADU_LENGTH,
+                                             .duplicate_window     = BP_DEFAULT_DUPLICATE_WINDOW,
+                                             .sweep_rate           = BP_DEFAULT_SWEEP_RATE,
+                                             .adaptive_dacs        = BP_DEFAULT_ADAPTIVE_DACS,
                                              .persistent_storage   = BP_DEFAULT_PERSISTENT_STORAGE,
-                                             .storage_service_parm = BP_DEFAULT_STORAGE_SERVICE_PARM};
+                                             .storage_service_parm = BP_DEFAULT_STORAGE_SERVICE_PARM,
+                                             .payload_compressor   = BP_DEFAULT_PAYLOAD_COMPRESSOR};
+
+/* Protocol Engines (by attributes.protocol_version, or by the start of a received bundle) */
+static const bp_protocol_t *const bplib_protocols[] = {&v6_protocol,
+#ifdef BPLIB_INCLUDE_BPV7
+                                                       &v7_protocol,
+#endif
+};
+
+#define BP_NUM_PROTOCOLS (sizeof(bplib_protocols) / sizeof(bplib_protocols[0]))
+
+/* Storage Service Types of Bundle Queues (indexed by class of service) */
+static const int bundle_queue_types[BP_NUM_COS_QUEUES] = {BP_STORE_BULK_TYPE, BP_STORE_DATA_TYPE,
+                                                          BP_STORE_EXPEDITED_TYPE};
 
 /******************************************************************************
  FILE DATA
  ******************************************************************************/
 
 #if BPLIB_GLOBAL_CUSTODY_ID
-bp_handle_t bplib_custody_id_mutex  = {0};
-bp_val_t    bplib_global_custody_id = 0;
+#ifndef __GNUC__
+bp_handle_t bplib_custody_id_mutex = {0}; /* only needed without atomic builtins */
+#endif
+bp_val_t bplib_global_custody_id = 0;
 #endif
 
+/* Open Channels */
+bplib_os_mutex_t bplib_channel_list_lock = {0};
+bp_desc_t       *bplib_channel_list      = NULL;
+
+/* Routing Table - rules sorted from the narrowest ranges to the widest */
+bplib_os_mutex_t bplib_route_table_lock = {0};
+bp_route_rule_t  bplib_route_table[BPLIB_MAX_ROUTES];
+int              bplib_num_routes = 0;
+
 /******************************************************************************
  LOCAL FUNCTIONS
  ******************************************************************************/
 
 /*--------------------------------------------------------------------------------------
- * create_bundle
+ * custody_tree_create - allocates an rb_tree for custody aggregation (see bp_custody_t)
  *-------------------------------------------------------------------------------------*/
-BP_LOCAL_SCOPE int create_bundle(void *parm, bool is_record, const uint8_t *payload, int size, int timeout)
+BP_LOCAL_SCOPE int custody_tree_create(void **tree, int size)
 {
-    bp_channel_t     *ch     = (bp_channel_t *)parm;
-    bp_bundle_data_t *data   = NULL;
-    bp_handle_t       handle = BP_INVALID_HANDLE;
+    *tree = bplib_os_calloc_tag(sizeof(rb_tree_t), BP_MEM_CUSTODY);
+    if (*tree == NULL)
+    {
+        return BP_ERROR;
+    }
 
-    /* Set Type of Bundle */
-    if (is_record)
+    int status = rb_tree_create(size, (rb_tree_t *)*tree);
+    if (status != BP_SUCCESS)
     {
-        handle = ch->dacs_handle;
-        data   = &ch->dacs.data;
+        bplib_os_free(*tree);
+        *tree = NULL;
     }
-    else /* data bundle */
+
+    return status;
+}
+
+/*--------------------------------------------------------------------------------------
+ * custody_tree_destroy - frees an rb_tree allocated by custody_tree_create
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int custody_tree_destroy(void *tree)
+{
+    if (tree)
     {
-        handle = ch->bundle_handle;
-        data   = &ch->bundle.data;
+        rb_tree_destroy((rb_tree_t *)tree);
+        bplib_os_free(tree);
     }
 
-    /* Enqueue Bundle */
-    int storage_header_size = &data->header[data->headersize] - (uint8_t *)data;
-    return ch->store.enqueue(handle, data, storage_header_size, payload, size, timeout);
+    return BP_SUCCESS;
 }
 
+#if BPLIB_LATENCY_STATS
 /*--------------------------------------------------------------------------------------
- * delete_bundle
+ * latency_record - adds a latency sample to a histogram
+ *
+ *  updated atomically since the storage histograms are sampled by bplib_process
+ *  running on several threads at once as well as by the other channel functions
  *-------------------------------------------------------------------------------------*/
-BP_LOCAL_SCOPE int delete_bundle(void *parm, bp_val_t cid, uint32_t *flags)
+BP_LOCAL_SCOPE void latency_record(bp_histogram_t *hist, unsigned long usecs)
 {
-    bp_channel_t *ch = (bp_channel_t *)parm;
+    int bucket = 0;
 
-    bp_active_bundle_t bundle;
-    int                status = ch->active_table.remove(ch->active_table.table, cid, &bundle);
-    if (status == BP_SUCCESS)
+    /* Find Log2 Bucket */
+    while (bucket < (BP_LATENCY_BUCKETS - 1) && (usecs >> bucket) != 0)
+    {
+        bucket++;
+    }
+
+    /* Update Histogram */
+    if (usecs > UINT32_MAX)
+    {
+        usecs = UINT32_MAX;
+    }
+    uint32_t max = __atomic_load_n(&hist->max, __ATOMIC_RELAXED);
+    while (usecs > max &&
+           !__atomic_compare_exchange_n(&hist->max, &max, (uint32_t)usecs, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+        /* max reloaded by failed exchange */
+    }
+    __atomic_add_fetch(&hist->buckets[bucket], 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&hist->count, 1, __ATOMIC_RELAXED);
+}
+#endif
+
+/*--------------------------------------------------------------------------------------
+ * latency_start - returns the start time of a latency measurement (microseconds)
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE unsigned long latency_start(void)
+{
+    unsigned long usnow = 0;
+#if BPLIB_LATENCY_STATS
+    bplib_os_monotime_us(&usnow);
+#endif
+    return usnow;
+}
+
+/*--------------------------------------------------------------------------------------
+ * latency_stop - records the latency since the start of a measurement
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void latency_stop(bp_histogram_t *hist, unsigned long start)
+{
+#if BPLIB_LATENCY_STATS
+    latency_record(hist, latency_start() - start);
+#else
+    (void)hist;
+    (void)start;
+#endif
+}
+
+/*--------------------------------------------------------------------------------------
+ * stats_add - updates a statistic of a call that may run on several threads at once (e.g. bplib_process,
+ *  bplib_load, bplib_accept)
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void stats_add(uint32_t *stat, int delta)
+{
+    __atomic_add_fetch(stat, (uint32_t)delta, __ATOMIC_RELAXED);
+}
+
+/*--------------------------------------------------------------------------------------
+ * store_enqueue - enqueues an object, memory the storage service allocates is charged to the channel
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int store_enqueue(bp_channel_t *ch, bp_handle_t h, const void *data1, size_t data1_size,
+                                 const void *data2, size_t data2_size, int timeout)
+{
+    bptrace2(enqueue_entry, ch, data1_size + data2_size);
+    bp_memstats_t *prev   = bplib_os_memaccount(&ch->memory);
+    int            status = ch->store.enqueue(h, data1, data1_size, data2, data2_size, timeout);
+    bplib_os_memaccount(prev);
+    bptrace2(enqueue_return, ch, status);
+    return status;
+}
+
+/*--------------------------------------------------------------------------------------
+ * store_dequeue - dequeues an object, memory the storage service allocates is charged to the channel
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int store_dequeue(bp_channel_t *ch, bp_handle_t h, bp_object_t **object, int timeout)
+{
+    bptrace1(dequeue_entry, ch);
+    bp_memstats_t *prev   = bplib_os_memaccount(&ch->memory);
+    int            status = ch->store.dequeue(h, object, timeout);
+    bplib_os_memaccount(prev);
+    bptrace3(dequeue_return, ch, status, status == BP_SUCCESS ? (*object)->header.sid : BP_SID_VACANT);
+    return status;
+}
+
+/*--------------------------------------------------------------------------------------
+ * store_retrieve - retrieves an object, memory the storage service allocates is charged to the channel
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int store_retrieve(bp_channel_t *ch, bp_handle_t h, bp_sid_t sid, bp_object_t **object, int timeout)
+{
+    bptrace2(retrieve_entry, ch, sid);
+    bp_memstats_t *prev   = bplib_os_memaccount(&ch->memory);
+    int            status = ch->store.retrieve(h, sid, object, timeout);
+    bplib_os_memaccount(prev);
+    bptrace2(retrieve_return, ch, status);
+    return status;
+}
+
+/*--------------------------------------------------------------------------------------
+ * store_allocate - allocates an object to fill in place, charged to the channel
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bp_object_t *store_allocate(bp_channel_t *ch, bp_handle_t h, size_t size)
+{
+    bp_memstats_t *prev   = bplib_os_memaccount(&ch->memory);
+    bp_object_t   *object = ch->store.allocate(h, size);
+    bplib_os_memaccount(prev);
+    return object;
+}
+
+/*--------------------------------------------------------------------------------------
+ * store_enqueue_batch - enqueues objects in order, one storage service call when supported
+ *
+ *  Returns number of objects enqueued, or error code of the first object when none are
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int store_enqueue_batch(bp_channel_t *ch, bp_handle_t h, const bp_store_vec_t *objects, int count,
+                                       int timeout)
+{
+    int i;
+
+    if (ch->store.enqueue_batch)
     {
-        status = ch->store.relinquish(ch->bundle_handle, bundle.sid);
+        bptrace2(enqueue_batch_entry, ch, count);
+        bp_memstats_t *prev   = bplib_os_memaccount(&ch->memory);
+        int            status = ch->store.enqueue_batch(h, objects, count, timeout);
+        bplib_os_memaccount(prev);
+        bptrace2(enqueue_batch_return, ch, status);
+        return status;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        int status = store_enqueue(ch, h, objects[i].data1, objects[i].data1_size, objects[i].data2,
+                                   objects[i].data2_size, timeout);
         if (status != BP_SUCCESS)
         {
-            bplog(flags, BP_FLAG_STORE_FAILURE, "Failed (%d) to relinquish bundle\n", status);
+            return i > 0 ? i : status;
         }
     }
-    else
+
+    return count;
+}
+
+/*--------------------------------------------------------------------------------------
+ * store_dequeue_batch - dequeues up to max objects, only the first waits on the timeout
+ *
+ *  Returns number of objects dequeued, or error code (BP_TIMEOUT when empty)
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int store_dequeue_batch(bp_channel_t *ch, bp_handle_t h, bp_object_t **objects, int max, int timeout)
+{
+    int i;
+
+    if (ch->store.dequeue_batch)
     {
-        bplog(flags, BP_FLAG_UNKNOWN_CID, "Failed (%d) to remove bundle with CID=%lu from active table\n", status,
-              (unsigned long)cid);
+        bptrace2(dequeue_batch_entry, ch, max);
+        bp_memstats_t *prev   = bplib_os_memaccount(&ch->memory);
+        int            status = ch->store.dequeue_batch(h, objects, max, timeout);
+        bplib_os_memaccount(prev);
+        bptrace2(dequeue_batch_return, ch, status);
+        return status;
     }
 
-    /* Return Status */
-    return status;
+    for (i = 0; i < max; i++)
+    {
+        int status = store_dequeue(ch, h, &objects[i], i == 0 ? timeout : BP_CHECK);
+        if (status != BP_SUCCESS)
+        {
+            return i > 0 ? i : status;
+        }
+    }
+
+    return max;
 }
 
 /*--------------------------------------------------------------------------------------
- * create_dacs
+ * store_relinquish_batch - relinquishes every object, returns first error code
  *-------------------------------------------------------------------------------------*/
-BP_LOCAL_SCOPE int create_dacs(bp_channel_t *ch, unsigned long sysnow, int timeout, uint32_t *flags)
+BP_LOCAL_SCOPE int store_relinquish_batch(bp_channel_t *ch, bp_handle_t h, const bp_sid_t *sids, int count)
 {
     int ret_status = BP_SUCCESS;
+    int i;
 
-    /* If the custody_tree has nodes, initialize the iterator for traversing the custody_tree in order */
-    rb_tree_goto_first(&ch->custody_tree);
+    bptrace2(relinquish_entry, ch, count);
 
-    /* Continue to delete nodes from the custody_tree and write them to DACS until the custody_tree is empty */
-    while (!rb_tree_is_empty(&ch->custody_tree))
+    if (ch->store.relinquish_batch)
     {
-        /* Build Acknowledgment - will remove nodes from the custody_tree */
-        int size = v6_populate_acknowledgment(ch->dacs_buffer, ch->dacs_size, ch->dacs.attributes.max_fills_per_dacs,
-                                              &ch->custody_tree, flags);
-        if (size > 0)
+        ret_status = ch->store.relinquish_batch(h, sids, count);
+    }
+    else
+    {
+        for (i = 0; i < count; i++)
         {
-            int status = BP_SUCCESS;
-
-            /* Check if Re-initialization Needed */
-            if (ch->dacs.prebuilt == false)
-            {
-                status = v6_populate_bundle(&ch->dacs, flags);
-            }
-
-            /* Send Bundle */
-            if (status == BP_SUCCESS)
+            int status = ch->store.relinquish(h, sids[i]);
+            if (status != BP_SUCCESS && ret_status == BP_SUCCESS)
             {
-                status = v6_send_bundle(&ch->dacs, ch->dacs_buffer, size, create_bundle, ch, timeout, flags);
-                if (status == BP_SUCCESS)
-                {
-                    /* DACS successfully enqueued */
-                    ch->dacs_last_sent = sysnow;
-                }
-                else if (ret_status == BP_SUCCESS)
-                {
-                    /* Save first failed DACS enqueue to return later */
-                    bplog(flags, BP_FLAG_STORE_FAILURE, "Failed (%d) to send DACS bundle\n", status);
-                    ret_status = status;
-                    ch->stats.lost++;
-                }
+                ret_status = status;
             }
         }
     }
 
-    /* Return Status */
+    bptrace2(relinquish_return, ch, ret_status);
     return ret_status;
 }
 
-/******************************************************************************
- EXPORTED FUNCTIONS
- ******************************************************************************/
-
 /*--------------------------------------------------------------------------------------
- * bplib_init - initializes bp library
+ * dequeue_bundle - dequeues a bundle from a queue, starting with the head left by an expiration sweep
  *-------------------------------------------------------------------------------------*/
-int bplib_init(void)
+BP_LOCAL_SCOPE int dequeue_bundle(bp_channel_t *ch, int queue, bp_object_t **object, int timeout)
 {
-    int status;
+    if (ch->sweep_period > 0)
+    {
+        bplib_os_mutex_lock(&ch->sweep_lock);
+        {
+            *object                = ch->sweep_heads[queue];
+            ch->sweep_heads[queue] = NULL;
+        }
+        bplib_os_mutex_unlock(&ch->sweep_lock);
 
-    /* Initialize OS Interface */
-    bplib_os_init();
+        if (*object)
+        {
+            return BP_SUCCESS;
+        }
+    }
 
-    /* Initialize CRC algorithms */
-    bplib_crc_init();
+    return store_dequeue(ch, ch->bundle_handles[queue], object, timeout);
+}
 
-    /* Initialize v6 Module */
-    status = v6_initialize();
-    if (status != BP_SUCCESS)
+/*--------------------------------------------------------------------------------------
+ * dequeue_bundles - dequeues up to max bundles from a queue, starting with the head left by an expiration sweep
+ *
+ *  Returns number of bundles dequeued, or error code (BP_TIMEOUT when empty)
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int dequeue_bundles(bp_channel_t *ch, int queue, bp_object_t **objects, int max, int timeout)
+{
+    int status;
+
+    if (ch->sweep_period > 0 && max > 0 && dequeue_bundle(ch, queue, &objects[0], BP_CHECK) == BP_SUCCESS)
     {
-        return status;
+        status = max > 1 ? store_dequeue_batch(ch, ch->bundle_handles[queue], &objects[1], max - 1, BP_CHECK) : 0;
+        return status > 0 ? status + 1 : 1;
     }
 
-/* (Optional) Global Custody ID */
-#if BPLIB_GLOBAL_CUSTODY_ID
-    bplib_custody_id_mutex  = bplib_os_createlock();
-    bplib_global_custody_id = 0;
-#endif
+    return store_dequeue_batch(ch, ch->bundle_handles[queue], objects, max, timeout);
+}
 
-    /* Return Success */
-    return BP_SUCCESS;
+/*--------------------------------------------------------------------------------------
+ * storage_header_size - size of the bundle data stored in front of the payload
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int storage_header_size(bp_bundle_data_t *data)
+{
+    return &data->header[data->headersize] - (uint8_t *)data;
 }
 
 /*--------------------------------------------------------------------------------------
- * bplib_deinit - deinitializes bp library
+ * lent_header_size - storage header size that will precede a payload sent on the channel
  *-------------------------------------------------------------------------------------*/
-void bplib_deinit(void)
+BP_LOCAL_SCOPE int lent_header_size(bp_channel_t *ch)
 {
-/* (Optional) Global Custody ID */
-#if BPLIB_GLOBAL_CUSTODY_ID
-    if (bp_handle_is_valid(bplib_custody_id_mutex))
-    {
-        bplib_os_destroylock(bplib_custody_id_mutex);
-        bplib_custody_id_mutex = BP_INVALID_HANDLE;
-    }
-#endif
+    return offsetof(bp_bundle_data_t, header) + ch->proto->header_size(&ch->bundle);
 }
 
 /*--------------------------------------------------------------------------------------
- * bplib_open -
+ * lent_stash - records the storage header size of a lent payload in the bytes
+ *  preceding it; these bytes are overwritten by the storage header when stored
  *-------------------------------------------------------------------------------------*/
-bp_desc_t *bplib_open(bp_route_t route, bp_store_t store, bp_attr_t attributes)
+BP_LOCAL_SCOPE void lent_stash(uint8_t *payload, int hdrsz)
 {
-    assert(store.create);
-    assert(store.destroy);
-    assert(store.enqueue);
-    assert(store.dequeue);
-    assert(store.retrieve);
-    assert(store.release);
-    assert(store.relinquish);
-    assert(store.getcount);
+    memcpy(payload - sizeof(hdrsz), &hdrsz, sizeof(hdrsz));
+}
 
-    int status = BP_SUCCESS;
+/*--------------------------------------------------------------------------------------
+ * lent_object - returns the storage object of a lent payload
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bp_object_t *lent_object(uint8_t *payload, int *hdrsz)
+{
+    memcpy(hdrsz, payload - sizeof(*hdrsz), sizeof(*hdrsz));
+    return (bp_object_t *)(payload - *hdrsz - sizeof(bp_object_hdr_t));
+}
 
-    /* Validate Attributes */
-    if (attributes.protocol_version != 6)
+/*--------------------------------------------------------------------------------------
+ * bundle_queue - class of service queue that bundles of a class are stored in
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int bundle_queue(bp_channel_t *ch, int cos)
+{
+    if (ch->cos_scheduling == BP_SCHEDULE_FIFO)
     {
-        bplog(NULL, BP_FLAG_NONCOMPLIANT, "Unsupported bundle protocol version: %d\n", attributes.protocol_version);
-        return NULL;
+        return BP_COS_NORMAL; /* single queue */
     }
-    else if (attributes.timeout > 0 && attributes.active_table_size <= 0)
+    else if (cos <= BP_COS_BULK)
     {
-        bplog(NULL, BP_FLAG_API_ERROR, "Active table size must be greater than zero when a timeout is specified\n");
-        return NULL;
+        return BP_COS_BULK;
     }
-    else if (attributes.timeout < 0)
+    else if (cos >= BP_COS_EXPEDITED)
     {
-        bplog(NULL, BP_FLAG_API_ERROR, "Timeout cannot be negative\n");
-        return NULL;
+        return BP_COS_EXPEDITED; /* includes extended class of service */
     }
-    else if (attributes.max_length < 0)
+    else
     {
-        bplog(NULL, BP_FLAG_API_ERROR, "Max length cannot be negative\n");
-        return NULL;
+        return BP_COS_NORMAL;
     }
+}
 
-    /* Allocate Channel */
-    bp_desc_t *desc = (bp_desc_t *)bplib_os_calloc(sizeof(bp_desc_t));
-    if (desc == NULL)
+/*--------------------------------------------------------------------------------------
+ * stored_bundles - number of bundles held by the storage service in all queues
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int stored_bundles(bp_channel_t *ch)
+{
+    int count = 0;
+    int q;
+
+    for (q = 0; q < BP_NUM_COS_QUEUES; q++)
     {
-        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Cannot open channel: not enough memory\n");
-        return NULL;
+        if (bp_handle_is_valid(ch->bundle_handles[q]))
+        {
+            count += ch->store.getcount(ch->bundle_handles[q]);
+        }
     }
 
-    bp_channel_t *ch = &desc->channel;
+    return count;
+}
 
-    /* Clear Channel Memory and Initialize to Defaults */
-    ch->custody_tree_lock   = BP_INVALID_HANDLE;
-    ch->active_table_signal = BP_INVALID_HANDLE;
-    ch->bundle_handle       = BP_INVALID_HANDLE;
-    ch->payload_handle      = BP_INVALID_HANDLE;
-    ch->dacs_handle         = BP_INVALID_HANDLE;
-
-    /* Set Store */
-    ch->store = store;
+/*--------------------------------------------------------------------------------------
+ * schedule_queues - orders the queues the next bundle is loaded from (active table lock must be held)
+ *
+ *  Strict priority tries expedited, then normal, then bulk bundles.  Weighted priority does
+ *  the same, except that queues which have used up their weight this round are tried last.
+ *  Returns the number of queues in the order.
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int schedule_queues(bp_channel_t *ch, int *order)
+{
+    int num_queues = 0;
+    int q;
 
-    /* Initialize Bundle Store */
-    ch->bundle_handle = ch->store.create(BP_STORE_DATA_TYPE, route.local_node, route.local_service,
-                                         attributes.persistent_storage, attributes.storage_service_parm);
-    if (!bp_handle_is_valid(ch->bundle_handle))
+    /* Queues with Weight Left in Round (all queues for strict priority) */
+    for (q = BP_COS_EXPEDITED; q >= BP_COS_BULK; q--)
     {
-        bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to create storage handle for bundles\n");
-        bplib_close(desc);
-        return NULL;
+        if (ch->cos_scheduling == BP_SCHEDULE_STRICT || ch->cos_credits[q] > 0)
+        {
+            order[num_queues++] = q;
+        }
     }
 
-    /* Initialize Payload Store */
-    ch->payload_handle = ch->store.create(BP_STORE_PAYLOAD_TYPE, route.local_node, route.local_service,
-                                          attributes.persistent_storage, attributes.storage_service_parm);
-    if (!bp_handle_is_valid(ch->payload_handle))
+    /* Queues that Used up their Weight */
+    for (q = BP_COS_EXPEDITED; q >= BP_COS_BULK; q--)
     {
-        bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to create storage handle for payloads\n");
-        bplib_close(desc);
-        return NULL;
+        if (ch->cos_scheduling == BP_SCHEDULE_WEIGHTED && ch->cos_credits[q] <= 0)
+        {
+            order[num_queues++] = q;
+        }
     }
 
-    /* Initialize DACS Store */
-    ch->dacs_handle = ch->store.create(BP_STORE_DACS_TYPE, route.local_node, route.local_service,
-                                       attributes.persistent_storage, attributes.storage_service_parm);
-    if (!bp_handle_is_valid(ch->dacs_handle))
-    {
-        bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to create storage handle for dacs\n");
-        bplib_close(desc);
-        return NULL;
-    }
+    return num_queues;
+}
 
-    /* Initialize Bundle */
-    status = v6_create(&ch->bundle, route, attributes);
-    if (status != BP_SUCCESS)
+/*--------------------------------------------------------------------------------------
+ * charge_queue - counts a bundle loaded from a queue against its weight (active table lock must be held)
+ *
+ *  Loading from a queue without weight left means the queues with weight had nothing
+ *  to send, so a new round is started.
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void charge_queue(bp_channel_t *ch, int q)
+{
+    if (ch->cos_credits[q] <= 0)
     {
-        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to initialize bundle\n", status);
-        bplib_close(desc);
-        return NULL;
+        ch->cos_credits[BP_COS_BULK]      = BPLIB_COS_BULK_WEIGHT;
+        ch->cos_credits[BP_COS_NORMAL]    = BPLIB_COS_NORMAL_WEIGHT;
+        ch->cos_credits[BP_COS_EXPEDITED] = BPLIB_COS_EXPEDITED_WEIGHT;
     }
 
-    /* Build DACS Attributes */
-    bp_attr_t dacs_attributes       = attributes;
-    dacs_attributes.request_custody = false;
-    dacs_attributes.admin_record    = true;
+    ch->cos_credits[q]--;
+}
 
-    /* Build DACS Route */
-    bp_route_t custody_route          = route;
-    custody_route.destination_node    = BP_IPN_NULL;
-    custody_route.destination_service = BP_IPN_NULL;
+/*--------------------------------------------------------------------------------------
+ * bundle_stored - notifies loads that a data bundle was stored
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void bundle_stored(bp_channel_t *ch)
+{
+    bplib_os_setevent(ch->ready_event);
 
-    /* Initialize DACS */
-    status = v6_create(&ch->dacs, custody_route, dacs_attributes);
-    if (status != BP_SUCCESS)
+    /* Wake Load Waiting on Scheduled Queues (see bplib_load) or on an Empty Batch (see bplib_load_batch)
+     *  the fence orders the store before the waiter check, pairing with the fence in bplib_load_batch */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    bool batch_waiting = __atomic_load_n(&ch->load_waiters, __ATOMIC_RELAXED) > 0;
+    if (ch->cos_scheduling != BP_SCHEDULE_FIFO || batch_waiting)
     {
-        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to initialize dacs\n");
-        bplib_close(desc);
-        return NULL;
+        bplib_os_lock(ch->active_table_signal);
+        {
+            ch->load_events++;
+            if (batch_waiting)
+            {
+                bplib_os_broadcast(ch->active_table_signal);
+            }
+            else
+            {
+                bplib_os_signal(ch->active_table_signal);
+            }
+        }
+        bplib_os_unlock(ch->active_table_signal);
     }
+}
 
-    /* Create DACS Lock */
-    ch->custody_tree_lock = bplib_os_createlock();
-    if (!bp_handle_is_valid(ch->custody_tree_lock))
-    {
-        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to create a lock for dacs processing\n");
-        bplib_close(desc);
-        return NULL;
-    }
+/*--------------------------------------------------------------------------------------
+ * bucket_fill - adds tokens accrued at rate (per second) since last filled
+ *
+ *  Returns the number of milliseconds until the bucket has tokens, zero when it has some
+ *  or is not paced (rate <= 0).
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int bucket_fill(bp_bucket_t *bucket, int rate, unsigned long msnow)
+{
+    unsigned long elapsed = msnow - bucket->filled;
+    bucket->filled        = msnow;
 
-    /* Allocate Memory for Channel DACS Bundle Fills */
-    ch->dacs_size =
-        sizeof(bp_val_t) * attributes.max_fills_per_dacs + 6; /* 2 bytes per fill plus payload block header */
-    ch->dacs_buffer = (uint8_t *)bplib_os_calloc(ch->dacs_size);
-    if (ch->dacs_buffer == NULL)
+    /* Not Paced */
+    if (rate <= 0)
     {
-        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to allocate memory for channel DACS\n");
-        bplib_close(desc);
-        return NULL;
+        bucket->tokens = 0;
+        return 0;
     }
 
-    /* Allocate Memory for DACS Channel Tree to Store Bundle IDs */
-    status = rb_tree_create(attributes.max_gaps_per_dacs, &ch->custody_tree);
-    if (status != BP_SUCCESS)
+    /* Add Tokens up to Depth of Bucket (at least one byte or bundle) */
+    int64_t depth = (int64_t)rate * BPLIB_PACING_BURST_MS;
+    if (depth < 1000)
     {
-        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to allocate memory for channel DACS tree\n");
-        bplib_close(desc);
-        return NULL;
+        depth = 1000;
     }
-
-    /* Initialize Last Time DACS Sent */
-    ch->dacs_last_sent = 0;
-
-    /* Initialize Active Table Signal */
-    ch->active_table_signal = bplib_os_createlock();
-    if (!bp_handle_is_valid(ch->active_table_signal))
+    if (elapsed > INT32_MAX)
     {
-        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to create custody_tree_lock for active table\n");
-        bplib_close(desc);
-        return NULL;
+        elapsed = INT32_MAX; /* keeps tokens added from overflowing, bucket is full long before */
     }
-
-    /* Initialize Active Table Functions */
-    if (attributes.retransmit_order == BP_RETX_SMALLEST_CID)
+    bucket->tokens += (int64_t)elapsed * rate; /* a rate per second is thousandths per millisecond */
+    if (bucket->tokens > depth)
     {
-        ch->active_table.create    = (bp_table_create_t)cbuf_create;
-        ch->active_table.destroy   = (bp_table_destroy_t)cbuf_destroy;
-        ch->active_table.add       = (bp_table_add_t)cbuf_add;
-        ch->active_table.next      = (bp_table_next_t)cbuf_next;
-        ch->active_table.remove    = (bp_table_remove_t)cbuf_remove;
-        ch->active_table.available = (bp_table_available_t)cbuf_available;
-        ch->active_table.count     = (bp_table_count_t)cbuf_count;
+        bucket->tokens = depth;
     }
-    else if (attributes.retransmit_order == BP_RETX_OLDEST_BUNDLE)
+
+    /* Time until Tokens Available */
+    if (bucket->tokens > 0)
     {
-        ch->active_table.create    = (bp_table_create_t)rh_hash_create;
-        ch->active_table.destroy   = (bp_table_destroy_t)rh_hash_destroy;
-        ch->active_table.add       = (bp_table_add_t)rh_hash_add;
-        ch->active_table.next      = (bp_table_next_t)rh_hash_next;
-        ch->active_table.remove    = (bp_table_remove_t)rh_hash_remove;
-        ch->active_table.available = (bp_table_available_t)rh_hash_available;
-        ch->active_table.count     = (bp_table_count_t)rh_hash_count;
+        return 0;
     }
-    else
+    return (int)(-bucket->tokens / rate) + 1;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bucket_take - removes tokens of loaded bytes or bundles, going into debt if they run out
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void bucket_take(bp_bucket_t *bucket, int rate, size_t units)
+{
+    if (rate > 0)
     {
-        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Unrecognized attribute for creating active table: %d\n",
-              attributes.retransmit_order);
-        bplib_close(desc);
-        return NULL;
+        bucket->tokens -= (int64_t)units * 1000;
     }
+}
 
-    /* Initialize Active Table */
-    status = ch->active_table.create(&ch->active_table.table, attributes.active_table_size);
-    if (status != BP_SUCCESS)
+/*--------------------------------------------------------------------------------------
+ * retx_rate - share of a load rate that retransmissions are paced at
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int retx_rate(bp_channel_t *ch, int rate)
+{
+    if (rate <= 0)
     {
-        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to create active table for channel\n");
-        bplib_close(desc);
-        return NULL;
+        return 0;
     }
 
-    /* Initialize Current Custody ID */
-    ch->current_active_cid = 0;
-
-    /* Return Channel */
-    return desc;
+    int64_t share = ((int64_t)rate * ch->bundle.attributes.retx_share) / 100;
+    return share > 0 ? (int)share : 1;
 }
 
 /*--------------------------------------------------------------------------------------
- * bplib_close -
+ * pace_load - checks the load rates of a paced channel (active table lock must be held)
+ *
+ *  Returns the number of milliseconds until another bundle can be loaded, zero when one
+ *  can be now; retx is set when a retransmission also fits in its share of the load rates.
  *-------------------------------------------------------------------------------------*/
-void bplib_close(bp_desc_t *desc)
+BP_LOCAL_SCOPE int pace_load(bp_channel_t *ch, unsigned long msnow, bool *retx)
 {
-    /* Check Parameters */
-    if (desc == NULL)
-    {
-        return;
-    }
+    int bytes   = ch->bundle.attributes.load_rate_bytes;
+    int bundles = ch->bundle.attributes.load_rate_bundles;
+
+    /* Fill Buckets */
+    int byte_delay        = bucket_fill(&ch->pace_bytes, bytes, msnow);
+    int bundle_delay      = bucket_fill(&ch->pace_bundles, bundles, msnow);
+    int retx_byte_delay   = bucket_fill(&ch->retx_bytes, retx_rate(ch, bytes), msnow);
+    int retx_bundle_delay = bucket_fill(&ch->retx_bundles, retx_rate(ch, bundles), msnow);
+
+    /* Return Time until Load */
+    int delay = byte_delay > bundle_delay ? byte_delay : bundle_delay;
+    *retx     = (delay == 0) && (retx_byte_delay == 0) && (retx_bundle_delay == 0);
+    return delay;
+}
 
-    /* Get Channel */
-    bp_channel_t *ch = &desc->channel;
+/*--------------------------------------------------------------------------------------
+ * pace_charge - takes a loaded bundle out of the load rates (active table lock must be held)
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void pace_charge(bp_channel_t *ch, size_t size, bool resend)
+{
+    int bytes   = ch->bundle.attributes.load_rate_bytes;
+    int bundles = ch->bundle.attributes.load_rate_bundles;
 
-    /* Un-initialize Bundle Store */
-    if (bp_handle_is_valid(ch->bundle_handle))
+    bucket_take(&ch->pace_bytes, bytes, size);
+    bucket_take(&ch->pace_bundles, bundles, 1);
+    if (resend)
     {
-        ch->store.destroy(ch->bundle_handle);
-        ch->bundle_handle = BP_INVALID_HANDLE;
+        bucket_take(&ch->retx_bytes, retx_rate(ch, bytes), size);
+        bucket_take(&ch->retx_bundles, retx_rate(ch, bundles), 1);
     }
+}
 
-    /* Un-initialize Payload Store */
-    if (bp_handle_is_valid(ch->payload_handle))
-    {
-        ch->store.destroy(ch->payload_handle);
-        ch->payload_handle = BP_INVALID_HANDLE;
-    }
+/*--------------------------------------------------------------------------------------
+ * create_bundle
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int create_bundle(void *parm, bool is_record, const uint8_t *payload, int size, int timeout)
+{
+    bp_channel_t     *ch     = (bp_channel_t *)parm;
+    bp_bundle_data_t *data   = NULL;
+    bp_handle_t       handle = BP_INVALID_HANDLE;
 
-    /* Un-initialize Record Store */
-    if (bp_handle_is_valid(ch->dacs_handle))
+    /* Set Type of Bundle */
+    if (is_record)
     {
-        ch->store.destroy(ch->dacs_handle);
-        ch->dacs_handle = BP_INVALID_HANDLE;
+        handle = ch->dacs_handle;
+        data   = &ch->dacs.data;
     }
-
-    /* Destroy Custody Tree Lock */
-    if (bp_handle_is_valid(ch->custody_tree_lock))
+    else /* data bundle */
     {
-        bplib_os_destroylock(ch->custody_tree_lock);
-        ch->custody_tree_lock = BP_INVALID_HANDLE;
+        handle = ch->bundle_handles[bundle_queue(ch, ch->bundle.attributes.class_of_service)];
+        data   = &ch->bundle.data;
     }
 
-    /* Free Buffer for DACS */
-    if (ch->dacs_buffer)
+    /* Enqueue Bundle */
+    unsigned long start  = latency_start();
+    data->enqtime        = start;
+    int           status = store_enqueue(ch, handle, data, storage_header_size(data), payload, size, timeout);
+    latency_stop(&ch->stats.enqueue, start);
+    bptrace4(store, ch, is_record, size, status);
+    if (status == BP_SUCCESS)
     {
-        bplib_os_free(ch->dacs_buffer);
-        ch->dacs_buffer = NULL;
+        if (is_record)
+        {
+            bplib_os_setevent(ch->ready_event);
+        }
+        else
+        {
+            bundle_stored(ch);
+        }
     }
 
-    /* Free Custody Tree */
-    rb_tree_destroy(&ch->custody_tree);
+    /* Return Status */
+    return status;
+}
 
-    /* Un-initialize Bundle and DACS */
-    v6_destroy(&ch->bundle);
-    v6_destroy(&ch->dacs);
+/*--------------------------------------------------------------------------------------
+ * create_lent_bundle - posts a lent payload with its storage header written in place
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int create_lent_bundle(void *parm, bool is_record, const uint8_t *payload, int size, int timeout)
+{
+    bp_lent_parm_t   *lent   = (bp_lent_parm_t *)parm;
+    bp_channel_t     *ch     = lent->ch;
+    bp_bundle_data_t *data   = &ch->bundle.data;
+    int               hdrsz  = storage_header_size(data);
+    int               status = BP_SUCCESS;
 
-    /* Un-initialize Active Table */
-    if (bp_handle_is_valid(ch->active_table_signal))
+    (void)is_record;
+
+    /* Check Payload is In Place (a lent payload is never fragmented) */
+    if (payload != (uint8_t *)&lent->object->data[hdrsz] || (size_t)(hdrsz + size) != lent->object->header.size)
     {
-        bplib_os_destroylock(ch->active_table_signal);
+        return BP_ERROR;
     }
-    if (ch->active_table.destroy)
+
+    /* Write Storage Header in Front of Payload */
+    unsigned long start = latency_start();
+    data->enqtime       = start;
+    memcpy(lent->object->data, data, hdrsz);
+
+    /* Post Object - ownership passes to storage service */
+    status = ch->store.post(lent->object->header.handle, lent->object, timeout);
+    latency_stop(&ch->stats.enqueue, start);
+    if (status == BP_SUCCESS)
     {
-        ch->active_table.destroy(ch->active_table.table);
+        lent->object = NULL;
+        bundle_stored(ch);
     }
 
-    /* Free Channel */
-    bplib_os_free(desc);
+    /* Return Status */
+    return status;
 }
 
 /*--------------------------------------------------------------------------------------
- * bplib_flush -
+ * reserve_custody_ids - claims the next block of custody ids for the channel
+ *
+ *  With a global custody id, each channel reserves a block of ids at a time so that
+ *  assigning an id only touches shared state once per block
  *-------------------------------------------------------------------------------------*/
-int bplib_flush(bp_desc_t *desc)
+BP_LOCAL_SCOPE void reserve_custody_ids(bp_channel_t *ch)
 {
-    /* Check Parameters */
-    if (desc == NULL)
+#if BPLIB_GLOBAL_CUSTODY_ID
+    bp_val_t cid;
+#ifdef __GNUC__
+    cid = __atomic_fetch_add(&bplib_global_custody_id, BPLIB_CUSTODY_ID_BLOCK_SIZE, __ATOMIC_RELAXED);
+#else
+    bplib_os_lock(bplib_custody_id_mutex);
     {
-        return BP_ERROR;
+        cid = bplib_global_custody_id;
+        bplib_global_custody_id += BPLIB_CUSTODY_ID_BLOCK_SIZE;
     }
+    bplib_os_unlock(bplib_custody_id_mutex);
+#endif
+    ch->current_active_cid  = cid;
+    ch->reserved_active_cid = cid + BPLIB_CUSTODY_ID_BLOCK_SIZE;
+#else
+    ch->reserved_active_cid = ch->current_active_cid + BPLIB_CUSTODY_ID_BLOCK_SIZE;
+#endif
+}
 
-    /* Get Channel */
-    bp_channel_t *ch = &desc->channel;
+/*--------------------------------------------------------------------------------------
+ * assign_custody_id - returns next custody id of channel (active table lock held)
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bp_val_t assign_custody_id(bp_channel_t *ch)
+{
+    bp_val_t cid = ch->current_active_cid++;
+    if (ch->current_active_cid == ch->reserved_active_cid)
+    {
+        reserve_custody_ids(ch);
+    }
+    return cid;
+}
 
-    /* Flush Data Bundles */
-    bp_handle_t handle = ch->bundle_handle;
+/*--------------------------------------------------------------------------------------
+ * start_retx_timer - starts the retransmit timer of a bundle being added to the active table
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void start_retx_timer(bp_channel_t *ch, bp_active_bundle_t *bundle)
+{
+    twheel_t *retx_timers = ch->retx_timers[bundle->cos];
 
-    /* Lock Active Table */
-    bplib_os_lock(ch->active_table_signal);
+    bundle->timer = TWHEEL_NULL_TIMER;
+    if (retx_timers && ch->retx_timeout != 0)
     {
-        /* Relinquish All Active Bundles */
-        bp_active_bundle_t active_bundle;
-        while (ch->active_table.next(ch->active_table.table, &active_bundle) == BP_SUCCESS)
+        int status = twheel_start(retx_timers, bundle->cid, bundle->retx + ch->retx_timeout, &bundle->timer);
+        if (status != BP_SUCCESS)
         {
-            ch->active_table.remove(ch->active_table.table, active_bundle.cid, NULL);
-            ch->store.relinquish(handle, active_bundle.sid);
-            ch->stats.lost++;
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Unexpected error (%d) starting retransmit timer, CID=%lu\n", status,
+                  (unsigned long)bundle->cid);
         }
     }
-    bplib_os_unlock(ch->active_table_signal);
-
-    /* Return Success */
-    return BP_SUCCESS;
 }
 
 /*--------------------------------------------------------------------------------------
- * bplib_config -
+ * stop_retx_timer - stops the retransmit timer of a bundle removed from the active table
  *-------------------------------------------------------------------------------------*/
-int bplib_config(bp_desc_t *desc, int mode, int opt, int *val)
+BP_LOCAL_SCOPE void stop_retx_timer(bp_channel_t *ch, bp_active_bundle_t *bundle)
 {
-    /* Check Parameters */
-    if (desc == NULL)
-    {
-        return BP_ERROR;
-    }
-    else if (val == NULL)
+    if (ch->retx_timers[bundle->cos] && bundle->timer != TWHEEL_NULL_TIMER)
     {
-        return BP_ERROR;
+        twheel_stop(ch->retx_timers[bundle->cos], bundle->timer);
+        bundle->timer = TWHEEL_NULL_TIMER;
     }
+}
 
-    /* Get Channel */
-    bp_channel_t *ch = &desc->channel;
-
-    /* Set Mode */
-    bool setopt = mode == BP_OPT_MODE_WRITE ? true : false;
+/*--------------------------------------------------------------------------------------
+ * retransmit_bundle - retrieves the earliest timed-out bundle of a queue (active table lock must be held)
+ *
+ *  The bundle is removed from the active table into active_bundle and is reinserted when it is
+ *  loaded.  Timed-out bundles that cannot be retrieved or have expired are deleted along the way.
+ *  Returns NULL when no retransmittable bundle of the queue has timed out.
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bp_object_t *retransmit_bundle(bp_channel_t *ch, int q, unsigned long msnow, unsigned long sysnow,
+                                              bool unrelt, bp_active_bundle_t *active_bundle, uint32_t *flags)
+{
+    bp_object_t *object = NULL;
+    bp_val_t     cid    = 0;
 
-    /* Select and Process Option */
-    switch (opt)
+    /* Get Earliest Timed Out Bundle */
+    while (object == NULL && ch->retx_timers[q] && twheel_expired(ch->retx_timers[q], msnow, &cid) == BP_SUCCESS)
     {
-        case BP_OPT_LIFETIME:
+        /* Remove Timed Out Bundle from Active Table (it will be reinserted if retransmitted) */
+        if (ch->active_table.remove(ch->active_table.table, cid, active_bundle) != BP_SUCCESS)
         {
-            if (setopt)
+            continue; /* bundle already acknowledged */
+        }
+
+        /* Timer Freed when Expired */
+        active_bundle->timer = TWHEEL_NULL_TIMER;
+
+        /* Retrieve Timed Out Bundle from Storage */
+        unsigned long ret_start  = latency_start();
+        int           ret_status = store_retrieve(ch, ch->bundle_handles[q], active_bundle->sid, &object, BP_CHECK);
+        latency_stop(&ch->stats.retrieve, ret_start);
+        if (ret_status == BP_SUCCESS)
+        {
+            bp_bundle_data_t *data = (bp_bundle_data_t *)object->data;
+
+            /* Check Lifetime of Bundle */
+            if (ch->proto->is_expired(&ch->bundle, sysnow, data->exprtime, unrelt))
             {
-                ch->bundle.attributes.lifetime = *val;
-            }
-            else
-            {
-                *val = ch->bundle.attributes.lifetime;
+                /* Bundle Expired (bundle deleted below) */
+                bptrace2(expire, ch, active_bundle->sid);
+                object = NULL;
+                stats_add(&ch->stats.expired, 1);
             }
-            break;
         }
-        case BP_OPT_REQUEST_CUSTODY:
+        else
         {
-            if (setopt && *val != true && *val != false)
-            {
-                return BP_ERROR;
-            }
-            if (setopt)
-            {
-                ch->bundle.attributes.request_custody = *val;
-            }
-            else
-            {
-                *val = ch->bundle.attributes.request_custody;
-            }
-            break;
+            /* Failed to Retrieve Bundle from Storage */
+            bplog(flags, BP_FLAG_STORE_FAILURE, "Failed to retrieve timed-out bundle\n");
+            object = NULL;
+            stats_add(&ch->stats.lost, 1);
         }
-        case BP_OPT_ADMIN_RECORD:
+
+        /* Clear Entry in Storage
+         *  - when the retrieval of the bundle failed above OR
+         *  - when the retrieved bundle has expired */
+        if (object == NULL)
         {
-            if (setopt && *val != true && *val != false)
+            ch->store.release(ch->bundle_handles[q], active_bundle->sid);
+            ch->store.relinquish(ch->bundle_handles[q], active_bundle->sid);
+        }
+    }
+
+    return object;
+}
+
+/*--------------------------------------------------------------------------------------
+ * resize_active_table - changes the number of bundles tracked by the active table (active table lock must be held)
+ *
+ *  Whichever of the table and the retransmit timers can fail to resize is resized first:
+ *  the timers when growing (allocation) and the table when shrinking (bundles that do not
+ *  fit); the timers always shrink back if the table then fails to grow.
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int resize_active_table(bp_channel_t *ch, int size)
+{
+    int            old_size = ch->bundle.attributes.active_table_size;
+    int            status   = BP_SUCCESS;
+    bp_memstats_t *prev     = bplib_os_memaccount(&ch->memory);
+    int            q;
+
+    /* Shrink Table */
+    if (size < old_size)
+    {
+        status = ch->active_table.resize(ch->active_table.table, size);
+    }
+
+    /* Resize Retransmit Timers */
+    for (q = 0; status == BP_SUCCESS && q < BP_NUM_COS_QUEUES; q++)
+    {
+        if (ch->retx_timers[q])
+        {
+            status = twheel_resize(ch->retx_timers[q], size);
+        }
+    }
+
+    /* Grow Table */
+    if (status == BP_SUCCESS && size > old_size)
+    {
+        status = ch->active_table.resize(ch->active_table.table, size);
+    }
+
+    bplib_os_memaccount(prev);
+
+    /* Check Resize */
+    if (status != BP_SUCCESS)
+    {
+        for (q = 0; q < BP_NUM_COS_QUEUES; q++)
+        {
+            if (ch->retx_timers[q])
             {
-                return BP_ERROR;
+                twheel_resize(ch->retx_timers[q], old_size);
             }
-            if (setopt)
+        }
+        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Unable to resize active table from %d to %d with %d bundles active\n",
+              old_size, size, ch->active_table.count(ch->active_table.table));
+        return BP_ERROR;
+    }
+
+    /* Wake Loads Waiting for Room */
+    ch->bundle.attributes.active_table_size = size;
+    ch->load_events++;
+    bplib_os_broadcast(ch->active_table_signal);
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * relinquish_acknowledged - relinquishes the bundles removed by delete_bundles (active table lock must be held)
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void relinquish_acknowledged(bp_channel_t *ch, uint32_t *flags)
+{
+    if (ch->relinquish_count > 0)
+    {
+        int status = store_relinquish_batch(ch, ch->relinquish_handle, ch->relinquish_sids, ch->relinquish_count);
+        if (status != BP_SUCCESS)
+        {
+            bplog(flags, BP_FLAG_STORE_FAILURE, "Failed (%d) to relinquish bundle\n", status);
+        }
+        ch->relinquish_count = 0;
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * acknowledged_bundle - called for each bundle removed from the active table by delete_bundles
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void acknowledged_bundle(void *parm, bp_active_bundle_t *bundle)
+{
+    bp_ack_parm_t *ack = (bp_ack_parm_t *)parm;
+    bp_channel_t  *ch  = ack->ch;
+
+    bptrace3(relinquish, ch, bundle->cid, bundle->sid);
+    stop_retx_timer(ch, bundle);
+#if BPLIB_LATENCY_STATS
+    latency_record(&ch->stats.load_to_ack, (ack->msnow - bundle->retx) * 1000);
+#endif
+
+    /* Batch Relinquishes by Queue */
+    bp_handle_t handle = ch->bundle_handles[bundle->cos];
+    if (ch->relinquish_count > 0 && !bp_handle_equal(handle, ch->relinquish_handle))
+    {
+        relinquish_acknowledged(ch, ack->flags);
+    }
+    ch->relinquish_handle = handle;
+
+    ch->relinquish_sids[ch->relinquish_count++] = bundle->sid;
+    if (ch->relinquish_count == BPLIB_MAX_RELINQUISH_BATCH)
+    {
+        relinquish_acknowledged(ch, ack->flags);
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * delete_bundles - removes a range of acknowledged bundles from the active table (active table lock must be held)
+ *
+ *  the storage IDs of removed bundles are collected and relinquished in batches
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int delete_bundles(void *parm, bp_val_t cid, bp_val_t count, int *num_deleted, uint32_t *flags)
+{
+    bp_channel_t *ch  = (bp_channel_t *)parm;
+    bp_ack_parm_t ack = {ch, flags, 0};
+
+#if BPLIB_LATENCY_STATS
+    bplib_os_monotime(&ack.msnow);
+#endif
+
+    *num_deleted = ch->active_table.remove_range(ch->active_table.table, cid, count, acknowledged_bundle, &ack);
+    if ((bp_val_t)*num_deleted != count)
+    {
+        return bplog(flags, BP_FLAG_UNKNOWN_CID, "Failed to remove %lu of %lu bundles from active table, CID=%lu\n",
+                     (unsigned long)(count - *num_deleted), (unsigned long)count, (unsigned long)cid);
+    }
+
+    /* Return Status */
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * dacs_bound - limits an adapted DACS period to BPLIB_DACS_ADAPT_RANGE times either side of the dacs rate
+ *
+ *  The longest period is also kept to half the retransmit timeout so that custody signals get back
+ *  before the custodian retransmits (the custodian's timeout is taken to be the same as the channel's).
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bp_val_t dacs_bound(bp_channel_t *ch, bp_val_t wait)
+{
+    bp_val_t min_wait = ch->dacs_period / BPLIB_DACS_ADAPT_RANGE;
+    bp_val_t max_wait = ch->dacs_period * BPLIB_DACS_ADAPT_RANGE;
+
+    if (ch->retx_timeout > 0 && max_wait > ch->retx_timeout / 2)
+    {
+        max_wait = ch->retx_timeout / 2;
+    }
+
+    if (min_wait == 0)
+    {
+        min_wait = 1;
+    }
+
+    if (max_wait < min_wait)
+    {
+        max_wait = min_wait;
+    }
+
+    if (wait < min_wait)
+    {
+        return min_wait;
+    }
+    else if (wait > max_wait)
+    {
+        return max_wait;
+    }
+    else
+    {
+        return wait;
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * dacs_period - milliseconds between DACS bundles sent to a source (zero when not periodic)
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bp_val_t dacs_period(bp_channel_t *ch, bp_custody_source_t *source)
+{
+    if (!ch->dacs_adaptive || ch->dacs_period == 0 || source->dacs_wait == 0)
+    {
+        return ch->dacs_period;
+    }
+
+    return dacs_bound(ch, source->dacs_wait);
+}
+
+/*--------------------------------------------------------------------------------------
+ * adapt_dacs - adapts the DACS period of a source to the custody taken since its last DACS
+ *
+ *  The period is halved when custody is taken at more than twice the average rate, or when enough
+ *  was taken to fill half the custodian's active table (estimated by the channel's own), and doubled
+ *  when the rate falls below half the average.  The first DACS sent to a source starts the period
+ *  at the dacs rate, and the second starts the average.
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void adapt_dacs(bp_channel_t *ch, bp_custody_source_t *source, unsigned long elapsed)
+{
+    unsigned long rate = (source->taken * 1000) / (elapsed > 0 ? elapsed : 1);
+    bp_val_t      wait = dacs_period(ch, source);
+
+    if (source->dacs_wait == 0)
+    {
+        wait = ch->dacs_period;
+    }
+    else if (source->rate == 0)
+    {
+        source->rate = rate;
+    }
+    else
+    {
+        if (source->taken >= ch->dacs_urgent || rate > (2 * source->rate))
+        {
+            wait /= 2;
+        }
+        else if (rate < (source->rate / 2))
+        {
+            wait *= 2;
+        }
+
+        source->rate = ((3 * source->rate) + rate) / 4;
+    }
+
+    source->dacs_wait = dacs_bound(ch, wait);
+    source->taken     = 0;
+}
+
+/*--------------------------------------------------------------------------------------
+ * create_dacs
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int create_dacs(bp_channel_t *ch, bp_custody_source_t *source, unsigned long msnow, int timeout,
+                               uint32_t *flags)
+{
+    int           ret_status = BP_SUCCESS;
+    int           max_fills  = ch->dacs.attributes.max_fills_per_dacs;
+    int           fills_size = ch->dacs_size;
+    unsigned long elapsed    = msnow - (unsigned long)source->dacs_last_sent;
+
+    /* Address DACS Bundle to Source - the bundle is shared by all sources */
+    if (ch->dacs.route.destination_node != source->node || ch->dacs.route.destination_service != source->service)
+    {
+        ch->dacs.route.destination_node    = source->node;
+        ch->dacs.route.destination_service = source->service;
+        ch->dacs.prebuilt                  = false;
+    }
+
+    /* Fit Adaptive DACS to Max Length - the header is built first for the room it leaves */
+    if (ch->dacs_adaptive && (ch->dacs.prebuilt || ch->proto->populate_bundle(&ch->dacs, flags) == BP_SUCCESS))
+    {
+        int room = ch->dacs.attributes.max_length - ch->proto->header_size(&ch->dacs);
+        if (room > 0)
+        {
+            max_fills  = INT_MAX;
+            fills_size = room < ch->dacs_size ? room : ch->dacs_size;
+        }
+    }
+
+    /* If the custody_tree has nodes, initialize the iterator for traversing the custody_tree in order */
+    source->custody.goto_first(source->custody.tree);
+
+    /* Continue to delete nodes from the custody_tree and write them to DACS until the custody_tree is empty */
+    while (!source->custody.is_empty(source->custody.tree))
+    {
+        /* Build Acknowledgment - will remove nodes from the custody_tree */
+        int size =
+            ch->proto->populate_acknowledgment(ch->dacs_buffer, fills_size, max_fills, &source->custody, flags);
+        if (size > 0)
+        {
+            int status = BP_SUCCESS;
+
+            /* Check if Re-initialization Needed */
+            if (ch->dacs.prebuilt == false)
             {
-                ch->bundle.attributes.admin_record = *val;
+                status = ch->proto->populate_bundle(&ch->dacs, flags);
             }
-            else
+
+            /* Send Bundle */
+            if (status == BP_SUCCESS)
             {
-                *val = ch->bundle.attributes.admin_record;
+                status = ch->proto->send_bundle(&ch->dacs, ch->dacs_buffer, size, create_bundle, ch, timeout, flags);
+                if (status == BP_SUCCESS)
+                {
+                    /* DACS successfully enqueued */
+                    bptrace4(dacs_create, ch, source->node, source->service, size);
+                    source->dacs_last_sent = msnow;
+                }
+                else if (ret_status == BP_SUCCESS)
+                {
+                    /* Save first failed DACS enqueue to return later */
+                    bplog(flags, BP_FLAG_STORE_FAILURE, "Failed (%d) to send DACS bundle\n", status);
+                    ret_status = status;
+                    stats_add(&ch->stats.lost, 1);
+                }
             }
-            break;
         }
-        case BP_OPT_INTEGRITY_CHECK:
+    }
+
+    /* Adapt Period to Custody Taken */
+    if (ch->dacs_adaptive)
+    {
+        adapt_dacs(ch, source, elapsed);
+    }
+
+    /* Return Status */
+    return ret_status;
+}
+
+/*--------------------------------------------------------------------------------------
+ * idle_dacs - lengthens the adapted DACS period of a source that had nothing to acknowledge for a period
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void idle_dacs(bp_channel_t *ch, bp_custody_source_t *source, unsigned long msnow)
+{
+    if (source->dacs_wait != 0)
+    {
+        source->dacs_wait = dacs_bound(ch, dacs_period(ch, source) * 2);
+    }
+
+    source->dacs_last_sent = msnow;
+}
+
+/*--------------------------------------------------------------------------------------
+ * check_dacs - sends the aggregated custody signals if the dacs rate period has elapsed
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void check_dacs(bp_channel_t *ch, unsigned long msnow, uint32_t *flags)
+{
+    if (ch->dacs_period > 0)
+    {
+        /* Check If DACS Ready to Send - each source has its own period */
+        bplib_os_mutex_lock(&ch->custody_tree_lock);
         {
-            if (setopt && *val != true && *val != false)
-            {
-                return BP_ERROR;
-            }
-            if (setopt)
+            int i;
+            for (i = 0; i < ch->num_custody_sources; i++)
             {
-                ch->bundle.attributes.integrity_check = *val;
+                bp_custody_source_t *source = &ch->custody_sources[i];
+                if (msnow < (source->dacs_last_sent + dacs_period(ch, source)))
+                {
+                    continue;
+                }
+                else if (!source->custody.is_empty(source->custody.tree))
+                {
+                    create_dacs(ch, source, msnow, BP_CHECK, flags);
+                }
+                else if (ch->dacs_adaptive)
+                {
+                    idle_dacs(ch, source, msnow);
+                }
             }
-            else
+        }
+        bplib_os_mutex_unlock(&ch->custody_tree_lock);
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * received_before - checks if a payload for the local node was already received, otherwise
+ *  remembers it so that a copy processed at the same time on another thread is dropped
+ *
+ *  the check and the insert are one critical section; forget_payload backs the insert
+ *  out when the payload ends up not being stored
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bool received_before(bp_channel_t *ch, bp_payload_t *payload)
+{
+    dedup_key_t key = {payload->adu, payload->fragoffset};
+    bool        found;
+
+    bplib_os_mutex_lock(&ch->dedup_lock);
+    {
+        found = (dedup_insert(ch->dedup, &key) == BP_DUPLICATE);
+    }
+    bplib_os_mutex_unlock(&ch->dedup_lock);
+
+    return found;
+}
+
+/*--------------------------------------------------------------------------------------
+ * forget_payload - stops dropping copies of a payload that received_before remembered but was not stored
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void forget_payload(bp_channel_t *ch, bp_payload_t *payload)
+{
+    dedup_key_t key = {payload->adu, payload->fragoffset};
+
+    bplib_os_mutex_lock(&ch->dedup_lock);
+    {
+        dedup_remove(ch->dedup, &key);
+    }
+    bplib_os_mutex_unlock(&ch->dedup_lock);
+}
+
+/*--------------------------------------------------------------------------------------
+ * store_payload_result - accounts for the outcome of storing a received payload
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void store_payload_result(bp_channel_t *ch, bp_payload_t *payload, int status,
+                                         bool *custody_transfer, uint32_t *flags)
+{
+    if (status != BP_SUCCESS && ch->dedup)
+    {
+        forget_payload(ch, payload);
+    }
+
+    if (status == BP_SUCCESS && payload->node != BP_IPN_NULL)
+    {
+        *custody_transfer = true;
+    }
+    else if (status != BP_SUCCESS)
+    {
+        bplog(flags, BP_FLAG_STORE_FAILURE, "Failed (%d) to store payload\n", status);
+        stats_add(&ch->stats.lost, 1);
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * verify_payload - compares the crc of a received payload with the one its bundle carried
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int verify_payload(bp_payload_t *payload, bp_crcval_t crc, uint32_t *flags)
+{
+    if (crc != payload->crc)
+    {
+        return bplog(flags, BP_FLAG_FAILED_INTEGRITY_CHECK, "Failed %s integrity check, exp=%08lX, act=%08lX\n",
+                     bplib_crc_get_name(payload->crc_params), (unsigned long)payload->crc, (unsigned long)crc);
+    }
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * enqueue_payload - stores a received payload, checking its integrity as it is copied
+ *
+ *  With a zero-copy storage service the crc is computed while the payload is copied
+ *  into the allocated object, so the payload is only read once; otherwise it is checked
+ *  and then enqueued.  intact is cleared when the payload fails its integrity check
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int enqueue_payload(bp_channel_t *ch, bp_payload_t *payload, int timeout, bool *intact,
+                                   uint32_t *flags)
+{
+    bplib_crc_parameters_t *params = payload->crc_params;
+    size_t                  hdrsz  = sizeof(bp_payload_data_t);
+    size_t                  size   = payload->data.payloadsize;
+    bp_object_t            *object = NULL;
+    int                     status;
+
+    *intact = true;
+
+    /* Allocate Object to Copy Payload Into */
+    if (params != NULL && ch->store.allocate != NULL && ch->store.post != NULL && ch->store.discard != NULL)
+    {
+        object = store_allocate(ch, ch->payload_handle, hdrsz + size);
+    }
+
+    /* Copy and Check Payload in One Pass */
+    if (object != NULL)
+    {
+        memcpy(object->data, &payload->data, hdrsz);
+        bp_crcval_t crc = bplib_crc_copy(params, bplib_crc_initial_value(params), &object->data[hdrsz],
+                                         payload->memptr, size);
+        status          = verify_payload(payload, bplib_crc_finalize(params, crc), flags);
+        if (status != BP_SUCCESS)
+        {
+            *intact = false;
+        }
+        else
+        {
+            /* Post Object - ownership passes to storage service */
+            status = ch->store.post(object->header.handle, object, timeout);
+        }
+
+        if (status != BP_SUCCESS)
+        {
+            ch->store.discard(object->header.handle, object);
+        }
+
+        return status;
+    }
+
+    /* Check Payload then Enqueue It */
+    if (params != NULL)
+    {
+        status = verify_payload(payload, bplib_crc_get(payload->memptr, size, params), flags);
+        if (status != BP_SUCCESS)
+        {
+            *intact = false;
+            return status;
+        }
+    }
+
+    return store_enqueue(ch, ch->payload_handle, &payload->data, hdrsz, payload->memptr, size, timeout);
+}
+
+/*--------------------------------------------------------------------------------------
+ * decompress_payload - replaces a dequeued compressed payload with a decompressed copy
+ *
+ *  The copy carries the header of the stored object so that bplib_ackpayload can
+ *  relinquish it; the stored object is released here.  Returns NULL on failure,
+ *  in which case the stored object is relinquished.
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bp_object_t *decompress_payload(bp_channel_t *ch, bp_object_t *object, uint32_t *flags)
+{
+    bp_payload_data_t     *data       = (bp_payload_data_t *)object->data;
+    const bp_compressor_t *compressor = ch->bundle.attributes.payload_compressor;
+    bp_object_t           *copy       = NULL;
+
+    /* Allocate Copy */
+    if (compressor && compressor->id == data->compressor && data->rawsize > 0)
+    {
+        bp_memstats_t *prev = bplib_os_memaccount(&ch->memory);
+        copy = (bp_object_t *)bplib_os_calloc_tag(sizeof(bp_object_t) + sizeof(bp_payload_data_t) + data->rawsize,
+                                                  BP_MEM_CHANNEL);
+        bplib_os_memaccount(prev);
+    }
+
+    /* Decompress Payload */
+    if (copy)
+    {
+        bp_payload_data_t *copy_data = (bp_payload_data_t *)copy->data;
+        copy->header                 = object->header;
+        *copy_data                   = *data;
+
+        int rawsize = compressor->decompress((uint8_t *)data + sizeof(bp_payload_data_t), data->payloadsize,
+                                             (uint8_t *)copy_data + sizeof(bp_payload_data_t), data->rawsize);
+        if (rawsize == data->rawsize)
+        {
+            copy_data->payloadsize  = rawsize;
+            copy_data->decompressed = true;
+            ch->store.release(object->header.handle, object->header.sid);
+            return copy;
+        }
+
+        bplib_os_free(copy);
+    }
+
+    /* Drop Stored Payload */
+    bplog(flags, BP_FLAG_FAILED_TO_PARSE, "Failed to decompress payload with compressor %d\n", data->compressor);
+    ch->store.release(object->header.handle, object->header.sid);
+    ch->store.relinquish(object->header.handle, object->header.sid);
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------
+ * reassembly_expired - checks if the bundles of a partially reassembled ADU have expired
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bool reassembly_expired(void *parm, bp_val_t exprtime)
+{
+    bp_reasm_parm_t *reasm_parm = (bp_reasm_parm_t *)parm;
+    bp_channel_t    *ch         = reasm_parm->ch;
+
+    return ch->proto->is_expired(&ch->bundle, reasm_parm->sysnow, exprtime, reasm_parm->unrelt) != 0;
+}
+
+/*--------------------------------------------------------------------------------------
+ * reassemble_fragment - writes a received fragment into the reassembly buffer of its ADU
+ *
+ *  Returns BP_SUCCESS when the fragment was taken, storing the ADU when it is complete,
+ *  and BP_PENDING_ACCEPTANCE when the fragment cannot be reassembled and is stored as
+ *  it is.  The fragment is checked before it is taken, clearing intact when it fails.
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int reassemble_fragment(bp_channel_t *ch, bp_payload_t *payload, int timeout, bool *intact,
+                                       uint32_t *flags)
+{
+    int slot;
+    int status;
+
+    /* Check Fragment */
+    if (payload->crc_params != NULL)
+    {
+        status = verify_payload(
+            payload, bplib_crc_get(payload->memptr, payload->data.payloadsize, payload->crc_params), flags);
+        if (status != BP_SUCCESS)
+        {
+            *intact = false;
+            return status;
+        }
+        payload->crc_params = NULL;
+    }
+
+    /* Get Current Time */
+    bp_reasm_parm_t reasm_parm = {.ch = ch, .sysnow = 0, .unrelt = false};
+    if (bplib_os_systime(&reasm_parm.sysnow) == BP_ERROR)
+    {
+        reasm_parm.unrelt = true; /* time is unreliable */
+    }
+
+    /* Drop Expired ADUs and Write Fragment into Place */
+    bplib_os_mutex_lock(&ch->reasm_lock);
+    {
+        stats_add(&ch->stats.expired, reasm_expire(ch->reasm, reassembly_expired, &reasm_parm));
+        status = reasm_insert(ch->reasm, &payload->adu, payload->data.exprtime, payload->adulen,
+                              payload->fragoffset, payload->memptr, payload->data.payloadsize, &slot);
+    }
+    bplib_os_mutex_unlock(&ch->reasm_lock);
+
+    /* Store Fragment as it is when it Cannot be Reassembled */
+    if (status == BP_FULL || status == BP_ERROR)
+    {
+        bplog(flags, BP_FLAG_DIAGNOSTIC, "Unable (%d) to reassemble fragment at offset %lu of %lu byte ADU\n",
+              status, (unsigned long)payload->fragoffset, (unsigned long)payload->adulen);
+        return BP_PENDING_ACCEPTANCE;
+    }
+
+    /* Store Complete ADU (a complete slot is not reused until released, so the lock is not needed) */
+    if (status == BP_PENDING_ACCEPTANCE)
+    {
+        bp_payload_t adu   = *payload;
+        int          size  = 0;
+        bool         whole = true;
+
+        reasm_get(ch->reasm, slot, &adu.memptr, &size);
+        adu.data.payloadsize = size;
+        adu.fragoffset       = 0;
+        adu.adulen           = 0;
+
+        unsigned long start = latency_start();
+        status              = enqueue_payload(ch, &adu, timeout, &whole, flags);
+        latency_stop(&ch->stats.enqueue, start);
+        if (status == BP_SUCCESS)
+        {
+            stats_add(&ch->stats.reassembled_payloads, 1);
+            bplib_os_setevent(ch->ready_event);
+        }
+
+        bplib_os_mutex_lock(&ch->reasm_lock);
+        {
+            reasm_release(ch->reasm, slot);
+        }
+        bplib_os_mutex_unlock(&ch->reasm_lock);
+    }
+
+    return status;
+}
+
+/*--------------------------------------------------------------------------------------
+ * receive_bundle - decodes a received bundle and stores or forwards it
+ *
+ *  DACS bundles are returned as BP_PENDING_ACKNOWLEDGMENT for the caller to apply
+ *  under the active table lock; custody_transfer is set when custody must be taken.
+ *  When defer is set, payloads for the local node are not stored but returned as
+ *  BP_PENDING_ACCEPTANCE for the caller to enqueue and pass to store_payload_result.
+ *  Decoding, integrity checks, and storing payloads run on the calling thread without
+ *  a channel lock, so several threads can process bundles of one channel in parallel;
+ *  only forwarding, which builds the header in the channel's bundle, is serialized
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int receive_bundle(bp_channel_t *ch, const void *bundle, size_t size, int timeout, bool defer,
+                                  bp_payload_t *payload, bool *custody_transfer, uint32_t *flags)
+{
+    int status = ch->proto->receive_bundle(&ch->bundle, bundle, size, payload, flags);
+    if (status == BP_PENDING_EXPIRATION) /* received bundle is expired */
+    {
+        bptrace2(expire, ch, BP_SID_VACANT);
+        stats_add(&ch->stats.expired, 1);
+    }
+    else if (status == BP_PENDING_ACKNOWLEDGMENT) /* received bundle is a DACS */
+    {
+        /* Increment Statistics */
+        stats_add(&ch->stats.received_dacs, 1);
+    }
+    else if (status == BP_PENDING_ACCEPTANCE) /* received bundle is a payload for local node.service */
+    {
+        bool intact = true;
+
+        /* Drop Payload Already Stored or Being Stored by Another Thread - custody is acknowledged again */
+        if (ch->dedup && received_before(ch, payload))
+        {
+            bptrace3(duplicate, ch, payload->adu.node, payload->adu.createseq);
+            stats_add(&ch->stats.duplicate_bundles, 1);
+            if (payload->node != BP_IPN_NULL)
+            {
+                *custody_transfer = true;
+            }
+            return BP_SUCCESS;
+        }
+
+        /* Reassemble Fragmented ADU */
+        if (ch->reasm && payload->adulen != 0)
+        {
+            status = reassemble_fragment(ch, payload, timeout, &intact, flags);
+        }
+
+        if (status != BP_PENDING_ACCEPTANCE)
+        {
+            /* Fragment Taken into Reassembly Buffer */
+            if (intact)
+            {
+                stats_add(&ch->stats.received_bundles, 1);
+                store_payload_result(ch, payload, status, custody_transfer, flags);
+            }
+            else
+            {
+                stats_add(&ch->stats.unrecognized, 1);
+                if (ch->dedup)
+                {
+                    forget_payload(ch, payload);
+                }
+            }
+
+            return status;
+        }
+        else if (defer)
+        {
+            /* Check Payload for the Caller to Store */
+            if (payload->crc_params != NULL &&
+                verify_payload(payload,
+                               bplib_crc_get(payload->memptr, payload->data.payloadsize, payload->crc_params),
+                               flags) != BP_SUCCESS)
+            {
+                intact = false;
+                status = BP_ERROR;
+            }
+        }
+        else
+        {
+            /* Store Payload */
+            unsigned long start = latency_start();
+            status              = enqueue_payload(ch, payload, timeout, &intact, flags);
+            latency_stop(&ch->stats.enqueue, start);
+            if (status == BP_SUCCESS)
+            {
+                bplib_os_setevent(ch->ready_event);
+            }
+        }
+
+        /* Increment Statistics */
+        if (!intact)
+        {
+            stats_add(&ch->stats.unrecognized, 1);
+            if (ch->dedup)
+            {
+                forget_payload(ch, payload);
+            }
+        }
+        else
+        {
+            stats_add(&ch->stats.received_bundles, 1);
+            if (!defer)
+            {
+                store_payload_result(ch, payload, status, custody_transfer, flags);
+            }
+        }
+    }
+    else if (status == BP_PENDING_FORWARD) /* received bundle is for another node */
+    {
+        /* Increment Statistics */
+        stats_add(&ch->stats.forwarded_bundles, 1);
+
+        /* Build and Store Forwarded Bundle */
+        bplib_os_mutex_lock(&ch->forward_lock);
+        {
+            status = ch->proto->forward_bundle(&ch->bundle, bundle, size, flags);
+            if (status == BP_SUCCESS)
+            {
+                status = ch->proto->send_bundle(&ch->bundle, payload->memptr, payload->data.payloadsize,
+                                                create_bundle, ch, timeout, flags);
+            }
+        }
+        bplib_os_mutex_unlock(&ch->forward_lock);
+        if (status == BP_SUCCESS && payload->node != BP_IPN_NULL)
+        {
+            *custody_transfer = true;
+        }
+        else if (status != BP_SUCCESS)
+        {
+            stats_add(&ch->stats.lost, 1);
+        }
+    }
+    else
+    {
+        /* Increment Statistics */
+        stats_add(&ch->stats.unrecognized, 1);
+    }
+
+    /* Return Status */
+    return status;
+}
+
+/*--------------------------------------------------------------------------------------
+ * receive_acknowledgment - applies a received DACS (active table lock must be held)
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int receive_acknowledgment(bp_channel_t *ch, bp_payload_t *payload, int *num_acks, uint32_t *flags)
+{
+    int bytes_read = ch->proto->receive_acknowledgment(payload->memptr, payload->data.payloadsize, num_acks,
+                                                       delete_bundles, ch, flags);
+    relinquish_acknowledged(ch, flags);
+    stats_add(&ch->stats.acknowledged_bundles, *num_acks);
+    bptrace2(dacs_receive, ch, *num_acks);
+
+    /* Return Status */
+    if (bytes_read > 0)
+    {
+        return BP_SUCCESS;
+    }
+    else
+    {
+        return bytes_read; /* Error Code */
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * custody_source - finds where custody of bundles from a custodian is aggregated (custody tree lock must be held)
+ *
+ *  Sources are matched on the custodian's node and service.  A custodian without a source is given
+ *  a source with nothing to acknowledge, or else the least recently taken source after its DACS is sent.
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bp_custody_source_t *custody_source(bp_channel_t *ch, bp_ipn_t node, bp_ipn_t service,
+                                                   unsigned long msnow, uint32_t *flags)
+{
+    bp_custody_source_t *idle   = NULL;
+    bp_custody_source_t *oldest = NULL;
+    int                  i;
+
+    for (i = 0; i < ch->num_custody_sources; i++)
+    {
+        bp_custody_source_t *source = &ch->custody_sources[i];
+        if (source->node == node && source->service == service)
+        {
+            source->last_taken = msnow;
+            return source;
+        }
+        else if (source->custody.is_empty(source->custody.tree))
+        {
+            if (idle == NULL)
+            {
+                idle = source;
+            }
+        }
+        else if (oldest == NULL || source->last_taken < oldest->last_taken)
+        {
+            oldest = source;
+        }
+    }
+
+    /* Store DACS Bundle of Reused Source */
+    if (idle == NULL)
+    {
+        create_dacs(ch, oldest, msnow, BP_CHECK, flags);
+        idle = oldest;
+    }
+
+    /* Initialize New Source */
+    idle->node       = node;
+    idle->service    = service;
+    idle->last_taken = msnow;
+    idle->taken      = 0;
+    idle->rate       = 0;
+    idle->dacs_wait  = 0;
+
+    return idle;
+}
+
+/*--------------------------------------------------------------------------------------
+ * take_custody - records custody of a received bundle (custody tree lock must be held)
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void take_custody(bp_channel_t *ch, bp_payload_t *payload, unsigned long msnow, uint32_t *flags)
+{
+    bp_custody_source_t *source = custody_source(ch, payload->node, payload->service, msnow, flags);
+
+    /* Insert Custody ID directly into custody_tree of source */
+    int insert_status = source->custody.insert(payload->cid, source->custody.tree);
+    if (insert_status == BP_FULL)
+    {
+        /* Flag Full Tree - possibly the custody_tree size is configured to be too small */
+        bplog(flags, BP_FLAG_CUSTODY_FULL, "Generating DACS because no more room to track custody\n");
+
+        /* Store Custody Signal */
+        create_dacs(ch, source, msnow, BP_CHECK, flags);
+
+        /* Start New DACS */
+        insert_status = source->custody.insert(payload->cid, source->custody.tree);
+
+        /* There is no valid reason for an insert to fail on an empty custody_tree */
+        assert(insert_status == BP_SUCCESS);
+    }
+    else if (insert_status == BP_DUPLICATE)
+    {
+        /* Duplicate values are fine and are treated as a success */
+        bplog(flags, BP_FLAG_DUPLICATES, "Same bundle received multiple times\n");
+    }
+    else if (insert_status != BP_SUCCESS)
+    {
+        /* Tree error unexpected */
+        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Unexpected error saving custody information: %d\n", insert_status);
+    }
+
+    /* Acknowledge at Once when the Custodian's Active Table could be Filling */
+    if (insert_status == BP_SUCCESS)
+    {
+        source->taken++;
+        if (ch->dacs_adaptive && source->taken >= ch->dacs_urgent)
+        {
+            create_dacs(ch, source, msnow, BP_CHECK, flags);
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * sweep_queue - relinquishes expired bundles at the head of a queue (sweep lock must be held)
+ *
+ *  Bundles are queued in about the order they expire, so the sweep stops at the first
+ *  unexpired bundle, which is kept as the head of the queue until it is loaded or expires.
+ *  Returns true when the sweep stopped at its limit with more left to check
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bool sweep_queue(bp_channel_t *ch, int queue, unsigned long sysnow, bool unrelt, uint32_t *flags)
+{
+    bp_handle_t handle = ch->bundle_handles[queue];
+    int         swept  = 0;
+
+    while (swept < BPLIB_MAX_SWEEP)
+    {
+        bp_object_t *object = ch->sweep_heads[queue];
+        if (object == NULL)
+        {
+            int status = store_dequeue(ch, handle, &object, BP_CHECK);
+            if (status == BP_TIMEOUT)
+            {
+                return false;
+            }
+            else if (status != BP_SUCCESS)
+            {
+                bplog(flags, BP_FLAG_STORE_FAILURE, "Failed (%d) to dequeue bundle to sweep\n", status);
+                return false;
+            }
+        }
+
+        /* Keep Unexpired Head */
+        bp_bundle_data_t *data = (bp_bundle_data_t *)object->data;
+        if (!ch->proto->is_expired(&ch->bundle, sysnow, data->exprtime, unrelt))
+        {
+            ch->sweep_heads[queue] = object;
+            return false;
+        }
+
+        /* Relinquish Expired Bundle */
+        bptrace2(expire, ch, object->header.sid);
+        ch->sweep_heads[queue] = NULL;
+        ch->store.release(handle, object->header.sid);
+        ch->store.relinquish(handle, object->header.sid);
+        stats_add(&ch->stats.expired, 1);
+        swept++;
+    }
+
+    return true;
+}
+
+/*--------------------------------------------------------------------------------------
+ * sweep_expired - relinquishes expired bundles at the heads of the bundle queues
+ *
+ *  Returns true when a queue has more left to sweep
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bool sweep_expired(bp_channel_t *ch, uint32_t *flags)
+{
+    unsigned long sysnow = 0;
+    bool          unrelt = false;
+    bool          more   = false;
+    int           q;
+
+    /* Get Current Time */
+    if (bplib_os_systime(&sysnow) == BP_ERROR)
+    {
+        unrelt = true; /* time is unreliable */
+    }
+
+    bplib_os_mutex_lock(&ch->sweep_lock);
+    {
+        for (q = 0; q < BP_NUM_COS_QUEUES; q++)
+        {
+            if (bp_handle_is_valid(ch->bundle_handles[q]) && sweep_queue(ch, q, sysnow, unrelt, flags))
+            {
+                more = true;
+            }
+        }
+    }
+    bplib_os_mutex_unlock(&ch->sweep_lock);
+
+    return more;
+}
+
+/*--------------------------------------------------------------------------------------
+ * drain_sweep_heads - lets go of the unexpired bundles held at the heads of the queues by a sweep
+ *
+ *  Each head was dequeued but never loaded.  It is released, and relinquished as well when
+ *  relinquish is set; otherwise a store that resumes after a reset sends it again.
+ *  Returns number of bundles relinquished
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int drain_sweep_heads(bp_channel_t *ch, bool relinquish)
+{
+    int drained = 0;
+    int q;
+
+    bplib_os_mutex_lock(&ch->sweep_lock);
+    {
+        for (q = 0; q < BP_NUM_COS_QUEUES; q++)
+        {
+            bp_object_t *object = ch->sweep_heads[q];
+            if (object != NULL)
+            {
+                bp_sid_t sid       = object->header.sid;
+                ch->sweep_heads[q] = NULL;
+                ch->store.release(ch->bundle_handles[q], sid);
+                if (relinquish)
+                {
+                    ch->store.relinquish(ch->bundle_handles[q], sid);
+                    drained++;
+                }
+            }
+        }
+    }
+    bplib_os_mutex_unlock(&ch->sweep_lock);
+
+    return drained;
+}
+
+/*--------------------------------------------------------------------------------------
+ * find_protocol - returns the engine of a protocol version, NULL if not built in
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE const bp_protocol_t *find_protocol(int version)
+{
+    unsigned int i;
+    for (i = 0; i < BP_NUM_PROTOCOLS; i++)
+    {
+        if (bplib_protocols[i]->version == version)
+        {
+            return bplib_protocols[i];
+        }
+    }
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------
+ * recognize_protocol - returns the engine of a received bundle, NULL if none recognizes it
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE const bp_protocol_t *recognize_protocol(const void *bundle, size_t size)
+{
+    unsigned int i;
+    for (i = 0; i < BP_NUM_PROTOCOLS; i++)
+    {
+        if (bplib_protocols[i]->recognize(bundle, (int)size))
+        {
+            return bplib_protocols[i];
+        }
+    }
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------
+ * find_route - returns the channel of the first rule holding a destination (route table lock must be held)
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bp_desc_t *find_route(bp_ipn_t node, bp_ipn_t service)
+{
+    int i;
+    for (i = 0; i < bplib_num_routes; i++)
+    {
+        bp_route_rule_t *rule = &bplib_route_table[i];
+        if (node >= rule->first_node && node <= rule->last_node && service >= rule->first_service &&
+            service <= rule->last_service)
+        {
+            return rule->desc;
+        }
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------
+ * stream_end - finishes the streamed payload of a channel
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void stream_end(bp_channel_t *ch, uint32_t *flags)
+{
+    ch->proto->end_adu(&ch->bundle, ch->stream_sent > 0, flags);
+    bplib_os_free(ch->stream_buffer);
+    ch->stream_buffer = NULL;
+    ch->stream_open   = false;
+}
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * bplib_init - initializes bp library
+ *-------------------------------------------------------------------------------------*/
+int bplib_init(void)
+{
+    int status;
+
+    /* Initialize OS Interface */
+    bplib_os_init();
+
+    /* Initialize CRC algorithms */
+    bplib_crc_init();
+
+    /* Initialize Protocol Engines */
+    unsigned int i;
+    for (i = 0; i < BP_NUM_PROTOCOLS; i++)
+    {
+        status = bplib_protocols[i]->initialize();
+        if (status != BP_SUCCESS)
+        {
+            return status;
+        }
+    }
+
+/* (Optional) Global Custody ID */
+#if BPLIB_GLOBAL_CUSTODY_ID
+#ifndef __GNUC__
+    bplib_custody_id_mutex = bplib_os_createlock();
+#endif
+    bplib_global_custody_id = 0;
+#endif
+
+    /* Open Channel List */
+    bplib_os_mutex_init(&bplib_channel_list_lock);
+    bplib_channel_list = NULL;
+
+    /* Routing Table */
+    bplib_os_mutex_init(&bplib_route_table_lock);
+    bplib_num_routes = 0;
+
+    /* Return Success */
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_deinit - deinitializes bp library
+ *-------------------------------------------------------------------------------------*/
+void bplib_deinit(void)
+{
+/* (Optional) Global Custody ID */
+#if BPLIB_GLOBAL_CUSTODY_ID && !defined(__GNUC__)
+    if (bp_handle_is_valid(bplib_custody_id_mutex))
+    {
+        bplib_os_destroylock(bplib_custody_id_mutex);
+        bplib_custody_id_mutex = BP_INVALID_HANDLE;
+    }
+#endif
+
+    /* Open Channel List */
+    bplib_os_mutex_destroy(&bplib_channel_list_lock);
+
+    /* Routing Table */
+    bplib_os_mutex_destroy(&bplib_route_table_lock);
+}
+
+/*--------------------------------------------------------------------------------------
+ * open_channel - opens a channel for bplib_open, which sets the memory account back
+ *
+ *  Memory allocated for the channel after its descriptor is charged to the channel
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bp_desc_t *open_channel(bp_route_t route, bp_store_t store, bp_attr_t attributes)
+{
+    assert(store.create);
+    assert(store.destroy);
+    assert(store.enqueue);
+    assert(store.dequeue);
+    assert(store.retrieve);
+    assert(store.release);
+    assert(store.relinquish);
+    assert(store.getcount);
+
+    int status = BP_SUCCESS;
+
+    /* Validate Attributes */
+    const bp_protocol_t *proto = find_protocol(attributes.protocol_version);
+    if (proto == NULL)
+    {
+        bplog(NULL, BP_FLAG_NONCOMPLIANT, "Unsupported bundle protocol version: %d\n", attributes.protocol_version);
+        return NULL;
+    }
+    else if (attributes.timeout > 0 && attributes.active_table_size <= 0)
+    {
+        bplog(NULL, BP_FLAG_API_ERROR, "Active table size must be greater than zero when a timeout is specified\n");
+        return NULL;
+    }
+    else if (attributes.timeout < 0)
+    {
+        bplog(NULL, BP_FLAG_API_ERROR, "Timeout cannot be negative\n");
+        return NULL;
+    }
+    else if (attributes.active_table_size < 0 || (unsigned long)attributes.active_table_size > BP_MAX_INDEX)
+    {
+        bplog(NULL, BP_FLAG_API_ERROR, "Active table size of %d cannot exceed %lu (see BP_INDEX_TYPE)\n",
+              attributes.active_table_size, (unsigned long)BP_MAX_INDEX);
+        return NULL;
+    }
+    else if (attributes.max_length < 0)
+    {
+        bplog(NULL, BP_FLAG_API_ERROR, "Max length cannot be negative\n");
+        return NULL;
+    }
+    else if (attributes.max_custody_sources <= 0)
+    {
+        bplog(NULL, BP_FLAG_API_ERROR, "Max custody sources must be greater than zero\n");
+        return NULL;
+    }
+    else if (attributes.cos_scheduling < BP_SCHEDULE_FIFO || attributes.cos_scheduling > BP_SCHEDULE_WEIGHTED)
+    {
+        bplog(NULL, BP_FLAG_API_ERROR, "Unrecognized class of service scheduling: %d\n", attributes.cos_scheduling);
+        return NULL;
+    }
+    else if (attributes.retx_share < 1 || attributes.retx_share > 100)
+    {
+        bplog(NULL, BP_FLAG_API_ERROR, "Retransmission share must be between 1 and 100 percent: %d\n",
+              attributes.retx_share);
+        return NULL;
+    }
+    else if (attributes.reassembly_slots < 0)
+    {
+        bplog(NULL, BP_FLAG_API_ERROR, "Reassembly slots cannot be negative\n");
+        return NULL;
+    }
+    else if (attributes.reassembly_slots > 0 && attributes.max_adu_length <= 0)
+    {
+        bplog(NULL, BP_FLAG_API_ERROR, "Max ADU length must be greater than zero when reassembling fragments\n");
+        return NULL;
+    }
+    else if (attributes.duplicate_window < 0)
+    {
+        bplog(NULL, BP_FLAG_API_ERROR, "Duplicate window cannot be negative\n");
+        return NULL;
+    }
+
+    /* Allocate Channel */
+    bp_desc_t *desc = (bp_desc_t *)bplib_os_calloc_tag(sizeof(bp_desc_t), BP_MEM_CHANNEL);
+    if (desc == NULL)
+    {
+        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Cannot open channel: not enough memory\n");
+        return NULL;
+    }
+
+    bp_channel_t *ch = &desc->channel;
+    bplib_os_memaccount(&ch->memory);
+
+    /* Clear Channel Memory and Initialize to Defaults */
+    ch->active_table_signal = BP_INVALID_HANDLE;
+    ch->payload_handle      = BP_INVALID_HANDLE;
+    ch->dacs_handle         = BP_INVALID_HANDLE;
+    ch->relinquish_handle   = BP_INVALID_HANDLE;
+    ch->ready_event         = BP_ERROR;
+    ch->cos_scheduling      = attributes.cos_scheduling;
+    bplib_os_mutex_init(&ch->custody_tree_lock);
+    bplib_os_mutex_init(&ch->reasm_lock);
+    bplib_os_mutex_init(&ch->dedup_lock);
+    bplib_os_mutex_init(&ch->sweep_lock);
+    bplib_os_mutex_init(&ch->forward_lock);
+
+    int q;
+    for (q = 0; q < BP_NUM_COS_QUEUES; q++)
+    {
+        ch->bundle_handles[q] = BP_INVALID_HANDLE;
+    }
+
+    /* Set Store and Protocol Engine */
+    ch->store = store;
+    ch->proto = proto;
+
+    /* Initialize Bundle Stores (a queue per class of service when scheduled) */
+    for (q = 0; q < BP_NUM_COS_QUEUES; q++)
+    {
+        if (bundle_queue(ch, q) != q)
+        {
+            continue; /* not scheduled */
+        }
+
+        ch->bundle_handles[q] = ch->store.create(bundle_queue_types[q], route.local_node, route.local_service,
+                                                 attributes.persistent_storage, attributes.storage_service_parm);
+        if (!bp_handle_is_valid(ch->bundle_handles[q]))
+        {
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to create storage handle for bundles\n");
+            bplib_close(desc);
+            return NULL;
+        }
+    }
+
+    /* Initialize Payload Store */
+    ch->payload_handle = ch->store.create(BP_STORE_PAYLOAD_TYPE, route.local_node, route.local_service,
+                                          attributes.persistent_storage, attributes.storage_service_parm);
+    if (!bp_handle_is_valid(ch->payload_handle))
+    {
+        bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to create storage handle for payloads\n");
+        bplib_close(desc);
+        return NULL;
+    }
+
+    /* Initialize DACS Store */
+    ch->dacs_handle = ch->store.create(BP_STORE_DACS_TYPE, route.local_node, route.local_service,
+                                       attributes.persistent_storage, attributes.storage_service_parm);
+    if (!bp_handle_is_valid(ch->dacs_handle))
+    {
+        bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to create storage handle for dacs\n");
+        bplib_close(desc);
+        return NULL;
+    }
+
+    /* Initialize Bundle */
+    status = ch->proto->create(&ch->bundle, route, attributes, 1);
+    if (status != BP_SUCCESS)
+    {
+        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to initialize bundle\n", status);
+        bplib_close(desc);
+        return NULL;
+    }
+
+    /* Build DACS Attributes */
+    bp_attr_t dacs_attributes          = attributes;
+    dacs_attributes.request_custody    = false;
+    dacs_attributes.admin_record       = true;
+    dacs_attributes.payload_compressor = NULL;
+
+    /* Build DACS Route */
+    bp_route_t custody_route          = route;
+    custody_route.destination_node    = BP_IPN_NULL;
+    custody_route.destination_service = BP_IPN_NULL;
+
+    /* Initialize DACS (custody signals are only sent on the storage service data path) */
+    if (ch->proto->store == NULL)
+    {
+        status = ch->proto->create(&ch->dacs, custody_route, dacs_attributes, attributes.max_custody_sources);
+    }
+    if (status != BP_SUCCESS)
+    {
+        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to initialize dacs\n");
+        bplib_close(desc);
+        return NULL;
+    }
+
+    /* Allocate Memory for Channel DACS Bundle Fills (adaptive DACS fill up to the max length) */
+    ch->dacs_size =
+        sizeof(bp_val_t) * attributes.max_fills_per_dacs + 6; /* 2 bytes per fill plus payload block header */
+    if (attributes.adaptive_dacs && ch->dacs_size < attributes.max_length)
+    {
+        ch->dacs_size = attributes.max_length;
+    }
+    ch->dacs_buffer = (uint8_t *)bplib_os_calloc_tag(ch->dacs_size, BP_MEM_DACS);
+    if (ch->dacs_buffer == NULL)
+    {
+        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to allocate memory for channel DACS\n");
+        bplib_close(desc);
+        return NULL;
+    }
+
+    /* Allocate Memory for Compressed Payloads */
+    if (attributes.payload_compressor)
+    {
+        if (attributes.payload_compressor->compress == NULL || attributes.payload_compressor->decompress == NULL)
+        {
+            bplog(NULL, BP_FLAG_API_ERROR, "Payload compressor must provide compress and decompress functions\n");
+            bplib_close(desc);
+            return NULL;
+        }
+
+        ch->compress_buffer = (uint8_t *)bplib_os_calloc_tag(attributes.max_length, BP_MEM_CHANNEL);
+        if (ch->compress_buffer == NULL)
+        {
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to allocate memory for channel payload compression\n");
+            bplib_close(desc);
+            return NULL;
+        }
+    }
+
+    /* Allocate Fragment Reassembly Buffer */
+    if (attributes.reassembly_slots > 0)
+    {
+        status = reasm_create(&ch->reasm, attributes.reassembly_slots, attributes.max_adu_length,
+                              BPLIB_REASM_MAX_RANGES);
+        if (status != BP_SUCCESS)
+        {
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to allocate memory for channel fragment reassembly\n");
+            bplib_close(desc);
+            return NULL;
+        }
+    }
+
+    /* Allocate Duplicate Detection Index */
+    if (attributes.duplicate_window > 0)
+    {
+        status = dedup_create(&ch->dedup, attributes.duplicate_window);
+        if (status != BP_SUCCESS)
+        {
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to allocate memory for channel duplicate detection\n");
+            bplib_close(desc);
+            return NULL;
+        }
+    }
+
+    /* Initialize Custody Functions */
+    bp_custody_t custody = {0};
+    if (attributes.custody_aggregation == BP_CUSTODY_RANGES)
+    {
+        custody.create     = custody_tree_create;
+        custody.destroy    = custody_tree_destroy;
+        custody.insert     = (bp_custody_insert_t)rb_tree_insert;
+        custody.is_empty   = (bp_custody_is_empty_t)rb_tree_is_empty;
+        custody.goto_first = (bp_custody_goto_first_t)rb_tree_goto_first;
+        custody.get_next   = (bp_custody_get_next_t)rb_tree_get_next;
+    }
+    else if (attributes.custody_aggregation == BP_CUSTODY_BITMAP)
+    {
+        custody.create     = (bp_custody_create_t)cbitmap_create;
+        custody.destroy    = (bp_custody_destroy_t)cbitmap_destroy;
+        custody.insert     = (bp_custody_insert_t)cbitmap_insert;
+        custody.is_empty   = (bp_custody_is_empty_t)cbitmap_is_empty;
+        custody.goto_first = (bp_custody_goto_first_t)cbitmap_goto_first;
+        custody.get_next   = (bp_custody_get_next_t)cbitmap_get_next;
+    }
+    else
+    {
+        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Unrecognized attribute for aggregating custody: %d\n",
+              attributes.custody_aggregation);
+        bplib_close(desc);
+        return NULL;
+    }
+
+    /* Allocate Memory for Custody Sources */
+    ch->custody_sources =
+        (bp_custody_source_t *)bplib_os_calloc_tag(sizeof(bp_custody_source_t) * attributes.max_custody_sources,
+                                                   BP_MEM_DACS);
+    if (ch->custody_sources == NULL)
+    {
+        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to allocate memory for channel custody sources\n");
+        bplib_close(desc);
+        return NULL;
+    }
+
+    /* Allocate Memory for DACS Channel Trees to Store Bundle IDs */
+    int i;
+    for (i = 0; i < attributes.max_custody_sources; i++)
+    {
+        bp_custody_source_t *source = &ch->custody_sources[i];
+        source->node                = BP_IPN_NULL;
+        source->service             = BP_IPN_NULL;
+        source->custody             = custody;
+        source->dacs_last_sent      = 0;
+        source->last_taken          = 0;
+        source->taken               = 0;
+        source->rate                = 0;
+        source->dacs_wait           = 0;
+
+        status = source->custody.create(&source->custody.tree, attributes.max_gaps_per_dacs);
+        if (status != BP_SUCCESS)
+        {
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to allocate memory for channel DACS tree\n");
+            bplib_close(desc);
+            return NULL;
+        }
+
+        ch->num_custody_sources++;
+    }
+
+    /* Initialize Timeout Periods (attributes are in seconds) */
+    ch->retx_timeout = (bp_val_t)attributes.timeout * 1000;
+    ch->dacs_period  = attributes.dacs_rate > 0 ? (bp_val_t)attributes.dacs_rate * 1000 : 0;
+    ch->sweep_period = attributes.sweep_rate > 0 ? (bp_val_t)attributes.sweep_rate * 1000 : 0;
+
+    /* Initialize Adaptive DACS (half of the channel's active table estimates the custodian's) */
+    ch->dacs_adaptive = attributes.adaptive_dacs;
+    ch->dacs_urgent   = attributes.active_table_size > 1 ? (unsigned long)attributes.active_table_size / 2 : 1;
+
+    /* Initialize Active Table Signal */
+    ch->active_table_signal = bplib_os_createlock();
+    if (!bp_handle_is_valid(ch->active_table_signal))
+    {
+        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to create custody_tree_lock for active table\n");
+        bplib_close(desc);
+        return NULL;
+    }
+
+    /* Initialize Active Table Functions */
+    if (attributes.retransmit_order == BP_RETX_SMALLEST_CID)
+    {
+        ch->active_table.create       = (bp_table_create_t)cbuf_create;
+        ch->active_table.destroy      = (bp_table_destroy_t)cbuf_destroy;
+        ch->active_table.add          = (bp_table_add_t)cbuf_add;
+        ch->active_table.next         = (bp_table_next_t)cbuf_next;
+        ch->active_table.remove       = (bp_table_remove_t)cbuf_remove;
+        ch->active_table.remove_range = (bp_table_remove_range_t)cbuf_remove_range;
+        ch->active_table.available    = (bp_table_available_t)cbuf_available;
+        ch->active_table.count        = (bp_table_count_t)cbuf_count;
+        ch->active_table.resize       = (bp_table_resize_t)cbuf_resize;
+    }
+    else if (attributes.retransmit_order == BP_RETX_OLDEST_BUNDLE)
+    {
+        ch->active_table.create       = (bp_table_create_t)rh_hash_create;
+        ch->active_table.destroy      = (bp_table_destroy_t)rh_hash_destroy;
+        ch->active_table.add          = (bp_table_add_t)rh_hash_add;
+        ch->active_table.next         = (bp_table_next_t)rh_hash_next;
+        ch->active_table.remove       = (bp_table_remove_t)rh_hash_remove;
+        ch->active_table.remove_range = (bp_table_remove_range_t)rh_hash_remove_range;
+        ch->active_table.available    = (bp_table_available_t)rh_hash_available;
+        ch->active_table.count        = (bp_table_count_t)rh_hash_count;
+        ch->active_table.resize       = (bp_table_resize_t)rh_hash_resize;
+    }
+    else
+    {
+        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Unrecognized attribute for creating active table: %d\n",
+              attributes.retransmit_order);
+        bplib_close(desc);
+        return NULL;
+    }
+
+    /* Initialize Active Table */
+    status = ch->active_table.create(&ch->active_table.table, attributes.active_table_size);
+    if (status != BP_SUCCESS)
+    {
+        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to create active table for channel\n");
+        bplib_close(desc);
+        return NULL;
+    }
+
+    /* Initialize Retransmit Timers (one per bundle queue) */
+    if (attributes.active_table_size > 0)
+    {
+        unsigned long msnow = 0;
+        bplib_os_monotime(&msnow);
+        for (q = 0; q < BP_NUM_COS_QUEUES; q++)
+        {
+            if (!bp_handle_is_valid(ch->bundle_handles[q]))
+            {
+                continue;
+            }
+
+            status = twheel_create(&ch->retx_timers[q], attributes.active_table_size, msnow);
+            if (status != BP_SUCCESS)
+            {
+                bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to create retransmit timers for channel\n");
+                bplib_close(desc);
+                return NULL;
+            }
+        }
+    }
+
+    /* Initialize Readiness Event (not all platforms provide one) */
+    ch->ready_event = bplib_os_createevent();
+
+    /* Initialize Current Custody ID */
+    ch->current_active_cid  = 0;
+    ch->reserved_active_cid = 0;
+    reserve_custody_ids(ch);
+
+    /* Add to Open Channels */
+    bplib_os_mutex_lock(&bplib_channel_list_lock);
+    {
+        desc->next         = bplib_channel_list;
+        bplib_channel_list = desc;
+    }
+    bplib_os_mutex_unlock(&bplib_channel_list_lock);
+
+    /* Return Channel */
+    return desc;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_open -
+ *-------------------------------------------------------------------------------------*/
+bp_desc_t *bplib_open(bp_route_t route, bp_store_t store, bp_attr_t attributes)
+{
+    bp_memstats_t *prev = bplib_os_memaccount(NULL);
+    bp_desc_t     *desc = open_channel(route, store, attributes);
+    bplib_os_memaccount(prev);
+    return desc;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_close -
+ *-------------------------------------------------------------------------------------*/
+void bplib_close(bp_desc_t *desc)
+{
+    /* Check Parameters */
+    if (desc == NULL)
+    {
+        return;
+    }
+
+    /* Get Channel */
+    bp_channel_t *ch = &desc->channel;
+
+    /* Remove Routes to Channel */
+    bplib_delroute(desc);
+
+    /* Remove from Open Channels (not present if open failed) */
+    bplib_os_mutex_lock(&bplib_channel_list_lock);
+    {
+        bp_desc_t **link = &bplib_channel_list;
+        while (*link && *link != desc)
+        {
+            link = &(*link)->next;
+        }
+        if (*link)
+        {
+            *link = desc->next;
+        }
+    }
+    bplib_os_mutex_unlock(&bplib_channel_list_lock);
+
+    /* Release Bundles Held by Expiration Sweep (no longer swept once removed from open channels) */
+    drain_sweep_heads(ch, false);
+
+    /* Un-initialize Bundle Stores */
+    int q;
+    for (q = 0; q < BP_NUM_COS_QUEUES; q++)
+    {
+        if (bp_handle_is_valid(ch->bundle_handles[q]))
+        {
+            ch->store.destroy(ch->bundle_handles[q]);
+            ch->bundle_handles[q] = BP_INVALID_HANDLE;
+        }
+    }
+
+    /* Un-initialize Payload Store */
+    if (bp_handle_is_valid(ch->payload_handle))
+    {
+        ch->store.destroy(ch->payload_handle);
+        ch->payload_handle = BP_INVALID_HANDLE;
+    }
+
+    /* Un-initialize Record Store */
+    if (bp_handle_is_valid(ch->dacs_handle))
+    {
+        ch->store.destroy(ch->dacs_handle);
+        ch->dacs_handle = BP_INVALID_HANDLE;
+    }
+
+    /* Destroy Custody Tree Lock */
+    bplib_os_mutex_destroy(&ch->custody_tree_lock);
+
+    /* Destroy Forwarding Lock */
+    bplib_os_mutex_destroy(&ch->forward_lock);
+
+    /* Free Buffer for DACS */
+    if (ch->dacs_buffer)
+    {
+        bplib_os_free(ch->dacs_buffer);
+        ch->dacs_buffer = NULL;
+    }
+
+    /* Free Buffer for Streamed Payload */
+    if (ch->stream_buffer)
+    {
+        bplib_os_free(ch->stream_buffer);
+        ch->stream_buffer = NULL;
+    }
+
+    /* Free Buffer for Payload Compression */
+    if (ch->compress_buffer)
+    {
+        bplib_os_free(ch->compress_buffer);
+        ch->compress_buffer = NULL;
+    }
+
+    /* Free Fragment Reassembly Buffer */
+    if (ch->reasm)
+    {
+        reasm_destroy(ch->reasm);
+        ch->reasm = NULL;
+    }
+
+    /* Destroy Fragment Reassembly Lock */
+    bplib_os_mutex_destroy(&ch->reasm_lock);
+
+    /* Free Duplicate Detection Index */
+    if (ch->dedup)
+    {
+        dedup_destroy(ch->dedup);
+        ch->dedup = NULL;
+    }
+
+    /* Destroy Duplicate Detection Lock */
+    bplib_os_mutex_destroy(&ch->dedup_lock);
+
+    /* Destroy Expiration Sweep Lock (a swept bundle not yet loaded is left in storage) */
+    bplib_os_mutex_destroy(&ch->sweep_lock);
+
+    /* Free Custody Trees */
+    if (ch->custody_sources)
+    {
+        int i;
+        for (i = 0; i < ch->num_custody_sources; i++)
+        {
+            ch->custody_sources[i].custody.destroy(ch->custody_sources[i].custody.tree);
+        }
+        bplib_os_free(ch->custody_sources);
+        ch->custody_sources = NULL;
+    }
+
+    /* Un-initialize Bundle and DACS */
+    ch->proto->destroy(&ch->bundle);
+    ch->proto->destroy(&ch->dacs);
+
+    /* Un-initialize Active Table */
+    if (bp_handle_is_valid(ch->active_table_signal))
+    {
+        bplib_os_destroylock(ch->active_table_signal);
+    }
+    if (ch->active_table.destroy)
+    {
+        ch->active_table.destroy(ch->active_table.table);
+    }
+    for (q = 0; q < BP_NUM_COS_QUEUES; q++)
+    {
+        if (ch->retx_timers[q])
+        {
+            twheel_destroy(ch->retx_timers[q]);
+        }
+    }
+    bplib_os_destroyevent(ch->ready_event);
+
+    /* Free Channel */
+    bplib_os_free(desc);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_flush -
+ *-------------------------------------------------------------------------------------*/
+int bplib_flush(bp_desc_t *desc)
+{
+    /* Check Parameters */
+    if (desc == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    /* Get Channel */
+    bp_channel_t *ch = &desc->channel;
+
+    /* Lock Active Table */
+    bplib_os_lock(ch->active_table_signal);
+    {
+        /* Relinquish All Active Bundles */
+        bp_active_bundle_t active_bundle;
+        while (ch->active_table.next(ch->active_table.table, &active_bundle) == BP_SUCCESS)
+        {
+            ch->active_table.remove(ch->active_table.table, active_bundle.cid, NULL);
+            stop_retx_timer(ch, &active_bundle);
+            ch->store.relinquish(ch->bundle_handles[active_bundle.cos], active_bundle.sid);
+            stats_add(&ch->stats.lost, 1);
+        }
+    }
+    bplib_os_unlock(ch->active_table_signal);
+
+    /* Relinquish Bundles Held by Expiration Sweep */
+    stats_add(&ch->stats.lost, drain_sweep_heads(ch, true));
+
+    /* Active Table Has Room */
+    bplib_os_setevent(ch->ready_event);
+
+    /* Return Success */
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_config -
+ *-------------------------------------------------------------------------------------*/
+int bplib_config(bp_desc_t *desc, int mode, int opt, int *val)
+{
+    /* Check Parameters */
+    if (desc == NULL)
+    {
+        return BP_ERROR;
+    }
+    else if (val == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    /* Get Channel */
+    bp_channel_t *ch = &desc->channel;
+
+    /* Set Mode */
+    bool setopt = mode == BP_OPT_MODE_WRITE ? true : false;
+
+    /* Bundle Header Cannot Change Until Streamed Payload is Closed */
+    if (setopt && ch->stream_open)
+    {
+        return BP_ERROR;
+    }
+
+    /* Select and Process Option */
+    switch (opt)
+    {
+        case BP_OPT_LIFETIME:
+        {
+            if (setopt)
+            {
+                ch->bundle.attributes.lifetime = *val;
+            }
+            else
+            {
+                *val = ch->bundle.attributes.lifetime;
+            }
+            break;
+        }
+        case BP_OPT_REQUEST_CUSTODY:
+        {
+            if (setopt && *val != true && *val != false)
+            {
+                return BP_ERROR;
+            }
+            if (setopt)
+            {
+                ch->bundle.attributes.request_custody = *val;
+            }
+            else
+            {
+                *val = ch->bundle.attributes.request_custody;
+            }
+            break;
+        }
+        case BP_OPT_ADMIN_RECORD:
+        {
+            if (setopt && *val != true && *val != false)
+            {
+                return BP_ERROR;
+            }
+            if (setopt)
+            {
+                ch->bundle.attributes.admin_record = *val;
+            }
+            else
+            {
+                *val = ch->bundle.attributes.admin_record;
+            }
+            break;
+        }
+        case BP_OPT_INTEGRITY_CHECK:
+        {
+            if (setopt && *val != true && *val != false)
+            {
+                return BP_ERROR;
+            }
+            if (setopt)
+            {
+                ch->bundle.attributes.integrity_check = *val;
+            }
+            else
+            {
+                *val = ch->bundle.attributes.integrity_check;
+            }
+            break;
+        }
+        case BP_OPT_ALLOW_FRAGMENTATION:
+        {
+            if (setopt && *val != true && *val != false)
+            {
+                return BP_ERROR;
+            }
+            if (setopt)
+            {
+                ch->bundle.attributes.allow_fragmentation = *val;
+            }
+            else
+            {
+                *val = ch->bundle.attributes.allow_fragmentation;
+            }
+            break;
+        }
+        case BP_OPT_IGNORE_EXPIRATION:
+        {
+            if (setopt && *val != true && *val != false)
+            {
+                return BP_ERROR;
+            }
+            if (setopt)
+            {
+                ch->bundle.attributes.ignore_expiration = *val;
+            }
+            else
+            {
+                *val = ch->bundle.attributes.ignore_expiration;
+            }
+            break;
+        }
+        case BP_OPT_CID_REUSE:
+        {
+            if (setopt && *val != true && *val != false)
+            {
+                return BP_ERROR;
+            }
+            if (setopt)
+            {
+                ch->bundle.attributes.cid_reuse = *val;
+            }
+            else
+            {
+                *val = ch->bundle.attributes.cid_reuse;
+            }
+            break;
+        }
+        case BP_OPT_CIPHER_SUITE:
+        {
+            if (setopt)
+            {
+                ch->bundle.attributes.cipher_suite = *val;
+            }
+            else
+            {
+                *val = ch->bundle.attributes.cipher_suite;
+            }
+            break;
+        }
+        case BP_OPT_CLASS_OF_SERVICE:
+        {
+            if (setopt)
+            {
+                ch->bundle.attributes.class_of_service = *val;
+            }
+            else
+            {
+                *val = ch->bundle.attributes.class_of_service;
+            }
+            break;
+        }
+        case BP_OPT_TIMEOUT:
+        {
+            if (setopt && *val < 0)
+            {
+                return BP_ERROR;
+            }
+            if (setopt && *val > 0 && ch->bundle.attributes.active_table_size == 0)
+            {
+                return BP_ERROR;
+            }
+            if (setopt)
+            {
+                ch->bundle.attributes.timeout = *val;
+                ch->retx_timeout              = (bp_val_t)*val * 1000;
+            }
+            else
+            {
+                *val = ch->bundle.attributes.timeout;
+            }
+            break;
+        }
+        case BP_OPT_TIMEOUT_MS:
+        {
+            if (setopt && *val < 0)
+            {
+                return BP_ERROR;
+            }
+            if (setopt && *val > 0 && ch->bundle.attributes.active_table_size == 0)
+            {
+                return BP_ERROR;
+            }
+            if (setopt)
+            {
+                ch->bundle.attributes.timeout = (*val + 999) / 1000; /* rounded up so only zero is disabled */
+                ch->retx_timeout              = *val;
+            }
+            else
+            {
+                *val = (int)ch->retx_timeout;
+            }
+            break;
+        }
+        case BP_OPT_MAX_LENGTH:
+        {
+            if (setopt && *val < 0)
+            {
+                return BP_ERROR;
+            }
+            if (setopt)
+            {
+                ch->bundle.attributes.max_length = *val;
+            }
+            else
+            {
+                *val = ch->bundle.attributes.max_length;
+            }
+            break;
+        }
+        case BP_OPT_DACS_RATE:
+        {
+            if (setopt)
+            {
+                ch->dacs.attributes.dacs_rate = *val;
+                ch->dacs_period               = *val > 0 ? (bp_val_t)*val * 1000 : 0;
+            }
+            else
+            {
+                *val = ch->dacs.attributes.dacs_rate;
+            }
+            break;
+        }
+        case BP_OPT_DACS_RATE_MS:
+        {
+            if (setopt)
+            {
+                ch->dacs.attributes.dacs_rate = *val > 0 ? (*val + 999) / 1000 : 0;
+                ch->dacs_period               = *val > 0 ? (bp_val_t)*val : 0;
+            }
+            else
+            {
+                *val = (int)ch->dacs_period;
+            }
+            break;
+        }
+        case BP_OPT_LOAD_RATE_BYTES:
+        {
+            if (setopt && *val < 0)
+            {
+                return BP_ERROR;
+            }
+            if (setopt)
+            {
+                ch->bundle.attributes.load_rate_bytes = *val;
+            }
+            else
+            {
+                *val = ch->bundle.attributes.load_rate_bytes;
+            }
+            break;
+        }
+        case BP_OPT_LOAD_RATE_BUNDLES:
+        {
+            if (setopt && *val < 0)
+            {
+                return BP_ERROR;
+            }
+            if (setopt)
+            {
+                ch->bundle.attributes.load_rate_bundles = *val;
+            }
+            else
+            {
+                *val = ch->bundle.attributes.load_rate_bundles;
+            }
+            break;
+        }
+        case BP_OPT_RETX_SHARE:
+        {
+            if (setopt && (*val < 1 || *val > 100))
+            {
+                return BP_ERROR;
+            }
+            if (setopt)
+            {
+                ch->bundle.attributes.retx_share = *val;
+            }
+            else
+            {
+                *val = ch->bundle.attributes.retx_share;
+            }
+            break;
+        }
+        case BP_OPT_ACTIVE_TABLE_SIZE:
+        {
+            if (setopt && (*val <= 0 || (unsigned long)*val > BP_MAX_INDEX))
+            {
+                return BP_ERROR;
+            }
+            if (setopt && ch->bundle.attributes.active_table_size == 0)
+            {
+                return BP_ERROR;
+            }
+            if (setopt)
+            {
+                int status;
+                bplib_os_lock(ch->active_table_signal);
+                {
+                    status = resize_active_table(ch, *val);
+                }
+                bplib_os_unlock(ch->active_table_signal);
+                if (status != BP_SUCCESS)
+                {
+                    return status;
+                }
+            }
+            else
+            {
+                *val = ch->bundle.attributes.active_table_size;
+            }
+            break;
+        }
+        default:
+        {
+            /* Option Not Found */
+            return bplog(NULL, BP_FLAG_API_ERROR, "Config. Option Not Found (%d)\n", opt);
+        }
+    }
+
+    /* Re-initialize Bundles */
+    if (setopt)
+    {
+        ch->proto->invalidate_bundle(&ch->bundle);
+    }
+
+    /* Return Status */
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_latchstats -
+ *-------------------------------------------------------------------------------------*/
+int bplib_latchstats(bp_desc_t *desc, bp_stats_t *stats)
+{
+    /* Check Parameters */
+    if (desc == NULL)
+    {
+        return BP_ERROR;
+    }
+    else if (stats == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    /* Get Channel */
+    bp_channel_t *ch = &desc->channel;
+
+    /* Update Store Counts */
+    ch->stats.stored_bundles  = stored_bundles(ch);
+    ch->stats.stored_payloads = ch->store.getcount(ch->payload_handle);
+    ch->stats.stored_dacs     = ch->store.getcount(ch->dacs_handle);
+
+    /* Update Active Statistic */
+    ch->stats.active_bundles = ch->active_table.count(ch->active_table.table);
+
+    /* Latch Statistics */
+    *stats = ch->stats;
+
+    /* Return Success */
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_memstats - latches memory allocated for a channel, or for the library when desc is NULL
+ *
+ *  A channel is charged with what is allocated for it after its descriptor, by subsystem:
+ *  its active table, custody trees, dacs buffer, and the objects of its storage service
+ *-------------------------------------------------------------------------------------*/
+int bplib_memstats(bp_desc_t *desc, bp_memstats_t *stats)
+{
+    /* Check Parameters */
+    if (stats == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    /* Latch Statistics */
+    bplib_os_memstats(stats, desc ? &desc->channel.memory : NULL);
+
+    /* Return Success */
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_eventfd - returns a descriptor that polls readable when the channel may have a
+ *  bundle to load or a payload to accept, or BP_ERROR if not supported on the platform
+ *-------------------------------------------------------------------------------------*/
+int bplib_eventfd(bp_desc_t *desc)
+{
+    /* Check Parameters */
+    if (desc == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    /* Return Descriptor */
+    return desc->channel.ready_event;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_eventclear - clears the readiness event; must be called before draining the
+ *  channel with bplib_load and bplib_accept so that no event is missed
+ *-------------------------------------------------------------------------------------*/
+int bplib_eventclear(bp_desc_t *desc)
+{
+    /* Check Parameters */
+    if (desc == NULL)
+    {
+        return BP_ERROR;
+    }
+    else if (desc->channel.ready_event < 0)
+    {
+        return BP_ERROR;
+    }
+
+    /* Clear Event */
+    bplib_os_clearevent(desc->channel.ready_event);
+
+    /* Return Success */
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_tick - sends aggregated custody signals that are due across all open channels,
+ *  and sweeps expired bundles from channels opened with a sweep rate
+ *
+ *  timeout - returns the number of milliseconds the caller can wait before the next call;
+ *            BP_PEND if no open channel generates timed custody signals or is swept
+ *  flags - OR'ed with flags from creating the custody signals
+ *
+ *  Returns BP_SUCCESS or the first error from enqueuing a DACS bundle
+ *-------------------------------------------------------------------------------------*/
+int bplib_tick(int *timeout, uint32_t *flags)
+{
+    int           ret_status = BP_SUCCESS;
+    unsigned long next_wait  = 0;
+    bool          waiting    = false;
+    unsigned long msnow;
+
+    /* Get Current Time */
+    if (bplib_os_monotime(&msnow) == BP_ERROR)
+    {
+        return bplog(flags, BP_FLAG_UNRELIABLE_TIME, "Unreliable monotonic time found\n");
+    }
+
+    bplib_os_mutex_lock(&bplib_channel_list_lock);
+    {
+        bp_desc_t *desc;
+        for (desc = bplib_channel_list; desc != NULL; desc = desc->next)
+        {
+            bp_channel_t *ch = &desc->channel;
+            int           i;
+
+            /* Sweep Expired Bundles (again on the next call when a sweep stopped at its limit) */
+            if (ch->sweep_period > 0)
+            {
+                unsigned long wait = 0;
+                if (msnow < (ch->sweep_last + ch->sweep_period))
+                {
+                    wait = (ch->sweep_last + ch->sweep_period) - msnow;
+                }
+                else if (!sweep_expired(ch, flags))
+                {
+                    ch->sweep_last = msnow;
+                    wait           = ch->sweep_period;
+                }
+
+                if (!waiting || wait < next_wait)
+                {
+                    next_wait = wait;
+                    waiting   = true;
+                }
+            }
+
+            if (ch->dacs_period == 0)
+            {
+                continue;
+            }
+
+            bplib_os_mutex_lock(&ch->custody_tree_lock);
+            {
+                for (i = 0; i < ch->num_custody_sources; i++)
+                {
+                    bp_custody_source_t *source = &ch->custody_sources[i];
+                    bp_val_t             period = dacs_period(ch, source);
+                    unsigned long        wait;
+
+                    if (source->custody.is_empty(source->custody.tree))
+                    {
+                        /* Lengthen Adapted Period of Idle Source */
+                        if (ch->dacs_adaptive && msnow >= (source->dacs_last_sent + period))
+                        {
+                            idle_dacs(ch, source, msnow);
+                            period = dacs_period(ch, source);
+                        }
+
+                        /* Custody Taken Now is Due No Sooner than a Period Away */
+                        wait = period;
+                    }
+                    else if (msnow >= (source->dacs_last_sent + period))
+                    {
+                        int status = create_dacs(ch, source, msnow, BP_CHECK, flags);
+                        if (status != BP_SUCCESS && ret_status == BP_SUCCESS)
+                        {
+                            ret_status = status;
+                        }
+                        wait = dacs_period(ch, source);
+                    }
+                    else
+                    {
+                        wait = (source->dacs_last_sent + period) - msnow;
+                    }
+
+                    /* Keep Earliest Deadline */
+                    if (!waiting || wait < next_wait)
+                    {
+                        next_wait = wait;
+                        waiting   = true;
+                    }
+                }
+            }
+            bplib_os_mutex_unlock(&ch->custody_tree_lock);
+        }
+    }
+    bplib_os_mutex_unlock(&bplib_channel_list_lock);
+
+    /* Return Time to Next Deadline */
+    if (timeout)
+    {
+        if (!waiting)
+        {
+            *timeout = BP_PEND;
+        }
+        else
+        {
+            *timeout = next_wait > INT_MAX ? INT_MAX : (int)next_wait;
+        }
+    }
+
+    return ret_status;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_store -
+ *-------------------------------------------------------------------------------------*/
+int bplib_store(bp_desc_t *desc, const void *payload, size_t size, int timeout, uint32_t *flags)
+{
+    int status = BP_SUCCESS;
+
+    /* Check Parameters */
+    if (desc == NULL)
+    {
+        return BP_ERROR;
+    }
+    else if (payload == NULL)
+    {
+        return BP_ERROR;
+    }
+    else if (flags == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    /* Get Channel */
+    bp_channel_t *ch = &desc->channel;
+
+    /* Direct Data Path */
+    if (ch->proto->store)
+    {
+        return ch->proto->store(&ch->bundle, payload, size, timeout, flags);
+    }
+
+    /* Check if Re-initialization Needed */
+    if (ch->bundle.prebuilt == false)
+    {
+        status = ch->proto->populate_bundle(&ch->bundle, flags);
+    }
+
+    /* Compress Payload */
+    int csize = 0;
+    if (status == BP_SUCCESS && ch->compress_buffer && size > 0 && size <= (size_t)INT_MAX)
+    {
+        const bp_compressor_t *compressor = ch->bundle.attributes.payload_compressor;
+        int                    max_csize  = ch->bundle.attributes.max_length - ch->proto->header_size(&ch->bundle);
+        if (max_csize > (int)size - 1)
+        {
+            max_csize = (int)size - 1; /* only worth sending compressed when smaller */
+        }
+
+        if (max_csize > 0)
+        {
+            csize = compressor->compress(payload, (int)size, ch->compress_buffer, max_csize);
+        }
+
+        if (csize > 0 && ch->proto->set_compression(&ch->bundle, compressor->id, (int)size, flags) != BP_SUCCESS)
+        {
+            csize = 0;
+        }
+    }
+
+    /* Send Bundle */
+    if (status == BP_SUCCESS && csize > 0)
+    {
+        status = ch->proto->send_bundle(&ch->bundle, ch->compress_buffer, csize, create_bundle, ch, timeout, flags);
+        if (status == BP_SUCCESS)
+        {
+            stats_add(&ch->stats.compressed_payloads, 1);
+        }
+
+        /* Restore Prebuilt Bundle to Uncompressed */
+        ch->proto->set_compression(&ch->bundle, 0, 0, flags);
+    }
+    else if (status == BP_SUCCESS)
+    {
+        status = ch->proto->send_bundle(&ch->bundle, payload, size, create_bundle, ch, timeout, flags);
+    }
+
+    /* Return Status */
+    return status;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_stream_open -
+ *
+ *  starts storing a payload of size bytes that is passed in pieces to bplib_stream_write;
+ *  each bundle is stored as soon as its part of the payload has been written, so only
+ *  one bundle of the payload is held by the library at a time
+ *-------------------------------------------------------------------------------------*/
+int bplib_stream_open(bp_desc_t *desc, size_t size, uint32_t *flags)
+{
+    int status = BP_SUCCESS;
+
+    /* Check Parameters */
+    if (desc == NULL)
+    {
+        return BP_ERROR;
+    }
+    else if (size == 0)
+    {
+        return BP_ERROR;
+    }
+    else if (flags == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    /* Get Channel */
+    bp_channel_t *ch = &desc->channel;
+
+    /* Check Stream Can be Opened */
+    if (ch->proto->begin_adu == NULL)
+    {
+        return bplog(flags, BP_FLAG_API_ERROR, "Protocol engine does not support streamed payloads\n");
+    }
+    else if (ch->stream_open)
+    {
+        return bplog(flags, BP_FLAG_API_ERROR, "Streamed payload already open\n");
+    }
+
+    /* Check if Re-initialization Needed */
+    if (ch->bundle.prebuilt == false)
+    {
+        status = ch->proto->populate_bundle(&ch->bundle, flags);
+        if (status != BP_SUCCESS)
+        {
+            return status;
+        }
+    }
+
+    /* Start Payload */
+    int max_paysize = ch->proto->begin_adu(&ch->bundle, size, flags);
+    if (max_paysize < 0)
+    {
+        return max_paysize;
+    }
+
+    /* Allocate Buffer for Payload of One Bundle */
+    bp_memstats_t *prev = bplib_os_memaccount(&ch->memory);
+    ch->stream_buffer   = (uint8_t *)bplib_os_calloc_tag(max_paysize, BP_MEM_CHANNEL);
+    bplib_os_memaccount(prev);
+    if (ch->stream_buffer == NULL)
+    {
+        ch->proto->end_adu(&ch->bundle, false, flags);
+        return bplog(flags, BP_FLAG_DIAGNOSTIC, "Failed to allocate memory for streamed payload\n");
+    }
+
+    /* Open Stream */
+    ch->stream_open = true;
+    ch->stream_size = size;
+    ch->stream_sent = 0;
+    ch->stream_max  = max_paysize;
+    ch->stream_fill = 0;
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_stream_write -
+ *
+ *  adds the next size bytes to the payload opened by bplib_stream_open; bundles are
+ *  stored directly from the written data when a write holds the whole payload of a
+ *  bundle, otherwise the data is collected until it does.  If a bundle cannot be
+ *  stored the streamed payload is closed and an error code returned
+ *-------------------------------------------------------------------------------------*/
+int bplib_stream_write(bp_desc_t *desc, const void *data, size_t size, int timeout, uint32_t *flags)
+{
+    int status = BP_SUCCESS;
+
+    /* Check Parameters */
+    if (desc == NULL)
+    {
+        return BP_ERROR;
+    }
+    else if (data == NULL)
+    {
+        return BP_ERROR;
+    }
+    else if (flags == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    /* Get Channel */
+    bp_channel_t *ch = &desc->channel;
+
+    /* Check Write Fits in Payload */
+    if (!ch->stream_open)
+    {
+        return bplog(flags, BP_FLAG_API_ERROR, "Streamed payload not open\n");
+    }
+    else if (size > ch->stream_size - ch->stream_sent - ch->stream_fill)
+    {
+        return bplog(flags, BP_FLAG_API_ERROR, "Write of %lu bytes exceeds size of streamed payload (%lu)\n",
+                     (unsigned long)size, (unsigned long)ch->stream_size);
+    }
+
+    /* Store Bundles */
+    const uint8_t *src = (const uint8_t *)data;
+    while (size > 0 && status == BP_SUCCESS)
+    {
+        /* Size of Next Bundle's Payload */
+        bp_val_t remaining   = ch->stream_size - ch->stream_sent;
+        int      bundle_size = remaining < (bp_val_t)ch->stream_max ? (int)remaining : ch->stream_max;
+
+        if (ch->stream_fill == 0 && size >= (size_t)bundle_size)
+        {
+            /* Store Bundle from Written Data */
+            status = ch->proto->send_fragment(&ch->bundle, src, bundle_size, ch->stream_sent, create_bundle, ch,
+                                              timeout, flags);
+            src += bundle_size;
+            size -= bundle_size;
+        }
+        else
+        {
+            /* Collect Written Data */
+            int n = bundle_size - ch->stream_fill;
+            if ((size_t)n > size)
+            {
+                n = (int)size;
+            }
+            memcpy(&ch->stream_buffer[ch->stream_fill], src, n);
+            ch->stream_fill += n;
+            src += n;
+            size -= n;
+
+            /* Store Bundle from Collected Data */
+            if (ch->stream_fill < bundle_size)
+            {
+                continue;
+            }
+            status          = ch->proto->send_fragment(&ch->bundle, ch->stream_buffer, bundle_size, ch->stream_sent,
+                                                       create_bundle, ch, timeout, flags);
+            ch->stream_fill = 0;
+        }
+
+        if (status == BP_SUCCESS)
+        {
+            ch->stream_sent += bundle_size;
+        }
+    }
+
+    /* Close Stream that Failed */
+    if (status != BP_SUCCESS)
+    {
+        stream_end(ch, flags);
+    }
+
+    return status;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_stream_close -
+ *
+ *  finishes the payload opened by bplib_stream_open; returns an error if not all of
+ *  it was written, in which case the bundles already stored carry a partial payload
+ *-------------------------------------------------------------------------------------*/
+int bplib_stream_close(bp_desc_t *desc, uint32_t *flags)
+{
+    int status = BP_SUCCESS;
+
+    /* Check Parameters */
+    if (desc == NULL)
+    {
+        return BP_ERROR;
+    }
+    else if (flags == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    /* Get Channel */
+    bp_channel_t *ch = &desc->channel;
+
+    /* Check Stream */
+    if (!ch->stream_open)
+    {
+        return bplog(flags, BP_FLAG_API_ERROR, "Streamed payload not open\n");
+    }
+    else if (ch->stream_sent != ch->stream_size)
+    {
+        status = bplog(flags, BP_FLAG_API_ERROR, "Streamed payload closed after %lu of %lu bytes\n",
+                       (unsigned long)(ch->stream_sent + ch->stream_fill), (unsigned long)ch->stream_size);
+    }
+
+    /* Close Stream */
+    stream_end(ch, flags);
+
+    return status;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_lend -
+ *
+ *  allocates a payload buffer inside a storage object so that bplib_store_lent can
+ *  bundle it without copying; returns NULL if the storage service does not support
+ *  zero-copy or the payload would need to be fragmented
+ *-------------------------------------------------------------------------------------*/
+void *bplib_lend(bp_desc_t *desc, size_t size, uint32_t *flags)
+{
+    int status = BP_SUCCESS;
+
+    /* Check Parameters */
+    if (desc == NULL)
+    {
+        return NULL;
+    }
+    else if (size == 0)
+    {
+        return NULL;
+    }
+    else if (flags == NULL)
+    {
+        return NULL;
+    }
+
+    /* Get Channel */
+    bp_channel_t *ch = &desc->channel;
+
+    /* Check Storage Service */
+    if (ch->store.allocate == NULL || ch->store.post == NULL || ch->store.discard == NULL)
+    {
+        bplog(flags, BP_FLAG_API_ERROR, "Storage service does not support lending payloads\n");
+        return NULL;
+    }
+    else if (ch->proto->store)
+    {
+        bplog(flags, BP_FLAG_API_ERROR, "Protocol engine does not support lending payloads\n");
+        return NULL;
+    }
+
+    /* Check if Re-initialization Needed */
+    if (ch->bundle.prebuilt == false)
+    {
+        status = ch->proto->populate_bundle(&ch->bundle, flags);
+        if (status != BP_SUCCESS)
+        {
+            return NULL;
+        }
+    }
+
+    /* Check Fragmentation */
+    if ((int)size > ch->bundle.attributes.max_length - ch->proto->header_size(&ch->bundle))
+    {
+        bplog(flags, BP_FLAG_BUNDLE_TOO_LARGE, "Unable to lend payload that requires fragmentation (%lu)\n",
+              (unsigned long)size);
+        return NULL;
+    }
+
+    /* Allocate Object with Room for Storage Header */
+    int          hdrsz  = lent_header_size(ch);
+    bp_handle_t  handle = ch->bundle_handles[bundle_queue(ch, ch->bundle.attributes.class_of_service)];
+    bp_object_t *object = store_allocate(ch, handle, hdrsz + size);
+    if (object == NULL)
+    {
+        bplog(flags, BP_FLAG_STORE_FAILURE, "Failed to allocate lent payload of %lu bytes\n", (unsigned long)size);
+        return NULL;
+    }
+
+    /* Return Payload Buffer */
+    uint8_t *payload = (uint8_t *)&object->data[hdrsz];
+    lent_stash(payload, hdrsz);
+    return payload;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_store_lent -
+ *
+ *  bundles a payload obtained from bplib_lend; on success the library owns the buffer,
+ *  on failure it remains lent to the caller (retry or return it with bplib_unlend)
+ *-------------------------------------------------------------------------------------*/
+int bplib_store_lent(bp_desc_t *desc, void *payload, size_t size, int timeout, uint32_t *flags)
+{
+    int status = BP_SUCCESS;
+    int hdrsz;
+
+    /* Check Parameters */
+    if (desc == NULL)
+    {
+        return BP_ERROR;
+    }
+    else if (payload == NULL)
+    {
+        return BP_ERROR;
+    }
+    else if (flags == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    /* Get Channel and Object */
+    bp_channel_t *ch     = &desc->channel;
+    bp_object_t  *object = lent_object(payload, &hdrsz);
+    if (size == 0 || hdrsz + size > object->header.size)
+    {
+        return bplog(flags, BP_FLAG_API_ERROR, "Invalid size of lent payload: %lu\n", (unsigned long)size);
+    }
+
+    /* Check if Re-initialization Needed */
+    if (ch->bundle.prebuilt == false)
+    {
+        status = ch->proto->populate_bundle(&ch->bundle, flags);
+    }
+
+    /* Send Bundle */
+    if (status == BP_SUCCESS)
+    {
+        bp_handle_t handle = ch->bundle_handles[bundle_queue(ch, ch->bundle.attributes.class_of_service)];
+        if (hdrsz == lent_header_size(ch) && bp_handle_equal(object->header.handle, handle) &&
+            (int)size <= ch->bundle.attributes.max_length - ch->proto->header_size(&ch->bundle))
+        {
+            /* Store In Place */
+            bp_lent_parm_t lent     = {ch, object};
+            size_t         lentsize = object->header.size;
+            object->header.size     = hdrsz + size;
+            status = ch->proto->send_bundle(&ch->bundle, payload, size, create_lent_bundle, &lent, timeout, flags);
+            if (lent.object != NULL)
+            {
+                /* Restore Lent Size and Stash (overwritten by the storage header) */
+                object->header.size = lentsize;
+                lent_stash(payload, hdrsz);
+            }
+        }
+        else
+        {
+            /* Channel Changed Since Payload was Lent - fall back to copying it */
+            status = ch->proto->send_bundle(&ch->bundle, payload, size, create_bundle, ch, timeout, flags);
+            if (status == BP_SUCCESS)
+            {
+                ch->store.discard(object->header.handle, object);
+            }
+        }
+    }
+
+    /* Return Status */
+    return status;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_unlend -
+ *
+ *  returns a payload buffer obtained from bplib_lend that will not be stored
+ *-------------------------------------------------------------------------------------*/
+int bplib_unlend(bp_desc_t *desc, void *payload)
+{
+    int hdrsz;
+
+    /* Check Parameters */
+    if (desc == NULL)
+    {
+        return BP_ERROR;
+    }
+    else if (payload == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    /* Discard Object */
+    bp_channel_t *ch     = &desc->channel;
+    bp_object_t  *object = lent_object(payload, &hdrsz);
+    return ch->store.discard(object->header.handle, object);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_load -
+ *-------------------------------------------------------------------------------------*/
+int bplib_load(bp_desc_t *desc, void **bundle, size_t *size, int timeout, uint32_t *flags)
+{
+    bp_active_bundle_t active_bundle = {.sid = BP_SID_VACANT, .timer = TWHEEL_NULL_TIMER};
+    int                status        = BP_SUCCESS; /* success or error code */
+
+    /* Check Parameters */
+    if (desc == NULL)
+    {
+        return BP_ERROR;
+    }
+    else if (bundle == NULL)
+    {
+        return BP_ERROR;
+    }
+    else if (flags == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    /* Get Channel */
+    bp_channel_t *ch = &desc->channel;
+
+    /* Direct Data Path */
+    if (ch->proto->load)
+    {
+        status = ch->proto->load(&ch->bundle, bundle, size, timeout, flags);
+        if (status == BP_SUCCESS)
+        {
+            bptrace3(transmit, ch, BP_SID_VACANT, size ? *size : 0);
+            stats_add(&ch->stats.transmitted_bundles, 1);
+        }
+        return status;
+    }
+
+    /* Setup State */
+    unsigned long sysnow = 0;     /* current system time used for expiration (seconds) */
+    unsigned long msnow  = 0;     /* current monotonic time used for timeouts (milliseconds) */
+    bp_object_t  *object = NULL;  /* start out assuming nothing to send */
+    bool          newcid = true;  /* whether to assign new custody id and active table entry */
+    bool          resend = false; /* is loaded bundle a retransmission */
+    bool          isdacs = false; /* is loaded bundle a dacs */
+    bool          unrelt = false; /* is time unreliable */
+
+    /* Get Current Time */
+    if (bplib_os_systime(&sysnow) == BP_ERROR)
+    {
+        unrelt = true; /* time is unreliable */
+        bplog(flags, BP_FLAG_UNRELIABLE_TIME, "Unreliable time detected: %ld\n", sysnow);
+    }
+    bplib_os_monotime(&msnow);
+
+    /*-------------------------*/
+    /* Try to Send DACS Bundle */
+    /*-------------------------*/
+    check_dacs(ch, msnow, flags);
+
+    /* Dequeue any Stored DACS */
+    unsigned long start       = latency_start();
+    int           dacs_status = store_dequeue(ch, ch->dacs_handle, &object, BP_CHECK);
+    if (dacs_status == BP_SUCCESS)
+    {
+        latency_stop(&ch->stats.dequeue, start);
+        isdacs = true;
+    }
+    else if (dacs_status != BP_TIMEOUT)
+    {
+        /* Failed Storage Service */
+        bplog(flags, BP_FLAG_STORE_FAILURE, "Failed (%d) to dequeue dacs bundle from storage service\n", dacs_status);
+    }
+
+    /*------------------------------------------------------------*/
+    /* Pace Load - wait until load rates allow another bundle out */
+    /*------------------------------------------------------------*/
+    bool paced   = (ch->bundle.attributes.load_rate_bytes > 0) || (ch->bundle.attributes.load_rate_bundles > 0);
+    bool retx_ok = true; /* timed-out bundles fit in their share of the load rates */
+    if (paced && object == NULL)
+    {
+        bplib_os_lock(ch->active_table_signal);
+        {
+            int delay = pace_load(ch, msnow, &retx_ok);
+            while (delay > 0 && status == BP_SUCCESS)
             {
-                *val = ch->bundle.attributes.integrity_check;
+                if (timeout == BP_CHECK)
+                {
+                    status = BP_TIMEOUT;
+                }
+                else
+                {
+                    /* Wait out Delay (or whatever is left of timeout) */
+                    unsigned long wait_start = msnow;
+                    bplib_os_waiton(ch->active_table_signal, (timeout == BP_PEND || delay < timeout) ? delay : timeout);
+                    bplib_os_monotime(&msnow);
+                    if (timeout != BP_PEND)
+                    {
+                        unsigned long waited = msnow - wait_start;
+                        timeout              = waited < (unsigned long)timeout ? timeout - (int)waited : BP_CHECK;
+                    }
+                    delay = pace_load(ch, msnow, &retx_ok);
+                }
             }
-            break;
         }
-        case BP_OPT_ALLOW_FRAGMENTATION:
+        bplib_os_unlock(ch->active_table_signal);
+
+        if (status != BP_SUCCESS)
         {
-            if (setopt && *val != true && *val != false)
-            {
-                return BP_ERROR;
-            }
-            if (setopt)
-            {
-                ch->bundle.attributes.allow_fragmentation = *val;
-            }
-            else
-            {
-                *val = ch->bundle.attributes.allow_fragmentation;
-            }
-            break;
+            return status;
         }
-        case BP_OPT_IGNORE_EXPIRATION:
+    }
+
+    /*--------------------------------------------------------------*/
+    /* Schedule Queues - a single queue unless class of service set */
+    /*--------------------------------------------------------------*/
+    int           order[BP_NUM_COS_QUEUES] = {BP_COS_NORMAL}; /* queues in the order they are tried */
+    int           num_queues               = 1;
+    int           queue                    = BP_COS_NORMAL; /* queue of bundle loaded */
+    int           queue_timeout            = timeout;
+    bool          waited                   = true; /* scheduled queues are waited on together, once */
+    unsigned long load_events              = 0;
+    if (ch->cos_scheduling != BP_SCHEDULE_FIFO)
+    {
+        bplib_os_lock(ch->active_table_signal);
         {
-            if (setopt && *val != true && *val != false)
-            {
-                return BP_ERROR;
-            }
-            if (setopt)
-            {
-                ch->bundle.attributes.ignore_expiration = *val;
-            }
-            else
-            {
-                *val = ch->bundle.attributes.ignore_expiration;
-            }
-            break;
+            num_queues  = schedule_queues(ch, order);
+            load_events = ch->load_events;
         }
-        case BP_OPT_CID_REUSE:
+        bplib_os_unlock(ch->active_table_signal);
+        queue_timeout = BP_CHECK;
+        waited        = (timeout == BP_CHECK);
+    }
+
+    while (object == NULL)
+    {
+        int qi;
+        for (qi = 0; object == NULL && qi < num_queues && (status == BP_SUCCESS || status == BP_TIMEOUT); qi++)
         {
-            if (setopt && *val != true && *val != false)
-            {
-                return BP_ERROR;
-            }
-            if (setopt)
+            int pass_timeout = retx_ok ? queue_timeout : BP_CHECK; /* deferred retransmissions are sent if no wait */
+
+            queue  = order[qi];
+            status = BP_SUCCESS;
+
+            /*------------------------------------------------*/
+            /* Try to Send Active Bundle (if nothing to send) */
+            /*------------------------------------------------*/
+            bplib_os_lock(ch->active_table_signal);
             {
-                ch->bundle.attributes.cid_reuse = *val;
+                object = retx_ok ? retransmit_bundle(ch, queue, msnow, sysnow, unrelt, &active_bundle, flags) : NULL;
+                if (object)
+                {
+                    /* Bundle is a Retransmission */
+                    resend = true;
+
+                    /* Set flag to reuse custody id and active table entry */
+                    if (ch->bundle.attributes.cid_reuse)
+                    {
+                        newcid = false;
+                    }
+                }
+
+                /* Check Active Table Has Room (if nothing to send)
+                 * Since next step is to dequeue from store, need to make sure that there is room
+                 * in the active table since we don't want to dequeue a bundle from store and have
+                 * no place to put it.  Note that it is possible that even if the active table was
+                 * full, if the bundle dequeued did not request custody transfer it could still go
+                 * out, but the current design requires that at least one slot in the active table
+                 * is open at all times regardless if the bundle is requesting custody. */
+                if (object == NULL)
+                {
+                    status = ch->active_table.available(ch->active_table.table, ch->current_active_cid);
+                    if (status != BP_SUCCESS)
+                    {
+                        bplog(flags, BP_FLAG_ACTIVE_TABLE_WRAP, "No more room in active table for bundles\n");
+                        status = bplib_os_waiton(ch->active_table_signal, pass_timeout);
+                        if (status == BP_SUCCESS)
+                        {
+                            /* Recheck Table Availability
+                             * The conditional active_table_signal can notify that the table has space but
+                             * another thread could claim the space before this current context is able to
+                             * proceed; therefore the check for room in the table must be remade. Furthermore,
+                             * the check is only made once as we don't want to stay trapped inside this function;
+                             * as such any failed check is overwritten to be a TIMEOUT. */
+                            status = ch->active_table.available(ch->active_table.table, ch->current_active_cid);
+                            if (status != BP_SUCCESS)
+                            {
+                                status = BP_TIMEOUT;
+                            }
+                        }
+                    }
+                }
             }
-            else
+            bplib_os_unlock(ch->active_table_signal);
+
+            /*------------------------------------------------*/
+            /* Try to Send Stored Bundle (if nothing to send) */
+            /*------------------------------------------------*/
+            while (object == NULL && status == BP_SUCCESS)
             {
-                *val = ch->bundle.attributes.cid_reuse;
+                /* Dequeue Bundle from Storage Service */
+                unsigned long deq_start  = latency_start();
+                int           deq_status = dequeue_bundle(ch, queue, &object, pass_timeout);
+                if (deq_status == BP_SUCCESS)
+                {
+                    bp_bundle_data_t *data = (bp_bundle_data_t *)object->data;
+                    latency_stop(&ch->stats.dequeue, deq_start);
+
+                    /* Check Expiration Time */
+                    if (ch->proto->is_expired(&ch->bundle, sysnow, data->exprtime, unrelt))
+                    {
+                        /* Bundle Expired Clear Entry (and loop again) */
+                        bptrace2(expire, ch, object->header.sid);
+                        ch->store.release(ch->bundle_handles[queue], object->header.sid);
+                        ch->store.relinquish(ch->bundle_handles[queue], object->header.sid);
+                        stats_add(&ch->stats.expired, 1);
+                        object = NULL;
+                    }
+                }
+                else if (deq_status == BP_TIMEOUT)
+                {
+                    /* No Bundles in Storage to Send */
+                    status = BP_TIMEOUT;
+                }
+                else
+                {
+                    /* Failed Storage Service */
+                    status = bplog(flags, BP_FLAG_STORE_FAILURE, "Failed (%d) to dequeue bundle from storage service\n",
+                                   deq_status);
+                }
             }
-            break;
         }
-        case BP_OPT_CIPHER_SUITE:
+
+        /* Send Deferred Retransmissions (if no new bundle to send in their place) */
+        if (object == NULL && !retx_ok && status == BP_TIMEOUT)
         {
-            if (setopt)
-            {
-                ch->bundle.attributes.cipher_suite = *val;
-            }
-            else
-            {
-                *val = ch->bundle.attributes.cipher_suite;
-            }
-            break;
+            retx_ok = true;
+            status  = BP_SUCCESS;
+            continue;
         }
-        case BP_OPT_CLASS_OF_SERVICE:
+
+        /* Wait for Scheduled Queues (if nothing to send)
+         * Bundles stored and acknowledged since the queues were scheduled are counted
+         * by load_events, so that none are missed between checking the queues and waiting */
+        if (object != NULL || waited || status != BP_TIMEOUT)
         {
-            if (setopt)
-            {
-                ch->bundle.attributes.class_of_service = *val;
-            }
-            else
-            {
-                *val = ch->bundle.attributes.class_of_service;
-            }
             break;
         }
-        case BP_OPT_TIMEOUT:
+
+        waited = true;
+        bplib_os_lock(ch->active_table_signal);
         {
-            if (setopt && *val < 0)
-            {
-                return BP_ERROR;
-            }
-            if (setopt && *val > 0 && ch->bundle.attributes.active_table_size == 0)
-            {
-                return BP_ERROR;
-            }
-            if (setopt)
+            if (ch->load_events == load_events)
             {
-                ch->bundle.attributes.timeout = *val;
+                status = bplib_os_waiton(ch->active_table_signal, timeout);
             }
             else
             {
-                *val = ch->bundle.attributes.timeout;
+                status = BP_SUCCESS;
             }
-            break;
         }
-        case BP_OPT_MAX_LENGTH:
+        bplib_os_unlock(ch->active_table_signal);
+
+        if (status != BP_SUCCESS)
         {
-            if (setopt && *val < 0)
-            {
-                return BP_ERROR;
-            }
-            if (setopt)
-            {
-                ch->bundle.attributes.max_length = *val;
-            }
-            else
-            {
-                *val = ch->bundle.attributes.max_length;
-            }
             break;
         }
-        case BP_OPT_DACS_RATE:
+    }
+
+    /*------------------------------*/
+    /* Load Bundle if Ready to Send */
+    /*------------------------------*/
+    if (object)
+    {
+        bp_bundle_data_t *data = (bp_bundle_data_t *)object->data;
+
+        /* Count Bundle Against Weight of Queue */
+        if (!isdacs && ch->cos_scheduling == BP_SCHEDULE_WEIGHTED)
         {
-            if (setopt)
+            bplib_os_lock(ch->active_table_signal);
             {
-                ch->dacs.attributes.dacs_rate = *val;
+                charge_queue(ch, queue);
             }
-            else
+            bplib_os_unlock(ch->active_table_signal);
+        }
+
+        /* Take Bundle out of Load Rates */
+        if (paced)
+        {
+            bplib_os_lock(ch->active_table_signal);
             {
-                *val = ch->dacs.attributes.dacs_rate;
+                pace_charge(ch, data->bundlesize, resend);
             }
-            break;
+            bplib_os_unlock(ch->active_table_signal);
         }
-        default:
+
+        /* Check Custody Transfer */
+        if (data->cteboffset != 0)
         {
-            /* Option Not Found */
-            return bplog(NULL, BP_FLAG_API_ERROR, "Config. Option Not Found (%d)\n", opt);
-        }
-    }
+            /* Save/Update Storage ID and Queue */
+            active_bundle.sid = object->header.sid;
+            active_bundle.cos = queue;
 
-    /* Re-initialize Bundles */
-    if (setopt)
-    {
-        ch->bundle.prebuilt = false;
-    }
+            /* Update Retransmit Time */
+            active_bundle.retx = msnow;
 
-    /* Return Status */
-    return BP_SUCCESS;
-}
+            /* Save Bundle as Active */
+            bplib_os_lock(ch->active_table_signal);
+            {
+                /* Assign New Custody ID */
+                if (newcid)
+                {
+                    active_bundle.cid = assign_custody_id(ch);
+                    bptrace3(assign_cid, ch, active_bundle.cid, active_bundle.sid);
+                }
 
-/*--------------------------------------------------------------------------------------
- * bplib_latchstats -
- *-------------------------------------------------------------------------------------*/
-int bplib_latchstats(bp_desc_t *desc, bp_stats_t *stats)
-{
-    /* Check Parameters */
-    if (desc == NULL)
-    {
-        return BP_ERROR;
-    }
-    else if (stats == NULL)
-    {
-        return BP_ERROR;
-    }
+                /* Start Retransmit Timer */
+                start_retx_timer(ch, &active_bundle);
 
-    /* Get Channel */
-    bp_channel_t *ch = &desc->channel;
+                /* Update Active Table */
+                status = ch->active_table.add(ch->active_table.table, active_bundle, !newcid);
+                if (status == BP_DUPLICATE)
+                {
+                    bplog(flags, BP_FLAG_DUPLICATES, "Duplicate bundle detected in active table, CID=%lu\n",
+                          (unsigned long)active_bundle.cid);
+                }
+                else if (status != BP_SUCCESS)
+                {
+                    bplog(NULL, BP_FLAG_DIAGNOSTIC, "Unexpected error adding bundle to active table: %d\n", status);
+                }
 
-    /* Update Store Counts */
-    ch->stats.stored_bundles  = ch->store.getcount(ch->bundle_handle);
-    ch->stats.stored_payloads = ch->store.getcount(ch->payload_handle);
-    ch->stats.stored_dacs     = ch->store.getcount(ch->dacs_handle);
+                /* Stop Timer of Bundle Not Added */
+                if (status != BP_SUCCESS)
+                {
+                    stop_retx_timer(ch, &active_bundle);
+                }
+            }
+            bplib_os_unlock(ch->active_table_signal);
 
-    /* Update Active Statistic */
-    ch->stats.active_bundles = ch->active_table.count(ch->active_table.table);
+            /* Jam Custody ID */
+            ch->proto->update_bundle(data, active_bundle.cid, flags);
+        }
 
-    /* Latch Statistics */
-    *stats = ch->stats;
+        /* Load Bundle */
+        *bundle = data->header;
+        if (size)
+            *size = data->bundlesize;
+
+        /* Update Statistics and Flags */
+        if (isdacs)
+        {
+            bptrace2(transmit_dacs, ch, data->bundlesize);
+            stats_add(&ch->stats.transmitted_dacs, 1);
+            bplog(flags, BP_FLAG_ROUTE_NEEDED, "DACS bundle needs routing\n");
+        }
+        else if (resend)
+        {
+            bptrace3(retransmit, ch, object->header.sid, data->bundlesize);
+            stats_add(&ch->stats.retransmitted_bundles, 1);
+        }
+        else /* new data bundle */
+        {
+            bptrace3(transmit, ch, object->header.sid, data->bundlesize);
+            stats_add(&ch->stats.transmitted_bundles, 1);
+            latency_stop(&ch->stats.store_to_load, data->enqtime);
+        }
+    }
 
-    /* Return Success */
-    return BP_SUCCESS;
+    /* Return Status */
+    return status;
 }
 
 /*--------------------------------------------------------------------------------------
- * bplib_store -
+ * load_batch_room - counts the new custody ids the active table can take for a batch
+ *  (active table lock must be held)
+ *
+ *  The run of custody ids following those already claimed is counted, so that no bundle is
+ *  dequeued from store without a place to put it; the retransmissions in the batch are
+ *  reinserted and so still occupy the table
  *-------------------------------------------------------------------------------------*/
-int bplib_store(bp_desc_t *desc, const void *payload, size_t size, int timeout, uint32_t *flags)
+BP_LOCAL_SCOPE int load_batch_room(bp_channel_t *ch, int count, int max, int ncids, int nresnd)
 {
-    int status = BP_SUCCESS;
+    int table_count = ch->active_table.count(ch->active_table.table) + nresnd;
+    int room        = 0;
 
-    /* Check Parameters */
-    if (desc == NULL)
-    {
-        return BP_ERROR;
-    }
-    else if (payload == NULL)
+    while ((count + room < max) && (table_count + room < ch->bundle.attributes.active_table_size) &&
+           (ch->active_table.available(ch->active_table.table, ch->current_active_cid + ncids + room) == BP_SUCCESS))
     {
-        return BP_ERROR;
-    }
-    else if (flags == NULL)
-    {
-        return BP_ERROR;
+        room++;
     }
 
-    /* Get Channel */
-    bp_channel_t *ch = &desc->channel;
+    return room;
+}
 
-    /* Check if Re-initialization Needed */
-    if (ch->bundle.prebuilt == false)
-    {
-        status = v6_populate_bundle(&ch->bundle, flags);
-    }
+/*--------------------------------------------------------------------------------------
+ * load_batch_stored - dequeues up to room unexpired bundles into a batch without waiting
+ *  (active table lock must be held, so the room counted is not claimed by another load)
+ *
+ *  Returns BP_SUCCESS, BP_TIMEOUT when the queue runs out first, or the storage service error
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int load_batch_stored(bp_channel_t *ch, bp_object_t **objects, bp_active_bundle_t *active_bundles,
+                                     bool *newcids, int *count, int room, unsigned long sysnow, bool unrelt,
+                                     uint32_t *flags)
+{
+    int i;
 
-    /* Send Bundle */
-    if (status == BP_SUCCESS)
+    while (room > 0)
     {
-        status = v6_send_bundle(&ch->bundle, payload, size, create_bundle, ch, timeout, flags);
+        /* Dequeue Bundles from Storage Service */
+        unsigned long deq_start  = latency_start();
+        int           first      = *count;
+        int           deq_status = dequeue_bundles(ch, BP_COS_NORMAL, &objects[first], room, BP_CHECK);
+        if (deq_status == BP_TIMEOUT)
+        {
+            /* No Bundles in Storage to Send */
+            return BP_TIMEOUT;
+        }
+        else if (deq_status <= 0)
+        {
+            /* Failed Storage Service */
+            return bplog(flags, BP_FLAG_STORE_FAILURE, "Failed (%d) to dequeue bundle from storage service\n",
+                         deq_status);
+        }
+        latency_stop(&ch->stats.dequeue, deq_start);
+
+        /* Keep Unexpired Bundles (compacted in place) */
+        for (i = 0; i < deq_status; i++)
+        {
+            bp_object_t      *object = objects[first + i];
+            bp_bundle_data_t *data   = (bp_bundle_data_t *)object->data;
+
+            /* Check Expiration Time */
+            if (ch->proto->is_expired(&ch->bundle, sysnow, data->exprtime, unrelt))
+            {
+                /* Bundle Expired Clear Entry (and loop again) */
+                bptrace2(expire, ch, object->header.sid);
+                ch->store.release(ch->bundle_handles[BP_COS_NORMAL], object->header.sid);
+                ch->store.relinquish(ch->bundle_handles[BP_COS_NORMAL], object->header.sid);
+                stats_add(&ch->stats.expired, 1);
+            }
+            else
+            {
+                objects[*count]              = object;
+                active_bundles[*count].sid   = BP_SID_VACANT;
+                active_bundles[*count].retx  = 0;
+                active_bundles[*count].cid   = 0;
+                active_bundles[*count].timer = TWHEEL_NULL_TIMER;
+                active_bundles[*count].cos   = BP_COS_NORMAL;
+                newcids[*count]              = true;
+                (*count)++;
+                room--;
+            }
+        }
     }
 
-    /* Return Status */
-    return status;
+    return BP_SUCCESS;
 }
 
 /*--------------------------------------------------------------------------------------
- * bplib_load -
+ * bplib_load_batch -
+ *
+ *  loads up to max bundles in a single call; the system time, DACS timer, and active
+ *  table are checked once for the whole batch and new custody IDs are assigned as a
+ *  contiguous run under a single lock.  Bundles are ordered the same as successive
+ *  calls to bplib_load would return them: DACS, then retransmissions, then new bundles.
+ *
+ *  returns the number of bundles loaded, or a return code if no bundle was loaded
  *-------------------------------------------------------------------------------------*/
-int bplib_load(bp_desc_t *desc, void **bundle, size_t *size, int timeout, uint32_t *flags)
+int bplib_load_batch(bp_desc_t *desc, void **bundles, size_t *sizes, int max, int timeout, uint32_t *flags)
 {
-    bp_active_bundle_t active_bundle = {BP_SID_VACANT, 0, 0};
-    int                status        = BP_SUCCESS; /* success or error code */
+    bp_object_t       *objects[BPLIB_MAX_LOAD_BATCH];
+    bp_active_bundle_t active_bundles[BPLIB_MAX_LOAD_BATCH];
+    bool               newcids[BPLIB_MAX_LOAD_BATCH];
+    int                count  = 0;          /* number of bundles loaded into batch */
+    int                ndacs  = 0;          /* number of dacs at start of batch */
+    int                nresnd = 0;          /* number of retransmissions following the dacs */
+    int                ncids  = 0;          /* number of new custody ids already claimed in batch */
+    int                room   = 0;          /* number of new custody ids the active table can accept */
+    int                status = BP_SUCCESS; /* success or error code */
+    int                i;
 
     /* Check Parameters */
     if (desc == NULL)
     {
         return BP_ERROR;
     }
-    else if (bundle == NULL)
+    else if (bundles == NULL)
     {
         return BP_ERROR;
     }
@@ -902,16 +4293,46 @@ int bplib_load(bp_desc_t *desc, void **bundle, size_t *size, int timeout, uint32
     {
         return BP_ERROR;
     }
+    else if (max <= 0)
+    {
+        return BP_ERROR;
+    }
+
+    /* Limit Batch Size */
+    if (max > BPLIB_MAX_LOAD_BATCH)
+    {
+        max = BPLIB_MAX_LOAD_BATCH;
+    }
 
     /* Get Channel */
     bp_channel_t *ch = &desc->channel;
 
+    /* Load Scheduled Queues, Paced Channels, and Direct Data Paths One Bundle at a Time */
+    bool paced = (ch->bundle.attributes.load_rate_bytes > 0) || (ch->bundle.attributes.load_rate_bundles > 0);
+    if (ch->cos_scheduling != BP_SCHEDULE_FIFO || paced || ch->proto->load)
+    {
+        while (count < max)
+        {
+            status = bplib_load(desc, &bundles[count], sizes ? &sizes[count] : NULL,
+                                count == 0 ? timeout : BP_CHECK, flags);
+            if (status != BP_SUCCESS)
+            {
+                break;
+            }
+            count++;
+        }
+
+        /* Error after Partial Batch - batch is returned, so the error is only logged */
+        if (count > 0 && status != BP_TIMEOUT && status != BP_SUCCESS)
+        {
+            bplog(flags, BP_FLAG_DIAGNOSTIC, "Load batch stopped after %d bundles (%d)\n", count, status);
+        }
+        return count > 0 ? count : status;
+    }
+
     /* Setup State */
-    unsigned long sysnow = 0;     /* current system time used for timeouts (seconds) */
-    bp_object_t  *object = NULL;  /* start out assuming nothing to send */
-    bool          newcid = true;  /* whether to assign new custody id and active table entry */
-    bool          resend = false; /* is loaded bundle a retransmission */
-    bool          isdacs = false; /* is loaded bundle a dacs */
+    unsigned long sysnow = 0;     /* current system time used for expiration (seconds) */
+    unsigned long msnow  = 0;     /* current monotonic time used for timeouts (milliseconds) */
     bool          unrelt = false; /* is time unreliable */
 
     /* Get Current Time */
@@ -920,241 +4341,273 @@ int bplib_load(bp_desc_t *desc, void **bundle, size_t *size, int timeout, uint32
         unrelt = true; /* time is unreliable */
         bplog(flags, BP_FLAG_UNRELIABLE_TIME, "Unreliable time detected: %ld\n", sysnow);
     }
+    bplib_os_monotime(&msnow);
 
-    /*-------------------------*/
-    /* Try to Send DACS Bundle */
-    /*-------------------------*/
-    if (ch->dacs.attributes.dacs_rate > 0)
+    /*--------------------------*/
+    /* Try to Send DACS Bundles */
+    /*--------------------------*/
+    check_dacs(ch, msnow, flags);
+
+    /* Dequeue any Stored DACS */
+    while (count < max)
     {
-        /* Check If DACS Ready to Send */
-        bplib_os_lock(ch->custody_tree_lock);
+        unsigned long start       = latency_start();
+        int           dacs_status = store_dequeue(ch, ch->dacs_handle, &objects[count], BP_CHECK);
+        if (dacs_status == BP_SUCCESS)
+        {
+            latency_stop(&ch->stats.dequeue, start);
+            active_bundles[count].sid   = BP_SID_VACANT;
+            active_bundles[count].retx  = 0;
+            active_bundles[count].cid   = 0;
+            active_bundles[count].timer = TWHEEL_NULL_TIMER;
+            active_bundles[count].cos   = BP_COS_NORMAL;
+            newcids[count]              = true;
+            count++;
+        }
+        else
         {
-            if ((sysnow >= (ch->dacs_last_sent + ch->dacs.attributes.dacs_rate)) &&
-                !rb_tree_is_empty(&ch->custody_tree))
+            if (dacs_status != BP_TIMEOUT)
             {
-                create_dacs(ch, sysnow, BP_CHECK, flags);
+                /* Failed Storage Service */
+                bplog(flags, BP_FLAG_STORE_FAILURE, "Failed (%d) to dequeue dacs bundle from storage service\n",
+                      dacs_status);
             }
+            break;
         }
-        bplib_os_unlock(ch->custody_tree_lock);
-    }
-
-    /* Dequeue any Stored DACS */
-    int dacs_status = ch->store.dequeue(ch->dacs_handle, &object, BP_CHECK);
-    if (dacs_status == BP_SUCCESS)
-    {
-        isdacs = true;
-    }
-    else if (dacs_status != BP_TIMEOUT)
-    {
-        /* Failed Storage Service */
-        bplog(flags, BP_FLAG_STORE_FAILURE, "Failed (%d) to dequeue dacs bundle from storage service\n", dacs_status);
     }
+    ndacs = count;
 
-    /*------------------------------------------------*/
-    /* Try to Send Active Bundle (if nothing to send) */
-    /*------------------------------------------------*/
+    /*-------------------------------------------------------------------------*/
+    /* Try to Send Active then Stored Bundles (if room left in batch)           */
+    /* The active table stays locked from counting its room until the bundles  */
+    /* dequeued into that room are added, so no other load can claim the room  */
+    /*-------------------------------------------------------------------------*/
     bplib_os_lock(ch->active_table_signal);
     {
-        /* Get Oldest Bundle */
-        while (object == NULL && ch->active_table.next(ch->active_table.table, &active_bundle) == BP_SUCCESS)
+        bp_active_bundle_t active_bundle;
+        bp_object_t       *object;
+
+        /* Get Earliest Timed Out Bundles */
+        while (count < max && (object = retransmit_bundle(ch, BP_COS_NORMAL, msnow, sysnow, unrelt, &active_bundle,
+                                                          flags)) != NULL)
         {
-            /* Check if Bundle has Timed Out */
-            if (ch->bundle.attributes.timeout != 0 && sysnow >= (active_bundle.retx + ch->bundle.attributes.timeout))
+            objects[count]        = object;
+            active_bundles[count] = active_bundle;
+            newcids[count]        = !ch->bundle.attributes.cid_reuse;
+            count++;
+
+            /* Reinserted below at a New CID (unless reused) */
+            if (!ch->bundle.attributes.cid_reuse)
             {
-                /* Retrieve Timed Out Bundle from Storage */
-                if (ch->store.retrieve(ch->bundle_handle, active_bundle.sid, &object, BP_CHECK) == BP_SUCCESS)
-                {
-                    bp_bundle_data_t *data = (bp_bundle_data_t *)object->data;
+                ncids++;
+            }
+        }
+        nresnd = count - ndacs;
 
-                    /* Check Lifetime of Bundle */
-                    if (v6_is_expired(&ch->bundle, sysnow, data->exprtime, unrelt))
-                    {
-                        /* Bundle Expired (bundle deleted below) */
-                        object = NULL;
-                        ch->stats.expired++;
-                    }
-                }
-                else
+        /* Dequeue Stored Bundles into Room Left in Batch and Active Table */
+        room   = load_batch_room(ch, count, max, ncids, nresnd);
+        status = load_batch_stored(ch, objects, active_bundles, newcids, &count, room, sysnow, unrelt, flags);
+
+        /* Wait if Nothing Else to Send */
+        if (count == 0 && (status == BP_SUCCESS || status == BP_TIMEOUT))
+        {
+            if (room == 0)
+            {
+                /* Woken when Acknowledgments Make Room */
+                bplog(flags, BP_FLAG_ACTIVE_TABLE_WRAP, "No more room in active table for bundles\n");
+                status = bplib_os_waiton(ch->active_table_signal, timeout);
+            }
+            else if (timeout != BP_CHECK)
+            {
+                /* Woken by bundle_stored - counted as a waiter first, so that a bundle stored before
+                 * then is found by checking the store again and one stored after wakes the wait */
+                __atomic_add_fetch(&ch->load_waiters, 1, __ATOMIC_RELAXED);
+                __atomic_thread_fence(__ATOMIC_SEQ_CST);
+                status = load_batch_stored(ch, objects, active_bundles, newcids, &count, room, sysnow, unrelt, flags);
+                if (count == 0 && status == BP_TIMEOUT)
                 {
-                    /* Failed to Retrieve Bundle from Storage */
-                    bplog(flags, BP_FLAG_STORE_FAILURE, "Failed to retrieve timed-out bundle\n");
-                    ch->stats.lost++;
+                    status = bplib_os_waiton(ch->active_table_signal, timeout);
                 }
+                __atomic_sub_fetch(&ch->load_waiters, 1, __ATOMIC_RELAXED);
+            }
 
-                /* Check Success of Retrieving Valid Timed Out Bundle */
-                if (object)
-                {
-                    /* Bundle is a Retransmission */
-                    resend = true;
+            /* Recheck Once (see bplib_load) - another thread can claim what woke the wait */
+            if (count == 0 && status == BP_SUCCESS)
+            {
+                room   = load_batch_room(ch, count, max, ncids, nresnd);
+                status = load_batch_stored(ch, objects, active_bundles, newcids, &count, room, sysnow, unrelt, flags);
+            }
+        }
 
-                    /* Handle Active Table and Custody ID */
-                    if (ch->bundle.attributes.cid_reuse)
-                    {
-                        /* Set flag to reuse custody id and active table entry,
-                         * active table entry is not cleared, since CID is being reused */
-                        newcid = false;
-                    }
-                    else
-                    {
-                        /* Clear Entry (it will be reinserted below at the current CID) */
-                        ch->active_table.remove(ch->active_table.table, active_bundle.cid, NULL);
+        /* Save Custody Bundles as Active */
+        for (i = 0; i < count; i++)
+        {
+            bp_bundle_data_t *data = (bp_bundle_data_t *)objects[i]->data;
 
-                        /* Move to Next Oldest */
-                        ch->active_table.next(ch->active_table.table, NULL);
-                    }
+            /* Check Custody Transfer */
+            if (data->cteboffset != 0)
+            {
+                /* Save/Update Storage ID and Retransmit Time */
+                active_bundles[i].sid  = objects[i]->header.sid;
+                active_bundles[i].retx = msnow;
+
+                /* Assign New Custody ID */
+                if (newcids[i])
+                {
+                    active_bundles[i].cid = assign_custody_id(ch);
+                    bptrace3(assign_cid, ch, active_bundles[i].cid, active_bundles[i].sid);
                 }
-                else
+
+                /* Start Retransmit Timer */
+                start_retx_timer(ch, &active_bundles[i]);
+
+                /* Update Active Table */
+                int add_status = ch->active_table.add(ch->active_table.table, active_bundles[i], !newcids[i]);
+                if (add_status == BP_DUPLICATE)
                 {
-                    /* Clear Entry in Active Table and Storage
-                     *  - when the retrieval of the bundle failed above OR
-                     *  - when the retrieved bundle has expired */
-                    ch->active_table.remove(ch->active_table.table, active_bundle.cid, NULL);
-                    ch->store.release(ch->bundle_handle, active_bundle.sid);
-                    ch->store.relinquish(ch->bundle_handle, active_bundle.sid);
+                    bplog(flags, BP_FLAG_DUPLICATES, "Duplicate bundle detected in active table, CID=%lu\n",
+                          (unsigned long)active_bundles[i].cid);
                 }
-            }
-            else /* oldest active bundle still active */
-            {
-                /* Check Active Table Has Room
-                 * Since next step is to dequeue from store, need to make sure that there is room
-                 * in the active table since we don't want to dequeue a bundle from store and have
-                 * no place to put it.  Note that it is possible that even if the active table was
-                 * full, if the bundle dequeued did not request custody transfer it could still go
-                 * out, but the current design requires that at least one slot in the active table
-                 * is open at all times regardless if the bundle is requesting custody. */
-                status = ch->active_table.available(ch->active_table.table, ch->current_active_cid);
-                if (status != BP_SUCCESS)
+                else if (add_status != BP_SUCCESS)
                 {
-                    bplog(flags, BP_FLAG_ACTIVE_TABLE_WRAP, "No more room in active table for bundles\n");
-                    status = bplib_os_waiton(ch->active_table_signal, timeout);
-                    if (status == BP_SUCCESS)
-                    {
-                        /* Recheck Table Availability
-                         * The conditional active_table_signal can notify that the table has space but
-                         * another thread could claim the space before this current context is able to proceed;
-                         * therefore the check for room in the table must be remade. Furthermore, the check
-                         * is only made once as we don't want to stay trapped inside this function; as such
-                         * any failed check is overwritten to be a TIMEOUT. */
-                        status = ch->active_table.available(ch->active_table.table, ch->current_active_cid);
-                        if (status != BP_SUCCESS)
-                        {
-                            status = BP_TIMEOUT;
-                        }
-                    }
+                    bplog(NULL, BP_FLAG_DIAGNOSTIC, "Unexpected error adding bundle to active table: %d\n",
+                          add_status);
                 }
 
-                /* Break Out of Loop */
-                break;
+                /* Stop Timer of Bundle Not Added */
+                if (add_status != BP_SUCCESS)
+                {
+                    stop_retx_timer(ch, &active_bundles[i]);
+                }
             }
         }
     }
     bplib_os_unlock(ch->active_table_signal);
 
-    /*------------------------------------------------*/
-    /* Try to Send Stored Bundle (if nothing to send) */
-    /*------------------------------------------------*/
-    while (object == NULL && status == BP_SUCCESS)
+    /* Check for Empty Batch (room that was found taken is a timeout) */
+    if (count == 0)
+    {
+        return status == BP_SUCCESS ? BP_TIMEOUT : status;
+    }
+
+    /*-------------------------------*/
+    /* Load Bundles and Update Stats */
+    /*-------------------------------*/
+    for (i = 0; i < count; i++)
     {
-        /* Dequeue Bundle from Storage Service */
-        int deq_status = ch->store.dequeue(ch->bundle_handle, &object, timeout);
-        if (deq_status == BP_SUCCESS)
+        bp_bundle_data_t *data = (bp_bundle_data_t *)objects[i]->data;
+
+        /* Jam Custody ID */
+        if (data->cteboffset != 0)
         {
-            bp_bundle_data_t *data = (bp_bundle_data_t *)object->data;
+            ch->proto->update_bundle(data, active_bundles[i].cid, flags);
+        }
 
-            /* Check Expiration Time */
-            if (v6_is_expired(&ch->bundle, sysnow, data->exprtime, unrelt))
-            {
-                /* Bundle Expired Clear Entry (and loop again) */
-                ch->store.release(ch->bundle_handle, object->header.sid);
-                ch->store.relinquish(ch->bundle_handle, object->header.sid);
-                ch->stats.expired++;
-                object = NULL;
-            }
+        /* Load Bundle */
+        bundles[i] = data->header;
+        if (sizes)
+            sizes[i] = data->bundlesize;
+
+        /* Update Statistics and Flags */
+        if (i < ndacs)
+        {
+            bptrace2(transmit_dacs, ch, data->bundlesize);
+            stats_add(&ch->stats.transmitted_dacs, 1);
+            bplog(flags, BP_FLAG_ROUTE_NEEDED, "DACS bundle needs routing\n");
         }
-        else if (deq_status == BP_TIMEOUT)
+        else if (i < ndacs + nresnd)
         {
-            /* No Bundles in Storage to Send */
-            status = BP_TIMEOUT;
+            bptrace3(retransmit, ch, objects[i]->header.sid, data->bundlesize);
+            stats_add(&ch->stats.retransmitted_bundles, 1);
         }
-        else
+        else /* new data bundle */
         {
-            /* Failed Storage Service */
-            status =
-                bplog(flags, BP_FLAG_STORE_FAILURE, "Failed (%d) to dequeue bundle from storage service\n", deq_status);
+            bptrace3(transmit, ch, objects[i]->header.sid, data->bundlesize);
+            stats_add(&ch->stats.transmitted_bundles, 1);
+            latency_stop(&ch->stats.store_to_load, data->enqtime);
         }
     }
 
-    /*------------------------------*/
-    /* Load Bundle if Ready to Send */
-    /*------------------------------*/
-    if (object)
+    /* Return Number of Bundles Loaded */
+    return count;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_process -
+ *-------------------------------------------------------------------------------------*/
+int bplib_process(bp_desc_t *desc, const void *bundle, size_t size, int timeout, uint32_t *flags)
+{
+    int status;
+
+    /* Check Parameters */
+    if (desc == NULL)
     {
-        bp_bundle_data_t *data = (bp_bundle_data_t *)object->data;
+        return BP_ERROR;
+    }
+    else if (bundle == NULL)
+    {
+        return BP_ERROR;
+    }
+    else if (flags == NULL)
+    {
+        return BP_ERROR;
+    }
 
-        /* Check Custody Transfer */
-        if (data->cteboffset != 0)
+    /* Get Channel */
+    bp_channel_t *ch = &desc->channel;
+
+    /* Direct Data Path */
+    if (ch->proto->process)
+    {
+        status = ch->proto->process(&ch->bundle, bundle, size, timeout, flags);
+        if (status == BP_SUCCESS)
         {
-            /* Save/Update Storage ID */
-            active_bundle.sid = object->header.sid;
+            stats_add(&ch->stats.received_bundles, 1);
+        }
+        return status;
+    }
 
-            /* Update Retransmit Time */
-            active_bundle.retx = sysnow;
+    /* Receive Bundle */
+    bp_payload_t payload;
+    bool         custody_transfer = false;
+    status = receive_bundle(ch, bundle, size, timeout, false, &payload, &custody_transfer, flags);
+    if (status == BP_PENDING_ACKNOWLEDGMENT) /* received bundle is a DACS */
+    {
+        /* Process Aggregate Custody Signal (DACS) */
+        bplib_os_lock(ch->active_table_signal);
+        {
+            int num_acks = 0;
+            status       = receive_acknowledgment(ch, &payload, &num_acks, flags);
 
-            /* Save Bundle as Active */
-            bplib_os_lock(ch->active_table_signal);
+            /* Signal Active Table */
+            if (num_acks > 0)
             {
-                /* Assign New Custody ID */
-                if (newcid)
-                {
-#if BPLIB_GLOBAL_CUSTODY_ID
-                    bplib_os_lock(bplib_custody_id_mutex);
-                    {
-                        active_bundle.cid      = bplib_global_custody_id++;
-                        ch->current_active_cid = bplib_global_custody_id;
-                    }
-                    bplib_os_unlock(bplib_custody_id_mutex);
-#else
-                    active_bundle.cid = ch->current_active_cid++;
-#endif
-                }
+                ch->load_events++;
+                bplib_os_signal(ch->active_table_signal);
 
-                /* Update Active Table */
-                status = ch->active_table.add(ch->active_table.table, active_bundle, !newcid);
-                if (status == BP_DUPLICATE)
-                {
-                    bplog(flags, BP_FLAG_DUPLICATES, "Duplicate bundle detected in active table, CID=%lu\n",
-                          (unsigned long)active_bundle.cid);
-                }
-                else if (status != BP_SUCCESS)
+                /* Freed Room in Active Table for Bundles Waiting in Storage */
+                if (stored_bundles(ch) > 0)
                 {
-                    bplog(NULL, BP_FLAG_DIAGNOSTIC, "Unexpected error adding bundle to active table: %d\n", status);
+                    bplib_os_setevent(ch->ready_event);
                 }
             }
-            bplib_os_unlock(ch->active_table_signal);
-
-            /* Jam Custody ID */
-            v6_update_bundle(data, active_bundle.cid, flags);
         }
+        bplib_os_unlock(ch->active_table_signal);
+    }
 
-        /* Load Bundle */
-        *bundle = data->header;
-        if (size)
-            *size = data->bundlesize;
+    /* Acknowledge Custody Transfer - Update DACS */
+    if (custody_transfer)
+    {
+        /* Get Time - only used for keeping track of when the dacs is sent */
+        unsigned long msnow = 0;
+        bplib_os_monotime(&msnow);
 
-        /* Update Statistics and Flags */
-        if (isdacs)
-        {
-            ch->stats.transmitted_dacs++;
-            bplog(flags, BP_FLAG_ROUTE_NEEDED, "DACS bundle needs routing\n");
-        }
-        else if (resend)
-        {
-            ch->stats.retransmitted_bundles++;
-        }
-        else /* new data bundle */
+        /* Take Custody */
+        bplib_os_mutex_lock(&ch->custody_tree_lock);
         {
-            ch->stats.transmitted_bundles++;
+            take_custody(ch, &payload, msnow, flags);
         }
+        bplib_os_mutex_unlock(&ch->custody_tree_lock);
     }
 
     /* Return Status */
@@ -1162,18 +4615,37 @@ int bplib_load(bp_desc_t *desc, void **bundle, size_t *size, int timeout, uint32
 }
 
 /*--------------------------------------------------------------------------------------
- * bplib_process -
+ * bplib_process_batch -
+ *
+ *  processes an array of received bundles; all bundles are decoded first, then the
+ *  accepted payloads are stored with a single storage service call and the custody
+ *  signals and custody transfers of the batch are each applied under a single lock.
+ *  The bundle buffers must remain valid until the function returns.
+ *
+ *  returns the number of bundles successfully processed, or error code
  *-------------------------------------------------------------------------------------*/
-int bplib_process(bp_desc_t *desc, const void *bundle, size_t size, int timeout, uint32_t *flags)
+int bplib_process_batch(bp_desc_t *desc, const void **bundles, const size_t *sizes, int count, int timeout,
+                        uint32_t *flags)
 {
-    int status;
+    bp_payload_t   payloads[BPLIB_MAX_PROCESS_BATCH];
+    int            statuses[BPLIB_MAX_PROCESS_BATCH];
+    bool           custody[BPLIB_MAX_PROCESS_BATCH];
+    bp_store_vec_t vecs[BPLIB_MAX_PROCESS_BATCH];
+    int            accepted[BPLIB_MAX_PROCESS_BATCH];
+    int            processed = 0;
+    int            base;
+    int            i;
 
     /* Check Parameters */
     if (desc == NULL)
     {
         return BP_ERROR;
     }
-    else if (bundle == NULL)
+    else if (bundles == NULL)
+    {
+        return BP_ERROR;
+    }
+    else if (sizes == NULL)
     {
         return BP_ERROR;
     }
@@ -1181,165 +4653,175 @@ int bplib_process(bp_desc_t *desc, const void *bundle, size_t size, int timeout,
     {
         return BP_ERROR;
     }
+    else if (count < 0)
+    {
+        return BP_ERROR;
+    }
 
     /* Get Channel */
     bp_channel_t *ch = &desc->channel;
 
-    /* Receive Bundle */
-    bp_payload_t payload;
-    bool         custody_transfer = false;
-    status                        = v6_receive_bundle(&ch->bundle, bundle, size, &payload, flags);
-    if (status == BP_PENDING_EXPIRATION) /* received bundle is expired */
+    /* Direct Data Path - process one bundle at a time */
+    if (ch->proto->process)
     {
-        ch->stats.expired++;
+        for (i = 0; i < count; i++)
+        {
+            if (bplib_process(desc, bundles[i], sizes[i], timeout, flags) == BP_SUCCESS)
+            {
+                processed++;
+            }
+        }
+        return processed;
     }
-    else if (status == BP_PENDING_ACKNOWLEDGMENT) /* received bundle is a DACS */
-    {
-        /* Increment Statistics */
-        ch->stats.received_dacs++;
 
-        /* Process Aggregate Custody Signal (DACS) */
-        bplib_os_lock(ch->active_table_signal);
+    /* Process Bundles in Chunks */
+    for (base = 0; base < count; base += BPLIB_MAX_PROCESS_BATCH)
+    {
+        int  num_bundles = (count - base) < BPLIB_MAX_PROCESS_BATCH ? (count - base) : BPLIB_MAX_PROCESS_BATCH;
+        bool any_dacs     = false;
+        bool any_custody  = false;
+        bool any_stored   = false;
+        int  num_accepted = 0;
+
+        /* Receive Bundles */
+        for (i = 0; i < num_bundles; i++)
         {
-            int num_acks   = 0;
-            int bytes_read = v6_receive_acknowledgment(payload.memptr, payload.data.payloadsize, &num_acks,
-                                                       delete_bundle, ch, flags);
-            ch->stats.acknowledged_bundles += num_acks;
-
-            /* Signal Active Table */
-            if (num_acks > 0)
+            custody[i] = false;
+            if (bundles[base + i] == NULL)
             {
-                bplib_os_signal(ch->active_table_signal);
+                statuses[i] = BP_ERROR;
+                continue;
             }
 
-            /* Set Status */
-            if (bytes_read > 0)
+            statuses[i] = receive_bundle(ch, bundles[base + i], sizes[base + i], timeout, true, &payloads[i],
+                                         &custody[i], flags);
+            if (statuses[i] == BP_PENDING_ACKNOWLEDGMENT)
             {
-                status = BP_SUCCESS;
+                any_dacs = true;
             }
-            else
+            else if (statuses[i] == BP_PENDING_ACCEPTANCE)
             {
-                status = bytes_read; /* Error Code */
+                vecs[num_accepted].data1      = &payloads[i].data;
+                vecs[num_accepted].data1_size = sizeof(bp_payload_data_t);
+                vecs[num_accepted].data2      = payloads[i].memptr;
+                vecs[num_accepted].data2_size = payloads[i].data.payloadsize;
+                accepted[num_accepted++]      = i;
+            }
+            else if (custody[i])
+            {
+                any_custody = true;
             }
-        }
-        bplib_os_unlock(ch->active_table_signal);
-    }
-    else if (status == BP_PENDING_ACCEPTANCE) /* received bundle is a payload for local node.service */
-    {
-        /* Increment Statistics */
-        ch->stats.received_bundles++;
-
-        /* Store Payload */
-        status = ch->store.enqueue(ch->payload_handle, &payload.data, sizeof(bp_payload_data_t), payload.memptr,
-                                   payload.data.payloadsize, timeout);
-        if (status == BP_SUCCESS && payload.node != BP_IPN_NULL)
-        {
-            custody_transfer = true;
-        }
-        else if (status != BP_SUCCESS)
-        {
-            bplog(flags, BP_FLAG_STORE_FAILURE, "Failed (%d) to store payload\n", status);
-            ch->stats.lost++;
-        }
-    }
-    else if (status == BP_PENDING_FORWARD) /* received bundle is for another node */
-    {
-        /* Increment Statistics */
-        ch->stats.forwarded_bundles++;
-
-        /* Store Forwarded Bundle */
-        status =
-            v6_send_bundle(&ch->bundle, payload.memptr, payload.data.payloadsize, create_bundle, ch, timeout, flags);
-        if (status == BP_SUCCESS && payload.node != BP_IPN_NULL)
-        {
-            custody_transfer = true;
-        }
-        else if (status != BP_SUCCESS)
-        {
-            ch->stats.lost++;
-        }
-    }
-    else
-    {
-        /* Increment Statistics */
-        ch->stats.unrecognized++;
-    }
-
-    /* Acknowledge Custody Transfer - Update DACS */
-    if (custody_transfer)
-    {
-        /* Get Time */
-        unsigned long sysnow = 0;
-        if (bplib_os_systime(&sysnow) == BP_ERROR)
-        {
-            /* Other than raise the flag, no further action is taken;
-             * the use of sysnow in the create_dacs function calls below
-             * are only for keeping track of when the dacs is sent and
-             * do not make their way into the bundle creation time. */
-            bplog(flags, BP_FLAG_UNRELIABLE_TIME, "Unreliable time detected: %ld\n", sysnow);
         }
 
-        /* Take Custody */
-        bplib_os_lock(ch->custody_tree_lock);
+        /* Store Accepted Payloads */
+        if (num_accepted > 0)
         {
-            if (ch->dacs.route.destination_node == payload.node &&
-                ch->dacs.route.destination_service == payload.service)
+            int stored = 0;
+            while (stored < num_accepted)
             {
-                /* Insert Custody ID directly into current custody_tree */
-                int insert_status = rb_tree_insert(payload.cid, &ch->custody_tree);
-                if (insert_status == BP_FULL)
+                unsigned long start  = latency_start();
+                int           status = store_enqueue_batch(ch, ch->payload_handle, &vecs[stored],
+                                                           num_accepted - stored, timeout);
+                latency_stop(&ch->stats.enqueue, start);
+                if (status > 0)
                 {
-                    /* Flag Full Tree - possibly the custody_tree size is configured to be too small */
-                    bplog(flags, BP_FLAG_CUSTODY_FULL, "Generating DACS because no more room to track custody\n");
-
-                    /* Store Custody Signal */
-                    create_dacs(ch, sysnow, BP_CHECK, flags);
-
-                    /* Start New DACS */
-                    insert_status = rb_tree_insert(payload.cid, &ch->custody_tree);
-
-                    /* There is no valid reason for an insert to fail on an empty custody_tree */
-                    assert(insert_status == BP_SUCCESS);
+                    while (status-- > 0)
+                    {
+                        statuses[accepted[stored++]] = BP_SUCCESS;
+                    }
+                }
+                else
+                {
+                    /* Payload Not Stored - Continue with Remaining Payloads */
+                    statuses[accepted[stored++]] = status;
                 }
-                else if (insert_status == BP_DUPLICATE)
+            }
+
+            for (i = 0; i < num_accepted; i++)
+            {
+                int k = accepted[i];
+                store_payload_result(ch, &payloads[k], statuses[k], &custody[k], flags);
+                if (custody[k])
                 {
-                    /* Duplicate values are fine and are treated as a success */
-                    bplog(flags, BP_FLAG_DUPLICATES, "Same bundle received multiple times\n");
+                    any_custody = true;
                 }
-                else if (insert_status != BP_SUCCESS)
+                if (statuses[k] == BP_SUCCESS)
                 {
-                    /* Tree error unexpected */
-                    bplog(NULL, BP_FLAG_DIAGNOSTIC, "Unexpected error saving custody information: %d\n", insert_status);
+                    any_stored = true;
                 }
             }
-            else
+
+            if (any_stored)
+            {
+                bplib_os_setevent(ch->ready_event);
+            }
+        }
+
+        /* Process Aggregate Custody Signals (DACS) */
+        if (any_dacs)
+        {
+            bplib_os_lock(ch->active_table_signal);
             {
-                /* Store DACS Bundle */
-                if (!rb_tree_is_empty(&ch->custody_tree))
+                int total_acks = 0;
+                for (i = 0; i < num_bundles; i++)
+                {
+                    if (statuses[i] == BP_PENDING_ACKNOWLEDGMENT)
+                    {
+                        int num_acks = 0;
+                        statuses[i]  = receive_acknowledgment(ch, &payloads[i], &num_acks, flags);
+                        total_acks += num_acks;
+                    }
+                }
+
+                /* Signal Active Table */
+                if (total_acks > 0)
                 {
-                    create_dacs(ch, sysnow, BP_CHECK, flags);
+                    ch->load_events++;
+                    bplib_os_signal(ch->active_table_signal);
+
+                    /* Freed Room in Active Table for Bundles Waiting in Storage */
+                    if (stored_bundles(ch) > 0)
+                    {
+                        bplib_os_setevent(ch->ready_event);
+                    }
                 }
+            }
+            bplib_os_unlock(ch->active_table_signal);
+        }
 
-                /* Initial New DACS Bundle */
-                ch->dacs.route.destination_node    = payload.node;
-                ch->dacs.route.destination_service = payload.service;
-                ch->dacs.prebuilt                  = false;
+        /* Acknowledge Custody Transfers - Update DACS */
+        if (any_custody)
+        {
+            /* Get Time (see bplib_process) */
+            unsigned long msnow = 0;
+            bplib_os_monotime(&msnow);
 
-                /* Start New DACS */
-                int insert_status = rb_tree_insert(payload.cid, &ch->custody_tree);
-                if (insert_status != BP_SUCCESS)
+            /* Take Custody */
+            bplib_os_mutex_lock(&ch->custody_tree_lock);
+            {
+                for (i = 0; i < num_bundles; i++)
                 {
-                    /* There is no valid reason for an insert to fail on an empty custody_tree */
-                    bplog(NULL, BP_FLAG_DIAGNOSTIC, "Unexpected error encountered on empty custody tree: %d\n",
-                          insert_status);
+                    if (custody[i])
+                    {
+                        take_custody(ch, &payloads[i], msnow, flags);
+                    }
                 }
             }
+            bplib_os_mutex_unlock(&ch->custody_tree_lock);
+        }
+
+        /* Count Successfully Processed Bundles */
+        for (i = 0; i < num_bundles; i++)
+        {
+            if (statuses[i] == BP_SUCCESS)
+            {
+                processed++;
+            }
         }
-        bplib_os_unlock(ch->custody_tree_lock);
     }
 
-    /* Return Status */
-    return status;
+    /* Return Number of Bundles Processed */
+    return processed;
 }
 
 /*--------------------------------------------------------------------------------------
@@ -1369,13 +4851,26 @@ int bplib_accept(bp_desc_t *desc, void **payload, size_t *size, int timeout, uin
     /* Get Channel */
     bp_channel_t *ch = &desc->channel;
 
+    /* Direct Data Path */
+    if (ch->proto->accept)
+    {
+        status = ch->proto->accept(&ch->bundle, payload, size, timeout, flags);
+        if (status == BP_SUCCESS)
+        {
+            stats_add(&ch->stats.delivered_payloads, 1);
+        }
+        return status;
+    }
+
     while (object == NULL && status == BP_SUCCESS)
     {
         /* Dequeue Payload from Storage */
-        status = ch->store.dequeue(ch->payload_handle, &object, timeout);
+        unsigned long deq_start = latency_start();
+        status                  = store_dequeue(ch, ch->payload_handle, &object, timeout);
         if (status == BP_SUCCESS)
         {
             bp_payload_data_t *data = (bp_payload_data_t *)object->data;
+            latency_stop(&ch->stats.dequeue, deq_start);
 
             /* Get Current Time */
             unsigned long sysnow = 0;
@@ -1387,16 +4882,23 @@ int bplib_accept(bp_desc_t *desc, void **payload, size_t *size, int timeout, uin
             }
 
             /* Check Expiration Time */
-            if (v6_is_expired(&ch->bundle, sysnow, data->exprtime, unrelt))
+            if (ch->proto->is_expired(&ch->bundle, sysnow, data->exprtime, unrelt))
             {
+                bptrace2(expire, ch, object->header.sid);
                 ch->store.release(ch->payload_handle, object->header.sid);
                 ch->store.relinquish(ch->payload_handle, object->header.sid);
-                ch->stats.expired++;
+                stats_add(&ch->stats.expired, 1);
                 object = NULL;
             }
+            else if (data->compressor != 0 && (object = decompress_payload(ch, object, flags)) == NULL)
+            {
+                /* Drop Payload that cannot be Decompressed */
+                stats_add(&ch->stats.lost, 1);
+            }
             else
             {
                 /* Return Payload to Application */
+                data = (bp_payload_data_t *)object->data;
                 *payload = (void *)((uint8_t *)data + sizeof(bp_payload_data_t));
                 if (size)
                 {
@@ -1410,7 +4912,7 @@ int bplib_accept(bp_desc_t *desc, void **payload, size_t *size, int timeout, uin
                 }
 
                 /* Count as Delivered */
-                ch->stats.delivered_payloads++;
+                stats_add(&ch->stats.delivered_payloads, 1);
             }
         }
         else if (status != BP_TIMEOUT)
@@ -1441,8 +4943,14 @@ int bplib_ackbundle(bp_desc_t *desc, const void *bundle)
         return BP_ERROR;
     }
 
+    /* Direct Data Path */
+    bp_channel_t *ch = &desc->channel;
+    if (ch->proto->ackbundle)
+    {
+        return ch->proto->ackbundle(&ch->bundle, bundle);
+    }
+
     /* Determine Storage Object Pointer */
-    bp_channel_t           *ch = &desc->channel;
     const bp_bundle_data_t *data =
         (const bp_bundle_data_t *)((const uint8_t *)bundle - offsetof(bp_bundle_data_t, header));
     const bp_object_t *object = (const bp_object_t *)((const uint8_t *)data - sizeof(bp_object_hdr_t));
@@ -1475,11 +4983,25 @@ int bplib_ackpayload(bp_desc_t *desc, const void *payload)
         return BP_ERROR;
     }
 
+    /* Direct Data Path */
+    bp_channel_t *ch = &desc->channel;
+    if (ch->proto->ackpayload)
+    {
+        return ch->proto->ackpayload(&ch->bundle, payload);
+    }
+
     /* Determine Storage Object Pointer */
-    bp_channel_t            *ch     = &desc->channel;
     const bp_payload_data_t *data   = (const bp_payload_data_t *)((const uint8_t *)payload - sizeof(bp_payload_data_t));
     const bp_object_t       *object = (const bp_object_t *)((const uint8_t *)data - sizeof(bp_object_hdr_t));
 
+    /* Free Decompressed Copy (stored object already released by decompress_payload) */
+    if (data->decompressed)
+    {
+        ch->store.relinquish(object->header.handle, object->header.sid);
+        bplib_os_free((void *)object);
+        return status;
+    }
+
     /* Release Memory */
     ch->store.release(object->header.handle, object->header.sid);
 
@@ -1501,7 +5023,192 @@ int bplib_ackpayload(bp_desc_t *desc, const void *payload)
  *-------------------------------------------------------------------------------------*/
 int bplib_routeinfo(const void *bundle, size_t size, bp_route_t *route)
 {
-    return v6_routeinfo(bundle, size, route);
+    const bp_protocol_t *proto = recognize_protocol(bundle, size);
+    if (proto == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    return proto->routeinfo(bundle, size, route);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_addroute -
+ *
+ *  desc -                  channel that bundles destined to the ranges are dispatched to [INPUT]
+ *  first_node, last_node - inclusive range of destination nodes [INPUT]
+ *  first_service, last_service - inclusive range of destination services [INPUT]
+ *  Returns:                BP_SUCCESS or error code
+ *
+ *  When the ranges of several rules hold a destination, the rule with the narrowest
+ *  node range is used, then the one with the narrowest service range, then the one
+ *  added first - so a rule for a single endpoint overrides a rule for its node, which
+ *  overrides a rule for a block of nodes.
+ *-------------------------------------------------------------------------------------*/
+int bplib_addroute(bp_desc_t *desc, bp_ipn_t first_node, bp_ipn_t last_node, bp_ipn_t first_service,
+                   bp_ipn_t last_service)
+{
+    int status = BP_SUCCESS;
+
+    /* Check Parameters */
+    if (desc == NULL)
+    {
+        return BP_ERROR;
+    }
+    else if (first_node > last_node || first_service > last_service)
+    {
+        return bplog(NULL, BP_FLAG_API_ERROR, "Invalid route ranges: %lu-%lu.%lu-%lu\n", (unsigned long)first_node,
+                     (unsigned long)last_node, (unsigned long)first_service, (unsigned long)last_service);
+    }
+
+    bplib_os_mutex_lock(&bplib_route_table_lock);
+    {
+        if (bplib_num_routes >= BPLIB_MAX_ROUTES)
+        {
+            status = bplog(NULL, BP_FLAG_API_ERROR, "Routing table full (%d rules)\n", BPLIB_MAX_ROUTES);
+        }
+        else
+        {
+            bp_ipn_t nodes    = last_node - first_node;
+            bp_ipn_t services = last_service - first_service;
+            int      i        = bplib_num_routes;
+
+            /* Insert after Rules with Ranges as Narrow */
+            while (i > 0)
+            {
+                bp_route_rule_t *prev          = &bplib_route_table[i - 1];
+                bp_ipn_t         prev_nodes    = prev->last_node - prev->first_node;
+                bp_ipn_t         prev_services = prev->last_service - prev->first_service;
+                if (prev_nodes < nodes || (prev_nodes == nodes && prev_services <= services))
+                {
+                    break;
+                }
+                bplib_route_table[i] = *prev;
+                i--;
+            }
+
+            bplib_route_table[i].first_node    = first_node;
+            bplib_route_table[i].last_node     = last_node;
+            bplib_route_table[i].first_service = first_service;
+            bplib_route_table[i].last_service  = last_service;
+            bplib_route_table[i].desc          = desc;
+            bplib_num_routes++;
+        }
+    }
+    bplib_os_mutex_unlock(&bplib_route_table_lock);
+
+    /* Return Status */
+    return status;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_delroute -
+ *
+ *  desc -                  channel whose routing table rules are removed [INPUT]
+ *  Returns:                BP_SUCCESS or error code
+ *-------------------------------------------------------------------------------------*/
+int bplib_delroute(bp_desc_t *desc)
+{
+    int i, kept = 0;
+
+    /* Check Parameters */
+    if (desc == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    bplib_os_mutex_lock(&bplib_route_table_lock);
+    {
+        for (i = 0; i < bplib_num_routes; i++)
+        {
+            if (bplib_route_table[i].desc != desc)
+            {
+                bplib_route_table[kept++] = bplib_route_table[i];
+            }
+        }
+        bplib_num_routes = kept;
+    }
+    bplib_os_mutex_unlock(&bplib_route_table_lock);
+
+    /* Return Success */
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_lookup -
+ *
+ *  bundle -                pointer to a bundle (byte array) [INPUT]
+ *  size -                  size of bundle being pointed to [INPUT]
+ *  Returns:                channel the routing table dispatches the bundle to, or NULL
+ *-------------------------------------------------------------------------------------*/
+bp_desc_t *bplib_lookup(const void *bundle, size_t size)
+{
+    bp_desc_t *desc = NULL;
+    bp_route_t route;
+
+    /* Read Destination */
+    if (bplib_routeinfo(bundle, size, &route) != BP_SUCCESS)
+    {
+        return NULL;
+    }
+
+    /* Find Channel */
+    bplib_os_mutex_lock(&bplib_route_table_lock);
+    {
+        desc = find_route(route.destination_node, route.destination_service);
+    }
+    bplib_os_mutex_unlock(&bplib_route_table_lock);
+
+    /* Return Channel */
+    return desc;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_dispatch -
+ *
+ *  bundle -                pointer to a received bundle (byte array) [INPUT]
+ *  size -                  size of bundle being pointed to [INPUT]
+ *  timeout -               0: check, -1: pend, 1 and above: timeout in milliseconds [INPUT]
+ *  flags -                 processing flags [OUTPUT]
+ *  Returns:                BP_SUCCESS or error code
+ *
+ *  Processes the bundle on the channel the routing table dispatches it to; bundles for
+ *  other nodes are forwarded by the channel they are routed to (see bplib_process).
+ *  Channels must not be closed while bundles are dispatched to them.
+ *-------------------------------------------------------------------------------------*/
+int bplib_dispatch(const void *bundle, size_t size, int timeout, uint32_t *flags)
+{
+    bp_desc_t *desc = NULL;
+    bp_route_t route;
+
+    /* Check Parameters */
+    if (flags == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    /* Read Destination */
+    int status = bplib_routeinfo(bundle, size, &route);
+    if (status != BP_SUCCESS)
+    {
+        return bplog(flags, BP_FLAG_FAILED_TO_PARSE, "Failed (%d) to read destination of bundle\n", status);
+    }
+
+    /* Find Channel */
+    bplib_os_mutex_lock(&bplib_route_table_lock);
+    {
+        desc = find_route(route.destination_node, route.destination_service);
+    }
+    bplib_os_mutex_unlock(&bplib_route_table_lock);
+
+    /* Process Bundle */
+    if (desc == NULL)
+    {
+        return bplog(flags, BP_FLAG_NO_ROUTE, "No route to %lu.%lu\n", (unsigned long)route.destination_node,
+                     (unsigned long)route.destination_service);
+    }
+
+    return bplib_process(desc, bundle, size, timeout, flags);
 }
 
 /*--------------------------------------------------------------------------------------
@@ -1514,7 +5221,13 @@ int bplib_routeinfo(const void *bundle, size_t size, bp_route_t *route)
  *-------------------------------------------------------------------------------------*/
 int bplib_display(const void *bundle, size_t size, uint32_t *flags)
 {
-    return v6_display(bundle, size, flags);
+    const bp_protocol_t *proto = recognize_protocol(bundle, size);
+    if (proto == NULL)
+    {
+        return bplog(flags, BP_FLAG_NONCOMPLIANT, "Unrecognized bundle protocol version\n");
+    }
+
+    return proto->display(bundle, size, flags);
 }
 
 /*--------------------------------------------------------------------------------------
@@ -26,6 +26,8 @@
  ******************************************************************************/
 
 #include "bplib.h"
+#include "crc.h"
+#include "rb_tree.h"
 
 /******************************************************************************
  DEFINES
@@ -47,7 +49,7 @@
 
 /* Call-Backs */
 typedef int (*bp_create_func_t)(void *parm, bool is_record, const uint8_t *payload, int size, int timeout);
-typedef int (*bp_delete_func_t)(void *parm, bp_val_t cid, uint32_t *flags);
+typedef int (*bp_delete_func_t)(void *parm, bp_val_t cid, bp_val_t count, int *num_deleted, uint32_t *flags);
 
 /* Bundle Field (fixed size) */
 typedef struct
@@ -60,19 +62,56 @@ typedef struct
 /* Active Bundle */
 typedef struct
 {
-    bp_sid_t sid;  /* storage id */
-    bp_val_t retx; /* retransmit time */
-    bp_val_t cid;  /* custody id */
+    bp_sid_t   sid;   /* storage id */
+    bp_val_t   retx;  /* retransmit time */
+    bp_val_t   cid;   /* custody id */
+    bp_index_t timer; /* retransmit timer */
+    uint8_t    cos;   /* class of service queue bundle was loaded from */
 } bp_active_bundle_t;
 
+/* Active Table Call-Back (invoked for each bundle removed by a range removal) */
+typedef void (*bp_removed_func_t)(void *parm, bp_active_bundle_t *bundle);
+
+/* Custody Functions (signatures follow the rb_tree API) */
+typedef int (*bp_custody_create_t)(void **tree, int size);
+typedef int (*bp_custody_destroy_t)(void *tree);
+typedef int (*bp_custody_insert_t)(bp_val_t value, void *tree);
+typedef bool (*bp_custody_is_empty_t)(void *tree);
+typedef int (*bp_custody_goto_first_t)(void *tree);
+typedef int (*bp_custody_get_next_t)(void *tree, rb_range_t *range, bool should_pop, bool should_rebalance);
+
+/* Custody Aggregator (custody ids received and waiting to be acknowledged in a DACS) */
+typedef struct
+{
+    void                   *tree;
+    bp_custody_create_t     create;
+    bp_custody_destroy_t    destroy;
+    bp_custody_insert_t     insert;
+    bp_custody_is_empty_t   is_empty;
+    bp_custody_goto_first_t goto_first;
+    bp_custody_get_next_t   get_next;
+} bp_custody_t;
+
 /* Payload Data */
 typedef struct
 {
-    bp_val_t exprtime;    /* absolute time when payload expires */
-    bool     ackapp;      /* acknowledgement by application is requested */
-    int      payloadsize; /* size of payload */
+    bp_val_t exprtime;     /* absolute time when payload expires */
+    bool     ackapp;       /* acknowledgement by application is requested */
+    int      payloadsize;  /* size of payload */
+    int      compressor;   /* identifier of compressor used on payload, 0: not compressed */
+    int      rawsize;      /* size of payload before compression */
+    bool     decompressed; /* payload is a decompressed copy of the stored payload */
 } bp_payload_data_t;
 
+/* Application Data Unit Identifier (the fragments of an ADU share it) */
+typedef struct
+{
+    bp_ipn_t node;      /* source node */
+    bp_ipn_t service;   /* source service */
+    bp_val_t createsec; /* creation timestamp seconds */
+    bp_val_t createseq; /* creation timestamp sequence */
+} bp_adu_id_t;
+
 /* Pending Structure */
 typedef struct
 {
@@ -81,15 +120,26 @@ typedef struct
     bp_ipn_t          service; /* custody service of payload */
     bp_payload_data_t data;    /* serialized and stored payload data */
     const uint8_t    *memptr;  /* pointer to payload */
+
+    /* Fragment of an ADU (adulen zero when the payload is a whole ADU) */
+    bp_adu_id_t adu;        /* ADU the payload is part of */
+    bp_val_t    fragoffset; /* offset of the payload into the ADU */
+    bp_val_t    adulen;     /* total length of the ADU */
+
+    /* Integrity Check Left to the Storage Copy of the Payload (crc_params NULL when none) */
+    bplib_crc_parameters_t *crc_params; /* crc computed over the payload */
+    bp_crcval_t             crc;        /* crc the payload must have */
 } bp_payload_t;
 
 /* Bundle Data */
 typedef struct
 {
     bp_val_t   exprtime;                       /* absolute time when bundle expires */
+    bp_val_t   enqtime;                        /* monotonic time bundle was queued (latency statistics) */
     bp_field_t cidfield;                       /* SDNV of custody id field of bundle */
     int        cteboffset;                     /* offset of the CTEB block of bundle */
     int        biboffset;                      /* offset of the BIB block of bundle */
+    int        cmpoffset;                      /* offset of the compression block of bundle */
     int        payoffset;                      /* offset of the payload block of bundle */
     int        headersize;                     /* size of the header (portion of buffer below used) */
     int        bundlesize;                     /* total size of the bundle (header and payload) */
@@ -104,6 +154,52 @@ typedef struct
     bp_bundle_data_t data;       /* serialized and stored bundle data */
     bool             prebuilt;   /* does pre-built bundle header need initialization */
     void            *blocks;     /* populated in initialization function */
+    void            *templates;  /* prebuilt headers by destination, populated in initialization function */
 } bp_bundle_t;
 
+/* Bundle Protocol Engine (one per protocol version, chosen when a channel is opened) */
+typedef struct
+{
+    int version; /* attributes.protocol_version served */
+
+    /* Engine */
+    int (*initialize)(void);
+    bool (*recognize)(const void *bundle, int size); /* is a received bundle of this version */
+    int (*routeinfo)(const void *bundle, int size, bp_route_t *route);
+    int (*display)(const void *bundle, int size, uint32_t *flags);
+
+    /* Channel */
+    int (*create)(bp_bundle_t *bundle, bp_route_t route, bp_attr_t attributes, int templates);
+    int (*destroy)(bp_bundle_t *bundle);
+    int (*invalidate_bundle)(bp_bundle_t *bundle);
+
+    /* Storage Service Data Path (bundles and payloads are kept by the channel's storage service) */
+    int (*populate_bundle)(bp_bundle_t *bundle, uint32_t *flags);
+    int (*send_bundle)(bp_bundle_t *bundle, const uint8_t *buffer, int size, bp_create_func_t create, void *parm,
+                       int timeout, uint32_t *flags);
+    int (*begin_adu)(bp_bundle_t *bundle, bp_val_t size, uint32_t *flags); /* payload bytes per bundle */
+    int (*send_fragment)(bp_bundle_t *bundle, const uint8_t *buffer, int size, bp_val_t offset,
+                         bp_create_func_t create, void *parm, int timeout, uint32_t *flags);
+    int (*end_adu)(bp_bundle_t *bundle, bool sent, uint32_t *flags);
+    int (*receive_bundle)(bp_bundle_t *bundle, const uint8_t *buffer, int size, bp_payload_t *payload,
+                          uint32_t *flags); /* only reads bundle, may be called concurrently */
+    int (*forward_bundle)(bp_bundle_t *bundle, const uint8_t *buffer, int size, uint32_t *flags);
+    int (*update_bundle)(bp_bundle_data_t *data, bp_val_t cid, uint32_t *flags);
+    int (*header_size)(bp_bundle_t *bundle);
+    int (*set_compression)(bp_bundle_t *bundle, int algorithm, int rawsize, uint32_t *flags);
+    int (*populate_acknowledgment)(uint8_t *rec, int size, int max_fills, bp_custody_t *custody, uint32_t *flags);
+    int (*receive_acknowledgment)(const uint8_t *rec, int size, int *num_acks, bp_delete_func_t remove, void *parm,
+                                  uint32_t *flags);
+    int (*is_expired)(bp_bundle_t *bundle, unsigned long sysnow, unsigned long exprtime, bool unrelt);
+
+    /* Direct Data Path (optional - when set, the engine keeps bundles and payloads itself, in place of
+     * the storage service path above; loaded bundles and accepted payloads stay valid until acknowledged) */
+    int (*store)(bp_bundle_t *bundle, const void *payload, size_t size, int timeout, uint32_t *flags);
+    int (*load)(bp_bundle_t *bundle, void **data, size_t *size, int timeout, uint32_t *flags);
+    int (*process)(bp_bundle_t *bundle, const void *data, size_t size, int timeout, uint32_t *flags);
+    int (*accept)(bp_bundle_t *bundle, void **payload, size_t *size, int timeout, uint32_t *flags);
+    int (*ackbundle)(bp_bundle_t *bundle, const void *data);
+    int (*ackpayload)(bp_bundle_t *bundle, const void *payload);
+} bp_protocol_t;
+
 #endif /* BUNDLE_TYPES_H */
@@ -0,0 +1,782 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include "bplib.h"
+#include "bplib_os.h"
+#include "bplib_engine.h"
+
+/******************************************************************************
+ TYPEDEFS
+ ******************************************************************************/
+
+/* engine_channel_t */
+typedef struct
+{
+    bp_desc_t     *desc;
+    bp_engine_io_t io;
+    bool           in_use;
+    bool           removing;     /* no longer serviced, slot is freed once not scheduled */
+    bool           scheduled;    /* queued on a worker or being serviced */
+    bool           event_failed; /* readiness event dropped from the poll set after it failed */
+    unsigned long  next_service; /* milliseconds, serviced then even without a readiness event */
+} engine_channel_t;
+
+/* engine_worker_t */
+typedef struct
+{
+    bp_engine_t     *engine;
+    bplib_os_mutex_t lock;   /* guards queue, taken by the worker and by workers stealing from it */
+    int             *queue;  /* ring of indices of channels to service, one entry per channel */
+    int              front;
+    int              count;
+    uint8_t         *buffer; /* bundles received by this worker */
+    bp_handle_t      thread;
+} engine_worker_t;
+
+/*
+ * bp_engine_t - services many channels with a fixed number of threads
+ *
+ *  A dispatcher thread polls the readiness events of the channels and the
+ *  receive descriptors given by the application, and queues each channel that
+ *  is ready, or that has gone a period without being serviced, on one worker.
+ *  Workers service the channels on their own queue and steal from the others
+ *  when it runs dry.  A channel is only queued once at a time, so the I/O
+ *  functions of a channel are never called concurrently.
+ */
+struct bp_engine
+{
+    bp_engine_attr_t  attributes;
+    bp_handle_t       lock;       /* guards channels and running, wakes idle workers and removals */
+    bool              running;
+    int               queued;     /* channels waiting on worker queues, accessed atomically */
+    int               wake_event; /* re-polls the dispatcher when a channel is done being serviced */
+    bp_handle_t       dispatcher;
+    int               next_worker;
+    engine_channel_t *channels;
+    engine_worker_t  *workers;
+    /* Dispatcher Poll Set */
+    int  *fds;         /* readiness event and receive descriptor of each channel, then the wake event */
+    int        *fd_channels; /* index of channel each descriptor belongs to */
+    bp_desc_t **fd_descs;    /* channel that held the slot when the poll set was built */
+    bool       *ready;       /* descriptors that poll readable */
+    bool       *failed;      /* descriptors that hung up or are in error */
+    bool       *due;         /* channels with a readable descriptor */
+    int        *pending;     /* channels to schedule once the lock is released */
+};
+
+/******************************************************************************
+ LOCAL FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * engine_put - adds a channel to the back of a worker's queue
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void engine_put(bp_engine_t *engine, engine_worker_t *w, int c)
+{
+    int max_channels = engine->attributes.max_channels;
+
+    bplib_os_mutex_lock(&w->lock);
+    {
+        w->queue[(w->front + w->count) % max_channels] = c;
+        w->count++;
+    }
+    bplib_os_mutex_unlock(&w->lock);
+
+    __atomic_add_fetch(&engine->queued, 1, __ATOMIC_RELEASE);
+}
+
+/*--------------------------------------------------------------------------------------
+ * engine_take - removes a channel from the front of a worker's queue, or from the
+ *  back when stealing so that the worker keeps the order of its own queue
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int engine_take(bp_engine_t *engine, engine_worker_t *w, bool steal)
+{
+    int max_channels = engine->attributes.max_channels;
+    int c            = BP_ERROR;
+
+    bplib_os_mutex_lock(&w->lock);
+    {
+        if (w->count > 0)
+        {
+            w->count--;
+            if (steal)
+            {
+                c = w->queue[(w->front + w->count) % max_channels];
+            }
+            else
+            {
+                c        = w->queue[w->front];
+                w->front = (w->front + 1) % max_channels;
+            }
+        }
+    }
+    bplib_os_mutex_unlock(&w->lock);
+
+    if (c != BP_ERROR)
+    {
+        __atomic_sub_fetch(&engine->queued, 1, __ATOMIC_ACQUIRE);
+    }
+
+    return c;
+}
+
+/*--------------------------------------------------------------------------------------
+ * engine_find_work - takes a channel from the worker's queue, or steals one
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int engine_find_work(bp_engine_t *engine, engine_worker_t *w)
+{
+    int num_workers = engine->attributes.num_workers;
+    int self        = (int)(w - engine->workers);
+    int c           = engine_take(engine, w, false);
+    int i;
+
+    for (i = 1; i < num_workers && c == BP_ERROR; i++)
+    {
+        c = engine_take(engine, &engine->workers[(self + i) % num_workers], true);
+    }
+
+    return c;
+}
+
+/*--------------------------------------------------------------------------------------
+ * engine_service - moves up to a batch of bundles and payloads in each direction
+ *
+ *  Returns true if a batch was filled and the channel may have more to do
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bool engine_service(bp_engine_t *engine, engine_channel_t *ch, uint8_t *buffer)
+{
+    bp_desc_t      *desc       = ch->desc;
+    bp_engine_io_t *io         = &ch->io;
+    int             batch_size = engine->attributes.batch_size;
+    bool            more       = false;
+    uint32_t        flags      = 0;
+    int             status;
+    int             n;
+
+    /* Clear Readiness Event before Draining Channel */
+    bplib_eventclear(desc);
+
+    /* Process Received Bundles */
+    if (io->receive)
+    {
+        for (n = 0; n < batch_size; n++)
+        {
+            int size = io->receive(io->parm, buffer, engine->attributes.receive_size);
+            if (size <= 0)
+            {
+                break;
+            }
+
+            status = bplib_process(desc, buffer, size, BP_CHECK, &flags);
+            if (status != BP_SUCCESS)
+            {
+                bplog(NULL, BP_FLAG_DIAGNOSTIC, "Engine failed (%d) to process bundle [%08X]\n", status, flags);
+            }
+        }
+        more = more || (n == batch_size);
+    }
+
+    /* Load and Send Bundles */
+    if (io->send)
+    {
+        for (n = 0; n < batch_size; n++)
+        {
+            void  *bundle = NULL;
+            size_t size   = 0;
+
+            status = bplib_load(desc, &bundle, &size, BP_CHECK, &flags);
+            if (status != BP_SUCCESS)
+            {
+                if (status != BP_TIMEOUT)
+                {
+                    bplog(NULL, BP_FLAG_DIAGNOSTIC, "Engine failed (%d) to load bundle [%08X]\n", status, flags);
+                }
+                break;
+            }
+
+            io->send(io->parm, bundle, size);
+            bplib_ackbundle(desc, bundle);
+        }
+        more = more || (n == batch_size);
+    }
+
+    /* Accept and Deliver Payloads */
+    if (io->deliver)
+    {
+        for (n = 0; n < batch_size; n++)
+        {
+            void  *payload = NULL;
+            size_t size    = 0;
+
+            status = bplib_accept(desc, &payload, &size, BP_CHECK, &flags);
+            if (status != BP_SUCCESS)
+            {
+                if (status != BP_TIMEOUT)
+                {
+                    bplog(NULL, BP_FLAG_DIAGNOSTIC, "Engine failed (%d) to accept payload [%08X]\n", status, flags);
+                }
+                break;
+            }
+
+            io->deliver(io->parm, payload, size);
+            bplib_ackpayload(desc, payload);
+        }
+        more = more || (n == batch_size);
+    }
+
+    return more;
+}
+
+/*--------------------------------------------------------------------------------------
+ * engine_worker - thread that services the channels queued on it or stolen from others
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void engine_worker(void *parm)
+{
+    engine_worker_t *w      = (engine_worker_t *)parm;
+    bp_engine_t     *engine = w->engine;
+
+    while (true)
+    {
+        /* Find Channel to Service */
+        int c = engine_find_work(engine, w);
+        if (c == BP_ERROR)
+        {
+            bool stop;
+            bplib_os_lock(engine->lock);
+            {
+                while (engine->running && __atomic_load_n(&engine->queued, __ATOMIC_ACQUIRE) == 0)
+                {
+                    bplib_os_waiton(engine->lock, BP_PEND);
+                }
+                stop = !engine->running;
+            }
+            bplib_os_unlock(engine->lock);
+
+            if (stop)
+            {
+                break;
+            }
+            continue;
+        }
+
+        /* Service Channel - it stays in place while scheduled */
+        engine_channel_t *ch = &engine->channels[c];
+        bool              skip;
+        bplib_os_lock(engine->lock);
+        {
+            skip = ch->removing || !engine->running;
+        }
+        bplib_os_unlock(engine->lock);
+
+        bool more = !skip && engine_service(engine, ch, w->buffer);
+
+        /* Requeue Channel with More to Do, Otherwise Return it to the Dispatcher */
+        bplib_os_lock(engine->lock);
+        {
+            more = more && !ch->removing && engine->running;
+            if (!more)
+            {
+                ch->scheduled = false;
+                bplib_os_broadcast(engine->lock);
+            }
+        }
+        bplib_os_unlock(engine->lock);
+
+        if (more)
+        {
+            engine_put(engine, w, c);
+        }
+        else
+        {
+            bplib_os_setevent(engine->wake_event);
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * engine_drop - removes a descriptor that hung up or is in error from the poll set, as it
+ *  would otherwise poll again at once; the channel is then serviced every period, and a
+ *  dropped receive descriptor is treated as absent so receive is called on each service;
+ *  the poll ran unlocked, so the slot is only changed if it still holds the channel and
+ *  descriptor that were polled (it may have been removed and reused in the meantime)
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void engine_drop(bp_engine_t *engine, int c, bp_desc_t *desc, int fd)
+{
+    bplib_os_lock(engine->lock);
+    {
+        engine_channel_t *ch = &engine->channels[c];
+        if (ch->in_use && !ch->removing && ch->desc == desc)
+        {
+            if (ch->io.receive && ch->io.receive_fd == fd)
+            {
+                ch->io.receive_fd = -1;
+                bplog(NULL, BP_FLAG_DIAGNOSTIC, "Engine dropped receive descriptor %d that hung up or failed\n", fd);
+            }
+            else if (bplib_eventfd(ch->desc) == fd)
+            {
+                ch->event_failed = true;
+                bplog(NULL, BP_FLAG_DIAGNOSTIC, "Engine dropped readiness event %d that failed\n", fd);
+            }
+        }
+    }
+    bplib_os_unlock(engine->lock);
+}
+
+/*--------------------------------------------------------------------------------------
+ * engine_dispatcher - thread that queues channels on workers when they are ready or due
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void engine_dispatcher(void *parm)
+{
+    bp_engine_t *engine       = (bp_engine_t *)parm;
+    int          max_channels = engine->attributes.max_channels;
+    int          period       = engine->attributes.period;
+    bool         running      = true;
+
+    while (running)
+    {
+        unsigned long msnow    = 0;
+        int           timeout  = period;
+        int           num_fds  = 0;
+        int           num_pend = 0;
+        int           c;
+        int           i;
+
+        /* Build Poll Set from Channels not Already Scheduled */
+        bplib_os_monotime(&msnow);
+        bplib_os_lock(engine->lock);
+        {
+            running = engine->running;
+            for (c = 0; c < max_channels; c++)
+            {
+                engine_channel_t *ch = &engine->channels[c];
+                engine->due[c]       = false;
+                if (!ch->in_use || ch->removing || ch->scheduled)
+                {
+                    continue;
+                }
+
+                long wait = (long)(ch->next_service - msnow);
+                if (wait < timeout)
+                {
+                    timeout = wait > 0 ? (int)wait : 0;
+                }
+
+                int event_fd = bplib_eventfd(ch->desc);
+                if (event_fd >= 0 && !ch->event_failed)
+                {
+                    engine->fds[num_fds]         = event_fd;
+                    engine->fd_channels[num_fds] = c;
+                    engine->fd_descs[num_fds]    = ch->desc;
+                    num_fds++;
+                }
+
+                if (ch->io.receive && ch->io.receive_fd >= 0)
+                {
+                    engine->fds[num_fds]         = ch->io.receive_fd;
+                    engine->fd_channels[num_fds] = c;
+                    engine->fd_descs[num_fds]    = ch->desc;
+                    num_fds++;
+                }
+            }
+        }
+        bplib_os_unlock(engine->lock);
+
+        if (!running)
+        {
+            break;
+        }
+
+        engine->fds[num_fds]         = engine->wake_event;
+        engine->fd_channels[num_fds] = BP_ERROR;
+        engine->fd_descs[num_fds]    = NULL;
+        num_fds++;
+
+        /* Send Custody Signals that are Due */
+        uint32_t flags        = 0;
+        int      tick_timeout = BP_PEND;
+        if (bplib_tick(&tick_timeout, &flags) == BP_SUCCESS && tick_timeout != BP_PEND && tick_timeout < timeout)
+        {
+            timeout = tick_timeout;
+        }
+
+        /* Wait for Readiness */
+        int count = bplib_os_waitevents(engine->fds, num_fds, engine->ready, engine->failed, timeout);
+        if (count == BP_ERROR)
+        {
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Engine failed to poll channels, servicing them every period\n");
+            bplib_os_lock(engine->lock);
+            {
+                if (engine->running)
+                {
+                    bplib_os_waiton(engine->lock, timeout);
+                }
+            }
+            bplib_os_unlock(engine->lock);
+        }
+        else if (count > 0)
+        {
+            bplib_os_clearevent(engine->wake_event);
+            for (i = 0; i < num_fds; i++)
+            {
+                if (engine->ready[i] && engine->fd_channels[i] != BP_ERROR)
+                {
+                    engine->due[engine->fd_channels[i]] = true;
+                }
+                else if (engine->failed[i] && engine->fd_channels[i] != BP_ERROR)
+                {
+                    engine_drop(engine, engine->fd_channels[i], engine->fd_descs[i], engine->fds[i]);
+                }
+            }
+        }
+
+        /* Schedule Channels that are Ready or Due */
+        bplib_os_monotime(&msnow);
+        bplib_os_lock(engine->lock);
+        {
+            for (c = 0; c < max_channels; c++)
+            {
+                engine_channel_t *ch = &engine->channels[c];
+                if (ch->in_use && !ch->removing && !ch->scheduled &&
+                    (engine->due[c] || (long)(msnow - ch->next_service) >= 0))
+                {
+                    ch->scheduled              = true;
+                    ch->next_service           = msnow + period;
+                    engine->pending[num_pend++] = c;
+                }
+            }
+        }
+        bplib_os_unlock(engine->lock);
+
+        /* Spread Channels across Workers */
+        for (i = 0; i < num_pend; i++)
+        {
+            engine_put(engine, &engine->workers[engine->next_worker], engine->pending[i]);
+            engine->next_worker = (engine->next_worker + 1) % engine->attributes.num_workers;
+        }
+
+        if (num_pend > 0)
+        {
+            bplib_os_lock(engine->lock);
+            {
+                bplib_os_broadcast(engine->lock);
+            }
+            bplib_os_unlock(engine->lock);
+        }
+    }
+}
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * bplib_engine_create - starts the dispatcher and worker threads of an engine
+ *
+ *  attributes - NULL or attributes where zero selects the default
+ *
+ *  Returns the engine, or NULL if it could not be started
+ *-------------------------------------------------------------------------------------*/
+bp_engine_t *bplib_engine_create(const bp_engine_attr_t *attributes)
+{
+    bp_engine_t *engine = (bp_engine_t *)bplib_os_calloc_tag(sizeof(bp_engine_t), BP_MEM_ENGINE);
+    if (engine == NULL)
+    {
+        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Cannot create engine: not enough memory\n");
+        return NULL;
+    }
+
+    /* Set Attributes */
+    if (attributes)
+    {
+        engine->attributes = *attributes;
+    }
+    if (engine->attributes.num_workers <= 0)
+    {
+        engine->attributes.num_workers = bplib_os_numcpus();
+    }
+    if (engine->attributes.max_channels <= 0)
+    {
+        engine->attributes.max_channels = BP_ENGINE_DEFAULT_MAX_CHANNELS;
+    }
+    if (engine->attributes.period <= 0)
+    {
+        engine->attributes.period = BP_ENGINE_DEFAULT_PERIOD;
+    }
+    if (engine->attributes.batch_size <= 0)
+    {
+        engine->attributes.batch_size = BP_ENGINE_DEFAULT_BATCH_SIZE;
+    }
+    if (engine->attributes.receive_size <= 0)
+    {
+        engine->attributes.receive_size = BP_ENGINE_DEFAULT_RECEIVE_SIZE;
+    }
+
+    int num_workers  = engine->attributes.num_workers;
+    int max_channels = engine->attributes.max_channels;
+    int max_fds      = (max_channels * 2) + 1;
+    int i;
+
+    /* Initialize Handles so a Partially Created Engine can be Destroyed */
+    engine->lock       = BP_INVALID_HANDLE;
+    engine->dispatcher = BP_INVALID_HANDLE;
+    engine->wake_event = bplib_os_createevent();
+
+    /* Allocate Channels, Workers, and Poll Set */
+    engine->channels    = (engine_channel_t *)bplib_os_calloc_tag(sizeof(engine_channel_t) * max_channels,
+                                                                  BP_MEM_ENGINE);
+    engine->workers     = (engine_worker_t *)bplib_os_calloc_tag(sizeof(engine_worker_t) * num_workers, BP_MEM_ENGINE);
+    engine->fds         = (int *)bplib_os_calloc_tag(sizeof(int) * max_fds, BP_MEM_ENGINE);
+    engine->fd_channels = (int *)bplib_os_calloc_tag(sizeof(int) * max_fds, BP_MEM_ENGINE);
+    engine->fd_descs    = (bp_desc_t **)bplib_os_calloc_tag(sizeof(bp_desc_t *) * max_fds, BP_MEM_ENGINE);
+    engine->ready       = (bool *)bplib_os_calloc_tag(sizeof(bool) * max_fds, BP_MEM_ENGINE);
+    engine->failed      = (bool *)bplib_os_calloc_tag(sizeof(bool) * max_fds, BP_MEM_ENGINE);
+    engine->due         = (bool *)bplib_os_calloc_tag(sizeof(bool) * max_channels, BP_MEM_ENGINE);
+    engine->pending     = (int *)bplib_os_calloc_tag(sizeof(int) * max_channels, BP_MEM_ENGINE);
+    if (engine->channels == NULL || engine->workers == NULL || engine->fds == NULL || engine->fd_channels == NULL ||
+        engine->fd_descs == NULL || engine->ready == NULL || engine->failed == NULL || engine->due == NULL ||
+        engine->pending == NULL)
+    {
+        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Cannot create engine: not enough memory for %d channels\n", max_channels);
+        bplib_engine_destroy(engine);
+        return NULL;
+    }
+
+    for (i = 0; i < num_workers; i++)
+    {
+        engine_worker_t *w = &engine->workers[i];
+        w->engine          = engine;
+        w->thread          = BP_INVALID_HANDLE;
+        w->queue           = (int *)bplib_os_calloc_tag(sizeof(int) * max_channels, BP_MEM_ENGINE);
+        w->buffer          = (uint8_t *)bplib_os_calloc_tag(engine->attributes.receive_size, BP_MEM_ENGINE);
+        bplib_os_mutex_init(&w->lock);
+        if (w->queue == NULL || w->buffer == NULL)
+        {
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Cannot create engine: not enough memory for worker %d\n", i);
+            bplib_engine_destroy(engine);
+            return NULL;
+        }
+    }
+
+    /* Create Lock and Wake Event */
+    engine->lock = bplib_os_createlock();
+    if (!bp_handle_is_valid(engine->lock) || engine->wake_event < 0)
+    {
+        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Cannot create engine: lock or pollable event unavailable\n");
+        bplib_engine_destroy(engine);
+        return NULL;
+    }
+
+    /* Start Threads */
+    engine->running    = true;
+    engine->dispatcher = bplib_os_createthread(engine_dispatcher, engine);
+    for (i = 0; i < num_workers && bp_handle_is_valid(engine->dispatcher); i++)
+    {
+        engine->workers[i].thread = bplib_os_createthread(engine_worker, &engine->workers[i]);
+        if (!bp_handle_is_valid(engine->workers[i].thread))
+        {
+            break;
+        }
+    }
+    if (!bp_handle_is_valid(engine->dispatcher) || i < num_workers)
+    {
+        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Cannot create engine: failed to start %d worker threads\n", num_workers);
+        bplib_engine_destroy(engine);
+        return NULL;
+    }
+
+    return engine;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_engine_destroy - stops the threads of an engine and frees it
+ *
+ *  Channels still added to the engine are left open and are no longer serviced
+ *-------------------------------------------------------------------------------------*/
+void bplib_engine_destroy(bp_engine_t *engine)
+{
+    int i;
+
+    if (engine == NULL)
+    {
+        return;
+    }
+
+    /* Stop Threads */
+    if (bp_handle_is_valid(engine->lock))
+    {
+        bplib_os_lock(engine->lock);
+        {
+            engine->running = false;
+            bplib_os_broadcast(engine->lock);
+        }
+        bplib_os_unlock(engine->lock);
+    }
+    bplib_os_setevent(engine->wake_event);
+
+    if (bp_handle_is_valid(engine->dispatcher))
+    {
+        bplib_os_jointhread(engine->dispatcher);
+    }
+
+    /* Free Workers */
+    if (engine->workers)
+    {
+        for (i = 0; i < engine->attributes.num_workers; i++)
+        {
+            engine_worker_t *w = &engine->workers[i];
+            if (bp_handle_is_valid(w->thread))
+            {
+                bplib_os_jointhread(w->thread);
+            }
+            bplib_os_mutex_destroy(&w->lock);
+            bplib_os_free(w->queue);
+            bplib_os_free(w->buffer);
+        }
+        bplib_os_free(engine->workers);
+    }
+
+    /* Free Engine */
+    if (bp_handle_is_valid(engine->lock))
+    {
+        bplib_os_destroylock(engine->lock);
+    }
+    bplib_os_destroyevent(engine->wake_event);
+    bplib_os_free(engine->channels);
+    bplib_os_free(engine->fds);
+    bplib_os_free(engine->fd_channels);
+    bplib_os_free(engine->fd_descs);
+    bplib_os_free(engine->ready);
+    bplib_os_free(engine->failed);
+    bplib_os_free(engine->due);
+    bplib_os_free(engine->pending);
+    bplib_os_free(engine);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_engine_add - has the engine service a channel
+ *
+ *  io - functions the engine calls to move bundles and payloads of the channel; they
+ *       must not block, and are never called concurrently for the same channel
+ *
+ *  Returns BP_SUCCESS, or BP_ERROR if the engine is full or already has the channel
+ *-------------------------------------------------------------------------------------*/
+int bplib_engine_add(bp_engine_t *engine, bp_desc_t *desc, const bp_engine_io_t *io)
+{
+    int status = BP_ERROR;
+    int slot   = BP_ERROR;
+    int c;
+
+    /* Check Parameters */
+    if (engine == NULL || desc == NULL || io == NULL)
+    {
+        return bplog(NULL, BP_FLAG_API_ERROR, "Invalid parameters passed to add channel to engine\n");
+    }
+
+    bplib_os_lock(engine->lock);
+    {
+        for (c = 0; c < engine->attributes.max_channels; c++)
+        {
+            engine_channel_t *ch = &engine->channels[c];
+            if (ch->in_use && ch->desc == desc)
+            {
+                slot = BP_ERROR;
+                break;
+            }
+            else if (!ch->in_use && slot == BP_ERROR)
+            {
+                slot = c;
+            }
+        }
+
+        if (slot != BP_ERROR)
+        {
+            engine_channel_t *ch = &engine->channels[slot];
+            ch->desc             = desc;
+            ch->io               = *io;
+            ch->in_use           = true;
+            ch->removing         = false;
+            ch->scheduled        = false;
+            ch->event_failed     = false;
+            bplib_os_monotime(&ch->next_service); /* due now */
+            status = BP_SUCCESS;
+        }
+    }
+    bplib_os_unlock(engine->lock);
+
+    if (status != BP_SUCCESS)
+    {
+        return bplog(NULL, BP_FLAG_API_ERROR, "Unable to add channel to engine, full or already added\n");
+    }
+
+    /* Poll Channel */
+    bplib_os_setevent(engine->wake_event);
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_engine_remove - stops servicing a channel, waiting for a service in progress
+ *
+ *  Must be called before the channel is closed
+ *-------------------------------------------------------------------------------------*/
+int bplib_engine_remove(bp_engine_t *engine, bp_desc_t *desc)
+{
+    int status = BP_ERROR;
+    int c;
+
+    /* Check Parameters */
+    if (engine == NULL || desc == NULL)
+    {
+        return bplog(NULL, BP_FLAG_API_ERROR, "Invalid parameters passed to remove channel from engine\n");
+    }
+
+    bplib_os_lock(engine->lock);
+    {
+        for (c = 0; c < engine->attributes.max_channels; c++)
+        {
+            engine_channel_t *ch = &engine->channels[c];
+            if (ch->in_use && !ch->removing && ch->desc == desc)
+            {
+                /* Wait for Worker to Finish with Channel */
+                ch->removing = true;
+                while (ch->scheduled && engine->running)
+                {
+                    bplib_os_waiton(engine->lock, BP_PEND);
+                }
+                ch->in_use = false;
+                ch->desc   = NULL;
+                status     = BP_SUCCESS;
+                break;
+            }
+        }
+    }
+    bplib_os_unlock(engine->lock);
+
+    if (status != BP_SUCCESS)
+    {
+        return bplog(NULL, BP_FLAG_API_ERROR, "Unable to remove channel that was not added to engine\n");
+    }
+
+    return BP_SUCCESS;
+}
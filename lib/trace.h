@@ -0,0 +1,58 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include "bplib.h"
+
+#if BPLIB_TRACEPOINTS
+#include <sys/sdt.h>
+#endif
+
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+/*
+ * Tracepoints - static probes of the "bplib" provider (USDT) at the transitions of a
+ *  bundle, for example with bpftrace: usdt:/path/to/program:bplib:transmit
+ *
+ *  Compiled out (arguments not evaluated) unless BPLIB_TRACEPOINTS is true; when
+ *  compiled in, an unattached probe is a nop and the tracer timestamps each hit.
+ *  Arguments are integers or pointers, the channel is always the first.
+ */
+#if BPLIB_TRACEPOINTS
+#define bptrace1(name, a)          DTRACE_PROBE1(bplib, name, a)
+#define bptrace2(name, a, b)       DTRACE_PROBE2(bplib, name, a, b)
+#define bptrace3(name, a, b, c)    DTRACE_PROBE3(bplib, name, a, b, c)
+#define bptrace4(name, a, b, c, d) DTRACE_PROBE4(bplib, name, a, b, c, d)
+#else
+#define bptrace1(name, a)
+#define bptrace2(name, a, b)
+#define bptrace3(name, a, b, c)
+#define bptrace4(name, a, b, c, d)
+#endif
+
+#endif /* TRACE_H */
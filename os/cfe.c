@@ -47,12 +47,74 @@
 #define BP_BPLIB_INFO_EID 0xFF
 #endif
 
+/* Threads Run as cFE Child Tasks and Locks are OSAL Objects (Compile-Time Option)
+ *  Without child tasks, services that would start a thread (e.g. the write behind of
+ *  the file storage service) do their work in the calling app and locks are no-ops */
+#ifndef BP_CFE_CHILD_TASKS
+#define BP_CFE_CHILD_TASKS false
+#endif
+
+/* Stack Size of Child Tasks (Compile-Time Option) */
+#ifndef BP_CFE_CHILD_STACK_SIZE
+#define BP_CFE_CHILD_STACK_SIZE 16384
+#endif
+
+/* Priority of Child Tasks, below the apps they work for so those keep their schedule (Compile-Time Option) */
+#ifndef BP_CFE_CHILD_PRIORITY
+#define BP_CFE_CHILD_PRIORITY 200
+#endif
+
+/* Waitable Locks and Threads of Child Tasks (Compile-Time Option) */
+#ifndef BP_MAX_LOCKS
+#define BP_MAX_LOCKS 128
+#endif
+#ifndef BP_MAX_THREADS
+#define BP_MAX_THREADS 8
+#endif
+
+/* Inline Mutexes of Child Tasks */
+#define BP_MUTEX_SPINS    100
+#define BP_MUTEX_UNLOCKED 0
+#define BP_MUTEX_LOCKED   1
+
+/******************************************************************************
+ TYPEDEFS
+ ******************************************************************************/
+
+typedef struct
+{
+    bool      used;
+    osal_id_t condvar; /* mutex and condition of the waitable lock */
+} bplib_os_lock_t;
+
+typedef struct
+{
+    CFE_ES_TaskId_t task_id;
+    osal_id_t       done; /* binary semaphore given when the thread returns */
+    void (*entry)(void *parm);
+    void *parm;
+} bplib_os_thread_t;
+
+typedef struct
+{
+    size_t         size;    /* of memory block, including header */
+    bp_memstats_t *account; /* also charged with block, NULL for none */
+    int            tag;     /* subsystem charged with block */
+} bplib_os_memhdr_t;
+
 /******************************************************************************
  FILE DATA
  ******************************************************************************/
 
-static size_t current_memory_allocated = 0;
-static size_t highest_memory_allocated = 0;
+static bp_memstats_t  memory_stats;
+static bp_memstats_t *memory_account = NULL; /* one for all tasks, see bplib_os_memaccount */
+
+#if BP_CFE_CHILD_TASKS
+static bplib_os_lock_t    locks[BP_MAX_LOCKS];
+static bplib_os_thread_t *threads[BP_MAX_THREADS];
+static osal_id_t          lock_of_locks;
+static osal_id_t          memory_lock; /* memory statistics are charged by child tasks too */
+#endif
 
 static uint32_t flag_log_enable = BP_FLAG_NONCOMPLIANT | BP_FLAG_DROPPED | BP_FLAG_BUNDLE_TOO_LARGE |
                                   BP_FLAG_UNKNOWNREC | BP_FLAG_INVALID_CIPHER_SUITEID |
@@ -78,7 +140,13 @@ void bplib_os_enable_log_flags(uint32_t enable_mask)
 /*--------------------------------------------------------------------------------------
  * bplib_os_init -
  *-------------------------------------------------------------------------------------*/
-void bplib_os_init(void) {}
+void bplib_os_init(void)
+{
+#if BP_CFE_CHILD_TASKS
+    OS_MutSemCreate(&lock_of_locks, "BPLOCKS", 0);
+    OS_MutSemCreate(&memory_lock, "BPMEM", 0);
+#endif
+}
 
 /*--------------------------------------------------------------------------------------
  * bplib_os_log -
@@ -170,6 +238,30 @@ int bplib_os_systime(unsigned long *sysnow)
     }
 }
 
+/*--------------------------------------------------------------------------------------
+ * bplib_os_monotime - returns milliseconds of mission elapsed time
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_monotime(unsigned long *msnow)
+{
+    assert(msnow);
+
+    CFE_TIME_SysTime_t met = CFE_TIME_GetMET();
+    *msnow = ((unsigned long)met.Seconds * 1000) + (CFE_TIME_Sub2MicroSecs(met.Subseconds) / 1000);
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_monotime_us - returns microseconds of mission elapsed time
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_monotime_us(unsigned long *usnow)
+{
+    assert(usnow);
+
+    CFE_TIME_SysTime_t met = CFE_TIME_GetMET();
+    *usnow = ((unsigned long)met.Seconds * 1000000) + CFE_TIME_Sub2MicroSecs(met.Subseconds);
+    return BP_SUCCESS;
+}
+
 /*--------------------------------------------------------------------------------------
  * bplib_os_sleep
  *-------------------------------------------------------------------------------------*/
@@ -178,6 +270,14 @@ void bplib_os_sleep(int seconds)
     OS_TaskDelay(seconds * 1000);
 }
 
+/*--------------------------------------------------------------------------------------
+ * bplib_os_sleep_us - rounded up to the millisecond resolution of the task delay
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_sleep_us(unsigned long usecs)
+{
+    OS_TaskDelay((usecs + 999) / 1000);
+}
+
 /*--------------------------------------------------------------------------------------
  * bplib_os_random -
  *-------------------------------------------------------------------------------------*/
@@ -188,6 +288,323 @@ uint32_t bplib_os_random(void)
     return (uint32_t)BP_RAND_HASH(seed);
 }
 
+#if BP_CFE_CHILD_TASKS
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_createlock -
+ *-------------------------------------------------------------------------------------*/
+bp_handle_t bplib_os_createlock(void)
+{
+    bp_handle_t handle = BP_INVALID_HANDLE;
+
+    OS_MutSemTake(lock_of_locks);
+    {
+        int i;
+        for (i = 0; i < BP_MAX_LOCKS; i++)
+        {
+            if (!locks[i].used)
+            {
+                char name[OS_MAX_API_NAME];
+                snprintf(name, sizeof(name), "BPLK%03d", i);
+                if (OS_CondVarCreate(&locks[i].condvar, name, 0) == OS_SUCCESS)
+                {
+                    locks[i].used = true;
+                    handle        = bp_handle_from_serial(i, BPLIB_HANDLE_OS_BASE);
+                }
+                break;
+            }
+        }
+    }
+    OS_MutSemGive(lock_of_locks);
+
+    return handle;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_destroylock -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_destroylock(bp_handle_t h)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_OS_BASE);
+
+    OS_MutSemTake(lock_of_locks);
+    {
+        if (locks[handle].used)
+        {
+            OS_CondVarDelete(locks[handle].condvar);
+            locks[handle].used = false;
+        }
+    }
+    OS_MutSemGive(lock_of_locks);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_lock -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_lock(bp_handle_t h)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_OS_BASE);
+
+    OS_CondVarLock(locks[handle].condvar);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_unlock -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_unlock(bp_handle_t h)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_OS_BASE);
+
+    OS_CondVarUnlock(locks[handle].condvar);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_signal -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_signal(bp_handle_t h)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_OS_BASE);
+
+    OS_CondVarSignal(locks[handle].condvar);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_broadcast -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_broadcast(bp_handle_t h)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_OS_BASE);
+
+    OS_CondVarBroadcast(locks[handle].condvar);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_waiton -
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_waiton(bp_handle_t h, int timeout_ms)
+{
+    if (timeout_ms == BP_PEND)
+    {
+        return bplib_os_waiton_us(h, BP_PEND);
+    }
+
+    return bplib_os_waiton_us(h, (long)timeout_ms * 1000);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_waiton_us - waits up to a number of microseconds to be signaled
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_waiton_us(bp_handle_t h, long timeout_us)
+{
+    int   handle = bp_handle_to_serial(h, BPLIB_HANDLE_OS_BASE);
+    int32 status;
+
+    if (timeout_us == BP_PEND)
+    {
+        /* Block Forever until Success */
+        status = OS_CondVarWait(locks[handle].condvar);
+    }
+    else if (timeout_us > 0)
+    {
+        /* Wake Up Time is Absolute on the OSAL Local Clock */
+        OS_time_t wakeup;
+        OS_GetLocalTime(&wakeup);
+        wakeup = OS_TimeAdd(wakeup, OS_TimeFromTotalMicroseconds(timeout_us));
+        status = OS_CondVarTimedWait(locks[handle].condvar, &wakeup);
+    }
+    else /* timeout_us = 0 */
+    {
+        /* conditional does not support a non-blocking attempt
+         * so treat it as an immediate timeout */
+        return BP_TIMEOUT;
+    }
+
+    if (status == OS_ERROR_TIMEOUT)
+    {
+        return BP_TIMEOUT;
+    }
+    else if (status != OS_SUCCESS)
+    {
+        return BP_ERROR;
+    }
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_waituntil - waits to be signaled until a deadline of bplib_os_monotime_us
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_waituntil(bp_handle_t h, unsigned long deadline_us)
+{
+    unsigned long usnow;
+    bplib_os_monotime_us(&usnow);
+
+    long remaining = (long)(deadline_us - usnow);
+    if (remaining <= 0)
+    {
+        return BP_TIMEOUT;
+    }
+
+    return bplib_os_waiton_us(h, remaining);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_mutex_init -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_mutex_init(bplib_os_mutex_t *m)
+{
+    __atomic_store_n(&m->state, BP_MUTEX_UNLOCKED, __ATOMIC_RELEASE);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_mutex_destroy -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_mutex_destroy(bplib_os_mutex_t *m)
+{
+    (void)m;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_mutex_lock - spins briefly, then delays so that a lower priority holder can run
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_mutex_lock(bplib_os_mutex_t *m)
+{
+    int spins = 0;
+    int c     = BP_MUTEX_UNLOCKED;
+
+    while (!__atomic_compare_exchange_n(&m->state, &c, BP_MUTEX_LOCKED, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    {
+        if (++spins >= BP_MUTEX_SPINS)
+        {
+            OS_TaskDelay(1);
+        }
+        c = BP_MUTEX_UNLOCKED;
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_mutex_unlock -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_mutex_unlock(bplib_os_mutex_t *m)
+{
+    __atomic_store_n(&m->state, BP_MUTEX_UNLOCKED, __ATOMIC_RELEASE);
+}
+
+/*--------------------------------------------------------------------------------------
+ * child_task_entry - adapts cFE child task entry point to bplib thread entry point
+ *
+ *  Child tasks are not passed a parameter, so the task finds its thread by task id;
+ *  the creating task holds the thread table until the task id is recorded
+ *-------------------------------------------------------------------------------------*/
+static void child_task_entry(void)
+{
+    CFE_ES_TaskId_t    task_id;
+    bplib_os_thread_t *t = NULL;
+    int                i;
+
+    CFE_ES_GetTaskID(&task_id);
+
+    OS_MutSemTake(lock_of_locks);
+    {
+        for (i = 0; i < BP_MAX_THREADS; i++)
+        {
+            if (threads[i] != NULL && CFE_RESOURCEID_TEST_EQUAL(threads[i]->task_id, task_id))
+            {
+                t = threads[i];
+                break;
+            }
+        }
+    }
+    OS_MutSemGive(lock_of_locks);
+
+    if (t != NULL)
+    {
+        t->entry(t->parm);
+        OS_BinSemGive(t->done);
+    }
+
+    CFE_ES_ExitChildTask();
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_createthread - runs the thread in a child task of the calling cFE app
+ *-------------------------------------------------------------------------------------*/
+bp_handle_t bplib_os_createthread(void (*entry)(void *parm), void *parm)
+{
+    bp_handle_t handle = BP_INVALID_HANDLE;
+
+    OS_MutSemTake(lock_of_locks);
+    {
+        int i;
+        for (i = 0; i < BP_MAX_THREADS; i++)
+        {
+            if (threads[i] == NULL)
+            {
+                threads[i] = (bplib_os_thread_t *)bplib_os_calloc(sizeof(bplib_os_thread_t));
+                if (threads[i])
+                {
+                    char sem_name[OS_MAX_API_NAME];
+                    char task_name[OS_MAX_API_NAME];
+                    snprintf(sem_name, sizeof(sem_name), "BPDN%03d", i);
+                    snprintf(task_name, sizeof(task_name), "BPLIB_CHILD%03d", i);
+
+                    threads[i]->entry = entry;
+                    threads[i]->parm  = parm;
+                    if (OS_BinSemCreate(&threads[i]->done, sem_name, 0, 0) != OS_SUCCESS)
+                    {
+                        bplib_os_free(threads[i]);
+                        threads[i] = NULL;
+                    }
+                    else if (CFE_ES_CreateChildTask(&threads[i]->task_id, task_name, child_task_entry,
+                                                    CFE_ES_TASK_STACK_ALLOCATE, BP_CFE_CHILD_STACK_SIZE,
+                                                    BP_CFE_CHILD_PRIORITY, 0) != CFE_SUCCESS)
+                    {
+                        OS_BinSemDelete(threads[i]->done);
+                        bplib_os_free(threads[i]);
+                        threads[i] = NULL;
+                    }
+                    else
+                    {
+                        handle = bp_handle_from_serial(i, BPLIB_HANDLE_THREAD_BASE);
+                    }
+                }
+                break;
+            }
+        }
+    }
+    OS_MutSemGive(lock_of_locks);
+
+    return handle;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_jointhread - waits for thread to return and releases it
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_jointhread(bp_handle_t h)
+{
+    int                handle = bp_handle_to_serial(h, BPLIB_HANDLE_THREAD_BASE);
+    bplib_os_thread_t *t;
+
+    OS_MutSemTake(lock_of_locks);
+    {
+        t               = threads[handle];
+        threads[handle] = NULL;
+    }
+    OS_MutSemGive(lock_of_locks);
+
+    if (t == NULL || OS_BinSemTake(t->done) != OS_SUCCESS)
+    {
+        return BP_ERROR;
+    }
+
+    OS_BinSemDelete(t->done);
+    bplib_os_free(t);
+
+    return BP_SUCCESS;
+}
+
+#else /* single task, every lock is a no-op */
+
 /*--------------------------------------------------------------------------------------
  * bplib_os_createlock -
  *-------------------------------------------------------------------------------------*/
@@ -228,6 +645,14 @@ void bplib_os_signal(bp_handle_t h)
     (void)h;
 }
 
+/*--------------------------------------------------------------------------------------
+ * bplib_os_broadcast -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_broadcast(bp_handle_t h)
+{
+    (void)h;
+}
+
 /*--------------------------------------------------------------------------------------
  * bplib_os_waiton -
  *-------------------------------------------------------------------------------------*/
@@ -238,6 +663,132 @@ int bplib_os_waiton(bp_handle_t h, int timeout_ms)
     return BP_TIMEOUT;
 }
 
+/*--------------------------------------------------------------------------------------
+ * bplib_os_waiton_us -
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_waiton_us(bp_handle_t h, long timeout_us)
+{
+    (void)h;
+    (void)timeout_us;
+    return BP_TIMEOUT;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_waituntil -
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_waituntil(bp_handle_t h, unsigned long deadline_us)
+{
+    (void)h;
+    (void)deadline_us;
+    return BP_TIMEOUT;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_mutex_init -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_mutex_init(bplib_os_mutex_t *m)
+{
+    m->state = 0;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_mutex_destroy -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_mutex_destroy(bplib_os_mutex_t *m)
+{
+    (void)m;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_mutex_lock -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_mutex_lock(bplib_os_mutex_t *m)
+{
+    (void)m;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_mutex_unlock -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_mutex_unlock(bplib_os_mutex_t *m)
+{
+    (void)m;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_createthread - threads are not available, callers fall back to running inline
+ *-------------------------------------------------------------------------------------*/
+bp_handle_t bplib_os_createthread(void (*entry)(void *parm), void *parm)
+{
+    (void)entry;
+    (void)parm;
+    return BP_INVALID_HANDLE;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_jointhread -
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_jointhread(bp_handle_t h)
+{
+    (void)h;
+    return BP_ERROR;
+}
+
+#endif /* BP_CFE_CHILD_TASKS */
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_createevent - pollable descriptors are not available
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_createevent(void)
+{
+    return BP_ERROR;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_destroyevent -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_destroyevent(int fd)
+{
+    (void)fd;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_setevent -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_setevent(int fd)
+{
+    (void)fd;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_clearevent -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_clearevent(int fd)
+{
+    (void)fd;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_waitevents - pollable descriptors are not available
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_waitevents(const int *fds, int num_fds, bool *ready, bool *failed, int timeout_ms)
+{
+    (void)fds;
+    (void)num_fds;
+    (void)ready;
+    (void)failed;
+    (void)timeout_ms;
+    return BP_ERROR;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_numcpus -
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_numcpus(void)
+{
+    return 1;
+}
+
 /*--------------------------------------------------------------------------------------
  * bplib_os_format -
  *-------------------------------------------------------------------------------------*/
@@ -272,28 +823,90 @@ int bplib_os_strnlen(const char *str, int maxlen)
 }
 
 /*----------------------------------------------------------------------------
- * bplib_os_calloc
+ * mem_charge - adds to (or with a negative size, takes from) memory statistics
+ *----------------------------------------------------------------------------*/
+static void mem_charge(bp_memstats_t *stats, int tag, long size)
+{
+    stats->used += (size_t)size;
+    stats->tag_used[tag] += (size_t)size;
+
+    if (stats->used > stats->high)
+    {
+        stats->high = stats->used;
+    }
+    if (stats->tag_used[tag] > stats->tag_high[tag])
+    {
+        stats->tag_high[tag] = stats->tag_used[tag];
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * mem_latch - copies memory statistics
+ *----------------------------------------------------------------------------*/
+static void mem_latch(bp_memstats_t *dst, bp_memstats_t *src)
+{
+#if BP_CFE_CHILD_TASKS
+    OS_MutSemTake(memory_lock);
+    *dst = *src;
+    OS_MutSemGive(memory_lock);
+#else
+    *dst = *src;
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * mem_account - charges a memory block to the statistics and its account
+ *----------------------------------------------------------------------------*/
+static void mem_account(bplib_os_memhdr_t *hdr, long size)
+{
+#if BP_CFE_CHILD_TASKS
+    OS_MutSemTake(memory_lock);
+#endif
+
+    mem_charge(&memory_stats, hdr->tag, size);
+    if (hdr->account)
+    {
+        mem_charge(hdr->account, hdr->tag, size);
+    }
+
+#if BP_CFE_CHILD_TASKS
+    OS_MutSemGive(memory_lock);
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_os_calloc - allocates memory not charged to any subsystem
  *----------------------------------------------------------------------------*/
 void *bplib_os_calloc(size_t size)
 {
+    return bplib_os_calloc_tag(size, BP_MEM_OTHER);
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_os_calloc_tag - allocates memory charged to a subsystem (BP_MEM_xxx)
+ *
+ *  Also charged to the memory account of the calling thread, if one is set
+ *----------------------------------------------------------------------------*/
+void *bplib_os_calloc_tag(size_t size, int tag)
+{
+    assert(tag >= 0 && tag < BP_NUM_MEM_TAGS);
+
     /* Allocate Memory Block */
-    size_t   block_size = size + sizeof(size_t);
+    size_t   block_size = size + sizeof(bplib_os_memhdr_t);
     uint8_t *mem_ptr    = (uint8_t *)calloc(block_size, 1);
     if (mem_ptr)
     {
-        /* Prepend Amount */
-        size_t *size_ptr = (size_t *)mem_ptr;
-        *size_ptr        = block_size;
+        /* Prepend Header */
+        bplib_os_memhdr_t *hdr = (bplib_os_memhdr_t *)mem_ptr;
+        hdr->size              = block_size;
+        hdr->account           = memory_account;
+        hdr->tag               = tag;
 
         /* Update Statistics */
-        current_memory_allocated += block_size;
-        if (current_memory_allocated > highest_memory_allocated)
-        {
-            highest_memory_allocated = current_memory_allocated;
-        }
+        mem_account(hdr, (long)block_size);
 
         /* Return User Block */
-        return (mem_ptr + sizeof(size_t));
+        return (mem_ptr + sizeof(bplib_os_memhdr_t));
     }
     else
     {
@@ -308,17 +921,16 @@ void bplib_os_free(void *ptr)
 {
     if (ptr)
     {
-        uint8_t *mem_ptr = (uint8_t *)ptr;
+        uint8_t *mem_ptr = (uint8_t *)ptr - sizeof(bplib_os_memhdr_t);
 
-        /* Read Amount */
-        size_t *size_ptr   = (size_t *)((uint8_t *)mem_ptr - sizeof(size_t));
-        size_t  block_size = *size_ptr;
+        /* Read Header */
+        bplib_os_memhdr_t *hdr = (bplib_os_memhdr_t *)mem_ptr;
 
         /* Update Statistics */
-        current_memory_allocated -= block_size;
+        mem_account(hdr, -(long)hdr->size);
 
         /* Free Memory Block */
-        free(mem_ptr - sizeof(size_t));
+        free(mem_ptr);
     }
 }
 
@@ -327,7 +939,9 @@ void bplib_os_free(void *ptr)
  *----------------------------------------------------------------------------*/
 size_t bplib_os_memused(void)
 {
-    return current_memory_allocated;
+    bp_memstats_t stats;
+    mem_latch(&stats, &memory_stats);
+    return stats.used;
 }
 
 /*----------------------------------------------------------------------------
@@ -335,5 +949,29 @@ size_t bplib_os_memused(void)
  *----------------------------------------------------------------------------*/
 size_t bplib_os_memhigh(void)
 {
-    return highest_memory_allocated;
+    bp_memstats_t stats;
+    mem_latch(&stats, &memory_stats);
+    return stats.high;
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_os_memstats - copies memory statistics of an account, or of all
+ *  allocations when account is NULL
+ *----------------------------------------------------------------------------*/
+void bplib_os_memstats(bp_memstats_t *stats, bp_memstats_t *account)
+{
+    mem_latch(stats, account ? account : &memory_stats);
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_os_memaccount - sets account charged with calling thread's allocations
+ *
+ *  Returns the previous account (NULL for none) so that it can be restored; an
+ *  account must outlive every allocation charged to it
+ *----------------------------------------------------------------------------*/
+bp_memstats_t *bplib_os_memaccount(bp_memstats_t *account)
+{
+    bp_memstats_t *prev = memory_account;
+    memory_account      = account;
+    return prev;
 }
@@ -22,6 +22,10 @@
  INCLUDES
  ******************************************************************************/
 
+#ifdef __linux__
+#define _GNU_SOURCE /* adaptive mutexes */
+#endif
+
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdint.h>
@@ -30,6 +34,13 @@
 #include <pthread.h>
 #include <errno.h>
 #include <unistd.h>
+#include <sched.h>
+#include <poll.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
 
 #include "bplib.h"
 #include "bplib_os.h"
@@ -40,7 +51,41 @@
 
 #define UNIX_SECS_AT_2000     946684800
 #define BP_MAX_LOG_ENTRY_SIZE 256
-#define BP_MAX_LOCKS          128
+#define BP_MUTEX_SPINS        100
+#define BP_MAX_POLL_LOCAL     64
+
+/* Waitable Locks, about four per channel with the RAM storage service (Compile-Time Option) */
+#ifndef BP_MAX_LOCKS
+#define BP_MAX_LOCKS 128
+#endif
+
+/* Threads, including a service engine's worker per online processor (Compile-Time Option) */
+#ifndef BP_MAX_THREADS
+#define BP_MAX_THREADS 256
+#endif
+
+/* Mutex Type of Waitable Locks */
+#if !BPLIB_OS_FAST_LOCKS
+#define BP_LOCK_MUTEX_TYPE PTHREAD_MUTEX_RECURSIVE
+#elif defined(PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP)
+#define BP_LOCK_MUTEX_TYPE PTHREAD_MUTEX_ADAPTIVE_NP
+#else
+#define BP_LOCK_MUTEX_TYPE PTHREAD_MUTEX_DEFAULT
+#endif
+
+/* Clock of Waitable Locks - monotonic so waits are unaffected by steps in the system time */
+#if defined(_POSIX_MONOTONIC_CLOCK) && !defined(__APPLE__)
+#define BP_COND_CLOCK     CLOCK_MONOTONIC
+#define BP_COND_SET_CLOCK true
+#else
+#define BP_COND_CLOCK     CLOCK_REALTIME
+#define BP_COND_SET_CLOCK false
+#endif
+
+/* Inline Mutex States */
+#define BP_MUTEX_UNLOCKED  0
+#define BP_MUTEX_LOCKED    1
+#define BP_MUTEX_CONTENDED 2
 
 /******************************************************************************
  TYPEDEFS
@@ -52,17 +97,32 @@ typedef struct
     pthread_mutex_t mutex;
 } bplib_os_lock_t;
 
+typedef struct
+{
+    pthread_t thread;
+    void (*entry)(void *parm);
+    void *parm;
+} bplib_os_thread_t;
+
+typedef struct
+{
+    size_t         size;    /* of memory block, including header */
+    bp_memstats_t *account; /* also charged with block, NULL for none */
+    int            tag;     /* subsystem charged with block */
+} bplib_os_memhdr_t;
+
 /******************************************************************************
  FILE DATA
  ******************************************************************************/
 
-static bplib_os_lock_t *locks[BP_MAX_LOCKS] = {0};
-static pthread_mutex_t  lock_of_locks;
+static bplib_os_lock_t   *locks[BP_MAX_LOCKS]     = {0};
+static bplib_os_thread_t *threads[BP_MAX_THREADS] = {0};
+static pthread_mutex_t    lock_of_locks;
 
 static struct timespec prevnow;
 
-static size_t current_memory_allocated = 0;
-static size_t highest_memory_allocated = 0;
+static bp_memstats_t           memory_stats;
+static __thread bp_memstats_t *memory_account = NULL; /* of calling thread */
 
 static uint32_t flag_log_enable = BP_FLAG_NONCOMPLIANT | BP_FLAG_DROPPED | BP_FLAG_BUNDLE_TOO_LARGE |
                                   BP_FLAG_UNKNOWNREC | BP_FLAG_INVALID_CIPHER_SUITEID |
@@ -90,10 +150,7 @@ void bplib_os_enable_log_flags(uint32_t enable_mask)
  *-------------------------------------------------------------------------------------*/
 void bplib_os_init()
 {
-    pthread_mutexattr_t locks_attr;
-    pthread_mutexattr_init(&locks_attr);
-    pthread_mutexattr_settype(&locks_attr, PTHREAD_MUTEX_RECURSIVE);
-    pthread_mutex_init(&lock_of_locks, &locks_attr);
+    pthread_mutex_init(&lock_of_locks, NULL);
 
     clock_gettime(CLOCK_REALTIME, &prevnow);
 
@@ -198,6 +255,48 @@ int bplib_os_systime(unsigned long *sysnow)
     return status;
 }
 
+/*--------------------------------------------------------------------------------------
+ * bplib_os_monotime - returns milliseconds from an arbitrary fixed starting point
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_monotime(unsigned long *msnow)
+{
+    struct timespec now;
+
+    /* Get Monotonic Time */
+    if (clock_gettime(CLOCK_MONOTONIC, &now) != 0)
+    {
+        return BP_ERROR;
+    }
+
+    /* Return Time */
+    if (msnow)
+        *msnow = ((unsigned long)now.tv_sec * 1000) + ((unsigned long)now.tv_nsec / 1000000);
+
+    /* Return Status */
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_monotime_us - returns microseconds from an arbitrary fixed starting point
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_monotime_us(unsigned long *usnow)
+{
+    struct timespec now;
+
+    /* Get Monotonic Time */
+    if (clock_gettime(CLOCK_MONOTONIC, &now) != 0)
+    {
+        return BP_ERROR;
+    }
+
+    /* Return Time (wraps, only differences are meaningful) */
+    if (usnow)
+        *usnow = ((unsigned long)now.tv_sec * 1000000) + ((unsigned long)now.tv_nsec / 1000);
+
+    /* Return Status */
+    return BP_SUCCESS;
+}
+
 /*--------------------------------------------------------------------------------------
  * bplib_os_sleep
  *-------------------------------------------------------------------------------------*/
@@ -206,6 +305,18 @@ void bplib_os_sleep(int seconds)
     sleep(seconds);
 }
 
+/*--------------------------------------------------------------------------------------
+ * bplib_os_sleep_us
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_sleep_us(unsigned long usecs)
+{
+    struct timespec ts = {.tv_sec = usecs / 1000000, .tv_nsec = (usecs % 1000000) * 1000};
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+    {
+        /* resume the remaining time after a signal */
+    }
+}
+
 /*--------------------------------------------------------------------------------------
  * bplib_os_random -
  *-------------------------------------------------------------------------------------*/
@@ -233,9 +344,16 @@ bp_handle_t bplib_os_createlock(void)
                 {
                     pthread_mutexattr_t attr;
                     pthread_mutexattr_init(&attr);
-                    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+                    pthread_mutexattr_settype(&attr, BP_LOCK_MUTEX_TYPE);
                     pthread_mutex_init(&locks[i]->mutex, &attr);
-                    pthread_cond_init(&locks[i]->cond, NULL);
+
+                    pthread_condattr_t cond_attr;
+                    pthread_condattr_init(&cond_attr);
+#if BP_COND_SET_CLOCK
+                    pthread_condattr_setclock(&cond_attr, BP_COND_CLOCK);
+#endif
+                    pthread_cond_init(&locks[i]->cond, &cond_attr);
+                    pthread_condattr_destroy(&cond_attr);
                     handle = bp_handle_from_serial(i, BPLIB_HANDLE_OS_BASE);
                     break;
                 }
@@ -297,16 +415,39 @@ void bplib_os_signal(bp_handle_t h)
     pthread_cond_signal(&locks[handle]->cond);
 }
 
+/*--------------------------------------------------------------------------------------
+ * bplib_os_broadcast -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_broadcast(bp_handle_t h)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_OS_BASE);
+
+    pthread_cond_broadcast(&locks[handle]->cond);
+}
+
 /*--------------------------------------------------------------------------------------
  * bplib_os_waiton -
  *-------------------------------------------------------------------------------------*/
 int bplib_os_waiton(bp_handle_t h, int timeout_ms)
+{
+    if (timeout_ms == BP_PEND)
+    {
+        return bplib_os_waiton_us(h, BP_PEND);
+    }
+
+    return bplib_os_waiton_us(h, (long)timeout_ms * 1000);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_waiton_us - waits up to a number of microseconds to be signaled
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_waiton_us(bp_handle_t h, long timeout_us)
 {
     int handle = bp_handle_to_serial(h, BPLIB_HANDLE_OS_BASE);
     int status;
 
     /* Perform Wait */
-    if (timeout_ms == -1)
+    if (timeout_us == BP_PEND)
     {
         /* Block Forever until Success */
         status = pthread_cond_wait(&locks[handle]->cond, &locks[handle]->mutex);
@@ -319,13 +460,13 @@ int bplib_os_waiton(bp_handle_t h, int timeout_ms)
             status = BP_SUCCESS;
         }
     }
-    else if (timeout_ms > 0)
+    else if (timeout_us > 0)
     {
         /* Build Time Structure */
         struct timespec ts;
-        clock_gettime(CLOCK_REALTIME, &ts);
-        ts.tv_sec += (time_t)(timeout_ms / 1000);
-        ts.tv_nsec += (timeout_ms % 1000) * 1000000L;
+        clock_gettime(BP_COND_CLOCK, &ts);
+        ts.tv_sec += (time_t)(timeout_us / 1000000);
+        ts.tv_nsec += (timeout_us % 1000000) * 1000L;
         if (ts.tv_nsec >= 1000000000L)
         {
             ts.tv_nsec -= 1000000000L;
@@ -343,7 +484,7 @@ int bplib_os_waiton(bp_handle_t h, int timeout_ms)
             status = BP_SUCCESS;
         }
     }
-    else /* timeout_ms = 0 */
+    else /* timeout_us = 0 */
     {
         /* conditional does not support a non-blocking attempt
          * so treat it as an immediate timeout */
@@ -354,6 +495,274 @@ int bplib_os_waiton(bp_handle_t h, int timeout_ms)
     return status;
 }
 
+/*--------------------------------------------------------------------------------------
+ * bplib_os_waituntil - waits to be signaled until a deadline of bplib_os_monotime_us
+ *
+ *  Returns BP_TIMEOUT once the deadline has passed, so a caller that is woken without
+ *  the condition it waits for being met can wait again without extending its timeout
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_waituntil(bp_handle_t h, unsigned long deadline_us)
+{
+    unsigned long usnow;
+    if (bplib_os_monotime_us(&usnow) == BP_ERROR)
+    {
+        return BP_ERROR;
+    }
+
+    long remaining = (long)(deadline_us - usnow);
+    if (remaining <= 0)
+    {
+        return BP_TIMEOUT;
+    }
+
+    return bplib_os_waiton_us(h, remaining);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_mutex_init -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_mutex_init(bplib_os_mutex_t *m)
+{
+    __atomic_store_n(&m->state, BP_MUTEX_UNLOCKED, __ATOMIC_RELEASE);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_mutex_destroy -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_mutex_destroy(bplib_os_mutex_t *m)
+{
+    assert(__atomic_load_n(&m->state, __ATOMIC_ACQUIRE) == BP_MUTEX_UNLOCKED);
+    (void)m;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_mutex_lock - spins briefly, then sleeps on the state word until released
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_mutex_lock(bplib_os_mutex_t *m)
+{
+    int spins;
+    int c;
+
+    /* Spin while Held - critical sections guarded by these are short */
+    for (spins = 0; spins < BP_MUTEX_SPINS; spins++)
+    {
+        c = BP_MUTEX_UNLOCKED;
+        if (__atomic_compare_exchange_n(&m->state, &c, BP_MUTEX_LOCKED, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            return;
+        }
+    }
+
+    /* Mark Contended and Sleep - the holder wakes one waiter on unlock */
+    while (__atomic_exchange_n(&m->state, BP_MUTEX_CONTENDED, __ATOMIC_ACQUIRE) != BP_MUTEX_UNLOCKED)
+    {
+#ifdef __linux__
+        syscall(SYS_futex, &m->state, FUTEX_WAIT_PRIVATE, BP_MUTEX_CONTENDED, NULL, NULL, 0);
+#else
+        sched_yield();
+#endif
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_mutex_unlock -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_mutex_unlock(bplib_os_mutex_t *m)
+{
+    if (__atomic_exchange_n(&m->state, BP_MUTEX_UNLOCKED, __ATOMIC_RELEASE) == BP_MUTEX_CONTENDED)
+    {
+#ifdef __linux__
+        syscall(SYS_futex, &m->state, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#endif
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * thread_entry - adapts pthread entry point to bplib thread entry point
+ *-------------------------------------------------------------------------------------*/
+static void *thread_entry(void *arg)
+{
+    bplib_os_thread_t *t = (bplib_os_thread_t *)arg;
+    t->entry(t->parm);
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_createthread -
+ *-------------------------------------------------------------------------------------*/
+bp_handle_t bplib_os_createthread(void (*entry)(void *parm), void *parm)
+{
+    bp_handle_t handle = BP_INVALID_HANDLE;
+
+    pthread_mutex_lock(&lock_of_locks);
+    {
+        int i;
+        for (i = 0; i < BP_MAX_THREADS; i++)
+        {
+            if (threads[i] == NULL)
+            {
+                threads[i] = (bplib_os_thread_t *)bplib_os_calloc(sizeof(bplib_os_thread_t));
+                if (threads[i])
+                {
+                    threads[i]->entry = entry;
+                    threads[i]->parm  = parm;
+                    if (pthread_create(&threads[i]->thread, NULL, thread_entry, threads[i]) == 0)
+                    {
+                        handle = bp_handle_from_serial(i, BPLIB_HANDLE_THREAD_BASE);
+                    }
+                    else
+                    {
+                        bplib_os_free(threads[i]);
+                        threads[i] = NULL;
+                    }
+                }
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&lock_of_locks);
+
+    return handle;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_jointhread - waits for thread to return and releases it
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_jointhread(bp_handle_t h)
+{
+    int                handle = bp_handle_to_serial(h, BPLIB_HANDLE_THREAD_BASE);
+    bplib_os_thread_t *t;
+
+    pthread_mutex_lock(&lock_of_locks);
+    {
+        t               = threads[handle];
+        threads[handle] = NULL;
+    }
+    pthread_mutex_unlock(&lock_of_locks);
+
+    if (t == NULL || pthread_join(t->thread, NULL) != 0)
+    {
+        return BP_ERROR;
+    }
+
+    bplib_os_free(t);
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_createevent - returns a descriptor that polls readable while the event is set
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_createevent(void)
+{
+#ifdef __linux__
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd >= 0)
+    {
+        return fd;
+    }
+#endif
+
+    return BP_ERROR;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_destroyevent -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_destroyevent(int fd)
+{
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_setevent -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_setevent(int fd)
+{
+    if (fd >= 0)
+    {
+        uint64_t one = 1;
+        ssize_t  ret = write(fd, &one, sizeof(one));
+        (void)ret; /* counter can only fail to increment when already set */
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_clearevent -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_clearevent(int fd)
+{
+    if (fd >= 0)
+    {
+        uint64_t count;
+        ssize_t  ret = read(fd, &count, sizeof(count));
+        (void)ret; /* nothing to read when already clear */
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_waitevents - waits until any of the descriptors polls readable
+ *
+ *  ready - set for each descriptor that is readable; negative descriptors are ignored
+ *  failed - set for each descriptor that hung up, is in error, or is not open and so
+ *           will poll again at once without being readable; the caller should drop it
+ *
+ *  Returns the number of descriptors that are readable or failed, 0 on timeout, or BP_ERROR
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_waitevents(const int *fds, int num_fds, bool *ready, bool *failed, int timeout_ms)
+{
+    struct pollfd  local_pfds[BP_MAX_POLL_LOCAL];
+    struct pollfd *pfds = local_pfds;
+    int            i;
+
+    /* Allocate Descriptors that do not Fit on the Stack */
+    if (num_fds > BP_MAX_POLL_LOCAL)
+    {
+        pfds = (struct pollfd *)bplib_os_calloc(sizeof(struct pollfd) * num_fds);
+        if (pfds == NULL)
+        {
+            return BP_ERROR;
+        }
+    }
+
+    for (i = 0; i < num_fds; i++)
+    {
+        pfds[i].fd     = fds[i];
+        pfds[i].events = POLLIN;
+    }
+
+    int count = poll(pfds, (nfds_t)num_fds, timeout_ms);
+    if (count < 0 && errno == EINTR)
+    {
+        count = 0;
+    }
+
+    for (i = 0; i < num_fds; i++)
+    {
+        ready[i]  = (count > 0) && ((pfds[i].revents & POLLIN) != 0);
+        failed[i] = (count > 0) && !ready[i] && ((pfds[i].revents & (POLLHUP | POLLERR | POLLNVAL)) != 0);
+    }
+
+    if (pfds != local_pfds)
+    {
+        bplib_os_free(pfds);
+    }
+
+    return count < 0 ? BP_ERROR : count;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_numcpus - number of processors online
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_numcpus(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
 /*--------------------------------------------------------------------------------------
  * bplib_os_format -
  *-------------------------------------------------------------------------------------*/
@@ -388,28 +797,84 @@ int bplib_os_strnlen(const char *str, int maxlen)
 }
 
 /*----------------------------------------------------------------------------
- * bplib_os_calloc
+ * mem_charge - adds to (or with a negative size, takes from) memory statistics
+ *
+ *  Relaxed atomics as allocations are charged from any thread; a high water
+ *  mark is only raised, never lowered
+ *----------------------------------------------------------------------------*/
+static void mem_charge(bp_memstats_t *stats, int tag, long size)
+{
+    size_t  used[2];
+    size_t *high[2] = {&stats->high, &stats->tag_high[tag]};
+    int     i;
+
+    used[0] = __atomic_add_fetch(&stats->used, (size_t)size, __ATOMIC_RELAXED);
+    used[1] = __atomic_add_fetch(&stats->tag_used[tag], (size_t)size, __ATOMIC_RELAXED);
+
+    for (i = 0; size > 0 && i < 2; i++)
+    {
+        size_t h = __atomic_load_n(high[i], __ATOMIC_RELAXED);
+        while (used[i] > h && !__atomic_compare_exchange_n(high[i], &h, used[i], true, __ATOMIC_RELAXED,
+                                                             __ATOMIC_RELAXED))
+        {
+            /* h reloaded by failed exchange */
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * mem_latch - copies memory statistics
+ *----------------------------------------------------------------------------*/
+static void mem_latch(bp_memstats_t *dst, bp_memstats_t *src)
+{
+    int i;
+
+    dst->used = __atomic_load_n(&src->used, __ATOMIC_RELAXED);
+    dst->high = __atomic_load_n(&src->high, __ATOMIC_RELAXED);
+    for (i = 0; i < BP_NUM_MEM_TAGS; i++)
+    {
+        dst->tag_used[i] = __atomic_load_n(&src->tag_used[i], __ATOMIC_RELAXED);
+        dst->tag_high[i] = __atomic_load_n(&src->tag_high[i], __ATOMIC_RELAXED);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_os_calloc - allocates memory not charged to any subsystem
  *----------------------------------------------------------------------------*/
 void *bplib_os_calloc(size_t size)
 {
+    return bplib_os_calloc_tag(size, BP_MEM_OTHER);
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_os_calloc_tag - allocates memory charged to a subsystem (BP_MEM_xxx)
+ *
+ *  Also charged to the memory account of the calling thread, if one is set
+ *----------------------------------------------------------------------------*/
+void *bplib_os_calloc_tag(size_t size, int tag)
+{
+    assert(tag >= 0 && tag < BP_NUM_MEM_TAGS);
+
     /* Allocate Memory Block */
-    size_t   block_size = size + sizeof(size_t);
+    size_t   block_size = size + sizeof(bplib_os_memhdr_t);
     uint8_t *mem_ptr    = (uint8_t *)calloc(block_size, 1);
     if (mem_ptr)
     {
-        /* Prepend Amount */
-        size_t *size_ptr = (size_t *)mem_ptr;
-        *size_ptr        = block_size;
+        /* Prepend Header */
+        bplib_os_memhdr_t *hdr = (bplib_os_memhdr_t *)mem_ptr;
+        hdr->size              = block_size;
+        hdr->account           = memory_account;
+        hdr->tag               = tag;
 
         /* Update Statistics */
-        current_memory_allocated += block_size;
-        if (current_memory_allocated > highest_memory_allocated)
+        mem_charge(&memory_stats, tag, (long)block_size);
+        if (hdr->account)
         {
-            highest_memory_allocated = current_memory_allocated;
+            mem_charge(hdr->account, tag, (long)block_size);
         }
 
         /* Return User Block */
-        return (mem_ptr + sizeof(size_t));
+        return (mem_ptr + sizeof(bplib_os_memhdr_t));
     }
     else
     {
@@ -424,17 +889,20 @@ void bplib_os_free(void *ptr)
 {
     if (ptr)
     {
-        uint8_t *mem_ptr = (uint8_t *)ptr;
+        uint8_t *mem_ptr = (uint8_t *)ptr - sizeof(bplib_os_memhdr_t);
 
-        /* Read Amount */
-        size_t *size_ptr   = (size_t *)((uint8_t *)mem_ptr - sizeof(size_t));
-        size_t  block_size = *size_ptr;
+        /* Read Header */
+        bplib_os_memhdr_t *hdr = (bplib_os_memhdr_t *)mem_ptr;
 
         /* Update Statistics */
-        current_memory_allocated -= block_size;
+        mem_charge(&memory_stats, hdr->tag, -(long)hdr->size);
+        if (hdr->account)
+        {
+            mem_charge(hdr->account, hdr->tag, -(long)hdr->size);
+        }
 
         /* Free Memory Block */
-        free(mem_ptr - sizeof(size_t));
+        free(mem_ptr);
     }
 }
 
@@ -443,7 +911,9 @@ void bplib_os_free(void *ptr)
  *----------------------------------------------------------------------------*/
 size_t bplib_os_memused(void)
 {
-    return current_memory_allocated;
+    bp_memstats_t stats;
+    mem_latch(&stats, &memory_stats);
+    return stats.used;
 }
 
 /*----------------------------------------------------------------------------
@@ -451,5 +921,29 @@ size_t bplib_os_memused(void)
  *----------------------------------------------------------------------------*/
 size_t bplib_os_memhigh(void)
 {
-    return highest_memory_allocated;
+    bp_memstats_t stats;
+    mem_latch(&stats, &memory_stats);
+    return stats.high;
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_os_memstats - copies memory statistics of an account, or of all
+ *  allocations when account is NULL
+ *----------------------------------------------------------------------------*/
+void bplib_os_memstats(bp_memstats_t *stats, bp_memstats_t *account)
+{
+    mem_latch(stats, account ? account : &memory_stats);
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_os_memaccount - sets account charged with calling thread's allocations
+ *
+ *  Returns the previous account (NULL for none) so that it can be restored; an
+ *  account must outlive every allocation charged to it
+ *----------------------------------------------------------------------------*/
+bp_memstats_t *bplib_os_memaccount(bp_memstats_t *account)
+{
+    bp_memstats_t *prev = memory_account;
+    memory_account      = account;
+    return prev;
 }
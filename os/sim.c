@@ -0,0 +1,969 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#ifdef __linux__
+#define _GNU_SOURCE /* adaptive mutexes */
+#endif
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sched.h>
+#include <poll.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+#include "bplib.h"
+#include "bplib_os.h"
+
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+#define BP_MAX_LOG_ENTRY_SIZE 256
+#define BP_SIM_START_US       1000000 /* virtual monotonic time at start (zero is avoided as it often means unset) */
+#define BP_MUTEX_SPINS        100
+#define BP_MAX_POLL_LOCAL     64
+
+/* Virtual System Time at Start, Seconds since 2000 (Compile-Time Option) */
+#ifndef BP_SIM_EPOCH_SECS
+#define BP_SIM_EPOCH_SECS 631152000 /* 2020-01-01 */
+#endif
+
+/* Seed of the Pseudo Random Numbers, so Simulations are Repeatable (Compile-Time Option) */
+#ifndef BP_SIM_SEED
+#define BP_SIM_SEED 0x2545F491
+#endif
+
+/* Waitable Locks, about four per channel with the RAM storage service (Compile-Time Option) */
+#ifndef BP_MAX_LOCKS
+#define BP_MAX_LOCKS 128
+#endif
+
+/* Threads, including a service engine's worker per online processor (Compile-Time Option) */
+#ifndef BP_MAX_THREADS
+#define BP_MAX_THREADS 256
+#endif
+
+/* Mutex Type of Waitable Locks */
+#if !BPLIB_OS_FAST_LOCKS
+#define BP_LOCK_MUTEX_TYPE PTHREAD_MUTEX_RECURSIVE
+#elif defined(PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP)
+#define BP_LOCK_MUTEX_TYPE PTHREAD_MUTEX_ADAPTIVE_NP
+#else
+#define BP_LOCK_MUTEX_TYPE PTHREAD_MUTEX_DEFAULT
+#endif
+
+/* Clock of Waitable Locks - monotonic so waits are unaffected by steps in the system time */
+#if defined(_POSIX_MONOTONIC_CLOCK) && !defined(__APPLE__)
+#define BP_COND_CLOCK     CLOCK_MONOTONIC
+#define BP_COND_SET_CLOCK true
+#else
+#define BP_COND_CLOCK     CLOCK_REALTIME
+#define BP_COND_SET_CLOCK false
+#endif
+
+/* Inline Mutex States */
+#define BP_MUTEX_UNLOCKED  0
+#define BP_MUTEX_LOCKED    1
+#define BP_MUTEX_CONTENDED 2
+
+/******************************************************************************
+ TYPEDEFS
+ ******************************************************************************/
+
+typedef struct
+{
+    pthread_cond_t  cond;
+    pthread_mutex_t mutex;
+} bplib_os_lock_t;
+
+typedef struct
+{
+    pthread_t thread;
+    void (*entry)(void *parm);
+    void *parm;
+} bplib_os_thread_t;
+
+typedef struct
+{
+    size_t         size;    /* of memory block, including header */
+    bp_memstats_t *account; /* also charged with block, NULL for none */
+    int            tag;     /* subsystem charged with block */
+} bplib_os_memhdr_t;
+
+/******************************************************************************
+ FILE DATA
+ ******************************************************************************/
+
+static bplib_os_lock_t   *locks[BP_MAX_LOCKS]     = {0};
+static bplib_os_thread_t *threads[BP_MAX_THREADS] = {0};
+static pthread_mutex_t    lock_of_locks;
+
+static unsigned long sim_now_us  = BP_SIM_START_US; /* virtual monotonic time */
+static int           sim_threads = 0;               /* threads created and not yet joined */
+static uint32_t      sim_random  = BP_SIM_SEED;
+
+static bp_memstats_t           memory_stats;
+static __thread bp_memstats_t *memory_account = NULL; /* of calling thread */
+
+static uint32_t flag_log_enable = BP_FLAG_NONCOMPLIANT | BP_FLAG_DROPPED | BP_FLAG_BUNDLE_TOO_LARGE |
+                                  BP_FLAG_UNKNOWNREC | BP_FLAG_INVALID_CIPHER_SUITEID |
+                                  BP_FLAG_INVALID_BIB_RESULT_TYPE | BP_FLAG_INVALID_BIB_TARGET_TYPE |
+                                  BP_FLAG_FAILED_TO_PARSE | BP_FLAG_API_ERROR;
+
+/******************************************************************************
+ LOCAL FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * sim_now - current virtual monotonic time in microseconds
+ *-------------------------------------------------------------------------------------*/
+static unsigned long sim_now(void)
+{
+    return __atomic_load_n(&sim_now_us, __ATOMIC_ACQUIRE);
+}
+
+/*--------------------------------------------------------------------------------------
+ * sim_advance_to - moves the virtual clock forward to a time, never backwards
+ *
+ *  Threads blocked in a timed wait are woken so that they check their deadlines
+ *-------------------------------------------------------------------------------------*/
+static void sim_advance_to(unsigned long usecs)
+{
+    unsigned long now = sim_now();
+    while ((long)(usecs - now) > 0)
+    {
+        if (__atomic_compare_exchange_n(&sim_now_us, &now, usecs, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            break;
+        }
+    }
+
+    if (__atomic_load_n(&sim_threads, __ATOMIC_ACQUIRE) > 0)
+    {
+        int i;
+        pthread_mutex_lock(&lock_of_locks);
+        for (i = 0; i < BP_MAX_LOCKS; i++)
+        {
+            if (locks[i])
+            {
+                pthread_cond_broadcast(&locks[i]->cond);
+            }
+        }
+        pthread_mutex_unlock(&lock_of_locks);
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * sim_wait - waits on a lock until signaled or until the virtual clock reaches a deadline
+ *
+ *  With no other threads nothing can signal the caller, so the time passes in the wait:
+ *  the clock advances to the deadline and the wait times out.  Otherwise the caller
+ *  sleeps until it is signaled or some thread advances the clock (either returns
+ *  BP_SUCCESS while the deadline is not reached, like a spurious wakeup).
+ *-------------------------------------------------------------------------------------*/
+static int sim_wait(int handle, unsigned long deadline_us)
+{
+    if ((long)(deadline_us - sim_now()) <= 0)
+    {
+        return BP_TIMEOUT;
+    }
+
+    if (__atomic_load_n(&sim_threads, __ATOMIC_ACQUIRE) == 0)
+    {
+        sim_advance_to(deadline_us);
+        return BP_TIMEOUT;
+    }
+
+    if (pthread_cond_wait(&locks[handle]->cond, &locks[handle]->mutex) != 0)
+    {
+        return BP_ERROR;
+    }
+
+    return (long)(deadline_us - sim_now()) <= 0 ? BP_TIMEOUT : BP_SUCCESS;
+}
+
+/******************************************************************************
+ EXPORTED UTILITY FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_enable_log_flags -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_enable_log_flags(uint32_t enable_mask)
+{
+    flag_log_enable = enable_mask;
+}
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_init -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_init()
+{
+    pthread_mutex_init(&lock_of_locks, NULL);
+
+    sim_random = BP_SIM_SEED;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_log -
+ *
+ * Returns - the error code passed in (for convenience)
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_log(const char *file, unsigned int line, uint32_t *flags, uint32_t event, const char *fmt, ...)
+{
+    if ((flag_log_enable & event) == event)
+    {
+        char    formatted_string[BP_MAX_LOG_ENTRY_SIZE];
+        va_list args;
+        int     vlen, msglen;
+
+        /* Build Formatted String */
+        va_start(args, fmt);
+        vlen   = vsnprintf(formatted_string, BP_MAX_LOG_ENTRY_SIZE - 1, fmt, args);
+        msglen = vlen < BP_MAX_LOG_ENTRY_SIZE - 1 ? vlen : BP_MAX_LOG_ENTRY_SIZE - 1;
+        va_end(args);
+
+        /* Log Message */
+        if (msglen > 0)
+        {
+            char  log_message[BP_MAX_LOG_ENTRY_SIZE];
+            char *pathptr;
+
+            formatted_string[msglen] = '\0';
+
+            /* Chop Path in Filename */
+            pathptr = strrchr(file, '/');
+            if (pathptr)
+                pathptr++;
+            else
+                pathptr = (char *)file;
+
+            /* Create Log Message */
+            if (event != BP_FLAG_DIAGNOSTIC)
+            {
+                msglen = snprintf(log_message, BP_MAX_LOG_ENTRY_SIZE, "%s:%u:%08X:%s", pathptr, line, event,
+                                  formatted_string);
+            }
+            else
+            {
+                msglen = snprintf(log_message, BP_MAX_LOG_ENTRY_SIZE, "%s:%u:%s", pathptr, line, formatted_string);
+            }
+
+            /* Provide Truncation Indicator */
+            if (msglen > (BP_MAX_LOG_ENTRY_SIZE - 2))
+            {
+                log_message[BP_MAX_LOG_ENTRY_SIZE - 2] = '#';
+            }
+
+            /* Display Log Message */
+            printf("%s", log_message);
+        }
+    }
+
+    /* Set Event Flag and Return */
+    if (event > 0)
+    {
+        if (flags)
+            *flags |= event;
+        return BP_ERROR;
+    }
+    else
+    {
+        return BP_SUCCESS;
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_systime - returns virtual seconds since 2000
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_systime(unsigned long *sysnow)
+{
+    if (sysnow)
+        *sysnow = BP_SIM_EPOCH_SECS + ((sim_now() - BP_SIM_START_US) / 1000000);
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_monotime - returns virtual milliseconds
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_monotime(unsigned long *msnow)
+{
+    if (msnow)
+        *msnow = sim_now() / 1000;
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_monotime_us - returns virtual microseconds
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_monotime_us(unsigned long *usnow)
+{
+    if (usnow)
+        *usnow = sim_now();
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_sleep - advances the virtual clock
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_sleep(int seconds)
+{
+    if (seconds > 0)
+    {
+        sim_advance_to(sim_now() + ((unsigned long)seconds * 1000000));
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_sleep_us - advances the virtual clock
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_sleep_us(unsigned long usecs)
+{
+    sim_advance_to(sim_now() + usecs);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_random - xorshift32, the same sequence on every run
+ *-------------------------------------------------------------------------------------*/
+uint32_t bplib_os_random(void)
+{
+    uint32_t x = sim_random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    sim_random = x;
+    return x;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_createlock -
+ *-------------------------------------------------------------------------------------*/
+bp_handle_t bplib_os_createlock(void)
+{
+    bp_handle_t handle = BP_INVALID_HANDLE;
+
+    pthread_mutex_lock(&lock_of_locks);
+    {
+        int i;
+        for (i = 0; i < BP_MAX_LOCKS; i++)
+        {
+            if (locks[i] == NULL)
+            {
+                locks[i] = (bplib_os_lock_t *)bplib_os_calloc(sizeof(bplib_os_lock_t));
+                if (locks[i])
+                {
+                    pthread_mutexattr_t attr;
+                    pthread_mutexattr_init(&attr);
+                    pthread_mutexattr_settype(&attr, BP_LOCK_MUTEX_TYPE);
+                    pthread_mutex_init(&locks[i]->mutex, &attr);
+
+                    pthread_condattr_t cond_attr;
+                    pthread_condattr_init(&cond_attr);
+#if BP_COND_SET_CLOCK
+                    pthread_condattr_setclock(&cond_attr, BP_COND_CLOCK);
+#endif
+                    pthread_cond_init(&locks[i]->cond, &cond_attr);
+                    pthread_condattr_destroy(&cond_attr);
+                    handle = bp_handle_from_serial(i, BPLIB_HANDLE_OS_BASE);
+                    break;
+                }
+            }
+        }
+    }
+    pthread_mutex_unlock(&lock_of_locks);
+
+    return handle;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_destroylock -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_destroylock(bp_handle_t h)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_OS_BASE);
+
+    pthread_mutex_lock(&lock_of_locks);
+    {
+        if (locks[handle])
+        {
+            pthread_mutex_destroy(&locks[handle]->mutex);
+            pthread_cond_destroy(&locks[handle]->cond);
+            bplib_os_free(locks[handle]);
+            locks[handle] = NULL;
+        }
+    }
+    pthread_mutex_unlock(&lock_of_locks);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_lock -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_lock(bp_handle_t h)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_OS_BASE);
+
+    pthread_mutex_lock(&locks[handle]->mutex);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_unlock -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_unlock(bp_handle_t h)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_OS_BASE);
+
+    pthread_mutex_unlock(&locks[handle]->mutex);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_signal -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_signal(bp_handle_t h)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_OS_BASE);
+
+    pthread_cond_signal(&locks[handle]->cond);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_broadcast -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_broadcast(bp_handle_t h)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_OS_BASE);
+
+    pthread_cond_broadcast(&locks[handle]->cond);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_waiton -
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_waiton(bp_handle_t h, int timeout_ms)
+{
+    if (timeout_ms == BP_PEND)
+    {
+        return bplib_os_waiton_us(h, BP_PEND);
+    }
+
+    return bplib_os_waiton_us(h, (long)timeout_ms * 1000);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_waiton_us - waits up to a number of virtual microseconds to be signaled
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_waiton_us(bp_handle_t h, long timeout_us)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_OS_BASE);
+
+    if (timeout_us == BP_PEND)
+    {
+        /* Block Forever until Success */
+        if (pthread_cond_wait(&locks[handle]->cond, &locks[handle]->mutex) != 0)
+        {
+            return BP_ERROR;
+        }
+
+        return BP_SUCCESS;
+    }
+    else if (timeout_us > 0)
+    {
+        return sim_wait(handle, sim_now() + (unsigned long)timeout_us);
+    }
+
+    return BP_TIMEOUT;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_waituntil - waits to be signaled until a deadline of bplib_os_monotime_us
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_waituntil(bp_handle_t h, unsigned long deadline_us)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_OS_BASE);
+
+    return sim_wait(handle, deadline_us);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_mutex_init -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_mutex_init(bplib_os_mutex_t *m)
+{
+    __atomic_store_n(&m->state, BP_MUTEX_UNLOCKED, __ATOMIC_RELEASE);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_mutex_destroy -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_mutex_destroy(bplib_os_mutex_t *m)
+{
+    assert(__atomic_load_n(&m->state, __ATOMIC_ACQUIRE) == BP_MUTEX_UNLOCKED);
+    (void)m;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_mutex_lock - spins briefly, then sleeps on the state word until released
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_mutex_lock(bplib_os_mutex_t *m)
+{
+    int spins;
+    int c;
+
+    /* Spin while Held - critical sections guarded by these are short */
+    for (spins = 0; spins < BP_MUTEX_SPINS; spins++)
+    {
+        c = BP_MUTEX_UNLOCKED;
+        if (__atomic_compare_exchange_n(&m->state, &c, BP_MUTEX_LOCKED, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            return;
+        }
+    }
+
+    /* Mark Contended and Sleep - the holder wakes one waiter on unlock */
+    while (__atomic_exchange_n(&m->state, BP_MUTEX_CONTENDED, __ATOMIC_ACQUIRE) != BP_MUTEX_UNLOCKED)
+    {
+#ifdef __linux__
+        syscall(SYS_futex, &m->state, FUTEX_WAIT_PRIVATE, BP_MUTEX_CONTENDED, NULL, NULL, 0);
+#else
+        sched_yield();
+#endif
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_mutex_unlock -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_mutex_unlock(bplib_os_mutex_t *m)
+{
+    if (__atomic_exchange_n(&m->state, BP_MUTEX_UNLOCKED, __ATOMIC_RELEASE) == BP_MUTEX_CONTENDED)
+    {
+#ifdef __linux__
+        syscall(SYS_futex, &m->state, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#endif
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * thread_entry - adapts pthread entry point to bplib thread entry point
+ *-------------------------------------------------------------------------------------*/
+static void *thread_entry(void *arg)
+{
+    bplib_os_thread_t *t = (bplib_os_thread_t *)arg;
+    t->entry(t->parm);
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_createthread -
+ *-------------------------------------------------------------------------------------*/
+bp_handle_t bplib_os_createthread(void (*entry)(void *parm), void *parm)
+{
+    bp_handle_t handle = BP_INVALID_HANDLE;
+
+    pthread_mutex_lock(&lock_of_locks);
+    {
+        int i;
+        for (i = 0; i < BP_MAX_THREADS; i++)
+        {
+            if (threads[i] == NULL)
+            {
+                threads[i] = (bplib_os_thread_t *)bplib_os_calloc(sizeof(bplib_os_thread_t));
+                if (threads[i])
+                {
+                    threads[i]->entry = entry;
+                    threads[i]->parm  = parm;
+
+                    /* Counted before it starts, so its first wait already blocks */
+                    __atomic_add_fetch(&sim_threads, 1, __ATOMIC_ACQ_REL);
+                    if (pthread_create(&threads[i]->thread, NULL, thread_entry, threads[i]) == 0)
+                    {
+                        handle = bp_handle_from_serial(i, BPLIB_HANDLE_THREAD_BASE);
+                    }
+                    else
+                    {
+                        __atomic_sub_fetch(&sim_threads, 1, __ATOMIC_ACQ_REL);
+                        bplib_os_free(threads[i]);
+                        threads[i] = NULL;
+                    }
+                }
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&lock_of_locks);
+
+    return handle;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_jointhread - waits for thread to return and releases it
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_jointhread(bp_handle_t h)
+{
+    int                handle = bp_handle_to_serial(h, BPLIB_HANDLE_THREAD_BASE);
+    bplib_os_thread_t *t;
+
+    pthread_mutex_lock(&lock_of_locks);
+    {
+        t               = threads[handle];
+        threads[handle] = NULL;
+    }
+    pthread_mutex_unlock(&lock_of_locks);
+
+    if (t == NULL || pthread_join(t->thread, NULL) != 0)
+    {
+        return BP_ERROR;
+    }
+
+    __atomic_sub_fetch(&sim_threads, 1, __ATOMIC_ACQ_REL);
+    bplib_os_free(t);
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_createevent - returns a descriptor that polls readable while the event is set
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_createevent(void)
+{
+#ifdef __linux__
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd >= 0)
+    {
+        return fd;
+    }
+#endif
+
+    return BP_ERROR;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_destroyevent -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_destroyevent(int fd)
+{
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_setevent -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_setevent(int fd)
+{
+    if (fd >= 0)
+    {
+        uint64_t one = 1;
+        ssize_t  ret = write(fd, &one, sizeof(one));
+        (void)ret; /* counter can only fail to increment when already set */
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_clearevent -
+ *-------------------------------------------------------------------------------------*/
+void bplib_os_clearevent(int fd)
+{
+    if (fd >= 0)
+    {
+        uint64_t count;
+        ssize_t  ret = read(fd, &count, sizeof(count));
+        (void)ret; /* nothing to read when already clear */
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_waitevents - waits until any of the descriptors polls readable
+ *
+ *  ready - set for each descriptor that is readable; negative descriptors are ignored
+ *  failed - set for each descriptor that hung up, is in error, or is not open and so
+ *           will poll again at once without being readable; the caller should drop it
+ *
+ *  Returns the number of descriptors that are readable or failed, 0 on timeout, or BP_ERROR
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_waitevents(const int *fds, int num_fds, bool *ready, bool *failed, int timeout_ms)
+{
+    struct pollfd  local_pfds[BP_MAX_POLL_LOCAL];
+    struct pollfd *pfds = local_pfds;
+    int            i;
+
+    /* Allocate Descriptors that do not Fit on the Stack */
+    if (num_fds > BP_MAX_POLL_LOCAL)
+    {
+        pfds = (struct pollfd *)bplib_os_calloc(sizeof(struct pollfd) * num_fds);
+        if (pfds == NULL)
+        {
+            return BP_ERROR;
+        }
+    }
+
+    for (i = 0; i < num_fds; i++)
+    {
+        pfds[i].fd     = fds[i];
+        pfds[i].events = POLLIN;
+    }
+
+    /* Check, then Wait - in virtual time unless other threads could set an event */
+    int count = poll(pfds, (nfds_t)num_fds, 0);
+    if (count == 0 && timeout_ms != 0)
+    {
+        if (timeout_ms > 0 && __atomic_load_n(&sim_threads, __ATOMIC_ACQUIRE) == 0)
+        {
+            sim_advance_to(sim_now() + ((unsigned long)timeout_ms * 1000));
+        }
+        else
+        {
+            count = poll(pfds, (nfds_t)num_fds, timeout_ms);
+        }
+    }
+    if (count < 0 && errno == EINTR)
+    {
+        count = 0;
+    }
+
+    for (i = 0; i < num_fds; i++)
+    {
+        ready[i]  = (count > 0) && ((pfds[i].revents & POLLIN) != 0);
+        failed[i] = (count > 0) && !ready[i] && ((pfds[i].revents & (POLLHUP | POLLERR | POLLNVAL)) != 0);
+    }
+
+    if (pfds != local_pfds)
+    {
+        bplib_os_free(pfds);
+    }
+
+    return count < 0 ? BP_ERROR : count;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_numcpus - number of processors online
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_numcpus(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_format -
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_format(char *dst, size_t len, const char *fmt, ...)
+{
+    va_list args;
+    int     vlen;
+
+    /* Build Formatted String */
+    va_start(args, fmt);
+    vlen = vsnprintf(dst, len, fmt, args);
+    va_end(args);
+
+    /* Return Error Code */
+    return vlen;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_os_strnlen -
+ *-------------------------------------------------------------------------------------*/
+int bplib_os_strnlen(const char *str, int maxlen)
+{
+    int len;
+    for (len = 0; len < maxlen; len++)
+    {
+        if (str[len] == '\0')
+        {
+            return len;
+        }
+    }
+    return maxlen;
+}
+
+/*----------------------------------------------------------------------------
+ * mem_charge - adds to (or with a negative size, takes from) memory statistics
+ *
+ *  Relaxed atomics as allocations are charged from any thread; a high water
+ *  mark is only raised, never lowered
+ *----------------------------------------------------------------------------*/
+static void mem_charge(bp_memstats_t *stats, int tag, long size)
+{
+    size_t  used[2];
+    size_t *high[2] = {&stats->high, &stats->tag_high[tag]};
+    int     i;
+
+    used[0] = __atomic_add_fetch(&stats->used, (size_t)size, __ATOMIC_RELAXED);
+    used[1] = __atomic_add_fetch(&stats->tag_used[tag], (size_t)size, __ATOMIC_RELAXED);
+
+    for (i = 0; size > 0 && i < 2; i++)
+    {
+        size_t h = __atomic_load_n(high[i], __ATOMIC_RELAXED);
+        while (used[i] > h && !__atomic_compare_exchange_n(high[i], &h, used[i], true, __ATOMIC_RELAXED,
+                                                             __ATOMIC_RELAXED))
+        {
+            /* h reloaded by failed exchange */
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * mem_latch - copies memory statistics
+ *----------------------------------------------------------------------------*/
+static void mem_latch(bp_memstats_t *dst, bp_memstats_t *src)
+{
+    int i;
+
+    dst->used = __atomic_load_n(&src->used, __ATOMIC_RELAXED);
+    dst->high = __atomic_load_n(&src->high, __ATOMIC_RELAXED);
+    for (i = 0; i < BP_NUM_MEM_TAGS; i++)
+    {
+        dst->tag_used[i] = __atomic_load_n(&src->tag_used[i], __ATOMIC_RELAXED);
+        dst->tag_high[i] = __atomic_load_n(&src->tag_high[i], __ATOMIC_RELAXED);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_os_calloc - allocates memory not charged to any subsystem
+ *----------------------------------------------------------------------------*/
+void *bplib_os_calloc(size_t size)
+{
+    return bplib_os_calloc_tag(size, BP_MEM_OTHER);
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_os_calloc_tag - allocates memory charged to a subsystem (BP_MEM_xxx)
+ *
+ *  Also charged to the memory account of the calling thread, if one is set
+ *----------------------------------------------------------------------------*/
+void *bplib_os_calloc_tag(size_t size, int tag)
+{
+    assert(tag >= 0 && tag < BP_NUM_MEM_TAGS);
+
+    /* Allocate Memory Block */
+    size_t   block_size = size + sizeof(bplib_os_memhdr_t);
+    uint8_t *mem_ptr    = (uint8_t *)calloc(block_size, 1);
+    if (mem_ptr)
+    {
+        /* Prepend Header */
+        bplib_os_memhdr_t *hdr = (bplib_os_memhdr_t *)mem_ptr;
+        hdr->size              = block_size;
+        hdr->account           = memory_account;
+        hdr->tag               = tag;
+
+        /* Update Statistics */
+        mem_charge(&memory_stats, tag, (long)block_size);
+        if (hdr->account)
+        {
+            mem_charge(hdr->account, tag, (long)block_size);
+        }
+
+        /* Return User Block */
+        return (mem_ptr + sizeof(bplib_os_memhdr_t));
+    }
+    else
+    {
+        return NULL;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_os_free
+ *----------------------------------------------------------------------------*/
+void bplib_os_free(void *ptr)
+{
+    if (ptr)
+    {
+        uint8_t *mem_ptr = (uint8_t *)ptr - sizeof(bplib_os_memhdr_t);
+
+        /* Read Header */
+        bplib_os_memhdr_t *hdr = (bplib_os_memhdr_t *)mem_ptr;
+
+        /* Update Statistics */
+        mem_charge(&memory_stats, hdr->tag, -(long)hdr->size);
+        if (hdr->account)
+        {
+            mem_charge(hdr->account, hdr->tag, -(long)hdr->size);
+        }
+
+        /* Free Memory Block */
+        free(mem_ptr);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_os_memused - how many bytes of memory currently allocated
+ *----------------------------------------------------------------------------*/
+size_t bplib_os_memused(void)
+{
+    bp_memstats_t stats;
+    mem_latch(&stats, &memory_stats);
+    return stats.used;
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_os_memhigh - the most total bytes in allocation at any given time
+ *----------------------------------------------------------------------------*/
+size_t bplib_os_memhigh(void)
+{
+    bp_memstats_t stats;
+    mem_latch(&stats, &memory_stats);
+    return stats.high;
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_os_memstats - copies memory statistics of an account, or of all
+ *  allocations when account is NULL
+ *----------------------------------------------------------------------------*/
+void bplib_os_memstats(bp_memstats_t *stats, bp_memstats_t *account)
+{
+    mem_latch(stats, account ? account : &memory_stats);
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_os_memaccount - sets account charged with calling thread's allocations
+ *
+ *  Returns the previous account (NULL for none) so that it can be restored; an
+ *  account must outlive every allocation charged to it
+ *----------------------------------------------------------------------------*/
+bp_memstats_t *bplib_os_memaccount(bp_memstats_t *account)
+{
+    bp_memstats_t *prev = memory_account;
+    memory_account      = account;
+    return prev;
+}
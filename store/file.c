@@ -25,20 +25,31 @@
 #include "bplib.h"
 #include "bplib_store_file.h"
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define FILE_MMAP_SUPPORTED
+#endif
+
 /******************************************************************************
  DEFINES
  ******************************************************************************/
 
 #define FILE_FLUSH_DEFAULT true
 #define FILE_MAX_FILENAME  256
-#define FILE_DATA_COUNT    256 /* Cannot be changed without changing macros */
-#define FILE_MEM_LOCKED    1
-#define FILE_MEM_AVAIABLE  0
+#define FILE_MAX_NAME      64
+#define FILE_CACHE_NULL    (-1)
+#define FILE_INDEX_MAGIC   0x42504958 /* "BPIX" */
+#define FILE_OBJECT_ALIGN  8          /* objects are padded so that the next one is aligned in a mapping */
 
 /* Dynamically Set Attributes */
 
-#define FILE_DEFAULT_CACHE_SIZE 16384
-#define FILE_DEFAULT_ROOT       ".pfile"
+#define FILE_DEFAULT_CACHE_SIZE         16384
+#define FILE_DEFAULT_ROOT               ".pfile"
+#define FILE_DEFAULT_WRITE_BEHIND_DEPTH 1024
+#define FILE_DEFAULT_SEGMENT_SIZE       256
 
 /* Configurable Options */
 
@@ -46,38 +57,81 @@
 #define FILE_MAX_STORES 60
 #endif
 
+#ifndef FILE_MAP_CHUNK_SIZE
+#define FILE_MAP_CHUNK_SIZE 0x100000 /* (Compile-Time Option) smallest mapping of a segment file, doubled as it grows */
+#endif
+
+#ifndef FILE_WRITE_BEHIND_RETRY_MS
+#define FILE_WRITE_BEHIND_RETRY_MS 100 /* (Compile-Time Option) delay before I/O thread retries a failed write */
+#endif
+
 /******************************************************************************
  MACROS
  ******************************************************************************/
 
-#define GET_DATAID(sid)     (sid - 1)
-#define GET_FILEID(did)     ((did) >> 8)
-#define GET_DATAOFFSET(did) ((uint8_t)((did)&0xFF))
+#define GET_DATAID(sid)         (sid - 1)
+#define GET_FILEID(fs, did)     ((did) / (unsigned long)(fs)->segment_size)
+#define GET_DATAOFFSET(fs, did) ((did) % (unsigned long)(fs)->segment_size)
 
 /******************************************************************************
  TYPEDEFS
  ******************************************************************************/
 
+/* file_region_t - memory mapping of a segment file, kept until it is replaced and no object views it */
+typedef struct
+{
+    unsigned char *base;
+    size_t         length;  /* bytes mapped, which may extend past the end of the file as it is written */
+    int            views;   /* cached objects that point into the mapping */
+    bool           retired; /* replaced by another mapping, unmapped once the last view is removed */
+} file_region_t;
+
 typedef struct
 {
-    void         *mem_ptr;
-    bool          mem_locked;
+    void          *mem_ptr;
+    file_region_t *mem_region; /* mapping that mem_ptr points into, NULL when mem_ptr was allocated */
+    int            mem_locked; /* number of dequeues/retrieves not yet released, never evicted while non-zero */
     unsigned long mem_data_id;
+    int           hash_next;   /* next entry in hash bucket, or in free list when unused */
+    int           lru_newer;   /* next more recently used unlocked entry */
+    int           lru_older;   /* next less recently used unlocked entry */
 } data_cache_t;
 
 typedef struct
 {
-    bool freed[FILE_DATA_COUNT];
-    int  free_cnt;
+    int   free_cnt;    /* number of objects in segment relinquished */
+    int   compact_cnt; /* value of free_cnt when segment was last compacted */
+    bool *freed;       /* segment_size entries, true when object is relinquished */
 } free_table_t;
 
+typedef struct
+{
+    file_region_t *region;      /* current mapping of segment file, NULL when unmapped */
+    unsigned long  file_id;     /* segment file currently mapped */
+    int            num_indexed; /* number of entries in offsets that are known */
+    size_t        *offsets;     /* byte offset of each object in the segment file */
+} file_map_t;
+
+typedef struct
+{
+    uint32_t      magic;              /* FILE_INDEX_MAGIC */
+    int           segment_size;       /* number of objects per segment file */
+    unsigned long write_data_id;      /* objects with lower ids were in the segment files when saved */
+    unsigned long first_file_id;      /* oldest segment file that may still hold objects */
+    unsigned long relinquish_data_id; /* identifies segment of relinquish table */
+    int           data_count;         /* number of objects not relinquished */
+} file_index_t;
+
 typedef struct
 {
     bool        in_use;
     bp_handle_t lock;
     uint64_t    service_id;
     char       *file_root;
+    char        file_name[FILE_MAX_NAME]; /* prefix of the segment, table, and index file names */
     int         data_count;
+    int         segment_size;      /* number of objects per segment file */
+    int         compact_threshold; /* percent of segment relinquished before it is compacted */
 
     FILE         *write_fd;
     unsigned long write_data_id;
@@ -86,6 +140,7 @@ typedef struct
     FILE         *read_fd;
     unsigned long read_data_id;
     bool          read_error;
+    unsigned long read_pos_id; /* sid of object read file is positioned at */
 
     FILE         *retrieve_fd;
     unsigned long retrieve_data_id;
@@ -94,9 +149,45 @@ typedef struct
     unsigned long relinquish_data_id;
     free_table_t  relinquish_table;
 
-    data_cache_t *data_cache;
-    int           cache_size;
-    bool          flush_on_write;
+    data_cache_t   *data_cache;
+    int             cache_size;
+    int            *cache_buckets;  /* first entry of each hash bucket, indexed by data id */
+    unsigned long   cache_mask;     /* number of hash buckets minus one */
+    int             cache_free;     /* list of unused entries */
+    int             cache_newest;   /* most recently used unlocked entry */
+    int             cache_oldest;   /* least recently used unlocked entry, next to be evicted */
+    int             prefetch_count; /* objects read ahead into cache on a read from a segment file */
+    bp_file_stats_t stats;
+    bool            flush_on_write;
+
+    bool       map_segments;
+    file_map_t read_map;
+    file_map_t retrieve_map;
+
+    int           commit_count;   /* commit after this many objects, 0 disables group commit */
+    int           commit_period;  /* milliseconds after first uncommitted object that it is committed */
+    int           commit_pending; /* number of objects written since last commit */
+    unsigned long commit_start;   /* time of first uncommitted object */
+    unsigned long commit_data_id; /* objects with lower data ids are committed */
+    int           commit_waiters; /* enqueues blocked in wait_for_commit */
+
+    bool          recover;         /* true: an index file is kept so the store can be recovered after a reset */
+    int           type;            /* type and endpoint of store, identifies it on recovery */
+    bp_ipn_t      node;
+    bp_ipn_t      service;
+    unsigned long first_file_id;   /* oldest segment file that may still hold objects */
+    unsigned long recover_data_id; /* dequeue skips relinquished objects with lower ids, which were recovered */
+    unsigned long recover_file_id; /* segment of recover_table */
+    free_table_t  recover_table;
+
+    bool            write_behind;  /* true: objects are written to file by the I/O thread */
+    bool            wb_running;    /* cleared to stop the I/O thread */
+    bool            wb_wakeup;     /* set to wake the I/O thread, protected by wb_lock */
+    bp_handle_t     wb_lock;       /* I/O thread waits on this lock for objects */
+    bp_handle_t     wb_thread;     /* I/O thread */
+    unsigned char **wb_queue;      /* objects not yet written, indexed by write data id */
+    int             wb_depth;      /* maximum number of objects in wb_queue */
+    unsigned long   wb_written_id; /* objects with lower data ids are in the segment files */
 } file_store_t;
 
 /******************************************************************************
@@ -107,8 +198,23 @@ static file_store_t file_stores[FILE_MAX_STORES];
 
 static uint64_t file_service_id = 0;
 
-static bp_file_driver_t file_driver = {
-    .open = fopen, .close = fclose, .read = fread, .write = fwrite, .seek = fseek, .flush = fflush};
+#ifdef FILE_MMAP_SUPPORTED
+static int file_sync(FILE *stream)
+{
+    return fsync(fileno(stream));
+}
+#define FILE_SYNC file_sync
+#else
+#define FILE_SYNC NULL
+#endif
+
+static bp_file_driver_t file_driver = {.open  = fopen,
+                                       .close = fclose,
+                                       .read  = fread,
+                                       .write = fwrite,
+                                       .seek  = fseek,
+                                       .flush = fflush,
+                                       .sync  = FILE_SYNC};
 
 /******************************************************************************
  LOCAL FUNCTIONS
@@ -117,12 +223,12 @@ static bp_file_driver_t file_driver = {
 /*--------------------------------------------------------------------------------------
  * open_dat_file -
  *-------------------------------------------------------------------------------------*/
-BP_LOCAL_SCOPE FILE *open_dat_file(int service_id, char *file_root, uint32_t file_id, bool read_only)
+BP_LOCAL_SCOPE FILE *open_dat_file(const char *file_root, const char *file_name, uint32_t file_id, bool read_only)
 {
     FILE *fd;
 
     char filename[FILE_MAX_FILENAME];
-    bplib_os_format(filename, FILE_MAX_FILENAME, "%s/%d_%u.dat", file_root, service_id, file_id);
+    bplib_os_format(filename, FILE_MAX_FILENAME, "%s/%s_%u.dat", file_root, file_name, file_id);
 
     if (read_only)
     {
@@ -144,10 +250,10 @@ BP_LOCAL_SCOPE FILE *open_dat_file(int service_id, char *file_root, uint32_t fil
 /*--------------------------------------------------------------------------------------
  * delete_dat_file -
  *-------------------------------------------------------------------------------------*/
-BP_LOCAL_SCOPE int delete_dat_file(int service_id, char *file_root, uint32_t file_id)
+BP_LOCAL_SCOPE int delete_dat_file(const char *file_root, const char *file_name, uint32_t file_id)
 {
     char filename[FILE_MAX_FILENAME];
-    bplib_os_format(filename, FILE_MAX_FILENAME, "%s/%d_%u.dat", file_root, service_id, file_id);
+    bplib_os_format(filename, FILE_MAX_FILENAME, "%s/%s_%u.dat", file_root, file_name, file_id);
 
     int status = remove(filename);
 
@@ -162,12 +268,12 @@ BP_LOCAL_SCOPE int delete_dat_file(int service_id, char *file_root, uint32_t fil
 /*--------------------------------------------------------------------------------------
  * open_tbl_file -
  *-------------------------------------------------------------------------------------*/
-BP_LOCAL_SCOPE FILE *open_tbl_file(int service_id, char *file_root, uint32_t file_id, bool read_only)
+BP_LOCAL_SCOPE FILE *open_tbl_file(const char *file_root, const char *file_name, uint32_t file_id, bool read_only)
 {
     FILE *fd;
 
     char filename[FILE_MAX_FILENAME];
-    bplib_os_format(filename, FILE_MAX_FILENAME, "%s/%d_%u.tbl", file_root, service_id, file_id);
+    bplib_os_format(filename, FILE_MAX_FILENAME, "%s/%s_%u.tbl", file_root, file_name, file_id);
 
     if (read_only)
     {
@@ -189,10 +295,10 @@ BP_LOCAL_SCOPE FILE *open_tbl_file(int service_id, char *file_root, uint32_t fil
 /*--------------------------------------------------------------------------------------
  * delete_tbl_file -
  *-------------------------------------------------------------------------------------*/
-BP_LOCAL_SCOPE int delete_tbl_file(int service_id, char *file_root, uint32_t file_id)
+BP_LOCAL_SCOPE int delete_tbl_file(const char *file_root, const char *file_name, uint32_t file_id)
 {
     char filename[FILE_MAX_FILENAME];
-    bplib_os_format(filename, FILE_MAX_FILENAME, "%s/%d_%u.tbl", file_root, service_id, file_id);
+    bplib_os_format(filename, FILE_MAX_FILENAME, "%s/%s_%u.tbl", file_root, file_name, file_id);
 
     int status = remove(filename);
 
@@ -207,299 +313,2084 @@ BP_LOCAL_SCOPE int delete_tbl_file(int service_id, char *file_root, uint32_t fil
     }
 }
 
-/******************************************************************************
- EXPORTED FUNCTIONS
- ******************************************************************************/
+/*--------------------------------------------------------------------------------------
+ * free_object - free an object read from storage, or stop viewing it in a mapping
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void free_object(void *object_ptr, file_region_t *region)
+{
+#ifdef FILE_MMAP_SUPPORTED
+    if (region != NULL)
+    {
+        if (--region->views == 0 && region->retired)
+        {
+            munmap(region->base, region->length);
+            bplib_os_free(region);
+        }
+        return;
+    }
+#endif
+    bplib_os_free(object_ptr);
+}
 
 /*--------------------------------------------------------------------------------------
- * bplib_store_file_init -
+ * cache_link - add unlocked entry to newest end of LRU list
  *-------------------------------------------------------------------------------------*/
-void bplib_store_file_init(bp_file_driver_t *driver)
+BP_LOCAL_SCOPE void cache_link(file_store_t *fs, int index)
 {
-    if (driver)
-        file_driver = *driver;
+    data_cache_t *entry = &fs->data_cache[index];
 
-    memset(file_stores, 0, sizeof(file_stores));
+    entry->lru_newer = FILE_CACHE_NULL;
+    entry->lru_older = fs->cache_newest;
+    if (fs->cache_newest != FILE_CACHE_NULL)
+    {
+        fs->data_cache[fs->cache_newest].lru_newer = index;
+    }
+    else
+    {
+        fs->cache_oldest = index;
+    }
+    fs->cache_newest = index;
 }
 
 /*--------------------------------------------------------------------------------------
- * bplib_store_file_create -
+ * cache_unlink - remove unlocked entry from LRU list
  *-------------------------------------------------------------------------------------*/
-bp_handle_t bplib_store_file_create(int type, bp_ipn_t node, bp_ipn_t service, bool recover, void *parm)
+BP_LOCAL_SCOPE void cache_unlink(file_store_t *fs, int index)
 {
-    (void)type;
-    (void)node;
-    (void)service;
-    (void)recover;
-
-    bp_file_attr_t *attr = (bp_file_attr_t *)parm;
-    bp_handle_t     pending_h;
+    data_cache_t *entry = &fs->data_cache[index];
 
-    int s;
-    for (s = 0; s < FILE_MAX_STORES; s++)
+    if (entry->lru_newer != FILE_CACHE_NULL)
     {
-        if (file_stores[s].in_use == false)
-        {
-            pending_h = bp_handle_from_serial(s, BPLIB_HANDLE_FILE_STORE_BASE);
+        fs->data_cache[entry->lru_newer].lru_older = entry->lru_older;
+    }
+    else
+    {
+        fs->cache_newest = entry->lru_older;
+    }
 
-            /* Clear File Store (pointers set to NULL) */
-            memset(&file_stores[s], 0, sizeof(file_stores[s]));
-            file_stores[s].write_fd      = NULL;
-            file_stores[s].read_fd       = NULL;
-            file_stores[s].retrieve_fd   = NULL;
-            file_stores[s].relinquish_fd = NULL;
+    if (entry->lru_older != FILE_CACHE_NULL)
+    {
+        fs->data_cache[entry->lru_older].lru_newer = entry->lru_newer;
+    }
+    else
+    {
+        fs->cache_oldest = entry->lru_newer;
+    }
+}
 
-            /* Set In Use (necessary to be able to destroy later) */
-            file_stores[s].in_use = true;
+/*--------------------------------------------------------------------------------------
+ * cache_find - returns index of cache entry holding data id, or FILE_CACHE_NULL
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int cache_find(file_store_t *fs, unsigned long data_id)
+{
+    int index = fs->cache_buckets[data_id & fs->cache_mask];
+    while (index != FILE_CACHE_NULL && fs->data_cache[index].mem_data_id != data_id)
+    {
+        index = fs->data_cache[index].hash_next;
+    }
+    return index;
+}
 
-            /* Initialize Parameters */
-            file_stores[s].service_id         = file_service_id++;
-            file_stores[s].lock               = BP_INVALID_HANDLE;
-            file_stores[s].write_data_id      = 1;
-            file_stores[s].read_data_id       = 1;
-            file_stores[s].retrieve_data_id   = 1;
-            file_stores[s].relinquish_data_id = 1;
+/*--------------------------------------------------------------------------------------
+ * cache_lock - hold cache entry until it is released
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void cache_lock(file_store_t *fs, int index)
+{
+    if (fs->data_cache[index].mem_locked++ == 0)
+    {
+        cache_unlink(fs, index);
+    }
+}
 
-            /* Setup and Check Lock */
-            file_stores[s].lock = bplib_os_createlock();
-            if (!bp_handle_is_valid(file_stores[s].lock))
-            {
-                bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed (%d) to create FSS lock\n", file_stores[s].lock);
-                bplib_store_file_destroy(pending_h);
-                break;
-            }
+/*--------------------------------------------------------------------------------------
+ * cache_unlock - let go of cache entry, making it the newest eviction candidate once unused
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void cache_unlock(file_store_t *fs, int index)
+{
+    if (fs->data_cache[index].mem_locked > 0 && --fs->data_cache[index].mem_locked == 0)
+    {
+        cache_link(fs, index);
+    }
+}
 
-            /* Setup Root Path */
-            const char *root_path = FILE_DEFAULT_ROOT;
-            if (attr && attr->root_path)
-            {
-                root_path = attr->root_path;
-            }
-            int root_path_len = bplib_os_strnlen(root_path, FILE_MAX_FILENAME) + 1;
-            if (root_path_len <= FILE_MAX_FILENAME)
-            {
-                file_stores[s].file_root = (char *)bplib_os_calloc(root_path_len);
-                if (file_stores[s].file_root)
-                {
-                    memcpy(file_stores[s].file_root, root_path, root_path_len);
-                }
-            }
+/*--------------------------------------------------------------------------------------
+ * cache_remove - free object held by cache entry and return entry to free list
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void cache_remove(file_store_t *fs, int index)
+{
+    data_cache_t *entry = &fs->data_cache[index];
 
-            /* Check File Root Setup */
-            if (file_stores[s].file_root == NULL)
-            {
-                bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to set FSS root path\n");
-                bplib_store_file_destroy(pending_h);
-                break;
-            }
+    /* Remove from Hash Bucket */
+    int *link = &fs->cache_buckets[entry->mem_data_id & fs->cache_mask];
+    while (*link != index)
+    {
+        link = &fs->data_cache[*link].hash_next;
+    }
+    *link = entry->hash_next;
 
-            /* Setup Data Cache */
-            int cache_size = FILE_DEFAULT_CACHE_SIZE;
-            if (attr && attr->cache_size)
-            {
-                cache_size = attr->cache_size;
-            }
-            file_stores[s].cache_size = cache_size;
-            file_stores[s].data_cache = (data_cache_t *)bplib_os_calloc(cache_size * sizeof(data_cache_t));
+    /* Remove from LRU List */
+    if (entry->mem_locked == 0)
+    {
+        cache_unlink(fs, index);
+    }
 
-            /* Set Flush Attribute */
-            if (attr)
-            {
-                file_stores[s].flush_on_write = attr->flush_on_write;
-            }
-            else
-            {
-                file_stores[s].flush_on_write = FILE_FLUSH_DEFAULT;
-            }
+    /* Free Entry */
+    free_object(entry->mem_ptr, entry->mem_region);
+    entry->mem_ptr     = NULL;
+    entry->mem_region  = NULL;
+    entry->mem_data_id = BP_SID_VACANT;
+    entry->mem_locked  = 0;
+    entry->hash_next   = fs->cache_free;
+    fs->cache_free     = index;
+    fs->stats.cached_objects--;
+}
 
-            /* Check Data Cache Setup */
-            if (file_stores[s].data_cache == NULL)
-            {
-                bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to allocate FSS data cache\n");
-                bplib_store_file_destroy(pending_h);
-                break;
-            }
+/*--------------------------------------------------------------------------------------
+ * cache_available - true when an entry is free or can be evicted
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bool cache_available(file_store_t *fs)
+{
+    return fs->cache_free != FILE_CACHE_NULL || fs->cache_oldest != FILE_CACHE_NULL;
+}
 
-            /* Return Handle */
-            return pending_h;
+/*--------------------------------------------------------------------------------------
+ * cache_insert - returns index of new cache entry for object, or FILE_CACHE_NULL when all entries are locked
+ *
+ *  object_ptr - object owned by the cache once inserted
+ *  region - mapping that object_ptr views, or NULL when it was allocated
+ *  locked - true: object is being returned to the caller and is held until released
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int cache_insert(file_store_t *fs, unsigned long data_id, unsigned char *object_ptr,
+                                file_region_t *region, bool locked)
+{
+    /* Evict Least Recently Used Object */
+    if (fs->cache_free == FILE_CACHE_NULL)
+    {
+        if (fs->cache_oldest == FILE_CACHE_NULL)
+        {
+            return FILE_CACHE_NULL;
         }
+        cache_remove(fs, fs->cache_oldest);
+        fs->stats.evictions++;
     }
 
-    return BP_INVALID_HANDLE;
+    /* Take Entry off Free List */
+    int           index = fs->cache_free;
+    data_cache_t *entry = &fs->data_cache[index];
+    fs->cache_free      = entry->hash_next;
+
+    /* Add to Hash Bucket */
+    unsigned long bucket      = data_id & fs->cache_mask;
+    entry->mem_ptr            = object_ptr;
+    entry->mem_region         = region;
+    entry->mem_data_id        = data_id;
+    entry->hash_next          = fs->cache_buckets[bucket];
+    fs->cache_buckets[bucket] = index;
+    fs->stats.cached_objects++;
+
+    /* Hold or Make Available for Eviction */
+    if (locked)
+    {
+        entry->mem_locked = 1;
+    }
+    else
+    {
+        entry->mem_locked = 0;
+        cache_link(fs, index);
+    }
+
+    return index;
 }
 
 /*--------------------------------------------------------------------------------------
- * bplib_store_file_destroy -
+ * flush_dat_file - push buffered writes of a segment file out to where readers can see them
  *-------------------------------------------------------------------------------------*/
-int bplib_store_file_destroy(bp_handle_t h)
+BP_LOCAL_SCOPE void flush_dat_file(file_store_t *fs, unsigned long file_id)
 {
-    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_FILE_STORE_BASE);
-
-    assert(handle >= 0 && handle < FILE_MAX_STORES);
-    assert(file_stores[handle].in_use);
-
-    if (file_stores[handle].write_fd != NULL)
+    /* The I/O thread owns the write file and flushes each batch it writes */
+    if (fs->write_behind)
     {
-        file_driver.close(file_stores[handle].write_fd);
+        return;
     }
-    if (file_stores[handle].read_fd != NULL)
+
+    if (!fs->flush_on_write && fs->write_fd != NULL && GET_FILEID(fs, GET_DATAID(fs->write_data_id)) == file_id)
     {
-        file_driver.close(file_stores[handle].read_fd);
+        file_driver.flush(fs->write_fd);
     }
-    if (file_stores[handle].retrieve_fd != NULL)
+}
+
+/*--------------------------------------------------------------------------------------
+ * sync_dat_file - flush and sync current write file to stable storage
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int sync_dat_file(file_store_t *fs)
+{
+    int status = BP_SUCCESS;
+
+    if (fs->write_fd != NULL)
     {
-        file_driver.close(file_stores[handle].retrieve_fd);
+        int flush_status = file_driver.flush(fs->write_fd);
+        if (flush_status < 0)
+        {
+            status = bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to flush group commit\n", flush_status);
+        }
+        else if (file_driver.sync != NULL)
+        {
+            int sync_status = file_driver.sync(fs->write_fd);
+            if (sync_status < 0)
+            {
+                status = bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to sync group commit\n", sync_status);
+            }
+        }
     }
-    if (file_stores[handle].file_root != NULL)
+
+    return status;
+}
+
+/*--------------------------------------------------------------------------------------
+ * commit_objects - flush and sync all objects written since the last commit
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int commit_objects(file_store_t *fs)
+{
+    int status = sync_dat_file(fs);
+
+    if (status == BP_SUCCESS)
     {
-        bplib_os_free(file_stores[handle].file_root);
+        fs->commit_data_id = fs->write_data_id;
+        fs->commit_pending = 0;
+        bplib_os_broadcast(fs->lock);
     }
-    if (bp_handle_is_valid(file_stores[handle].lock))
+
+    return status;
+}
+
+/*--------------------------------------------------------------------------------------
+ * wake_waiter - wake a dequeue or cache waiter on the store lock
+ *
+ *  Enqueues waiting for a group commit share the condition of the store lock, so
+ *  while any are waiting a single signal could wake one of them instead, and
+ *  everyone is woken to recheck their own condition.
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void wake_waiter(file_store_t *fs)
+{
+    if (fs->commit_waiters > 0)
     {
-        bplib_os_destroylock(file_stores[handle].lock);
+        bplib_os_broadcast(fs->lock);
     }
-    if (file_stores[handle].data_cache != NULL)
+    else
     {
-        bplib_os_free(file_stores[handle].data_cache);
+        bplib_os_signal(fs->lock);
     }
+}
 
-    file_stores[handle].in_use = false;
+/*--------------------------------------------------------------------------------------
+ * commit_remaining - milliseconds until uncommitted objects are due to be committed
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE long commit_remaining(file_store_t *fs)
+{
+    unsigned long now;
 
-    return BP_SUCCESS;
+    bplib_os_monotime(&now);
+
+    return (long)(fs->commit_start + fs->commit_period) - (long)now;
 }
 
 /*--------------------------------------------------------------------------------------
- * bplib_store_file_enqueue -
+ * check_commit - commit objects whose commit period has elapsed
  *-------------------------------------------------------------------------------------*/
-int bplib_store_file_enqueue(bp_handle_t h, const void *data1, size_t data1_size, const void *data2, size_t data2_size,
-                             int timeout)
+BP_LOCAL_SCOPE void check_commit(file_store_t *fs)
 {
-    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_FILE_STORE_BASE);
-    (void)timeout;
-
-    assert(handle >= 0 && handle < FILE_MAX_STORES);
-    assert(file_stores[handle].in_use);
+    if (!fs->write_behind && fs->commit_pending > 0 && fs->commit_period > 0 && commit_remaining(fs) <= 0)
+    {
+        commit_objects(fs);
+    }
+}
 
-    /* Initialize Variables */
-    file_store_t *fs            = (file_store_t *)&file_stores[handle];
-    unsigned long data_size     = data1_size + data2_size;
-    unsigned long object_size   = sizeof(bp_object_hdr_t) + data_size;
-    unsigned long bytes_written = 0;
-    bool          flush_error   = false;
+/*--------------------------------------------------------------------------------------
+ * wait_for_commit - block until object is committed, committing it when no one else does
+ *
+ *  The wait is bounded by the commit period and by the caller's timeout; whichever
+ *  expires first, the waiting caller performs the commit itself, so on return the
+ *  object is always committed (or the commit failed).  With a commit period of 0
+ *  the caller commits at once, so only BP_CHECK enqueues are grouped.
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int wait_for_commit(file_store_t *fs, unsigned long data_id, int timeout)
+{
+    unsigned long start;
 
-    /* Get IDs */
-    unsigned long data_id     = GET_DATAID(fs->write_data_id);
-    unsigned long file_id     = GET_FILEID(data_id);
-    unsigned long data_offset = GET_DATAOFFSET(data_id);
+    bplib_os_monotime(&start);
 
-    /* Check Need to Open Write File */
-    if (fs->write_fd == NULL)
+    while (fs->commit_data_id <= data_id)
     {
-        /* Open Write File */
-        fs->write_fd = open_dat_file(fs->service_id, fs->file_root, file_id, false);
-        if (fs->write_fd == NULL)
+        long remaining = commit_remaining(fs);
+        if (timeout != BP_PEND)
         {
-            return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to enqueue data\n");
+            unsigned long now;
+            bplib_os_monotime(&now);
+            long timeout_remaining = (long)(start + timeout) - (long)now;
+            if (timeout_remaining < remaining)
+            {
+                remaining = timeout_remaining;
+            }
         }
 
-        /* Seek to Current Position */
+        if (remaining <= 0)
+        {
+            return commit_objects(fs);
+        }
+
+        fs->commit_waiters++;
+        int wait_status = bplib_os_waiton(fs->lock, (int)remaining);
+        fs->commit_waiters--;
+        if (wait_status == BP_ERROR)
+        {
+            return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to wait for group commit\n");
+        }
+    }
+
+    return BP_SUCCESS;
+}
+
+#ifdef FILE_MMAP_SUPPORTED
+
+/*--------------------------------------------------------------------------------------
+ * unmap_dat_file - let go of the current mapping, which is unmapped once no object views it
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void unmap_dat_file(file_map_t *map)
+{
+    if (map->region != NULL)
+    {
+        map->region->retired = true;
+        if (map->region->views == 0)
+        {
+            munmap(map->region->base, map->region->length);
+            bplib_os_free(map->region);
+        }
+        map->region = NULL;
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * map_dat_file - map segment file so that at least min_length bytes are accessible
+ *
+ *  Segment files grow while they are being written, so the mapping reserves room
+ *  past the end of the file, starting at FILE_MAP_CHUNK_SIZE and doubling each time
+ *  it is outgrown; pages past the end of the file become readable as the file is
+ *  extended, so objects written since the file was mapped are read without a
+ *  remap.  Only written objects are read, so nothing past the end of the file is
+ *  touched.  The mapping is private and writable so that the header of an object
+ *  viewed in place can be updated without changing the file.  The object offsets
+ *  already indexed stay valid across a remap.
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int map_dat_file(file_store_t *fs, file_map_t *map, unsigned long file_id, size_t min_length)
+{
+    struct stat    st;
+    unsigned char *base;
+    int            fd;
+
+    /* Check Current Mapping */
+    if (map->region != NULL && map->file_id == file_id && map->region->length >= min_length)
+    {
+        return BP_SUCCESS;
+    }
+
+    /* Make Pending Writes Visible */
+    flush_dat_file(fs, file_id);
+
+    /* Open Segment File */
+    char filename[FILE_MAX_FILENAME];
+    bplib_os_format(filename, FILE_MAX_FILENAME, "%s/%s_%lu.dat", fs->file_root, fs->file_name, file_id);
+    fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to open data file %s for mapping: %s\n", filename,
+                     strerror(errno));
+    }
+
+    /* Size Mapping */
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < min_length || st.st_size == 0)
+    {
+        close(fd);
+        return bplog(NULL, BP_FLAG_STORE_FAILURE, "Data file %s too short to map (%lu bytes)\n", filename,
+                     (unsigned long)min_length);
+    }
+    size_t length = FILE_MAP_CHUNK_SIZE;
+    if (map->region != NULL && map->file_id == file_id)
+    {
+        length = map->region->length * 2;
+    }
+    while (length < (size_t)st.st_size)
+    {
+        length *= 2;
+    }
+
+    /* Map Segment File */
+    file_region_t *region = (file_region_t *)bplib_os_calloc_tag(sizeof(file_region_t), BP_MEM_FILE);
+    base                  = (unsigned char *)mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (region == NULL || base == MAP_FAILED)
+    {
+        if (base != MAP_FAILED)
+        {
+            munmap(base, length);
+        }
+        bplib_os_free(region);
+        return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to map data file %s: %s\n", filename, strerror(errno));
+    }
+    region->base   = base;
+    region->length = length;
+
+    /* Reset Index When Switching Segments */
+    if (map->file_id != file_id || map->num_indexed == 0)
+    {
+        map->num_indexed = 1;
+        map->offsets[0]  = 0;
+    }
+
+    /* Replace Mapping */
+    unmap_dat_file(map);
+    map->region  = region;
+    map->file_id = file_id;
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * locate_mapped_object - find object in mapped segment, returns its size in bytes
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int locate_mapped_object(file_store_t *fs, file_map_t *map, unsigned long file_id, size_t offset,
+                                        unsigned long *object_size)
+{
+    /* Object Size Precedes Object */
+    if (map_dat_file(fs, map, file_id, offset + sizeof(unsigned long)) != BP_SUCCESS)
+    {
+        return BP_ERROR;
+    }
+    memcpy(object_size, map->region->base + offset, sizeof(unsigned long));
+
+    /* Object Must Be Completely Written */
+    return map_dat_file(fs, map, file_id, offset + sizeof(unsigned long) + *object_size);
+}
+
+/*--------------------------------------------------------------------------------------
+ * read_mapped_object - find object in mapped segment file
+ *
+ *  An object of a complete segment is returned in place, with region set to the
+ *  mapping it views; the mapping is kept until the cache entry holding the object
+ *  is removed.  The segment being written is still appended to, and an update to
+ *  a private page would hide objects written to that page later, so its objects
+ *  are copied out and region is set to NULL.  Returns NULL on failure.
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE unsigned char *read_mapped_object(file_store_t *fs, file_map_t *map, unsigned long file_id,
+                                                 unsigned long data_offset, file_region_t **region)
+{
+    unsigned long  next_write_id = fs->write_behind ? fs->wb_written_id : fs->write_data_id;
+    unsigned long  object_size;
+    unsigned char *object_ptr;
+
+    *region = NULL;
+
+    /* Make Pending Writes Visible */
+    flush_dat_file(fs, file_id);
+
+    /* Map Segment File */
+    if (map_dat_file(fs, map, file_id, sizeof(unsigned long)) != BP_SUCCESS)
+    {
+        return NULL;
+    }
+
+    /* Index Objects Up to Requested Offset */
+    while (map->num_indexed <= (int)data_offset)
+    {
+        size_t offset = map->offsets[map->num_indexed - 1];
+        if (locate_mapped_object(fs, map, file_id, offset, &object_size) != BP_SUCCESS)
+        {
+            return NULL;
+        }
+        map->offsets[map->num_indexed++] = offset + sizeof(unsigned long) + object_size;
+    }
+
+    /* Locate Object */
+    size_t offset = map->offsets[data_offset];
+    if (locate_mapped_object(fs, map, file_id, offset, &object_size) != BP_SUCCESS)
+    {
+        return NULL;
+    }
+
+    /* View Object of Complete Segment
+     *  objects of files written without padding are copied when they are not aligned */
+    unsigned char *mapped_ptr = map->region->base + offset + sizeof(unsigned long);
+    if (file_id < GET_FILEID(fs, GET_DATAID(next_write_id)) && ((uintptr_t)mapped_ptr % FILE_OBJECT_ALIGN) == 0)
+    {
+        *region = map->region;
+        map->region->views++;
+        return mapped_ptr;
+    }
+
+    /* Copy Object of Segment Being Written */
+    object_ptr = (unsigned char *)bplib_os_calloc_tag(object_size, BP_MEM_FILE);
+    if (object_ptr != NULL)
+    {
+        memcpy(object_ptr, mapped_ptr, object_size);
+    }
+
+    return object_ptr;
+}
+
+#endif
+
+/*--------------------------------------------------------------------------------------
+ * save_tbl_file - write relinquish table of segment to its table file
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int save_tbl_file(file_store_t *fs, unsigned long file_id)
+{
+    unsigned long bytes_written = 0;
+    unsigned long table_size    = (2 * sizeof(int)) + (fs->segment_size * sizeof(bool));
+
+    /* Open Relinquish File */
+    fs->relinquish_fd = open_tbl_file(fs->file_root, fs->file_name, file_id, false);
+    if (fs->relinquish_fd == NULL)
+    {
+        return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to relinquish data\n");
+    }
+
+    /* Write Relinquish Table */
+    bytes_written += file_driver.write(&fs->relinquish_table.free_cnt, 1, sizeof(int), fs->relinquish_fd);
+    bytes_written += file_driver.write(&fs->relinquish_table.compact_cnt, 1, sizeof(int), fs->relinquish_fd);
+    bytes_written +=
+        file_driver.write(fs->relinquish_table.freed, 1, fs->segment_size * sizeof(bool), fs->relinquish_fd);
+
+    /* Close Relinquish File */
+    file_driver.close(fs->relinquish_fd);
+    fs->relinquish_fd = NULL;
+
+    /* Check Status of Write */
+    if (bytes_written != table_size)
+    {
+        return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to update relinquish table (%lu != %lu)\n", bytes_written,
+                     table_size);
+    }
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * load_tbl_file - read relinquish table of segment, or start an empty one if none saved
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int load_tbl_file(file_store_t *fs, unsigned long file_id, free_table_t *table)
+{
+    unsigned long bytes_read = 0;
+    unsigned long table_size = (2 * sizeof(int)) + (fs->segment_size * sizeof(bool));
+
+    /* Open Relinquish File */
+    fs->relinquish_fd = open_tbl_file(fs->file_root, fs->file_name, file_id, true);
+    if (fs->relinquish_fd == NULL)
+    {
+        /* Initialize New Relinquish Table */
+        table->free_cnt    = 0;
+        table->compact_cnt = 0;
+        memset(table->freed, 0, fs->segment_size * sizeof(bool));
+        return BP_SUCCESS;
+    }
+
+    /* Read Relinquish Table */
+    bytes_read += file_driver.read(&table->free_cnt, 1, sizeof(int), fs->relinquish_fd);
+    bytes_read += file_driver.read(&table->compact_cnt, 1, sizeof(int), fs->relinquish_fd);
+    bytes_read += file_driver.read(table->freed, 1, fs->segment_size * sizeof(bool), fs->relinquish_fd);
+
+    /* Close Relinquish File */
+    file_driver.close(fs->relinquish_fd);
+    fs->relinquish_fd = NULL;
+
+    /* Check for Error */
+    if (bytes_read != table_size)
+    {
+        return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to read new relinquish table (%lu != %lu)\n", bytes_read,
+                     table_size);
+    }
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * compact_dat_file - rewrite segment file without the objects that were relinquished
+ *
+ *  Storage IDs encode the position of an object in its segment, so live objects
+ *  cannot move between segments; instead each relinquished object is replaced
+ *  with an empty record (a size of zero) so that the positions of the remaining
+ *  objects are unchanged and the file shrinks to the size of its live data.  Only
+ *  completely written segments are compacted.  The segment is copied to a
+ *  temporary file that is renamed over the original, so a failure part way
+ *  through leaves the original segment in place.
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int compact_dat_file(file_store_t *fs, unsigned long file_id, free_table_t *table)
+{
+    unsigned long  next_write_id = fs->write_behind ? fs->wb_written_id : fs->write_data_id;
+    unsigned char *object_ptr    = NULL;
+    unsigned long  object_size   = 0;
+    bool           copy_success  = true;
+
+    /* Check Segment Is Complete */
+    if (file_id >= GET_FILEID(fs, GET_DATAID(next_write_id)))
+    {
+        return BP_TIMEOUT;
+    }
+
+    /* Open Segment and Temporary File */
+    char tmpname[FILE_MAX_FILENAME];
+    char datname[FILE_MAX_FILENAME];
+    bplib_os_format(tmpname, FILE_MAX_FILENAME, "%s/%s_%lu.tmp", fs->file_root, fs->file_name, file_id);
+    bplib_os_format(datname, FILE_MAX_FILENAME, "%s/%s_%lu.dat", fs->file_root, fs->file_name, file_id);
+    FILE *src_fd = open_dat_file(fs->file_root, fs->file_name, file_id, true);
+    if (src_fd == NULL)
+    {
+        return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to open data file %s for compaction\n", datname);
+    }
+    FILE *dst_fd = file_driver.open(tmpname, "wb");
+    if (dst_fd == NULL)
+    {
+        file_driver.close(src_fd);
+        return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to create compacted file %s: %s\n", tmpname,
+                     strerror(errno));
+    }
+
+    /* Copy Live Objects */
+    int pos;
+    for (pos = 0; pos < fs->segment_size && copy_success; pos++)
+    {
+        if (file_driver.read(&object_size, 1, sizeof(object_size), src_fd) != sizeof(object_size))
+        {
+            copy_success = false;
+        }
+        else if (table->freed[pos] || object_size == 0)
+        {
+            /* Replace Relinquished Object with Empty Record */
+            unsigned long empty_size = 0;
+            copy_success = (file_driver.seek(src_fd, object_size, SEEK_CUR) >= 0) &&
+                           (file_driver.write(&empty_size, 1, sizeof(empty_size), dst_fd) == sizeof(empty_size));
+        }
+        else
+        {
+            /* Copy Object */
+            object_ptr = (unsigned char *)bplib_os_calloc_tag(object_size, BP_MEM_FILE);
+            copy_success =
+                (object_ptr != NULL) && (file_driver.read(object_ptr, 1, object_size, src_fd) == object_size) &&
+                (file_driver.write(&object_size, 1, sizeof(object_size), dst_fd) == sizeof(object_size)) &&
+                (file_driver.write(object_ptr, 1, object_size, dst_fd) == object_size);
+            if (object_ptr != NULL)
+            {
+                bplib_os_free(object_ptr);
+            }
+        }
+    }
+
+    /* Commit Compacted File */
+    if (copy_success)
+    {
+        copy_success = (file_driver.flush(dst_fd) >= 0) && (file_driver.sync == NULL || file_driver.sync(dst_fd) >= 0);
+    }
+    file_driver.close(src_fd);
+    file_driver.close(dst_fd);
+    if (!copy_success || rename(tmpname, datname) < 0)
+    {
+        remove(tmpname);
+        return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to compact data file %s\n", datname);
+    }
+
+    /* Readers of Segment Reposition in Compacted File */
+    if (fs->read_fd != NULL && GET_FILEID(fs, GET_DATAID(fs->read_data_id)) == file_id)
+    {
+        file_driver.close(fs->read_fd);
+        fs->read_fd = NULL;
+    }
+    if (fs->retrieve_fd != NULL && GET_FILEID(fs, GET_DATAID(fs->retrieve_data_id)) == file_id)
+    {
+        file_driver.close(fs->retrieve_fd);
+        fs->retrieve_fd = NULL;
+    }
+#ifdef FILE_MMAP_SUPPORTED
+    if (fs->read_map.file_id == file_id)
+    {
+        unmap_dat_file(&fs->read_map);
+        fs->read_map.num_indexed = 0;
+    }
+    if (fs->retrieve_map.file_id == file_id)
+    {
+        unmap_dat_file(&fs->retrieve_map);
+        fs->retrieve_map.num_indexed = 0;
+    }
+#endif
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * dat_file_exists -
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bool dat_file_exists(file_store_t *fs, unsigned long file_id)
+{
+    FILE *fd = open_dat_file(fs->file_root, fs->file_name, file_id, true);
+    if (fd == NULL)
+    {
+        return false;
+    }
+    file_driver.close(fd);
+    return true;
+}
+
+/*--------------------------------------------------------------------------------------
+ * save_idx_file - checkpoint cursors of a recoverable store, along with its current relinquish table
+ *
+ *  the index is written to a temporary file and renamed over the previous one,
+ *  so a reset while saving leaves the last complete index in place
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int save_idx_file(file_store_t *fs)
+{
+    if (!fs->recover)
+    {
+        return BP_SUCCESS;
+    }
+
+    /* Save Relinquish Table of Partially Relinquished Segment */
+    if (fs->relinquish_table.free_cnt > 0 && fs->relinquish_table.free_cnt < fs->segment_size)
+    {
+        save_tbl_file(fs, GET_FILEID(fs, GET_DATAID(fs->relinquish_data_id)));
+    }
+
+    /* Build Index */
+    file_index_t index = {.magic              = FILE_INDEX_MAGIC,
+                          .segment_size       = fs->segment_size,
+                          .write_data_id      = fs->write_behind ? fs->wb_written_id : fs->write_data_id,
+                          .first_file_id      = fs->first_file_id,
+                          .relinquish_data_id = fs->relinquish_data_id,
+                          .data_count         = fs->data_count};
+
+    /* Write Index */
+    char tmpname[FILE_MAX_FILENAME];
+    char idxname[FILE_MAX_FILENAME];
+    bplib_os_format(idxname, FILE_MAX_FILENAME, "%s/%s.idx", fs->file_root, fs->file_name);
+    bplib_os_format(tmpname, FILE_MAX_FILENAME, "%s.tmp", idxname);
+    FILE *fd = file_driver.open(tmpname, "wb");
+    if (fd == NULL)
+    {
+        return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to create index file %s: %s\n", tmpname, strerror(errno));
+    }
+    bool write_success = (file_driver.write(&index, 1, sizeof(index), fd) == sizeof(index)) &&
+                         (file_driver.flush(fd) >= 0) && (file_driver.sync == NULL || file_driver.sync(fd) >= 0);
+    file_driver.close(fd);
+    if (!write_success || rename(tmpname, idxname) < 0)
+    {
+        remove(tmpname);
+        return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to save index file %s\n", idxname);
+    }
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * load_idx_file - returns BP_TIMEOUT when no index was saved
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int load_idx_file(file_store_t *fs, file_index_t *index)
+{
+    char idxname[FILE_MAX_FILENAME];
+    bplib_os_format(idxname, FILE_MAX_FILENAME, "%s/%s.idx", fs->file_root, fs->file_name);
+
+    FILE *fd = file_driver.open(idxname, "rb");
+    if (fd == NULL)
+    {
+        return BP_TIMEOUT;
+    }
+    size_t bytes_read = file_driver.read(index, 1, sizeof(file_index_t), fd);
+    file_driver.close(fd);
+
+    if (bytes_read != sizeof(file_index_t) || index->magic != FILE_INDEX_MAGIC)
+    {
+        return bplog(NULL, BP_FLAG_STORE_FAILURE, "Invalid index file %s\n", idxname);
+    }
+    else if (index->segment_size != fs->segment_size)
+    {
+        return bplog(NULL, BP_FLAG_STORE_FAILURE, "Index file %s has segment size %d, store configured for %d\n",
+                     idxname, index->segment_size, fs->segment_size);
+    }
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * recover_dat_file - returns number of complete objects in segment file
+ *
+ *  an object that was only partly written when the store was reset is cut off
+ *  so that writes resume directly after the last complete object
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int recover_dat_file(file_store_t *fs, unsigned long file_id)
+{
+    unsigned long object_size = 0;
+    int           count       = 0;
+    bool          torn        = false;
+
+    FILE *src_fd = open_dat_file(fs->file_root, fs->file_name, file_id, true);
+    if (src_fd == NULL)
+    {
+        return 0;
+    }
+
+    /* Count Complete Objects */
+    while (count < fs->segment_size)
+    {
+        size_t bytes_read = file_driver.read(&object_size, 1, sizeof(object_size), src_fd);
+        if (bytes_read != sizeof(object_size))
+        {
+            torn = (bytes_read != 0);
+            break;
+        }
+
+        unsigned char *object_ptr = (unsigned char *)bplib_os_calloc_tag(object_size, BP_MEM_FILE);
+        bool           complete   = (object_ptr != NULL || object_size == 0) &&
+                          (file_driver.read(object_ptr, 1, object_size, src_fd) == object_size);
+        if (object_ptr != NULL)
+        {
+            bplib_os_free(object_ptr);
+        }
+        if (!complete)
+        {
+            torn = true;
+            break;
+        }
+
+        count++;
+    }
+
+    /* Cut Off Partial Object */
+    if (torn)
+    {
+        char tmpname[FILE_MAX_FILENAME];
+        char datname[FILE_MAX_FILENAME];
+        bplib_os_format(tmpname, FILE_MAX_FILENAME, "%s/%s_%lu.tmp", fs->file_root, fs->file_name, file_id);
+        bplib_os_format(datname, FILE_MAX_FILENAME, "%s/%s_%lu.dat", fs->file_root, fs->file_name, file_id);
+        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Dropping partial object %d of data file %s\n", count, datname);
+
+        bool  copy_success = (file_driver.seek(src_fd, 0, SEEK_SET) >= 0);
+        FILE *dst_fd       = file_driver.open(tmpname, "wb");
+        if (dst_fd != NULL)
+        {
+            int pos;
+            for (pos = 0; pos < count && copy_success; pos++)
+            {
+                if (file_driver.read(&object_size, 1, sizeof(object_size), src_fd) != sizeof(object_size))
+                {
+                    copy_success = false;
+                    break;
+                }
+                unsigned char *object_ptr = (unsigned char *)bplib_os_calloc_tag(object_size, BP_MEM_FILE);
+                copy_success =
+                    (object_ptr != NULL || object_size == 0) &&
+                    (file_driver.read(object_ptr, 1, object_size, src_fd) == object_size) &&
+                    (file_driver.write(&object_size, 1, sizeof(object_size), dst_fd) == sizeof(object_size)) &&
+                    (file_driver.write(object_ptr, 1, object_size, dst_fd) == object_size);
+                if (object_ptr != NULL)
+                {
+                    bplib_os_free(object_ptr);
+                }
+            }
+            copy_success = copy_success && (file_driver.flush(dst_fd) >= 0) &&
+                           (file_driver.sync == NULL || file_driver.sync(dst_fd) >= 0);
+            file_driver.close(dst_fd);
+        }
+        file_driver.close(src_fd);
+
+        if (dst_fd == NULL || !copy_success || rename(tmpname, datname) < 0)
+        {
+            remove(tmpname);
+            return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to remove partial object from data file %s\n", datname);
+        }
+    }
+    else
+    {
+        file_driver.close(src_fd);
+    }
+
+    return count;
+}
+
+/*--------------------------------------------------------------------------------------
+ * recover_store - restore state of store from its index file and the segment it ends in
+ *
+ *  only the segment files written since the index was saved are scanned, and the
+ *  read cursor restarts at the oldest segment that may still hold objects so that
+ *  bundles that were dequeued but never acknowledged before the reset are sent again
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int recover_store(file_store_t *fs)
+{
+    file_index_t index;
+
+    /* Load Index */
+    int status = load_idx_file(fs, &index);
+    if (status == BP_TIMEOUT)
+    {
+        /* Start Index for New Store */
+        return save_idx_file(fs);
+    }
+    else if (status != BP_SUCCESS)
+    {
+        return status;
+    }
+
+    /* Replay Segments Written Since Index */
+    unsigned long file_id = GET_FILEID(fs, GET_DATAID(index.write_data_id));
+    int           count   = 0;
+    while (true)
+    {
+        count = recover_dat_file(fs, file_id);
+        if (count != fs->segment_size)
+        {
+            break;
+        }
+        file_id++;
+    }
+    if (count < 0)
+    {
+        return count;
+    }
+
+    /* Restore Cursors
+     *  segments deleted after the index was saved are skipped */
+    unsigned long write_file_id = file_id;
+    fs->write_data_id           = (file_id * fs->segment_size) + count + 1;
+    fs->first_file_id           = index.first_file_id;
+    while (fs->first_file_id < write_file_id && !dat_file_exists(fs, fs->first_file_id))
+    {
+        fs->first_file_id++;
+    }
+    fs->read_data_id       = (fs->first_file_id * fs->segment_size) + 1;
+    fs->recover_data_id    = fs->write_data_id;
+    fs->relinquish_data_id = index.relinquish_data_id;
+    if (fs->read_data_id > fs->write_data_id)
+    {
+        fs->read_data_id = fs->write_data_id;
+    }
+
+    /* Restore Relinquish Table
+     *  the segment being relinquished may have been deleted before its table was saved */
+    unsigned long relinquish_file_id = GET_FILEID(fs, GET_DATAID(fs->relinquish_data_id));
+    status                           = load_tbl_file(fs, relinquish_file_id, &fs->relinquish_table);
+    if (status != BP_SUCCESS)
+    {
+        return status;
+    }
+    if (relinquish_file_id < write_file_id && !dat_file_exists(fs, relinquish_file_id))
+    {
+        fs->relinquish_table.free_cnt = fs->segment_size;
+        memset(fs->relinquish_table.freed, 1, fs->segment_size * sizeof(bool));
+    }
+
+    /* Count Objects Still Present
+     *  the count in the index can be stale by the objects relinquished since it was saved */
+    fs->data_count = 0;
+    for (file_id = fs->first_file_id; file_id <= write_file_id; file_id++)
+    {
+        int num_objects = fs->segment_size;
+        if (file_id == write_file_id)
+        {
+            num_objects = count;
+        }
+        if (num_objects == 0 || !dat_file_exists(fs, file_id))
+        {
+            continue;
+        }
+
+        int free_cnt = 0;
+        if (file_id == relinquish_file_id)
+        {
+            free_cnt = fs->relinquish_table.free_cnt;
+        }
+        else if (load_tbl_file(fs, file_id, &fs->recover_table) == BP_SUCCESS)
+        {
+            free_cnt = fs->recover_table.free_cnt;
+        }
+        if (free_cnt < num_objects)
+        {
+            fs->data_count += num_objects - free_cnt;
+        }
+    }
+    fs->recover_file_id = ULONG_MAX;
+
+    bplog(NULL, BP_FLAG_DIAGNOSTIC, "Recovered %d objects from ipn:%lu.%lu in file store\n", fs->data_count,
+          (unsigned long)fs->node, (unsigned long)fs->service);
+
+    /* Save Index of Recovered State */
+    return save_idx_file(fs);
+}
+
+/*--------------------------------------------------------------------------------------
+ * recovered_relinquished - true when recovered object was relinquished before the reset
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bool recovered_relinquished(file_store_t *fs, unsigned long sid)
+{
+    unsigned long data_id     = GET_DATAID(sid);
+    unsigned long file_id     = GET_FILEID(fs, data_id);
+    unsigned long data_offset = GET_DATAOFFSET(fs, data_id);
+
+    bool          relinquishing = (file_id == GET_FILEID(fs, GET_DATAID(fs->relinquish_data_id)));
+
+    /* Load Relinquish Table of Segment
+     *  a segment without a data file was entirely relinquished, even when it is the
+     *  segment being relinquished, whose table may not have been saved before the reset */
+    if (file_id != fs->recover_file_id)
+    {
+        fs->recover_file_id        = file_id;
+        fs->recover_table.free_cnt = 0;
+        if (!dat_file_exists(fs, file_id))
+        {
+            fs->recover_table.free_cnt = fs->segment_size;
+        }
+        else if (!relinquishing && load_tbl_file(fs, file_id, &fs->recover_table) != BP_SUCCESS)
+        {
+            fs->recover_table.free_cnt = 0;
+            memset(fs->recover_table.freed, 0, fs->segment_size * sizeof(bool));
+        }
+    }
+
+    if (fs->recover_table.free_cnt == fs->segment_size)
+    {
+        return true;
+    }
+    else if (relinquishing)
+    {
+        return fs->relinquish_table.freed[data_offset];
+    }
+
+    return fs->recover_table.freed[data_offset];
+}
+
+/*--------------------------------------------------------------------------------------
+ * write_dat_object - append object to its segment file
+ *
+ *  The object is written as its size followed by the object header and the data
+ *  buffers; the write file is left open so the caller decides when it is committed
+ *  and closed.
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int write_dat_object(file_store_t *fs, unsigned long write_data_id, const bp_object_hdr_t *header,
+                                    const void *data1, size_t data1_size, const void *data2, size_t data2_size)
+{
+    /* Initialize Variables */
+    static const uint8_t padding[FILE_OBJECT_ALIGN] = {0};
+    unsigned long        data_size     = sizeof(bp_object_hdr_t) + data1_size + data2_size;
+    unsigned long        object_size   = (data_size + FILE_OBJECT_ALIGN - 1) & ~(unsigned long)(FILE_OBJECT_ALIGN - 1);
+    unsigned long        bytes_written = 0;
+    bool                 flush_error   = false;
+
+    /* Get IDs */
+    unsigned long data_id     = GET_DATAID(write_data_id);
+    unsigned long file_id     = GET_FILEID(fs, data_id);
+    unsigned long data_offset = GET_DATAOFFSET(fs, data_id);
+
+    /* Check Need to Open Write File */
+    if (fs->write_fd == NULL)
+    {
+        /* Start New Segment
+         *  a file left behind by an earlier store is removed rather than appended to */
+        if (data_offset == 0 && dat_file_exists(fs, file_id))
+        {
+            delete_dat_file(fs->file_root, fs->file_name, file_id);
+        }
+
+        /* Open Write File */
+        fs->write_fd = open_dat_file(fs->file_root, fs->file_name, file_id, false);
+        if (fs->write_fd == NULL)
+        {
+            return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to enqueue data\n");
+        }
+
+        /* Seek to Current Position */
         if (fs->write_error)
         {
-            /* Start at Beginning of File */
-            int seek_status = file_driver.seek(fs->write_fd, 0, SEEK_SET);
-            if (seek_status < 0)
+            /* Start at Beginning of File */
+            int seek_status = file_driver.seek(fs->write_fd, 0, SEEK_SET);
+            if (seek_status < 0)
+            {
+                return bplog(NULL, BP_FLAG_STORE_FAILURE,
+                             "Failed (%d) to set write position after error to start of file\n", seek_status);
+            }
+
+            /* Read/Seek Through File */
+            unsigned long pos;
+            for (pos = 0; pos < data_offset; pos++)
+            {
+                unsigned long current_size;
+
+                /* Read Current Data Size */
+                unsigned long bytes_read = file_driver.read(&current_size, 1, sizeof(current_size), fs->write_fd);
+                if (bytes_read != sizeof(current_size))
+                {
+                    return bplog(NULL, BP_FLAG_STORE_FAILURE,
+                                 "Failed to read data size for write after error (%d != %d)\n", bytes_read,
+                                 sizeof(current_size));
+                }
+
+                /* Seek to End of Current Data */
+                seek_status = file_driver.seek(fs->write_fd, current_size, SEEK_CUR);
+                if (seek_status < 0)
+                {
+                    return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to jump over data for write after error\n",
+                                 seek_status);
+                }
+            }
+        }
+    }
+
+    /* Write Object Size */
+    bytes_written += file_driver.write(&object_size, 1, sizeof(object_size), fs->write_fd);
+
+    /* Write Object */
+    bytes_written += file_driver.write(header, 1, sizeof(bp_object_hdr_t), fs->write_fd);
+
+    /* Write Data Buffer 1 */
+    bytes_written += file_driver.write(data1, 1, data1_size, fs->write_fd);
+
+    /* Write Data Buffer 2 */
+    bytes_written += file_driver.write(data2, 1, data2_size, fs->write_fd);
+
+    /* Pad Object to Alignment of Next Object */
+    bytes_written += file_driver.write(padding, 1, object_size - data_size, fs->write_fd);
+
+    /* Flush File Data */
+    if (fs->flush_on_write)
+    {
+        int flush_status = file_driver.flush(fs->write_fd);
+        if (flush_status < 0)
+        {
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to flush data write\n", flush_status);
+            flush_error = true;
+        }
+    }
+
+    /* Check Errors and Return Status */
+    if ((bytes_written != (object_size + sizeof(object_size))) || flush_error)
+    {
+        fs->write_error = true;
+        if (fs->write_fd)
+        {
+            file_driver.close(fs->write_fd);
+            fs->write_fd = NULL;
+        }
+
+        /* Return Failure */
+        return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to write data to file (%d ?= %d)\n", bytes_written,
+                     object_size + sizeof(object_size));
+    }
+
+    fs->write_error = false;
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * enqueue_object - append object to current segment file, called with lock held
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int enqueue_object(file_store_t *fs, bp_handle_t h, const void *data1, size_t data1_size,
+                                  const void *data2, size_t data2_size)
+{
+    /* Write Object */
+    bp_object_hdr_t object_header = {.handle = h, .sid = (bp_sid_t)fs->write_data_id, .size = data1_size + data2_size};
+    int status = write_dat_object(fs, fs->write_data_id, &object_header, data1, data1_size, data2, data2_size);
+    if (status != BP_SUCCESS)
+    {
+        return status;
+    }
+
+    /* Check Need to Close Write File
+     *  this needs to be determined prior to the write_data_id being
+     *  incremented because the x_data_id variables are one based instead
+     *  of zero based */
+    bool segment_done = (fs->write_data_id % fs->segment_size) == 0;
+
+    /* Set Write State */
+    fs->write_data_id++;
+    fs->data_count++;
+
+    /* Group Commit
+     *  a segment is always committed before its write file is closed */
+    if (fs->commit_count > 0)
+    {
+        if (fs->commit_pending++ == 0)
+        {
+            bplib_os_monotime(&fs->commit_start);
+        }
+
+        if (segment_done || fs->commit_pending >= fs->commit_count ||
+            (fs->commit_period > 0 && commit_remaining(fs) <= 0))
+        {
+            commit_objects(fs);
+        }
+    }
+
+    /* Close Write File */
+    if (segment_done)
+    {
+        file_driver.close(fs->write_fd);
+        fs->write_fd = NULL;
+        save_idx_file(fs);
+    }
+
+    wake_waiter(fs);
+
+    /* Return Success */
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * queue_object - hand object to the I/O thread, called with lock held
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int queue_object(file_store_t *fs, bp_handle_t h, const void *data1, size_t data1_size,
+                                const void *data2, size_t data2_size, int timeout)
+{
+    /* Wait for Room in Queue */
+    if (fs->write_data_id - fs->wb_written_id >= (unsigned long)fs->wb_depth)
+    {
+        int wait_status = bplib_os_waiton(fs->lock, timeout);
+        if (wait_status == BP_ERROR)
+        {
+            return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to wait for write behind queue\n", wait_status);
+        }
+        else if (fs->write_data_id - fs->wb_written_id >= (unsigned long)fs->wb_depth)
+        {
+            return BP_TIMEOUT;
+        }
+    }
+
+    /* Build Object */
+    unsigned char *object_ptr = (unsigned char *)bplib_os_calloc_tag(sizeof(bp_object_hdr_t) + data1_size + data2_size,
+                                                                     BP_MEM_FILE);
+    if (object_ptr == NULL)
+    {
+        return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to allocate object for write behind queue\n");
+    }
+    bp_object_hdr_t *object_header = (bp_object_hdr_t *)object_ptr;
+    object_header->handle          = h;
+    object_header->sid             = (bp_sid_t)fs->write_data_id;
+    object_header->size            = data1_size + data2_size;
+    if (data1_size > 0)
+    {
+        memcpy(object_ptr + sizeof(bp_object_hdr_t), data1, data1_size);
+    }
+    if (data2_size > 0)
+    {
+        memcpy(object_ptr + sizeof(bp_object_hdr_t) + data1_size, data2, data2_size);
+    }
+
+    /* Queue Object */
+    fs->wb_queue[fs->write_data_id % fs->wb_depth] = object_ptr;
+    fs->write_data_id++;
+    fs->data_count++;
+    bplib_os_signal(fs->lock);
+
+    /* Wake I/O Thread */
+    bplib_os_lock(fs->wb_lock);
+    {
+        fs->wb_wakeup = true;
+        bplib_os_signal(fs->wb_lock);
+    }
+    bplib_os_unlock(fs->wb_lock);
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * copy_queued_object - copy object that the I/O thread has not yet written, called with lock held
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE unsigned char *copy_queued_object(file_store_t *fs, unsigned long write_data_id)
+{
+    bp_object_hdr_t *queued_object = (bp_object_hdr_t *)fs->wb_queue[write_data_id % fs->wb_depth];
+    size_t           object_size   = sizeof(bp_object_hdr_t) + queued_object->size;
+
+    unsigned char *object_ptr = (unsigned char *)bplib_os_calloc_tag(object_size, BP_MEM_FILE);
+    if (object_ptr != NULL)
+    {
+        memcpy(object_ptr, queued_object, object_size);
+    }
+
+    return object_ptr;
+}
+
+/*--------------------------------------------------------------------------------------
+ * prefetch_objects - read objects that follow sid in its segment file into the data cache
+ *
+ *  fd - segment file positioned just after the object for sid
+ *  returns the number of objects fd was advanced past, or BP_ERROR when its position is lost
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int prefetch_objects(file_store_t *fs, FILE *fd, unsigned long sid)
+{
+    unsigned long file_id = GET_FILEID(fs, GET_DATAID(sid));
+    int           count   = 0;
+
+    while (count < fs->prefetch_count)
+    {
+        unsigned long next_sid = sid + count + 1;
+        unsigned long data_id  = GET_DATAID(next_sid);
+
+        /* Stop at End of Written Objects in Segment */
+        if (next_sid >= fs->write_data_id || (fs->write_behind && next_sid >= fs->wb_written_id) ||
+            GET_FILEID(fs, data_id) != file_id)
+        {
+            break;
+        }
+
+        /* Stop Rather Than Wait on Locked Entries */
+        if (!cache_available(fs))
+        {
+            break;
+        }
+
+        /* Read Object Size */
+        unsigned long object_size = 0;
+        if (file_driver.read(&object_size, 1, sizeof(object_size), fd) != sizeof(object_size))
+        {
+            return BP_ERROR;
+        }
+
+        /* Skip Compacted, Cached, and Relinquished Objects */
+        bool skip = (object_size == 0) || (cache_find(fs, data_id) != FILE_CACHE_NULL);
+        if (GET_FILEID(fs, GET_DATAID(fs->relinquish_data_id)) == file_id)
+        {
+            skip = skip || fs->relinquish_table.freed[GET_DATAOFFSET(fs, data_id)];
+        }
+
+        unsigned char *object_ptr = NULL;
+        if (!skip)
+        {
+            object_ptr = (unsigned char *)bplib_os_calloc_tag(object_size, BP_MEM_FILE);
+        }
+
+        if (object_ptr == NULL)
+        {
+            if (file_driver.seek(fd, object_size, SEEK_CUR) < 0)
+            {
+                return BP_ERROR;
+            }
+        }
+        else if (file_driver.read(object_ptr, 1, object_size, fd) != object_size)
+        {
+            bplib_os_free(object_ptr);
+            return BP_ERROR;
+        }
+        else
+        {
+            /* Cache Object as Eviction Candidate */
+            bp_object_hdr_t *prefetched_object_header = (bp_object_hdr_t *)object_ptr;
+            prefetched_object_header->sid             = (bp_sid_t)next_sid;
+            cache_insert(fs, data_id, object_ptr, NULL, false);
+            fs->stats.prefetches++;
+        }
+
+        count++;
+    }
+
+    return count;
+}
+
+/*--------------------------------------------------------------------------------------
+ * file_io_thread - writes queued objects to segment files
+ *
+ *  Objects are written outside of the store lock, so enqueue, dequeue, and retrieve
+ *  are never blocked behind the file system.  Objects stay in the queue, and are
+ *  served from it, until they have been written and flushed.  Group commit is
+ *  applied to each batch of objects taken from the queue.
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void file_io_thread(void *parm)
+{
+    file_store_t *fs = (file_store_t *)parm;
+
+    bplib_os_lock(fs->lock);
+    while (true)
+    {
+        unsigned long first_id = fs->wb_written_id;
+        unsigned long last_id  = fs->write_data_id;
+        bool          running  = fs->wb_running;
+        bplib_os_unlock(fs->lock);
+
+        /* Write Batch */
+        unsigned long id;
+        for (id = first_id; id < last_id; id++)
+        {
+            bp_object_hdr_t *queued_object = (bp_object_hdr_t *)fs->wb_queue[id % fs->wb_depth];
+            const void      *queued_data   = (unsigned char *)queued_object + sizeof(bp_object_hdr_t);
+            if (write_dat_object(fs, id, queued_object, queued_data, queued_object->size, NULL, 0) != BP_SUCCESS)
+            {
+                break;
+            }
+
+            /* Group Commit Prior to Closing Segment */
+            if (fs->commit_count > 0 && fs->commit_pending++ == 0)
+            {
+                bplib_os_monotime(&fs->commit_start);
+            }
+            if (id % fs->segment_size == 0)
+            {
+                if (fs->commit_count > 0)
+                {
+                    sync_dat_file(fs);
+                    fs->commit_pending = 0;
+                }
+                file_driver.close(fs->write_fd);
+                fs->write_fd = NULL;
+            }
+        }
+
+        /* Make Batch Visible to Readers */
+        if (fs->write_fd != NULL)
+        {
+            if (fs->commit_count > 0 && fs->commit_pending > 0 &&
+                (fs->commit_pending >= fs->commit_count || !running ||
+                 (fs->commit_period > 0 && commit_remaining(fs) <= 0)))
+            {
+                sync_dat_file(fs);
+                fs->commit_pending = 0;
+            }
+            else
+            {
+                file_driver.flush(fs->write_fd);
+            }
+        }
+
+        /* Release Written Objects */
+        bplib_os_lock(fs->lock);
+        {
+            unsigned long written_id;
+            for (written_id = first_id; written_id < id; written_id++)
+            {
+                bplib_os_free(fs->wb_queue[written_id % fs->wb_depth]);
+                fs->wb_queue[written_id % fs->wb_depth] = NULL;
+            }
+            fs->wb_written_id = id;
+            bplib_os_broadcast(fs->lock);
+
+            /* Checkpoint Completed Segments */
+            if (GET_FILEID(fs, GET_DATAID(first_id)) != GET_FILEID(fs, GET_DATAID(id)))
+            {
+                save_idx_file(fs);
+            }
+        }
+
+        /* Check Exit */
+        if (!running && (id == fs->write_data_id || id < last_id))
+        {
+            if (id < fs->write_data_id)
+            {
+                bplog(NULL, BP_FLAG_STORE_FAILURE, "Write behind dropped %lu objects on exit\n",
+                      fs->write_data_id - id);
+            }
+            break;
+        }
+
+        /* Wait for Work */
+        if (id == fs->write_data_id || id < last_id)
+        {
+            int timeout = BP_PEND;
+            if (id < last_id)
+            {
+                timeout = FILE_WRITE_BEHIND_RETRY_MS;
+            }
+            else if (fs->commit_count > 0 && fs->commit_pending > 0 && fs->commit_period > 0)
+            {
+                long remaining = commit_remaining(fs);
+                timeout        = remaining > 0 ? (int)remaining : 0;
+            }
+
+            bplib_os_unlock(fs->lock);
+            bplib_os_lock(fs->wb_lock);
+            {
+                if (!fs->wb_wakeup && timeout != 0)
+                {
+                    bplib_os_waiton(fs->wb_lock, timeout);
+                }
+                fs->wb_wakeup = false;
+            }
+            bplib_os_unlock(fs->wb_lock);
+            bplib_os_lock(fs->lock);
+        }
+    }
+    bplib_os_unlock(fs->lock);
+}
+
+/*--------------------------------------------------------------------------------------
+ * relinquish_object - marks data relinquished and deletes fully relinquished segments (store lock must be held)
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int relinquish_object(file_store_t *fs, bp_sid_t sid)
+{
+    /* Get IDs */
+    unsigned long data_id      = GET_DATAID(sid);
+    unsigned long file_id      = GET_FILEID(fs, data_id);
+    unsigned long data_offset  = GET_DATAOFFSET(fs, data_id);
+    unsigned long prev_data_id = GET_DATAID(fs->relinquish_data_id);
+    unsigned long prev_file_id = GET_FILEID(fs, prev_data_id);
+
+    /* Clear Data Cache */
+    int cache_index = cache_find(fs, data_id);
+    if (cache_index != FILE_CACHE_NULL)
+    {
+        cache_remove(fs, cache_index);
+    }
+
+    /* Check Need to Read New Relinquish Table */
+    if (file_id != prev_file_id)
+    {
+        /* Set Current Relinquish Table */
+        fs->relinquish_data_id = (unsigned long)sid;
+
+        /* Check Need to Save Off Previous Relinquish Table
+         *  a segment that is entirely relinquished has already been deleted */
+        if (fs->relinquish_table.free_cnt > 0 && fs->relinquish_table.free_cnt < fs->segment_size)
+        {
+            /* Compact Previous Segment */
+            if (fs->compact_threshold > 0 && fs->relinquish_table.free_cnt > fs->relinquish_table.compact_cnt &&
+                (fs->relinquish_table.free_cnt * 100) >= (fs->compact_threshold * fs->segment_size))
+            {
+                if (compact_dat_file(fs, prev_file_id, &fs->relinquish_table) == BP_SUCCESS)
+                {
+                    fs->relinquish_table.compact_cnt = fs->relinquish_table.free_cnt;
+                }
+            }
+
+            /* Write Previous Relinquish Table */
+            int save_status = save_tbl_file(fs, prev_file_id);
+            if (save_status != BP_SUCCESS)
+            {
+                return save_status;
+            }
+        }
+
+        /* Read New Relinquish Table */
+        int load_status = load_tbl_file(fs, file_id, &fs->relinquish_table);
+        if (load_status != BP_SUCCESS)
+        {
+            return load_status;
+        }
+    }
+
+    /* Check if Still Present */
+    if (fs->relinquish_table.freed[data_offset] == 0)
+    {
+        /* Mark Data as Relinquished */
+        fs->relinquish_table.freed[data_offset] = 1;
+        fs->data_count--;
+
+        /* Relinquish Resources */
+        fs->relinquish_table.free_cnt++;
+        if (fs->relinquish_table.free_cnt == fs->segment_size)
+        {
+            /* Wait for I/O Thread to Finish Segment
+             *  otherwise the thread recreates the file after it is deleted */
+            while (fs->write_behind && fs->wb_written_id <= (file_id + 1) * fs->segment_size)
+            {
+                if (bplib_os_waiton(fs->lock, FILE_WRITE_BEHIND_RETRY_MS) == BP_ERROR)
+                {
+                    break;
+                }
+            }
+
+            /* Delete Associated Files
+             *  only check the status of the data file deletion as it is
+             *  possible (and often the case) that the table file is never
+             *  created because the state of which bundles are freed does
+             *  not need to be saved off */
+            delete_tbl_file(fs->file_root, fs->file_name, file_id);
+#ifdef FILE_MMAP_SUPPORTED
+            if (fs->retrieve_map.file_id == file_id)
+            {
+                unmap_dat_file(&fs->retrieve_map);
+            }
+#endif
+            int dat_status = delete_dat_file(fs->file_root, fs->file_name, file_id);
+            if (dat_status < 0)
+            {
+                return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to relinquish file\n", dat_status);
+            }
+
+            /* Advance Oldest Segment Past Deleted Files */
+            if (file_id == fs->first_file_id)
+            {
+                unsigned long write_file_id = GET_FILEID(fs, GET_DATAID(fs->write_data_id));
+                do
+                {
+                    fs->first_file_id++;
+                } while (fs->first_file_id < write_file_id && !dat_file_exists(fs, fs->first_file_id));
+            }
+            if (fs->recover_file_id == file_id)
+            {
+                fs->recover_file_id = ULONG_MAX;
+            }
+
+            /* Checkpoint Deletion so Recovery Does Not Look for the Segment */
+            save_idx_file(fs);
+        }
+    }
+
+    /* Return Success */
+    return BP_SUCCESS;
+}
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * bplib_store_file_init -
+ *-------------------------------------------------------------------------------------*/
+void bplib_store_file_init(bp_file_driver_t *driver)
+{
+    if (driver)
+        file_driver = *driver;
+
+    memset(file_stores, 0, sizeof(file_stores));
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_store_file_stats -
+ *-------------------------------------------------------------------------------------*/
+void bplib_store_file_stats(bp_handle_t h, bp_file_stats_t *stats, bool log_stats, bool reset_stats)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_FILE_STORE_BASE);
+
+    assert(handle >= 0 && handle < FILE_MAX_STORES);
+    assert(file_stores[handle].in_use);
+
+    file_store_t *fs = (file_store_t *)&file_stores[handle];
+    bplib_os_lock(fs->lock);
+    {
+        /* Copy Stats */
+        if (stats)
+        {
+            *stats = fs->stats;
+        }
+
+        /* Log Stats */
+        if (log_stats)
+        {
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Number of cache hits: %lu\n", fs->stats.hits);
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Number of cache misses: %lu\n", fs->stats.misses);
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Number of cache evictions: %lu\n", fs->stats.evictions);
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Number of objects prefetched: %lu\n", fs->stats.prefetches);
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Number of objects cached: %d\n", fs->stats.cached_objects);
+        }
+
+        /* Reset Stats */
+        if (reset_stats)
+        {
+            fs->stats.hits       = 0;
+            fs->stats.misses     = 0;
+            fs->stats.evictions  = 0;
+            fs->stats.prefetches = 0;
+        }
+    }
+    bplib_os_unlock(fs->lock);
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_store_file_create -
+ *-------------------------------------------------------------------------------------*/
+bp_handle_t bplib_store_file_create(int type, bp_ipn_t node, bp_ipn_t service, bool recover, void *parm)
+{
+    bp_file_attr_t *attr = (bp_file_attr_t *)parm;
+    bp_handle_t     pending_h;
+
+    int s;
+    for (s = 0; s < FILE_MAX_STORES; s++)
+    {
+        if (file_stores[s].in_use == false)
+        {
+            pending_h = bp_handle_from_serial(s, BPLIB_HANDLE_FILE_STORE_BASE);
+
+            /* Clear File Store (pointers set to NULL) */
+            memset(&file_stores[s], 0, sizeof(file_stores[s]));
+            file_stores[s].write_fd      = NULL;
+            file_stores[s].read_fd       = NULL;
+            file_stores[s].retrieve_fd   = NULL;
+            file_stores[s].relinquish_fd = NULL;
+
+            /* Set In Use (necessary to be able to destroy later) */
+            file_stores[s].in_use = true;
+
+            /* Initialize Parameters */
+            file_stores[s].service_id         = file_service_id++;
+            file_stores[s].lock               = BP_INVALID_HANDLE;
+            file_stores[s].wb_lock            = BP_INVALID_HANDLE;
+            file_stores[s].wb_thread          = BP_INVALID_HANDLE;
+            file_stores[s].write_data_id      = 1;
+            file_stores[s].read_data_id       = 1;
+            file_stores[s].retrieve_data_id   = 1;
+            file_stores[s].relinquish_data_id = 1;
+            file_stores[s].type               = type;
+            file_stores[s].node               = node;
+            file_stores[s].service            = service;
+            file_stores[s].recover_file_id    = ULONG_MAX;
+
+            /* Name Files
+             *  stores that can be recovered are named by their endpoint so that
+             *  they find their files again after a reset */
+            if (recover)
             {
-                return bplog(NULL, BP_FLAG_STORE_FAILURE,
-                             "Failed (%d) to set write position after error to start of file\n", seek_status);
+                bplib_os_format(file_stores[s].file_name, FILE_MAX_NAME, "%d_%lu_%lu", type, (unsigned long)node,
+                                (unsigned long)service);
+            }
+            else
+            {
+                bplib_os_format(file_stores[s].file_name, FILE_MAX_NAME, "%d", (int)file_stores[s].service_id);
             }
 
-            /* Read/Seek Through File */
-            unsigned long pos;
-            for (pos = 0; pos < data_offset; pos++)
+            /* Setup and Check Lock */
+            file_stores[s].lock = bplib_os_createlock();
+            if (!bp_handle_is_valid(file_stores[s].lock))
             {
-                unsigned long current_size;
+                bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed (%d) to create FSS lock\n", file_stores[s].lock);
+                bplib_store_file_destroy(pending_h);
+                break;
+            }
 
-                /* Read Current Data Size */
-                unsigned long bytes_read = file_driver.read(&current_size, 1, sizeof(current_size), fs->write_fd);
-                if (bytes_read != sizeof(current_size))
+            /* Setup Root Path */
+            const char *root_path = FILE_DEFAULT_ROOT;
+            if (attr && attr->root_path)
+            {
+                root_path = attr->root_path;
+            }
+            int root_path_len = bplib_os_strnlen(root_path, FILE_MAX_FILENAME) + 1;
+            if (root_path_len <= FILE_MAX_FILENAME)
+            {
+                file_stores[s].file_root = (char *)bplib_os_calloc_tag(root_path_len, BP_MEM_FILE);
+                if (file_stores[s].file_root)
                 {
-                    return bplog(NULL, BP_FLAG_STORE_FAILURE,
-                                 "Failed to read data size for write after error (%d != %d)\n", bytes_read,
-                                 sizeof(current_size));
+                    memcpy(file_stores[s].file_root, root_path, root_path_len);
                 }
+            }
 
-                /* Seek to End of Current Data */
-                seek_status = file_driver.seek(fs->write_fd, current_size, SEEK_CUR);
-                if (seek_status < 0)
+            /* Check File Root Setup */
+            if (file_stores[s].file_root == NULL)
+            {
+                bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to set FSS root path\n");
+                bplib_store_file_destroy(pending_h);
+                break;
+            }
+
+            /* Setup Data Cache */
+            int cache_size = FILE_DEFAULT_CACHE_SIZE;
+            if (attr && attr->cache_size)
+            {
+                cache_size = attr->cache_size;
+            }
+            unsigned long num_buckets = 1;
+            while (num_buckets < (unsigned long)cache_size)
+            {
+                num_buckets <<= 1;
+            }
+            file_stores[s].cache_size    = cache_size;
+            file_stores[s].cache_mask    = num_buckets - 1;
+            file_stores[s].cache_free    = FILE_CACHE_NULL;
+            file_stores[s].cache_newest  = FILE_CACHE_NULL;
+            file_stores[s].cache_oldest  = FILE_CACHE_NULL;
+            file_stores[s].data_cache    = (data_cache_t *)bplib_os_calloc_tag(cache_size * sizeof(data_cache_t),
+                                                                               BP_MEM_FILE);
+            file_stores[s].cache_buckets = (int *)bplib_os_calloc_tag(num_buckets * sizeof(int), BP_MEM_FILE);
+            if (file_stores[s].data_cache != NULL && file_stores[s].cache_buckets != NULL)
+            {
+                int i;
+                for (i = cache_size - 1; i >= 0; i--)
                 {
-                    return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to jump over data for write after error\n",
-                                 seek_status);
+                    file_stores[s].data_cache[i].mem_data_id = BP_SID_VACANT;
+                    file_stores[s].data_cache[i].hash_next   = file_stores[s].cache_free;
+                    file_stores[s].cache_free                = i;
+                }
+                for (i = 0; i < (int)num_buckets; i++)
+                {
+                    file_stores[s].cache_buckets[i] = FILE_CACHE_NULL;
                 }
             }
-        }
-    }
 
-    /* Create Object */
-    bp_object_hdr_t object_header = {.handle = h, .sid = BP_SID_VACANT, .size = data_size};
+            /* Set Prefetch Attribute
+             *  at most half the cache is read ahead so prefetched objects are not evicted before they are used */
+            if (attr && attr->prefetch_count > 0)
+            {
+                file_stores[s].prefetch_count = attr->prefetch_count;
+                if (file_stores[s].prefetch_count > cache_size / 2)
+                {
+                    file_stores[s].prefetch_count = cache_size / 2;
+                }
+            }
 
-    /* Write Object Size */
-    bytes_written += file_driver.write(&object_size, 1, sizeof(object_size), fs->write_fd);
+            /* Set Flush Attribute */
+            if (attr)
+            {
+                file_stores[s].flush_on_write = attr->flush_on_write;
+            }
+            else
+            {
+                file_stores[s].flush_on_write = FILE_FLUSH_DEFAULT;
+            }
 
-    /* Write Object */
-    bytes_written += file_driver.write(&object_header, 1, sizeof(bp_object_hdr_t), fs->write_fd);
+            /* Set Group Commit Attributes */
+            if (attr && attr->commit_count > 0)
+            {
+                file_stores[s].commit_count   = attr->commit_count;
+                file_stores[s].commit_period  = attr->commit_period;
+                file_stores[s].commit_data_id = file_stores[s].write_data_id;
+            }
 
-    /* Write Data Buffer 1 */
-    bytes_written += file_driver.write(data1, 1, data1_size, fs->write_fd);
+            /* Set Segment Mapping Attribute */
+            if (attr && attr->map_segments)
+            {
+#ifdef FILE_MMAP_SUPPORTED
+                file_stores[s].map_segments = true;
+#else
+                bplog(NULL, BP_FLAG_DIAGNOSTIC, "Mapped segment files not supported, using file driver\n");
+#endif
+            }
 
-    /* Write Data Buffer 2 */
-    bytes_written += file_driver.write(data2, 1, data2_size, fs->write_fd);
+            /* Check Data Cache Setup */
+            if (file_stores[s].data_cache == NULL || file_stores[s].cache_buckets == NULL)
+            {
+                bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to allocate FSS data cache\n");
+                bplib_store_file_destroy(pending_h);
+                break;
+            }
 
-    /* Flush File Data */
-    if (fs->flush_on_write)
+            /* Setup Segments */
+            int segment_size = FILE_DEFAULT_SEGMENT_SIZE;
+            if (attr && attr->segment_size > 0)
+            {
+                segment_size = attr->segment_size;
+            }
+            if (attr && attr->compact_threshold > 0)
+            {
+                file_stores[s].compact_threshold = attr->compact_threshold;
+            }
+            file_stores[s].segment_size           = segment_size;
+            file_stores[s].relinquish_table.freed = (bool *)bplib_os_calloc_tag(segment_size * sizeof(bool),
+                                                                                BP_MEM_FILE);
+            file_stores[s].read_map.offsets       = (size_t *)bplib_os_calloc_tag(segment_size * sizeof(size_t),
+                                                                                  BP_MEM_FILE);
+            file_stores[s].retrieve_map.offsets   = (size_t *)bplib_os_calloc_tag(segment_size * sizeof(size_t),
+                                                                                  BP_MEM_FILE);
+
+            /* Check Segment Setup */
+            if (file_stores[s].relinquish_table.freed == NULL || file_stores[s].read_map.offsets == NULL ||
+                file_stores[s].retrieve_map.offsets == NULL)
+            {
+                bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to allocate FSS segment tables\n");
+                bplib_store_file_destroy(pending_h);
+                break;
+            }
+
+            /* Recover Store */
+            if (recover)
+            {
+                int i;
+                for (i = 0; i < FILE_MAX_STORES; i++)
+                {
+                    if (i != s && file_stores[i].in_use && file_stores[i].recover && file_stores[i].type == type &&
+                        file_stores[i].node == node && file_stores[i].service == service)
+                    {
+                        break;
+                    }
+                }
+                if (i < FILE_MAX_STORES)
+                {
+                    bplog(NULL, BP_FLAG_DIAGNOSTIC, "Store for ipn:%lu.%lu already in use!\n", (unsigned long)node,
+                          (unsigned long)service);
+                    bplib_store_file_destroy(pending_h);
+                    break;
+                }
+
+                /* Index Is Only Saved Once Store Is Recovered */
+                file_stores[s].recover_table.freed = (bool *)bplib_os_calloc_tag(segment_size * sizeof(bool),
+                                                                                 BP_MEM_FILE);
+                file_stores[s].recover             = (file_stores[s].recover_table.freed != NULL);
+                if (!file_stores[s].recover || recover_store(&file_stores[s]) != BP_SUCCESS)
+                {
+                    bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to recover FSS\n");
+                    file_stores[s].recover = false;
+                    bplib_store_file_destroy(pending_h);
+                    break;
+                }
+                file_stores[s].commit_data_id = file_stores[s].write_data_id;
+            }
+
+            /* Setup Write Behind */
+            if (attr && attr->write_behind)
+            {
+                file_store_t *fs = &file_stores[s];
+                fs->wb_depth     = FILE_DEFAULT_WRITE_BEHIND_DEPTH;
+                if (attr->write_behind_depth > 0)
+                {
+                    fs->wb_depth = attr->write_behind_depth;
+                }
+                fs->wb_written_id = fs->write_data_id;
+                fs->wb_running    = true;
+                fs->wb_queue      = (unsigned char **)bplib_os_calloc_tag(fs->wb_depth * sizeof(unsigned char *),
+                                                                          BP_MEM_FILE);
+                fs->wb_lock       = bplib_os_createlock();
+                if (fs->wb_queue == NULL || !bp_handle_is_valid(fs->wb_lock))
+                {
+                    bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to allocate FSS write behind queue\n");
+                    bplib_store_file_destroy(pending_h);
+                    break;
+                }
+
+                /* Start I/O Thread (falls back to writing inline) */
+                fs->write_behind = true;
+                fs->wb_thread    = bplib_os_createthread(file_io_thread, fs);
+                if (!bp_handle_is_valid(fs->wb_thread))
+                {
+                    bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to start FSS I/O thread, writing inline\n");
+                    fs->write_behind = false;
+                }
+            }
+
+            /* Return Handle */
+            return pending_h;
+        }
+    }
+
+    return BP_INVALID_HANDLE;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_store_file_destroy -
+ *-------------------------------------------------------------------------------------*/
+int bplib_store_file_destroy(bp_handle_t h)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_FILE_STORE_BASE);
+
+    assert(handle >= 0 && handle < FILE_MAX_STORES);
+    assert(file_stores[handle].in_use);
+
+    /* Stop I/O Thread (writes out remaining queued objects) */
+    if (bp_handle_is_valid(file_stores[handle].wb_thread))
     {
-        int flush_status = file_driver.flush(fs->write_fd);
-        if (flush_status < 0)
+        bplib_os_lock(file_stores[handle].lock);
+        file_stores[handle].wb_running = false;
+        bplib_os_unlock(file_stores[handle].lock);
+
+        bplib_os_lock(file_stores[handle].wb_lock);
+        file_stores[handle].wb_wakeup = true;
+        bplib_os_signal(file_stores[handle].wb_lock);
+        bplib_os_unlock(file_stores[handle].wb_lock);
+
+        bplib_os_jointhread(file_stores[handle].wb_thread);
+        file_stores[handle].wb_thread    = BP_INVALID_HANDLE;
+        file_stores[handle].write_behind = false;
+    }
+    if (file_stores[handle].wb_queue != NULL)
+    {
+        int i;
+        for (i = 0; i < file_stores[handle].wb_depth; i++)
         {
-            bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to flush data write\n", flush_status);
-            flush_error = true;
+            if (file_stores[handle].wb_queue[i] != NULL)
+            {
+                bplib_os_free(file_stores[handle].wb_queue[i]);
+            }
         }
+        bplib_os_free(file_stores[handle].wb_queue);
+    }
+    if (bp_handle_is_valid(file_stores[handle].wb_lock))
+    {
+        bplib_os_destroylock(file_stores[handle].wb_lock);
     }
 
-    /* Check Errors and Return Status */
-    if ((bytes_written != (object_size + sizeof(object_size))) || flush_error)
+    if (file_stores[handle].write_fd != NULL)
     {
-        fs->write_error = true;
-        if (fs->write_fd)
+        if (file_stores[handle].commit_pending > 0)
         {
-            file_driver.close(fs->write_fd);
-            fs->write_fd = NULL;
+            commit_objects(&file_stores[handle]);
+        }
+        file_driver.close(file_stores[handle].write_fd);
+        file_stores[handle].write_fd = NULL;
+    }
+    save_idx_file(&file_stores[handle]);
+    if (file_stores[handle].read_fd != NULL)
+    {
+        file_driver.close(file_stores[handle].read_fd);
+    }
+    if (file_stores[handle].retrieve_fd != NULL)
+    {
+        file_driver.close(file_stores[handle].retrieve_fd);
+    }
+#ifdef FILE_MMAP_SUPPORTED
+    unmap_dat_file(&file_stores[handle].read_map);
+    unmap_dat_file(&file_stores[handle].retrieve_map);
+#endif
+    if (file_stores[handle].file_root != NULL)
+    {
+        bplib_os_free(file_stores[handle].file_root);
+    }
+    if (bp_handle_is_valid(file_stores[handle].lock))
+    {
+        bplib_os_destroylock(file_stores[handle].lock);
+    }
+    if (file_stores[handle].data_cache != NULL)
+    {
+        int i;
+        for (i = 0; i < file_stores[handle].cache_size; i++)
+        {
+            if (file_stores[handle].data_cache[i].mem_ptr != NULL)
+            {
+                free_object(file_stores[handle].data_cache[i].mem_ptr, file_stores[handle].data_cache[i].mem_region);
+            }
         }
+        bplib_os_free(file_stores[handle].data_cache);
+    }
+    if (file_stores[handle].cache_buckets != NULL)
+    {
+        bplib_os_free(file_stores[handle].cache_buckets);
+    }
+    if (file_stores[handle].relinquish_table.freed != NULL)
+    {
+        bplib_os_free(file_stores[handle].relinquish_table.freed);
+    }
+    if (file_stores[handle].recover_table.freed != NULL)
+    {
+        bplib_os_free(file_stores[handle].recover_table.freed);
+    }
+    if (file_stores[handle].read_map.offsets != NULL)
+    {
+        bplib_os_free(file_stores[handle].read_map.offsets);
+    }
+    if (file_stores[handle].retrieve_map.offsets != NULL)
+    {
+        bplib_os_free(file_stores[handle].retrieve_map.offsets);
+    }
 
-        /* Return Failure */
-        return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to write data to file (%d ?= %d)\n", bytes_written,
-                     object_size + sizeof(object_size));
+    file_stores[handle].in_use = false;
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_store_file_enqueue -
+ *-------------------------------------------------------------------------------------*/
+int bplib_store_file_enqueue(bp_handle_t h, const void *data1, size_t data1_size, const void *data2, size_t data2_size,
+                             int timeout)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_FILE_STORE_BASE);
+
+    assert(handle >= 0 && handle < FILE_MAX_STORES);
+    assert(file_stores[handle].in_use);
+
+    file_store_t *fs = (file_store_t *)&file_stores[handle];
+    bplib_os_lock(fs->lock);
+    unsigned long data_id = fs->write_data_id;
+    int           status;
+    if (fs->write_behind)
+    {
+        status = queue_object(fs, h, data1, data1_size, data2, data2_size, timeout);
     }
     else
     {
-        /* Close Write File
-         *  this needs to be performed here prior to the write_data_id being
-         *  incremented because the x_data_id variables are one based instead
-         *  of zero based */
-        if (fs->write_data_id % FILE_DATA_COUNT == 0)
+        status = enqueue_object(fs, h, data1, data1_size, data2, data2_size);
+        if (status == BP_SUCCESS && fs->commit_count > 0 && timeout != BP_CHECK)
         {
-            file_driver.close(fs->write_fd);
-            fs->write_fd = NULL;
+            status = wait_for_commit(fs, data_id, timeout);
         }
-
-        /* Set Write State */
-        fs->write_error = false;
-        fs->write_data_id++;
-        fs->data_count++;
-        bplib_os_signal(fs->lock);
-
-        /* Return Success */
-        return BP_SUCCESS;
     }
+    bplib_os_unlock(fs->lock);
+
+    return status;
 }
 
 /*--------------------------------------------------------------------------------------
@@ -520,18 +2411,56 @@ int bplib_store_file_dequeue(bp_handle_t h, bp_object_t **object, int timeout)
         unsigned long  bytes_read   = 0;
         unsigned long  object_size  = 0;
         unsigned char *object_ptr   = NULL;
-        unsigned long  cache_index  = 0;
+        file_region_t *region       = NULL;
+        int            cache_index  = FILE_CACHE_NULL;
         bool           read_success = false;
+        bool           read_file    = false;
+
+        /* Skip Objects Relinquished Before Reset */
+        while (fs->read_data_id < fs->recover_data_id && fs->read_data_id < fs->write_data_id &&
+               recovered_relinquished(fs, fs->read_data_id))
+        {
+            if (fs->read_data_id % fs->segment_size == 0)
+            {
+                if (fs->read_fd)
+                {
+                    file_driver.close(fs->read_fd);
+                    fs->read_fd = NULL;
+                }
+#ifdef FILE_MMAP_SUPPORTED
+                unmap_dat_file(&fs->read_map);
+#endif
+            }
+            fs->read_data_id++;
+        }
 
         /* Get IDs */
         unsigned long data_id     = GET_DATAID(fs->read_data_id);
-        unsigned long file_id     = GET_FILEID(data_id);
-        unsigned long data_offset = GET_DATAOFFSET(data_id);
+        unsigned long file_id     = GET_FILEID(fs, data_id);
+        unsigned long data_offset = GET_DATAOFFSET(fs, data_id);
+
+        /* Commit Objects That Are Due */
+        check_commit(fs);
 
-        /* Check if Data Available */
+        /* Check if Data Available - timed waits last until a deadline so wakeups without data do not end them */
         if (fs->read_data_id == fs->write_data_id)
         {
-            int wait_status = bplib_os_waiton(fs->lock, timeout);
+            int wait_status;
+            if (timeout == BP_PEND || timeout == BP_CHECK)
+            {
+                wait_status = bplib_os_waiton(fs->lock, timeout);
+            }
+            else
+            {
+                unsigned long deadline = 0;
+                bplib_os_monotime_us(&deadline);
+                deadline += (unsigned long)timeout * 1000;
+                do
+                {
+                    wait_status = bplib_os_waituntil(fs->lock, deadline);
+                } while (wait_status == BP_SUCCESS && fs->read_data_id == fs->write_data_id);
+            }
+
             if (wait_status == BP_ERROR)
             {
                 bplib_os_unlock(fs->lock);
@@ -544,136 +2473,201 @@ int bplib_store_file_dequeue(bp_handle_t h, bp_object_t **object, int timeout)
             }
         }
 
-        /* Check Need to Open Read File */
-        if (fs->read_fd == NULL)
+        /* Check Data Cache for Prefetched Object */
+        cache_index = cache_find(fs, data_id);
+        if (cache_index != FILE_CACHE_NULL)
         {
-            /* Open Read File */
-            fs->read_fd = open_dat_file(fs->service_id, fs->file_root, file_id, true);
-            if (fs->read_fd == NULL)
-            {
-                bplib_os_unlock(fs->lock);
-                return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to dequeue data\n");
-            }
+            cache_lock(fs, cache_index);
+            object_ptr = fs->data_cache[cache_index].mem_ptr;
+            fs->stats.hits++;
         }
-
-        /* Seek to Current Position */
-        if (fs->read_error)
+        else
         {
-            /* Start at Beginning of File */
-            int seek_status = file_driver.seek(fs->read_fd, 0, SEEK_SET);
-            if (seek_status < 0)
+            /* Read Data */
+            fs->stats.misses++;
+            if (fs->write_behind && fs->read_data_id >= fs->wb_written_id)
             {
-                bplib_os_unlock(fs->lock);
-                return bplog(NULL, BP_FLAG_STORE_FAILURE,
-                             "Failed (%d) to set read position after error to start of file\n", seek_status);
+                object_ptr = copy_queued_object(fs, fs->read_data_id);
+                if (object_ptr != NULL)
+                {
+                    bp_object_hdr_t *dequeued_object_header = (bp_object_hdr_t *)object_ptr;
+                    dequeued_object_header->sid             = (bp_sid_t)fs->read_data_id;
+                    read_success                            = true;
+                }
             }
-
-            /* Read/Seek Through File */
-            unsigned int pos;
-            for (pos = 0; pos < data_offset; pos++)
+#ifdef FILE_MMAP_SUPPORTED
+            else if (fs->map_segments)
             {
-                unsigned long current_size;
+                object_ptr = read_mapped_object(fs, &fs->read_map, file_id, data_offset, &region);
+                if (object_ptr != NULL)
+                {
+                    /* SID Is Written with Object - only set for files stored without it, to not copy the page */
+                    bp_object_hdr_t *dequeued_object_header = (bp_object_hdr_t *)object_ptr;
+                    if (dequeued_object_header->sid != (bp_sid_t)fs->read_data_id)
+                    {
+                        dequeued_object_header->sid = (bp_sid_t)fs->read_data_id;
+                    }
+                    read_success = true;
+                }
+            }
+#endif
+            else
+            {
+                /* Check Need to Open Read File */
+                if (fs->read_fd == NULL)
+                {
+                    /* Open Read File */
+                    fs->read_fd = open_dat_file(fs->file_root, fs->file_name, file_id, true);
+                    if (fs->read_fd == NULL)
+                    {
+                        bplib_os_unlock(fs->lock);
+                        return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to dequeue data\n");
+                    }
+                    fs->read_pos_id = fs->read_data_id - data_offset;
+                }
 
-                /* Read Current Object Size */
-                bytes_read = file_driver.read(&current_size, 1, sizeof(current_size), fs->read_fd);
-                if (bytes_read != sizeof(current_size))
+                /* Seek to Current Position
+                 *  reads served from the cache or write behind queue leave the read
+                 *  file behind, so it is moved forward to the object being read */
+                if (fs->read_error || fs->read_pos_id > fs->read_data_id)
                 {
-                    bplib_os_unlock(fs->lock);
-                    return bplog(NULL, BP_FLAG_STORE_FAILURE,
-                                 "Failed to read data size for read after error (%d != %d)\n", bytes_read,
-                                 sizeof(current_size));
+                    /* Start at Beginning of File */
+                    int seek_status = file_driver.seek(fs->read_fd, 0, SEEK_SET);
+                    if (seek_status < 0)
+                    {
+                        bplib_os_unlock(fs->lock);
+                        return bplog(NULL, BP_FLAG_STORE_FAILURE,
+                                     "Failed (%d) to set read position after error to start of file\n", seek_status);
+                    }
+                    fs->read_pos_id = fs->read_data_id - data_offset;
                 }
 
-                /* Seek to End of Current Data */
-                seek_status = file_driver.seek(fs->read_fd, current_size, SEEK_CUR);
-                if (seek_status < 0)
+                /* Read/Seek Through File */
+                while (fs->read_pos_id < fs->read_data_id)
                 {
-                    bplib_os_unlock(fs->lock);
-                    return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to jump over data for read after error\n",
-                                 seek_status);
+                    unsigned long current_size;
+
+                    /* Read Current Object Size */
+                    bytes_read = file_driver.read(&current_size, 1, sizeof(current_size), fs->read_fd);
+                    if (bytes_read != sizeof(current_size))
+                    {
+                        fs->read_error = true;
+                        bplib_os_unlock(fs->lock);
+                        return bplog(NULL, BP_FLAG_STORE_FAILURE,
+                                     "Failed to read data size for read after error (%d != %d)\n", bytes_read,
+                                     sizeof(current_size));
+                    }
+
+                    /* Seek to End of Current Data */
+                    int seek_status = file_driver.seek(fs->read_fd, current_size, SEEK_CUR);
+                    if (seek_status < 0)
+                    {
+                        fs->read_error = true;
+                        bplib_os_unlock(fs->lock);
+                        return bplog(NULL, BP_FLAG_STORE_FAILURE,
+                                     "Failed (%d) to jump over data for read after error\n", seek_status);
+                    }
+                    fs->read_pos_id++;
                 }
-            }
-        }
 
-        /* Read Data */
-        bytes_read = file_driver.read(&object_size, 1, sizeof(object_size), fs->read_fd);
-        if (bytes_read == sizeof(object_size))
-        {
-            object_ptr = (unsigned char *)bplib_os_calloc(object_size);
-            bytes_read = file_driver.read(object_ptr, 1, object_size, fs->read_fd);
-            if (bytes_read == object_size)
-            {
-                /* Update SID */
-                bp_object_hdr_t *dequeued_object_header = (bp_object_hdr_t *)object_ptr;
-                dequeued_object_header->sid             = (bp_sid_t)fs->read_data_id;
-                read_success                            = true;
-            }
-        }
+                /* Make Pending Writes Visible */
+                flush_dat_file(fs, file_id);
 
-        /* Check for Read Errors */
-        if (!read_success)
-        {
-            /* Set Error State */
-            fs->read_error = true;
+                /* Read Data */
+                bytes_read = file_driver.read(&object_size, 1, sizeof(object_size), fs->read_fd);
+                if (bytes_read == sizeof(object_size))
+                {
+                    object_ptr = (unsigned char *)bplib_os_calloc_tag(object_size, BP_MEM_FILE);
+                    bytes_read = file_driver.read(object_ptr, 1, object_size, fs->read_fd);
+                    if (bytes_read == object_size)
+                    {
+                        /* Update SID */
+                        bp_object_hdr_t *dequeued_object_header = (bp_object_hdr_t *)object_ptr;
+                        dequeued_object_header->sid             = (bp_sid_t)fs->read_data_id;
+                        fs->read_pos_id                         = fs->read_data_id + 1;
+                        read_success                            = true;
+                        read_file                               = true;
+                    }
+                }
+            }
 
-            /* Close Read File */
-            if (fs->read_fd)
+            /* Check for Read Errors */
+            if (!read_success)
             {
-                file_driver.close(fs->read_fd);
-                fs->read_fd = NULL;
-            }
+                /* Set Error State */
+                fs->read_error = true;
 
-            /* Free Object Pointer */
-            if (object_ptr)
-                bplib_os_free(object_ptr);
+                /* Close Read File */
+                if (fs->read_fd)
+                {
+                    file_driver.close(fs->read_fd);
+                    fs->read_fd = NULL;
+                }
 
-            /* Return Failure */
-            bplib_os_unlock(fs->lock);
-            return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to read data from file\n", bytes_read);
-        }
+                /* Free Object Pointer */
+                if (object_ptr)
+                    free_object(object_ptr, region);
 
-        /* Check State of Data Cache */
-        cache_index = data_id % fs->cache_size;
-        if (fs->data_cache[cache_index].mem_locked)
-        {
-            int wait_status = bplib_os_waiton(fs->lock, timeout);
-            if (wait_status == BP_ERROR)
-            {
-                bplib_os_free(object_ptr);
+                /* Return Failure */
                 bplib_os_unlock(fs->lock);
-                return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to get lock to update cache\n", wait_status);
+                return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to read data from file\n", bytes_read);
             }
-            else if ((wait_status == BP_TIMEOUT) || (fs->data_cache[cache_index].mem_locked))
+            fs->read_error = false;
+
+            /* Check State of Data Cache */
+            if (!cache_available(fs))
             {
-                bplib_os_free(object_ptr);
-                bplib_os_unlock(fs->lock);
-                return BP_TIMEOUT;
+                int wait_status = bplib_os_waiton(fs->lock, timeout);
+                if (wait_status == BP_ERROR)
+                {
+                    free_object(object_ptr, region);
+                    bplib_os_unlock(fs->lock);
+                    return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to get lock to update cache\n",
+                                 wait_status);
+                }
+                else if ((wait_status == BP_TIMEOUT) || !cache_available(fs))
+                {
+                    free_object(object_ptr, region);
+                    bplib_os_unlock(fs->lock);
+                    return BP_TIMEOUT;
+                }
             }
-        }
 
-        /* Free Previous Entry in Data Cache */
-        if (fs->data_cache[cache_index].mem_ptr)
-        {
-            bplib_os_free(fs->data_cache[cache_index].mem_ptr);
-        }
+            /* Update Data Cache */
+            cache_insert(fs, data_id, object_ptr, region, true);
 
-        /* Update Data Cache */
-        fs->data_cache[cache_index].mem_locked  = FILE_MEM_LOCKED;
-        fs->data_cache[cache_index].mem_ptr     = object_ptr;
-        fs->data_cache[cache_index].mem_data_id = data_id;
+            /* Read Ahead in Segment File */
+            if (read_file)
+            {
+                int prefetched = prefetch_objects(fs, fs->read_fd, fs->read_data_id);
+                if (prefetched == BP_ERROR)
+                {
+                    fs->read_error = true;
+                }
+                else
+                {
+                    fs->read_pos_id += prefetched;
+                }
+            }
+        }
 
         /* Check Need to Open New File
          *  this needs to be performed here prior to the read_data_id being
          *  incremented because the x_data_id variables are one based instead
          *  of zero based */
-        if (fs->read_data_id % FILE_DATA_COUNT == 0)
+        if (fs->read_data_id % fs->segment_size == 0)
         {
-            file_driver.close(fs->read_fd);
-            fs->read_fd = NULL;
+            if (fs->read_fd)
+            {
+                file_driver.close(fs->read_fd);
+                fs->read_fd = NULL;
+            }
+#ifdef FILE_MMAP_SUPPORTED
+            unmap_dat_file(&fs->read_map);
+#endif
         }
 
         /* Set Read State */
-        fs->read_error = false;
         fs->read_data_id++;
 
         /* Return Object */
@@ -705,117 +2699,157 @@ int bplib_store_file_retrieve(bp_handle_t h, bp_sid_t sid, bp_object_t **object,
         unsigned long  bytes_read       = 0;
         unsigned long  object_size      = 0;
         unsigned char *object_ptr       = NULL;
-        unsigned long  cache_index      = 0;
+        file_region_t *region           = NULL;
+        int            cache_index      = FILE_CACHE_NULL;
         long           offset_delta     = 0;
         bool           retrieve_success = false;
+        bool           retrieve_file    = false;
 
         /* Get IDs */
         unsigned long data_id          = GET_DATAID(sid);
-        unsigned long file_id          = GET_FILEID(data_id);
-        unsigned long data_offset      = GET_DATAOFFSET(data_id);
+        unsigned long file_id          = GET_FILEID(fs, data_id);
+        unsigned long data_offset      = GET_DATAOFFSET(fs, data_id);
         unsigned long prev_data_id     = GET_DATAID(fs->retrieve_data_id);
-        unsigned long prev_file_id     = GET_FILEID(prev_data_id);
-        unsigned long prev_data_offset = GET_DATAOFFSET(prev_data_id);
+        unsigned long prev_file_id     = GET_FILEID(fs, prev_data_id);
+        unsigned long prev_data_offset = GET_DATAOFFSET(fs, prev_data_id);
 
         /* Check Data Cache */
-        cache_index = data_id % fs->cache_size;
-        if (fs->data_cache[cache_index].mem_ptr)
+        cache_index = cache_find(fs, data_id);
+        if (cache_index != FILE_CACHE_NULL)
         {
-            if (fs->data_cache[cache_index].mem_data_id == data_id)
-            {
-                /* Return Data Cache */
-                *object = fs->data_cache[cache_index].mem_ptr;
-                bplib_os_unlock(fs->lock);
-                return BP_SUCCESS;
-            }
+            /* Return Data Cache */
+            cache_lock(fs, cache_index);
+            fs->stats.hits++;
+            *object = fs->data_cache[cache_index].mem_ptr;
+            bplib_os_unlock(fs->lock);
+            return BP_SUCCESS;
         }
+        fs->stats.misses++;
 
-        /* Check Need to Open New Retrieve File */
-        if (file_id != prev_file_id)
+        /* Read Data */
+        if (fs->write_behind && (unsigned long)sid >= fs->wb_written_id)
         {
-            if (fs->retrieve_fd)
+            object_ptr = copy_queued_object(fs, (unsigned long)sid);
+            if (object_ptr != NULL)
             {
-                file_driver.close(fs->retrieve_fd);
-                fs->retrieve_fd = NULL;
+                bp_object_hdr_t *retrieved_object_header = (bp_object_hdr_t *)object_ptr;
+                retrieved_object_header->sid             = sid;
+                retrieve_success                         = true;
             }
         }
-
-        /* Check Need to Open Retrieve File */
-        if (fs->retrieve_fd == NULL)
+#ifdef FILE_MMAP_SUPPORTED
+        else if (fs->map_segments)
         {
-            /* Open Retrieve File */
-            fs->retrieve_fd = open_dat_file(fs->service_id, fs->file_root, file_id, true);
-            if (fs->retrieve_fd == NULL)
+            object_ptr = read_mapped_object(fs, &fs->retrieve_map, file_id, data_offset, &region);
+            if (object_ptr != NULL)
             {
-                bplib_os_unlock(fs->lock);
-                return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to retrieve data\n");
+                bp_object_hdr_t *retrieved_object_header = (bp_object_hdr_t *)object_ptr;
+                if (retrieved_object_header->sid != sid)
+                {
+                    retrieved_object_header->sid = sid;
+                }
+                fs->retrieve_data_id = (unsigned long)sid;
+                retrieve_success     = true;
             }
         }
+#endif
         else
         {
-            /* Set Delta from Current Position in File */
-            offset_delta = data_offset - prev_data_offset;
-            if (offset_delta < 0)
+            /* Check Need to Open New Retrieve File */
+            if (file_id != prev_file_id)
             {
-                /* Handling Seeking Backwards */
-                offset_delta    = data_offset;
-                int seek_status = file_driver.seek(fs->retrieve_fd, 0, SEEK_SET);
-                if (seek_status < 0)
+                if (fs->retrieve_fd)
                 {
-                    bplib_os_unlock(fs->lock);
-                    return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to set retrieve position to start of file\n",
-                                 seek_status);
+                    file_driver.close(fs->retrieve_fd);
+                    fs->retrieve_fd = NULL;
                 }
             }
-        }
-
-        /* Seek Forward */
-        if (offset_delta > 0)
-        {
-            unsigned long current_size;
-            long          pos;
 
-            for (pos = 0; pos < offset_delta; pos++)
+            /* Check Need to Open Retrieve File */
+            if (fs->retrieve_fd == NULL)
             {
-                /* Read Current Data Size */
-                bytes_read = file_driver.read(&current_size, 1, sizeof(current_size), fs->retrieve_fd);
-                if (bytes_read != sizeof(current_size))
+                /* Open Retrieve File */
+                fs->retrieve_fd = open_dat_file(fs->file_root, fs->file_name, file_id, true);
+                if (fs->retrieve_fd == NULL)
                 {
                     bplib_os_unlock(fs->lock);
-                    return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to read data size on retrieval (%d != %d)\n",
-                                 bytes_read, sizeof(current_size));
+                    return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to retrieve data\n");
                 }
 
-                /* Seek to End of Current Data */
-                int seek_status = file_driver.seek(fs->retrieve_fd, current_size, SEEK_CUR);
-                if (seek_status < 0)
+                /* Seek Forward from Start of File */
+                offset_delta = data_offset;
+            }
+            else
+            {
+                /* Set Delta from Current Position in File
+                 *  the previous retrieval left the file positioned after its object */
+                offset_delta = data_offset - (prev_data_offset + 1);
+                if (offset_delta < 0)
                 {
-                    bplib_os_unlock(fs->lock);
-                    return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to jump to end of data on retrieval\n",
-                                 seek_status);
+                    /* Handling Seeking Backwards */
+                    offset_delta    = data_offset;
+                    int seek_status = file_driver.seek(fs->retrieve_fd, 0, SEEK_SET);
+                    if (seek_status < 0)
+                    {
+                        bplib_os_unlock(fs->lock);
+                        return bplog(NULL, BP_FLAG_STORE_FAILURE,
+                                     "Failed (%d) to set retrieve position to start of file\n", seek_status);
+                    }
                 }
             }
-        }
 
-        /* Read Data */
-        bytes_read = file_driver.read(&object_size, 1, sizeof(object_size), fs->retrieve_fd);
-        if (bytes_read == sizeof(object_size))
-        {
-            object_ptr = (unsigned char *)bplib_os_calloc(object_size);
-            bytes_read = file_driver.read(object_ptr, 1, object_size, fs->retrieve_fd);
-            if (bytes_read == object_size)
+            /* Seek Forward */
+            if (offset_delta > 0)
             {
-                bp_object_hdr_t *retrieved_object_header = (bp_object_hdr_t *)object_ptr;
-                retrieved_object_header->sid             = sid;
-                fs->retrieve_data_id                     = (unsigned long)sid;
-                retrieve_success                         = true;
+                unsigned long current_size;
+                long          pos;
+
+                for (pos = 0; pos < offset_delta; pos++)
+                {
+                    /* Read Current Data Size */
+                    bytes_read = file_driver.read(&current_size, 1, sizeof(current_size), fs->retrieve_fd);
+                    if (bytes_read != sizeof(current_size))
+                    {
+                        bplib_os_unlock(fs->lock);
+                        return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to read data size on retrieval (%d != %d)\n",
+                                     bytes_read, sizeof(current_size));
+                    }
+
+                    /* Seek to End of Current Data */
+                    int seek_status = file_driver.seek(fs->retrieve_fd, current_size, SEEK_CUR);
+                    if (seek_status < 0)
+                    {
+                        bplib_os_unlock(fs->lock);
+                        return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to jump to end of data on retrieval\n",
+                                     seek_status);
+                    }
+                }
+            }
+
+            /* Make Pending Writes Visible */
+            flush_dat_file(fs, file_id);
+
+            /* Read Data */
+            bytes_read = file_driver.read(&object_size, 1, sizeof(object_size), fs->retrieve_fd);
+            if (bytes_read == sizeof(object_size))
+            {
+                object_ptr = (unsigned char *)bplib_os_calloc_tag(object_size, BP_MEM_FILE);
+                bytes_read = file_driver.read(object_ptr, 1, object_size, fs->retrieve_fd);
+                if (bytes_read == object_size)
+                {
+                    bp_object_hdr_t *retrieved_object_header = (bp_object_hdr_t *)object_ptr;
+                    retrieved_object_header->sid             = sid;
+                    fs->retrieve_data_id                     = (unsigned long)sid;
+                    retrieve_success                         = true;
+                    retrieve_file                            = true;
+                }
             }
         }
 
         /* Check Success */
         if (!retrieve_success)
         {
-            bplib_os_free(object_ptr);
+            free_object(object_ptr, region);
 
             /* Close Read File */
             if (fs->retrieve_fd)
@@ -830,36 +2864,44 @@ int bplib_store_file_retrieve(bp_handle_t h, bp_sid_t sid, bp_object_t **object,
         }
 
         /* Check State of Data Cache */
-        cache_index = data_id % fs->cache_size;
-        if (fs->data_cache[cache_index].mem_locked)
+        if (!cache_available(fs))
         {
             int wait_status = bplib_os_waiton(fs->lock, timeout);
             if (wait_status == BP_ERROR)
             {
-                bplib_os_free(object_ptr);
+                free_object(object_ptr, region);
                 bplib_os_unlock(fs->lock);
                 return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to update data cache on retrieval\n",
                              wait_status);
             }
-            else if ((wait_status == BP_TIMEOUT) || (fs->data_cache[cache_index].mem_locked))
+            else if ((wait_status == BP_TIMEOUT) || !cache_available(fs))
             {
-                bplib_os_free(object_ptr);
+                free_object(object_ptr, region);
                 bplib_os_unlock(fs->lock);
                 return BP_TIMEOUT;
             }
         }
 
-        /* Free Previous Entry in Data Cache */
-        if (fs->data_cache[cache_index].mem_ptr)
+        /* Update Data Cache */
+        cache_insert(fs, data_id, object_ptr, region, true);
+
+        /* Read Ahead in Segment File
+         *  retransmissions walk forward through the oldest segments, so the
+         *  objects that follow are likely to be retrieved next */
+        if (retrieve_file)
         {
-            bplib_os_free(fs->data_cache[cache_index].mem_ptr);
+            int prefetched = prefetch_objects(fs, fs->retrieve_fd, (unsigned long)sid);
+            if (prefetched == BP_ERROR)
+            {
+                file_driver.close(fs->retrieve_fd);
+                fs->retrieve_fd = NULL;
+            }
+            else
+            {
+                fs->retrieve_data_id += prefetched;
+            }
         }
 
-        /* Update Data Cache */
-        fs->data_cache[cache_index].mem_locked  = FILE_MEM_LOCKED;
-        fs->data_cache[cache_index].mem_ptr     = object_ptr;
-        fs->data_cache[cache_index].mem_data_id = data_id;
-
         /* Return Object */
         *object = (bp_object_t *)object_ptr;
     }
@@ -884,11 +2926,10 @@ int bplib_store_file_release(bp_handle_t h, bp_sid_t sid)
     bplib_os_lock(fs->lock);
     {
         /* Get Cache Index */
-        unsigned long data_id     = GET_DATAID(sid);
-        unsigned long cache_index = data_id % fs->cache_size;
+        int cache_index = cache_find(fs, GET_DATAID(sid));
 
         /* Check Data Cache */
-        if ((fs->data_cache[cache_index].mem_ptr == NULL) || (fs->data_cache[cache_index].mem_data_id != data_id))
+        if (cache_index == FILE_CACHE_NULL)
         {
             /* Releasing Invalid Resource */
             bplib_os_unlock(fs->lock);
@@ -896,8 +2937,8 @@ int bplib_store_file_release(bp_handle_t h, bp_sid_t sid)
         }
 
         /* Unlock Cache Entry */
-        fs->data_cache[cache_index].mem_locked = FILE_MEM_AVAIABLE;
-        bplib_os_signal(fs->lock);
+        cache_unlock(fs, cache_index);
+        wake_waiter(fs);
     }
     bplib_os_unlock(fs->lock);
 
@@ -911,6 +2952,7 @@ int bplib_store_file_release(bp_handle_t h, bp_sid_t sid)
 int bplib_store_file_relinquish(bp_handle_t h, bp_sid_t sid)
 {
     int handle = bp_handle_to_serial(h, BPLIB_HANDLE_FILE_STORE_BASE);
+    int status;
 
     assert(handle >= 0 && handle < FILE_MAX_STORES);
     assert(file_stores[handle].in_use);
@@ -918,120 +2960,45 @@ int bplib_store_file_relinquish(bp_handle_t h, bp_sid_t sid)
     file_store_t *fs = (file_store_t *)&file_stores[handle];
     bplib_os_lock(fs->lock);
     {
-        /* Get IDs */
-        unsigned long data_id      = GET_DATAID(sid);
-        unsigned long file_id      = GET_FILEID(data_id);
-        unsigned long data_offset  = GET_DATAOFFSET(data_id);
-        unsigned long prev_data_id = GET_DATAID(fs->relinquish_data_id);
-        unsigned long prev_file_id = GET_FILEID(prev_data_id);
-
-        /* Clear Data Cache */
-        unsigned long cache_index = data_id % fs->cache_size;
-        if (fs->data_cache[cache_index].mem_ptr)
-        {
-            if (fs->data_cache[cache_index].mem_data_id == data_id)
-            {
-                bplib_os_free(fs->data_cache[cache_index].mem_ptr);
-                fs->data_cache[cache_index].mem_ptr     = NULL;
-                fs->data_cache[cache_index].mem_data_id = BP_SID_VACANT;
-                fs->data_cache[cache_index].mem_locked  = FILE_MEM_AVAIABLE;
-            }
-        }
-
-        /* Check Need to Read New Relinquish Table */
-        if (file_id != prev_file_id)
-        {
-            /* Set Current Relinquish Table */
-            fs->relinquish_data_id = (unsigned long)sid;
-
-            /* Check Need to Save Off Previous Relinquish Table */
-            if (fs->relinquish_table.free_cnt > 0)
-            {
-                /* Open Previous Relinquish File */
-                if (fs->relinquish_fd == NULL)
-                {
-                    fs->relinquish_fd = open_tbl_file(fs->service_id, fs->file_root, prev_file_id, false);
-                    if (fs->relinquish_fd == NULL)
-                    {
-                        bplib_os_unlock(fs->lock);
-                        return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to relinquish data\n");
-                    }
-                }
-
-                /* Write Previous Relinquish Table */
-                unsigned long bytes_written =
-                    file_driver.write(&fs->relinquish_table, 1, sizeof(fs->relinquish_table), fs->relinquish_fd);
-
-                /* Close Previous Relinquish File */
-                file_driver.close(fs->relinquish_fd);
-                fs->relinquish_fd = NULL;
-
-                /* Check Status of Write */
-                if (bytes_written != sizeof(fs->relinquish_table))
-                {
-                    bplib_os_unlock(fs->lock);
-                    return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to update relinquish table (%d != %d)\n",
-                                 bytes_written, sizeof(fs->relinquish_table));
-                }
-            }
+        status = relinquish_object(fs, sid);
+    }
+    bplib_os_unlock(fs->lock);
 
-            /* Open New Relinquish File */
-            fs->relinquish_fd = open_tbl_file(fs->service_id, fs->file_root, file_id, true);
-            if (fs->relinquish_fd == NULL)
-            {
-                /* Initialize New Relinquish Table */
-                memset(&fs->relinquish_table, 0, sizeof(fs->relinquish_table));
-            }
-            else
-            {
-                /* Read Relinquish Table */
-                unsigned long bytes_read =
-                    file_driver.read(&fs->relinquish_table, 1, sizeof(fs->relinquish_table), fs->relinquish_fd);
+    /* Return Status */
+    return status;
+}
 
-                /* Close New Relinquish File */
-                file_driver.close(fs->relinquish_fd);
-                fs->relinquish_fd = NULL;
+/*--------------------------------------------------------------------------------------
+ * bplib_store_file_relinquish_batch -
+ *
+ *  relinquishes each object under a single store lock, returns the first error code
+ *-------------------------------------------------------------------------------------*/
+int bplib_store_file_relinquish_batch(bp_handle_t h, const bp_sid_t *sids, int count)
+{
+    int handle     = bp_handle_to_serial(h, BPLIB_HANDLE_FILE_STORE_BASE);
+    int ret_status = BP_SUCCESS;
+    int i;
 
-                /* Check for Error */
-                if (bytes_read != sizeof(fs->relinquish_table))
-                {
-                    bplib_os_unlock(fs->lock);
-                    return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to read new relinquish table (%d != %d)\n",
-                                 bytes_read, sizeof(fs->relinquish_table));
-                }
-            }
-        }
+    assert(handle >= 0 && handle < FILE_MAX_STORES);
+    assert(file_stores[handle].in_use);
+    assert(sids);
 
-        /* Check if Still Present */
-        if (fs->relinquish_table.freed[data_offset] == 0)
+    file_store_t *fs = (file_store_t *)&file_stores[handle];
+    bplib_os_lock(fs->lock);
+    {
+        for (i = 0; i < count; i++)
         {
-            /* Mark Data as Relinquished */
-            fs->relinquish_table.freed[data_offset] = 1;
-            fs->data_count--;
-
-            /* Relinquish Resources */
-            fs->relinquish_table.free_cnt++;
-            if (fs->relinquish_table.free_cnt == FILE_DATA_COUNT)
+            int status = relinquish_object(fs, sids[i]);
+            if (status != BP_SUCCESS && ret_status == BP_SUCCESS)
             {
-                /* Delete Associated Files
-                 *  only check the status of the data file deletion as it is
-                 *  possible (and often the case) that the table file is never
-                 *  created because the state of which bundles are freed does
-                 *  not need to be saved off */
-                delete_tbl_file(fs->service_id, fs->file_root, file_id);
-                int dat_status = delete_dat_file(fs->service_id, fs->file_root, file_id);
-                if (dat_status < 0)
-                {
-                    bplib_os_unlock(fs->lock);
-                    return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to relinquish file\n", dat_status);
-                }
+                ret_status = status;
             }
         }
     }
     bplib_os_unlock(fs->lock);
 
-    /* Return Success */
-    return BP_SUCCESS;
+    /* Return Status */
+    return ret_status;
 }
 
 /*--------------------------------------------------------------------------------------
@@ -36,14 +36,23 @@
 
 #define FLASH_OBJECT_SYNC_HI 0x42502046
 #define FLASH_OBJECT_SYNC_LO 0x4C415348
+#define FLASH_OBJECT_ALIGN   8 /* alignment of objects packed into a shared page */
+#define FLASH_SID_PROBES     4 /* consecutive cache entries an object may be placed in */
 
 /******************************************************************************
  MACROS
  ******************************************************************************/
 
-#define FLASH_GET_SID(addr)  ((((addr).block * FLASH_DRIVER.pages_per_block) + (addr).page) + 1)
-#define FLASH_GET_BLOCK(sid) (((sid)-1) / FLASH_DRIVER.pages_per_block)
-#define FLASH_GET_PAGE(sid)  (((sid)-1) % FLASH_DRIVER.pages_per_block)
+#define FLASH_GET_SID(addr, slot) \
+    (((((addr).block * FLASH_DRIVER.pages_per_block) + (addr).page) * FLASH_MAX_OBJECTS_PER_PAGE) + (slot) + 1)
+#define FLASH_GET_BLOCK(sid) ((((sid)-1) / FLASH_MAX_OBJECTS_PER_PAGE) / FLASH_DRIVER.pages_per_block)
+#define FLASH_GET_PAGE(sid)  ((((sid)-1) / FLASH_MAX_OBJECTS_PER_PAGE) % FLASH_DRIVER.pages_per_block)
+#define FLASH_GET_SLOT(sid)  (((sid)-1) % FLASH_MAX_OBJECTS_PER_PAGE)
+
+#define FLASH_OBJECT_SPAN(size) \
+    (((sizeof(flash_object_hdr_t) + (size) + FLASH_OBJECT_ALIGN - 1) / FLASH_OBJECT_ALIGN) * FLASH_OBJECT_ALIGN)
+#define FLASH_SAME_PAGE(a, b) (((a).block == (b).block) && ((a).page == (b).page))
+#define FLASH_SID_INDEX(sid)  (((((uint32_t)(sid)) * UINT32_C(2654435761)) >> 16) % FLASH_SID_CACHE_SIZE)
 
 /******************************************************************************
  TYPEDEFS
@@ -60,8 +69,16 @@ typedef struct
 {
     bp_flash_index_t next_block;
     bp_flash_index_t pages_in_use;
+    uint32_t         erase_count; /* number of times block erased since initialization */
 } flash_block_control_t;
 
+typedef struct
+{
+    bp_sid_t sid;    /* object described by entry, BP_SID_VACANT when empty */
+    int      size;   /* size of object data */
+    int      offset; /* offset of object header in its first page */
+} flash_sid_entry_t;
+
 typedef struct
 {
     bp_flash_index_t out;
@@ -71,20 +88,30 @@ typedef struct
 
 typedef struct
 {
-    bool             in_use;
-    bool             preserve;
-    int              type; /* bp store type */
-    bp_ipn_t         node;
-    bp_ipn_t         service;
-    bp_flash_attr_t  attributes;
-    bp_flash_addr_t  write_addr;
-    bp_flash_addr_t  read_addr;
-    bp_flash_index_t active_block;
-    uint8_t         *write_stage; /* holding buffer to construct data object before write */
-    uint8_t         *read_stage;  /* lockable buffer that holds data object for read */
-    bool             stage_locked;
-    int              object_count;
-    int              inactive_count;
+    bool               in_use;
+    bool               preserve;
+    int                type; /* bp store type */
+    bp_ipn_t           node;
+    bp_ipn_t           service;
+    bp_flash_attr_t    attributes;
+    bp_flash_addr_t    write_addr;
+    bp_flash_addr_t    read_addr;
+    int                read_slot; /* object within read page when pages are shared */
+    bp_flash_index_t   active_block;
+    uint8_t           *write_stage;   /* holding buffer to construct data object before write */
+    uint8_t           *read_stage;    /* lockable buffer that holds data object for read */
+    uint8_t           *combine_page;  /* page at write address being filled with small objects */
+    int                combine_slots; /* number of objects packed into combine page */
+    int                combine_bytes; /* number of bytes used in combine page */
+    int                combine_live;  /* number of objects in combine page not yet relinquished */
+    uint8_t           *page_buffer;   /* memory buffer used for ECC and for object deletes */
+    flash_sid_entry_t *sid_cache;     /* dequeued objects indexed by SID, NULL when disabled */
+    bool               stage_locked;
+    int                object_count;
+    int                inactive_count;
+    int                page_writes; /* pages programmed through this control structure */
+    int                page_reads;  /* pages read through this control structure */
+    bplib_os_mutex_t   lock;        /* mutex for queue state and stages of this store */
 } flash_store_t;
 
 /******************************************************************************
@@ -102,12 +129,16 @@ static int               FLASH_ECC_CODE_SIZE  = 0; /* size in bytes of encoding
 static flash_store_t      flash_stores[FLASH_MAX_STORES]; /* available set of storage service control structures */
 static flash_block_list_t flash_free_blocks;              /* linked list of flash blocks available for use */
 static flash_block_list_t flash_fail_blocks; /* linked list of flash blocks that have failed during runtime use */
+static flash_block_list_t flash_erased_blocks; /* linked list of free flash blocks already erased for allocation */
 
-static bp_handle_t            flash_device_lock = {0};  /* mutex for accessing flash control structures */
-static flash_block_control_t *flash_blocks      = NULL; /* memory array of per block meta data, one per flash block */
-static int      flash_error_count      = 0; /* total number of flash errors encountered across all storage services */
-static int      flash_used_block_count = 0; /* total number of flash blocks currently in use by all storage services */
-static uint8_t *flash_page_buffer      = NULL; /* memory buffer used for ECC and for object deletes */
+static bp_handle_t            flash_alloc_lock = {0};  /* mutex for block lists, counts, and claiming stores */
+static flash_block_control_t *flash_blocks     = NULL; /* memory array of per block meta data, one per flash block */
+static int flash_error_count      = 0; /* total number of flash errors encountered across all storage services */
+static int flash_used_block_count = 0; /* total number of flash blocks currently in use by all storage services */
+
+static bp_handle_t      flash_gc_thread_handle = {0};   /* background erase thread */
+static bool             flash_gc_running       = false; /* background erase thread commanded to run */
+static bp_flash_index_t flash_gc_block = BP_FLASH_INVALID_INDEX; /* block being erased by the background thread */
 
 /******************************************************************************
  LOCAL FUNCTIONS - UTILITY
@@ -119,7 +150,7 @@ static uint8_t *flash_page_buffer      = NULL; /* memory buffer used for ECC and
 BP_LOCAL_SCOPE const char *type2str(int type)
 {
     const char *type_str = "objects";
-    if (type == BP_STORE_DATA_TYPE)
+    if (type == BP_STORE_DATA_TYPE || type == BP_STORE_BULK_TYPE || type == BP_STORE_EXPEDITED_TYPE)
     {
         type_str = "bundle(s)";
     }
@@ -141,15 +172,15 @@ BP_LOCAL_SCOPE const char *type2str(int type)
 /*--------------------------------------------------------------------------------------
  * flash_page_write -
  *-------------------------------------------------------------------------------------*/
-BP_LOCAL_SCOPE int flash_page_write(bp_flash_addr_t addr, uint8_t *data, int size)
+BP_LOCAL_SCOPE int flash_page_write(uint8_t *page_buffer, bp_flash_addr_t addr, uint8_t *data, int size)
 {
     assert(size <= FLASH_PAGE_DATA_SIZE);
 
     if (FLASH_ECC_CODE_SIZE > 0)
     {
-        memcpy(flash_page_buffer, data, size);
-        lrc_encode(flash_page_buffer, FLASH_PAGE_DATA_SIZE);
-        return FLASH_DRIVER.write(addr, flash_page_buffer);
+        memcpy(page_buffer, data, size);
+        lrc_encode(page_buffer, FLASH_PAGE_DATA_SIZE);
+        return FLASH_DRIVER.write(addr, page_buffer);
     }
     else
     {
@@ -160,7 +191,7 @@ BP_LOCAL_SCOPE int flash_page_write(bp_flash_addr_t addr, uint8_t *data, int siz
 /*--------------------------------------------------------------------------------------
  * flash_page_read -
  *-------------------------------------------------------------------------------------*/
-BP_LOCAL_SCOPE int flash_page_read(bp_flash_addr_t addr, uint8_t *data, int size)
+BP_LOCAL_SCOPE int flash_page_read(uint8_t *page_buffer, bp_flash_addr_t addr, uint8_t *data, int size)
 {
     assert(size <= FLASH_PAGE_DATA_SIZE);
 
@@ -168,10 +199,10 @@ BP_LOCAL_SCOPE int flash_page_read(bp_flash_addr_t addr, uint8_t *data, int size
 
     if (FLASH_ECC_CODE_SIZE > 0)
     {
-        status = FLASH_DRIVER.read(addr, flash_page_buffer);
+        status = FLASH_DRIVER.read(addr, page_buffer);
         if (status == BP_SUCCESS)
         {
-            int decode_status = lrc_decode(flash_page_buffer, FLASH_PAGE_DATA_SIZE);
+            int decode_status = lrc_decode(page_buffer, FLASH_PAGE_DATA_SIZE);
             if (decode_status == BP_ECC_NO_ERRORS)
             {
                 status = BP_SUCCESS;
@@ -190,23 +221,23 @@ BP_LOCAL_SCOPE int flash_page_read(bp_flash_addr_t addr, uint8_t *data, int size
             }
 
             /*
-             * Inside flash_object_delete, the flash_page_buffer is used to read the first
+             * Inside flash_object_delete, the store's page buffer is used to read the first
              * page of an object - this is a shortcut so that the code doesn't need to allocate
              * a separate buffer just to read the beginning of the object.  It is the only
              * time in the code when this is done, and it is hardcoded to only read one page
-             * and have the offset into the flash_page_buffer be zero.
+             * and have the offset into the page buffer be zero.
              *
-             * When this occurs, we not only don't need to copy the contents out of the flash_page_buffer
+             * When this occurs, we not only don't need to copy the contents out of the page buffer
              * since the "data" pointer already points to it, but on many architectures, calling
              * memcpy with overlapping address ranges causes an exception.
              *
              * Note that there is no case in the code where the data buffer is pointing to a location
-             * in memory that overlaps with the flash_page_buffer; so the check for equivalence is
+             * in memory that overlaps with the page buffer; so the check for equivalence is
              * sufficient.
              */
-            if (data != flash_page_buffer)
+            if (data != page_buffer)
             {
-                memcpy(data, flash_page_buffer, size);
+                memcpy(data, page_buffer, size);
             }
         }
     }
@@ -244,64 +275,195 @@ BP_LOCAL_SCOPE void flash_block_list_add(flash_block_list_t *list, bp_flash_inde
 }
 
 /*--------------------------------------------------------------------------------------
- * flash_free_reclaim -
+ * flash_block_list_remove - unlink block from list given the block linking to it
  *-------------------------------------------------------------------------------------*/
-BP_LOCAL_SCOPE int flash_free_reclaim(bp_flash_index_t block)
+BP_LOCAL_SCOPE void flash_block_list_remove(flash_block_list_t *list, bp_flash_index_t prev, bp_flash_index_t block)
 {
-    /* Clear Block Control Entry */
-    flash_blocks[block].next_block   = BP_FLASH_INVALID_INDEX;
-    flash_blocks[block].pages_in_use = FLASH_DRIVER.pages_per_block;
+    /* Link Around Block */
+    if (prev == BP_FLASH_INVALID_INDEX)
+    {
+        list->out = flash_blocks[block].next_block;
+    }
+    else
+    {
+        flash_blocks[prev].next_block = flash_blocks[block].next_block;
+    }
 
-    /* Block No Longer In Use */
-    flash_used_block_count--;
+    /* Removing Last Block */
+    if (list->in == block)
+    {
+        list->in = prev;
+    }
+
+    /* Mark Next Block Invalid */
+    flash_blocks[block].next_block = BP_FLASH_INVALID_INDEX;
+    list->count--;
+}
 
-    /* Add to Free or Failed List */
-    if (!FLASH_DRIVER.isbad(block))
+/*--------------------------------------------------------------------------------------
+ * flash_free_select - take least erased block off the free list, allocator lock held
+ *
+ *  ties go to the block that has been on the free list the longest, so when wear is
+ *  even blocks are handed out in the order they were reclaimed
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bp_flash_index_t flash_free_select(void)
+{
+    bp_flash_index_t prev      = BP_FLASH_INVALID_INDEX;
+    bp_flash_index_t best      = flash_free_blocks.out;
+    bp_flash_index_t best_prev = BP_FLASH_INVALID_INDEX;
+
+    /* Empty Free List */
+    if (best == BP_FLASH_INVALID_INDEX)
     {
-        flash_block_list_add(&flash_free_blocks, block);
-        return BP_SUCCESS;
+        return BP_FLASH_INVALID_INDEX;
     }
-    else
+
+    /* Find Least Worn Block */
+    bp_flash_index_t block = best;
+    while (block != BP_FLASH_INVALID_INDEX)
+    {
+        if (flash_blocks[block].erase_count < flash_blocks[best].erase_count)
+        {
+            best      = block;
+            best_prev = prev;
+        }
+        prev  = block;
+        block = flash_blocks[block].next_block;
+    }
+
+    /* Take Block */
+    flash_block_list_remove(&flash_free_blocks, best_prev, best);
+    return best;
+}
+
+/*--------------------------------------------------------------------------------------
+ * flash_count_error - count flash error from outside the allocator lock
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void flash_count_error(void)
+{
+    bplib_os_lock(flash_alloc_lock);
+    flash_error_count++;
+    bplib_os_unlock(flash_alloc_lock);
+}
+
+/*--------------------------------------------------------------------------------------
+ * flash_free_reclaim -
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int flash_free_reclaim(bp_flash_index_t block)
+{
+    int status;
+
+    bplib_os_lock(flash_alloc_lock);
     {
-        flash_block_list_add(&flash_fail_blocks, block);
-        return BP_ERROR;
+        /* Clear Block Control Entry */
+        flash_blocks[block].next_block   = BP_FLASH_INVALID_INDEX;
+        flash_blocks[block].pages_in_use = FLASH_DRIVER.pages_per_block;
+
+        /* Block No Longer In Use */
+        flash_used_block_count--;
+
+        /* Add to Free or Failed List */
+        if (!FLASH_DRIVER.isbad(block))
+        {
+            flash_block_list_add(&flash_free_blocks, block);
+            status = BP_SUCCESS;
+        }
+        else
+        {
+            flash_block_list_add(&flash_fail_blocks, block);
+            status = BP_ERROR;
+        }
+
+        /* Wake Background Erase */
+        bplib_os_broadcast(flash_alloc_lock);
     }
+    bplib_os_unlock(flash_alloc_lock);
+
+    return status;
 }
 
 /*--------------------------------------------------------------------------------------
  * flash_free_allocate -
+ *
+ *  blocks already erased by the background erase thread are handed out first; otherwise
+ *  the least worn free block is taken off the free list before it is erased so that the
+ *  erase, which is the slowest flash operation, does not hold up other stores reclaiming
+ *  or allocating
  *-------------------------------------------------------------------------------------*/
 BP_LOCAL_SCOPE int flash_free_allocate(bp_flash_index_t *block)
 {
     int status = BP_ERROR;
 
-    /* Erase Block */
-    while (status != BP_SUCCESS && flash_free_blocks.out != BP_FLASH_INVALID_INDEX)
+    while (status != BP_SUCCESS)
     {
-        bp_flash_index_t block_out = flash_free_blocks.out;
-        status                     = FLASH_DRIVER.erase(block_out);
-        if (status == BP_SUCCESS)
+        bp_flash_index_t block_out = BP_FLASH_INVALID_INDEX;
+
+        /* Move to Next Free Block */
+        bplib_os_lock(flash_alloc_lock);
         {
-            /* Return Block */
-            *block = block_out;
-            flash_used_block_count++;
+            while (true)
+            {
+                if (flash_erased_blocks.out != BP_FLASH_INVALID_INDEX)
+                {
+                    /* Take Erased Block */
+                    block_out = flash_erased_blocks.out;
+                    flash_block_list_remove(&flash_erased_blocks, BP_FLASH_INVALID_INDEX, block_out);
+                    *block = block_out;
+                    flash_used_block_count++;
+                    status = BP_SUCCESS;
+                    break;
+                }
+                else if (flash_gc_block != BP_FLASH_INVALID_INDEX)
+                {
+                    /* Wait for Background Erase - it has the next block */
+                    bplib_os_waiton(flash_alloc_lock, BP_PEND);
+                }
+                else
+                {
+                    /* Take Least Worn Free Block */
+                    block_out = flash_free_select();
+                    break;
+                }
+            }
+
+            /* Wake Background Erase to Replace Block */
+            bplib_os_broadcast(flash_alloc_lock);
         }
-        else
+        bplib_os_unlock(flash_alloc_lock);
+
+        /* Check for Empty List or Erased Block */
+        if (block_out == BP_FLASH_INVALID_INDEX || status == BP_SUCCESS)
+        {
+            break;
+        }
+
+        /* Erase Block */
+        status = FLASH_DRIVER.erase(block_out);
+        bplib_os_lock(flash_alloc_lock);
+        {
+            if (status == BP_SUCCESS)
+            {
+                /* Return Block */
+                *block = block_out;
+                flash_blocks[block_out].erase_count++;
+                flash_used_block_count++;
+            }
+            else
+            {
+                /* Failed to Erase - Add to Failed Block List */
+                flash_error_count++;
+                flash_block_list_add(&flash_fail_blocks, block_out);
+            }
+        }
+        bplib_os_unlock(flash_alloc_lock);
+
+        /* Log Erase Failure */
+        if (status != BP_SUCCESS)
         {
-            /* Failed to Erase - Add to Failed Block List */
-            flash_error_count++;
-            flash_block_list_add(&flash_fail_blocks, block_out);
             bplog(NULL, BP_FLAG_STORE_FAILURE,
                   "Failed to erase block %d when allocating it... adding as failed block\n",
                   FLASH_DRIVER.phyblk(block_out));
         }
-
-        /* Move to Next Free Block */
-        flash_free_blocks.out = flash_blocks[block_out].next_block;
-        flash_free_blocks.count--;
-
-        /* Mark Next Block Invalid */
-        flash_blocks[block_out].next_block = BP_FLASH_INVALID_INDEX;
     }
 
     /* Log Error */
@@ -314,10 +476,87 @@ BP_LOCAL_SCOPE int flash_free_allocate(bp_flash_index_t *block)
     return status;
 }
 
+/*--------------------------------------------------------------------------------------
+ * flash_gc_thread - keeps the erased block list topped up so allocation does not erase
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void flash_gc_thread(void *parm)
+{
+    (void)parm;
+
+    bplib_os_lock(flash_alloc_lock);
+    {
+        while (flash_gc_running)
+        {
+            if (flash_erased_blocks.count < FLASH_GC_ERASED_BLOCKS && flash_free_blocks.count > 0)
+            {
+                /* Erase Outside of Allocator Lock */
+                bp_flash_index_t block = flash_free_select();
+                flash_gc_block         = block;
+                bplib_os_unlock(flash_alloc_lock);
+                int status = FLASH_DRIVER.erase(block);
+                bplib_os_lock(flash_alloc_lock);
+                flash_gc_block = BP_FLASH_INVALID_INDEX;
+
+                /* Add to Erased or Failed List */
+                if (status == BP_SUCCESS)
+                {
+                    flash_blocks[block].erase_count++;
+                    flash_block_list_add(&flash_erased_blocks, block);
+                }
+                else
+                {
+                    bplog(NULL, BP_FLAG_STORE_FAILURE,
+                          "Failed to erase block %d in background... adding as failed block\n",
+                          FLASH_DRIVER.phyblk(block));
+                    flash_error_count++;
+                    flash_block_list_add(&flash_fail_blocks, block);
+                }
+
+                /* Wake Allocators Waiting on Erase */
+                bplib_os_broadcast(flash_alloc_lock);
+            }
+            else
+            {
+                bplib_os_waiton(flash_alloc_lock, BP_PEND);
+            }
+        }
+    }
+    bplib_os_unlock(flash_alloc_lock);
+}
+
+/*--------------------------------------------------------------------------------------
+ * flash_write_advance - move write address to next page, allocating next block as needed
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int flash_write_advance(bp_flash_addr_t *addr)
+{
+    addr->page++;
+
+    /* Check Need to go to Next Block */
+    if (addr->page >= FLASH_DRIVER.pages_per_block)
+    {
+        bp_flash_index_t next_write_block;
+        int              flash_status = flash_free_allocate(&next_write_block);
+        if (flash_status == BP_SUCCESS)
+        {
+            flash_blocks[addr->block].next_block = next_write_block;
+            addr->block                          = next_write_block;
+            addr->page                           = 0;
+        }
+        else
+        {
+            return bplog(NULL, BP_FLAG_STORE_FAILURE,
+                         "Failed to retrieve next free block in middle of flash write at block: %ld\n",
+                         FLASH_DRIVER.phyblk(addr->block));
+        }
+    }
+
+    return BP_SUCCESS;
+}
+
 /*--------------------------------------------------------------------------------------
  * flash_data_write -
  *-------------------------------------------------------------------------------------*/
-BP_LOCAL_SCOPE int flash_data_write(bp_flash_addr_t *addr, uint8_t *data, int size)
+BP_LOCAL_SCOPE int flash_data_write(uint8_t *page_buffer, bp_flash_addr_t *addr, uint8_t *data, int size)
 {
     int data_index = 0;
     int bytes_left = size;
@@ -334,14 +573,14 @@ BP_LOCAL_SCOPE int flash_data_write(bp_flash_addr_t *addr, uint8_t *data, int si
     {
         /* Write Data into Page */
         int bytes_to_copy = bytes_left < FLASH_PAGE_DATA_SIZE ? bytes_left : FLASH_PAGE_DATA_SIZE;
-        int flash_status  = flash_page_write(*addr, &data[data_index], bytes_to_copy);
+        int flash_status  = flash_page_write(page_buffer, *addr, &data[data_index], bytes_to_copy);
 
         /* Check if Write Failed
          *  don't set return status of function to failure
          *  but instead count and log the error and keep going */
         if (flash_status != BP_SUCCESS)
         {
-            flash_error_count++;
+            flash_count_error();
             bplog(NULL, BP_FLAG_STORE_FAILURE, "Error encountered writing data to flash address: %d.%d\n",
                   FLASH_DRIVER.phyblk(addr->block), addr->page);
         }
@@ -349,25 +588,9 @@ BP_LOCAL_SCOPE int flash_data_write(bp_flash_addr_t *addr, uint8_t *data, int si
         /* Always Continue with Write */
         data_index += bytes_to_copy;
         bytes_left -= bytes_to_copy;
-        addr->page++;
-
-        /* Check Need to go to Next Block */
-        if (addr->page >= FLASH_DRIVER.pages_per_block)
+        if (flash_write_advance(addr) != BP_SUCCESS)
         {
-            bp_flash_index_t next_write_block;
-            flash_status = flash_free_allocate(&next_write_block);
-            if (flash_status == BP_SUCCESS)
-            {
-                flash_blocks[addr->block].next_block = next_write_block;
-                addr->block                          = next_write_block;
-                addr->page                           = 0;
-            }
-            else
-            {
-                return bplog(NULL, BP_FLAG_STORE_FAILURE,
-                             "Failed to retrieve next free block in middle of flash write at block: %ld\n",
-                             FLASH_DRIVER.phyblk(addr->block));
-            }
+            return BP_ERROR;
         }
     }
 
@@ -377,7 +600,7 @@ BP_LOCAL_SCOPE int flash_data_write(bp_flash_addr_t *addr, uint8_t *data, int si
 /*--------------------------------------------------------------------------------------
  * flash_data_read -
  *-------------------------------------------------------------------------------------*/
-BP_LOCAL_SCOPE int flash_data_read(bp_flash_addr_t *addr, uint8_t *data, int size)
+BP_LOCAL_SCOPE int flash_data_read(uint8_t *page_buffer, bp_flash_addr_t *addr, uint8_t *data, int size)
 {
     int data_index = 0;
     int bytes_left = size;
@@ -394,14 +617,14 @@ BP_LOCAL_SCOPE int flash_data_read(bp_flash_addr_t *addr, uint8_t *data, int siz
     {
         /* Read Data from Page */
         int bytes_to_copy = bytes_left < FLASH_PAGE_DATA_SIZE ? bytes_left : FLASH_PAGE_DATA_SIZE;
-        int flash_status  = flash_page_read(*addr, &data[data_index], bytes_to_copy);
+        int flash_status  = flash_page_read(page_buffer, *addr, &data[data_index], bytes_to_copy);
 
         /* Check if Read Failed
          *  don't set return status of function to failure
          *  but instead count and log the error and keep going */
         if (flash_status != BP_SUCCESS)
         {
-            flash_error_count++;
+            flash_count_error();
             bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to read data from flash address: %d.%d\n",
                   FLASH_DRIVER.phyblk(addr->block), addr->page);
         }
@@ -435,6 +658,184 @@ BP_LOCAL_SCOPE int flash_data_read(bp_flash_addr_t *addr, uint8_t *data, int siz
  LOCAL FUNCTIONS - OBJECT LEVEL
  ******************************************************************************/
 
+/*--------------------------------------------------------------------------------------
+ * flash_active_reclaim - reclaim fully deleted blocks at the front of the store
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void flash_active_reclaim(flash_store_t *fs)
+{
+    while (fs->active_block != BP_FLASH_INVALID_INDEX && flash_blocks[fs->active_block].pages_in_use == 0)
+    {
+        /* Get Next Block */
+        bp_flash_index_t next_active_block = flash_blocks[fs->active_block].next_block;
+
+        /* Reclaim Block as Free */
+        int status = flash_free_reclaim(fs->active_block);
+        if (status != BP_SUCCESS)
+        {
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to reclaim block %d as a free block\n", status,
+                  FLASH_DRIVER.phyblk(fs->active_block));
+        }
+
+        /* Update Active Block */
+        fs->active_block = next_active_block;
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * flash_page_locate - returns offset of object in slot of a shared page, or BP_ERROR
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int flash_page_locate(const uint8_t *page, int slot)
+{
+    int offset = 0;
+    int s;
+
+    for (s = 0; s < FLASH_MAX_OBJECTS_PER_PAGE; s++)
+    {
+        const flash_object_hdr_t *flash_object_hdr = (const flash_object_hdr_t *)&page[offset];
+
+        /* Check for End of Objects in Page */
+        if (((offset + sizeof(flash_object_hdr_t)) > (size_t)FLASH_PAGE_DATA_SIZE) ||
+            (flash_object_hdr->synchi != FLASH_OBJECT_SYNC_HI) || (flash_object_hdr->synclo != FLASH_OBJECT_SYNC_LO) ||
+            (flash_object_hdr->object_hdr.size > (size_t)FLASH_PAGE_DATA_SIZE))
+        {
+            break;
+        }
+        else if (s == slot)
+        {
+            return offset;
+        }
+
+        /* Skip to Next Object */
+        offset += FLASH_OBJECT_SPAN(flash_object_hdr->object_hdr.size);
+    }
+
+    return BP_ERROR;
+}
+
+/*--------------------------------------------------------------------------------------
+ * flash_combine_flush - program the partially filled combine page and move past it
+ *
+ *  the page is only written when at least one of its objects is still held by the store;
+ *  either way the page holds a use count on its block until this point so that the block
+ *  cannot be reclaimed while the write address still points into it
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int flash_combine_flush(flash_store_t *fs)
+{
+    bp_flash_addr_t page_addr = fs->write_addr;
+    int             slots     = fs->combine_slots;
+    int             status;
+
+    /* Check for Open Page */
+    if (slots == 0)
+    {
+        return BP_SUCCESS;
+    }
+
+    /* Program Page */
+    if (fs->combine_live > 0)
+    {
+        /* Encode in Place - combine page is sized to hold the code bytes */
+        if (FLASH_ECC_CODE_SIZE > 0)
+        {
+            lrc_encode(fs->combine_page, FLASH_PAGE_DATA_SIZE);
+        }
+
+        /* Count and Log Error but Keep Going (same as flash_data_write) */
+        fs->page_writes++;
+        if (FLASH_DRIVER.write(page_addr, fs->combine_page) != BP_SUCCESS)
+        {
+            flash_count_error();
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Error encountered writing combined page to flash address: %d.%d\n",
+                  FLASH_DRIVER.phyblk(page_addr.block), page_addr.page);
+        }
+    }
+
+    /* Close Page */
+    fs->combine_slots = 0;
+    fs->combine_bytes = 0;
+    fs->combine_live  = 0;
+    status            = flash_write_advance(&fs->write_addr);
+
+    /* Move Reader Past Page if Already Consumed */
+    if (FLASH_SAME_PAGE(fs->read_addr, page_addr) && (fs->read_slot >= slots))
+    {
+        fs->read_addr = fs->write_addr;
+        fs->read_slot = 0;
+    }
+
+    /* Release Hold on Block */
+    flash_blocks[page_addr.block].pages_in_use--;
+    if ((status == BP_SUCCESS) && (page_addr.block == fs->active_block))
+    {
+        flash_active_reclaim(fs);
+    }
+
+    return status;
+}
+
+/*--------------------------------------------------------------------------------------
+ * flash_object_combine - pack object into the combine page at the write address
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int flash_object_combine(flash_store_t *fs, bp_handle_t h, const uint8_t *data1, int data1_size,
+                                        const uint8_t *data2, int data2_size)
+{
+    int status       = BP_SUCCESS;
+    int bytes_needed = sizeof(flash_object_hdr_t) + data1_size + data2_size;
+
+    /* Program Current Page if Object Does Not Fit */
+    if ((fs->combine_slots > 0) && ((fs->combine_bytes + bytes_needed) > FLASH_PAGE_DATA_SIZE))
+    {
+        status = flash_combine_flush(fs);
+        if (status != BP_SUCCESS)
+        {
+            return status;
+        }
+    }
+
+    /* Open New Page */
+    if (fs->combine_slots == 0)
+    {
+        memset(fs->combine_page, 0, FLASH_PAGE_DATA_SIZE);
+    }
+
+    /* Account for Object on Page
+     *  the first object on a page takes the hold released by flash_combine_flush, each
+     *  additional object adds a use that its delete will remove */
+    flash_blocks[fs->write_addr.block].pages_in_use++;
+
+    /* Copy into Combine Page */
+    uint8_t           *object_ptr       = &fs->combine_page[fs->combine_bytes];
+    flash_object_hdr_t flash_object_hdr = {
+        .synchi     = FLASH_OBJECT_SYNC_HI,
+        .synclo     = FLASH_OBJECT_SYNC_LO,
+        .object_hdr = {.handle = h,
+                       .size   = data1_size + data2_size,
+                       .sid    = (bp_sid_t)FLASH_GET_SID(fs->write_addr, fs->combine_slots)}};
+    memcpy(object_ptr, &flash_object_hdr, sizeof(flash_object_hdr_t));
+    if (data1)
+    {
+        memcpy(&object_ptr[sizeof(flash_object_hdr_t)], data1, data1_size);
+    }
+    if (data2)
+    {
+        memcpy(&object_ptr[sizeof(flash_object_hdr_t) + data1_size], data2, data2_size);
+    }
+
+    /* Update Combine Page */
+    fs->combine_bytes += FLASH_OBJECT_SPAN(data1_size + data2_size);
+    fs->combine_slots++;
+    fs->combine_live++;
+
+    /* Program Page Once Full */
+    if ((fs->combine_slots >= FLASH_MAX_OBJECTS_PER_PAGE) ||
+        ((fs->combine_bytes + sizeof(flash_object_hdr_t)) > (size_t)FLASH_PAGE_DATA_SIZE))
+    {
+        status = flash_combine_flush(fs);
+    }
+
+    return status;
+}
+
 /*--------------------------------------------------------------------------------------
  * flash_object_write -
  *-------------------------------------------------------------------------------------*/
@@ -443,34 +844,55 @@ BP_LOCAL_SCOPE int flash_object_write(flash_store_t *fs, bp_handle_t h, const ui
 {
     int status = BP_SUCCESS;
 
+    /* Snapshot Free Blocks - other stores may allocate before this write does */
+    int free_blocks;
+    bplib_os_lock(flash_alloc_lock);
+    free_blocks = flash_free_blocks.count + flash_erased_blocks.count + (flash_gc_block != BP_FLASH_INVALID_INDEX);
+    bplib_os_unlock(flash_alloc_lock);
+
     /* Check if Room Available */
-    uint64_t bytes_available = ((uint64_t)flash_free_blocks.count * (uint64_t)FLASH_DRIVER.pages_per_block *
+    uint64_t bytes_available = ((uint64_t)free_blocks * (uint64_t)FLASH_DRIVER.pages_per_block *
                                 (uint64_t)FLASH_PAGE_DATA_SIZE) + /* full blocks remaining */
                                (((uint64_t)FLASH_DRIVER.pages_per_block - fs->write_addr.page) *
-                                (uint64_t)FLASH_PAGE_DATA_SIZE); /* current block remaining */
+                                (uint64_t)FLASH_PAGE_DATA_SIZE) - /* current block remaining */
+                               (uint64_t)fs->combine_bytes;       /* used portion of combine page */
     int bytes_needed = sizeof(flash_object_hdr_t) + data1_size + data2_size;
     if (bytes_available >= (uint64_t)bytes_needed && fs->attributes.max_data_size >= bytes_needed)
     {
-        /* Calculate Object Information */
-        unsigned long      sid              = FLASH_GET_SID(fs->write_addr);
-        flash_object_hdr_t flash_object_hdr = {
-            .synchi     = FLASH_OBJECT_SYNC_HI,
-            .synclo     = FLASH_OBJECT_SYNC_LO,
-            .object_hdr = {.handle = h, .size = data1_size + data2_size, .sid = (bp_sid_t)sid}};
-
-        /* Copy into Write Stage */
-        memcpy(&fs->write_stage[0], &flash_object_hdr, sizeof(flash_object_hdr_t));
-        if (data1)
+        if ((fs->combine_page != NULL) && (bytes_needed <= FLASH_PAGE_DATA_SIZE))
         {
-            memcpy(&fs->write_stage[sizeof(flash_object_hdr_t)], data1, data1_size);
+            /* Pack Small Object into Shared Page */
+            status = flash_object_combine(fs, h, data1, data1_size, data2, data2_size);
         }
-        if (data2)
+        else
         {
-            memcpy(&fs->write_stage[sizeof(flash_object_hdr_t) + data1_size], data2, data2_size);
-        }
+            /* Large Objects Start on a Fresh Page */
+            status = flash_combine_flush(fs);
+            if (status == BP_SUCCESS)
+            {
+                /* Calculate Object Information */
+                unsigned long      sid              = FLASH_GET_SID(fs->write_addr, 0);
+                flash_object_hdr_t flash_object_hdr = {
+                    .synchi     = FLASH_OBJECT_SYNC_HI,
+                    .synclo     = FLASH_OBJECT_SYNC_LO,
+                    .object_hdr = {.handle = h, .size = data1_size + data2_size, .sid = (bp_sid_t)sid}};
+
+                /* Copy into Write Stage */
+                memcpy(&fs->write_stage[0], &flash_object_hdr, sizeof(flash_object_hdr_t));
+                if (data1)
+                {
+                    memcpy(&fs->write_stage[sizeof(flash_object_hdr_t)], data1, data1_size);
+                }
+                if (data2)
+                {
+                    memcpy(&fs->write_stage[sizeof(flash_object_hdr_t) + data1_size], data2, data2_size);
+                }
 
-        /* Write Data into Flash */
-        status = flash_data_write(&fs->write_addr, fs->write_stage, bytes_needed);
+                /* Write Data into Flash */
+                status = flash_data_write(fs->page_buffer, &fs->write_addr, fs->write_stage, bytes_needed);
+                fs->page_writes += (bytes_needed + FLASH_PAGE_DATA_SIZE - 1) / FLASH_PAGE_DATA_SIZE;
+            }
+        }
     }
     else
     {
@@ -484,10 +906,84 @@ BP_LOCAL_SCOPE int flash_object_write(flash_store_t *fs, bp_handle_t h, const ui
     return status;
 }
 
+/*--------------------------------------------------------------------------------------
+ * flash_sid_lookup - returns cache entry describing object, or NULL when not cached
+ *
+ *  SIDs step by FLASH_MAX_OBJECTS_PER_PAGE from page to page, so they are hashed
+ *  before being reduced to an entry, and an object may sit in any of the
+ *  FLASH_SID_PROBES entries that follow
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE flash_sid_entry_t *flash_sid_lookup(flash_store_t *fs, bp_sid_t sid)
+{
+#if FLASH_SID_CACHE_SIZE > 0
+    if (fs->sid_cache != NULL)
+    {
+        unsigned int index = FLASH_SID_INDEX(sid);
+        int          probe;
+        for (probe = 0; probe < FLASH_SID_PROBES; probe++)
+        {
+            flash_sid_entry_t *entry = &fs->sid_cache[(index + probe) % FLASH_SID_CACHE_SIZE];
+            if (entry->sid == sid)
+            {
+                return entry;
+            }
+        }
+    }
+#else
+    (void)fs;
+    (void)sid;
+#endif
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------
+ * flash_sid_insert - record object in cache, evicting an object when no entry is free
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void flash_sid_insert(flash_store_t *fs, bp_sid_t sid, int size, int offset)
+{
+#if FLASH_SID_CACHE_SIZE > 0
+    if (fs->sid_cache != NULL)
+    {
+        unsigned int       index = FLASH_SID_INDEX(sid);
+        flash_sid_entry_t *entry = flash_sid_lookup(fs, sid);
+        int                probe;
+
+        /* Take First Free Entry */
+        for (probe = 0; (entry == NULL) && (probe < FLASH_SID_PROBES); probe++)
+        {
+            flash_sid_entry_t *candidate = &fs->sid_cache[(index + probe) % FLASH_SID_CACHE_SIZE];
+            if (candidate->sid == BP_SID_VACANT)
+            {
+                entry = candidate;
+            }
+        }
+
+        /* Evict Object in Home Entry */
+        if (entry == NULL)
+        {
+            entry = &fs->sid_cache[index];
+        }
+
+        entry->sid    = sid;
+        entry->size   = size;
+        entry->offset = offset;
+    }
+#else
+    (void)fs;
+    (void)sid;
+    (void)size;
+    (void)offset;
+#endif
+}
+
 /*--------------------------------------------------------------------------------------
  * flash_object_read -
+ *
+ *  on success the address and slot are moved to the object following the one read
  *-------------------------------------------------------------------------------------*/
-BP_LOCAL_SCOPE int flash_object_read(flash_store_t *fs, bp_handle_t h, bp_flash_addr_t *addr, bp_object_t **object)
+BP_LOCAL_SCOPE int flash_object_read(flash_store_t *fs, bp_handle_t h, bp_flash_addr_t *addr, int *slot,
+                                     bp_object_t **object)
 {
     int status;
 
@@ -495,21 +991,53 @@ BP_LOCAL_SCOPE int flash_object_read(flash_store_t *fs, bp_handle_t h, bp_flash_
     if (fs->stage_locked == false)
     {
         flash_object_hdr_t *flash_object_hdr = (flash_object_hdr_t *)fs->read_stage;
+        bp_flash_addr_t     page_addr        = *addr;
+        int                 offset           = 0;
+        bool                pending          = (fs->combine_slots > 0) && FLASH_SAME_PAGE(page_addr, fs->write_addr);
+
+        /* Read Object Header - objects in the combine page have not been programmed yet */
+        if (pending)
+        {
+            memcpy(fs->read_stage, fs->combine_page, FLASH_PAGE_DATA_SIZE);
+            status = BP_SUCCESS;
+        }
+        else
+        {
+            status = flash_data_read(fs->page_buffer, &page_addr, fs->read_stage, FLASH_PAGE_DATA_SIZE);
+            fs->page_reads++;
+        }
+
+        /* Locate Object in Shared Page */
+        if ((status == BP_SUCCESS) && (*slot > 0))
+        {
+            flash_sid_entry_t *cached = flash_sid_lookup(fs, (bp_sid_t)FLASH_GET_SID(*addr, *slot));
+            offset                    = cached ? cached->offset : flash_page_locate(fs->read_stage, *slot);
+            if (offset == BP_ERROR)
+            {
+                status = bplog(NULL, BP_FLAG_STORE_FAILURE, "Object %d not found in page at %d.%d\n", *slot,
+                               FLASH_DRIVER.phyblk(addr->block), addr->page);
+            }
+            else
+            {
+                flash_object_hdr = (flash_object_hdr_t *)&fs->read_stage[offset];
+            }
+        }
 
-        /* Read Object Header from Flash */
-        status = flash_data_read(addr, fs->read_stage, FLASH_PAGE_DATA_SIZE);
         if (status == BP_SUCCESS)
         {
             if ((flash_object_hdr->object_hdr.size <= fs->attributes.max_data_size) &&
                 bp_handle_equal(flash_object_hdr->object_hdr.handle, h) &&
+                (flash_object_hdr->object_hdr.sid == (bp_sid_t)FLASH_GET_SID(*addr, *slot)) &&
                 (flash_object_hdr->synchi == FLASH_OBJECT_SYNC_HI) &&
                 (flash_object_hdr->synclo == FLASH_OBJECT_SYNC_LO))
             {
-                int bytes_read      = FLASH_PAGE_DATA_SIZE - sizeof(flash_object_hdr_t);
+                int bytes_read      = FLASH_PAGE_DATA_SIZE - sizeof(flash_object_hdr_t) - offset;
                 int remaining_bytes = flash_object_hdr->object_hdr.size - bytes_read;
                 if (remaining_bytes > 0)
                 {
-                    status = flash_data_read(addr, &fs->read_stage[FLASH_PAGE_DATA_SIZE], remaining_bytes);
+                    status = flash_data_read(fs->page_buffer, &page_addr, &fs->read_stage[FLASH_PAGE_DATA_SIZE],
+                                             remaining_bytes);
+                    fs->page_reads += (remaining_bytes + FLASH_PAGE_DATA_SIZE - 1) / FLASH_PAGE_DATA_SIZE;
                 }
             }
             else
@@ -526,6 +1054,33 @@ BP_LOCAL_SCOPE int flash_object_read(flash_store_t *fs, bp_handle_t h, bp_flash_
         /* Object Successfully Dequeued */
         if (status == BP_SUCCESS)
         {
+            size_t object_bytes = sizeof(flash_object_hdr_t) + flash_object_hdr->object_hdr.size;
+
+            /* Remember Object for Retrieve and Relinquish */
+            flash_sid_insert(fs, flash_object_hdr->object_hdr.sid, flash_object_hdr->object_hdr.size, offset);
+
+            /* Move to Next Object
+             *  objects that fit in a page were packed when the store combines writes, so
+             *  the next object is either further into this page or at the start of the next */
+            if ((fs->combine_page != NULL) && (object_bytes <= (size_t)FLASH_PAGE_DATA_SIZE) &&
+                (pending || ((*slot + 1) < FLASH_MAX_OBJECTS_PER_PAGE &&
+                             flash_page_locate(fs->read_stage, *slot + 1) != BP_ERROR)))
+            {
+                *slot += 1;
+            }
+            else
+            {
+                *addr = page_addr;
+                *slot = 0;
+            }
+
+            /* Shift Object to Front of Stage */
+            if (offset > 0)
+            {
+                memmove(fs->read_stage, flash_object_hdr, object_bytes);
+                flash_object_hdr = (flash_object_hdr_t *)fs->read_stage;
+            }
+
             /* Return Locked Object */
             *object          = (bp_object_t *)&flash_object_hdr->object_hdr;
             fs->stage_locked = true;
@@ -550,30 +1105,78 @@ BP_LOCAL_SCOPE int flash_object_delete(flash_store_t *fs, bp_sid_t sid)
 
     /* Get Address from SID */
     bp_flash_addr_t addr = {FLASH_GET_BLOCK((unsigned long)sid), FLASH_GET_PAGE((unsigned long)sid)};
+    int             slot = FLASH_GET_SLOT((unsigned long)sid);
     if (addr.block >= FLASH_DRIVER.num_blocks || addr.page >= FLASH_DRIVER.pages_per_block)
     {
         return bplog(NULL, BP_FLAG_STORE_FAILURE, "Invalid address provided to delete function: %d.%d\n",
                      FLASH_DRIVER.phyblk(addr.block), addr.page);
     }
 
-    /* Retrieve Object Header */
-    flash_object_hdr_t *flash_object_hdr = (flash_object_hdr_t *)flash_page_buffer;
-    flash_object_hdr->object_hdr.sid     = BP_SID_VACANT;
-    bp_flash_addr_t hdr_addr             = addr;
-    status = flash_data_read(&hdr_addr, (uint8_t *)flash_object_hdr, sizeof(flash_object_hdr_t));
-    if (status != BP_SUCCESS)
+    /* Object Still in Combine Page */
+    bool pending = (fs->combine_slots > 0) && FLASH_SAME_PAGE(addr, fs->write_addr);
+
+    /* Look Up Object Size - dequeued objects are cached so their header is not read back */
+    int                object_size;
+    flash_sid_entry_t *cached = flash_sid_lookup(fs, sid);
+    if (cached != NULL)
     {
-        return bplog(NULL, BP_FLAG_STORE_FAILURE, "Unable to read object header at %d.%d in delete function\n",
-                     FLASH_DRIVER.phyblk(addr.block), addr.page);
+        object_size = cached->size;
+        cached->sid = BP_SID_VACANT;
+    }
+    else
+    {
+        /* Retrieve Object Header */
+        uint8_t *page   = fs->page_buffer;
+        int      offset = 0;
+        if (pending)
+        {
+            page = fs->combine_page;
+        }
+        else
+        {
+            /* Read Whole Page When Object Shares It */
+            flash_object_hdr_t *first_hdr = (flash_object_hdr_t *)page;
+            bp_flash_addr_t     hdr_addr  = addr;
+            int                 hdr_bytes = (slot > 0) ? FLASH_PAGE_DATA_SIZE : (int)sizeof(flash_object_hdr_t);
+            first_hdr->object_hdr.sid     = BP_SID_VACANT;
+            status                        = flash_data_read(fs->page_buffer, &hdr_addr, page, hdr_bytes);
+            fs->page_reads++;
+            if (status != BP_SUCCESS)
+            {
+                return bplog(NULL, BP_FLAG_STORE_FAILURE, "Unable to read object header at %d.%d in delete function\n",
+                             FLASH_DRIVER.phyblk(addr.block), addr.page);
+            }
+        }
+
+        /* Locate Object in Shared Page */
+        if (slot > 0)
+        {
+            offset = flash_page_locate(page, slot);
+            if (offset == BP_ERROR)
+            {
+                return bplog(NULL, BP_FLAG_STORE_FAILURE, "Object %d not found in page at %d.%d in delete function\n",
+                             slot, FLASH_DRIVER.phyblk(addr.block), addr.page);
+            }
+        }
+
+        flash_object_hdr_t *flash_object_hdr = (flash_object_hdr_t *)&page[offset];
+        if (flash_object_hdr->object_hdr.sid != sid)
+        {
+            return bplog(NULL, BP_FLAG_STORE_FAILURE, "Attempting to delete object with invalid SID: %lu != %lu\n",
+                         (unsigned long)flash_object_hdr->object_hdr.sid, (unsigned long)sid);
+        }
+
+        object_size = flash_object_hdr->object_hdr.size;
     }
-    else if (flash_object_hdr->object_hdr.sid != sid)
+
+    /* Object No Longer Needs to be Programmed */
+    if (pending)
     {
-        return bplog(NULL, BP_FLAG_STORE_FAILURE, "Attempting to delete object with invalid SID: %lu != %lu\n",
-                     (unsigned long)flash_object_hdr->object_hdr.sid, (unsigned long)sid);
+        fs->combine_live--;
     }
 
-    /* Delete Each Page of Data */
-    bytes_left = flash_object_hdr->object_hdr.size;
+    /* Delete Each Page of Data (the header is counted since it shares the first page) */
+    bytes_left = sizeof(flash_object_hdr_t) + object_size;
     while (bytes_left > 0)
     {
         /* Set Current Block */
@@ -606,23 +1209,7 @@ BP_LOCAL_SCOPE int flash_object_delete(flash_store_t *fs, bp_sid_t sid)
         /* Check if Active Block can be Updated */
         if (current_block == fs->active_block)
         {
-            /* Check if Block can be Reclaimed */
-            while (fs->active_block != BP_FLASH_INVALID_INDEX && flash_blocks[fs->active_block].pages_in_use == 0)
-            {
-                /* Get Next Block */
-                bp_flash_index_t next_active_block = flash_blocks[fs->active_block].next_block;
-
-                /* Reclaim Block as Free */
-                status = flash_free_reclaim(fs->active_block);
-                if (status != BP_SUCCESS)
-                {
-                    bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to reclaim block %d as a free block\n", status,
-                          FLASH_DRIVER.phyblk(fs->active_block));
-                }
-
-                /* Update Active Block */
-                fs->active_block = next_active_block;
-            }
+            flash_active_reclaim(fs);
         }
     }
 
@@ -659,11 +1246,13 @@ int bplib_store_flash_init(bp_flash_driver_t driver, bool sw_edac)
     FLASH_ECC_CODE_SIZE  = 0;
 
     /* Default Variables  */
-    flash_device_lock      = BP_INVALID_HANDLE;
+    flash_alloc_lock       = BP_INVALID_HANDLE;
     flash_blocks           = NULL;
     flash_error_count      = 0;
     flash_used_block_count = 0;
-    flash_page_buffer      = NULL;
+    flash_gc_thread_handle = BP_INVALID_HANDLE;
+    flash_gc_running       = false;
+    flash_gc_block         = BP_FLASH_INVALID_INDEX;
 
     /* Zero Out Flash Stores */
     memset(flash_stores, 0, sizeof(flash_stores));
@@ -678,19 +1267,33 @@ int bplib_store_flash_init(bp_flash_driver_t driver, bool sw_edac)
     flash_fail_blocks.in    = BP_FLASH_INVALID_INDEX;
     flash_fail_blocks.count = 0;
 
+    /* Initialize Erased Blocks List */
+    flash_erased_blocks.out   = BP_FLASH_INVALID_INDEX;
+    flash_erased_blocks.in    = BP_FLASH_INVALID_INDEX;
+    flash_erased_blocks.count = 0;
+
     do
     {
-        /* Initialize Flash Device Lock */
-        flash_device_lock = bplib_os_createlock();
-        if (!bp_handle_is_valid(flash_device_lock))
+        /* Initialize Flash Allocator Lock */
+        flash_alloc_lock = bplib_os_createlock();
+        if (!bp_handle_is_valid(flash_alloc_lock))
         {
-            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed (%d) to create flash device lock\n", flash_device_lock);
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed (%d) to create flash allocator lock\n",
+                  bp_handle_printable(flash_alloc_lock));
             break; /* Skip rest of initialization */
         }
 
+        /* Initialize Store Locks */
+        int s;
+        for (s = 0; s < FLASH_MAX_STORES; s++)
+        {
+            bplib_os_mutex_init(&flash_stores[s].lock);
+        }
+
         /* Allocate Memory for Block Control */
         flash_blocks =
-            (flash_block_control_t *)bplib_os_calloc(sizeof(flash_block_control_t) * FLASH_DRIVER.num_blocks);
+            (flash_block_control_t *)bplib_os_calloc_tag(sizeof(flash_block_control_t) * FLASH_DRIVER.num_blocks,
+                                                         BP_MEM_FLASH);
         if (flash_blocks == NULL)
         {
             bplog(NULL, BP_FLAG_DIAGNOSTIC, "Unable to allocate memory for flash block control information\n");
@@ -710,14 +1313,6 @@ int bplib_store_flash_init(bp_flash_driver_t driver, bool sw_edac)
             }
         }
 
-        /* Allocate Page Buffer */
-        flash_page_buffer = (uint8_t *)bplib_os_calloc(FLASH_DRIVER.page_size);
-        if (!flash_page_buffer)
-        {
-            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Unable to allocate memory for flash page buffer\n");
-            break; /* Skip rest of initialization */
-        }
-
         /* Build Free Block List */
         unsigned int block;
         for (block = 0; block < FLASH_DRIVER.num_blocks; block++)
@@ -738,6 +1333,18 @@ int bplib_store_flash_init(bp_flash_driver_t driver, bool sw_edac)
 
         /* Zero Out Used Flash Blocks */
         flash_used_block_count = 0;
+
+        /* Start Background Erase - without it blocks are erased when allocated */
+        if (FLASH_GC_ERASED_BLOCKS > 0)
+        {
+            flash_gc_running       = true;
+            flash_gc_thread_handle = bplib_os_createthread(flash_gc_thread, NULL);
+            if (!bp_handle_is_valid(flash_gc_thread_handle))
+            {
+                flash_gc_running = false;
+                bplog(NULL, BP_FLAG_DIAGNOSTIC, "Unable to start flash erase thread, erasing on allocation\n");
+            }
+        }
     }
     while (false);
 
@@ -764,6 +1371,19 @@ void bplib_store_flash_uninit(void)
 {
     int s;
 
+    /* Stop Background Erase */
+    if (bp_handle_is_valid(flash_gc_thread_handle))
+    {
+        bplib_os_lock(flash_alloc_lock);
+        {
+            flash_gc_running = false;
+            bplib_os_broadcast(flash_alloc_lock);
+        }
+        bplib_os_unlock(flash_alloc_lock);
+        bplib_os_jointhread(flash_gc_thread_handle);
+        flash_gc_thread_handle = BP_INVALID_HANDLE;
+    }
+
     for (s = 0; s < FLASH_MAX_STORES; s++)
     {
         if (flash_stores[s].preserve || flash_stores[s].in_use)
@@ -772,12 +1392,14 @@ void bplib_store_flash_uninit(void)
             flash_stores[s].preserve = false;
             bplib_store_flash_destroy(bp_handle_from_serial(s, BPLIB_HANDLE_FLASH_STORE_BASE));
         }
+
+        bplib_os_mutex_destroy(&flash_stores[s].lock);
     }
 
-    if (bp_handle_is_valid(flash_device_lock))
+    if (bp_handle_is_valid(flash_alloc_lock))
     {
-        bplib_os_destroylock(flash_device_lock);
-        flash_device_lock = BP_INVALID_HANDLE;
+        bplib_os_destroylock(flash_alloc_lock);
+        flash_alloc_lock = BP_INVALID_HANDLE;
     }
 
     if (flash_blocks)
@@ -790,12 +1412,6 @@ void bplib_store_flash_uninit(void)
     {
         lrc_uninit();
     }
-
-    if (flash_page_buffer)
-    {
-        bplib_os_free(flash_page_buffer);
-        flash_page_buffer = NULL;
-    }
 }
 
 /*--------------------------------------------------------------------------------------
@@ -807,11 +1423,24 @@ void bplib_store_flash_reclaim_used_blocks(bp_ipn_t node, bp_ipn_t service)
 
     for (s = 0; s < FLASH_MAX_STORES; s++)
     {
-        if ((flash_stores[s].in_use == false) && (flash_stores[s].preserve == true) && (flash_stores[s].node == node) &&
-            (flash_stores[s].service == service))
+        bool reclaim = false;
+
+        /* Claim Preserved Store */
+        bplib_os_lock(flash_alloc_lock);
+        {
+            if ((flash_stores[s].in_use == false) && (flash_stores[s].preserve == true) &&
+                (flash_stores[s].node == node) && (flash_stores[s].service == service))
+            {
+                flash_stores[s].in_use   = true;
+                flash_stores[s].preserve = false;
+                reclaim                  = true;
+            }
+        }
+        bplib_os_unlock(flash_alloc_lock);
+
+        /* Destroy Outside of Allocator Lock */
+        if (reclaim)
         {
-            flash_stores[s].in_use   = true;
-            flash_stores[s].preserve = false;
             bplib_store_flash_destroy(bp_handle_from_serial(s, BPLIB_HANDLE_FLASH_STORE_BASE));
         }
     }
@@ -824,32 +1453,39 @@ void bplib_store_flash_restore_failed_blocks(void)
 {
     flash_block_list_t new_fail_blocks = {.out = BP_FLASH_INVALID_INDEX, .in = BP_FLASH_INVALID_INDEX, .count = 0};
 
-    /* Loop Through Failed Blocks */
-    int block = flash_fail_blocks.out;
-    while (block != BP_FLASH_INVALID_INDEX)
+    bplib_os_lock(flash_alloc_lock);
     {
-        bp_flash_index_t next_block = flash_blocks[block].next_block;
+        /* Loop Through Failed Blocks */
+        int block = flash_fail_blocks.out;
+        while (block != BP_FLASH_INVALID_INDEX)
+        {
+            bp_flash_index_t next_block = flash_blocks[block].next_block;
 
-        /* Clear Block Control Entry */
-        flash_blocks[block].next_block   = BP_FLASH_INVALID_INDEX;
-        flash_blocks[block].pages_in_use = FLASH_DRIVER.pages_per_block;
+            /* Clear Block Control Entry */
+            flash_blocks[block].next_block   = BP_FLASH_INVALID_INDEX;
+            flash_blocks[block].pages_in_use = FLASH_DRIVER.pages_per_block;
 
-        /* Add to Free or Failed List */
-        if (!FLASH_DRIVER.isbad(block))
-        {
-            flash_block_list_add(&flash_free_blocks, block);
-        }
-        else
-        {
-            flash_block_list_add(&new_fail_blocks, block);
+            /* Add to Free or Failed List */
+            if (!FLASH_DRIVER.isbad(block))
+            {
+                flash_block_list_add(&flash_free_blocks, block);
+            }
+            else
+            {
+                flash_block_list_add(&new_fail_blocks, block);
+            }
+
+            /* Go to Next Failed Block */
+            block = next_block;
         }
 
-        /* Go to Next Failed Block */
-        block = next_block;
-    }
+        /* Update Failed Blocks List */
+        flash_fail_blocks = new_fail_blocks;
 
-    /* Update Failed Blocks List */
-    flash_fail_blocks = new_fail_blocks;
+        /* Wake Background Erase */
+        bplib_os_broadcast(flash_alloc_lock);
+    }
+    bplib_os_unlock(flash_alloc_lock);
 }
 
 /*--------------------------------------------------------------------------------------
@@ -857,35 +1493,90 @@ void bplib_store_flash_restore_failed_blocks(void)
  *-------------------------------------------------------------------------------------*/
 void bplib_store_flash_stats(bp_flash_stats_t *stats, bool log_stats, bool reset_stats)
 {
-    /* Copy Stats */
-    if (stats)
+    bp_flash_stats_t local_stats;
+    int              s;
+
+    /* Sum Pages Written and Read by Each Store */
+    local_stats.page_writes = 0;
+    local_stats.page_reads  = 0;
+    for (s = 0; s < FLASH_MAX_STORES; s++)
     {
-        stats->num_free_blocks = flash_free_blocks.count;
-        stats->num_used_blocks = flash_used_block_count;
-        stats->num_fail_blocks = flash_fail_blocks.count;
-        stats->error_count     = flash_error_count;
+        bplib_os_mutex_lock(&flash_stores[s].lock);
+        {
+            local_stats.page_writes += flash_stores[s].page_writes;
+            local_stats.page_reads += flash_stores[s].page_reads;
+            if (reset_stats)
+            {
+                flash_stores[s].page_writes = 0;
+                flash_stores[s].page_reads  = 0;
+            }
+        }
+        bplib_os_mutex_unlock(&flash_stores[s].lock);
     }
 
-    /* Log Stats */
-    if (log_stats)
+    bplib_os_lock(flash_alloc_lock);
     {
-        bplog(NULL, BP_FLAG_STORE_FAILURE, "Number of free blocks: %d\n", flash_free_blocks.count);
-        bplog(NULL, BP_FLAG_STORE_FAILURE, "Number of used blocks: %d\n", flash_used_block_count);
-        bplog(NULL, BP_FLAG_STORE_FAILURE, "Number of failed blocks: %d\n", flash_fail_blocks.count);
-        bplog(NULL, BP_FLAG_STORE_FAILURE, "Number of flash errors: %d\n", flash_error_count);
+        /* Copy Stats */
+        local_stats.num_erased_blocks = flash_erased_blocks.count;
+        local_stats.num_free_blocks   = flash_free_blocks.count + flash_erased_blocks.count;
+        local_stats.num_used_blocks   = flash_used_block_count;
+        local_stats.num_fail_blocks   = flash_fail_blocks.count;
+        local_stats.error_count       = flash_error_count;
+
+        /* Find Wear Spread */
+        local_stats.min_erase_count = 0;
+        local_stats.max_erase_count = 0;
+        if (flash_blocks)
+        {
+            unsigned int block;
+            local_stats.min_erase_count = (int)flash_blocks[0].erase_count;
+            for (block = 0; block < FLASH_DRIVER.num_blocks; block++)
+            {
+                int erase_count = (int)flash_blocks[block].erase_count;
+                if (erase_count < local_stats.min_erase_count)
+                {
+                    local_stats.min_erase_count = erase_count;
+                }
+                if (erase_count > local_stats.max_erase_count)
+                {
+                    local_stats.max_erase_count = erase_count;
+                }
+            }
+        }
 
-        int block = flash_fail_blocks.out;
-        while (block != BP_FLASH_INVALID_INDEX)
+        /* Log Stats */
+        if (log_stats)
         {
-            bplog(NULL, BP_FLAG_STORE_FAILURE, "Block <%d> failed\n", FLASH_DRIVER.phyblk(block));
-            block = flash_blocks[block].next_block;
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Number of free blocks: %d\n", local_stats.num_free_blocks);
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Number of erased blocks: %d\n", local_stats.num_erased_blocks);
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Number of used blocks: %d\n", local_stats.num_used_blocks);
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Number of failed blocks: %d\n", local_stats.num_fail_blocks);
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Number of flash errors: %d\n", local_stats.error_count);
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Number of pages written: %d\n", local_stats.page_writes);
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Number of pages read: %d\n", local_stats.page_reads);
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Block erase counts: %d to %d\n", local_stats.min_erase_count,
+                  local_stats.max_erase_count);
+
+            int block = flash_fail_blocks.out;
+            while (block != BP_FLASH_INVALID_INDEX)
+            {
+                bplog(NULL, BP_FLAG_STORE_FAILURE, "Block <%d> failed\n", FLASH_DRIVER.phyblk(block));
+                block = flash_blocks[block].next_block;
+            }
+        }
+
+        /* Reset Stats */
+        if (reset_stats)
+        {
+            flash_error_count = 0;
         }
     }
+    bplib_os_unlock(flash_alloc_lock);
 
-    /* Reset Stats */
-    if (reset_stats)
+    /* Return Stats */
+    if (stats)
     {
-        flash_error_count = 0;
+        *stats = local_stats;
     }
 }
 
@@ -899,113 +1590,169 @@ bp_handle_t bplib_store_flash_create(int type, bp_ipn_t node, bp_ipn_t service,
     bp_handle_t      handle   = BP_INVALID_HANDLE;
     int              s;
 
-    if (recover)
+    bplib_os_lock(flash_alloc_lock);
     {
-        /* Search for Existing Store */
-        for (s = 0; s < FLASH_MAX_STORES; s++)
+        if (recover)
         {
-            if ((flash_stores[s].preserve == true) && (flash_stores[s].type == type) &&
-                (flash_stores[s].node == node) && (flash_stores[s].service == service))
+            /* Search for Existing Store */
+            for (s = 0; s < FLASH_MAX_STORES; s++)
             {
-                if (!flash_stores[s].in_use)
-                {
-                    /* Recover Bundles */
-                    bplog(NULL, BP_FLAG_DIAGNOSTIC, "Recovered %d %s from ipn:%d.%d in flash store\n",
-                          flash_stores[s].object_count, type2str(type), node, service);
-                    handle = bp_handle_from_serial(s, BPLIB_HANDLE_FLASH_STORE_BASE);
-                }
-                else
+                if ((flash_stores[s].preserve == true) && (flash_stores[s].type == type) &&
+                    (flash_stores[s].node == node) && (flash_stores[s].service == service))
                 {
-                    /* Node.Service Already In Use */
-                    bplog(NULL, BP_FLAG_DIAGNOSTIC, "Store of %s for ipn:%d.%d already in use!\n", type2str(type), node,
-                          service);
-                    in_error = true;
-                }
+                    if (!flash_stores[s].in_use)
+                    {
+                        /* Recover Bundles */
+                        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Recovered %d %s from ipn:%d.%d in flash store\n",
+                              flash_stores[s].object_count, type2str(type), node, service);
+                        handle = bp_handle_from_serial(s, BPLIB_HANDLE_FLASH_STORE_BASE);
+                    }
+                    else
+                    {
+                        /* Node.Service Already In Use */
+                        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Store of %s for ipn:%d.%d already in use!\n",
+                              type2str(type), node, service);
+                        in_error = true;
+                    }
 
-                break;
+                    break;
+                }
             }
         }
-    }
 
-    if ((!bp_handle_is_valid(handle)) && (in_error == false))
-    {
-        for (s = 0; s < FLASH_MAX_STORES; s++)
+        if ((!bp_handle_is_valid(handle)) && (in_error == false))
         {
-            if ((!flash_stores[s].in_use) && (!flash_stores[s].preserve))
+            for (s = 0; s < FLASH_MAX_STORES; s++)
             {
-                /* Initialize Attributes */
-                if (attr)
+                if ((!flash_stores[s].in_use) && (!flash_stores[s].preserve))
                 {
-                    /* Check User Provided Attributes */
-                    if (attr->max_data_size < FLASH_PAGE_DATA_SIZE)
+                    /* Initialize Attributes */
+                    if (attr)
+                    {
+                        /* Check User Provided Attributes */
+                        if (attr->max_data_size < FLASH_PAGE_DATA_SIZE)
+                        {
+                            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Invalid attributes - must supply sufficient sizes\n");
+                            break;
+                        }
+
+                        /* Check Block Use Count Can Hold Packed Objects */
+                        int max_block_uses = FLASH_DRIVER.pages_per_block * (FLASH_MAX_OBJECTS_PER_PAGE + 1);
+                        if (attr->write_combine && (max_block_uses >= BP_FLASH_INVALID_INDEX))
+                        {
+                            bplog(NULL, BP_FLAG_DIAGNOSTIC,
+                                  "Invalid attributes - too many pages per block to combine\n");
+                            break;
+                        }
+
+                        /* Copy User Provided Attributes */
+                        flash_stores[s].attributes = *attr;
+                    }
+                    else
                     {
-                        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Invalid attributes - must supply sufficient sizes\n");
-                        break;
+                        /* Use Default Attributes */
+                        flash_stores[s].attributes.max_data_size = FLASH_PAGE_DATA_SIZE;
+                        flash_stores[s].attributes.write_combine = false;
                     }
 
-                    /* Copy User Provided Attributes */
-                    flash_stores[s].attributes = *attr;
-                }
-                else
-                {
-                    /* Use Default Attributes */
-                    flash_stores[s].attributes.max_data_size = FLASH_PAGE_DATA_SIZE;
+                    /* Account for Object Header Overhead */
+                    flash_stores[s].attributes.max_data_size += sizeof(flash_object_hdr_t);
+
+                    /* Round Up to Next Full Page (to optimize driver operations on page boundaries) */
+                    int num_pages_in_stage = (flash_stores[s].attributes.max_data_size + FLASH_DRIVER.page_size - 1) /
+                                             FLASH_DRIVER.page_size;
+                    flash_stores[s].attributes.max_data_size = FLASH_DRIVER.page_size * num_pages_in_stage;
+
+                    /* Initialize Store Identifiers */
+                    flash_stores[s].type    = type;
+                    flash_stores[s].node    = node;
+                    flash_stores[s].service = service;
+
+                    /* Initialize Read/Write Pointers */
+                    flash_stores[s].write_addr.block = BP_FLASH_INVALID_INDEX;
+                    flash_stores[s].write_addr.page  = 0;
+                    flash_stores[s].read_addr.block  = BP_FLASH_INVALID_INDEX;
+                    flash_stores[s].read_addr.page   = 0;
+                    flash_stores[s].read_slot        = 0;
+                    flash_stores[s].active_block     = BP_FLASH_INVALID_INDEX;
+
+                    /* Initialize Combine Page */
+                    flash_stores[s].combine_slots = 0;
+                    flash_stores[s].combine_bytes = 0;
+                    flash_stores[s].combine_live  = 0;
+
+                    /* Set Counts to Zero */
+                    flash_stores[s].object_count   = 0;
+                    flash_stores[s].inactive_count = 0;
+
+                    /* Update Store Index and Break Out of Loop */
+                    handle = bp_handle_from_serial(s, BPLIB_HANDLE_FLASH_STORE_BASE);
+                    break;
                 }
-
-                /* Account for Object Header Overhead */
-                flash_stores[s].attributes.max_data_size += sizeof(flash_object_hdr_t);
-
-                /* Round Up to Next Full Page (to optimize driver operations on page boundaries) */
-                int num_pages_in_stage =
-                    (flash_stores[s].attributes.max_data_size + FLASH_DRIVER.page_size - 1) / FLASH_DRIVER.page_size;
-                flash_stores[s].attributes.max_data_size = FLASH_DRIVER.page_size * num_pages_in_stage;
-
-                /* Initialize Store Identifiers */
-                flash_stores[s].type    = type;
-                flash_stores[s].node    = node;
-                flash_stores[s].service = service;
-
-                /* Initialize Read/Write Pointers */
-                flash_stores[s].write_addr.block = BP_FLASH_INVALID_INDEX;
-                flash_stores[s].write_addr.page  = 0;
-                flash_stores[s].read_addr.block  = BP_FLASH_INVALID_INDEX;
-                flash_stores[s].read_addr.page   = 0;
-                flash_stores[s].active_block     = BP_FLASH_INVALID_INDEX;
-
-                /* Set Counts to Zero */
-                flash_stores[s].object_count   = 0;
-                flash_stores[s].inactive_count = 0;
-
-                /* Update Store Index and Break Out of Loop */
-                handle = bp_handle_from_serial(s, BPLIB_HANDLE_FLASH_STORE_BASE);
-                break;
             }
         }
+
+        /* Claim Store - stages are allocated outside of the allocator lock */
+        if (bp_handle_is_valid(handle))
+        {
+            flash_stores[s].in_use = true;
+        }
     }
+    bplib_os_unlock(flash_alloc_lock);
 
     /* Allocate Stage */
     if (bp_handle_is_valid(handle))
     {
         flash_stores[s].stage_locked = false;
-        flash_stores[s].write_stage  = (uint8_t *)bplib_os_calloc(flash_stores[s].attributes.max_data_size);
-        flash_stores[s].read_stage   = (uint8_t *)bplib_os_calloc(flash_stores[s].attributes.max_data_size);
-        if ((flash_stores[s].write_stage == NULL) || (flash_stores[s].read_stage == NULL))
+        flash_stores[s].write_stage  = (uint8_t *)bplib_os_calloc_tag(flash_stores[s].attributes.max_data_size,
+                                                                      BP_MEM_FLASH);
+        flash_stores[s].read_stage   = (uint8_t *)bplib_os_calloc_tag(flash_stores[s].attributes.max_data_size,
+                                                                      BP_MEM_FLASH);
+        flash_stores[s].page_buffer  = (uint8_t *)bplib_os_calloc_tag(FLASH_DRIVER.page_size, BP_MEM_FLASH);
+        flash_stores[s].combine_page = NULL;
+        if (flash_stores[s].attributes.write_combine)
+        {
+            /* Full Page so ECC can be Encoded in Place */
+            flash_stores[s].combine_page = (uint8_t *)bplib_os_calloc_tag(FLASH_DRIVER.page_size, BP_MEM_FLASH);
+        }
+        flash_stores[s].sid_cache = NULL;
+        if (FLASH_SID_CACHE_SIZE > 0)
+        {
+            /* Starts Empty - recovered objects are cached again as they are dequeued */
+            flash_stores[s].sid_cache = (flash_sid_entry_t *)bplib_os_calloc_tag(
+                sizeof(flash_sid_entry_t) * FLASH_SID_CACHE_SIZE, BP_MEM_FLASH);
+        }
+        if ((flash_stores[s].write_stage == NULL) || (flash_stores[s].read_stage == NULL) ||
+            (flash_stores[s].page_buffer == NULL) ||
+            (flash_stores[s].attributes.write_combine && (flash_stores[s].combine_page == NULL)) ||
+            ((FLASH_SID_CACHE_SIZE > 0) && (flash_stores[s].sid_cache == NULL)))
         {
             bplog(NULL, BP_FLAG_DIAGNOSTIC, "Unable to allocate data stages\n");
             if (flash_stores[s].write_stage)
                 bplib_os_free(flash_stores[s].write_stage);
             if (flash_stores[s].read_stage)
                 bplib_os_free(flash_stores[s].read_stage);
+            if (flash_stores[s].page_buffer)
+                bplib_os_free(flash_stores[s].page_buffer);
+            if (flash_stores[s].combine_page)
+                bplib_os_free(flash_stores[s].combine_page);
+            if (flash_stores[s].sid_cache)
+                bplib_os_free(flash_stores[s].sid_cache);
             handle = BP_INVALID_HANDLE;
+
+            /* Release Claim */
+            bplib_os_lock(flash_alloc_lock);
+            flash_stores[s].in_use = false;
+            bplib_os_unlock(flash_alloc_lock);
         }
     }
 
     /* Set Store Properties */
     if (bp_handle_is_valid(handle))
     {
-        s                        = bp_handle_to_serial(handle, BPLIB_HANDLE_FLASH_STORE_BASE);
-        flash_stores[s].in_use   = true;
+        bplib_os_lock(flash_alloc_lock);
         flash_stores[s].preserve = recover;
+        bplib_os_unlock(flash_alloc_lock);
     }
 
     return handle;
@@ -1021,66 +1768,107 @@ int bplib_store_flash_destroy(bp_handle_t h)
     assert(handle >= 0 && handle < FLASH_MAX_STORES);
     assert(flash_stores[handle].in_use);
 
-    /* If Preserving:
-     *  Reset Active Block to Read Address - this will cause any bundles that are
-     *  active to be lost.  Since this store doesn't keep track of individual free pages,
-     *  there is no way to reset the active address to the exact page (the active address
-     *  only keeps track of the block for this reason).
-     *
-     * If Not Preserving:
-     *  Reclaim all blocks from the active block all the way to the end.  This drains all
-     *  the blocks associated with this store from flash. */
-    while ((flash_stores[handle].active_block != BP_FLASH_INVALID_INDEX) &&
-           ((!flash_stores[handle].preserve) ||
-            (flash_stores[handle].active_block != flash_stores[handle].read_addr.block)))
+    bplib_os_mutex_lock(&flash_stores[handle].lock);
     {
-        /* Get Next Block */
-        bp_flash_index_t next_active_block = flash_blocks[flash_stores[handle].active_block].next_block;
+        /* Program Partially Filled Combine Page - only needed if its objects are preserved */
+        if (flash_stores[handle].preserve)
+        {
+            flash_combine_flush(&flash_stores[handle]);
+        }
+        else
+        {
+            flash_stores[handle].combine_slots = 0;
+            flash_stores[handle].combine_bytes = 0;
+            flash_stores[handle].combine_live  = 0;
+        }
 
-        /* Reclaim Block as Free */
-        int status = flash_free_reclaim(flash_stores[handle].active_block);
-        if (status != BP_SUCCESS)
+        /* If Preserving:
+         *  Reset Active Block to Read Address - this will cause any bundles that are
+         *  active to be lost.  Since this store doesn't keep track of individual free pages,
+         *  there is no way to reset the active address to the exact page (the active address
+         *  only keeps track of the block for this reason).
+         *
+         * If Not Preserving:
+         *  Reclaim all blocks from the active block all the way to the end.  This drains all
+         *  the blocks associated with this store from flash. */
+        while ((flash_stores[handle].active_block != BP_FLASH_INVALID_INDEX) &&
+               ((!flash_stores[handle].preserve) ||
+                (flash_stores[handle].active_block != flash_stores[handle].read_addr.block)))
         {
-            bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to reclaim block %d as a free block\n", status,
-                  FLASH_DRIVER.phyblk(flash_stores[handle].active_block));
+            /* Get Next Block */
+            bp_flash_index_t next_active_block = flash_blocks[flash_stores[handle].active_block].next_block;
+
+            /* Reclaim Block as Free */
+            int status = flash_free_reclaim(flash_stores[handle].active_block);
+            if (status != BP_SUCCESS)
+            {
+                bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to reclaim block %d as a free block\n", status,
+                      FLASH_DRIVER.phyblk(flash_stores[handle].active_block));
+            }
+
+            /* Update Active Block */
+            flash_stores[handle].active_block = next_active_block;
         }
 
-        /* Update Active Block */
-        flash_stores[handle].active_block = next_active_block;
-    }
+        /* Cleanup Write Stage */
+        if (flash_stores[handle].write_stage)
+        {
+            bplib_os_free(flash_stores[handle].write_stage);
+            flash_stores[handle].write_stage = NULL;
+        }
 
-    /* Cleanup Write Stage */
-    if (flash_stores[handle].write_stage)
-    {
-        bplib_os_free(flash_stores[handle].write_stage);
-        flash_stores[handle].write_stage = NULL;
-    }
+        /* Cleanup Read Stage */
+        if (flash_stores[handle].read_stage)
+        {
+            bplib_os_free(flash_stores[handle].read_stage);
+            flash_stores[handle].read_stage   = NULL;
+            flash_stores[handle].stage_locked = false;
+        }
 
-    /* Cleanup Read Stage */
-    if (flash_stores[handle].read_stage)
-    {
-        bplib_os_free(flash_stores[handle].read_stage);
-        flash_stores[handle].read_stage   = NULL;
-        flash_stores[handle].stage_locked = false;
-    }
+        /* Cleanup Page Buffer */
+        if (flash_stores[handle].page_buffer)
+        {
+            bplib_os_free(flash_stores[handle].page_buffer);
+            flash_stores[handle].page_buffer = NULL;
+        }
 
-    /* Generate Status Message */
-    if (!flash_stores[handle].preserve)
-    {
-        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Deleting %d unpreserved %s from ipn:%d.%d in flash store\n",
-              flash_stores[handle].object_count, type2str(flash_stores[handle].type), flash_stores[handle].node,
-              flash_stores[handle].service);
-    }
-    else
-    {
-        int active_bundles = flash_stores[handle].object_count - flash_stores[handle].inactive_count;
-        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Deleting %d abandoned %s from ipn:%d.%d in flash store\n", active_bundles,
-              type2str(flash_stores[handle].type), flash_stores[handle].node, flash_stores[handle].service);
+        /* Cleanup Combine Page */
+        if (flash_stores[handle].combine_page)
+        {
+            bplib_os_free(flash_stores[handle].combine_page);
+            flash_stores[handle].combine_page = NULL;
+        }
+
+        /* Cleanup SID Cache */
+        if (flash_stores[handle].sid_cache)
+        {
+            bplib_os_free(flash_stores[handle].sid_cache);
+            flash_stores[handle].sid_cache = NULL;
+        }
+
+        /* Generate Status Message */
+        if (!flash_stores[handle].preserve)
+        {
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Deleting %d unpreserved %s from ipn:%d.%d in flash store\n",
+                  flash_stores[handle].object_count, type2str(flash_stores[handle].type), flash_stores[handle].node,
+                  flash_stores[handle].service);
+        }
+        else
+        {
+            int active_bundles = flash_stores[handle].object_count - flash_stores[handle].inactive_count;
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Deleting %d abandoned %s from ipn:%d.%d in flash store\n", active_bundles,
+                  type2str(flash_stores[handle].type), flash_stores[handle].node, flash_stores[handle].service);
+        }
+
+        /* Inactive Objects are Left for Recovery */
+        flash_stores[handle].object_count = flash_stores[handle].inactive_count;
     }
+    bplib_os_mutex_unlock(&flash_stores[handle].lock);
 
-    /* Set Store Properties */
-    flash_stores[handle].object_count = flash_stores[handle].inactive_count;
-    flash_stores[handle].in_use       = false;
+    /* Release Store */
+    bplib_os_lock(flash_alloc_lock);
+    flash_stores[handle].in_use = false;
+    bplib_os_unlock(flash_alloc_lock);
 
     return BP_SUCCESS;
 }
@@ -1101,7 +1889,7 @@ int bplib_store_flash_enqueue(bp_handle_t h, const void *data1, size_t data1_siz
     flash_store_t *fs     = (flash_store_t *)&flash_stores[handle];
     int            status = BP_SUCCESS;
 
-    bplib_os_lock(flash_device_lock);
+    bplib_os_mutex_lock(&fs->lock);
     {
         /* Check if First Write Block Available */
         if (fs->write_addr.block == BP_FLASH_INVALID_INDEX)
@@ -1136,7 +1924,7 @@ int bplib_store_flash_enqueue(bp_handle_t h, const void *data1, size_t data1_siz
             }
         }
     }
-    bplib_os_unlock(flash_device_lock);
+    bplib_os_mutex_unlock(&fs->lock);
 
     /* Return Status */
     return status;
@@ -1158,12 +1946,12 @@ int bplib_store_flash_dequeue(bp_handle_t h, bp_object_t **object, int timeout)
     flash_store_t *fs     = (flash_store_t *)&flash_stores[handle];
     int            status = BP_SUCCESS;
 
-    bplib_os_lock(flash_device_lock);
+    bplib_os_mutex_lock(&fs->lock);
     {
         /* Check if Data Objects Available */
-        if ((fs->read_addr.block != fs->write_addr.block) || (fs->read_addr.page != fs->write_addr.page))
+        if (!FLASH_SAME_PAGE(fs->read_addr, fs->write_addr) || (fs->read_slot < fs->combine_slots))
         {
-            status = flash_object_read(fs, h, &fs->read_addr, object);
+            status = flash_object_read(fs, h, &fs->read_addr, &fs->read_slot, object);
             if (status == BP_SUCCESS)
             {
                 fs->inactive_count--;
@@ -1175,7 +1963,7 @@ int bplib_store_flash_dequeue(bp_handle_t h, bp_object_t **object, int timeout)
             status = BP_TIMEOUT;
         }
     }
-    bplib_os_unlock(flash_device_lock);
+    bplib_os_mutex_unlock(&fs->lock);
 
     /* Return Status */
     return status;
@@ -1197,12 +1985,13 @@ int bplib_store_flash_retrieve(bp_handle_t h, bp_sid_t sid, bp_object_t **object
     flash_store_t *fs     = (flash_store_t *)&flash_stores[handle];
     int            status = BP_SUCCESS;
 
-    bplib_os_lock(flash_device_lock);
+    bplib_os_mutex_lock(&fs->lock);
     {
         bp_flash_addr_t page_addr = {FLASH_GET_BLOCK((unsigned long)sid), FLASH_GET_PAGE((unsigned long)sid)};
-        status                    = flash_object_read(fs, h, &page_addr, object);
+        int             slot      = FLASH_GET_SLOT((unsigned long)sid);
+        status                    = flash_object_read(fs, h, &page_addr, &slot, object);
     }
-    bplib_os_unlock(flash_device_lock);
+    bplib_os_mutex_unlock(&fs->lock);
 
     /* Return Status */
     return status;
@@ -1255,7 +2044,7 @@ int bplib_store_flash_relinquish(bp_handle_t h, bp_sid_t sid)
     flash_store_t *fs     = (flash_store_t *)&flash_stores[handle];
     int            status = BP_SUCCESS;
 
-    bplib_os_lock(flash_device_lock);
+    bplib_os_mutex_lock(&fs->lock);
     {
         /* Delete Pages Containing Object */
         status = flash_object_delete(fs, sid);
@@ -1264,12 +2053,51 @@ int bplib_store_flash_relinquish(bp_handle_t h, bp_sid_t sid)
             fs->object_count--;
         }
     }
-    bplib_os_unlock(flash_device_lock);
+    bplib_os_mutex_unlock(&fs->lock);
 
     /* Return Status */
     return status;
 }
 
+/*--------------------------------------------------------------------------------------
+ * bplib_store_flash_relinquish_batch -
+ *
+ *  deletes each object under a single store lock, returns the first error code
+ *-------------------------------------------------------------------------------------*/
+int bplib_store_flash_relinquish_batch(bp_handle_t h, const bp_sid_t *sids, int count)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_FLASH_STORE_BASE);
+    int i;
+
+    assert(handle >= 0 && handle < FLASH_MAX_STORES);
+    assert(flash_stores[handle].in_use);
+    assert(sids);
+
+    flash_store_t *fs         = (flash_store_t *)&flash_stores[handle];
+    int            ret_status = BP_SUCCESS;
+
+    bplib_os_mutex_lock(&fs->lock);
+    {
+        for (i = 0; i < count; i++)
+        {
+            /* Delete Pages Containing Object */
+            int status = flash_object_delete(fs, sids[i]);
+            if (status == BP_SUCCESS)
+            {
+                fs->object_count--;
+            }
+            else if (ret_status == BP_SUCCESS)
+            {
+                ret_status = status;
+            }
+        }
+    }
+    bplib_os_mutex_unlock(&fs->lock);
+
+    /* Return Status */
+    return ret_status;
+}
+
 /*--------------------------------------------------------------------------------------
  * bplib_store_flash_getcount -
  *-------------------------------------------------------------------------------------*/
@@ -64,6 +64,62 @@ typedef struct
 flash_driver_device_t flash_driver_device;
 bool                  flash_sim_initialized = false;
 
+static bplib_os_mutex_t      flash_sim_lock = {0}; /* serializes device operations like a single flash die */
+static bp_flash_sim_config_t flash_sim_config;     /* timing and error injection, all zero for functional only */
+static bp_flash_sim_stats_t  flash_sim_stats;      /* operation counts and device busy time */
+static uint32_t              flash_sim_random_state = 1;
+
+/******************************************************************************
+ LOCAL FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * flash_sim_random - xorshift so injected errors repeat for a given seed
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE uint32_t flash_sim_random(void)
+{
+    flash_sim_random_state ^= flash_sim_random_state << 13;
+    flash_sim_random_state ^= flash_sim_random_state >> 17;
+    flash_sim_random_state ^= flash_sim_random_state << 5;
+    return flash_sim_random_state;
+}
+
+/*--------------------------------------------------------------------------------------
+ * flash_sim_inject - true one in interval times, never when interval is zero
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bool flash_sim_inject(uint32_t interval)
+{
+    return (interval > 0) && (flash_sim_random() % interval == 0);
+}
+
+/*--------------------------------------------------------------------------------------
+ * flash_sim_busy - account device time for an operation, device lock held
+ *
+ *  in real time the wait is a spin on the microsecond clock, as a driver polling the
+ *  device ready bit would do, since the operating system sleep is in whole seconds
+ *-------------------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void flash_sim_busy(int latency_us, int transfer_bytes)
+{
+    unsigned long busy_us = (unsigned long)latency_us;
+    if (flash_sim_config.bus_bytes_per_us > 0)
+    {
+        busy_us += (transfer_bytes + flash_sim_config.bus_bytes_per_us - 1) / flash_sim_config.bus_bytes_per_us;
+    }
+
+    flash_sim_stats.busy_us += busy_us;
+
+    if (!flash_sim_config.virtual_time && busy_us > 0)
+    {
+        unsigned long start_us, now_us;
+        bplib_os_monotime_us(&start_us);
+        do
+        {
+            bplib_os_monotime_us(&now_us);
+        }
+        while (now_us - start_us < busy_us);
+    }
+}
+
 /******************************************************************************
  EXPORTED FUNCTIONS
  ******************************************************************************/
@@ -77,6 +133,13 @@ int bplib_flash_sim_initialize(void)
     {
         flash_sim_initialized = true;
 
+        /* Default to Functional Only */
+        memset(&flash_sim_config, 0, sizeof(flash_sim_config));
+        memset(&flash_sim_stats, 0, sizeof(flash_sim_stats));
+        flash_sim_random_state = 1;
+
+        bplib_os_mutex_init(&flash_sim_lock);
+
         flash_driver_device.blocks =
             (flash_driver_block_t *)malloc(FLASH_SIM_NUM_BLOCKS * sizeof(flash_driver_block_t));
 
@@ -138,6 +201,8 @@ int bplib_flash_sim_uninitialize(void)
             free(flash_driver_device.blocks[b].pages);
         }
         free(flash_driver_device.blocks);
+
+        bplib_os_mutex_destroy(&flash_sim_lock);
     }
 
     return BP_SUCCESS;
@@ -148,7 +213,22 @@ int bplib_flash_sim_uninitialize(void)
  *-------------------------------------------------------------------------------------*/
 int bplib_flash_sim_page_read(bp_flash_addr_t addr, void *page_data)
 {
-    memcpy(page_data, flash_driver_device.blocks[addr.block].pages[addr.page].data, FLASH_SIM_PAGE_SIZE);
+    bplib_os_mutex_lock(&flash_sim_lock);
+    {
+        memcpy(page_data, flash_driver_device.blocks[addr.block].pages[addr.page].data, FLASH_SIM_PAGE_SIZE);
+        flash_sim_busy(flash_sim_config.read_latency_us, FLASH_SIM_PAGE_SIZE);
+        flash_sim_stats.reads++;
+
+        /* Inject Bit Error - only into the data read, the page itself is left intact */
+        if (flash_sim_inject(flash_sim_config.bit_error_interval))
+        {
+            uint32_t bit = flash_sim_random() % (FLASH_SIM_PAGE_SIZE * 8);
+            ((uint8_t *)page_data)[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+            flash_sim_stats.bit_errors++;
+        }
+    }
+    bplib_os_mutex_unlock(&flash_sim_lock);
+
     return BP_SUCCESS;
 }
 
@@ -157,13 +237,30 @@ int bplib_flash_sim_page_read(bp_flash_addr_t addr, void *page_data)
  *-------------------------------------------------------------------------------------*/
 int bplib_flash_sim_page_write(bp_flash_addr_t addr, void *page_data)
 {
-    int      i;
-    uint8_t *byte_ptr = (uint8_t *)page_data;
-    for (i = 0; i < FLASH_SIM_PAGE_SIZE; i++)
+    int status = BP_SUCCESS;
+
+    bplib_os_mutex_lock(&flash_sim_lock);
     {
-        flash_driver_device.blocks[addr.block].pages[addr.page].data[i] &= byte_ptr[i];
+        int      i;
+        uint8_t *byte_ptr = (uint8_t *)page_data;
+        for (i = 0; i < FLASH_SIM_PAGE_SIZE; i++)
+        {
+            flash_driver_device.blocks[addr.block].pages[addr.page].data[i] &= byte_ptr[i];
+        }
+        flash_sim_busy(flash_sim_config.program_latency_us, FLASH_SIM_PAGE_SIZE);
+        flash_sim_stats.programs++;
+
+        /* Inject Program Failure */
+        if (flash_sim_inject(flash_sim_config.program_fail_interval))
+        {
+            flash_driver_device.blocks[addr.block].pages[0].spare[0] = FLASH_SIM_BAD_BLOCK_MARK;
+            flash_sim_stats.failures++;
+            status = BP_ERROR;
+        }
     }
-    return BP_SUCCESS;
+    bplib_os_mutex_unlock(&flash_sim_lock);
+
+    return status;
 }
 
 /*--------------------------------------------------------------------------------------
@@ -171,15 +268,30 @@ int bplib_flash_sim_page_write(bp_flash_addr_t addr, void *page_data)
  *-------------------------------------------------------------------------------------*/
 int bplib_flash_sim_block_erase(bp_flash_index_t block)
 {
-    int p;
+    int status = BP_SUCCESS;
 
-    for (p = 0; p < FLASH_SIM_PAGES_PER_BLOCK; p++)
+    bplib_os_mutex_lock(&flash_sim_lock);
     {
-        memset(flash_driver_device.blocks[block].pages[p].data, 0xFF, FLASH_SIM_PAGE_SIZE);
-        memset(flash_driver_device.blocks[block].pages[p].spare, 0xFF, FLASH_SIM_SPARE_SIZE);
+        int p;
+        for (p = 0; p < FLASH_SIM_PAGES_PER_BLOCK; p++)
+        {
+            memset(flash_driver_device.blocks[block].pages[p].data, 0xFF, FLASH_SIM_PAGE_SIZE);
+            memset(flash_driver_device.blocks[block].pages[p].spare, 0xFF, FLASH_SIM_SPARE_SIZE);
+        }
+        flash_sim_busy(flash_sim_config.erase_latency_us, 0);
+        flash_sim_stats.erases++;
+
+        /* Inject Erase Failure */
+        if (flash_sim_inject(flash_sim_config.erase_fail_interval))
+        {
+            flash_driver_device.blocks[block].pages[0].spare[0] = FLASH_SIM_BAD_BLOCK_MARK;
+            flash_sim_stats.failures++;
+            status = BP_ERROR;
+        }
     }
+    bplib_os_mutex_unlock(&flash_sim_lock);
 
-    return BP_SUCCESS;
+    return status;
 }
 
 /*--------------------------------------------------------------------------------------
@@ -206,3 +318,71 @@ int bplib_flash_sim_block_mark_bad(bp_flash_index_t block)
     flash_driver_device.blocks[block].pages[0].spare[0] = FLASH_SIM_BAD_BLOCK_MARK;
     return BP_SUCCESS;
 }
+
+/*--------------------------------------------------------------------------------------
+ * bplib_flash_sim_configure - set timing and error injection
+ *
+ *  factory bad blocks are marked here, so this is called before bplib_store_flash_init
+ *  for them to be kept off the free list; the operation statistics are reset
+ *-------------------------------------------------------------------------------------*/
+int bplib_flash_sim_configure(const bp_flash_sim_config_t *config)
+{
+    if (flash_sim_initialized == false || config == NULL)
+    {
+        return BP_ERROR;
+    }
+    else if (config->read_latency_us < 0 || config->program_latency_us < 0 || config->erase_latency_us < 0 ||
+             config->bus_bytes_per_us < 0 || config->bad_blocks < 0 || config->bad_blocks >= FLASH_SIM_NUM_BLOCKS)
+    {
+        return BP_ERROR;
+    }
+
+    bplib_os_mutex_lock(&flash_sim_lock);
+    {
+        flash_sim_config       = *config;
+        flash_sim_random_state = (config->seed != 0) ? config->seed : 1;
+        memset(&flash_sim_stats, 0, sizeof(flash_sim_stats));
+
+        /* Mark Factory Bad Blocks */
+        int marked = 0;
+        while (marked < config->bad_blocks)
+        {
+            uint32_t block = flash_sim_random() % FLASH_SIM_NUM_BLOCKS;
+            if (flash_driver_device.blocks[block].pages[0].spare[0] != FLASH_SIM_BAD_BLOCK_MARK)
+            {
+                flash_driver_device.blocks[block].pages[0].spare[0] = FLASH_SIM_BAD_BLOCK_MARK;
+                marked++;
+            }
+        }
+    }
+    bplib_os_mutex_unlock(&flash_sim_lock);
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * bplib_flash_sim_stats -
+ *-------------------------------------------------------------------------------------*/
+int bplib_flash_sim_stats(bp_flash_sim_stats_t *stats, bool reset_stats)
+{
+    if (flash_sim_initialized == false)
+    {
+        return BP_ERROR;
+    }
+
+    bplib_os_mutex_lock(&flash_sim_lock);
+    {
+        if (stats)
+        {
+            *stats = flash_sim_stats;
+        }
+
+        if (reset_stats)
+        {
+            memset(&flash_sim_stats, 0, sizeof(flash_sim_stats));
+        }
+    }
+    bplib_os_mutex_unlock(&flash_sim_lock);
+
+    return BP_SUCCESS;
+}
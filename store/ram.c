@@ -44,6 +44,7 @@
 #define MSGQ_SIZE_INFINITY  0
 #define MSGQ_STORE_STR      "bplibq"
 #define MSGQ_STORE_STR_SIZE 32
+#define MSGQ_SLOT_NODE_SIZE ((sizeof(queue_node_t) + 15) & ~(size_t)15) /* keeps object in slot aligned */
 
 /* Configurable Options */
 
@@ -79,8 +80,19 @@ typedef struct queue_def_t
     unsigned int  depth; /* maximum length of linked list */
     unsigned int  len;   /* current length of linked list (lazy deallocation means this includes non-active items) */
     unsigned int  max_data_size; /* largest item that can be queued */
+    bool          slab_nodes;    /* nodes are part of slab slots and are not freed */
 } queue_t;
 
+/* slab_t */
+typedef struct
+{
+    uint8_t      *memory;     /* preallocated slots, each a queue node followed by an object */
+    size_t        slot_size;  /* size of each slot in bytes */
+    size_t        max_object; /* largest object data size that fits in a slot */
+    int           num_slots;  /* number of slots */
+    queue_node_t *free_slots; /* list of unused slots */
+} slab_t;
+
 /* message_queue_t */
 typedef struct
 {
@@ -88,6 +100,7 @@ typedef struct
     bp_handle_t ready; /* handle for mutex/conditional */
     int         state; /* state of queue */
     int         count; /* number of items in queue */
+    slab_t      slab;  /* preallocated objects (memory is NULL when allocating from heap) */
 } message_queue_t;
 
 /* message queue handle */
@@ -110,6 +123,14 @@ BP_LOCAL_SCOPE void flush_queue(queue_t *q)
 {
     queue_node_t *temp;
 
+    /* Slab Memory is Freed as a Whole */
+    if (q->slab_nodes)
+    {
+        q->front = NULL;
+        q->rear  = NULL;
+        return;
+    }
+
     while (q->front)
     {
         temp = q->front->next;
@@ -138,7 +159,7 @@ BP_LOCAL_SCOPE int isempty(queue_t *q)
 /*----------------------------------------------------------------------------
  * Function:        enqueue
  *----------------------------------------------------------------------------*/
-BP_LOCAL_SCOPE int enqueue(queue_t *q, void *data, int size)
+BP_LOCAL_SCOPE int enqueue(queue_t *q, queue_node_t *node, void *data, int size)
 {
     /* check if queue is full */
     if ((q->depth != MSGQ_DEPTH_INFINITY) && (q->len >= q->depth))
@@ -152,11 +173,15 @@ BP_LOCAL_SCOPE int enqueue(queue_t *q, void *data, int size)
         return MSGQ_ERROR;
     }
 
-    /* create temp node */
-    queue_node_t *temp = (queue_node_t *)bplib_os_calloc((int)sizeof(queue_node_t));
+    /* create temp node (unless provided by slab) */
+    queue_node_t *temp = node;
     if (!temp)
     {
-        return MSGQ_MEMORY_ERROR;
+        temp = (queue_node_t *)bplib_os_calloc_tag((int)sizeof(queue_node_t), BP_MEM_RAM);
+        if (!temp)
+        {
+            return MSGQ_MEMORY_ERROR;
+        }
     }
 
     /* construct node to be added */
@@ -207,7 +232,10 @@ BP_LOCAL_SCOPE void *dequeue(queue_t *q, int *size)
         {
             q->front = q->front->next;
         }
-        bplib_os_free(tmp);
+        if (!q->slab_nodes)
+        {
+            bplib_os_free(tmp);
+        }
 
         q->len--;
     }
@@ -235,8 +263,10 @@ BP_LOCAL_SCOPE void *dequeue(queue_t *q, int *size)
  *           allowed to be queued up.  If the depth is zero, the queue
  *           is allowed to infinitely grow until all the memory in the
  *           system is consumed.
+ *        3. A non-zero slab count preallocates that many objects of slab
+ *           size bytes so that no allocations occur after creation.
  *----------------------------------------------------------------------------*/
-BP_LOCAL_SCOPE msgq_t msgq_create(int depth, int data_size)
+BP_LOCAL_SCOPE msgq_t msgq_create(int depth, int data_size, int slab_count, int slab_size)
 {
     message_queue_t *msgQ;
     bp_handle_t      ready_lock;
@@ -250,13 +280,47 @@ BP_LOCAL_SCOPE msgq_t msgq_create(int depth, int data_size)
     }
 
     /* Allocate MSG Q */
-    msgQ = (message_queue_t *)bplib_os_calloc(sizeof(message_queue_t));
+    msgQ = (message_queue_t *)bplib_os_calloc_tag(sizeof(message_queue_t), BP_MEM_RAM);
     if (msgQ == NULL)
     {
         printf("ERROR, Unable to allocate message queue\n");
+        bplib_os_destroylock(ready_lock);
         return MSGQ_INVALID_HANDLE;
     }
 
+    /* Allocate Slab */
+    if (slab_count > 0)
+    {
+        int i;
+
+        msgQ->slab.max_object = ((size_t)slab_size + 15) & ~(size_t)15;
+        msgQ->slab.slot_size  = MSGQ_SLOT_NODE_SIZE + sizeof(bp_object_hdr_t) + msgQ->slab.max_object;
+        msgQ->slab.num_slots  = slab_count;
+        msgQ->slab.memory     = (uint8_t *)bplib_os_calloc_tag(msgQ->slab.slot_size * slab_count, BP_MEM_RAM);
+        if (msgQ->slab.memory == NULL)
+        {
+            printf("ERROR, Unable to allocate %d slab objects of %d bytes\n", slab_count, slab_size);
+            bplib_os_destroylock(ready_lock);
+            bplib_os_free(msgQ);
+            return MSGQ_INVALID_HANDLE;
+        }
+
+        /* Build Free List */
+        msgQ->slab.free_slots = NULL;
+        for (i = slab_count - 1; i >= 0; i--)
+        {
+            queue_node_t *slot    = (queue_node_t *)&msgQ->slab.memory[msgQ->slab.slot_size * i];
+            slot->next            = msgQ->slab.free_slots;
+            msgQ->slab.free_slots = slot;
+        }
+
+        /* Queue Can Never Hold More Than the Slab */
+        if (depth == MSGQ_DEPTH_INFINITY || depth > slab_count)
+        {
+            depth = slab_count;
+        }
+    }
+
     /* Initialize MSG Q */
     msgQ->state               = MSGQ_OKAY;
     msgQ->queue.front         = NULL;
@@ -264,6 +328,7 @@ BP_LOCAL_SCOPE msgq_t msgq_create(int depth, int data_size)
     msgQ->queue.depth         = depth;
     msgQ->queue.len           = 0;
     msgQ->queue.max_data_size = data_size;
+    msgQ->queue.slab_nodes    = (msgQ->slab.memory != NULL);
     msgQ->ready               = ready_lock;
 
     /* Return MSG Q */
@@ -283,6 +348,10 @@ BP_LOCAL_SCOPE void msgq_delete(msgq_t queue_handle)
     {
         flush_queue(&msgQ->queue);
         bplib_os_destroylock(msgQ->ready);
+        if (msgQ->slab.memory)
+        {
+            bplib_os_free(msgQ->slab.memory);
+        }
         bplib_os_free(msgQ);
     }
 }
@@ -300,10 +369,17 @@ BP_LOCAL_SCOPE int msgq_post(msgq_t queue_handle, void *data, int size)
         return MSGQ_ERROR;
     }
 
+    /* Slab Objects Carry Their Own Node */
+    queue_node_t *node = NULL;
+    if (msgQ->slab.memory)
+    {
+        node = (queue_node_t *)((uint8_t *)data - MSGQ_SLOT_NODE_SIZE);
+    }
+
     /* Post Data */
     bplib_os_lock(msgQ->ready);
     {
-        post_state  = enqueue(&msgQ->queue, data, size);
+        post_state  = enqueue(&msgQ->queue, node, data, size);
         msgQ->state = post_state;
     }
     bplib_os_unlock(msgQ->ready);
@@ -319,47 +395,119 @@ BP_LOCAL_SCOPE int msgq_post(msgq_t queue_handle, void *data, int size)
 }
 
 /*----------------------------------------------------------------------------
- * Function:        msgq_receive
+ * Function:        msgq_wait
  *
- * Notes:           returns a pointer to the data and the size of the data by
- *                  populating the size parameter passed in by pointer
+ * Notes:           waits for a message to be posted, must be called with the
+ *                  queue locked
  *----------------------------------------------------------------------------*/
-BP_LOCAL_SCOPE int msgq_receive(msgq_t queue_handle, void **data, int *size, int block)
+BP_LOCAL_SCOPE int msgq_wait(message_queue_t *msgQ, int block)
 {
+    int recv_state = MSGQ_OKAY;
+
+    /* Wait for a message to be posted */
+    if (block == BP_PEND)
+    {
+        while (isempty(&msgQ->queue))
+        {
+            bplib_os_waiton(msgQ->ready, BP_PEND);
+        }
+    }
+    else if (block != BP_CHECK)
+    {
+        /* Timed Wait - until a deadline so wakeups that find the queue empty do not extend it */
+        unsigned long deadline = 0;
+        bplib_os_monotime_us(&deadline);
+        deadline += (unsigned long)block * 1000;
+        while (isempty(&msgQ->queue))
+        {
+            int wait_status = bplib_os_waituntil(msgQ->ready, deadline);
+            if (wait_status == BP_TIMEOUT)
+            {
+                recv_state = MSGQ_TIMEOUT;
+                break;
+            }
+            else if (wait_status == BP_ERROR)
+            {
+                recv_state = MSGQ_ERROR;
+                break;
+            }
+        }
+    }
+
+    return recv_state;
+}
+
+/*----------------------------------------------------------------------------
+ * Function:        msgq_post_batch
+ *
+ * Notes:           posts objects in order under a single lock, stopping at
+ *                  the first failure; returns the number of objects posted and
+ *                  the state of the last post in the post state parameter
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int msgq_post_batch(msgq_t queue_handle, bp_object_t **objects, int count, int *post_state)
+{
+    int posted = 0;
+
     message_queue_t *msgQ = (message_queue_t *)queue_handle;
     if (msgQ == NULL)
     {
-        return MSGQ_ERROR;
+        *post_state = MSGQ_ERROR;
+        return 0;
     }
 
-    int recv_state = MSGQ_OKAY;
-
+    /* Post Data */
+    *post_state = MSGQ_OKAY;
     bplib_os_lock(msgQ->ready);
     {
-        /* Wait for a message to be posted */
-        if (block == BP_PEND)
+        while (posted < count && *post_state == MSGQ_OKAY)
         {
-            while (isempty(&msgQ->queue))
+            /* Slab Objects Carry Their Own Node */
+            bp_object_t  *object = objects[posted];
+            queue_node_t *node   = NULL;
+            if (msgQ->slab.memory)
             {
-                bplib_os_waiton(msgQ->ready, BP_PEND);
+                node = (queue_node_t *)((uint8_t *)object - MSGQ_SLOT_NODE_SIZE);
             }
-        }
-        else if (block != BP_CHECK)
-        {
-            /* Timed Wait */
-            if (isempty(&msgQ->queue))
+
+            *post_state = enqueue(&msgQ->queue, node, object, sizeof(bp_object_hdr_t) + object->header.size);
+            if (*post_state == MSGQ_OKAY)
             {
-                int wait_status = bplib_os_waiton(msgQ->ready, block);
-                if (wait_status == BP_TIMEOUT)
-                {
-                    recv_state = MSGQ_TIMEOUT;
-                }
-                else if (wait_status == BP_ERROR)
-                {
-                    recv_state = MSGQ_ERROR;
-                }
+                posted++;
             }
         }
+        msgQ->state = *post_state;
+    }
+    bplib_os_unlock(msgQ->ready);
+
+    /* Trigger if Ready */
+    if (posted > 0)
+    {
+        bplib_os_signal(msgQ->ready);
+    }
+
+    /* Return Number Posted */
+    return posted;
+}
+
+/*----------------------------------------------------------------------------
+ * Function:        msgq_receive
+ *
+ * Notes:           returns a pointer to the data and the size of the data by
+ *                  populating the size parameter passed in by pointer
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int msgq_receive(msgq_t queue_handle, void **data, int *size, int block)
+{
+    message_queue_t *msgQ = (message_queue_t *)queue_handle;
+    if (msgQ == NULL)
+    {
+        return MSGQ_ERROR;
+    }
+
+    int recv_state;
+
+    bplib_os_lock(msgQ->ready);
+    {
+        recv_state = msgq_wait(msgQ, block);
 
         /* Get data from queue */
         msgQ->state = recv_state;
@@ -378,6 +526,145 @@ BP_LOCAL_SCOPE int msgq_receive(msgq_t queue_handle, void **data, int *size, int
     return recv_state;
 }
 
+/*----------------------------------------------------------------------------
+ * Function:        msgq_receive_batch
+ *
+ * Notes:           waits for the first message only and then removes up to
+ *                  max messages under a single lock; returns the number of
+ *                  messages received, or the receive state when none are
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int msgq_receive_batch(msgq_t queue_handle, void **data, int max, int block)
+{
+    message_queue_t *msgQ = (message_queue_t *)queue_handle;
+    if (msgQ == NULL)
+    {
+        return MSGQ_ERROR;
+    }
+
+    int recv_state;
+    int received = 0;
+
+    bplib_os_lock(msgQ->ready);
+    {
+        recv_state = msgq_wait(msgQ, block);
+
+        /* Get data from queue */
+        msgQ->state = recv_state;
+        if (msgQ->state == MSGQ_OKAY)
+        {
+            while (received < max && (data[received] = dequeue(&msgQ->queue, NULL)) != NULL)
+            {
+                received++;
+            }
+
+            if (received == 0)
+            {
+                recv_state = MSGQ_UNDERFLOW;
+            }
+        }
+    }
+    bplib_os_unlock(msgQ->ready);
+
+    /* Return Number Received or Status */
+    return received > 0 ? received : recv_state;
+}
+
+/*----------------------------------------------------------------------------
+ * Function:        msgq_alloc
+ *
+ * Notes:           returns an object from the slab, or from the heap when the
+ *                  queue does not have a slab
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bp_object_t *msgq_alloc(msgq_t queue_handle, size_t size)
+{
+    message_queue_t *msgQ   = (message_queue_t *)queue_handle;
+    bp_object_t     *object = NULL;
+
+    if (msgQ->slab.memory == NULL)
+    {
+        object = (bp_object_t *)bplib_os_calloc_tag(sizeof(bp_object_hdr_t) + size, BP_MEM_RAM);
+    }
+    else if (size <= msgQ->slab.max_object)
+    {
+        queue_node_t *slot = NULL;
+
+        bplib_os_lock(msgQ->ready);
+        {
+            slot = msgQ->slab.free_slots;
+            if (slot)
+            {
+                msgQ->slab.free_slots = slot->next;
+            }
+        }
+        bplib_os_unlock(msgQ->ready);
+
+        if (slot)
+        {
+            object = (bp_object_t *)((uint8_t *)slot + MSGQ_SLOT_NODE_SIZE);
+        }
+    }
+
+    return object;
+}
+
+/*----------------------------------------------------------------------------
+ * Function:        msgq_free
+ *
+ * Notes:           returns an object to the slab it came from or to the heap
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void msgq_free(msgq_t queue_handle, bp_object_t *object)
+{
+    message_queue_t *msgQ = (message_queue_t *)queue_handle;
+
+    if (msgQ->slab.memory == NULL)
+    {
+        bplib_os_free(object);
+    }
+    else
+    {
+        queue_node_t *slot = (queue_node_t *)((uint8_t *)object - MSGQ_SLOT_NODE_SIZE);
+
+        bplib_os_lock(msgQ->ready);
+        {
+            slot->next            = msgQ->slab.free_slots;
+            msgQ->slab.free_slots = slot;
+        }
+        bplib_os_unlock(msgQ->ready);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * Function:        msgq_free_batch
+ *
+ * Notes:           returns objects to the slab under a single lock, or to the heap
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void msgq_free_batch(msgq_t queue_handle, bp_object_t **objects, int count)
+{
+    message_queue_t *msgQ = (message_queue_t *)queue_handle;
+    int              i;
+
+    if (msgQ->slab.memory == NULL)
+    {
+        for (i = 0; i < count; i++)
+        {
+            bplib_os_free(objects[i]);
+        }
+    }
+    else
+    {
+        bplib_os_lock(msgQ->ready);
+        {
+            for (i = 0; i < count; i++)
+            {
+                queue_node_t *slot    = (queue_node_t *)((uint8_t *)objects[i] - MSGQ_SLOT_NODE_SIZE);
+                slot->next            = msgQ->slab.free_slots;
+                msgQ->slab.free_slots = slot;
+            }
+        }
+        bplib_os_unlock(msgQ->ready);
+    }
+}
+
 /******************************************************************************
  * EXPORTED FUNCTIONS
  ******************************************************************************/
@@ -399,10 +686,10 @@ bp_handle_t bplib_store_ram_create(int type, bp_ipn_t node, bp_ipn_t service, bo
     (void)node;
     (void)service;
     (void)recover;
-    (void)parm;
 
-    bp_handle_t slot;
-    int         i;
+    bp_ram_attr_t *attr = (bp_ram_attr_t *)parm;
+    bp_handle_t    slot;
+    int            i;
 
     /* Look for Empty Slots */
     slot = BP_INVALID_HANDLE;
@@ -410,7 +697,8 @@ bp_handle_t bplib_store_ram_create(int type, bp_ipn_t node, bp_ipn_t service, bo
     {
         if (msgq_stores[i] == MSGQ_INVALID_HANDLE)
         {
-            msgq_t msgq = msgq_create(MSGQ_MAX_DEPTH, MSGQ_MAX_SIZE);
+            msgq_t msgq = msgq_create(MSGQ_MAX_DEPTH, MSGQ_MAX_SIZE, attr ? attr->slab_count : 0,
+                                      attr ? attr->slab_size : 0);
             if (msgq != MSGQ_INVALID_HANDLE)
             {
                 msgq_stores[i] = msgq;
@@ -454,41 +742,31 @@ int bplib_store_ram_enqueue(bp_handle_t h, const void *data1, size_t data1_size,
     assert((data1_size + data2_size) > 0);
 
     int          status;
-    size_t       data_size   = data1_size + data2_size;
-    size_t       object_size = sizeof(bp_object_hdr_t) + data_size;
-    bp_object_t *object      = (bp_object_t *)bplib_os_calloc(object_size);
+    bp_object_t *object = bplib_store_ram_allocate(h, data1_size + data2_size);
 
-    /* Check memory allocation */
+    /* Check memory allocation (an exhausted slab is full) */
     if (!object)
     {
+        if (msgq_stores[handle]->slab.memory)
+        {
+            bplib_os_sleep(timeout / 1000);
+            return BP_TIMEOUT;
+        }
         return BP_ERROR;
     }
 
     /* Populate Object */
-    object->header.handle = h;
-    object->header.sid    = BP_SID_VACANT;
-    object->header.size   = data_size;
     memcpy(object->data, data1, data1_size);
     memcpy(&object->data[data1_size], data2, data2_size);
 
     /* Post object */
-    status = msgq_post(msgq_stores[handle], object, object_size);
-    if (status == MSGQ_OKAY)
+    status = bplib_store_ram_post(h, object, timeout);
+    if (status != BP_SUCCESS)
     {
-        msgq_stores[handle]->count++;
-        return BP_SUCCESS;
-    }
-    else if (status == MSGQ_FULL)
-    {
-        bplib_os_free(object);
-        bplib_os_sleep(timeout / 1000);
-        return BP_TIMEOUT;
-    }
-    else
-    {
-        bplib_os_free(object);
-        return BP_ERROR;
+        msgq_free(msgq_stores[handle], object);
     }
+
+    return status;
 }
 
 /*----------------------------------------------------------------------------
@@ -563,7 +841,7 @@ int bplib_store_ram_relinquish(bp_handle_t h, bp_sid_t sid)
     assert(msgq_stores[handle]);
 
     bp_object_t *object = (void *)sid;
-    bplib_os_free(object);
+    msgq_free(msgq_stores[handle], object);
     msgq_stores[handle]->count--;
 
     return BP_SUCCESS;
@@ -581,3 +859,211 @@ int bplib_store_ram_getcount(bp_handle_t h)
 
     return msgq_stores[handle]->count;
 }
+
+/*----------------------------------------------------------------------------
+ * bplib_store_ram_allocate -
+ *
+ *  allocates an object which the caller populates in place and then posts
+ *----------------------------------------------------------------------------*/
+bp_object_t *bplib_store_ram_allocate(bp_handle_t h, size_t size)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_RAM_STORE_BASE);
+
+    assert(handle >= 0 && handle < MSGQ_MAX_STORES);
+    assert(msgq_stores[handle]);
+    assert(size > 0);
+
+    bp_object_t *object = msgq_alloc(msgq_stores[handle], size);
+    if (object)
+    {
+        object->header.handle = h;
+        object->header.sid    = BP_SID_VACANT;
+        object->header.size   = size;
+    }
+
+    return object;
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_ram_post -
+ *
+ *  queues an allocated object without copying it; on success the store owns
+ *  the object, on failure it remains with the caller
+ *----------------------------------------------------------------------------*/
+int bplib_store_ram_post(bp_handle_t h, bp_object_t *object, int timeout)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_RAM_STORE_BASE);
+
+    assert(handle >= 0 && handle < MSGQ_MAX_STORES);
+    assert(msgq_stores[handle]);
+    assert(object);
+
+    int status = msgq_post(msgq_stores[handle], object, sizeof(bp_object_hdr_t) + object->header.size);
+    if (status == MSGQ_OKAY)
+    {
+        msgq_stores[handle]->count++;
+        return BP_SUCCESS;
+    }
+    else if (status == MSGQ_FULL)
+    {
+        bplib_os_sleep(timeout / 1000);
+        return BP_TIMEOUT;
+    }
+    else
+    {
+        return BP_ERROR;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_ram_discard -
+ *
+ *  frees an allocated object that was never posted
+ *----------------------------------------------------------------------------*/
+int bplib_store_ram_discard(bp_handle_t h, bp_object_t *object)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_RAM_STORE_BASE);
+
+    assert(handle >= 0 && handle < MSGQ_MAX_STORES);
+    assert(msgq_stores[handle]);
+    assert(object);
+
+    msgq_free(msgq_stores[handle], object);
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_ram_enqueue_batch -
+ *
+ *  copies and posts objects in order with a single queue lock; returns the
+ *  number of objects enqueued, or error code when none are
+ *----------------------------------------------------------------------------*/
+int bplib_store_ram_enqueue_batch(bp_handle_t h, const bp_store_vec_t *objects, int count, int timeout)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_RAM_STORE_BASE);
+
+    assert(handle >= 0 && handle < MSGQ_MAX_STORES);
+    assert(msgq_stores[handle]);
+    assert(objects);
+
+    bp_object_t *batch[BP_RAM_MAX_BATCH];
+    int          enqueued   = 0;
+    int          post_state = MSGQ_OKAY;
+
+    while (enqueued < count && post_state == MSGQ_OKAY)
+    {
+        int num_objects = 0;
+
+        /* Allocate and Populate Objects (stops when memory is exhausted) */
+        while (num_objects < BP_RAM_MAX_BATCH && enqueued + num_objects < count)
+        {
+            const bp_store_vec_t *vec    = &objects[enqueued + num_objects];
+            bp_object_t          *object = bplib_store_ram_allocate(h, vec->data1_size + vec->data2_size);
+            if (!object)
+            {
+                break;
+            }
+
+            memcpy(object->data, vec->data1, vec->data1_size);
+            memcpy(&object->data[vec->data1_size], vec->data2, vec->data2_size);
+            batch[num_objects++] = object;
+        }
+
+        /* Check memory allocation (an exhausted slab is full) */
+        if (num_objects == 0)
+        {
+            post_state = msgq_stores[handle]->slab.memory ? MSGQ_FULL : MSGQ_MEMORY_ERROR;
+            break;
+        }
+
+        /* Post Objects (freeing those not posted) */
+        int posted = msgq_post_batch(msgq_stores[handle], batch, num_objects, &post_state);
+        if (posted < num_objects)
+        {
+            msgq_free_batch(msgq_stores[handle], &batch[posted], num_objects - posted);
+        }
+        msgq_stores[handle]->count += posted;
+        enqueued += posted;
+    }
+
+    /* Return Number Enqueued or Status */
+    if (enqueued > 0)
+    {
+        return enqueued;
+    }
+    else if (post_state == MSGQ_FULL)
+    {
+        bplib_os_sleep(timeout / 1000);
+        return BP_TIMEOUT;
+    }
+    else
+    {
+        return BP_ERROR;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_ram_dequeue_batch -
+ *
+ *  dequeues up to max objects with a single queue lock, only waiting for the
+ *  first; returns the number of objects dequeued, or error code
+ *----------------------------------------------------------------------------*/
+int bplib_store_ram_dequeue_batch(bp_handle_t h, bp_object_t **objects, int max, int timeout)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_RAM_STORE_BASE);
+    int i;
+
+    assert(handle >= 0 && handle < MSGQ_MAX_STORES);
+    assert(msgq_stores[handle]);
+    assert(objects);
+
+    int status = msgq_receive_batch(msgq_stores[handle], (void **)objects, max, timeout);
+    if (status > 0)
+    {
+        for (i = 0; i < status; i++)
+        {
+            objects[i]->header.sid = (unsigned long)objects[i]; /* only update sid */
+        }
+        return status;
+    }
+    else if (status == MSGQ_TIMEOUT || status == MSGQ_UNDERFLOW)
+    {
+        return BP_TIMEOUT;
+    }
+    else
+    {
+        return BP_ERROR;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_ram_relinquish_batch -
+ *----------------------------------------------------------------------------*/
+int bplib_store_ram_relinquish_batch(bp_handle_t h, const bp_sid_t *sids, int count)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_RAM_STORE_BASE);
+    int i;
+
+    assert(handle >= 0 && handle < MSGQ_MAX_STORES);
+    assert(msgq_stores[handle]);
+    assert(sids);
+
+    bp_object_t *batch[BP_RAM_MAX_BATCH];
+    while (count > 0)
+    {
+        int num_objects = count < BP_RAM_MAX_BATCH ? count : BP_RAM_MAX_BATCH;
+        for (i = 0; i < num_objects; i++)
+        {
+            batch[i] = (bp_object_t *)sids[i];
+        }
+
+        msgq_free_batch(msgq_stores[handle], batch, num_objects);
+        msgq_stores[handle]->count -= num_objects;
+
+        sids += num_objects;
+        count -= num_objects;
+    }
+
+    return BP_SUCCESS;
+}
@@ -0,0 +1,655 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bplib.h"
+#include "bplib_os.h"
+#include "bplib_store_ring.h"
+
+/******************************************************************************
+ * DEFINES
+ ******************************************************************************/
+
+#define RING_CACHE_LINE   64
+#define RING_OBJECT_ALIGN 16
+
+/* Slot States */
+#define RING_SLOT_FREE      0 /* in free_slots */
+#define RING_SLOT_ALLOCATED 1 /* taken by allocate, not yet posted */
+#define RING_SLOT_QUEUED    2 /* in queued */
+#define RING_SLOT_DEQUEUED  3 /* handed out by dequeue, not yet relinquished */
+
+/* Configurable Options */
+
+#ifndef RING_MAX_STORES
+#define RING_MAX_STORES 60
+#endif
+
+/******************************************************************************
+ * TYPEDEFS
+ ******************************************************************************/
+
+/* ring_cell_t */
+typedef struct
+{
+    unsigned long seq;  /* position cell is ready for (see ring_push and ring_pop) */
+    unsigned int  slot; /* index of slot held by cell */
+} ring_cell_t;
+
+/*
+ * ring_t - bounded multi-producer/multi-consumer queue of slot indices
+ *
+ *  Each cell carries a sequence number so that producers and consumers claim
+ *  positions with a compare-and-swap and never take a lock; the positions are
+ *  kept on separate cache lines so producers and consumers do not share one
+ */
+typedef struct
+{
+    ring_cell_t  *cells;
+    unsigned long mask;
+    char          pad0[RING_CACHE_LINE];
+    unsigned long push_pos;
+    char          pad1[RING_CACHE_LINE];
+    unsigned long pop_pos;
+    char          pad2[RING_CACHE_LINE];
+} ring_t;
+
+/* ring_store_t */
+typedef struct
+{
+    uint8_t    *slots;      /* preallocated objects */
+    uint8_t    *states;     /* state of each slot (RING_SLOT_...), so a bad relinquish is caught */
+    size_t      slot_size;  /* size of each slot in bytes */
+    size_t      max_object; /* largest object data size that fits in a slot */
+    int         num_slots;  /* number of slots */
+    ring_t      free_slots; /* slots available to enqueue into */
+    ring_t      queued;     /* slots enqueued and not yet dequeued, in order */
+    int         count;      /* number of objects enqueued and not yet relinquished */
+    int         waiters;    /* number of dequeues blocked on ready */
+    bp_handle_t ready;      /* mutex/conditional used only to block and wake dequeues */
+} ring_store_t;
+
+/******************************************************************************
+ * FILE DATA
+ ******************************************************************************/
+
+static ring_store_t *ring_stores[RING_MAX_STORES];
+
+/******************************************************************************
+ * LOCAL RING FUNCTIONS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Function:        ring_create
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int ring_create(ring_t *ring, int size)
+{
+    unsigned long capacity = 1;
+    unsigned long i;
+
+    /* Round Up to Power of Two */
+    while (capacity < (unsigned long)size)
+    {
+        capacity <<= 1;
+    }
+
+    ring->cells = (ring_cell_t *)bplib_os_calloc_tag(sizeof(ring_cell_t) * capacity, BP_MEM_RAM);
+    if (ring->cells == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    for (i = 0; i < capacity; i++)
+    {
+        ring->cells[i].seq = i;
+    }
+    ring->mask     = capacity - 1;
+    ring->push_pos = 0;
+    ring->pop_pos  = 0;
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * Function:        ring_push
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int ring_push(ring_t *ring, unsigned int slot)
+{
+    ring_cell_t  *cell;
+    unsigned long pos = __atomic_load_n(&ring->push_pos, __ATOMIC_RELAXED);
+
+    while (true)
+    {
+        cell               = &ring->cells[pos & ring->mask];
+        unsigned long seq  = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        long          diff = (long)(seq - pos);
+        if (diff == 0)
+        {
+            /* Cell Free - Claim Position */
+            if (__atomic_compare_exchange_n(&ring->push_pos, &pos, pos + 1, true, __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            /* Cell Not Yet Consumed - Full */
+            return BP_ERROR;
+        }
+        else
+        {
+            /* Another Producer Claimed Position */
+            pos = __atomic_load_n(&ring->push_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    /* Publish Slot */
+    cell->slot = slot;
+    __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * Function:        ring_pop
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int ring_pop(ring_t *ring, unsigned int *slot)
+{
+    ring_cell_t  *cell;
+    unsigned long pos = __atomic_load_n(&ring->pop_pos, __ATOMIC_RELAXED);
+
+    while (true)
+    {
+        cell               = &ring->cells[pos & ring->mask];
+        unsigned long seq  = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        long          diff = (long)(seq - (pos + 1));
+        if (diff == 0)
+        {
+            /* Cell Published - Claim Position */
+            if (__atomic_compare_exchange_n(&ring->pop_pos, &pos, pos + 1, true, __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            /* Cell Not Yet Published - Empty */
+            return BP_TIMEOUT;
+        }
+        else
+        {
+            /* Another Consumer Claimed Position */
+            pos = __atomic_load_n(&ring->pop_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    /* Release Cell to Producers */
+    *slot = cell->slot;
+    __atomic_store_n(&cell->seq, pos + ring->mask + 1, __ATOMIC_RELEASE);
+
+    return BP_SUCCESS;
+}
+
+/******************************************************************************
+ * LOCAL STORE FUNCTIONS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * Function:        store_delete
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void store_delete(ring_store_t *store)
+{
+    if (store)
+    {
+        if (bp_handle_is_valid(store->ready))
+        {
+            bplib_os_destroylock(store->ready);
+        }
+        if (store->free_slots.cells)
+        {
+            bplib_os_free(store->free_slots.cells);
+        }
+        if (store->queued.cells)
+        {
+            bplib_os_free(store->queued.cells);
+        }
+        if (store->slots)
+        {
+            bplib_os_free(store->slots);
+        }
+        if (store->states)
+        {
+            bplib_os_free(store->states);
+        }
+        bplib_os_free(store);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * Function:        store_create
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE ring_store_t *store_create(int slot_count, int slot_size)
+{
+    ring_store_t *store;
+    int           i;
+
+    /* Allocate Store */
+    store = (ring_store_t *)bplib_os_calloc_tag(sizeof(ring_store_t), BP_MEM_RAM);
+    if (store == NULL)
+    {
+        return NULL;
+    }
+    store->ready = BP_INVALID_HANDLE;
+
+    /* Allocate Slots */
+    store->max_object = ((size_t)slot_size + RING_OBJECT_ALIGN - 1) & ~(size_t)(RING_OBJECT_ALIGN - 1);
+    store->slot_size  = sizeof(bp_object_hdr_t) + store->max_object;
+    store->num_slots  = slot_count;
+    store->slots      = (uint8_t *)bplib_os_calloc_tag(store->slot_size * slot_count, BP_MEM_RAM);
+    store->states     = (uint8_t *)bplib_os_calloc_tag(slot_count, BP_MEM_RAM); /* RING_SLOT_FREE */
+    if (store->slots == NULL || store->states == NULL)
+    {
+        store_delete(store);
+        return NULL;
+    }
+
+    /* Create Rings (every slot starts out free) */
+    if (ring_create(&store->free_slots, slot_count) != BP_SUCCESS ||
+        ring_create(&store->queued, slot_count) != BP_SUCCESS)
+    {
+        store_delete(store);
+        return NULL;
+    }
+    for (i = 0; i < slot_count; i++)
+    {
+        ring_push(&store->free_slots, i);
+    }
+
+    /* Create Lock */
+    store->ready = bplib_os_createlock();
+    if (!bp_handle_is_valid(store->ready))
+    {
+        store_delete(store);
+        return NULL;
+    }
+
+    return store;
+}
+
+/*----------------------------------------------------------------------------
+ * Function:        store_object
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE bp_object_t *store_object(ring_store_t *store, unsigned int slot)
+{
+    return (bp_object_t *)&store->slots[store->slot_size * slot];
+}
+
+/*----------------------------------------------------------------------------
+ * Function:        store_slot
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE unsigned int store_slot(ring_store_t *store, bp_object_t *object)
+{
+    return (unsigned int)(((uint8_t *)object - store->slots) / store->slot_size);
+}
+
+/*----------------------------------------------------------------------------
+ * Function:        store_post
+ *
+ * Notes:           queues the slot and wakes a blocked dequeue, if any; the
+ *                  queued ring holds every slot so the push cannot fail; either
+ *                  the waiter sees the pushed slot or the producer sees the waiter
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void store_post(ring_store_t *store, unsigned int slot)
+{
+    __atomic_add_fetch(&store->count, 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&store->states[slot], RING_SLOT_QUEUED, __ATOMIC_RELAXED); /* published by the push */
+    ring_push(&store->queued, slot);
+
+    /* Order the Push Before the Waiter Check - pairs with the fence in store_wait */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&store->waiters, __ATOMIC_RELAXED) > 0)
+    {
+        bplib_os_lock(store->ready);
+        bplib_os_signal(store->ready);
+        bplib_os_unlock(store->ready);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * Function:        store_wait
+ *
+ * Notes:           pops the next queued slot, blocking up to timeout when empty;
+ *                  the lock is only taken when the ring is found empty
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int store_wait(ring_store_t *store, unsigned int *slot, int timeout)
+{
+    int status = ring_pop(&store->queued, slot);
+    if (status == BP_SUCCESS || timeout == BP_CHECK)
+    {
+        return status;
+    }
+
+    bplib_os_lock(store->ready);
+    {
+        __atomic_add_fetch(&store->waiters, 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        /* Check Again Now That Producers Will Signal */
+        status = ring_pop(&store->queued, slot);
+        if (status == BP_TIMEOUT && timeout == BP_PEND)
+        {
+            while ((status = ring_pop(&store->queued, slot)) == BP_TIMEOUT)
+            {
+                bplib_os_waiton(store->ready, BP_PEND);
+            }
+        }
+        else if (status == BP_TIMEOUT)
+        {
+            /* Wait until Deadline - wakeups that lose the object to another consumer do not extend it */
+            unsigned long deadline = 0;
+            bplib_os_monotime_us(&deadline);
+            deadline += (unsigned long)timeout * 1000;
+            while ((status = ring_pop(&store->queued, slot)) == BP_TIMEOUT)
+            {
+                if (bplib_os_waituntil(store->ready, deadline) != BP_SUCCESS)
+                {
+                    status = ring_pop(&store->queued, slot);
+                    break;
+                }
+            }
+        }
+
+        __atomic_sub_fetch(&store->waiters, 1, __ATOMIC_SEQ_CST);
+    }
+    bplib_os_unlock(store->ready);
+
+    return status;
+}
+
+/*----------------------------------------------------------------------------
+ * Function:        store_lookup
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE ring_store_t *store_lookup(bp_handle_t h)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_RING_STORE_BASE);
+
+    assert(handle >= 0 && handle < RING_MAX_STORES);
+    assert(ring_stores[handle]);
+
+    return ring_stores[handle];
+}
+
+/******************************************************************************
+ * EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * bplib_store_ring_init -
+ *----------------------------------------------------------------------------*/
+void bplib_store_ring_init(void)
+{
+    memset(ring_stores, 0, sizeof(ring_stores));
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_ring_create -
+ *----------------------------------------------------------------------------*/
+bp_handle_t bplib_store_ring_create(int type, bp_ipn_t node, bp_ipn_t service, bool recover, void *parm)
+{
+    (void)type;
+    (void)node;
+    (void)service;
+    (void)recover;
+
+    bp_ring_attr_t *attr       = (bp_ring_attr_t *)parm;
+    int             slot_count = attr ? attr->slot_count : BP_RING_DEFAULT_SLOT_COUNT;
+    int             slot_size  = attr ? attr->slot_size : BP_RING_DEFAULT_SLOT_SIZE;
+    bp_handle_t     slot;
+    int             i;
+
+    /* Check Attributes */
+    if (slot_count <= 0 || slot_size <= 0)
+    {
+        return BP_INVALID_HANDLE;
+    }
+
+    /* Look for Empty Slots */
+    slot = BP_INVALID_HANDLE;
+    for (i = 0; i < RING_MAX_STORES; i++)
+    {
+        if (ring_stores[i] == NULL)
+        {
+            ring_store_t *store = store_create(slot_count, slot_size);
+            if (store != NULL)
+            {
+                ring_stores[i] = store;
+                slot           = bp_handle_from_serial(i, BPLIB_HANDLE_RING_STORE_BASE);
+            }
+            break;
+        }
+    }
+
+    /* Return Index into List */
+    return slot;
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_ring_destroy -
+ *----------------------------------------------------------------------------*/
+int bplib_store_ring_destroy(bp_handle_t h)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_RING_STORE_BASE);
+
+    store_delete(store_lookup(h));
+    ring_stores[handle] = NULL;
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_ring_enqueue -
+ *----------------------------------------------------------------------------*/
+int bplib_store_ring_enqueue(bp_handle_t h, const void *data1, size_t data1_size, const void *data2, size_t data2_size,
+                             int timeout)
+{
+    assert((data1_size + data2_size) > 0);
+
+    bp_object_t *object = bplib_store_ring_allocate(h, data1_size + data2_size);
+    if (!object)
+    {
+        /* Full (objects that can never fit are rejected by allocate) */
+        if (data1_size + data2_size > store_lookup(h)->max_object)
+        {
+            return BP_ERROR;
+        }
+        bplib_os_sleep(timeout / 1000);
+        return BP_TIMEOUT;
+    }
+
+    /* Populate Object */
+    memcpy(object->data, data1, data1_size);
+    if (data2_size > 0)
+    {
+        memcpy(&object->data[data1_size], data2, data2_size);
+    }
+
+    /* Post Object */
+    return bplib_store_ring_post(h, object, timeout);
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_ring_dequeue -
+ *----------------------------------------------------------------------------*/
+int bplib_store_ring_dequeue(bp_handle_t h, bp_object_t **object, int timeout)
+{
+    ring_store_t *store = store_lookup(h);
+    unsigned int  slot;
+
+    assert(object);
+
+    int status = store_wait(store, &slot, timeout);
+    if (status == BP_SUCCESS)
+    {
+        __atomic_store_n(&store->states[slot], RING_SLOT_DEQUEUED, __ATOMIC_RELEASE);
+        *object = store_object(store, slot);
+    }
+
+    return status;
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_ring_retrieve -
+ *----------------------------------------------------------------------------*/
+int bplib_store_ring_retrieve(bp_handle_t h, bp_sid_t sid, bp_object_t **object, int timeout)
+{
+    ring_store_t *store = store_lookup(h);
+
+    (void)timeout;
+
+    assert(object);
+
+    if (sid == BP_SID_VACANT || sid > (bp_sid_t)store->num_slots)
+    {
+        return BP_ERROR;
+    }
+
+    *object = store_object(store, (unsigned int)(sid - 1));
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_ring_release -
+ *----------------------------------------------------------------------------*/
+int bplib_store_ring_release(bp_handle_t h, bp_sid_t sid)
+{
+    (void)h;
+    (void)sid;
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_ring_relinquish -
+ *
+ *  only a dequeued slot is freed; relinquishing a slot twice, or one that is
+ *  still queued, would hand the same slot out to two producers
+ *----------------------------------------------------------------------------*/
+int bplib_store_ring_relinquish(bp_handle_t h, bp_sid_t sid)
+{
+    ring_store_t *store = store_lookup(h);
+
+    if (sid == BP_SID_VACANT || sid > (bp_sid_t)store->num_slots)
+    {
+        return BP_ERROR;
+    }
+
+    unsigned int slot  = (unsigned int)(sid - 1);
+    uint8_t      state = RING_SLOT_DEQUEUED;
+    if (!__atomic_compare_exchange_n(&store->states[slot], &state, RING_SLOT_FREE, false, __ATOMIC_ACQ_REL,
+                                     __ATOMIC_RELAXED))
+    {
+        return BP_ERROR;
+    }
+
+    __atomic_sub_fetch(&store->count, 1, __ATOMIC_RELAXED);
+    ring_push(&store->free_slots, slot);
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_ring_getcount -
+ *----------------------------------------------------------------------------*/
+int bplib_store_ring_getcount(bp_handle_t h)
+{
+    return __atomic_load_n(&store_lookup(h)->count, __ATOMIC_RELAXED);
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_ring_allocate -
+ *
+ *  takes a free slot which the caller populates in place and then posts
+ *----------------------------------------------------------------------------*/
+bp_object_t *bplib_store_ring_allocate(bp_handle_t h, size_t size)
+{
+    ring_store_t *store = store_lookup(h);
+    unsigned int  slot;
+
+    assert(size > 0);
+
+    if (size > store->max_object || ring_pop(&store->free_slots, &slot) != BP_SUCCESS)
+    {
+        return NULL;
+    }
+
+    __atomic_store_n(&store->states[slot], RING_SLOT_ALLOCATED, __ATOMIC_RELAXED);
+
+    bp_object_t *object   = store_object(store, slot);
+    object->header.handle = h;
+    object->header.sid    = slot + 1;
+    object->header.size   = size;
+
+    return object;
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_ring_post -
+ *
+ *  queues an allocated slot without copying it; the store owns it from now on
+ *----------------------------------------------------------------------------*/
+int bplib_store_ring_post(bp_handle_t h, bp_object_t *object, int timeout)
+{
+    ring_store_t *store = store_lookup(h);
+
+    (void)timeout;
+
+    assert(object);
+
+    store_post(store, store_slot(store, object));
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_ring_discard -
+ *
+ *  returns an allocated slot that was never posted
+ *----------------------------------------------------------------------------*/
+int bplib_store_ring_discard(bp_handle_t h, bp_object_t *object)
+{
+    ring_store_t *store = store_lookup(h);
+
+    assert(object);
+
+    unsigned int slot = store_slot(store, object);
+    __atomic_store_n(&store->states[slot], RING_SLOT_FREE, __ATOMIC_RELAXED);
+    ring_push(&store->free_slots, slot);
+
+    return BP_SUCCESS;
+}
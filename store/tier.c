@@ -0,0 +1,1169 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/******************************************************************************
+ * INCLUDES
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bplib.h"
+#include "bplib_os.h"
+#include "bplib_store_tier.h"
+
+/******************************************************************************
+ * DEFINES
+ ******************************************************************************/
+
+#define TIER_WRITE_TIMEOUT_MS 1000 /* longest a write behind waits on the persistent storage service */
+#define TIER_RETRY_MS         100  /* wait before retrying a write behind that failed */
+
+/* Configurable Options */
+
+#ifndef TIER_MAX_STORES
+#define TIER_MAX_STORES 60
+#endif
+
+/******************************************************************************
+ * TYPEDEFS
+ ******************************************************************************/
+
+/*
+ * tier_entry_t - one object of a tiered store, its address is the storage ID
+ *
+ *  Every object is on the list of all objects of its store; in addition, it is
+ *  on the dequeue queue until it is dequeued, on the write behind list until it
+ *  is written, on the cold list from when it is written until the persistent
+ *  store dequeues it, and on the hot list while it is both written and held in
+ *  RAM (which makes it a candidate for eviction)
+ */
+typedef struct tier_entry_t
+{
+    struct tier_entry_t *all_prev;     /* previous object of store */
+    struct tier_entry_t *all_next;     /* next object of store */
+    struct tier_entry_t *next;         /* next object on dequeue queue */
+    struct tier_entry_t *wb_next;      /* next object on write behind list */
+    struct tier_entry_t *cold_next;    /* next object on cold list */
+    struct tier_entry_t *hot_prev;     /* previous object on hot list */
+    struct tier_entry_t *hot_next;     /* next object on hot list */
+    bp_object_t         *object;       /* copy held in RAM, NULL when only in persistent storage */
+    size_t               size;         /* size of object data, 0 for recovered objects until dequeued */
+    bp_sid_t             cold_sid;     /* storage ID in persistent storage, BP_SID_VACANT until known */
+    unsigned long        stored_ms;    /* time object was enqueued */
+    int                  locks;        /* dequeues and retrievals not yet released */
+    bool                 queued;       /* on write behind list */
+    bool                 writing;      /* being written to persistent storage */
+    bool                 pending;      /* on cold list, written but not yet dequeued from persistent storage */
+    bool                 hot;          /* on hot list */
+    bool                 dequeued;     /* taken off the dequeue queue */
+    bool                 relinquished; /* freed by whoever holds it last */
+} tier_entry_t;
+
+/* tier_store_t */
+typedef struct
+{
+    bool             in_use;
+    bool             preserve;    /* write out queued objects when destroyed */
+    bp_tier_attr_t   attributes;  /* includes the persistent storage service */
+    size_t           hot_size;    /* bytes of objects held in RAM before written objects are evicted */
+    bp_handle_t      cold_handle; /* handle of persistent store */
+    bp_handle_t      lock;        /* protects entries and lists, and wakes dequeue and write behind */
+    bplib_os_mutex_t cold_lock;   /* serializes calls into persistent store, keeping it in order with the cold list */
+    tier_entry_t    *all;         /* list of all objects */
+    tier_entry_t    *front;       /* dequeue queue */
+    tier_entry_t    *rear;
+    tier_entry_t    *wb_front;    /* write behind list, oldest first */
+    tier_entry_t    *wb_rear;
+    tier_entry_t    *cold_front;  /* cold list, in the order of the queue of the persistent store */
+    tier_entry_t    *cold_rear;
+    tier_entry_t    *hot_front;   /* hot list, least recently written or read first */
+    tier_entry_t    *hot_rear;
+    int              object_count;
+    bp_tier_stats_t  stats;
+    bp_handle_t      wb_thread;
+    bool             wb_running;  /* cleared to stop the write behind thread */
+} tier_store_t;
+
+/******************************************************************************
+ * FILE DATA
+ ******************************************************************************/
+
+static tier_store_t tier_stores[TIER_MAX_STORES];
+
+/******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * tier_hot_add - object is written and held in RAM, store lock held
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void tier_hot_add(tier_store_t *ts, tier_entry_t *entry)
+{
+    entry->hot_prev = ts->hot_rear;
+    entry->hot_next = NULL;
+    if (ts->hot_rear)
+    {
+        ts->hot_rear->hot_next = entry;
+    }
+    else
+    {
+        ts->hot_front = entry;
+    }
+    ts->hot_rear = entry;
+    entry->hot   = true;
+}
+
+/*----------------------------------------------------------------------------
+ * tier_hot_remove - store lock held
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void tier_hot_remove(tier_store_t *ts, tier_entry_t *entry)
+{
+    if (entry->hot_prev)
+    {
+        entry->hot_prev->hot_next = entry->hot_next;
+    }
+    else
+    {
+        ts->hot_front = entry->hot_next;
+    }
+
+    if (entry->hot_next)
+    {
+        entry->hot_next->hot_prev = entry->hot_prev;
+    }
+    else
+    {
+        ts->hot_rear = entry->hot_prev;
+    }
+
+    entry->hot_prev = NULL;
+    entry->hot_next = NULL;
+    entry->hot      = false;
+}
+
+/*----------------------------------------------------------------------------
+ * tier_drop - frees copy of object held in RAM, store lock held
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void tier_drop(tier_store_t *ts, tier_entry_t *entry)
+{
+    if (entry->hot)
+    {
+        tier_hot_remove(ts, entry);
+    }
+
+    if (entry->object)
+    {
+        bplib_os_free(entry->object);
+        entry->object = NULL;
+        ts->stats.hot_bytes -= entry->size;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * tier_attach - holds copy read back from persistent storage in RAM, store lock held
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void tier_attach(tier_store_t *ts, tier_entry_t *entry, bp_object_t *object)
+{
+    if (entry->object == NULL)
+    {
+        entry->object = object;
+        ts->stats.hot_bytes += entry->size;
+        ts->stats.cold_reads++;
+        tier_hot_add(ts, entry);
+    }
+    else
+    {
+        /* Read Concurrently by Another Retrieval */
+        bplib_os_free(object);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * tier_evict - drops written objects from RAM until within hot size, store lock held
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void tier_evict(tier_store_t *ts)
+{
+    tier_entry_t *entry = ts->hot_front;
+    while (entry && ts->stats.hot_bytes > ts->hot_size)
+    {
+        tier_entry_t *next = entry->hot_next;
+
+        /* Objects Still in Use Stay in RAM */
+        if (entry->locks == 0)
+        {
+            tier_drop(ts, entry);
+            ts->stats.evictions++;
+        }
+
+        entry = next;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * tier_entry_alloc - allocates entry for object of size bytes, store lock held
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE tier_entry_t *tier_entry_alloc(tier_store_t *ts, size_t size)
+{
+    tier_entry_t *entry = (tier_entry_t *)bplib_os_calloc_tag(sizeof(tier_entry_t), BP_MEM_TIER);
+    if (entry)
+    {
+        entry->size     = size;
+        entry->cold_sid = BP_SID_VACANT;
+
+        /* Add to List of All Objects */
+        entry->all_next = ts->all;
+        if (ts->all)
+        {
+            ts->all->all_prev = entry;
+        }
+        ts->all = entry;
+    }
+
+    return entry;
+}
+
+/*----------------------------------------------------------------------------
+ * tier_entry_free - frees object entry and any copy held in RAM, store lock held
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void tier_entry_free(tier_store_t *ts, tier_entry_t *entry)
+{
+    tier_drop(ts, entry);
+
+    if (entry->all_prev)
+    {
+        entry->all_prev->all_next = entry->all_next;
+    }
+    else
+    {
+        ts->all = entry->all_next;
+    }
+    if (entry->all_next)
+    {
+        entry->all_next->all_prev = entry->all_prev;
+    }
+
+    bplib_os_free(entry);
+}
+
+/*----------------------------------------------------------------------------
+ * tier_queue - makes object available to dequeue, store lock held
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void tier_queue(tier_store_t *ts, tier_entry_t *entry)
+{
+    if (ts->rear)
+    {
+        ts->rear->next = entry;
+    }
+    else
+    {
+        ts->front = entry;
+    }
+    ts->rear = entry;
+    ts->object_count++;
+}
+
+/*----------------------------------------------------------------------------
+ * tier_cold_add - object is now at the rear of the queue of the persistent store, store lock held
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void tier_cold_add(tier_store_t *ts, tier_entry_t *entry)
+{
+    entry->cold_next = NULL;
+    if (ts->cold_rear)
+    {
+        ts->cold_rear->cold_next = entry;
+    }
+    else
+    {
+        ts->cold_front = entry;
+    }
+    ts->cold_rear  = entry;
+    entry->pending = true;
+}
+
+/*----------------------------------------------------------------------------
+ * tier_cold_pop - dequeues objects from persistent storage until entry's is, cold lock held
+ *
+ *  entry is either locked by the caller, or already dequeued and relinquished,
+ *  in which case it is freed here; when fetch is set and the entry holds no copy
+ *  of its object, the object dequeued is copied into RAM
+ *  written objects are left queued in the persistent store so that a preserved
+ *  store recovers them; both are kept in the same order, so the objects the
+ *  persistent store dequeues belong to the entries at the front of the cold list,
+ *  and dequeuing them is how their storage IDs are learned.  Since the tiered
+ *  store dequeues in the same order too, the entries ahead of this one have
+ *  already been dequeued by the time it is.
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int tier_cold_pop(tier_store_t *ts, bp_handle_t h, tier_entry_t *entry, bool fetch)
+{
+    bp_tier_attr_t *attr   = &ts->attributes;
+    int             status = BP_SUCCESS;
+
+    /* Check Storage ID Already Known */
+    bplib_os_lock(ts->lock);
+    bool done = !entry->pending;
+    bplib_os_unlock(ts->lock);
+
+    while (!done)
+    {
+        bp_object_t  *cold_object = NULL;
+        bp_sid_t      cold_sid    = BP_SID_VACANT;
+        bool          copy        = false;
+        tier_entry_t *front;
+
+        /* Dequeue Front of Persistent Store */
+        status = attr->cold.dequeue(ts->cold_handle, &cold_object, BP_CHECK);
+        if (status != BP_SUCCESS)
+        {
+            return bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to dequeue written object from tier store\n",
+                         status);
+        }
+
+        bplib_os_lock(ts->lock);
+        {
+            front = ts->cold_front;
+            assert(front);
+
+            ts->cold_front = front->cold_next;
+            if (ts->cold_front == NULL)
+            {
+                ts->cold_rear = NULL;
+            }
+            front->cold_next = NULL;
+            front->pending   = false;
+            front->cold_sid  = cold_object->header.sid;
+            front->size      = cold_object->header.size;
+
+            done = (front == entry);
+            if (front->relinquished)
+            {
+                /* Relinquished While Pending */
+                cold_sid = front->cold_sid;
+                tier_entry_free(ts, front);
+            }
+            else
+            {
+                /* Object Only in Persistent Storage is Copied on the Way */
+                copy = done && fetch && (front->object == NULL);
+            }
+        }
+        bplib_os_unlock(ts->lock);
+
+        if (copy)
+        {
+            bp_object_t *object = (bp_object_t *)bplib_os_calloc_tag(sizeof(bp_object_hdr_t) + entry->size,
+                                                                     BP_MEM_TIER);
+            if (object)
+            {
+                object->header.handle = h;
+                object->header.sid    = (bp_sid_t)entry;
+                object->header.size   = entry->size;
+                memcpy(object->data, cold_object->data, entry->size);
+
+                bplib_os_lock(ts->lock);
+                tier_attach(ts, entry, object);
+                bplib_os_unlock(ts->lock);
+            }
+        }
+
+        attr->cold.release(ts->cold_handle, cold_object->header.sid);
+        if (cold_sid != BP_SID_VACANT)
+        {
+            attr->cold.relinquish(ts->cold_handle, cold_sid);
+        }
+    }
+
+    return status;
+}
+
+/*----------------------------------------------------------------------------
+ * tier_read - learns storage ID and reads copy of object back into RAM, called without store lock
+ *
+ *  the entry is locked by the caller, so it is neither evicted nor freed
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int tier_read(tier_store_t *ts, bp_handle_t h, tier_entry_t *entry, int timeout)
+{
+    bp_object_t *cold_object = NULL;
+    bp_object_t *object      = NULL;
+    int          status;
+
+    bplib_os_mutex_lock(&ts->cold_lock);
+    {
+        /* Learn Storage ID */
+        status = tier_cold_pop(ts, h, entry, true);
+
+        bplib_os_lock(ts->lock);
+        bool held = (entry->object != NULL);
+        bplib_os_unlock(ts->lock);
+
+        /* Copy Object Out of Persistent Store */
+        if (status == BP_SUCCESS && !held)
+        {
+            status = ts->attributes.cold.retrieve(ts->cold_handle, entry->cold_sid, &cold_object, timeout);
+            if (status == BP_SUCCESS)
+            {
+                object = (bp_object_t *)bplib_os_calloc_tag(sizeof(bp_object_hdr_t) + entry->size, BP_MEM_TIER);
+                if (object)
+                {
+                    object->header.handle = h;
+                    object->header.sid    = (bp_sid_t)entry;
+                    object->header.size   = entry->size;
+                    memcpy(object->data, cold_object->data, entry->size);
+                }
+                else
+                {
+                    status = BP_ERROR;
+                }
+                ts->attributes.cold.release(ts->cold_handle, entry->cold_sid);
+            }
+        }
+    }
+    bplib_os_mutex_unlock(&ts->cold_lock);
+
+    /* Hold Object in RAM */
+    if (object)
+    {
+        bplib_os_lock(ts->lock);
+        tier_attach(ts, entry, object);
+        bplib_os_unlock(ts->lock);
+    }
+
+    return status;
+}
+
+/*----------------------------------------------------------------------------
+ * tier_write - writes oldest object of write behind list, called without store lock
+ *
+ *  returns BP_TIMEOUT when there is nothing left to write
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int tier_write(tier_store_t *ts, bp_handle_t h, int timeout)
+{
+    tier_entry_t *entry    = NULL;
+    bool          dequeued = false;
+    int           status   = BP_TIMEOUT;
+
+    /* Objects are Written in Order Under the Cold Lock */
+    bplib_os_mutex_lock(&ts->cold_lock);
+    {
+        bplib_os_lock(ts->lock);
+        {
+            /* Take Oldest Object Not Relinquished */
+            while ((entry = ts->wb_front) != NULL)
+            {
+                ts->wb_front = entry->wb_next;
+                if (ts->wb_front == NULL)
+                {
+                    ts->wb_rear = NULL;
+                }
+                entry->wb_next = NULL;
+                entry->queued  = false;
+
+                if (!entry->relinquished)
+                {
+                    entry->writing = true;
+                    break;
+                }
+
+                /* Never Written */
+                tier_entry_free(ts, entry);
+                ts->stats.skips++;
+            }
+        }
+        bplib_os_unlock(ts->lock);
+
+        if (entry)
+        {
+            status = ts->attributes.cold.enqueue(ts->cold_handle, entry->object->data, entry->size, NULL, 0, timeout);
+
+            bplib_os_lock(ts->lock);
+            {
+                entry->writing = false;
+                if (status == BP_SUCCESS)
+                {
+                    ts->stats.writes++;
+                    tier_cold_add(ts, entry);
+                    dequeued = entry->dequeued;
+
+                    /* Now a Candidate for Eviction */
+                    if (!entry->relinquished)
+                    {
+                        tier_hot_add(ts, entry);
+                        tier_evict(ts);
+                    }
+                }
+                else
+                {
+                    /* Put Back at Front */
+                    entry->queued  = true;
+                    entry->wb_next = ts->wb_front;
+                    ts->wb_front   = entry;
+                    if (ts->wb_rear == NULL)
+                    {
+                        ts->wb_rear = entry;
+                    }
+                }
+            }
+            bplib_os_unlock(ts->lock);
+
+            /* Objects Already Dequeued Are Dequeued from Persistent Store Right Away */
+            if (dequeued)
+            {
+                tier_cold_pop(ts, h, entry, false);
+            }
+        }
+    }
+    bplib_os_mutex_unlock(&ts->cold_lock);
+
+    return status;
+}
+
+/*----------------------------------------------------------------------------
+ * tier_io_thread - writes objects older than the write delay to persistent storage
+ *
+ *  objects relinquished before they reach the front of the write behind list are
+ *  dropped without ever being written; the write delay is ignored when RAM is full
+ *  and when a preserved store is destroyed
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE void tier_io_thread(void *parm)
+{
+    tier_store_t *ts = (tier_store_t *)parm;
+    bp_handle_t   h  = bp_handle_from_serial((int)(ts - tier_stores), BPLIB_HANDLE_TIER_STORE_BASE);
+
+    bplib_os_lock(ts->lock);
+    while (true)
+    {
+        tier_entry_t *entry = ts->wb_front;
+
+        /* Check Exit */
+        if (!ts->wb_running && (entry == NULL || !ts->preserve))
+        {
+            break;
+        }
+
+        /* Wait for Work */
+        if (entry == NULL)
+        {
+            bplib_os_waiton(ts->lock, BP_PEND);
+            continue;
+        }
+
+        /* Wait for Write Delay */
+        if (ts->wb_running && !entry->relinquished && ts->stats.hot_bytes < ts->hot_size)
+        {
+            unsigned long now_ms;
+            bplib_os_monotime(&now_ms);
+            long remaining = (long)ts->attributes.write_delay - (long)(now_ms - entry->stored_ms);
+            if (remaining > 0)
+            {
+                bplib_os_waiton(ts->lock, (int)remaining);
+                continue;
+            }
+        }
+
+        /* Write Object Outside of Store Lock */
+        bplib_os_unlock(ts->lock);
+        int status = tier_write(ts, h, TIER_WRITE_TIMEOUT_MS);
+        bplib_os_lock(ts->lock);
+
+        if (status != BP_SUCCESS && status != BP_TIMEOUT)
+        {
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to write behind object in tier store\n", status);
+            bplib_os_waiton(ts->lock, TIER_RETRY_MS);
+        }
+    }
+    bplib_os_unlock(ts->lock);
+}
+
+/*----------------------------------------------------------------------------
+ * tier_recover - queues the objects recovered by the persistent store
+ *
+ *  recovered objects stay in the queue of the persistent store, and are only
+ *  read back as they are dequeued
+ *----------------------------------------------------------------------------*/
+BP_LOCAL_SCOPE int tier_recover(tier_store_t *ts)
+{
+    int count  = ts->attributes.cold.getcount(ts->cold_handle);
+    int status = BP_SUCCESS;
+
+    bplib_os_lock(ts->lock);
+    {
+        while (count-- > 0)
+        {
+            tier_entry_t *entry = tier_entry_alloc(ts, 0);
+            if (entry == NULL)
+            {
+                status = bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed to allocate recovered object in tier store\n");
+                break;
+            }
+
+            tier_cold_add(ts, entry);
+            tier_queue(ts, entry);
+        }
+    }
+    bplib_os_unlock(ts->lock);
+
+    return status;
+}
+
+/******************************************************************************
+ * EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+/*----------------------------------------------------------------------------
+ * bplib_store_tier_init -
+ *----------------------------------------------------------------------------*/
+void bplib_store_tier_init(void)
+{
+    memset(tier_stores, 0, sizeof(tier_stores));
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_tier_stats -
+ *----------------------------------------------------------------------------*/
+void bplib_store_tier_stats(bp_handle_t h, bp_tier_stats_t *stats, bool log_stats, bool reset_stats)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_TIER_STORE_BASE);
+
+    assert(handle >= 0 && handle < TIER_MAX_STORES);
+    assert(tier_stores[handle].in_use);
+
+    tier_store_t *ts = &tier_stores[handle];
+    bplib_os_lock(ts->lock);
+    {
+        /* Copy Stats */
+        if (stats)
+        {
+            *stats = ts->stats;
+        }
+
+        /* Log Stats */
+        if (log_stats)
+        {
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Number of reads from RAM: %lu\n", ts->stats.hot_reads);
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Number of reads from persistent storage: %lu\n", ts->stats.cold_reads);
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Number of objects written: %lu\n", ts->stats.writes);
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Number of objects never written: %lu\n", ts->stats.skips);
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Number of objects evicted: %lu\n", ts->stats.evictions);
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Bytes held in RAM: %lu\n", (unsigned long)ts->stats.hot_bytes);
+        }
+
+        /* Reset Stats */
+        if (reset_stats)
+        {
+            ts->stats.hot_reads  = 0;
+            ts->stats.cold_reads = 0;
+            ts->stats.writes     = 0;
+            ts->stats.skips      = 0;
+            ts->stats.evictions  = 0;
+        }
+    }
+    bplib_os_unlock(ts->lock);
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_tier_create -
+ *----------------------------------------------------------------------------*/
+bp_handle_t bplib_store_tier_create(int type, bp_ipn_t node, bp_ipn_t service, bool recover, void *parm)
+{
+    bp_tier_attr_t *attr = (bp_tier_attr_t *)parm;
+    int             s;
+
+    /* Check Persistent Storage Service */
+    if (attr == NULL || attr->cold.create == NULL)
+    {
+        bplog(NULL, BP_FLAG_STORE_FAILURE, "Tier store requires a persistent storage service\n");
+        return BP_INVALID_HANDLE;
+    }
+
+    /* Look for Empty Slot */
+    for (s = 0; s < TIER_MAX_STORES; s++)
+    {
+        if (tier_stores[s].in_use == false)
+        {
+            break;
+        }
+    }
+    if (s == TIER_MAX_STORES)
+    {
+        return BP_INVALID_HANDLE;
+    }
+
+    /* Initialize Store */
+    tier_store_t *ts = &tier_stores[s];
+    memset(ts, 0, sizeof(tier_store_t));
+    ts->in_use      = true;
+    ts->preserve    = recover;
+    ts->attributes  = *attr;
+    ts->hot_size    = attr->hot_size > 0 ? attr->hot_size : BP_TIER_DEFAULT_HOT_SIZE;
+    ts->cold_handle = BP_INVALID_HANDLE;
+    ts->wb_thread   = BP_INVALID_HANDLE;
+    ts->lock        = bplib_os_createlock();
+    bplib_os_mutex_init(&ts->cold_lock);
+
+    bp_handle_t h = bp_handle_from_serial(s, BPLIB_HANDLE_TIER_STORE_BASE);
+    if (!bp_handle_is_valid(ts->lock))
+    {
+        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to create tier store locks\n");
+        bplib_store_tier_destroy(h);
+        return BP_INVALID_HANDLE;
+    }
+
+    /* Create Persistent Store */
+    ts->cold_handle = attr->cold.create(type, node, service, recover, attr->cold_parm);
+    if (!bp_handle_is_valid(ts->cold_handle))
+    {
+        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to create persistent store of tier store\n");
+        bplib_store_tier_destroy(h);
+        return BP_INVALID_HANDLE;
+    }
+
+    /* Queue Recovered Objects */
+    if (recover && tier_recover(ts) != BP_SUCCESS)
+    {
+        bplib_store_tier_destroy(h);
+        return BP_INVALID_HANDLE;
+    }
+
+    /* Start I/O Thread (falls back to writing inline) */
+    ts->wb_running = true;
+    ts->wb_thread  = bplib_os_createthread(tier_io_thread, ts);
+    if (!bp_handle_is_valid(ts->wb_thread))
+    {
+        bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to start tier store I/O thread, writing inline\n");
+        ts->wb_running = false;
+    }
+
+    return h;
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_tier_destroy -
+ *----------------------------------------------------------------------------*/
+int bplib_store_tier_destroy(bp_handle_t h)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_TIER_STORE_BASE);
+
+    assert(handle >= 0 && handle < TIER_MAX_STORES);
+    assert(tier_stores[handle].in_use);
+
+    tier_store_t *ts = &tier_stores[handle];
+
+    /* Stop I/O Thread (writes out objects of preserved stores) */
+    if (bp_handle_is_valid(ts->wb_thread))
+    {
+        bplib_os_lock(ts->lock);
+        {
+            ts->wb_running = false;
+            bplib_os_broadcast(ts->lock);
+        }
+        bplib_os_unlock(ts->lock);
+
+        bplib_os_jointhread(ts->wb_thread);
+        ts->wb_thread = BP_INVALID_HANDLE;
+    }
+    else if (ts->preserve && bp_handle_is_valid(ts->cold_handle))
+    {
+        /* Write Out Objects Inline */
+        while (tier_write(ts, h, TIER_WRITE_TIMEOUT_MS) == BP_SUCCESS)
+        {
+        }
+    }
+
+    /* Free Objects (written ones remain in persistent storage for recovery) */
+    while (ts->all)
+    {
+        tier_entry_free(ts, ts->all);
+    }
+
+    /* Destroy Persistent Store */
+    if (bp_handle_is_valid(ts->cold_handle))
+    {
+        ts->attributes.cold.destroy(ts->cold_handle);
+    }
+
+    if (bp_handle_is_valid(ts->lock))
+    {
+        bplib_os_destroylock(ts->lock);
+    }
+    bplib_os_mutex_destroy(&ts->cold_lock);
+
+    ts->in_use = false;
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_tier_enqueue -
+ *
+ *  objects are written behind by the I/O thread; when the object does not fit in
+ *  RAM, the oldest objects waiting to be written are written before enqueue
+ *  returns so that they can be evicted, and when there is no I/O thread every
+ *  object is written before enqueue returns
+ *----------------------------------------------------------------------------*/
+int bplib_store_tier_enqueue(bp_handle_t h, const void *data1, size_t data1_size, const void *data2, size_t data2_size,
+                             int timeout)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_TIER_STORE_BASE);
+
+    assert(handle >= 0 && handle < TIER_MAX_STORES);
+    assert(tier_stores[handle].in_use);
+    assert((data1_size + data2_size) > 0);
+
+    tier_store_t *ts     = &tier_stores[handle];
+    size_t        size   = data1_size + data2_size;
+    int           status = BP_SUCCESS;
+
+    /* Make Room in RAM */
+    while (status == BP_SUCCESS)
+    {
+        bool full;
+        bplib_os_lock(ts->lock);
+        {
+            tier_evict(ts);
+            full = (ts->wb_front != NULL) && (ts->stats.hot_bytes + size > ts->hot_size);
+        }
+        bplib_os_unlock(ts->lock);
+
+        if (!full)
+        {
+            break;
+        }
+
+        status = tier_write(ts, h, timeout);
+    }
+
+    /* Check Room (nothing left to write is not an error) */
+    if (status != BP_SUCCESS && status != BP_TIMEOUT)
+    {
+        return status;
+    }
+
+    /* Copy Object into RAM */
+    bp_object_t *object = (bp_object_t *)bplib_os_calloc_tag(sizeof(bp_object_hdr_t) + size, BP_MEM_TIER);
+    if (object == NULL)
+    {
+        return BP_ERROR;
+    }
+    object->header.handle = h;
+    object->header.size   = size;
+    memcpy(object->data, data1, data1_size);
+    memcpy(&object->data[data1_size], data2, data2_size);
+
+    tier_entry_t *entry;
+    bplib_os_lock(ts->lock);
+    {
+        entry = tier_entry_alloc(ts, size);
+        if (entry)
+        {
+            object->header.sid = (bp_sid_t)entry;
+            entry->object      = object;
+            ts->stats.hot_bytes += size;
+            bplib_os_monotime(&entry->stored_ms);
+
+            /* Queue for Write Behind */
+            entry->queued = true;
+            if (ts->wb_rear)
+            {
+                ts->wb_rear->wb_next = entry;
+            }
+            else
+            {
+                ts->wb_front = entry;
+            }
+            ts->wb_rear = entry;
+
+            tier_queue(ts, entry);
+            bplib_os_broadcast(ts->lock);
+        }
+    }
+    bplib_os_unlock(ts->lock);
+
+    /* Check Allocation */
+    if (entry == NULL)
+    {
+        bplib_os_free(object);
+        return BP_ERROR;
+    }
+
+    /* Write Inline */
+    if (!bp_handle_is_valid(ts->wb_thread))
+    {
+        do
+        {
+            status = tier_write(ts, h, timeout);
+        } while (status == BP_SUCCESS);
+
+        if (status != BP_TIMEOUT)
+        {
+            bplog(NULL, BP_FLAG_STORE_FAILURE, "Failed (%d) to write object in tier store, held in RAM\n", status);
+        }
+    }
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_tier_dequeue -
+ *----------------------------------------------------------------------------*/
+int bplib_store_tier_dequeue(bp_handle_t h, bp_object_t **object, int timeout)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_TIER_STORE_BASE);
+
+    assert(handle >= 0 && handle < TIER_MAX_STORES);
+    assert(tier_stores[handle].in_use);
+    assert(object);
+
+    tier_store_t *ts      = &tier_stores[handle];
+    tier_entry_t *entry   = NULL;
+    bool          hot     = false;
+    bool          pending = false;
+
+    bplib_os_lock(ts->lock);
+    {
+        /* Wait for Object */
+        if (timeout == BP_PEND)
+        {
+            while (ts->front == NULL)
+            {
+                bplib_os_waiton(ts->lock, BP_PEND);
+            }
+        }
+        else if (timeout != BP_CHECK)
+        {
+            /* Wait until Deadline - wakeups that find the queue empty do not extend it */
+            unsigned long deadline = 0;
+            bplib_os_monotime_us(&deadline);
+            deadline += (unsigned long)timeout * 1000;
+            while (ts->front == NULL)
+            {
+                if (bplib_os_waituntil(ts->lock, deadline) != BP_SUCCESS)
+                {
+                    break;
+                }
+            }
+        }
+
+        /* Take Oldest Object */
+        entry = ts->front;
+        if (entry)
+        {
+            ts->front = entry->next;
+            if (ts->front == NULL)
+            {
+                ts->rear = NULL;
+            }
+            entry->next     = NULL;
+            entry->dequeued = true;
+            entry->locks++;
+            pending = entry->pending;
+            if (entry->object)
+            {
+                ts->stats.hot_reads++;
+                *object = entry->object;
+                hot     = true;
+            }
+        }
+    }
+    bplib_os_unlock(ts->lock);
+
+    /* Check Empty */
+    if (entry == NULL)
+    {
+        return BP_TIMEOUT;
+    }
+
+    /* Dequeue from Persistent Store and Read Object Back */
+    if (pending || !hot)
+    {
+        int status = tier_read(ts, h, entry, timeout);
+        bplib_os_lock(ts->lock);
+        {
+            if (status != BP_SUCCESS)
+            {
+                /* Leave Object at Front of Queue */
+                entry->locks--;
+                entry->dequeued = false;
+                entry->next     = ts->front;
+                ts->front       = entry;
+                if (ts->rear == NULL)
+                {
+                    ts->rear = entry;
+                }
+            }
+            else if (!hot)
+            {
+                *object = entry->object;
+            }
+        }
+        bplib_os_unlock(ts->lock);
+        return status;
+    }
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_tier_retrieve -
+ *----------------------------------------------------------------------------*/
+int bplib_store_tier_retrieve(bp_handle_t h, bp_sid_t sid, bp_object_t **object, int timeout)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_TIER_STORE_BASE);
+
+    assert(handle >= 0 && handle < TIER_MAX_STORES);
+    assert(tier_stores[handle].in_use);
+    assert(object);
+
+    tier_store_t *ts    = &tier_stores[handle];
+    tier_entry_t *entry = (tier_entry_t *)sid;
+    bool          hot   = false;
+
+    bplib_os_lock(ts->lock);
+    {
+        entry->locks++;
+        if (entry->object)
+        {
+            /* Most Recently Used Is Evicted Last */
+            if (entry->hot)
+            {
+                tier_hot_remove(ts, entry);
+                tier_hot_add(ts, entry);
+            }
+            ts->stats.hot_reads++;
+            *object = entry->object;
+            hot     = true;
+        }
+    }
+    bplib_os_unlock(ts->lock);
+
+    /* Read Object Back from Persistent Store */
+    if (!hot)
+    {
+        int status = tier_read(ts, h, entry, timeout);
+        bplib_os_lock(ts->lock);
+        {
+            if (status != BP_SUCCESS)
+            {
+                entry->locks--;
+            }
+            else
+            {
+                *object = entry->object;
+            }
+        }
+        bplib_os_unlock(ts->lock);
+        return status;
+    }
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_tier_release -
+ *----------------------------------------------------------------------------*/
+int bplib_store_tier_release(bp_handle_t h, bp_sid_t sid)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_TIER_STORE_BASE);
+
+    assert(handle >= 0 && handle < TIER_MAX_STORES);
+    assert(tier_stores[handle].in_use);
+
+    tier_store_t *ts    = &tier_stores[handle];
+    tier_entry_t *entry = (tier_entry_t *)sid;
+
+    bplib_os_lock(ts->lock);
+    {
+        if (entry->locks > 0)
+        {
+            entry->locks--;
+        }
+
+        /* Objects Read Back Can Now Be Evicted */
+        if (entry->locks == 0)
+        {
+            tier_evict(ts);
+        }
+    }
+    bplib_os_unlock(ts->lock);
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_tier_relinquish -
+ *----------------------------------------------------------------------------*/
+int bplib_store_tier_relinquish(bp_handle_t h, bp_sid_t sid)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_TIER_STORE_BASE);
+
+    assert(handle >= 0 && handle < TIER_MAX_STORES);
+    assert(tier_stores[handle].in_use);
+
+    tier_store_t *ts       = &tier_stores[handle];
+    tier_entry_t *entry    = (tier_entry_t *)sid;
+    bp_sid_t      cold_sid = BP_SID_VACANT;
+
+    bplib_os_lock(ts->lock);
+    {
+        entry->relinquished = true;
+        ts->object_count--;
+
+        if (entry->queued)
+        {
+            /* Never Written - Freed When It Reaches Front of Write Behind List */
+            tier_drop(ts, entry);
+        }
+        else if (!entry->writing && !entry->pending)
+        {
+            cold_sid = entry->cold_sid;
+            tier_entry_free(ts, entry);
+        }
+
+        /* Otherwise Freed Once Written and Dequeued from Persistent Store */
+    }
+    bplib_os_unlock(ts->lock);
+
+    /* Relinquish Written Object */
+    if (cold_sid != BP_SID_VACANT)
+    {
+        return ts->attributes.cold.relinquish(ts->cold_handle, cold_sid);
+    }
+
+    return BP_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * bplib_store_tier_getcount -
+ *----------------------------------------------------------------------------*/
+int bplib_store_tier_getcount(bp_handle_t h)
+{
+    int handle = bp_handle_to_serial(h, BPLIB_HANDLE_TIER_STORE_BASE);
+
+    assert(handle >= 0 && handle < TIER_MAX_STORES);
+    assert(tier_stores[handle].in_use);
+
+    tier_store_t *ts = &tier_stores[handle];
+    int           count;
+
+    bplib_os_lock(ts->lock);
+    count = ts->object_count;
+    bplib_os_unlock(ts->lock);
+
+    return count;
+}
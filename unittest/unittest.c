@@ -32,7 +32,16 @@
 extern int ut_crc(void);
 extern int ut_rb_tree(void);
 extern int ut_rh_hash(void);
+extern int ut_twheel(void);
 extern int ut_flash(void);
+extern int ut_lz(void);
+extern int ut_cbitmap(void);
+extern int ut_sdnv(void);
+extern int ut_lrc(void);
+extern int ut_reasm(void);
+extern int ut_dedup(void);
+extern int ut_ring(void);
+extern int ut_file(void);
 
 /******************************************************************************
  EXPORTED FUNCTIONS
@@ -74,6 +83,18 @@ int bplib_unittest_rh_hash(void)
 #endif
 }
 
+/*--------------------------------------------------------------------------------------
+ * Timer Wheel Unit Test -
+ *--------------------------------------------------------------------------------------*/
+int bplib_unittest_twheel(void)
+{
+#ifdef UNITTESTS
+    return ut_twheel();
+#else
+    return 0;
+#endif
+}
+
 /*--------------------------------------------------------------------------------------
  * Flash Unit Test -
  *--------------------------------------------------------------------------------------*/
@@ -86,3 +107,100 @@ int bplib_unittest_flash(void)
     return 0;
 #endif
 }
+
+/*--------------------------------------------------------------------------------------
+ * LZ Compression Unit Test -
+ *--------------------------------------------------------------------------------------*/
+int bplib_unittest_lz(void)
+{
+#ifdef UNITTESTS
+    return ut_lz();
+#else
+    return 0;
+#endif
+}
+
+/*--------------------------------------------------------------------------------------
+ * Compressed Bitmap Unit Test -
+ *--------------------------------------------------------------------------------------*/
+int bplib_unittest_cbitmap(void)
+{
+#ifdef UNITTESTS
+    return ut_cbitmap();
+#else
+    return 0;
+#endif
+}
+
+/*--------------------------------------------------------------------------------------
+ * SDNV Unit Test -
+ *--------------------------------------------------------------------------------------*/
+int bplib_unittest_sdnv(void)
+{
+#ifdef UNITTESTS
+    return ut_sdnv();
+#else
+    return 0;
+#endif
+}
+
+/*--------------------------------------------------------------------------------------
+ * LRC Unit Test -
+ *--------------------------------------------------------------------------------------*/
+int bplib_unittest_lrc(void)
+{
+#ifdef UNITTESTS
+    bplib_store_flash_uninit(); /* lrc tables are shared with the flash storage service */
+    return ut_lrc();
+#else
+    return 0;
+#endif
+}
+
+/*--------------------------------------------------------------------------------------
+ * Reassembly Unit Test -
+ *--------------------------------------------------------------------------------------*/
+int bplib_unittest_reasm(void)
+{
+#ifdef UNITTESTS
+    return ut_reasm();
+#else
+    return 0;
+#endif
+}
+
+/*--------------------------------------------------------------------------------------
+ * Duplicate Detection Unit Test -
+ *--------------------------------------------------------------------------------------*/
+int bplib_unittest_dedup(void)
+{
+#ifdef UNITTESTS
+    return ut_dedup();
+#else
+    return 0;
+#endif
+}
+
+/*--------------------------------------------------------------------------------------
+ * Ring Storage Unit Test -
+ *--------------------------------------------------------------------------------------*/
+int bplib_unittest_ring(void)
+{
+#ifdef UNITTESTS
+    return ut_ring();
+#else
+    return 0;
+#endif
+}
+
+/*--------------------------------------------------------------------------------------
+ * File Storage Unit Test -
+ *--------------------------------------------------------------------------------------*/
+int bplib_unittest_file(void)
+{
+#ifdef UNITTESTS
+    return ut_file();
+#else
+    return 0;
+#endif
+}
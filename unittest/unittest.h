@@ -28,6 +28,15 @@
 int bplib_unittest_crc(void);
 int bplib_unittest_rb_tree(void);
 int bplib_unittest_rh_hash(void);
+int bplib_unittest_twheel(void);
 int bplib_unittest_flash(void);
+int bplib_unittest_lz(void);
+int bplib_unittest_cbitmap(void);
+int bplib_unittest_sdnv(void);
+int bplib_unittest_lrc(void);
+int bplib_unittest_reasm(void);
+int bplib_unittest_dedup(void);
+int bplib_unittest_ring(void);
+int bplib_unittest_file(void);
 
 #endif /* UNITTEST_H */
@@ -0,0 +1,229 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include "ut_assert.h"
+#include "bplib_os.h"
+#include "bundle_types.h"
+#include "cbitmap.h"
+
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+#define UT_CBITMAP_SPAN 65536 /* custody ids covered by stress test */
+
+/******************************************************************************
+ FILE DATA
+ ******************************************************************************/
+
+static bool present[UT_CBITMAP_SPAN];
+
+/******************************************************************************
+ TEST FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * Test #1
+ *--------------------------------------------------------------------------------------*/
+static void test_1(void)
+{
+    cbitmap_t *bitmap;
+    rb_range_t range;
+
+    printf("\n==== Test 1: Insert and Iterate ====\n");
+
+    ut_assert(cbitmap_create(&bitmap, 0) == BP_ERROR, "Failed to reject empty bitmap\n");
+    ut_assert(cbitmap_create(&bitmap, 2) == BP_SUCCESS, "Failed to create bitmap\n");
+    ut_assert(cbitmap_is_empty(bitmap), "Failed to create empty bitmap\n");
+
+    /* Insert Out of Order - range spans two blocks */
+    ut_assert(cbitmap_insert(CBITMAP_BLOCK_BITS, bitmap) == BP_SUCCESS, "Failed to insert\n");
+    ut_assert(cbitmap_insert(CBITMAP_BLOCK_BITS - 1, bitmap) == BP_SUCCESS, "Failed to insert\n");
+    ut_assert(cbitmap_insert(CBITMAP_BLOCK_BITS + 1, bitmap) == BP_SUCCESS, "Failed to insert\n");
+    ut_assert(cbitmap_insert(5, bitmap) == BP_SUCCESS, "Failed to insert\n");
+    ut_assert(cbitmap_insert(5, bitmap) == BP_DUPLICATE, "Failed to detect duplicate\n");
+    ut_assert(cbitmap_insert(CBITMAP_BLOCK_BITS * 2, bitmap) == BP_FULL, "Failed to detect full bitmap\n");
+    ut_assert(!cbitmap_is_empty(bitmap), "Failed to insert into bitmap\n");
+
+    /* Iterate Without Popping */
+    cbitmap_goto_first(bitmap);
+    ut_assert(cbitmap_get_next(bitmap, &range, false, false) == BP_SUCCESS && range.value == 5 && range.offset == 0,
+              "Failed to get first range: %lu + %lu\n", (unsigned long)range.value, (unsigned long)range.offset);
+    ut_assert(cbitmap_get_next(bitmap, &range, false, false) == BP_SUCCESS &&
+                  range.value == CBITMAP_BLOCK_BITS - 1 && range.offset == 2,
+              "Failed to get range across blocks: %lu + %lu\n", (unsigned long)range.value,
+              (unsigned long)range.offset);
+    ut_assert(cbitmap_get_next(bitmap, &range, false, false) == BP_ERROR, "Failed to detect end of bitmap\n");
+
+    /* Iterate and Pop */
+    cbitmap_goto_first(bitmap);
+    ut_assert(cbitmap_get_next(bitmap, &range, true, false) == BP_SUCCESS && range.value == 5,
+              "Failed to pop first range\n");
+    ut_assert(cbitmap_get_next(bitmap, &range, true, false) == BP_SUCCESS && range.offset == 2,
+              "Failed to pop range across blocks\n");
+    ut_assert(cbitmap_is_empty(bitmap), "Failed to release blocks\n");
+
+    /* Blocks Reused */
+    ut_assert(cbitmap_insert(CBITMAP_BLOCK_BITS * 2, bitmap) == BP_SUCCESS, "Failed to reuse block\n");
+    ut_assert(cbitmap_insert(CBITMAP_BLOCK_BITS * 7, bitmap) == BP_SUCCESS, "Failed to reuse block\n");
+    ut_assert(cbitmap_insert(0, bitmap) == BP_FULL, "Failed to detect full bitmap\n");
+
+    ut_assert(cbitmap_destroy(bitmap) == BP_SUCCESS, "Failed to destroy bitmap\n");
+}
+
+/*--------------------------------------------------------------------------------------
+ * Test #2
+ *--------------------------------------------------------------------------------------*/
+static void test_2(void)
+{
+    int        i, j;
+    cbitmap_t *bitmap;
+    rb_tree_t  tree;
+    rb_range_t range;
+    rb_range_t expected;
+
+    int test_cycles = 64;
+    int num_inserts = UT_CBITMAP_SPAN / 2;
+
+    printf("\n==== Test 2: Stress - Match Custody Tree ====\n");
+
+    ut_assert(cbitmap_create(&bitmap, UT_CBITMAP_SPAN / CBITMAP_BLOCK_BITS) == BP_SUCCESS,
+              "Failed to create bitmap\n");
+    ut_assert(rb_tree_create(UT_CBITMAP_SPAN, &tree) == BP_SUCCESS, "Failed to create tree\n");
+
+    for (j = 0; j < test_cycles; j++)
+    {
+        bool found_error = false;
+
+        /* Insert Scattered Custody IDs - both runs and isolated ids */
+        for (i = 0; i < num_inserts; i++)
+        {
+            bp_val_t cid = bplib_os_random() % UT_CBITMAP_SPAN;
+            if (j % 2 && (cid % 128) < 64)
+            {
+                cid = cid - (cid % 128) + (i % 64);
+            }
+
+            int status = cbitmap_insert(cid, bitmap);
+            if (present[cid])
+            {
+                found_error |= !ut_assert(status == BP_DUPLICATE, "Failed to detect duplicate %lu\n", cid);
+            }
+            else
+            {
+                found_error |= !ut_assert(status == BP_SUCCESS, "Failed to insert %lu: %d\n", cid, status);
+                rb_tree_insert(cid, &tree);
+                present[cid] = true;
+            }
+        }
+
+        /* Pop Ranges and Compare to Tree */
+        cbitmap_goto_first(bitmap);
+        rb_tree_goto_first(&tree);
+        while (!rb_tree_is_empty(&tree))
+        {
+            rb_tree_get_next(&tree, &expected, true, false);
+            if (!found_error)
+            {
+                found_error = !ut_assert(cbitmap_get_next(bitmap, &range, true, false) == BP_SUCCESS &&
+                                             range.value == expected.value && range.offset == expected.offset,
+                                         "Range %lu + %lu does not match %lu + %lu\n", (unsigned long)range.value,
+                                         (unsigned long)range.offset, (unsigned long)expected.value,
+                                         (unsigned long)expected.offset);
+            }
+        }
+        ut_assert(found_error || cbitmap_is_empty(bitmap), "Failed to pop all ranges\n");
+
+        /* Reset */
+        for (i = 0; i < UT_CBITMAP_SPAN; i++)
+        {
+            present[i] = false;
+        }
+        if (found_error)
+        {
+            cbitmap_destroy(bitmap);
+            cbitmap_create(&bitmap, UT_CBITMAP_SPAN / CBITMAP_BLOCK_BITS);
+        }
+    }
+
+    rb_tree_destroy(&tree);
+    ut_assert(cbitmap_destroy(bitmap) == BP_SUCCESS, "Failed to destroy bitmap\n");
+}
+
+/*--------------------------------------------------------------------------------------
+ * Test #3
+ *--------------------------------------------------------------------------------------*/
+static void test_3(void)
+{
+    int        i;
+    cbitmap_t *bitmap;
+    rb_range_t range;
+
+    int num_cids   = 4000000;
+    int num_ranges = 0;
+    int num_acked  = 0;
+
+    printf("\n==== Test 3: Millions of Custody IDs with Every Other Lost ====\n");
+
+    ut_assert(cbitmap_create(&bitmap, (num_cids / CBITMAP_BLOCK_BITS) + 1) == BP_SUCCESS,
+              "Failed to create bitmap\n");
+
+    for (i = 0; i < num_cids; i += 2)
+    {
+        if (!ut_assert(cbitmap_insert(i, bitmap) == BP_SUCCESS, "Failed to insert %d\n", i))
+        {
+            break;
+        }
+    }
+
+    cbitmap_goto_first(bitmap);
+    while (cbitmap_get_next(bitmap, &range, true, false) == BP_SUCCESS)
+    {
+        ut_assert(range.value == (bp_val_t)num_ranges * 2 && range.offset == 0, "Unexpected range %lu + %lu\n",
+                  (unsigned long)range.value, (unsigned long)range.offset);
+        num_acked += range.offset + 1;
+        num_ranges++;
+    }
+
+    ut_assert(num_ranges == num_cids / 2 && num_acked == num_cids / 2, "Failed to get all ranges: %d, %d\n",
+              num_ranges, num_acked);
+    ut_assert(cbitmap_is_empty(bitmap), "Failed to release all blocks\n");
+
+    ut_assert(cbitmap_destroy(bitmap) == BP_SUCCESS, "Failed to destroy bitmap\n");
+}
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+int ut_cbitmap(void)
+{
+    ut_reset();
+
+    test_1();
+    test_2();
+    test_3();
+
+    return ut_failures();
+}
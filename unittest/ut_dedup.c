@@ -0,0 +1,352 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ut_assert.h"
+#include "bplib.h"
+#include "bplib_os.h"
+#include "bplib_store_ram.h"
+#include "dedup.h"
+
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+#define UT_DEDUP_ENTRIES 16
+#define UT_DEDUP_BUNDLES 64
+#define UT_DEDUP_THREADS 4
+#define UT_DEDUP_TIMEOUT 1000
+#define UT_DEDUP_STALL   500 /* microseconds */
+
+/******************************************************************************
+ TYPEDEFS
+ ******************************************************************************/
+
+/* Bundles Processed by One Thread */
+typedef struct
+{
+    bp_desc_t *desc;
+    void     **bundles;
+    size_t    *sizes;
+    int        failures;
+} ut_dedup_worker_t;
+
+/******************************************************************************
+ LOCAL FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * dedup_stalled_enqueue - stores an object slowly so that other threads process copies
+ *  of a bundle while it is being stored
+ *--------------------------------------------------------------------------------------*/
+static int dedup_stalled_enqueue(bp_handle_t h, const void *data1, size_t data1_size, const void *data2,
+                                 size_t data2_size, int timeout)
+{
+    bplib_os_sleep_us(UT_DEDUP_STALL);
+    return bplib_store_ram_enqueue(h, data1, data1_size, data2, data2_size, timeout);
+}
+
+/*--------------------------------------------------------------------------------------
+ * dedup_worker - processes every bundle, started on several threads at once
+ *--------------------------------------------------------------------------------------*/
+static void dedup_worker(void *parm)
+{
+    ut_dedup_worker_t *worker = (ut_dedup_worker_t *)parm;
+    int                i;
+
+    for (i = 0; i < UT_DEDUP_BUNDLES; i++)
+    {
+        uint32_t flags = 0;
+        if (bplib_process(worker->desc, worker->bundles[i], worker->sizes[i], UT_DEDUP_TIMEOUT, &flags) != BP_SUCCESS)
+        {
+            worker->failures++;
+        }
+    }
+}
+
+/******************************************************************************
+ TEST FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * Test #1
+ *--------------------------------------------------------------------------------------*/
+static void test_1(void)
+{
+    dedup_t    *dedup;
+    dedup_key_t key = {.adu = {.node = 4, .service = 3, .createsec = 1000, .createseq = 7}, .fragoffset = 0};
+    dedup_key_t other;
+
+    printf("\n==== Test 1: Duplicate Identifiers ====\n");
+
+    ut_assert(dedup_create(&dedup, UT_DEDUP_ENTRIES) == BP_SUCCESS, "Failed to create duplicate index\n");
+
+    ut_assert(!dedup_find(dedup, &key), "Found identifier before insert\n");
+    ut_assert(dedup_insert(dedup, &key) == BP_SUCCESS, "Failed to insert identifier\n");
+    ut_assert(dedup_find(dedup, &key), "Failed to find identifier\n");
+    ut_assert(dedup_insert(dedup, &key) == BP_DUPLICATE, "Duplicate identifier inserted\n");
+    ut_assert(dedup_count(dedup) == 1, "Expected one identifier, had %d\n", dedup_count(dedup));
+
+    /* Each Field Tells Bundles Apart */
+    other = key;
+    other.adu.node++;
+    ut_assert(!dedup_find(dedup, &other), "Matched different node\n");
+    other = key;
+    other.adu.service++;
+    ut_assert(!dedup_find(dedup, &other), "Matched different service\n");
+    other = key;
+    other.adu.createsec++;
+    ut_assert(!dedup_find(dedup, &other), "Matched different creation time\n");
+    other = key;
+    other.adu.createseq++;
+    ut_assert(!dedup_find(dedup, &other), "Matched different sequence\n");
+    other = key;
+    other.fragoffset = 100;
+    ut_assert(!dedup_find(dedup, &other), "Matched different fragment offset\n");
+
+    dedup_destroy(dedup);
+}
+
+/*--------------------------------------------------------------------------------------
+ * Test #2
+ *--------------------------------------------------------------------------------------*/
+static void test_2(void)
+{
+    dedup_t    *dedup;
+    dedup_key_t key = {.adu = {.node = 9, .service = 1, .createsec = 2000, .createseq = 0}, .fragoffset = 0};
+    int         i;
+
+    printf("\n==== Test 2: Oldest Identifiers Forgotten ====\n");
+
+    dedup_create(&dedup, UT_DEDUP_ENTRIES);
+
+    for (i = 0; i < UT_DEDUP_ENTRIES * 3; i++)
+    {
+        key.adu.createseq = i;
+        ut_assert(dedup_insert(dedup, &key) == BP_SUCCESS, "Failed to insert identifier %d\n", i);
+    }
+    ut_assert(dedup_count(dedup) == UT_DEDUP_ENTRIES, "Expected %d identifiers, had %d\n", UT_DEDUP_ENTRIES,
+              dedup_count(dedup));
+
+    /* Only the Most Recent are Remembered */
+    for (i = 0; i < UT_DEDUP_ENTRIES * 3; i++)
+    {
+        bool expect       = i >= UT_DEDUP_ENTRIES * 2;
+        key.adu.createseq = i;
+        ut_assert(dedup_find(dedup, &key) == expect, "Identifier %d %s\n", i, expect ? "forgotten" : "remembered");
+    }
+
+    /* Forgotten Identifier is Inserted Again */
+    key.adu.createseq = 0;
+    ut_assert(dedup_insert(dedup, &key) == BP_SUCCESS, "Failed to insert forgotten identifier\n");
+    key.adu.createseq = UT_DEDUP_ENTRIES * 2;
+    ut_assert(!dedup_find(dedup, &key), "Oldest identifier not forgotten\n");
+
+    /* Invalid Size */
+    ut_assert(dedup_create(&dedup, 0) == BP_ERROR, "Created index with no entries\n");
+
+    dedup_destroy(dedup);
+}
+
+/*--------------------------------------------------------------------------------------
+ * Test #3
+ *--------------------------------------------------------------------------------------*/
+static void test_3(void)
+{
+    dedup_t    *dedup;
+    dedup_key_t key = {.adu = {.node = 5, .service = 2, .createsec = 3000, .createseq = 0}, .fragoffset = 0};
+    int         i;
+
+    printf("\n==== Test 3: Inserts Backed Out ====\n");
+
+    dedup_create(&dedup, UT_DEDUP_ENTRIES);
+
+    /* Newest Identifier Returned to Ring */
+    ut_assert(dedup_insert(dedup, &key) == BP_SUCCESS, "Failed to insert identifier\n");
+    ut_assert(dedup_remove(dedup, &key) == BP_SUCCESS, "Failed to remove identifier\n");
+    ut_assert(!dedup_find(dedup, &key), "Found removed identifier\n");
+    ut_assert(dedup_count(dedup) == 0, "Expected no identifiers, had %d\n", dedup_count(dedup));
+    ut_assert(dedup_remove(dedup, &key) == BP_ERROR, "Removed identifier twice\n");
+    ut_assert(dedup_insert(dedup, &key) == BP_SUCCESS, "Failed to insert removed identifier\n");
+
+    /* Older Identifier Unlinked */
+    for (i = 1; i < UT_DEDUP_ENTRIES; i++)
+    {
+        key.adu.createseq = i;
+        dedup_insert(dedup, &key);
+    }
+    key.adu.createseq = 3;
+    ut_assert(dedup_remove(dedup, &key) == BP_SUCCESS, "Failed to remove older identifier\n");
+    ut_assert(!dedup_find(dedup, &key), "Found removed older identifier\n");
+
+    /* Ring Wraps Over Removed Slot */
+    for (i = UT_DEDUP_ENTRIES; i < UT_DEDUP_ENTRIES * 2; i++)
+    {
+        key.adu.createseq = i;
+        ut_assert(dedup_insert(dedup, &key) == BP_SUCCESS, "Failed to insert identifier %d\n", i);
+    }
+    for (i = 0; i < UT_DEDUP_ENTRIES * 2; i++)
+    {
+        bool expect       = i >= UT_DEDUP_ENTRIES;
+        key.adu.createseq = i;
+        ut_assert(dedup_find(dedup, &key) == expect, "Identifier %d %s\n", i, expect ? "forgotten" : "remembered");
+    }
+
+    dedup_destroy(dedup);
+}
+
+/*--------------------------------------------------------------------------------------
+ * Test #4
+ *--------------------------------------------------------------------------------------*/
+static void test_4(void)
+{
+    bp_store_t store = {.create           = bplib_store_ram_create,
+                        .destroy          = bplib_store_ram_destroy,
+                        .enqueue          = bplib_store_ram_enqueue,
+                        .dequeue          = bplib_store_ram_dequeue,
+                        .retrieve         = bplib_store_ram_retrieve,
+                        .release          = bplib_store_ram_release,
+                        .relinquish       = bplib_store_ram_relinquish,
+                        .getcount         = bplib_store_ram_getcount,
+                        .enqueue_batch    = bplib_store_ram_enqueue_batch,
+                        .dequeue_batch    = bplib_store_ram_dequeue_batch,
+                        .relinquish_batch = bplib_store_ram_relinquish_batch};
+    bp_store_t        stalled_store = store;
+    bp_route_t        send_route    = {4, 3, 72, 43, 0, 0};
+    bp_route_t        recv_route    = {72, 43, 4, 3, 0, 0};
+    bp_attr_t         attr;
+    bp_stats_t        stats;
+    void             *bundles[UT_DEDUP_BUNDLES];
+    size_t            sizes[UT_DEDUP_BUNDLES];
+    ut_dedup_worker_t workers[UT_DEDUP_THREADS];
+    bp_handle_t       threads[UT_DEDUP_THREADS];
+    bp_desc_t        *sender;
+    bp_desc_t        *receiver;
+    bool              seen[UT_DEDUP_BUNDLES] = {false};
+    int               accepted               = 0;
+    int               i;
+
+    printf("\n==== Test 4: Copies Processed on Several Threads ====\n");
+
+    bplib_attrinit(&attr);
+    attr.request_custody = false;
+    sender               = bplib_open(send_route, store, attr);
+    attr.duplicate_window = UT_DEDUP_BUNDLES;
+    stalled_store.enqueue = dedup_stalled_enqueue;
+    receiver              = bplib_open(recv_route, stalled_store, attr);
+    ut_assert(sender != NULL && receiver != NULL, "Failed to open channels\n");
+    if (sender == NULL || receiver == NULL)
+    {
+        return;
+    }
+
+    /* Create Bundles */
+    for (i = 0; i < UT_DEDUP_BUNDLES; i++)
+    {
+        uint32_t flags = 0;
+        void    *bundle;
+        bundles[i] = NULL;
+        sizes[i]   = 0;
+        if (bplib_store(sender, &i, sizeof(i), UT_DEDUP_TIMEOUT, &flags) == BP_SUCCESS &&
+            bplib_load(sender, &bundle, &sizes[i], UT_DEDUP_TIMEOUT, &flags) == BP_SUCCESS)
+        {
+            bundles[i] = malloc(sizes[i]);
+            memcpy(bundles[i], bundle, sizes[i]);
+            bplib_ackbundle(sender, bundle);
+        }
+        ut_assert(bundles[i] != NULL, "Failed to create bundle %d\n", i);
+    }
+
+    /* Process Every Bundle on Each Thread at Once */
+    for (i = 0; i < UT_DEDUP_THREADS; i++)
+    {
+        workers[i] = (ut_dedup_worker_t){.desc = receiver, .bundles = bundles, .sizes = sizes, .failures = 0};
+        threads[i] = bplib_os_createthread(dedup_worker, &workers[i]);
+        if (!bp_handle_is_valid(threads[i]))
+        {
+            dedup_worker(&workers[i]);
+        }
+    }
+    for (i = 0; i < UT_DEDUP_THREADS; i++)
+    {
+        if (bp_handle_is_valid(threads[i]))
+        {
+            bplib_os_jointhread(threads[i]);
+        }
+        ut_assert(workers[i].failures == 0, "Thread %d failed to process %d bundles\n", i, workers[i].failures);
+    }
+
+    /* Each Payload Accepted Once - threads store them in no particular order */
+    for (;;)
+    {
+        uint32_t flags = 0;
+        void    *payload;
+        size_t   size;
+        int      value;
+        if (bplib_accept(receiver, &payload, &size, BP_CHECK, &flags) != BP_SUCCESS)
+        {
+            break;
+        }
+        memcpy(&value, payload, sizeof(value));
+        bplib_ackpayload(receiver, payload);
+        ut_assert(value >= 0 && value < UT_DEDUP_BUNDLES && !seen[value], "Accepted payload %d again\n", value);
+        if (value >= 0 && value < UT_DEDUP_BUNDLES)
+        {
+            seen[value] = true;
+        }
+        accepted++;
+    }
+    ut_assert(accepted == UT_DEDUP_BUNDLES, "Accepted %d payloads\n", accepted);
+
+    bplib_latchstats(receiver, &stats);
+    ut_assert(stats.received_bundles == UT_DEDUP_BUNDLES, "Received %u bundles\n",
+              (unsigned)stats.received_bundles);
+    ut_assert(stats.duplicate_bundles == UT_DEDUP_BUNDLES * (UT_DEDUP_THREADS - 1), "Dropped %u duplicates\n",
+              (unsigned)stats.duplicate_bundles);
+
+    for (i = 0; i < UT_DEDUP_BUNDLES; i++)
+    {
+        free(bundles[i]);
+    }
+    bplib_close(receiver);
+    bplib_close(sender);
+}
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+int ut_dedup(void)
+{
+    ut_reset();
+
+    test_1();
+    test_2();
+    test_3();
+    test_4();
+
+    return ut_failures();
+}
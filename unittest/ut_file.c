@@ -0,0 +1,458 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "ut_assert.h"
+#include "bplib_store_file.h"
+
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+#define UT_FILE_ROOT     ".ut_file"
+#define UT_FILE_SEGMENT  4
+#define UT_FILE_SERVICE  7
+#define UT_FILE_MAX_READ 64
+#define UT_FILE_OBJECTS  (UT_FILE_SEGMENT * 4 + 2)
+#define UT_FILE_TIMEOUT  1000
+
+/******************************************************************************
+ TYPEDEFS
+ ******************************************************************************/
+
+/* Work Done by a Store Before It Is Reset */
+typedef bool (*ut_file_work_t)(bp_handle_t h);
+
+/* Store Attributes Exercised Together */
+typedef struct
+{
+    const char    *name;
+    bp_file_attr_t attr;
+} ut_file_combo_t;
+
+/******************************************************************************
+ FILE DATA
+ ******************************************************************************/
+
+/* Enqueue Timeout - waits for room in the write behind queue and for group commits */
+static int file_timeout = BP_CHECK;
+
+static ut_file_combo_t file_combos[] = {
+    {"Write Through", {.flush_on_write = true}},
+    {"Mapped Reads", {.flush_on_write = true, .map_segments = true}},
+    {"Group Commit", {.commit_count = 3, .commit_period = 10}},
+    {"Write Behind", {.write_behind = true, .write_behind_depth = 4, .commit_count = 2, .commit_period = 10}},
+    {"Compaction", {.flush_on_write = true, .compact_threshold = 50}},
+    {"LRU Cache and Prefetch", {.flush_on_write = true, .cache_size = 4, .prefetch_count = 2}},
+    {"Mapped Compacted Cache", {.map_segments = true, .compact_threshold = 50, .cache_size = 4, .prefetch_count = 2}},
+    {"Mapped Write Behind", {.map_segments = true, .write_behind = true, .commit_count = 4, .compact_threshold = 50}},
+};
+
+/******************************************************************************
+ LOCAL FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * file_reset_root - removes files left by earlier tests
+ *--------------------------------------------------------------------------------------*/
+static void file_reset_root(void)
+{
+    int status = system("rm -rf " UT_FILE_ROOT " && mkdir -p " UT_FILE_ROOT);
+    ut_assert(status == 0, "Failed to reset %s\n", UT_FILE_ROOT);
+}
+
+/*--------------------------------------------------------------------------------------
+ * file_fill - enqueues objects holding the values first to first + count - 1
+ *--------------------------------------------------------------------------------------*/
+static bool file_fill(bp_handle_t h, int first, int count)
+{
+    int i;
+    for (i = first; i < first + count; i++)
+    {
+        if (bplib_store_file_enqueue(h, &i, sizeof(i), NULL, 0, file_timeout) != BP_SUCCESS)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*--------------------------------------------------------------------------------------
+ * file_drain - dequeues objects until none are left, relinquishing the first
+ *  relinquish of them, and returns how many were read or -1 on an error
+ *
+ *  values - the value of each object read, up to UT_FILE_MAX_READ
+ *--------------------------------------------------------------------------------------*/
+static int file_drain(bp_handle_t h, int relinquish, int *values)
+{
+    bp_object_t *object;
+    int          count = 0;
+    int          status;
+
+    while ((status = bplib_store_file_dequeue(h, &object, BP_CHECK)) == BP_SUCCESS)
+    {
+        bp_sid_t sid = object->header.sid;
+        if (values != NULL && count < UT_FILE_MAX_READ)
+        {
+            memcpy(&values[count], object->data, sizeof(int));
+        }
+        bplib_store_file_release(h, sid);
+        if (count < relinquish && bplib_store_file_relinquish(h, sid) != BP_SUCCESS)
+        {
+            return -1;
+        }
+        count++;
+    }
+
+    return status == BP_TIMEOUT ? count : -1;
+}
+
+/*--------------------------------------------------------------------------------------
+ * file_crash - runs work on a recoverable store in a child process that exits without
+ *  destroying the store, as though it were reset
+ *--------------------------------------------------------------------------------------*/
+static bool file_crash(bp_file_attr_t *attr, ut_file_work_t work)
+{
+    int   wstatus = 0;
+    pid_t pid     = fork();
+    if (pid == 0)
+    {
+        bp_handle_t h = bplib_store_file_create(0, 1, UT_FILE_SERVICE, true, attr);
+        _exit(bp_handle_is_valid(h) && work(h) ? 0 : 1);
+    }
+
+    return pid > 0 && waitpid(pid, &wstatus, 0) == pid && WIFEXITED(wstatus) && WEXITSTATUS(wstatus) == 0;
+}
+
+/*--------------------------------------------------------------------------------------
+ * file_dequeue_all - dequeues every object, checking they come out in the order enqueued
+ *--------------------------------------------------------------------------------------*/
+static bool file_dequeue_all(bp_handle_t h, int count, bp_sid_t *sids)
+{
+    bp_object_t *object;
+    int          value;
+    int          i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (bplib_store_file_dequeue(h, &object, BP_CHECK) != BP_SUCCESS)
+        {
+            return false;
+        }
+        sids[i] = object->header.sid;
+        memcpy(&value, object->data, sizeof(value));
+        bool ok = value == i && object->header.size == sizeof(value);
+        bplib_store_file_release(h, sids[i]);
+        if (!ok)
+        {
+            return false;
+        }
+    }
+
+    return bplib_store_file_dequeue(h, &object, BP_CHECK) == BP_TIMEOUT;
+}
+
+/*--------------------------------------------------------------------------------------
+ * file_retrieve - retrieves the object stored under sid and checks its value
+ *--------------------------------------------------------------------------------------*/
+static bool file_retrieve(bp_handle_t h, bp_sid_t sid, int expected)
+{
+    bp_object_t *object;
+    int          value;
+
+    if (bplib_store_file_retrieve(h, sid, &object, BP_CHECK) != BP_SUCCESS)
+    {
+        return false;
+    }
+    memcpy(&value, object->data, sizeof(value));
+    bplib_store_file_release(h, sid);
+
+    return value == expected;
+}
+
+/*--------------------------------------------------------------------------------------
+ * file_check_odd - checks values read back hold every odd object in order
+ *  a reset may also return even objects whose relinquishment was not yet saved
+ *--------------------------------------------------------------------------------------*/
+static bool file_check_odd(const int *values, int count)
+{
+    int next_odd = 1;
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (i > 0 && values[i] <= values[i - 1])
+        {
+            return false;
+        }
+        if (values[i] == next_odd)
+        {
+            next_odd += 2;
+        }
+    }
+
+    return next_odd > UT_FILE_OBJECTS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * Work Done Before Resets
+ *--------------------------------------------------------------------------------------*/
+static bool work_relinquish_all(bp_handle_t h)
+{
+    return file_fill(h, 0, UT_FILE_SEGMENT * 2) && file_drain(h, UT_FILE_SEGMENT * 2, NULL) == UT_FILE_SEGMENT * 2;
+}
+
+static bool work_relinquish_partial(bp_handle_t h)
+{
+    return file_fill(h, 0, 10) && file_drain(h, 10, NULL) == 10;
+}
+
+static bool work_relinquish_some(bp_handle_t h)
+{
+    return file_fill(h, 0, 10) && file_drain(h, 5, NULL) == 10;
+}
+
+static bool work_relinquish_even(bp_handle_t h)
+{
+    bp_sid_t sids[UT_FILE_OBJECTS];
+    int      i;
+
+    if (!file_fill(h, 0, UT_FILE_OBJECTS) || !file_dequeue_all(h, UT_FILE_OBJECTS, sids))
+    {
+        return false;
+    }
+    for (i = 0; i < UT_FILE_OBJECTS; i += 2)
+    {
+        if (bplib_store_file_relinquish(h, sids[i]) != BP_SUCCESS)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/******************************************************************************
+ TEST FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * Test #1
+ *--------------------------------------------------------------------------------------*/
+static void test_1(void)
+{
+    bp_file_attr_t attr = {.root_path = UT_FILE_ROOT, .flush_on_write = true, .segment_size = UT_FILE_SEGMENT};
+    bp_handle_t    h;
+    int            values[UT_FILE_MAX_READ];
+    int            count;
+
+    printf("\n==== Test 1: Crash After Relinquishing Whole Segments ====\n");
+
+    printf("\n==== Step 1.1: Every Segment Deleted ====\n");
+    file_reset_root();
+    ut_assert(file_crash(&attr, work_relinquish_all), "Store failed before reset\n");
+    h = bplib_store_file_create(0, 1, UT_FILE_SERVICE, true, &attr);
+    ut_assert(bp_handle_is_valid(h), "Failed to recover store\n");
+    ut_assert(bplib_store_file_getcount(h) == 0, "Recovered %d objects\n", bplib_store_file_getcount(h));
+    ut_assert(file_drain(h, 0, NULL) == 0, "Dequeued relinquished objects\n");
+    ut_assert(file_fill(h, 100, 1), "Failed to enqueue after recovery\n");
+    ut_assert(file_drain(h, 1, values) == 1 && values[0] == 100, "Failed to dequeue new object\n");
+    bplib_store_file_destroy(h);
+
+    printf("\n==== Step 1.2: Segments Deleted Ahead of Partly Relinquished Segment ====\n");
+    file_reset_root();
+    ut_assert(file_crash(&attr, work_relinquish_partial), "Store failed before reset\n");
+    h = bplib_store_file_create(0, 1, UT_FILE_SERVICE, true, &attr);
+    ut_assert(bp_handle_is_valid(h), "Failed to recover store\n");
+    count = bplib_store_file_getcount(h);
+    ut_assert(count <= 2, "Recovered %d objects, at most 2 remain\n", count);
+    ut_assert(file_drain(h, count, values) == count, "Failed to dequeue %d recovered objects\n", count);
+    ut_assert(count == 0 || values[0] == 10 - count, "Recovered object %d that was deleted\n", values[0]);
+    ut_assert(file_fill(h, 100, 1), "Failed to enqueue after recovery\n");
+    ut_assert(file_drain(h, 1, values) == 1 && values[0] == 100, "Failed to dequeue new object\n");
+    ut_assert(bplib_store_file_getcount(h) == 0, "Count %d after relinquishing all\n", bplib_store_file_getcount(h));
+    bplib_store_file_destroy(h);
+
+    printf("\n==== Step 1.3: Objects Left Unacknowledged ====\n");
+    file_reset_root();
+    ut_assert(file_crash(&attr, work_relinquish_some), "Store failed before reset\n");
+    h = bplib_store_file_create(0, 1, UT_FILE_SERVICE, true, &attr);
+    ut_assert(bp_handle_is_valid(h), "Failed to recover store\n");
+    count = bplib_store_file_getcount(h);
+    ut_assert(count >= 5 && count <= 6, "Recovered %d objects, expected 5 unacknowledged\n", count);
+    ut_assert(file_drain(h, count, values) == count, "Failed to dequeue %d recovered objects\n", count);
+    ut_assert(values[count - 1] == 9 && values[count - 5] == 5, "Recovered objects out of order\n");
+    ut_assert(bplib_store_file_getcount(h) == 0, "Count %d after relinquishing all\n", bplib_store_file_getcount(h));
+    bplib_store_file_destroy(h);
+
+    file_reset_root();
+}
+
+/*--------------------------------------------------------------------------------------
+ * Test #2
+ *--------------------------------------------------------------------------------------*/
+static void test_2(void)
+{
+    bp_sid_t        sids[UT_FILE_OBJECTS];
+    int             values[UT_FILE_MAX_READ];
+    bp_file_stats_t stats;
+    bp_handle_t     h;
+    int             count;
+    int             c, i;
+
+    printf("\n==== Test 2: Attribute Combinations With Recovery After Destroy ====\n");
+
+    for (c = 0; c < (int)(sizeof(file_combos) / sizeof(file_combos[0])); c++)
+    {
+        bp_file_attr_t attr = file_combos[c].attr;
+        attr.root_path      = UT_FILE_ROOT;
+        attr.segment_size   = UT_FILE_SEGMENT;
+
+        printf("\n==== Step 2.%d: %s ====\n", c + 1, file_combos[c].name);
+        file_reset_root();
+        file_timeout = UT_FILE_TIMEOUT;
+        h = bplib_store_file_create(0, 1, UT_FILE_SERVICE, true, &attr);
+        ut_assert(bp_handle_is_valid(h), "Failed to create store\n");
+        if (!bp_handle_is_valid(h))
+        {
+            continue;
+        }
+
+        /* Enqueue, Dequeue, and Relinquish Every Other Object */
+        ut_assert(file_fill(h, 0, UT_FILE_OBJECTS), "Failed to enqueue objects\n");
+        file_timeout = BP_CHECK;
+        ut_assert(bplib_store_file_getcount(h) == UT_FILE_OBJECTS, "Count %d after enqueue\n",
+                  bplib_store_file_getcount(h));
+        ut_assert(file_dequeue_all(h, UT_FILE_OBJECTS, sids), "Failed to dequeue objects in order\n");
+        for (i = 0; i < UT_FILE_OBJECTS; i += 2)
+        {
+            ut_assert(bplib_store_file_relinquish(h, sids[i]) == BP_SUCCESS, "Failed to relinquish %d\n", i);
+        }
+        ut_assert(bplib_store_file_relinquish(h, sids[0]) == BP_SUCCESS, "Failed second relinquish of 0\n");
+        ut_assert(bplib_store_file_getcount(h) == UT_FILE_OBJECTS / 2, "Count %d after relinquish\n",
+                  bplib_store_file_getcount(h));
+
+        /* Retrieve Remaining Objects - twice so the second pass can be served from the cache */
+        bplib_store_file_stats(h, NULL, false, true);
+        for (i = 1; i < UT_FILE_OBJECTS; i += 2)
+        {
+            ut_assert(file_retrieve(h, sids[i], i), "Failed to retrieve %d\n", i);
+            ut_assert(file_retrieve(h, sids[i], i), "Failed to retrieve %d again\n", i);
+        }
+        bplib_store_file_stats(h, &stats, false, false);
+        ut_assert(stats.hits >= UT_FILE_OBJECTS / 2, "Only %lu cache hits\n", stats.hits);
+        ut_assert(attr.prefetch_count == 0 || attr.map_segments || stats.prefetches > 0, "No objects prefetched\n");
+        ut_assert(attr.cache_size == 0 || stats.cached_objects <= attr.cache_size, "Cached %d objects\n",
+                  stats.cached_objects);
+        ut_assert(attr.cache_size == 0 || stats.evictions > 0, "No objects evicted from cache\n");
+        bplib_store_file_destroy(h);
+
+        /* Recover Remaining Objects */
+        h = bplib_store_file_create(0, 1, UT_FILE_SERVICE, true, &attr);
+        ut_assert(bp_handle_is_valid(h), "Failed to recover store\n");
+        if (!bp_handle_is_valid(h))
+        {
+            continue;
+        }
+        count = bplib_store_file_getcount(h);
+        ut_assert(count == UT_FILE_OBJECTS / 2, "Recovered %d objects\n", count);
+        ut_assert(file_drain(h, UT_FILE_OBJECTS, values) == count, "Failed to dequeue recovered objects\n");
+        ut_assert(file_check_odd(values, count), "Recovered objects are wrong or out of order\n");
+        ut_assert(bplib_store_file_getcount(h) == 0, "Count %d after relinquishing all\n",
+                  bplib_store_file_getcount(h));
+
+        /* Store Keeps Working After Recovery */
+        ut_assert(file_fill(h, 100, 1), "Failed to enqueue after recovery\n");
+        ut_assert(file_drain(h, 1, values) == 1 && values[0] == 100, "Failed to dequeue new object\n");
+        bplib_store_file_destroy(h);
+    }
+
+    file_reset_root();
+}
+
+/*--------------------------------------------------------------------------------------
+ * Test #3
+ *--------------------------------------------------------------------------------------*/
+static void test_3(void)
+{
+    int         values[UT_FILE_MAX_READ];
+    bp_handle_t h;
+    int         count;
+    int         c;
+
+    printf("\n==== Test 3: Attribute Combinations With Recovery After Reset ====\n");
+
+    for (c = 0; c < (int)(sizeof(file_combos) / sizeof(file_combos[0])); c++)
+    {
+        bp_file_attr_t attr = file_combos[c].attr;
+        attr.root_path      = UT_FILE_ROOT;
+        attr.segment_size   = UT_FILE_SEGMENT;
+
+        /* Objects in the write behind queue are not committed before enqueue returns */
+        if (attr.write_behind)
+        {
+            continue;
+        }
+
+        printf("\n==== Step 3.%d: %s ====\n", c + 1, file_combos[c].name);
+        file_reset_root();
+        file_timeout = UT_FILE_TIMEOUT;
+        ut_assert(file_crash(&attr, work_relinquish_even), "Store failed before reset\n");
+        file_timeout = BP_CHECK;
+
+        h = bplib_store_file_create(0, 1, UT_FILE_SERVICE, true, &attr);
+        ut_assert(bp_handle_is_valid(h), "Failed to recover store\n");
+        if (!bp_handle_is_valid(h))
+        {
+            continue;
+        }
+        count = bplib_store_file_getcount(h);
+        ut_assert(count >= UT_FILE_OBJECTS / 2, "Recovered only %d objects\n", count);
+        ut_assert(file_drain(h, UT_FILE_OBJECTS, values) == count, "Failed to dequeue recovered objects\n");
+        ut_assert(file_check_odd(values, count), "Recovered objects are missing or out of order\n");
+        ut_assert(bplib_store_file_getcount(h) == 0, "Count %d after relinquishing all\n",
+                  bplib_store_file_getcount(h));
+        bplib_store_file_destroy(h);
+    }
+
+    file_reset_root();
+}
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+int ut_file(void)
+{
+    ut_reset();
+
+    test_1();
+    test_2();
+    test_3();
+
+    return ut_failures();
+}
@@ -38,6 +38,9 @@
 
 #define TEST_DATA_SIZE (TEST_PAGE_DATA_SIZE * 3 + 200)
 #define NUM_BUNDLES    200
+#define SMALL_SIZE     100
+#define WEAR_CYCLES    1000
+#define CACHED_BUNDLES (FLASH_SID_CACHE_SIZE / 4)
 
 /******************************************************************************
  EXTERNAL PROTOTYPES
@@ -45,8 +48,8 @@
 
 extern int flash_free_reclaim(bp_flash_index_t block);
 extern int flash_free_allocate(bp_flash_index_t *block);
-extern int flash_data_write(bp_flash_addr_t *addr, uint8_t *data, int size);
-extern int flash_data_read(bp_flash_addr_t *addr, uint8_t *data, int size);
+extern int flash_data_write(uint8_t *page_buffer, bp_flash_addr_t *addr, uint8_t *data, int size);
+extern int flash_data_read(uint8_t *page_buffer, bp_flash_addr_t *addr, uint8_t *data, int size);
 
 /******************************************************************************
  FILE DATA
@@ -62,6 +65,7 @@ static bp_flash_driver_t flash_driver = {.num_blocks      = FLASH_SIM_NUM_BLOCKS
                                          .phyblk          = bplib_flash_sim_physical_block};
 
 static uint8_t test_data[TEST_DATA_SIZE], read_data[TEST_DATA_SIZE];
+static uint8_t page_buffer[FLASH_SIM_PAGE_SIZE];
 
 /******************************************************************************
  TEST FUNCTIONS
@@ -186,14 +190,14 @@ static void test_3(void)
     {
         bp_flash_index_t saved_block = addr.block;
         addr.page                    = 0;
-        status                       = flash_data_write(&addr, test_data, TEST_DATA_SIZE);
+        status                       = flash_data_write(page_buffer, &addr, test_data, TEST_DATA_SIZE);
         ut_assert(status == BP_SUCCESS, "Failed to write data: %d\n", status);
         ut_assert(addr.page > 0, "Failed to increment page number: %d\n", addr.page);
 
         /* Read Test Data */
         addr.block = saved_block;
         addr.page  = 0;
-        status     = flash_data_read(&addr, read_data, TEST_DATA_SIZE);
+        status     = flash_data_read(page_buffer, &addr, read_data, TEST_DATA_SIZE);
         ut_assert(status == BP_SUCCESS, "Failed to write data: %d\n", status);
         ut_assert(addr.page > 0, "Failed to increment page number: %d\n", addr.page);
         for (i = 0; i < TEST_DATA_SIZE; i++)
@@ -416,6 +420,210 @@ static void test_6(void)
     bplib_store_flash_uninit();
 }
 
+/*--------------------------------------------------------------------------------------
+ * Test #7
+ *--------------------------------------------------------------------------------------*/
+static void test_7(void)
+{
+    int              i, b;
+    bp_handle_t      h;
+    bp_sid_t         sids[NUM_BUNDLES];
+    bp_flash_stats_t stats;
+
+    printf("\n==== Test 7: Write Combining ====\n");
+
+    /* Initialize Driver */
+    int reclaimed_blocks = bplib_store_flash_init(flash_driver, true);
+    ut_assert(reclaimed_blocks == 256, "Failed to reclaim all blocks\n");
+
+    /* Initialize Test Data */
+    for (i = 0; i < TEST_DATA_SIZE; i++)
+    {
+        test_data[i] = i % 0xFF;
+    }
+
+    /* Create Storage Service */
+    bp_flash_attr_t attr = {.max_data_size = TEST_DATA_SIZE, .write_combine = true};
+    h                    = bplib_store_flash_create(0, 0, 0, false, &attr);
+    ut_assert(bp_handle_is_valid(h), "Failed to create storage service\n");
+
+    printf("\n==== Step 7.1: Enqueue Small and Large Objects ====\n");
+    bplib_store_flash_stats(NULL, false, true);
+    for (b = 0; b < NUM_BUNDLES; b++)
+    {
+        int size = (b % 50 == 49) ? TEST_DATA_SIZE : SMALL_SIZE + b;
+        test_data[0] = (uint8_t)b;
+        ut_assert(bplib_store_flash_enqueue(h, test_data, size, NULL, 0, BP_CHECK) == BP_SUCCESS,
+                  "Failed to enqueue test data\n");
+    }
+    bplib_store_flash_stats(&stats, false, false);
+    ut_assert(stats.page_writes < NUM_BUNDLES / 2, "Failed to combine page writes: %d\n", stats.page_writes);
+
+    printf("\n==== Step 7.2: Dequeue and Retrieve ====\n");
+    for (b = 0; b < NUM_BUNDLES; b++)
+    {
+        int          size   = (b % 50 == 49) ? TEST_DATA_SIZE : SMALL_SIZE + b;
+        bp_object_t *object = NULL;
+        ut_assert(bplib_store_flash_dequeue(h, &object, BP_CHECK) == BP_SUCCESS, "Failed to dequeue test data\n");
+        if (object == NULL)
+        {
+            break;
+        }
+        ut_assert(object->header.size == (size_t)size, "Incorrect size in dequeued object %d: %d != %d\n", b,
+                  (int)object->header.size, size);
+        ut_assert((uint8_t)object->data[0] == (uint8_t)b, "Dequeued object %d out of order\n", b);
+        ut_assert((uint8_t)object->data[size - 1] == test_data[size - 1], "Failed to dequeue correct data\n");
+        sids[b] = object->header.sid;
+        bplib_store_flash_release(h, sids[b]);
+    }
+    ut_assert(bplib_store_flash_dequeue(h, &(bp_object_t *){NULL}, BP_CHECK) == BP_TIMEOUT,
+              "Failed to detect empty store\n");
+    for (b = 0; b < NUM_BUNDLES; b += 7)
+    {
+        bp_object_t *object = NULL;
+        ut_assert(bplib_store_flash_retrieve(h, sids[b], &object, BP_CHECK) == BP_SUCCESS,
+                  "Failed to retrieve object %d\n", b);
+        if (object != NULL)
+        {
+            ut_assert((uint8_t)object->data[0] == (uint8_t)b, "Retrieved wrong object for %d\n", b);
+            bplib_store_flash_release(h, sids[b]);
+        }
+    }
+
+    printf("\n==== Step 7.3: Relinquish Out of Order ====\n");
+    for (b = 1; b < NUM_BUNDLES; b += 2)
+    {
+        ut_assert(bplib_store_flash_relinquish(h, sids[b]) == BP_SUCCESS, "Failed to relinquish object %d\n", b);
+    }
+    for (b = 0; b < NUM_BUNDLES; b += 2)
+    {
+        ut_assert(bplib_store_flash_relinquish(h, sids[b]) == BP_SUCCESS, "Failed to relinquish object %d\n", b);
+    }
+    ut_assert(bplib_store_flash_getcount(h) == 0, "Failed to relinquish all objects\n");
+    bplib_store_flash_stats(&stats, false, false);
+    ut_assert(stats.num_used_blocks == 1, "Failed to reclaim blocks: %d in use\n", stats.num_used_blocks);
+
+    /* Destroy Storage Service */
+    bplib_store_flash_destroy(h);
+
+    /* Uninitialize Driver */
+    bplib_store_flash_uninit();
+}
+
+/*--------------------------------------------------------------------------------------
+ * Test #8
+ *--------------------------------------------------------------------------------------*/
+static void test_8(void)
+{
+    int              i;
+    bp_flash_index_t block;
+    bp_flash_stats_t stats;
+
+    printf("\n==== Test 8: Wear Leveling ====\n");
+
+    int reclaimed_blocks = bplib_store_flash_init(flash_driver, false);
+    ut_assert(reclaimed_blocks == 256, "Failed to reclaim all blocks\n");
+
+    printf("\n==== Step 8.1: Cycle Single Block ====\n");
+    for (i = 0; i < WEAR_CYCLES; i++)
+    {
+        ut_assert(flash_free_allocate(&block) == BP_SUCCESS, "Failed to allocate block on %dth iteration\n", i);
+        ut_assert(flash_free_reclaim(block) == BP_SUCCESS, "Failed to reclaim block\n");
+    }
+
+    printf("\n==== Step 8.2: Check Erases Spread Across Blocks ====\n");
+    bplib_store_flash_stats(&stats, false, false);
+    ut_assert(stats.num_used_blocks == 0, "Failed to reclaim all blocks: %d in use\n", stats.num_used_blocks);
+    ut_assert(stats.num_free_blocks == 256, "Failed to return all blocks: %d free\n", stats.num_free_blocks);
+    ut_assert(stats.min_erase_count >= WEAR_CYCLES / 256, "Failed to erase every block: minimum %d erases\n",
+              stats.min_erase_count);
+    ut_assert(stats.max_erase_count - stats.min_erase_count <= 2, "Failed to level wear: %d to %d erases\n",
+              stats.min_erase_count, stats.max_erase_count);
+
+    /* Uninitialize Driver */
+    bplib_store_flash_uninit();
+}
+
+/*--------------------------------------------------------------------------------------
+ * Test #9
+ *--------------------------------------------------------------------------------------*/
+static void test_9(void)
+{
+    int              i, b;
+    bp_handle_t      h;
+    bp_sid_t         sids[NUM_BUNDLES];
+    bp_flash_stats_t stats;
+
+    printf("\n==== Test 9: SID Cache ====\n");
+
+    /* Initialize Driver */
+    int reclaimed_blocks = bplib_store_flash_init(flash_driver, true);
+    ut_assert(reclaimed_blocks == 256, "Failed to reclaim all blocks\n");
+
+    /* Initialize Test Data */
+    for (i = 0; i < TEST_DATA_SIZE; i++)
+    {
+        test_data[i] = i % 0xFF;
+    }
+
+    /* Create Storage Service */
+    bp_flash_attr_t attr = {.max_data_size = TEST_DATA_SIZE, .write_combine = true};
+    h                    = bplib_store_flash_create(0, 0, 0, false, &attr);
+    ut_assert(bp_handle_is_valid(h), "Failed to create storage service\n");
+
+    printf("\n==== Step 9.1: Enqueue and Dequeue ====\n");
+    for (b = 0; b < CACHED_BUNDLES; b++)
+    {
+        int size = (b % 4 == 3) ? TEST_DATA_SIZE : SMALL_SIZE + b;
+        test_data[0] = (uint8_t)b;
+        ut_assert(bplib_store_flash_enqueue(h, test_data, size, NULL, 0, BP_CHECK) == BP_SUCCESS,
+                  "Failed to enqueue test data\n");
+    }
+    for (b = 0; b < CACHED_BUNDLES; b++)
+    {
+        bp_object_t *object = NULL;
+        ut_assert(bplib_store_flash_dequeue(h, &object, BP_CHECK) == BP_SUCCESS, "Failed to dequeue test data\n");
+        if (object == NULL)
+        {
+            break;
+        }
+        sids[b] = object->header.sid;
+        bplib_store_flash_release(h, sids[b]);
+    }
+
+    printf("\n==== Step 9.2: Retrieve Cached Objects ====\n");
+    for (b = 0; b < CACHED_BUNDLES; b += 5)
+    {
+        int          size   = (b % 4 == 3) ? TEST_DATA_SIZE : SMALL_SIZE + b;
+        bp_object_t *object = NULL;
+        ut_assert(bplib_store_flash_retrieve(h, sids[b], &object, BP_CHECK) == BP_SUCCESS,
+                  "Failed to retrieve object %d\n", b);
+        if (object != NULL)
+        {
+            ut_assert(object->header.size == (size_t)size, "Incorrect size in retrieved object %d: %d != %d\n", b,
+                      (int)object->header.size, size);
+            ut_assert((uint8_t)object->data[0] == (uint8_t)b, "Retrieved wrong object for %d\n", b);
+            bplib_store_flash_release(h, sids[b]);
+        }
+    }
+
+    printf("\n==== Step 9.3: Relinquish Without Reading Flash ====\n");
+    bplib_store_flash_stats(NULL, false, true);
+    for (b = CACHED_BUNDLES - 1; b >= 0; b--)
+    {
+        ut_assert(bplib_store_flash_relinquish(h, sids[b]) == BP_SUCCESS, "Failed to relinquish object %d\n", b);
+    }
+    ut_assert(bplib_store_flash_getcount(h) == 0, "Failed to relinquish all objects\n");
+    bplib_store_flash_stats(&stats, false, false);
+    ut_assert(stats.page_reads == 0, "Failed to relinquish from cache: %d pages read\n", stats.page_reads);
+
+    /* Destroy Storage Service */
+    bplib_store_flash_destroy(h);
+
+    /* Uninitialize Driver */
+    bplib_store_flash_uninit();
+}
+
 /******************************************************************************
  EXPORTED FUNCTIONS
  ******************************************************************************/
@@ -436,6 +644,9 @@ int ut_flash(void)
     test_4();
     test_5();
     test_6();
+    test_7();
+    test_8();
+    test_9();
 
     /* Clean Up */
 
@@ -0,0 +1,214 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "ut_assert.h"
+#include "lrc.h"
+
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+#define UT_LRC_MAX_FRAME   2048
+#define UT_LRC_BLOCK_SIZE  7
+#define UT_LRC_ITERATIONS  200
+
+/******************************************************************************
+ HELPER FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * random_fill - fills a buffer with pseudo-random bytes
+ *--------------------------------------------------------------------------------------*/
+static void random_fill(uint32_t *x, uint8_t *buffer, int size)
+{
+    int i;
+
+    for (i = 0; i < size; i++)
+    {
+        *x        = (*x * 1103515245) + 12345;
+        buffer[i] = (uint8_t)(*x >> 16);
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * parity - returns one when a byte has an odd number of bits set
+ *--------------------------------------------------------------------------------------*/
+static uint8_t parity(uint8_t byte)
+{
+    uint8_t p = 0;
+
+    while (byte)
+    {
+        p ^= byte & 1;
+        byte >>= 1;
+    }
+
+    return p;
+}
+
+/*--------------------------------------------------------------------------------------
+ * reference_encode - encodes a frame one bit at a time
+ *--------------------------------------------------------------------------------------*/
+static void reference_encode(uint8_t *frame, int data_size)
+{
+    int data_index = 0;
+    int ecc_index  = data_size;
+
+    while (data_index < data_size)
+    {
+        uint8_t col = 0;
+        uint8_t row = 0;
+        int     i;
+
+        for (i = 0; i < UT_LRC_BLOCK_SIZE && data_index + i < data_size; i++)
+        {
+            col ^= frame[data_index + i];
+            row |= parity(frame[data_index + i]) << i;
+        }
+        row |= parity(col) << i;
+
+        frame[ecc_index++] = col;
+        frame[ecc_index++] = row;
+        data_index += UT_LRC_BLOCK_SIZE;
+    }
+}
+
+/******************************************************************************
+ TEST FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * Test #1
+ *--------------------------------------------------------------------------------------*/
+static void test_1(void)
+{
+    uint8_t  frame[UT_LRC_MAX_FRAME];
+    uint8_t  expected[UT_LRC_MAX_FRAME];
+    uint32_t x = 0x2468ACE1;
+    int      frame_size;
+
+    printf("\n==== Test 1: Codes Match Reference ====\n");
+
+    /* Every Frame Size up to a Few Pairs of Blocks, then Typical Page Sizes */
+    for (frame_size = 9; frame_size <= UT_LRC_MAX_FRAME; frame_size += (frame_size < 128 ? 1 : 127))
+    {
+        int data_size = lrc_init(frame_size);
+        ut_assert(data_size < frame_size, "Failed to initialize frame of %d\n", frame_size);
+
+        random_fill(&x, frame, frame_size);
+        memcpy(expected, frame, frame_size);
+        reference_encode(expected, data_size);
+        lrc_encode(frame, data_size);
+        ut_assert(memcmp(frame, expected, frame_size) == 0, "Codes of frame of %d differ from reference\n",
+                  frame_size);
+        ut_assert(lrc_decode(frame, data_size) == BP_ECC_NO_ERRORS, "Failed to decode frame of %d\n", frame_size);
+        ut_assert(memcmp(frame, expected, frame_size) == 0, "Decode changed frame of %d\n", frame_size);
+
+        lrc_uninit();
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * Test #2
+ *--------------------------------------------------------------------------------------*/
+static void test_2(void)
+{
+    uint8_t  frame[UT_LRC_MAX_FRAME];
+    uint8_t  expected[UT_LRC_MAX_FRAME];
+    uint32_t x          = 0x1357FDB9;
+    int      frame_size = 517; /* leaves a partial block at the end */
+    int      data_size  = lrc_init(frame_size);
+    int      i;
+
+    printf("\n==== Test 2: Single Bit Errors ====\n");
+
+    for (i = 0; i < UT_LRC_ITERATIONS; i++)
+    {
+        random_fill(&x, frame, data_size);
+        lrc_encode(frame, data_size);
+        memcpy(expected, frame, frame_size);
+
+        /* Error in Data */
+        x = (x * 1103515245) + 12345;
+        int bit = (int)((x >> 8) % (uint32_t)(data_size * 8));
+        frame[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+        ut_assert(lrc_decode(frame, data_size) == BP_ECC_COR_ERRORS, "Failed to detect error in bit %d\n", bit);
+        ut_assert(memcmp(frame, expected, frame_size) == 0, "Failed to correct error in bit %d\n", bit);
+
+        /* Error in Row Code */
+        x = (x * 1103515245) + 12345;
+        int code = data_size + 1 + (2 * (int)((x >> 8) % (uint32_t)((frame_size - data_size) / 2)));
+        frame[code] ^= 0x01;
+        ut_assert(lrc_decode(frame, data_size) == BP_ECC_COR_ERRORS, "Failed to detect error in code %d\n", code);
+        ut_assert(memcmp(frame, expected, data_size) == 0, "Changed data for error in code %d\n", code);
+        frame[code] ^= 0x01;
+    }
+
+    lrc_uninit();
+}
+
+/*--------------------------------------------------------------------------------------
+ * Test #3
+ *--------------------------------------------------------------------------------------*/
+static void test_3(void)
+{
+    uint8_t  frame[UT_LRC_MAX_FRAME];
+    uint32_t x          = 0xC0FFEE11;
+    int      frame_size = 2048;
+    int      data_size  = lrc_init(frame_size);
+    int      block;
+
+    printf("\n==== Test 3: Double Bit Errors ====\n");
+
+    for (block = 0; block < data_size / UT_LRC_BLOCK_SIZE; block++)
+    {
+        random_fill(&x, frame, data_size);
+        lrc_encode(frame, data_size);
+
+        /* Two Errors in One Byte Cannot be Located */
+        int byte = (block * UT_LRC_BLOCK_SIZE) + (block % UT_LRC_BLOCK_SIZE);
+        frame[byte] ^= 0x11;
+        ut_assert(lrc_decode(frame, data_size) == BP_ECC_UNCOR_ERRORS, "Failed to detect errors in block %d\n",
+                  block);
+    }
+
+    lrc_uninit();
+}
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+int ut_lrc(void)
+{
+    ut_reset();
+
+    test_1();
+    test_2();
+    test_3();
+
+    return ut_failures();
+}
@@ -0,0 +1,155 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "ut_assert.h"
+#include "bplib_lz.h"
+
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+#define UT_LZ_BUF_SIZE 80000 /* larger than the maximum match offset */
+
+/******************************************************************************
+ FILE DATA
+ ******************************************************************************/
+
+static uint8_t src[UT_LZ_BUF_SIZE];
+static uint8_t dst[UT_LZ_BUF_SIZE + (UT_LZ_BUF_SIZE / 255) + 16];
+static uint8_t out[UT_LZ_BUF_SIZE];
+
+/******************************************************************************
+ HELPER FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * round_trip - compresses and decompresses src, returning the compressed size
+ *--------------------------------------------------------------------------------------*/
+static int round_trip(int size)
+{
+    int csize = bplib_lz_compress(src, size, dst, sizeof(dst));
+    ut_assert(csize > 0, "Failed to compress %d bytes\n", size);
+
+    int rsize = bplib_lz_decompress(dst, csize, out, sizeof(out));
+    ut_assert(rsize == size, "Failed to decompress %d bytes: %d\n", size, rsize);
+    ut_assert(memcmp(src, out, size) == 0, "Decompressed data does not match for %d bytes\n", size);
+
+    return csize;
+}
+
+/******************************************************************************
+ TEST FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * Test #1
+ *--------------------------------------------------------------------------------------*/
+static void test_1(void)
+{
+    int sizes[] = {0, 1, 4, 12, 13, 64, 1000, UT_LZ_BUF_SIZE};
+    int i, j;
+
+    printf("\n==== Test 1: Round Trip ====\n");
+
+    /* Repeating Data */
+    for (i = 0; i < (int)(sizeof(sizes) / sizeof(sizes[0])); i++)
+    {
+        for (j = 0; j < sizes[i]; j++)
+        {
+            src[j] = (uint8_t)("telemetry 0123"[j % 14]);
+        }
+        int csize = round_trip(sizes[i]);
+        ut_assert(sizes[i] < 1000 || csize < sizes[i] / 4, "Failed to compress repeating data: %d\n", csize);
+    }
+
+    /* Incompressible Data */
+    uint32_t x = 0x12345678;
+    for (j = 0; j < UT_LZ_BUF_SIZE; j++)
+    {
+        x      = (x * 1103515245) + 12345;
+        src[j] = (uint8_t)(x >> 24);
+    }
+    round_trip(UT_LZ_BUF_SIZE);
+    ut_assert(bplib_lz_compress(src, UT_LZ_BUF_SIZE, dst, UT_LZ_BUF_SIZE) == 0,
+              "Failed to reject compressed data larger than buffer\n");
+}
+
+/*--------------------------------------------------------------------------------------
+ * Test #2
+ *--------------------------------------------------------------------------------------*/
+static void test_2(void)
+{
+    int j;
+
+    printf("\n==== Test 2: Malformed Data ====\n");
+
+    for (j = 0; j < 1000; j++)
+    {
+        src[j] = (uint8_t)(j % 10);
+    }
+    int csize = bplib_lz_compress(src, 1000, dst, sizeof(dst));
+    ut_assert(csize > 0, "Failed to compress data\n");
+
+    /* Output Too Small */
+    ut_assert(bplib_lz_decompress(dst, csize, out, 999) == BP_ERROR, "Failed to reject output buffer too small\n");
+
+    /* Truncated Input */
+    ut_assert(bplib_lz_decompress(dst, csize - 1, out, sizeof(out)) == BP_ERROR, "Failed to reject truncated data\n");
+
+    /* Offset Before Start of Output */
+    uint8_t bad_offset[] = {0x10, 'a', 0x05, 0x00};
+    ut_assert(bplib_lz_decompress(bad_offset, sizeof(bad_offset), out, sizeof(out)) == BP_ERROR,
+              "Failed to reject offset before start of data\n");
+
+    /* Zero Offset */
+    uint8_t zero_offset[] = {0x10, 'a', 0x00, 0x00};
+    ut_assert(bplib_lz_decompress(zero_offset, sizeof(zero_offset), out, sizeof(out)) == BP_ERROR,
+              "Failed to reject zero offset\n");
+
+    /* Corrupted Input Stays in Bounds */
+    for (j = 0; j < csize; j++)
+    {
+        uint8_t save = dst[j];
+        dst[j] ^= 0xA5;
+        int rsize = bplib_lz_decompress(dst, csize, out, 1000);
+        ut_assert(rsize == BP_ERROR || (rsize >= 0 && rsize <= 1000), "Corrupted data decompressed to %d\n", rsize);
+        dst[j] = save;
+    }
+}
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+int ut_lz(void)
+{
+    ut_reset();
+
+    test_1();
+    test_2();
+
+    return ut_failures();
+}
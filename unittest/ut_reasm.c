@@ -0,0 +1,195 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "ut_assert.h"
+#include "reasm.h"
+
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+#define UT_REASM_SLOTS      4
+#define UT_REASM_SLOT_SIZE  1024
+#define UT_REASM_MAX_RANGES 8
+
+/******************************************************************************
+ HELPER FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * pattern_fill - fills a buffer with bytes that depend on their offset
+ *--------------------------------------------------------------------------------------*/
+static void pattern_fill(uint8_t *buffer, int size)
+{
+    int i;
+
+    for (i = 0; i < size; i++)
+    {
+        buffer[i] = (uint8_t)((i * 31) + (i >> 8));
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * expired_before - expiration function that expires everything before a time
+ *--------------------------------------------------------------------------------------*/
+static bool expired_before(void *parm, bp_val_t exprtime)
+{
+    return exprtime < *(bp_val_t *)parm;
+}
+
+/******************************************************************************
+ TEST FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * Test #1
+ *--------------------------------------------------------------------------------------*/
+static void test_1(void)
+{
+    static const int order[] = {3, 0, 5, 1, 4, 2, 6}; /* out of order, last fragment completes */
+    reasm_t         *reasm;
+    uint8_t          adu[700];
+    bp_adu_id_t      id = {.node = 4, .service = 3, .createsec = 1000, .createseq = 7};
+    const uint8_t   *data;
+    int              size, slot, i;
+
+    printf("\n==== Test 1: Out of Order Fragments ====\n");
+
+    pattern_fill(adu, sizeof(adu));
+    ut_assert(reasm_create(&reasm, UT_REASM_SLOTS, UT_REASM_SLOT_SIZE, UT_REASM_MAX_RANGES) == BP_SUCCESS,
+              "Failed to create reassembly buffer\n");
+
+    for (i = 0; i < 7; i++)
+    {
+        int offset = order[i] * 100;
+        int status = reasm_insert(reasm, &id, 0, sizeof(adu), offset, &adu[offset], 100, &slot);
+        int expect = (i == 6) ? BP_PENDING_ACCEPTANCE : BP_SUCCESS;
+        ut_assert(status == expect, "Fragment at %d returned %d, expected %d\n", offset, status, expect);
+    }
+
+    ut_assert(reasm_count(reasm) == 1, "Expected one ADU being reassembled, had %d\n", reasm_count(reasm));
+    ut_assert(reasm_get(reasm, slot, &data, &size) == BP_SUCCESS, "Failed to get ADU\n");
+    ut_assert(size == sizeof(adu), "ADU of %d bytes, expected %d\n", size, (int)sizeof(adu));
+    ut_assert(memcmp(data, adu, sizeof(adu)) == 0, "Reassembled ADU does not match\n");
+    ut_assert(reasm_release(reasm, slot) == BP_SUCCESS, "Failed to release slot\n");
+    ut_assert(reasm_count(reasm) == 0, "Slot not freed by release\n");
+
+    reasm_destroy(reasm);
+}
+
+/*--------------------------------------------------------------------------------------
+ * Test #2
+ *--------------------------------------------------------------------------------------*/
+static void test_2(void)
+{
+    reasm_t      *reasm;
+    uint8_t       adu[600];
+    bp_adu_id_t   id = {.node = 4, .service = 3, .createsec = 2000, .createseq = 1};
+    const uint8_t *data;
+    int           size, slot;
+
+    printf("\n==== Test 2: Overlapping and Duplicate Fragments ====\n");
+
+    pattern_fill(adu, sizeof(adu));
+    reasm_create(&reasm, UT_REASM_SLOTS, UT_REASM_SLOT_SIZE, UT_REASM_MAX_RANGES);
+
+    ut_assert(reasm_insert(reasm, &id, 0, sizeof(adu), 100, &adu[100], 200, &slot) == BP_SUCCESS, "Fragment 1\n");
+    ut_assert(reasm_insert(reasm, &id, 0, sizeof(adu), 100, &adu[100], 200, &slot) == BP_SUCCESS, "Duplicate\n");
+    ut_assert(reasm_insert(reasm, &id, 0, sizeof(adu), 400, &adu[400], 100, &slot) == BP_SUCCESS, "Fragment 2\n");
+    ut_assert(reasm->slots[slot].num_ranges == 2, "Expected 2 ranges, had %d\n", reasm->slots[slot].num_ranges);
+    ut_assert(reasm_insert(reasm, &id, 0, sizeof(adu), 250, &adu[250], 200, &slot) == BP_SUCCESS, "Overlap\n");
+    ut_assert(reasm->slots[slot].num_ranges == 1, "Expected 1 range, had %d\n", reasm->slots[slot].num_ranges);
+    ut_assert(reasm_insert(reasm, &id, 0, sizeof(adu), 500, &adu[500], 100, &slot) == BP_SUCCESS, "Adjacent\n");
+    ut_assert(reasm_insert(reasm, &id, 0, sizeof(adu), 0, &adu[0], 150, &slot) == BP_PENDING_ACCEPTANCE,
+              "Failed to complete ADU\n");
+
+    reasm_get(reasm, slot, &data, &size);
+    ut_assert(memcmp(data, adu, sizeof(adu)) == 0, "Reassembled ADU does not match\n");
+    reasm_release(reasm, slot);
+
+    reasm_destroy(reasm);
+}
+
+/*--------------------------------------------------------------------------------------
+ * Test #3
+ *--------------------------------------------------------------------------------------*/
+static void test_3(void)
+{
+    reasm_t    *reasm;
+    uint8_t     adu[UT_REASM_SLOT_SIZE + 1];
+    bp_adu_id_t id = {.node = 9, .service = 1, .createsec = 3000, .createseq = 0};
+    bp_val_t    now;
+    int         slot, i;
+
+    printf("\n==== Test 3: Limits and Expiration ====\n");
+
+    pattern_fill(adu, sizeof(adu));
+    reasm_create(&reasm, UT_REASM_SLOTS, UT_REASM_SLOT_SIZE, UT_REASM_MAX_RANGES);
+
+    /* Fragments that Cannot be Reassembled */
+    ut_assert(reasm_insert(reasm, &id, 0, sizeof(adu), 0, adu, 10, &slot) == BP_ERROR, "ADU too long\n");
+    ut_assert(reasm_insert(reasm, &id, 0, 100, 95, adu, 10, &slot) == BP_ERROR, "Fragment past end of ADU\n");
+
+    /* Too Many Gaps */
+    for (i = 0; i < UT_REASM_MAX_RANGES; i++)
+    {
+        ut_assert(reasm_insert(reasm, &id, 0, 1000, i * 10, adu, 5, &slot) == BP_SUCCESS, "Range %d\n", i);
+    }
+    ut_assert(reasm_insert(reasm, &id, 0, 1000, 900, adu, 5, &slot) == BP_ERROR, "Range past limit\n");
+    ut_assert(reasm_insert(reasm, &id, 0, 1000, 5, adu, 5, &slot) == BP_SUCCESS, "Range filling a gap\n");
+
+    /* Fill All Slots */
+    for (i = 1; i < UT_REASM_SLOTS; i++)
+    {
+        id.createseq = i;
+        ut_assert(reasm_insert(reasm, &id, i * 100, 1000, 0, adu, 10, &slot) == BP_SUCCESS, "ADU %d\n", i);
+    }
+    id.createseq = UT_REASM_SLOTS;
+    ut_assert(reasm_insert(reasm, &id, 0, 1000, 0, adu, 10, &slot) == BP_FULL, "Expected no free slot\n");
+
+    /* Expire Partial ADUs */
+    now = 250;
+    ut_assert(reasm_expire(reasm, expired_before, &now) == 3, "Expected 3 expired ADUs\n");
+    ut_assert(reasm_count(reasm) == 1, "Expected one ADU left, had %d\n", reasm_count(reasm));
+    ut_assert(reasm_insert(reasm, &id, 0, 1000, 0, adu, 10, &slot) == BP_SUCCESS, "Slot not freed by expire\n");
+
+    reasm_destroy(reasm);
+}
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+int ut_reasm(void)
+{
+    ut_reset();
+
+    test_1();
+    test_2();
+    test_3();
+
+    return ut_failures();
+}
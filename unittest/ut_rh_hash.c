@@ -34,7 +34,8 @@
  *-------------------------------------------------------------------------------------*/
 static void print_hash(rh_hash_t *rh_hash, const char *message)
 {
-    int i, j;
+    int        i;
+    bp_index_t j;
 
     printf("\n------------------------\n");
     printf("HASH TABLE: %s\n", message);
@@ -45,7 +46,7 @@ static void print_hash(rh_hash_t *rh_hash, const char *message)
     if (rh_hash->oldest_entry != BP_MAX_INDEX)
     {
         printf("Oldest Entry:       [%d] %lu\n", rh_hash->oldest_entry,
-               (unsigned long)rh_hash->table[rh_hash->oldest_entry].bundle.cid);
+               (unsigned long)rh_hash->keys[rh_hash->oldest_entry].cid);
     }
     else
     {
@@ -55,7 +56,7 @@ static void print_hash(rh_hash_t *rh_hash, const char *message)
     if (rh_hash->newest_entry != BP_MAX_INDEX)
     {
         printf("Newest Entry:       [%d] %lu\n", rh_hash->newest_entry,
-               (unsigned long)rh_hash->table[rh_hash->newest_entry].bundle.cid);
+               (unsigned long)rh_hash->keys[rh_hash->newest_entry].cid);
     }
     else
     {
@@ -65,42 +66,42 @@ static void print_hash(rh_hash_t *rh_hash, const char *message)
     for (i = 0; i < rh_hash->size; i++)
     {
         printf("[%d] ", i);
-        if (rh_hash->table[i].bundle.sid == BP_SID_VACANT)
+        if (rh_hash->keys[i].sid == BP_SID_VACANT)
         {
             printf("EMPTY");
         }
         else
         {
-            printf("%-4lu -- ", (unsigned long)rh_hash->table[i].bundle.cid);
+            printf("%-4lu -- ", (unsigned long)rh_hash->keys[i].cid);
 
-            j = rh_hash->table[i].next;
+            j = rh_hash->keys[i].next;
             if (j == BP_MAX_INDEX)
                 printf("   ");
 
             while (j != BP_MAX_INDEX)
             {
                 printf("%-2d ", j);
-                j = rh_hash->table[j].next;
+                j = rh_hash->keys[j].next;
             }
 
             printf("| ");
-            if (rh_hash->table[i].before != BP_MAX_INDEX)
-                printf("%d", rh_hash->table[i].before);
+            if (rh_hash->nodes[i].before != BP_MAX_INDEX)
+                printf("%d", rh_hash->nodes[i].before);
             else
                 printf("N");
             printf(" <--t--> ");
-            if (rh_hash->table[i].after != BP_MAX_INDEX)
-                printf("%d", rh_hash->table[i].after);
+            if (rh_hash->nodes[i].after != BP_MAX_INDEX)
+                printf("%d", rh_hash->nodes[i].after);
             else
                 printf("N");
             printf(" | ");
-            if (rh_hash->table[i].prev != BP_MAX_INDEX)
-                printf("%d", rh_hash->table[i].prev);
+            if (rh_hash->keys[i].prev != BP_MAX_INDEX)
+                printf("%d", rh_hash->keys[i].prev);
             else
                 printf("N");
             printf(" <<-h->> ");
-            if (rh_hash->table[i].next != BP_MAX_INDEX)
-                printf("%d", rh_hash->table[i].next);
+            if (rh_hash->keys[i].next != BP_MAX_INDEX)
+                printf("%d", rh_hash->keys[i].next);
             else
                 printf("N");
         }
@@ -751,7 +752,7 @@ static void test_6(void)
     {
         for (i = 0; i < hash_size / 2; i++)
         {
-            bundle.cid = rh_hash->table[i].bundle.cid;
+            bundle.cid = rh_hash->keys[i].cid;
             cid        = bundle.cid;
 
             ut_assert(rh_hash_add(rh_hash, bundle, false) != BP_SUCCESS,
@@ -766,7 +767,7 @@ static void test_6(void)
             ut_assert(rh_hash_add(rh_hash, bundle, true) == BP_SUCCESS, "Failed to add CID %d\n", bundle.cid);
 
             /* Replace CID (out of place) */
-            cid = rh_hash->table[(i + (hash_size / 2)) % hash_size].bundle.cid;
+            cid = rh_hash->keys[(i + (hash_size / 2)) % hash_size].cid;
             ut_assert(rh_hash_remove(rh_hash, cid, &bundle) == BP_SUCCESS, "Failed to remove CID %d\n", cid);
             bundle.cid = cid + newcid++;
             ut_assert(rh_hash_add(rh_hash, bundle, true) == BP_SUCCESS, "Failed to add CID %d\n", bundle.cid);
@@ -1104,6 +1105,183 @@ static void test_9(void)
     free(order_of_cids);
 }
 
+/*--------------------------------------------------------------------------------------
+ * Test #10
+ *--------------------------------------------------------------------------------------*/
+typedef struct
+{
+    bool    *present;
+    bp_val_t first_cid;
+    bp_val_t count;
+    int      num_removed;
+    bool     found_error;
+} test_10_parm_t;
+
+static void test_10_removed(void *parm, bp_active_bundle_t *bundle)
+{
+    test_10_parm_t *p = (test_10_parm_t *)parm;
+    if (bundle->cid - p->first_cid >= p->count || !p->present[bundle->cid])
+    {
+        p->found_error = true;
+    }
+    else
+    {
+        p->present[bundle->cid] = false;
+    }
+    p->num_removed++;
+}
+
+static void test_10(void)
+{
+    int        i, j;
+    rh_hash_t *rh_hash;
+
+    int          test_cycles = 16384;
+    int          hash_size   = 64;
+    unsigned int cid_range   = 256;
+
+    bp_active_bundle_t bundle  = {1, 0, 0};
+    bool              *present = (bool *)malloc(cid_range * sizeof(bool));
+    test_10_parm_t     parm    = {present, 0, 0, 0, false};
+
+    printf("\n==== Test 10: Stress - Remove Range ====\n");
+
+    ut_assert(rh_hash_create(&rh_hash, hash_size) == BP_SUCCESS, "Failed to create hash\n");
+
+    /* Cycle Tests */
+    for (j = 0; j < test_cycles; j++)
+    {
+        int num_present = 0;
+        for (i = 0; i < (int)cid_range; i++)
+        {
+            present[i] = false;
+        }
+
+        /* Load Hash */
+        for (i = 0; i < hash_size; i++)
+        {
+            bundle.cid = bplib_os_random() % cid_range;
+            if (rh_hash_add(rh_hash, bundle, false) == BP_SUCCESS)
+            {
+                present[bundle.cid] = true;
+                num_present++;
+            }
+        }
+
+        /* Remove Ranges (both smaller and larger than the number of entries) */
+        while (num_present > 0)
+        {
+            parm.first_cid   = bplib_os_random() % cid_range;
+            parm.count       = (bplib_os_random() % (cid_range / 2)) + 1;
+            parm.num_removed = 0;
+            parm.found_error = false;
+
+            int expected = 0;
+            for (i = 0; i < (int)parm.count && parm.first_cid + i < cid_range; i++)
+            {
+                expected += present[parm.first_cid + i] ? 1 : 0;
+            }
+
+            int removed = rh_hash_remove_range(rh_hash, parm.first_cid, parm.count, test_10_removed, &parm);
+            ut_assert(!parm.found_error, "Removed CID outside of range %lu + %lu\n", (unsigned long)parm.first_cid,
+                      (unsigned long)parm.count);
+            ut_assert(removed == expected && parm.num_removed == expected,
+                      "Failed to remove range %lu + %lu: %d, %d != %d\n", (unsigned long)parm.first_cid,
+                      (unsigned long)parm.count, removed, parm.num_removed, expected);
+            num_present -= expected;
+
+            /* Check Remaining Entries */
+            ut_assert(rh_hash->num_entries == num_present, "Incorrect number of entries: %d != %d\n",
+                      (int)rh_hash->num_entries, num_present);
+        }
+
+        /* Check Empty */
+        ut_assert(rh_hash_next(rh_hash, &bundle) == BP_ERROR, "Failed to get CIDNOTFOUND error\n");
+        ut_assert(rh_hash->oldest_entry == BP_MAX_INDEX && rh_hash->newest_entry == BP_MAX_INDEX,
+                  "Failed to clear time order\n");
+    }
+
+    /* Clean Up */
+
+    ut_assert(rh_hash_destroy(rh_hash) == BP_SUCCESS, "Failed to destroy hash\n");
+
+    free(present);
+}
+
+/*--------------------------------------------------------------------------------------
+ * Test #11
+ *--------------------------------------------------------------------------------------*/
+static void test_11(void)
+{
+    int        i, j;
+    rh_hash_t *rh_hash;
+
+    int test_cycles = 1024;
+    int min_size    = 16;
+    int max_size    = 1024;
+
+    bp_active_bundle_t bundle        = {1, 0, 0};
+    bp_val_t          *order_of_cids = (bp_val_t *)malloc(max_size * sizeof(bp_val_t));
+
+    printf("\n==== Test 11: Stress - Resize ====\n");
+
+    ut_assert(rh_hash_create(&rh_hash, min_size) == BP_SUCCESS, "Failed to create hash\n");
+
+    /* Cycle Tests */
+    for (j = 0; j < test_cycles; j++)
+    {
+        int num_added = 0;
+        int size      = min_size + 1 + (bplib_os_random() % (max_size - min_size - 1));
+
+        /* Load Hash */
+        for (i = 0; i < min_size; i++)
+        {
+            bundle.cid = bplib_os_random() % (max_size * 4);
+            if (rh_hash_add(rh_hash, bundle, false) == BP_SUCCESS)
+            {
+                order_of_cids[num_added++] = bundle.cid;
+            }
+        }
+
+        /* Grow Hash and Fill */
+        ut_assert(rh_hash_resize(rh_hash, size) == BP_SUCCESS, "Failed to grow hash to %d\n", size);
+        while (num_added < size)
+        {
+            bundle.cid = bplib_os_random() % (max_size * 4);
+            if (rh_hash_add(rh_hash, bundle, false) == BP_SUCCESS)
+            {
+                order_of_cids[num_added++] = bundle.cid;
+            }
+        }
+        ut_assert(rh_hash_available(rh_hash, 0) == BP_ERROR, "Hash not full at %d\n", size);
+
+        /* Shrink Hash (only after enough entries removed) */
+        ut_assert(rh_hash_resize(rh_hash, min_size) == BP_ERROR, "Failed to reject shrinking full hash\n");
+        for (i = 0; i < num_added - min_size; i++)
+        {
+            ut_assert(rh_hash_remove(rh_hash, order_of_cids[i], NULL) == BP_SUCCESS, "Failed to remove CID %lu\n",
+                      (unsigned long)order_of_cids[i]);
+        }
+        ut_assert(rh_hash_resize(rh_hash, min_size) == BP_SUCCESS, "Failed to shrink hash\n");
+
+        /* Check Time Order Kept */
+        for (i = num_added - min_size; i < num_added; i++)
+        {
+            ut_assert(rh_hash_next(rh_hash, &bundle) == BP_SUCCESS && bundle.cid == order_of_cids[i],
+                      "Failed to get next CID %lu\n", (unsigned long)order_of_cids[i]);
+            ut_assert(rh_hash_remove(rh_hash, order_of_cids[i], NULL) == BP_SUCCESS, "Failed to remove CID %lu\n",
+                      (unsigned long)order_of_cids[i]);
+        }
+        ut_assert(rh_hash->num_entries == 0, "Failed to remove all entries\n");
+    }
+
+    /* Clean Up */
+
+    ut_assert(rh_hash_destroy(rh_hash) == BP_SUCCESS, "Failed to destroy hash\n");
+
+    free(order_of_cids);
+}
+
 /******************************************************************************
  EXPORTED FUNCTIONS
  ******************************************************************************/
@@ -1121,6 +1299,8 @@ int ut_rh_hash(void)
     test_7();
     test_8();
     test_9();
+    test_10();
+    test_11();
 
     return ut_failures();
 }
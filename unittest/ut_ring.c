@@ -0,0 +1,192 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include "ut_assert.h"
+#include "bplib_os.h"
+#include "bplib_store_ring.h"
+
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+#define UT_RING_SLOTS      4
+#define UT_RING_HANDOFFS   20000
+#define UT_RING_TIMEOUT_MS 1000
+
+/******************************************************************************
+ FILE DATA
+ ******************************************************************************/
+
+static bp_handle_t ring_ping;
+static bp_handle_t ring_pong;
+static int         ring_received;
+
+/******************************************************************************
+ LOCAL FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * ring_echo - dequeues each handoff from ping and returns it on pong, stopping at the
+ *             first one that it is not woken for
+ *--------------------------------------------------------------------------------------*/
+static void ring_echo(void *parm)
+{
+    bp_object_t *object;
+    int          i;
+
+    (void)parm;
+
+    for (i = 0; i < UT_RING_HANDOFFS; i++)
+    {
+        if (bplib_store_ring_dequeue(ring_ping, &object, UT_RING_TIMEOUT_MS) != BP_SUCCESS)
+        {
+            return;
+        }
+        bplib_store_ring_enqueue(ring_pong, object->data, sizeof(int), NULL, 0, BP_CHECK);
+        bplib_store_ring_relinquish(ring_ping, object->header.sid);
+        ring_received = i + 1;
+    }
+}
+
+/******************************************************************************
+ TEST FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * Test #1
+ *--------------------------------------------------------------------------------------*/
+static void test_1(void)
+{
+    bp_ring_attr_t attr = {.slot_count = UT_RING_SLOTS, .slot_size = sizeof(int)};
+    bp_object_t   *object;
+    bp_handle_t    echo;
+    int            i;
+
+    printf("\n==== Test 1: Blocked Dequeue Woken by Enqueue ====\n");
+
+    ring_received = 0;
+    ring_ping     = bplib_store_ring_create(0, 0, 0, false, &attr);
+    ring_pong     = bplib_store_ring_create(0, 0, 0, false, &attr);
+    ut_assert(bp_handle_is_valid(ring_ping) && bp_handle_is_valid(ring_pong), "Failed to create ring stores\n");
+
+    echo = bplib_os_createthread(ring_echo, NULL);
+    ut_assert(bp_handle_is_valid(echo), "Failed to create echo thread\n");
+
+    /* Hand Off One Object at a Time - each side blocks in dequeue until the other enqueues */
+    for (i = 0; i < UT_RING_HANDOFFS; i++)
+    {
+        ut_assert(bplib_store_ring_enqueue(ring_ping, &i, sizeof(i), NULL, 0, BP_CHECK) == BP_SUCCESS,
+                  "Failed to enqueue object %d\n", i);
+        if (!ut_assert(bplib_store_ring_dequeue(ring_pong, &object, UT_RING_TIMEOUT_MS) == BP_SUCCESS,
+                       "Lost wakeup on object %d\n", i))
+        {
+            break;
+        }
+        ut_assert(*(int *)object->data == i, "Object %d returned out of order\n", i);
+        bplib_store_ring_relinquish(ring_pong, object->header.sid);
+    }
+
+    bplib_os_jointhread(echo);
+    ut_assert(ring_received == UT_RING_HANDOFFS, "Echoed %d of %d objects\n", ring_received, UT_RING_HANDOFFS);
+    ut_assert(bplib_store_ring_getcount(ring_ping) == 0 && bplib_store_ring_getcount(ring_pong) == 0,
+              "Objects left in stores\n");
+
+    bplib_store_ring_destroy(ring_ping);
+    bplib_store_ring_destroy(ring_pong);
+}
+
+/*--------------------------------------------------------------------------------------
+ * Test #2
+ *--------------------------------------------------------------------------------------*/
+static void test_2(void)
+{
+    bp_ring_attr_t attr = {.slot_count = UT_RING_SLOTS, .slot_size = sizeof(int)};
+    bp_object_t   *object;
+    bp_object_t   *allocated;
+    bp_handle_t    ring;
+    bp_sid_t       sid;
+    int            value = 7;
+
+    printf("\n==== Test 2: Only Dequeued Slots Relinquished ====\n");
+
+    ring = bplib_store_ring_create(0, 0, 0, false, &attr);
+    ut_assert(bp_handle_is_valid(ring), "Failed to create ring store\n");
+
+    /* Queued Slot */
+    ut_assert(bplib_store_ring_enqueue(ring, &value, sizeof(value), NULL, 0, BP_CHECK) == BP_SUCCESS,
+              "Failed to enqueue object\n");
+    ut_assert(bplib_store_ring_relinquish(ring, 1) == BP_ERROR, "Relinquished queued slot\n");
+    ut_assert(bplib_store_ring_getcount(ring) == 1, "Count %d with one object queued\n",
+              bplib_store_ring_getcount(ring));
+
+    /* Dequeued Slot - relinquished once */
+    ut_assert(bplib_store_ring_dequeue(ring, &object, BP_CHECK) == BP_SUCCESS, "Failed to dequeue object\n");
+    ut_assert(*(int *)object->data == value, "Dequeued wrong object\n");
+    sid = object->header.sid;
+    ut_assert(bplib_store_ring_relinquish(ring, sid) == BP_SUCCESS, "Failed to relinquish dequeued slot\n");
+    ut_assert(bplib_store_ring_relinquish(ring, sid) == BP_ERROR, "Relinquished slot twice\n");
+    ut_assert(bplib_store_ring_getcount(ring) == 0, "Count %d after relinquish\n", bplib_store_ring_getcount(ring));
+
+    /* Allocated Slot */
+    allocated = bplib_store_ring_allocate(ring, sizeof(value));
+    ut_assert(allocated != NULL, "Failed to allocate slot\n");
+    if (allocated != NULL)
+    {
+        ut_assert(bplib_store_ring_relinquish(ring, allocated->header.sid) == BP_ERROR,
+                  "Relinquished allocated slot\n");
+        bplib_store_ring_discard(ring, allocated);
+    }
+
+    /* Every Slot Still Handed Out Once */
+    for (value = 0; value < UT_RING_SLOTS; value++)
+    {
+        ut_assert(bplib_store_ring_enqueue(ring, &value, sizeof(value), NULL, 0, BP_CHECK) == BP_SUCCESS,
+                  "Failed to enqueue object %d\n", value);
+    }
+    ut_assert(bplib_store_ring_enqueue(ring, &value, sizeof(value), NULL, 0, BP_CHECK) == BP_TIMEOUT,
+              "Enqueued into full store\n");
+    for (value = 0; value < UT_RING_SLOTS; value++)
+    {
+        ut_assert(bplib_store_ring_dequeue(ring, &object, BP_CHECK) == BP_SUCCESS &&
+                      *(int *)object->data == value,
+                  "Failed to dequeue object %d\n", value);
+        bplib_store_ring_relinquish(ring, object->header.sid);
+    }
+
+    bplib_store_ring_destroy(ring);
+}
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+int ut_ring(void)
+{
+    ut_reset();
+
+    test_1();
+    test_2();
+
+    return ut_failures();
+}
@@ -0,0 +1,231 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "ut_assert.h"
+#include "sdnv.h"
+
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+#define UT_SDNV_BUF_SIZE    32
+#define UT_SDNV_INDEX       3
+#define UT_SDNV_ITERATIONS  100000
+#define UT_SDNV_MAX_WIDTH   10
+
+/******************************************************************************
+ HELPER FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * random_value - returns a value of a random number of bits
+ *--------------------------------------------------------------------------------------*/
+static bp_val_t random_value(uint32_t *x)
+{
+    uint64_t value = 0;
+    int      bits;
+
+    *x    = (*x * 1103515245) + 12345;
+    bits  = (*x >> 16) % 65;
+    *x    = (*x * 1103515245) + 12345;
+    value = (uint64_t)(*x >> 8) << 40;
+    *x    = (*x * 1103515245) + 12345;
+    value |= (uint64_t)(*x >> 8) << 16;
+    *x    = (*x * 1103515245) + 12345;
+    value |= (uint64_t)(*x >> 16);
+
+    return (bp_val_t)(bits == 64 ? value : value & ((1ULL << bits) - 1));
+}
+
+/*--------------------------------------------------------------------------------------
+ * write_read - writes and reads back an sdnv at the start of a block and at its end,
+ *  where there is no room for a word, and checks that both give the same results
+ *--------------------------------------------------------------------------------------*/
+static void write_read(bp_val_t value, int width)
+{
+    uint8_t    head[UT_SDNV_BUF_SIZE];
+    uint8_t    tail[UT_SDNV_BUF_SIZE];
+    uint32_t   head_flags = 0;
+    uint32_t   tail_flags = 0;
+    bp_field_t field      = {value, UT_SDNV_INDEX, width};
+
+    memset(head, 0xA5, sizeof(head));
+    memset(tail, 0xA5, sizeof(tail));
+
+    /* Write */
+    int head_next = sdnv_write(head, sizeof(head), field, &head_flags);
+    int len       = head_next - UT_SDNV_INDEX;
+    int tail_next = sdnv_write(tail, UT_SDNV_INDEX + len, field, &tail_flags);
+    ut_assert(head_next == tail_next, "Write of %lu (%d) ended at %d and %d\n", (unsigned long)value, width,
+              head_next, tail_next);
+    ut_assert(head_flags == tail_flags, "Write of %lu (%d) set flags %08X and %08X\n", (unsigned long)value, width,
+              head_flags, tail_flags);
+    ut_assert(memcmp(head, tail, UT_SDNV_INDEX + len) == 0, "Write of %lu (%d) encoded differently\n",
+              (unsigned long)value, width);
+    ut_assert(head[head_next] == 0xA5, "Write of %lu (%d) changed the byte after it\n", (unsigned long)value, width);
+
+    /* Read */
+    bp_field_t head_field = {0, UT_SDNV_INDEX, width};
+    bp_field_t tail_field = {0, UT_SDNV_INDEX, width};
+    head_flags            = 0;
+    tail_flags            = 0;
+    head_next             = sdnv_read(head, sizeof(head), &head_field, &head_flags);
+    tail_next             = sdnv_read(tail, UT_SDNV_INDEX + len, &tail_field, &tail_flags);
+    ut_assert(head_next == tail_next, "Read of %lu (%d) ended at %d and %d\n", (unsigned long)value, width, head_next,
+              tail_next);
+    ut_assert(head_flags == tail_flags, "Read of %lu (%d) set flags %08X and %08X\n", (unsigned long)value, width,
+              head_flags, tail_flags);
+    ut_assert(head_field.value == tail_field.value, "Read of %lu (%d) decoded %lu and %lu\n", (unsigned long)value,
+              width, (unsigned long)head_field.value, (unsigned long)tail_field.value);
+}
+
+/******************************************************************************
+ TEST FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * Test #1
+ *--------------------------------------------------------------------------------------*/
+static void test_1(void)
+{
+    struct
+    {
+        bp_val_t value;
+        int      width;
+        int      len;
+        uint8_t  bytes[4];
+    } cases[] = {
+        {0x00, 0, 1, {0x00}},
+        {0x7F, 0, 1, {0x7F}},
+        {0x80, 0, 2, {0x81, 0x00}},
+        {0x3FFF, 0, 2, {0xFF, 0x7F}},
+        {0x4000, 0, 3, {0x81, 0x80, 0x00}},
+        {0x01, 4, 4, {0x80, 0x80, 0x80, 0x01}},
+        {0xABCD, 3, 3, {0x82, 0xD7, 0x4D}},
+    };
+    uint8_t  block[UT_SDNV_BUF_SIZE];
+    uint32_t flags;
+    int      i;
+
+    printf("\n==== Test 1: Encodings ====\n");
+
+    for (i = 0; i < (int)(sizeof(cases) / sizeof(cases[0])); i++)
+    {
+        bp_field_t field = {cases[i].value, UT_SDNV_INDEX, cases[i].width};
+        flags            = 0;
+        memset(block, 0, sizeof(block));
+        ut_assert(sdnv_write(block, sizeof(block), field, &flags) == UT_SDNV_INDEX + cases[i].len,
+                  "Failed to write %lu in %d bytes\n", (unsigned long)cases[i].value, cases[i].len);
+        ut_assert(memcmp(&block[UT_SDNV_INDEX], cases[i].bytes, cases[i].len) == 0, "Failed to encode %lu\n",
+                  (unsigned long)cases[i].value);
+        ut_assert(flags == 0, "Unexpected flags %08X writing %lu\n", flags, (unsigned long)cases[i].value);
+
+        field.value = 0;
+        ut_assert(sdnv_read(block, sizeof(block), &field, &flags) == UT_SDNV_INDEX + cases[i].len,
+                  "Failed to read %lu in %d bytes\n", (unsigned long)cases[i].value, cases[i].len);
+        ut_assert(field.value == cases[i].value, "Failed to decode %lu: %lu\n", (unsigned long)cases[i].value,
+                  (unsigned long)field.value);
+        ut_assert(flags == 0, "Unexpected flags %08X reading %lu\n", flags, (unsigned long)cases[i].value);
+
+        write_read(cases[i].value, cases[i].width);
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * Test #2
+ *--------------------------------------------------------------------------------------*/
+static void test_2(void)
+{
+    uint32_t x = 0x13579BDF;
+    int      width;
+    int      i;
+
+    printf("\n==== Test 2: Random Values and Widths ====\n");
+
+    for (i = 0; i < UT_SDNV_ITERATIONS; i++)
+    {
+        bp_val_t value = random_value(&x);
+        for (width = 0; width <= UT_SDNV_MAX_WIDTH; width++)
+        {
+            write_read(value, width);
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * Test #3
+ *--------------------------------------------------------------------------------------*/
+static void test_3(void)
+{
+    uint8_t    block[UT_SDNV_BUF_SIZE];
+    uint32_t   flags;
+    bp_field_t field;
+
+    printf("\n==== Test 3: Malformed Values ====\n");
+
+    /* Not Terminated Before End of Block */
+    memset(block, 0x80, sizeof(block));
+    field = (bp_field_t){0, UT_SDNV_INDEX, 0};
+    flags = 0;
+    ut_assert(sdnv_read(block, sizeof(block), &field, &flags) == UT_SDNV_BUF_SIZE, "Failed to read to end of block\n");
+    ut_assert(flags & BP_FLAG_SDNV_INCOMPLETE, "Failed to flag unterminated value\n");
+
+    /* Not Terminated Within Width */
+    block[UT_SDNV_INDEX + 3] = 0x01;
+    field                    = (bp_field_t){0, UT_SDNV_INDEX, 3};
+    flags                    = 0;
+    ut_assert(sdnv_read(block, sizeof(block), &field, &flags) == UT_SDNV_INDEX + 3, "Failed to stop at width\n");
+    ut_assert(flags & BP_FLAG_SDNV_INCOMPLETE, "Failed to flag value longer than its width\n");
+
+    /* Too Large to Decode */
+    memset(block, 0xFF, sizeof(block));
+    block[UT_SDNV_INDEX + 10] = 0x7F;
+    field                     = (bp_field_t){0, UT_SDNV_INDEX, 0};
+    flags                     = 0;
+    ut_assert(sdnv_read(block, sizeof(block), &field, &flags) == UT_SDNV_INDEX + 11, "Failed to read large value\n");
+    ut_assert(flags & BP_FLAG_SDNV_OVERFLOW, "Failed to flag value too large to decode\n");
+
+    /* Too Large to Encode in Width */
+    field = (bp_field_t){0x4000, UT_SDNV_INDEX, 2};
+    flags = 0;
+    ut_assert(sdnv_write(block, sizeof(block), field, &flags) == UT_SDNV_INDEX + 2, "Failed to write to width\n");
+    ut_assert(flags & BP_FLAG_SDNV_OVERFLOW, "Failed to flag value too large for its width\n");
+}
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+int ut_sdnv(void)
+{
+    ut_reset();
+
+    test_1();
+    test_2();
+    test_3();
+
+    return ut_failures();
+}
@@ -0,0 +1,240 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include "ut_assert.h"
+#include "twheel.h"
+
+/******************************************************************************
+ TEST FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * Test #1
+ *--------------------------------------------------------------------------------------*/
+static void test_1(void)
+{
+    twheel_t  *twheel;
+    bp_index_t timer;
+    bp_val_t   cid;
+
+    printf("\n==== Test 1: Create/Destroy ====\n");
+
+    ut_assert(twheel_create(&twheel, 0, 0) == BP_ERROR, "Failed to reject empty wheel\n");
+    ut_assert(twheel_create(&twheel, BP_MAX_INDEX + 1, 0) == BP_ERROR, "Failed to reject oversized wheel\n");
+    ut_assert(twheel_create(&twheel, 4, 0) == BP_SUCCESS, "Failed to create wheel\n");
+
+    ut_assert(twheel_start(twheel, 1, 10, &timer) == BP_SUCCESS, "Failed to start timer\n");
+    ut_assert(twheel_count(twheel) == 1, "Failed to count timer\n");
+    ut_assert(twheel_expired(twheel, 9, &cid) == BP_TIMEOUT, "Timer expired early\n");
+    ut_assert(twheel_expired(twheel, 10, &cid) == BP_SUCCESS && cid == 1, "Failed to expire timer\n");
+    ut_assert(twheel_count(twheel) == 0, "Failed to free expired timer\n");
+    ut_assert(twheel_stop(twheel, timer) == BP_ERROR, "Stopped timer that is not running\n");
+
+    ut_assert(twheel_destroy(twheel) == BP_SUCCESS, "Failed to destroy wheel\n");
+}
+
+/*--------------------------------------------------------------------------------------
+ * Test #2
+ *--------------------------------------------------------------------------------------*/
+static void test_2(void)
+{
+    twheel_t  *twheel;
+    bp_index_t timers[4];
+    bp_index_t timer;
+    bp_val_t   cid;
+
+    printf("\n==== Test 2: Full/Stop ====\n");
+
+    ut_assert(twheel_create(&twheel, 4, 100) == BP_SUCCESS, "Failed to create wheel\n");
+
+    ut_assert(twheel_start(twheel, 0, 105, &timers[0]) == BP_SUCCESS, "Failed to start timer 0\n");
+    ut_assert(twheel_start(twheel, 1, 106, &timers[1]) == BP_SUCCESS, "Failed to start timer 1\n");
+    ut_assert(twheel_start(twheel, 2, 107, &timers[2]) == BP_SUCCESS, "Failed to start timer 2\n");
+    ut_assert(twheel_start(twheel, 3, 108, &timers[3]) == BP_SUCCESS, "Failed to start timer 3\n");
+    ut_assert(twheel_start(twheel, 4, 109, &timer) == BP_FULL, "Failed to detect full wheel\n");
+
+    ut_assert(twheel_stop(twheel, timers[1]) == BP_SUCCESS, "Failed to stop timer 1\n");
+    ut_assert(twheel_stop(twheel, timers[1]) == BP_ERROR, "Stopped timer 1 twice\n");
+    ut_assert(twheel_start(twheel, 4, 109, &timer) == BP_SUCCESS, "Failed to reuse stopped timer\n");
+
+    ut_assert(twheel_expired(twheel, 200, &cid) == BP_SUCCESS && cid == 0, "Failed to expire CID 0\n");
+    ut_assert(twheel_stop(twheel, timers[2]) == BP_SUCCESS, "Failed to stop expired timer 2\n");
+    ut_assert(twheel_expired(twheel, 200, &cid) == BP_SUCCESS && cid == 3, "Failed to expire CID 3\n");
+    ut_assert(twheel_expired(twheel, 200, &cid) == BP_SUCCESS && cid == 4, "Failed to expire CID 4\n");
+    ut_assert(twheel_expired(twheel, 200, &cid) == BP_TIMEOUT, "Expired stopped timer\n");
+
+    twheel_destroy(twheel);
+}
+
+/*--------------------------------------------------------------------------------------
+ * Test #3
+ *--------------------------------------------------------------------------------------*/
+static void test_3(void)
+{
+    twheel_t  *twheel;
+    bp_index_t timer;
+    bp_val_t   cid;
+    bp_val_t   expire;
+    bp_val_t   now;
+    int        i;
+
+    /* Expirations spread across all levels, started out of order */
+    static const bp_val_t offsets[] = {70000, 3, 4097, 64, 63, 262144, 1, 65, 4095, 20000000, 4096, 0};
+    static const int      order[]   = {11, 6, 1, 4, 3, 7, 8, 10, 2, 0, 5, 9};
+    int                   num       = sizeof(offsets) / sizeof(offsets[0]);
+
+    printf("\n==== Test 3: Expiration Order ====\n");
+
+    ut_assert(twheel_create(&twheel, 16, 1000) == BP_SUCCESS, "Failed to create wheel\n");
+
+    for (i = 0; i < num; i++)
+    {
+        ut_assert(twheel_start(twheel, i, 1000 + offsets[i], &timer) == BP_SUCCESS, "Failed to start timer %d\n", i);
+    }
+
+    /* Step through time unevenly and check each timer expires in order and not early */
+    i   = 0;
+    now = 1000;
+    while (i < num && now < 1000 + 30000000)
+    {
+        while (twheel_expired(twheel, now, &cid) == BP_SUCCESS)
+        {
+            expire = 1000 + offsets[cid];
+            ut_assert(i < num && (int)cid == order[i], "Timer %lu expired out of order\n", (unsigned long)cid);
+            ut_assert(expire <= now, "Timer %lu expired early at %lu\n", (unsigned long)cid, (unsigned long)now);
+            ut_assert(now - expire < 1000, "Timer %lu expired late at %lu\n", (unsigned long)cid,
+                      (unsigned long)now);
+            i++;
+        }
+        now += (now % 7) + 1;
+        if (now > 1000 + 300000)
+        {
+            now += 997;
+        }
+    }
+
+    ut_assert(i == num, "Only %d of %d timers expired\n", i, num);
+    ut_assert(twheel_count(twheel) == 0, "Timers remaining in wheel\n");
+
+    twheel_destroy(twheel);
+}
+
+/*--------------------------------------------------------------------------------------
+ * Test #4
+ *--------------------------------------------------------------------------------------*/
+static void test_4(void)
+{
+    twheel_t  *twheel;
+    bp_index_t timer;
+    bp_val_t   cid;
+
+    printf("\n==== Test 4: Large Time Steps ====\n");
+
+    ut_assert(twheel_create(&twheel, 4, 0) == BP_SUCCESS, "Failed to create wheel\n");
+
+    ut_assert(twheel_start(twheel, 1, 50, &timer) == BP_SUCCESS, "Failed to start timer 1\n");
+    ut_assert(twheel_start(twheel, 2, 9000000, &timer) == BP_SUCCESS, "Failed to start timer 2\n");
+    ut_assert(twheel_start(twheel, 3, 9000001, &timer) == BP_SUCCESS, "Failed to start timer 3\n");
+    ut_assert(twheel_expired(twheel, 49, &cid) == BP_TIMEOUT, "Timer expired early\n");
+    ut_assert(twheel_expired(twheel, 8999999, &cid) == BP_SUCCESS && cid == 1, "Failed to expire timer 1\n");
+    ut_assert(twheel_expired(twheel, 8999999, &cid) == BP_TIMEOUT, "Timer 2 expired early\n");
+    ut_assert(twheel_expired(twheel, 9000000, &cid) == BP_SUCCESS && cid == 2, "Failed to expire timer 2\n");
+    ut_assert(twheel_expired(twheel, 9000000, &cid) == BP_TIMEOUT, "Timer 3 expired early\n");
+    ut_assert(twheel_stop(twheel, timer) == BP_SUCCESS, "Failed to stop timer 3\n");
+    ut_assert(twheel_start(twheel, 4, 9000010, &timer) == BP_SUCCESS, "Failed to start timer 4\n");
+    ut_assert(twheel_expired(twheel, 50000000, &cid) == BP_SUCCESS && cid == 4, "Failed to expire timer 4\n");
+    ut_assert(twheel_count(twheel) == 0, "Timers remaining in wheel\n");
+
+    twheel_destroy(twheel);
+}
+
+/*--------------------------------------------------------------------------------------
+ * Test #5
+ *--------------------------------------------------------------------------------------*/
+static void test_5(void)
+{
+    twheel_t  *twheel;
+    bp_index_t timers[8];
+    bp_val_t   cid;
+    int        i;
+
+    printf("\n==== Test 5: Resize ====\n");
+
+    ut_assert(twheel_create(&twheel, 4, 0) == BP_SUCCESS, "Failed to create wheel\n");
+    ut_assert(twheel_resize(twheel, 0) == BP_ERROR, "Failed to reject empty wheel\n");
+
+    /* Grow with Timers Running */
+    for (i = 0; i < 4; i++)
+    {
+        ut_assert(twheel_start(twheel, i, 10 + i, &timers[i]) == BP_SUCCESS, "Failed to start timer %d\n", i);
+    }
+    ut_assert(twheel_start(twheel, 4, 14, &timers[4]) == BP_FULL, "Failed to reject timer when full\n");
+    ut_assert(twheel_resize(twheel, 8) == BP_SUCCESS, "Failed to grow wheel\n");
+    for (i = 4; i < 8; i++)
+    {
+        ut_assert(twheel_start(twheel, i, 10 + i, &timers[i]) == BP_SUCCESS, "Failed to start timer %d\n", i);
+    }
+    ut_assert(twheel_count(twheel) == 8, "Failed to count timers\n");
+
+    /* Shrink with Timers Running (retired as they expire) */
+    ut_assert(twheel_resize(twheel, 2) == BP_SUCCESS, "Failed to shrink wheel\n");
+    ut_assert(twheel_start(twheel, 8, 18, &timers[0]) == BP_FULL, "Failed to reject timer when shrunk\n");
+    for (i = 0; i < 8; i++)
+    {
+        ut_assert(twheel_expired(twheel, 10 + i, &cid) == BP_SUCCESS && cid == (bp_val_t)i,
+                  "Failed to expire timer %d\n", i);
+    }
+    ut_assert(twheel->allocated == 2 && twheel->num_retired == 0, "Failed to shrink pool: %d, %d\n",
+              (int)twheel->allocated, (int)twheel->num_retired);
+
+    /* Run at New Size */
+    ut_assert(twheel_start(twheel, 9, 30, &timers[0]) == BP_SUCCESS, "Failed to start timer 9\n");
+    ut_assert(twheel_start(twheel, 10, 31, &timers[1]) == BP_SUCCESS, "Failed to start timer 10\n");
+    ut_assert(twheel_start(twheel, 11, 32, &timers[2]) == BP_FULL, "Failed to reject timer 11\n");
+    ut_assert(twheel_stop(twheel, timers[0]) == BP_SUCCESS, "Failed to stop timer 9\n");
+    ut_assert(twheel_expired(twheel, 31, &cid) == BP_SUCCESS && cid == 10, "Failed to expire timer 10\n");
+    ut_assert(twheel_count(twheel) == 0, "Timers remaining in wheel\n");
+
+    twheel_destroy(twheel);
+}
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * Timer Wheel Unit Test
+ *--------------------------------------------------------------------------------------*/
+int ut_twheel(void)
+{
+    ut_reset();
+
+    test_1();
+    test_2();
+    test_3();
+    test_4();
+    test_5();
+
+    return ut_failures();
+}
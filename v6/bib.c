@@ -479,3 +479,39 @@ int bib_verify(const void *payload, int payload_size, bp_blk_bib_t *bib, uint32_
     /* Return Success */
     return BP_SUCCESS;
 }
+
+/*--------------------------------------------------------------------------------------
+ * bib_defer -
+ *
+ *  bib - pointer to a bundle integrity block structure read from the bundle [INPUT]
+ *  params - pointer to the crc to compute over the payload when it is copied [OUTPUT]
+ *  crc - pointer to the finalized crc the payload must have [OUTPUT]
+ *
+ *  Returns:    success or error code
+ *-------------------------------------------------------------------------------------*/
+int bib_defer(bp_blk_bib_t *bib, bplib_crc_parameters_t **params, bp_crcval_t *crc, uint32_t *flags)
+{
+    assert(bib);
+    assert(params);
+    assert(crc);
+
+    /* Select Payload CRC */
+    if (bib->cipher_suite_id.value == BP_BIB_CRC16_X25)
+    {
+        *params = &BPLIB_CRC16_X25;
+        *crc    = bib->security_result_data.crc16;
+    }
+    else if (bib->cipher_suite_id.value == BP_BIB_CRC32_CASTAGNOLI)
+    {
+        *params = &BPLIB_CRC32_CASTAGNOLI;
+        *crc    = bib->security_result_data.crc32;
+    }
+    else
+    {
+        return bplog(flags, BP_FLAG_INVALID_CIPHER_SUITEID, "Invalid BIB cipher suite id: %d\n",
+                     bib->cipher_suite_id.value);
+    }
+
+    /* Return Success */
+    return BP_SUCCESS;
+}
@@ -62,5 +62,6 @@ int bib_read(const void *block, int size, bp_blk_bib_t *bib, bool update_indices
 int bib_write(void *block, int size, bp_blk_bib_t *bib, bool update_indices, uint32_t *flags);
 int bib_update(void *block, int size, const void *payload, int payload_size, bp_blk_bib_t *bib, uint32_t *flags);
 int bib_verify(const void *payload, int payload_size, bp_blk_bib_t *bib, uint32_t *flags);
+int bib_defer(bp_blk_bib_t *bib, bplib_crc_parameters_t **params, bp_crcval_t *crc, uint32_t *flags);
 
 #endif /* BIB_H */
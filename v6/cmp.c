@@ -0,0 +1,163 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include "bplib.h"
+#include "bplib_os.h"
+
+#include "cmp.h"
+#include "sdnv.h"
+#include "v6.h"
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * cmp_read -
+ *
+ *  block - pointer to block holding bundle block [INPUT]
+ *  size - size of block [INPUT]
+ *  cmp - pointer to a compression extension block structure to be populated by this function [OUTPUT]
+ *  update_indices - boolean, 0: use <sdnv>.index, 1: update <sdnv>.index as you go [INPUT]
+ *
+ *  Returns:    Next index
+ *-------------------------------------------------------------------------------------*/
+int cmp_read(const void *block, int size, bp_blk_cmp_t *cmp, bool update_indices, uint32_t *flags)
+{
+    uint8_t *buffer     = (uint8_t *)block;
+    int      bytes_read = 0;
+    int      end_index  = 0;
+    uint32_t sdnvflags  = 0;
+
+    /* Check Size */
+    if (size < 1)
+    {
+        return bplog(flags, BP_FLAG_FAILED_TO_PARSE, "Invalid size for the compression block: %d\n", size);
+    }
+
+    /* Read Block Information */
+    if (!update_indices)
+    {
+        sdnv_read(buffer, size, &cmp->bf, &sdnvflags);
+        sdnv_read(buffer, size, &cmp->blklen, &sdnvflags);
+        sdnv_read(buffer, size, &cmp->algorithm, &sdnvflags);
+        end_index = sdnv_read(buffer, size, &cmp->rawsize, &sdnvflags);
+    }
+    else
+    {
+        cmp->bf.width        = 0;
+        cmp->blklen.width    = 0;
+        cmp->algorithm.width = 0;
+        cmp->rawsize.width   = 0;
+
+        cmp->bf.index        = 1;
+        cmp->blklen.index    = sdnv_read(buffer, size, &cmp->bf, &sdnvflags);
+        cmp->algorithm.index = sdnv_read(buffer, size, &cmp->blklen, &sdnvflags);
+        cmp->rawsize.index   = sdnv_read(buffer, size, &cmp->algorithm, &sdnvflags);
+        end_index            = sdnv_read(buffer, size, &cmp->rawsize, &sdnvflags);
+    }
+
+    /* Check Block Length (skips any trailing fields added by later versions) */
+    bytes_read = cmp->algorithm.index + cmp->blklen.value;
+    if (bytes_read > size || bytes_read < end_index)
+    {
+        return bplog(flags, BP_FLAG_FAILED_TO_PARSE, "Compression block terminated prematurely: %d > %d\n",
+                     bytes_read, size);
+    }
+
+    /* Success Oriented Error Checking */
+    if (sdnvflags != 0)
+    {
+        *flags |= sdnvflags;
+        return bplog(flags, BP_FLAG_FAILED_TO_PARSE, "Flags raised during processing of compression block (%08X)\n",
+                     sdnvflags);
+    }
+    else
+    {
+        return bytes_read;
+    }
+}
+
+/*--------------------------------------------------------------------------------------
+ * cmp_write -
+ *
+ *  block - pointer to memory that holds bundle block [OUTPUT]
+ *  size - size of block [INPUT]
+ *  cmp - pointer to a compression extension block structure used to write the block [INPUT]
+ *  update_indices - boolean, 0: use <sdnv>.index, 1: update <sdnv>.index as you go [INPUT]
+ *
+ *  Returns:    Number of bytes written
+ *-------------------------------------------------------------------------------------*/
+int cmp_write(void *block, int size, bp_blk_cmp_t *cmp, bool update_indices, uint32_t *flags)
+{
+    uint8_t *buffer        = (uint8_t *)block;
+    int      bytes_written = 0;
+    uint32_t sdnvflags     = 0;
+
+    /* Check Size */
+    if (size < 1)
+    {
+        return bplog(flags, BP_FLAG_FAILED_TO_PARSE, "Insufficient room for the compression block: %d\n", size);
+    }
+
+    /* Set Block Flags (the payload cannot be used without this block) */
+    cmp->bf.value |= BP_BLK_REPALL_MASK | BP_BLK_DELETENOPROC_MASK;
+
+    /* Write Block */
+    buffer[0] = BP_CMP_BLK_TYPE; /* block type */
+    if (!update_indices)
+    {
+        sdnv_write(buffer, size, cmp->bf, &sdnvflags);
+        sdnv_write(buffer, size, cmp->algorithm, &sdnvflags);
+        bytes_written = sdnv_write(buffer, size, cmp->rawsize, &sdnvflags);
+    }
+    else
+    {
+        cmp->bf.width        = 0;
+        cmp->blklen.width    = 1; /* reserve one byte (7 bits) to hold length of block */
+        cmp->algorithm.width = 0;
+        cmp->rawsize.width   = 0;
+        cmp->bf.index        = 1;
+        cmp->blklen.index    = sdnv_write(buffer, size, cmp->bf, &sdnvflags);
+        cmp->algorithm.index = cmp->blklen.index + cmp->blklen.width;
+        cmp->rawsize.index   = sdnv_write(buffer, size, cmp->algorithm, &sdnvflags);
+        bytes_written        = sdnv_write(buffer, size, cmp->rawsize, &sdnvflags);
+    }
+
+    /* Write Block Length */
+    cmp->blklen.value = bytes_written - cmp->algorithm.index;
+    sdnv_write(buffer, size, cmp->blklen, &sdnvflags);
+
+    /* Success Oriented Error Checking */
+    if (sdnvflags != 0)
+    {
+        *flags |= sdnvflags;
+        return bplog(flags, BP_FLAG_FAILED_TO_PARSE, "Flags raised during processing of compression block (%08X)\n",
+                     sdnvflags);
+    }
+    else
+    {
+        return bytes_written;
+    }
+}
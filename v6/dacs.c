@@ -30,6 +30,12 @@
 #include "sdnv.h"
 #include "dacs.h"
 
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+#define DACS_FILL_MAX_WIDTH ((int)((sizeof(bp_val_t) * 8 + 6) / 7)) /* bytes in the longest SDNV of a fill */
+
 /******************************************************************************
  EXPORTED FUNCTIONS
  ******************************************************************************/
@@ -39,15 +45,15 @@
  *
  *  rec - buffer containing the ACS record [OUTPUT]
  *  size - size of buffer [INPUT]
- *  max_fills_per_dacs - the maximum number of allowable fills for each dacs
- *  tree - a rb_tree ptr containing the cid ranges for the bundle. The tree nodes will
- *      be deleted as they are written to the dacs. [OUTPUT]
- *  iter - a ptr to a ptr the next rb_node in the tree to extract the fill information
- *      and then delete. [OUTPUT]
+ *  max_fills_per_dacs - the maximum number of allowable fills for each dacs; fewer are written
+ *      when the next pair of fills might not fit in the buffer
+ *  custody - the custody aggregator (rb_tree or cbitmap) containing the cid ranges for the
+ *      bundle. The ranges will be deleted as they are written to the dacs; the aggregator's
+ *      iterator must already be set to its first range. [OUTPUT]
  *
  *  Returns:    Number of bytes processed of bundle
  *-------------------------------------------------------------------------------------*/
-int dacs_write(uint8_t *rec, int size, int max_fills_per_dacs, rb_tree_t *tree, uint32_t *flags)
+int dacs_write(uint8_t *rec, int size, int max_fills_per_dacs, bp_custody_t *custody, uint32_t *flags)
 {
     bp_field_t cid       = {0, 2, 0};
     bp_field_t fill      = {0, 0, 0};
@@ -64,19 +70,20 @@ int dacs_write(uint8_t *rec, int size, int max_fills_per_dacs, rb_tree_t *tree,
     rb_range_t range;
     rb_range_t prev_range;
 
-    /* Get the first available range from the rb tree and fill it. */
-    rb_tree_get_next(tree, &range, true, false);
+    /* Get the first available range from the custody aggregator and fill it. */
+    custody->get_next(custody->tree, &range, true, false);
     cid.value  = range.value;
     fill.index = sdnv_write(rec, size, cid, &sdnvflags);
     fill.value = range.offset + 1;
     fill.index = sdnv_write(rec, size, fill, &sdnvflags);
     count_fills += 2;
 
-    /* Traverse tree in order and write out fills to dacs. */
-    while (count_fills < max_fills_per_dacs && !rb_tree_is_empty(tree))
+    /* Traverse ranges in order and write out fills to dacs. */
+    while (count_fills < max_fills_per_dacs && (fill.index + (2 * DACS_FILL_MAX_WIDTH)) <= size &&
+           !custody->is_empty(custody->tree))
     {
         prev_range = range;
-        rb_tree_get_next(tree, &range, true, false);
+        custody->get_next(custody->tree, &range, true, false);
 
         /* Write range of missing cid.
            Calculate the missing values between the current and previous node. */
@@ -105,7 +112,6 @@ int dacs_write(uint8_t *rec, int size, int max_fills_per_dacs, rb_tree_t *tree,
  *-------------------------------------------------------------------------------------*/
 int dacs_read(const uint8_t *rec, int rec_size, int *num_acks, bp_delete_func_t ack, void *ack_parm, uint32_t *flags)
 {
-    bp_val_t   i;
     bp_field_t cid         = {0, 2, 0};
     bp_field_t fill        = {0, 0, 0};
     int        cidin       = true;
@@ -137,21 +143,17 @@ int dacs_read(const uint8_t *rec, int rec_size, int *num_acks, bp_delete_func_t
         /* Process Custody IDs */
         if (cidin == true && ack_success)
         {
-            /* Free Bundles */
-            cidin = false;
-            for (i = 0; i < fill.value; i++)
+            /* Free Bundles (entire fill at once) */
+            int num_deleted = 0;
+            cidin           = false;
+            int status      = ack(ack_parm, cid.value, fill.value, &num_deleted, flags);
+            ack_count += num_deleted;
+
+            /* Set Return Status */
+            if (status != BP_SUCCESS && ret_status != BP_SUCCESS)
             {
-                /* Acknowledge Bundle CID */
-                int status = ack(ack_parm, cid.value + i, flags);
-                if (status == BP_SUCCESS)
-                    ack_count++;
-
-                /* Set Return Status */
-                if (status != BP_SUCCESS && ret_status != BP_SUCCESS)
-                {
-                    /* Save Off First Failure */
-                    ret_status = status;
-                }
+                /* Save Off First Failure */
+                ret_status = status;
             }
         }
         else
@@ -33,7 +33,7 @@
  PROTOTYPES
  ******************************************************************************/
 
-int dacs_write(uint8_t *rec, int size, int max_fills_per_dacs, rb_tree_t *tree, uint32_t *flags);
+int dacs_write(uint8_t *rec, int size, int max_fills_per_dacs, bp_custody_t *custody, uint32_t *flags);
 int dacs_read(const uint8_t *rec, int rec_size, int *num_acks, bp_delete_func_t ack, void *ack_parm, uint32_t *flags);
 
 #endif /* DACS_H */
@@ -27,6 +27,50 @@
 
 #include "sdnv.h"
 
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+/* Decode SDNVs a Word at a Time when the Compiler can Count Leading Zeros */
+#if defined(__GNUC__) || defined(__clang__)
+#define SDNV_WORD_ACCESS
+#endif
+
+/* Bytes in a Word, the Longest SDNV Decoded a Word at a Time */
+#define SDNV_WORD_SIZE 8
+
+/* Continuation and Value Bits of Each Byte of a Word */
+#define SDNV_WORD_HIGH_BITS 0x8080808080808080ULL
+#define SDNV_WORD_LOW_BITS  0x7F7F7F7F7F7F7F7FULL
+
+/******************************************************************************
+ LOCAL FUNCTIONS
+ ******************************************************************************/
+
+#ifdef SDNV_WORD_ACCESS
+
+/*--------------------------------------------------------------------------------------
+ * sdnv_load - reads eight bytes so that the first byte is the most significant
+ *-------------------------------------------------------------------------------------*/
+static uint64_t sdnv_load(const uint8_t *ptr)
+{
+    return ((uint64_t)ptr[0] << 56) | ((uint64_t)ptr[1] << 48) | ((uint64_t)ptr[2] << 40) |
+           ((uint64_t)ptr[3] << 32) | ((uint64_t)ptr[4] << 24) | ((uint64_t)ptr[5] << 16) |
+           ((uint64_t)ptr[6] << 8) | (uint64_t)ptr[7];
+}
+
+/*--------------------------------------------------------------------------------------
+ * sdnv_compact - packs the seven bit groups held in each byte into a 56-bit value
+ *-------------------------------------------------------------------------------------*/
+static uint64_t sdnv_compact(uint64_t groups)
+{
+    groups = (groups & 0x007F007F007F007FULL) | ((groups & 0x7F007F007F007F00ULL) >> 1);
+    groups = (groups & 0x00003FFF00003FFFULL) | ((groups & 0x3FFF00003FFF0000ULL) >> 2);
+    return (groups & 0x000000000FFFFFFFULL) | ((groups & 0x0FFFFFFF00000000ULL) >> 4);
+}
+
+#endif
+
 /******************************************************************************
  EXPORTED FUNCTIONS
  ******************************************************************************/
@@ -60,6 +104,25 @@ int sdnv_read(const uint8_t *block, int size, bp_field_t *sdnv, uint32_t *flags)
         width = sdnv->width;
     }
 
+#ifdef SDNV_WORD_ACCESS
+    /* Read SDNV a Word at a Time - the first byte without a continuation bit ends it */
+    if ((size - sdnv->index) >= SDNV_WORD_SIZE)
+    {
+        uint64_t word = sdnv_load(&block[sdnv->index]);
+        uint64_t ends = ~word & SDNV_WORD_HIGH_BITS;
+        if (ends != 0)
+        {
+            int      len   = (__builtin_clzll(ends) / 8) + 1;
+            uint64_t value = sdnv_compact((word >> ((SDNV_WORD_SIZE - len) * 8)) & SDNV_WORD_LOW_BITS);
+            if (len <= width && (uint64_t)(bp_val_t)value == value)
+            {
+                sdnv->value = (bp_val_t)value;
+                return sdnv->index + len;
+            }
+        }
+    }
+#endif
+
     /* Read SDNV */
     for (i = sdnv->index; (i < (sdnv->index + width)) && (i < size); i++)
     {
@@ -31,6 +31,7 @@
 #include "bib.h"
 #include "pay.h"
 #include "cteb.h"
+#include "cmp.h"
 #include "dacs.h"
 #include "sdnv.h"
 
@@ -49,9 +50,32 @@ typedef struct
     bp_blk_pri_t  primary_block;
     bp_blk_cteb_t custody_block;
     bp_blk_bib_t  integrity_block;
+    bp_blk_cmp_t  compression_block;
     bp_blk_pay_t  payload_block;
+    /* Payload Being Sent (see v6_begin_adu) */
+    bp_val_t adu_offset; /* offset of the bundles' payload into the ADU (non-zero when forwarding a fragment) */
+    bp_val_t adu_length; /* length of the ADU */
+    bool     fragmented; /* fragment fields were added to the header for the payload */
 } bp_v6blocks_t;
 
+/* Prebuilt Header - the bundle data and blocks left by v6_build for a destination */
+typedef struct
+{
+    bp_ipn_t         destination_node;
+    bp_ipn_t         destination_service;
+    unsigned long    last_used; /* zero when template is empty */
+    bp_bundle_data_t data;
+    bp_v6blocks_t    blocks;
+} bp_v6template_t;
+
+/* Prebuilt Headers of a Bundle - the least recently used is replaced first */
+typedef struct
+{
+    int             count;
+    unsigned long   clock; /* incremented each time a template is used */
+    bp_v6template_t templates[];
+} bp_v6templates_t;
+
 /******************************************************************************
  FILE DATA
  ******************************************************************************
@@ -106,6 +130,10 @@ static const bp_blk_bib_t bundle_bib_blk = {
     .security_result_length = {0, 12, 1},
 };
 
+static const bp_blk_cmp_t bundle_cmp_blk = {
+    /* Value   Index   Width */
+    .bf = {0, 1, 1}, .blklen = {0, 2, 1}, .algorithm = {0, 3, 1}, .rawsize = {0, 4, 4}};
+
 static const bp_blk_pay_t bundle_pay_blk = {
     /* Value     Index   Width */
     .bf      = {0, 1, 1},
@@ -143,8 +171,28 @@ int v6_build(bp_bundle_t *bundle, bp_blk_pri_t *pri, uint8_t *hdr_buf, int hdr_l
     /* Initialize Primary Block */
     if (pri)
     {
-        /* User Provided Primary Block */
-        blocks->primary_block = *pri;
+        /* User Provided Primary Block - laid out like a library block, since the indices of a
+         * received block are those of its own encoding and its field widths are left at zero */
+        blocks->primary_block                  = bundle_pri_blk;
+        blocks->primary_block.dstnode.value    = pri->dstnode.value;
+        blocks->primary_block.dstserv.value    = pri->dstserv.value;
+        blocks->primary_block.srcnode.value    = pri->srcnode.value;
+        blocks->primary_block.srcserv.value    = pri->srcserv.value;
+        blocks->primary_block.rptnode.value    = pri->rptnode.value;
+        blocks->primary_block.rptserv.value    = pri->rptserv.value;
+        blocks->primary_block.cstnode.value    = pri->cstnode.value;
+        blocks->primary_block.cstserv.value    = pri->cstserv.value;
+        blocks->primary_block.createsec.value  = pri->createsec.value;
+        blocks->primary_block.createseq.value  = pri->createseq.value;
+        blocks->primary_block.lifetime.value   = pri->lifetime.value;
+        blocks->primary_block.fragoffset.value = pri->fragoffset.value;
+        blocks->primary_block.paylen.value     = pri->paylen.value;
+        blocks->primary_block.is_admin_rec     = pri->is_admin_rec;
+        blocks->primary_block.is_frag          = pri->is_frag;
+        blocks->primary_block.allow_frag       = pri->allow_frag;
+        blocks->primary_block.cst_rqst         = pri->cst_rqst;
+        blocks->primary_block.ack_app          = pri->ack_app;
+        blocks->primary_block.cos              = pri->cos;
 
         /* Set Pre-Built Flag to FALSE */
         bundle->prebuilt = false;
@@ -247,6 +295,30 @@ int v6_build(bp_bundle_t *bundle, bp_blk_pri_t *pri, uint8_t *hdr_buf, int hdr_l
         data->biboffset = 0;
     }
 
+    /* Write Compression Block (fields set per bundle by v6_set_compression) */
+    if (!pri && bundle->attributes.payload_compressor && !bundle->attributes.admin_record)
+    {
+        /* Initialize Block */
+        blocks->compression_block = bundle_cmp_blk;
+
+        /* Populate Data */
+        data->cmpoffset = hdr_index;
+        bytes_written   = cmp_write(&data->header[hdr_index], BP_BUNDLE_HDR_BUF_SIZE - hdr_index,
+                                    &blocks->compression_block, false, flags);
+
+        /* Check Status */
+        if (bytes_written < 0)
+        {
+            return bplog(flags, BP_FLAG_FAILED_TO_PARSE, "Failed (%d) to write compression block of bundle\n",
+                         bytes_written);
+        }
+        hdr_index += bytes_written;
+    }
+    else
+    {
+        data->cmpoffset = 0;
+    }
+
     /* Copy Non-excluded Header Regions */
     if (hdr_index + hdr_len < BP_BUNDLE_HDR_BUF_SIZE)
     {
@@ -269,6 +341,53 @@ int v6_build(bp_bundle_t *bundle, bp_blk_pri_t *pri, uint8_t *hdr_buf, int hdr_l
     return BP_SUCCESS;
 }
 
+/*--------------------------------------------------------------------------------------
+ * v6_fragment_header -
+ *
+ *  Adds the fragment offset and total payload length fields to the primary block of a
+ *  header built for whole payloads, or removes them again, moving the blocks that follow
+ *-------------------------------------------------------------------------------------*/
+int v6_fragment_header(bp_bundle_t *bundle, bool is_frag, uint32_t *flags)
+{
+    bp_bundle_data_t *data    = &bundle->data;
+    bp_v6blocks_t    *blocks  = (bp_v6blocks_t *)bundle->blocks;
+    bp_blk_pri_t     *pri     = &blocks->primary_block;
+    int               pri_end = pri->fragoffset.index; /* dictionary length is the last field of a whole payload */
+    int               growth  = pri->fragoffset.width + pri->paylen.width;
+
+    /* Move Blocks Following the Primary Block (payload block is written for each bundle) */
+    if (is_frag)
+    {
+        if (v6_header_size(bundle) + growth > BP_BUNDLE_HDR_BUF_SIZE)
+        {
+            return bplog(flags, BP_FLAG_BUNDLE_TOO_LARGE, "Fragment header exceeds maximum header size (%d)\n",
+                         v6_header_size(bundle) + growth);
+        }
+        memmove(&data->header[pri_end + growth], &data->header[pri_end], data->payoffset - pri_end);
+    }
+    else
+    {
+        memmove(&data->header[pri_end], &data->header[pri_end + growth], data->payoffset - pri_end - growth);
+        growth = -growth;
+    }
+    data->cteboffset += data->cteboffset ? growth : 0;
+    data->biboffset += data->biboffset ? growth : 0;
+    data->cmpoffset += data->cmpoffset ? growth : 0;
+    data->payoffset += growth;
+
+    /* Write Primary Block */
+    pri->is_frag      = is_frag;
+    int bytes_written = pri_write(data->header, BP_BUNDLE_HDR_BUF_SIZE, pri, false, flags);
+    if (bytes_written < 0)
+    {
+        return bplog(flags, BP_FLAG_FAILED_TO_PARSE, "Failed (%d) to write primary block of fragment\n",
+                     bytes_written);
+    }
+
+    /* Return Success */
+    return BP_SUCCESS;
+}
+
 /******************************************************************************
  EXPORTED FUNCTIONS
  ******************************************************************************/
@@ -292,9 +411,10 @@ int v6_initialize(void)
 /*--------------------------------------------------------------------------------------
  * v6_create -
  *
- *  This initializes a bundle structure
+ *  This initializes a bundle structure that keeps the prebuilt headers of up to
+ *  templates destinations (see v6_populate_bundle)
  *-------------------------------------------------------------------------------------*/
-int v6_create(bp_bundle_t *bundle, bp_route_t route, bp_attr_t attributes)
+int v6_create(bp_bundle_t *bundle, bp_route_t route, bp_attr_t attributes, int templates)
 {
     int status = BP_SUCCESS;
 
@@ -303,15 +423,33 @@ int v6_create(bp_bundle_t *bundle, bp_route_t route, bp_attr_t attributes)
     bundle->attributes = attributes;
 
     /* Initialize Blocks */
-    bundle->blocks = NULL;
+    bundle->blocks    = NULL;
+    bundle->templates = NULL;
 
     /* Allocate Blocks */
-    bundle->blocks = (bp_v6blocks_t *)bplib_os_calloc(sizeof(bp_v6blocks_t));
+    bundle->blocks = (bp_v6blocks_t *)bplib_os_calloc_tag(sizeof(bp_v6blocks_t), BP_MEM_CHANNEL);
     if (bundle->blocks == NULL)
     {
         status = BP_ERROR;
     }
 
+    /* Allocate Header Templates */
+    if (status == BP_SUCCESS && templates > 0)
+    {
+        bp_v6templates_t *cache =
+            (bp_v6templates_t *)bplib_os_calloc_tag(sizeof(bp_v6templates_t) + (templates * sizeof(bp_v6template_t)),
+                                                    BP_MEM_CHANNEL);
+        if (cache == NULL)
+        {
+            status = BP_ERROR;
+        }
+        else
+        {
+            cache->count      = templates;
+            bundle->templates = cache;
+        }
+    }
+
     /* Mark Bundle to Prebuild */
     bundle->prebuilt = false;
 
@@ -330,57 +468,126 @@ int v6_destroy(bp_bundle_t *bundle)
     {
         bplib_os_free(bundle->blocks);
     }
-    bundle->blocks = NULL;
+    if (bundle->templates)
+    {
+        bplib_os_free(bundle->templates);
+    }
+    bundle->blocks    = NULL;
+    bundle->templates = NULL;
     return BP_SUCCESS;
 }
 
 /*--------------------------------------------------------------------------------------
  * v6_populate_bundle -
  *
- *  This populates a new bundle's fields
+ *  This populates a new bundle's fields.  The header built for a destination is kept
+ *  as a template so that switching back to that destination (a DACS addressed to
+ *  another custodian, or the channel's own bundles after forwarding one) copies the
+ *  header and its block offsets instead of building it again.
  *-------------------------------------------------------------------------------------*/
 int v6_populate_bundle(bp_bundle_t *bundle, uint32_t *flags)
 {
-    return v6_build(bundle, NULL, NULL, 0, flags);
+    bp_v6templates_t *cache  = (bp_v6templates_t *)bundle->templates;
+    bp_v6template_t  *oldest = NULL;
+    int               status, i;
+
+    /* Restore Prebuilt Header of Destination */
+    if (cache)
+    {
+        for (i = 0; i < cache->count; i++)
+        {
+            bp_v6template_t *entry = &cache->templates[i];
+            if (entry->last_used != 0 && entry->destination_node == bundle->route.destination_node &&
+                entry->destination_service == bundle->route.destination_service)
+            {
+                entry->last_used                 = ++cache->clock;
+                bundle->data                     = entry->data;
+                *(bp_v6blocks_t *)bundle->blocks = entry->blocks;
+                bundle->prebuilt                 = true;
+                return BP_SUCCESS;
+            }
+            else if (oldest == NULL || entry->last_used < oldest->last_used)
+            {
+                oldest = entry;
+            }
+        }
+    }
+
+    /* Build Header */
+    status = v6_build(bundle, NULL, NULL, 0, flags);
+
+    /* Save Header as Template of Destination */
+    if (status == BP_SUCCESS && oldest)
+    {
+        oldest->destination_node    = bundle->route.destination_node;
+        oldest->destination_service = bundle->route.destination_service;
+        oldest->last_used           = ++cache->clock;
+        oldest->data                = bundle->data;
+        oldest->blocks              = *(bp_v6blocks_t *)bundle->blocks;
+    }
+
+    /* Return Status */
+    return status;
 }
 
 /*--------------------------------------------------------------------------------------
- * v6_send_bundle -
+ * v6_invalidate_bundle -
+ *
+ *  Marks a bundle whose attributes changed to be built again, discarding its templates
  *-------------------------------------------------------------------------------------*/
-int v6_send_bundle(bp_bundle_t *bundle, const uint8_t *buffer, int size, bp_create_func_t create, void *parm,
-                   int timeout, uint32_t *flags)
+int v6_invalidate_bundle(bp_bundle_t *bundle)
 {
-    int               payload_offset = 0;
-    bp_bundle_data_t *data           = &bundle->data;
-    bp_v6blocks_t    *blocks         = (bp_v6blocks_t *)bundle->blocks;
-    bp_blk_pri_t     *pri            = &blocks->primary_block;
-    bp_blk_bib_t     *bib            = &blocks->integrity_block;
-    bp_blk_pay_t     *pay            = &blocks->payload_block;
-
-    /* Update Payload Block */
-    pay->payptr  = buffer;
-    pay->paysize = size;
+    bp_v6templates_t *cache = (bp_v6templates_t *)bundle->templates;
+    int               i;
 
-    /* Check Fragmentation */
-    int max_paysize = bundle->attributes.max_length - data->headersize;
-    if (pay->paysize > max_paysize)
+    /* Empty Templates */
+    if (cache)
     {
-        if (bundle->attributes.allow_fragmentation)
-        {
-            pri->is_frag = true;
-        }
-        else
+        for (i = 0; i < cache->count; i++)
         {
-            return bplog(flags, BP_FLAG_BUNDLE_TOO_LARGE, "Unable to fragment forwarded bundle (%d > %d)\n",
-                         pay->paysize, max_paysize);
+            cache->templates[i].last_used = 0;
         }
     }
-    else if (max_paysize <= 0)
+
+    /* Mark Bundle to Prebuild */
+    bundle->prebuilt = false;
+
+    /* Return Success */
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * v6_begin_adu -
+ *
+ *  Starts sending a payload (ADU) of the given size in one or more bundles: sets the
+ *  creation time of the bundles and adds fragment fields to the header when the payload
+ *  does not fit in one bundle.  Returns the number of payload bytes carried by each
+ *  bundle (all but the last are full), or an error code.
+ *-------------------------------------------------------------------------------------*/
+int v6_begin_adu(bp_bundle_t *bundle, bp_val_t size, uint32_t *flags)
+{
+    bp_bundle_data_t *data   = &bundle->data;
+    bp_v6blocks_t    *blocks = (bp_v6blocks_t *)bundle->blocks;
+    bp_blk_pri_t     *pri    = &blocks->primary_block;
+
+    /* Check Fragmentation */
+    int max_paysize = bundle->attributes.max_length - v6_header_size(bundle);
+    if (max_paysize <= 0)
     {
         return bplog(flags, BP_FLAG_BUNDLE_TOO_LARGE, "Bundle header blocks exceed maximum size of bundle (%d > %d)\n",
-                     data->headersize, bundle->attributes.max_length);
+                     v6_header_size(bundle), bundle->attributes.max_length);
+    }
+    else if (size > (bp_val_t)max_paysize && !bundle->attributes.allow_fragmentation)
+    {
+        return bplog(flags, BP_FLAG_BUNDLE_TOO_LARGE, "Unable to fragment forwarded bundle (%lu > %d)\n",
+                     (unsigned long)size, max_paysize);
     }
 
+    /* Set ADU of Fragments (fragments of a forwarded fragment keep its offset and length) */
+    blocks->adu_offset = pri->is_frag ? pri->fragoffset.value : 0;
+    blocks->adu_length = pri->is_frag ? pri->paylen.value : size;
+    blocks->fragmented = false;
+
     /* Check if Time Needs to be Set  */
     bp_field_t lifetime = pri->lifetime;
     if (bundle->prebuilt)
@@ -430,66 +637,196 @@ int v6_send_bundle(bp_bundle_t *bundle, const uint8_t *buffer, int size, bp_crea
         }
     }
 
-    /* Enqueue Bundle */
-    while (payload_offset < pay->paysize)
+    /* Add Fragment Fields to Header */
+    if (size > (bp_val_t)max_paysize && !pri->is_frag)
     {
-        /* Calculate Storage Header Size and Fragment Size */
-        int payload_remaining = pay->paysize - payload_offset;
-        int fragment_size     = max_paysize < payload_remaining ? max_paysize : payload_remaining;
-
-        /* Update Primary Block Fragmentation */
-        if (pri->is_frag)
+        int status = v6_fragment_header(bundle, true, flags);
+        if (status != BP_SUCCESS)
         {
-            pri->fragoffset.value = payload_offset;
-            pri->paylen.value     = pay->paysize;
-            sdnv_write(data->header, BP_BUNDLE_HDR_BUF_SIZE, pri->fragoffset, flags);
-            sdnv_write(data->header, BP_BUNDLE_HDR_BUF_SIZE, pri->paylen, flags);
+            v6_fragment_header(bundle, false, flags);
+            return status;
         }
+        blocks->fragmented = true;
+        max_paysize -= pri->fragoffset.width + pri->paylen.width;
+    }
 
-        /* Update Integrity Block */
-        if (data->biboffset != 0)
-        {
-            bib_update(&data->header[data->biboffset], BP_BUNDLE_HDR_BUF_SIZE - data->biboffset,
-                       &pay->payptr[payload_offset], fragment_size, bib, flags);
-        }
+    /* Return Payload Bytes per Bundle */
+    return max_paysize;
+}
 
-        /* Write Payload Block (static portion) */
-        pay->blklen.value = fragment_size;
-        int bytes_written =
-            pay_write(&data->header[data->payoffset], BP_BUNDLE_HDR_BUF_SIZE - data->payoffset, pay, false, flags);
-        if (bytes_written < 0)
-        {
-            return bplog(flags, BP_FLAG_FAILED_TO_PARSE,
-                         "Failed (%d) to write payload block (static portion) of bundle\n", bytes_written);
-        }
-        data->headersize = data->payoffset + bytes_written;
-        data->bundlesize = data->headersize + fragment_size;
+/*--------------------------------------------------------------------------------------
+ * v6_send_fragment -
+ *
+ *  Stores the bundle carrying size bytes of the payload started by v6_begin_adu,
+ *  beginning offset bytes into it
+ *-------------------------------------------------------------------------------------*/
+int v6_send_fragment(bp_bundle_t *bundle, const uint8_t *buffer, int size, bp_val_t offset, bp_create_func_t create,
+                     void *parm, int timeout, uint32_t *flags)
+{
+    bp_bundle_data_t *data   = &bundle->data;
+    bp_v6blocks_t    *blocks = (bp_v6blocks_t *)bundle->blocks;
+    bp_blk_pri_t     *pri    = &blocks->primary_block;
+    bp_blk_bib_t     *bib    = &blocks->integrity_block;
 
-        /* Enqueue Bundle */
-        int status = create(parm, pri->is_admin_rec, &pay->payptr[payload_offset], fragment_size, timeout);
-        if (status != BP_SUCCESS)
-        {
-            return bplog(flags, BP_FLAG_STORE_FAILURE, "Failed (%d) to store bundle in storage system\n", status);
-        }
+    /* Update Primary Block Fragmentation */
+    if (pri->is_frag)
+    {
+        pri->fragoffset.value = blocks->adu_offset + offset;
+        pri->paylen.value     = blocks->adu_length;
+        sdnv_write(data->header, BP_BUNDLE_HDR_BUF_SIZE, pri->fragoffset, flags);
+        sdnv_write(data->header, BP_BUNDLE_HDR_BUF_SIZE, pri->paylen, flags);
+    }
 
-        payload_offset += fragment_size;
+    /* Update Integrity Block */
+    if (data->biboffset != 0)
+    {
+        bib_update(&data->header[data->biboffset], BP_BUNDLE_HDR_BUF_SIZE - data->biboffset, buffer, size, bib,
+                   flags);
     }
 
-    /* Increment Sequence Count (done here since now bundle successfully stored) */
-    if (bundle->prebuilt)
+    /* Write Payload Block (static portion, block length of the fragment) */
+    bp_blk_pay_t frag_pay = blocks->payload_block;
+    frag_pay.payptr       = buffer;
+    frag_pay.paysize      = size;
+    int bytes_written =
+        pay_write(&data->header[data->payoffset], BP_BUNDLE_HDR_BUF_SIZE - data->payoffset, &frag_pay, false, flags);
+    if (bytes_written < 0)
+    {
+        return bplog(flags, BP_FLAG_FAILED_TO_PARSE, "Failed (%d) to write payload block (static portion) of bundle\n",
+                     bytes_written);
+    }
+    data->headersize = data->payoffset + bytes_written;
+    data->bundlesize = data->headersize + size;
+
+    /* Enqueue Bundle */
+    int status = create(parm, pri->is_admin_rec, buffer, size, timeout);
+    if (status != BP_SUCCESS)
+    {
+        return bplog(flags, BP_FLAG_STORE_FAILURE, "Failed (%d) to store bundle in storage system\n", status);
+    }
+
+    /* Return Success */
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * v6_end_adu -
+ *
+ *  Finishes a payload started by v6_begin_adu, restoring the header of whole payloads;
+ *  once any of its bundles were stored, the next payload gets a new creation sequence
+ *-------------------------------------------------------------------------------------*/
+int v6_end_adu(bp_bundle_t *bundle, bool sent, uint32_t *flags)
+{
+    bp_v6blocks_t *blocks = (bp_v6blocks_t *)bundle->blocks;
+    bp_blk_pri_t  *pri    = &blocks->primary_block;
+    int            status = BP_SUCCESS;
+
+    /* Restore Header of Whole Payloads */
+    if (blocks->fragmented)
+    {
+        status             = v6_fragment_header(bundle, false, flags);
+        blocks->fragmented = false;
+    }
+
+    /* Increment Sequence Count (done here since now bundles successfully stored) */
+    if (sent && bundle->prebuilt)
     {
         pri->createseq.value++;
         sdnv_mask(&pri->createseq);
     }
 
-    /* Return Payload Bytes Stored */
+    /* Return Status */
+    return status;
+}
+
+/*--------------------------------------------------------------------------------------
+ * v6_send_bundle -
+ *-------------------------------------------------------------------------------------*/
+int v6_send_bundle(bp_bundle_t *bundle, const uint8_t *buffer, int size, bp_create_func_t create, void *parm,
+                   int timeout, uint32_t *flags)
+{
+    int offset = 0;
+    int status = BP_SUCCESS;
+
+    /* Start Payload */
+    int max_paysize = v6_begin_adu(bundle, size, flags);
+    if (max_paysize < 0)
+    {
+        return max_paysize;
+    }
+
+    /* Enqueue Bundles */
+    while (status == BP_SUCCESS && offset < size)
+    {
+        int fragment_size = size - offset < max_paysize ? size - offset : max_paysize;
+        status = v6_send_fragment(bundle, &buffer[offset], fragment_size, offset, create, parm, timeout, flags);
+        if (status == BP_SUCCESS)
+        {
+            offset += fragment_size;
+        }
+    }
+
+    /* Finish Payload */
+    v6_end_adu(bundle, offset > 0, flags);
+
+    /* Return Status */
+    return status;
+}
+
+/*--------------------------------------------------------------------------------------
+ * v6_header_size -
+ *
+ *  Returns the size of the header (all blocks up to the payload data) of bundles
+ *  sent with the current prebuilt bundle
+ *-------------------------------------------------------------------------------------*/
+int v6_header_size(bp_bundle_t *bundle)
+{
+    bp_v6blocks_t *blocks = (bp_v6blocks_t *)bundle->blocks;
+    bp_blk_pay_t  *pay    = &blocks->payload_block;
+
+    /* Payload Block Static Portion is Fixed Width (see pay_write) */
+    return bundle->data.payoffset + pay->blklen.index + pay->blklen.width;
+}
+
+/*--------------------------------------------------------------------------------------
+ * v6_set_compression -
+ *
+ *  Sets the compression block of bundles sent with the current prebuilt bundle;
+ *  an algorithm of zero marks the payload as not compressed
+ *-------------------------------------------------------------------------------------*/
+int v6_set_compression(bp_bundle_t *bundle, int algorithm, int rawsize, uint32_t *flags)
+{
+    bp_bundle_data_t *data   = &bundle->data;
+    bp_v6blocks_t    *blocks = (bp_v6blocks_t *)bundle->blocks;
+    bp_blk_cmp_t     *cmp    = &blocks->compression_block;
+
+    /* Check for Compression Block */
+    if (data->cmpoffset == 0)
+    {
+        return bplog(flags, BP_FLAG_API_ERROR, "Bundle has no compression block\n");
+    }
+    else if (rawsize >= (1 << (cmp->rawsize.width * 7)))
+    {
+        return bplog(flags, BP_FLAG_BUNDLE_TOO_LARGE, "Payload too large for compression block: %d\n", rawsize);
+    }
+
+    /* Write Fields */
+    cmp->algorithm.value = algorithm;
+    cmp->rawsize.value   = rawsize;
+    sdnv_write(&data->header[data->cmpoffset], BP_BUNDLE_HDR_BUF_SIZE - data->cmpoffset, cmp->algorithm, flags);
+    sdnv_write(&data->header[data->cmpoffset], BP_BUNDLE_HDR_BUF_SIZE - data->cmpoffset, cmp->rawsize, flags);
+
     return BP_SUCCESS;
 }
 
 /*--------------------------------------------------------------------------------------
- * v6_receive_bundle -
+ * v6_decode - parses and verifies a received bundle
+ *
+ *  the bundle is only read unless build is set, in which case the header of a bundle
+ *  being forwarded is built into it; the integrity check of a forwarded bundle is
+ *  skipped when building since it was verified when the bundle was first decoded
  *-------------------------------------------------------------------------------------*/
-int v6_receive_bundle(bp_bundle_t *bundle, const uint8_t *buffer, int size, bp_payload_t *payload, uint32_t *flags)
+int v6_decode(bp_bundle_t *bundle, const uint8_t *buffer, int size, bp_payload_t *payload, bool build, uint32_t *flags)
 {
     int status = BP_SUCCESS;
 
@@ -509,6 +846,10 @@ int v6_receive_bundle(bp_bundle_t *bundle, const uint8_t *buffer, int size, bp_p
     int          bib_index;
     bp_blk_bib_t bib_blk;
 
+    bool         cmp_present = false;
+    int          cmp_index;
+    bp_blk_cmp_t cmp_blk;
+
     int          pay_index;
     bp_blk_pay_t pay_blk;
 
@@ -614,6 +955,22 @@ int v6_receive_bundle(bp_bundle_t *bundle, const uint8_t *buffer, int size, bp_p
 
             index += bytes_read;
         }
+        else if (blk_type == BP_CMP_BLK_TYPE)
+        {
+            /* Mark Start of Compression Region (kept when forwarded) */
+            cmp_present = true;
+            cmp_index   = index;
+
+            /* Read Compression Block */
+            bytes_read = cmp_read(&buffer[cmp_index], size - cmp_index, &cmp_blk, true, flags);
+            if (bytes_read < 0)
+            {
+                return bplog(flags, BP_FLAG_FAILED_TO_PARSE, "Failed to parse compression block at offset %d\n",
+                             cmp_index);
+            }
+
+            index += bytes_read;
+        }
         else if (blk_type != BP_PAY_BLK_TYPE) /* skip over block */
         {
             bp_field_t blk_flags   = {0, 1, 0};
@@ -686,15 +1043,37 @@ int v6_receive_bundle(bp_bundle_t *bundle, const uint8_t *buffer, int size, bp_p
             exclude[ei++] = index + pay_blk.paysize;
 
             /* Set Returned Payload */
-            payload->data.exprtime    = exprtime;
-            payload->data.ackapp      = pri_blk.ack_app;
-            payload->data.payloadsize = pay_blk.paysize;
-            payload->memptr           = pay_blk.payptr;
-
-            /* Perform Integrity Check */
+            payload->data.exprtime     = exprtime;
+            payload->data.ackapp       = pri_blk.ack_app;
+            payload->data.payloadsize  = pay_blk.paysize;
+            payload->data.compressor   = cmp_present ? (int)cmp_blk.algorithm.value : 0;
+            payload->data.rawsize      = cmp_present ? (int)cmp_blk.rawsize.value : 0;
+            payload->data.decompressed = false;
+            payload->memptr            = pay_blk.payptr;
+            payload->crc_params        = NULL;
+
+            /* Set Returned Fragment Information */
+            payload->adu.node      = (bp_ipn_t)pri_blk.srcnode.value;
+            payload->adu.service   = (bp_ipn_t)pri_blk.srcserv.value;
+            payload->adu.createsec = pri_blk.createsec.value;
+            payload->adu.createseq = pri_blk.createseq.value;
+            payload->fragoffset    = pri_blk.is_frag ? pri_blk.fragoffset.value : 0;
+            payload->adulen        = pri_blk.is_frag ? pri_blk.paylen.value : 0;
+
+            /* Perform Integrity Check - payloads accepted locally are checked as they are stored */
             if (bib_present)
             {
-                status = bib_verify(pay_blk.payptr, pay_blk.paysize, &bib_blk, flags);
+                bool local    = (pri_blk.dstserv.value == 0) || (pri_blk.dstserv.value == bundle->route.local_service);
+                bool accepted = (pri_blk.dstnode.value == bundle->route.local_node) && !pri_blk.is_admin_rec && local;
+                if (accepted)
+                {
+                    status = bib_defer(&bib_blk, &payload->crc_params, &payload->crc, flags);
+                }
+                else if (!build)
+                {
+                    status = bib_verify(pay_blk.payptr, pay_blk.paysize, &bib_blk, flags);
+                }
+
                 if (status != BP_SUCCESS)
                 {
                     return status;
@@ -719,35 +1098,44 @@ int v6_receive_bundle(bp_bundle_t *bundle, const uint8_t *buffer, int size, bp_p
                     pri_blk.cstserv.value = bundle->route.local_service;
                 }
 
-                /* Copy Non-excluded Header Regions */
-                uint8_t hdr_buf[BP_BUNDLE_HDR_BUF_SIZE];
-                int     hdr_index = 0;
-                int     i;
-                for (i = 1; (i + 1) < ei; i += 2)
+                /* Indicate Bundle Ready for Forwarding */
+                status = BP_PENDING_FORWARD;
+
+                /* Build Forwarded Bundle */
+                if (build)
                 {
-                    int start_index   = exclude[i];
-                    int stop_index    = exclude[i + 1];
-                    int bytes_to_copy = stop_index - start_index;
-                    if ((hdr_index + bytes_to_copy) >= BP_BUNDLE_HDR_BUF_SIZE)
+                    /* Copy Non-excluded Header Regions */
+                    uint8_t hdr_buf[BP_BUNDLE_HDR_BUF_SIZE];
+                    int     hdr_index = 0;
+                    int     i;
+                    for (i = 1; (i + 1) < ei; i += 2)
                     {
-                        return bplog(flags, BP_FLAG_BUNDLE_TOO_LARGE,
-                                     "Non-excluded forwarded blocks exceed maximum header size (%d)\n", hdr_index);
+                        int start_index   = exclude[i];
+                        int stop_index    = exclude[i + 1];
+                        int bytes_to_copy = stop_index - start_index;
+                        if ((hdr_index + bytes_to_copy) >= BP_BUNDLE_HDR_BUF_SIZE)
+                        {
+                            return bplog(flags, BP_FLAG_BUNDLE_TOO_LARGE,
+                                         "Non-excluded forwarded blocks exceed maximum header size (%d)\n", hdr_index);
+                        }
+                        else
+                        {
+                            memcpy(&hdr_buf[hdr_index], &buffer[start_index], bytes_to_copy);
+                            hdr_index += bytes_to_copy;
+                        }
                     }
-                    else
+
+                    /* Initialize Forwarded Bundle */
+                    status = v6_build(bundle, &pri_blk, hdr_buf, hdr_index, flags);
+                    if (status == BP_SUCCESS)
                     {
-                        memcpy(&hdr_buf[hdr_index], &buffer[start_index], bytes_to_copy);
-                        hdr_index += bytes_to_copy;
+                        status = BP_PENDING_FORWARD;
                     }
                 }
 
-                /* Initialize Forwarded Bundle */
-                status = v6_build(bundle, &pri_blk, hdr_buf, hdr_index, flags);
-                if (status == BP_SUCCESS)
+                /* Handle Custody Transfer */
+                if (status == BP_PENDING_FORWARD)
                 {
-                    /* Indicate Bundle Ready for Forwarding */
-                    status = BP_PENDING_FORWARD;
-
-                    /* Handle Custody Transfer */
                     payload->node    = BP_IPN_NULL;
                     payload->service = BP_IPN_NULL;
                     if (pri_blk.cst_rqst)
@@ -802,6 +1190,27 @@ int v6_receive_bundle(bp_bundle_t *bundle, const uint8_t *buffer, int size, bp_p
                 /* Indicate Payload Ready for Acceptance */
                 status = BP_PENDING_ACCEPTANCE;
 
+                /* Check Compressed Payload can be Restored */
+                if (payload->data.compressor != 0)
+                {
+                    if (bundle->attributes.payload_compressor == NULL ||
+                        bundle->attributes.payload_compressor->id != payload->data.compressor)
+                    {
+                        return bplog(flags, BP_FLAG_DROPPED, "Dropping bundle with unsupported compressor %d\n",
+                                     payload->data.compressor);
+                    }
+                    else if (pri_blk.is_frag)
+                    {
+                        return bplog(flags, BP_FLAG_DROPPED, "Dropping fragment of compressed payload\n");
+                    }
+                    else if (payload->data.rawsize <= 0 ||
+                             payload->data.rawsize >= (1 << (bundle_cmp_blk.rawsize.width * 7)))
+                    {
+                        return bplog(flags, BP_FLAG_DROPPED, "Dropping bundle with invalid uncompressed size %d\n",
+                                     payload->data.rawsize);
+                    }
+                }
+
                 /* Handle Custody Transfer */
                 payload->node    = BP_IPN_NULL;
                 payload->service = BP_IPN_NULL;
@@ -830,6 +1239,37 @@ int v6_receive_bundle(bp_bundle_t *bundle, const uint8_t *buffer, int size, bp_p
     return status;
 }
 
+/*--------------------------------------------------------------------------------------
+ * v6_receive_bundle -
+ *
+ *  the bundle is only read (for its route and attributes), so bundles received on a
+ *  channel can be decoded by several threads at once; a bundle for another node is
+ *  returned as BP_PENDING_FORWARD before its header is built, see v6_forward_bundle.
+ *  The integrity check of a payload returned as BP_PENDING_ACCEPTANCE is not performed
+ *  but returned in payload->crc_params and payload->crc, for the caller to apply when
+ *  it copies the payload into storage
+ *-------------------------------------------------------------------------------------*/
+int v6_receive_bundle(bp_bundle_t *bundle, const uint8_t *buffer, int size, bp_payload_t *payload, uint32_t *flags)
+{
+    return v6_decode(bundle, buffer, size, payload, false, flags);
+}
+
+/*--------------------------------------------------------------------------------------
+ * v6_forward_bundle - builds the header of a bundle returned as BP_PENDING_FORWARD into the bundle
+ *-------------------------------------------------------------------------------------*/
+int v6_forward_bundle(bp_bundle_t *bundle, const uint8_t *buffer, int size, uint32_t *flags)
+{
+    bp_payload_t payload;
+
+    int status = v6_decode(bundle, buffer, size, &payload, true, flags);
+    if (status != BP_PENDING_FORWARD)
+    {
+        return bplog(flags, BP_FLAG_FAILED_TO_PARSE, "Failed (%d) to build forwarded bundle\n", status);
+    }
+
+    return BP_SUCCESS;
+}
+
 /*--------------------------------------------------------------------------------------
  * v6_update_bundle -
  *-------------------------------------------------------------------------------------*/
@@ -843,9 +1283,9 @@ int v6_update_bundle(bp_bundle_data_t *data, bp_val_t cid, uint32_t *flags)
 /*--------------------------------------------------------------------------------------
  * v6_populate_acknowledgment -
  *-------------------------------------------------------------------------------------*/
-int v6_populate_acknowledgment(uint8_t *rec, int size, int max_fills, rb_tree_t *tree, uint32_t *flags)
+int v6_populate_acknowledgment(uint8_t *rec, int size, int max_fills, bp_custody_t *custody, uint32_t *flags)
 {
-    return dacs_write(rec, size, max_fills, tree, flags);
+    return dacs_write(rec, size, max_fills, custody, flags);
 }
 
 /*--------------------------------------------------------------------------------------
@@ -879,34 +1319,51 @@ int v6_is_expired(bp_bundle_t *bundle, unsigned long sysnow, unsigned long exprt
 
 /*--------------------------------------------------------------------------------------
  * v6_routeinfo -
+ *
+ *  Only reads the SDNVs at the front of the primary block that hold the addresses,
+ *  so that a received bundle can be routed without decoding the rest of it
  *-------------------------------------------------------------------------------------*/
 int v6_routeinfo(const void *bundle, int size, bp_route_t *route)
 {
-    bp_blk_pri_t pri_blk;
-    uint32_t    *flags = 0;
+    const uint8_t *buffer    = (const uint8_t *)bundle;
+    bp_field_t     field     = {0, 1, 0};
+    bp_val_t       value[8]; /* pcf, blklen, dstnode, dstserv, srcnode, srcserv, rptnode, rptserv */
+    uint32_t       sdnvflags = 0;
+    int            i;
 
     /* Check Parameters */
-    if (bundle == NULL)
+    if (bundle == NULL || size < 1)
     {
         return BP_ERROR;
     }
 
-    /* Parse Primary Block */
-    int bytes_read = pri_read((uint8_t *)bundle, size, &pri_blk, true, flags);
-    if (bytes_read < 0)
+    /* Check Version */
+    if (buffer[0] != BP_PRI_VERSION)
     {
-        return bytes_read;
+        return bplog(NULL, BP_FLAG_FAILED_TO_PARSE, "Incorrect version of bundle reported: %d\n", buffer[0]);
+    }
+
+    /* Read Primary Block up to Addresses */
+    for (i = 0; i < 8; i++)
+    {
+        field.index = sdnv_read(buffer, size, &field, &sdnvflags);
+        value[i]    = field.value;
+    }
+    if (sdnvflags != 0)
+    {
+        return bplog(NULL, BP_FLAG_FAILED_TO_PARSE, "Flags raised during processing of primary block (%08X)\n",
+                     sdnvflags);
     }
 
     /* Set Addresses */
     if (route)
     {
-        route->local_node          = (bp_ipn_t)pri_blk.srcnode.value;
-        route->local_service       = (bp_ipn_t)pri_blk.srcserv.value;
-        route->destination_node    = (bp_ipn_t)pri_blk.dstnode.value;
-        route->destination_service = (bp_ipn_t)pri_blk.dstserv.value;
-        route->report_node         = (bp_ipn_t)pri_blk.rptnode.value;
-        route->report_service      = (bp_ipn_t)pri_blk.rptserv.value;
+        route->local_node          = (bp_ipn_t)value[4];
+        route->local_service       = (bp_ipn_t)value[5];
+        route->destination_node    = (bp_ipn_t)value[2];
+        route->destination_service = (bp_ipn_t)value[3];
+        route->report_node         = (bp_ipn_t)value[6];
+        route->report_service      = (bp_ipn_t)value[7];
     }
 
     /* Return Success */
@@ -1091,3 +1548,39 @@ int v6_display(const void *bundle, int size, uint32_t *flags)
     /* Return Success */
     return BP_SUCCESS;
 }
+
+/*--------------------------------------------------------------------------------------
+ * v6_recognize -
+ *
+ *  A v6 bundle starts with the version of its primary block
+ *-------------------------------------------------------------------------------------*/
+bool v6_recognize(const void *bundle, int size)
+{
+    return (bundle != NULL) && (size > 0) && (((const uint8_t *)bundle)[0] == BP_PRI_VERSION);
+}
+
+/******************************************************************************
+ PROTOCOL ENGINE
+ ******************************************************************************/
+
+const bp_protocol_t v6_protocol = {.version                 = BP_PRI_VERSION,
+                                   .initialize              = v6_initialize,
+                                   .recognize               = v6_recognize,
+                                   .routeinfo               = v6_routeinfo,
+                                   .display                 = v6_display,
+                                   .create                  = v6_create,
+                                   .destroy                 = v6_destroy,
+                                   .invalidate_bundle       = v6_invalidate_bundle,
+                                   .populate_bundle         = v6_populate_bundle,
+                                   .send_bundle             = v6_send_bundle,
+                                   .begin_adu               = v6_begin_adu,
+                                   .send_fragment           = v6_send_fragment,
+                                   .end_adu                 = v6_end_adu,
+                                   .receive_bundle          = v6_receive_bundle,
+                                   .forward_bundle          = v6_forward_bundle,
+                                   .update_bundle           = v6_update_bundle,
+                                   .header_size             = v6_header_size,
+                                   .set_compression         = v6_set_compression,
+                                   .populate_acknowledgment = v6_populate_acknowledgment,
+                                   .receive_acknowledgment  = v6_receive_acknowledgment,
+                                   .is_expired              = v6_is_expired};
@@ -47,6 +47,7 @@
 #define BP_PAY_BLK_TYPE  0x1
 #define BP_CTEB_BLK_TYPE 0xA
 #define BP_BIB_BLK_TYPE  0x3
+#define BP_CMP_BLK_TYPE  0xC0 /* payload compression, from the private and experimental range */
 
 /* BIB Definitions */
 #define BP_BIB_INTEGRITY_SIGNATURE 5
@@ -87,18 +88,30 @@
  ******************************************************************************/
 
 int v6_initialize(void);
-int v6_create(bp_bundle_t *bundle, bp_route_t route, bp_attr_t attributes);
+int v6_create(bp_bundle_t *bundle, bp_route_t route, bp_attr_t attributes, int templates);
 int v6_destroy(bp_bundle_t *bundle);
 int v6_populate_bundle(bp_bundle_t *bundle, uint32_t *flags);
+int v6_invalidate_bundle(bp_bundle_t *bundle);
 int v6_send_bundle(bp_bundle_t *bundle, const uint8_t *buffer, int size, bp_create_func_t create, void *parm,
                    int timeout, uint32_t *flags);
+int v6_begin_adu(bp_bundle_t *bundle, bp_val_t size, uint32_t *flags);
+int v6_send_fragment(bp_bundle_t *bundle, const uint8_t *buffer, int size, bp_val_t offset, bp_create_func_t create,
+                     void *parm, int timeout, uint32_t *flags);
+int v6_end_adu(bp_bundle_t *bundle, bool sent, uint32_t *flags);
 int v6_receive_bundle(bp_bundle_t *bundle, const uint8_t *buffer, int size, bp_payload_t *payload, uint32_t *flags);
+int v6_forward_bundle(bp_bundle_t *bundle, const uint8_t *buffer, int size, uint32_t *flags);
 int v6_update_bundle(bp_bundle_data_t *data, bp_val_t cid, uint32_t *flags);
-int v6_populate_acknowledgment(uint8_t *rec, int size, int max_fills, rb_tree_t *tree, uint32_t *flags);
+int v6_header_size(bp_bundle_t *bundle);
+int v6_set_compression(bp_bundle_t *bundle, int algorithm, int rawsize, uint32_t *flags);
+int v6_populate_acknowledgment(uint8_t *rec, int size, int max_fills, bp_custody_t *custody, uint32_t *flags);
 int v6_receive_acknowledgment(const uint8_t *rec, int size, int *num_acks, bp_delete_func_t remove, void *parm,
                               uint32_t *flags);
 int v6_is_expired(bp_bundle_t *bundle, unsigned long sysnow, unsigned long exprtime, bool unrelt);
 int v6_routeinfo(const void *bundle, int size, bp_route_t *route);
 int v6_display(const void *bundle, int size, uint32_t *flags);
+bool v6_recognize(const void *bundle, int size);
+
+/* Protocol Engine */
+extern const bp_protocol_t v6_protocol;
 
 #endif /* V6_H */
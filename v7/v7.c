@@ -0,0 +1,821 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "bplib.h"
+#include "bplib_os.h"
+#include "v7.h"
+#include "v7_types.h"
+#include "v7_mpool.h"
+#include "v7_codec.h"
+
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+/* A Bundle is a CBOR Indefinite Length Array of Blocks */
+#define BP_V7_ARRAY_START 0x9F
+#define BP_V7_ARRAY_END   0xFF
+
+/******************************************************************************
+ TYPEDEFS
+ ******************************************************************************/
+
+/* Channel State - all memory is allocated when the channel is created */
+typedef struct
+{
+    mpool_t            *pool;                           /* stored, loaded, and received bundles */
+    void               *pool_mem;                       /* memory the pool is carved from */
+    bp_handle_t         lock;                           /* guards below, signaled when a bundle is queued */
+    size_t              buffer_size;                    /* size of each load and accept buffer */
+    uint8_t            *buffers;                        /* load buffers followed by as many accept buffers */
+    bool                load_busy[BP_V7_NUM_BUFFERS];   /* load buffer holds a bundle not yet acknowledged */
+    bool                accept_busy[BP_V7_NUM_BUFFERS]; /* accept buffer holds a payload not yet acknowledged */
+    bp_sequencenumber_t sequence;                       /* creation timestamp sequence number */
+} bp_v7channel_t;
+
+/* Takes the Next Bundle off a Pool Queue */
+typedef mpool_cache_block_t *(*bp_v7take_func_t)(mpool_t *pool);
+
+/******************************************************************************
+ FILE DATA
+ ******************************************************************************/
+
+/* Pool Used by Route Information and Display, which Have No Channel */
+static uint64_t    v7_scratch_mem[BP_V7_SCRATCH_POOL_SIZE / sizeof(uint64_t)];
+static mpool_t    *v7_scratch_pool = NULL;
+static bp_handle_t v7_scratch_lock = {0};
+
+/******************************************************************************
+ LOCAL FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * v7_set_eid -
+ *-------------------------------------------------------------------------------------*/
+void v7_set_eid(bp_endpointid_buffer_t *eid, bp_ipn_t node, bp_ipn_t service)
+{
+    eid->scheme                 = bp_endpointid_scheme_ipn;
+    eid->ssp.ipn.node_number    = node;
+    eid->ssp.ipn.service_number = service;
+}
+
+/*--------------------------------------------------------------------------------------
+ * v7_find_payload -
+ *
+ *  returns the payload block of a bundle, or NULL if it has none
+ *-------------------------------------------------------------------------------------*/
+mpool_cache_canonical_block_t *v7_find_payload(mpool_cache_primary_block_t *cpb)
+{
+    mpool_cache_block_t           *blk = mpool_get_canonical_block_list(cpb);
+    mpool_cache_canonical_block_t *ccb;
+
+    while ((ccb = mpool_cast_canonical(blk = mpool_get_next_block(blk))) != NULL)
+    {
+        if (mpool_get_canonical_block_logical(ccb)->canonical_block.blockType == bp_blocktype_payloadBlock)
+        {
+            return ccb;
+        }
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------
+ * v7_bundle_expired -
+ *-------------------------------------------------------------------------------------*/
+bool v7_bundle_expired(bp_bundle_t *bundle, mpool_cache_primary_block_t *cpb)
+{
+    const bp_primary_block_t *pri    = mpool_get_pri_block_logical(cpb);
+    unsigned long             sysnow = 0;
+    bool                      unrelt = bplib_os_systime(&sysnow) == BP_ERROR;
+
+    /* A Creation Time of Zero Means the Source Had No Clock */
+    unsigned long exprtime = 0;
+    if (pri->creationTimeStamp.time != 0)
+    {
+        exprtime = (unsigned long)((pri->creationTimeStamp.time + pri->lifetime) / 1000);
+    }
+
+    return v7_is_expired(bundle, sysnow, exprtime, unrelt);
+}
+
+/*--------------------------------------------------------------------------------------
+ * v7_return_buffer -
+ *
+ *  returns the buffer of the set starting at base that ptr was lent from
+ *-------------------------------------------------------------------------------------*/
+int v7_return_buffer(bp_v7channel_t *v7, bool *busy, const uint8_t *base, const void *ptr)
+{
+    const uint8_t *p      = (const uint8_t *)ptr;
+    int            status = BP_ERROR;
+
+    if (p >= base && p < base + (BP_V7_NUM_BUFFERS * v7->buffer_size))
+    {
+        size_t slot = (size_t)(p - base) / v7->buffer_size;
+        bplib_os_lock(v7->lock);
+        {
+            if (busy[slot])
+            {
+                busy[slot] = false;
+                status     = BP_SUCCESS;
+            }
+        }
+        bplib_os_unlock(v7->lock);
+    }
+
+    return status;
+}
+
+/*--------------------------------------------------------------------------------------
+ * v7_wait_bundle -
+ *
+ *  claims a free buffer and takes the next unexpired bundle off a pool queue, waiting
+ *  up to timeout milliseconds for one to be queued; expired bundles are dropped
+ *-------------------------------------------------------------------------------------*/
+int v7_wait_bundle(bp_bundle_t *bundle, bp_v7take_func_t take, bool *busy, int timeout, mpool_cache_block_t **blk,
+                   int *slot, uint32_t *flags)
+{
+    bp_v7channel_t *v7     = (bp_v7channel_t *)bundle->blocks;
+    int             status = BP_SUCCESS;
+    int             i;
+
+    *blk  = NULL;
+    *slot = BP_ERROR;
+
+    bplib_os_lock(v7->lock);
+    {
+        /* Claim Buffer */
+        for (i = 0; i < BP_V7_NUM_BUFFERS && *slot == BP_ERROR; i++)
+        {
+            if (!busy[i])
+            {
+                busy[i] = true;
+                *slot   = i;
+            }
+        }
+
+        if (*slot == BP_ERROR)
+        {
+            status = bplog(flags, BP_FLAG_API_ERROR, "All %d buffers are lent out\n", BP_V7_NUM_BUFFERS);
+        }
+
+        /* Take Bundle - timed waits last until a deadline rather than restarting on each wakeup */
+        unsigned long deadline = 0;
+        bplib_os_monotime_us(&deadline);
+        deadline += (unsigned long)timeout * 1000;
+        while (status == BP_SUCCESS && *blk == NULL)
+        {
+            *blk = take(v7->pool);
+            if (*blk == NULL)
+            {
+                int wait_status = (timeout == BP_PEND) ? bplib_os_waiton(v7->lock, BP_PEND)
+                                                       : bplib_os_waituntil(v7->lock, deadline);
+                if (wait_status == BP_TIMEOUT)
+                {
+                    status = BP_TIMEOUT;
+                }
+            }
+            else if (v7_bundle_expired(bundle, mpool_cast_primary(*blk)))
+            {
+                mpool_return_bundle(v7->pool, *blk);
+                *blk = NULL;
+            }
+        }
+
+        /* Give Back Buffer */
+        if (status != BP_SUCCESS && *slot != BP_ERROR)
+        {
+            busy[*slot] = false;
+        }
+    }
+    bplib_os_unlock(v7->lock);
+
+    return status;
+}
+
+/*--------------------------------------------------------------------------------------
+ * v7_decode -
+ *
+ *  copies a received bundle into a pool and decodes its blocks; when primary_only is
+ *  set only the primary block is decoded, and only as much of the bundle as fits in
+ *  the pool need be copied.  Returns the decoded bundle, or NULL on failure.
+ *-------------------------------------------------------------------------------------*/
+mpool_cache_block_t *v7_decode(mpool_t *pool, const void *data, size_t size, bool primary_only, uint32_t *flags)
+{
+    const uint8_t       *buffer = (const uint8_t *)data;
+    mpool_cache_block_t *pblk;
+    mpool_cache_block_t *cblk;
+    mpool_stream_t       mps;
+    size_t               written;
+    size_t               consumed = 0;
+    int                  result;
+
+    /* Check Framing */
+    if (buffer == NULL || size < 2 || buffer[0] != BP_V7_ARRAY_START || buffer[size - 1] != BP_V7_ARRAY_END)
+    {
+        bplog(flags, BP_FLAG_FAILED_TO_PARSE, "Bundle of size %lu is not an array of blocks\n", (unsigned long)size);
+        return NULL;
+    }
+
+    /* Allocate Primary Block */
+    pblk = mpool_alloc_primary_block(pool);
+    if (pblk == NULL)
+    {
+        bplog(flags, BP_FLAG_STORE_FAILURE, "Bundle pool exhausted\n");
+        return NULL;
+    }
+
+    /* Copy Blocks into Pool */
+    mpool_start_stream_init(&mps, pool, mpool_stream_dir_write, bp_crctype_none);
+    written = mpool_stream_write(&mps, &buffer[1], size - 2);
+    if (written != size - 2 && !primary_only)
+    {
+        mpool_stream_close(&mps);
+        mpool_return_bundle(pool, pblk);
+        bplog(flags, BP_FLAG_STORE_FAILURE, "Bundle pool exhausted\n");
+        return NULL;
+    }
+    mpool_stream_turnaround(&mps);
+
+    /* Decode Blocks in Place */
+    result = v7_block_decode_pri_stream(&mps, mpool_cast_primary(pblk));
+    while (result > 0 && !primary_only && (consumed += result) < written)
+    {
+        cblk = mpool_alloc_canonical_block(pool);
+        if (cblk == NULL)
+        {
+            result = -1;
+            break;
+        }
+
+        /* Linked into the Bundle Whatever the Result, so it is Returned with It */
+        result = v7_block_decode_canonical_stream(&mps, mpool_cast_canonical(cblk));
+        mpool_store_canonical_block(mpool_cast_primary(pblk), cblk);
+    }
+    mpool_stream_close(&mps);
+
+    /* Check Decode */
+    if (result <= 0)
+    {
+        mpool_return_bundle(pool, pblk);
+        bplog(flags, BP_FLAG_FAILED_TO_PARSE, "Failed to decode block at offset %lu of bundle\n",
+              (unsigned long)consumed + 1);
+        return NULL;
+    }
+
+    return pblk;
+}
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+/*--------------------------------------------------------------------------------------
+ * v7_initialize -
+ *-------------------------------------------------------------------------------------*/
+int v7_initialize(void)
+{
+    if (v7_scratch_pool == NULL)
+    {
+        v7_scratch_lock = bplib_os_createlock();
+        if (!bp_handle_is_valid(v7_scratch_lock))
+        {
+            return bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to create lock for v7 scratch pool\n");
+        }
+
+        v7_scratch_pool = mpool_create(v7_scratch_mem, sizeof(v7_scratch_mem));
+        if (v7_scratch_pool == NULL)
+        {
+            bplib_os_destroylock(v7_scratch_lock);
+            v7_scratch_lock = BP_INVALID_HANDLE;
+            return bplog(NULL, BP_FLAG_DIAGNOSTIC, "Failed to create v7 scratch pool\n");
+        }
+    }
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * v7_create -
+ *
+ *  allocates the bundle pool and the load and accept buffers of the channel, so that
+ *  storing, loading, processing, and accepting bundles never allocate memory
+ *-------------------------------------------------------------------------------------*/
+int v7_create(bp_bundle_t *bundle, bp_route_t route, bp_attr_t attributes, int templates)
+{
+    bp_v7channel_t *v7;
+
+    (void)templates;
+
+    /* Initialize Route and Attributes */
+    bundle->route      = route;
+    bundle->attributes = attributes;
+    bundle->prebuilt   = true;
+    bundle->templates  = NULL;
+
+    /* Allocate Channel State */
+    v7             = (bp_v7channel_t *)bplib_os_calloc_tag(sizeof(bp_v7channel_t), BP_MEM_V7);
+    bundle->blocks = v7;
+    if (v7 == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    /* Allocate Pool and Buffers */
+    v7->lock        = bplib_os_createlock();
+    v7->buffer_size = (size_t)attributes.max_length;
+    v7->pool_mem    = bplib_os_calloc_tag(BP_V7_POOL_SIZE, BP_MEM_V7);
+    v7->buffers     = (uint8_t *)bplib_os_calloc_tag(2 * BP_V7_NUM_BUFFERS * v7->buffer_size, BP_MEM_V7);
+    if (v7->pool_mem != NULL)
+    {
+        v7->pool = mpool_create(v7->pool_mem, BP_V7_POOL_SIZE);
+    }
+
+    if (!bp_handle_is_valid(v7->lock) || v7->pool == NULL || v7->buffers == NULL || v7->buffer_size < 2)
+    {
+        v7_destroy(bundle);
+        return BP_ERROR;
+    }
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * v7_destroy -
+ *-------------------------------------------------------------------------------------*/
+int v7_destroy(bp_bundle_t *bundle)
+{
+    bp_v7channel_t *v7 = (bp_v7channel_t *)bundle->blocks;
+
+    if (v7)
+    {
+        if (v7->pool)
+        {
+            mpool_destroy(v7->pool);
+        }
+        if (v7->pool_mem)
+        {
+            bplib_os_free(v7->pool_mem);
+        }
+        if (v7->buffers)
+        {
+            bplib_os_free(v7->buffers);
+        }
+        if (bp_handle_is_valid(v7->lock))
+        {
+            bplib_os_destroylock(v7->lock);
+        }
+        bplib_os_free(v7);
+    }
+
+    bundle->blocks = NULL;
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * v7_invalidate_bundle -
+ *
+ *  nothing is prebuilt, each stored bundle is encoded from the current attributes
+ *-------------------------------------------------------------------------------------*/
+int v7_invalidate_bundle(bp_bundle_t *bundle)
+{
+    bundle->prebuilt = true;
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * v7_is_expired -
+ *
+ *  an expiration time of zero means the bundle was created without a clock
+ *-------------------------------------------------------------------------------------*/
+int v7_is_expired(bp_bundle_t *bundle, unsigned long sysnow, unsigned long exprtime, bool unrelt)
+{
+    return (int)(!unrelt && !bundle->attributes.ignore_expiration && exprtime != 0 && sysnow >= exprtime);
+}
+
+/*--------------------------------------------------------------------------------------
+ * v7_recognize -
+ *-------------------------------------------------------------------------------------*/
+bool v7_recognize(const void *bundle, int size)
+{
+    return size > 0 && ((const uint8_t *)bundle)[0] == BP_V7_ARRAY_START;
+}
+
+/*--------------------------------------------------------------------------------------
+ * v7_routeinfo -
+ *-------------------------------------------------------------------------------------*/
+int v7_routeinfo(const void *bundle, int size, bp_route_t *route)
+{
+    mpool_cache_block_t *pblk;
+    int                  status = BP_SUCCESS;
+
+    /* Check Parameters */
+    if (bundle == NULL || size < 1)
+    {
+        return BP_ERROR;
+    }
+
+    bplib_os_lock(v7_scratch_lock);
+    {
+        /* Decode Primary Block */
+        pblk = v7_decode(v7_scratch_pool, bundle, (size_t)size, true, NULL);
+        if (pblk == NULL)
+        {
+            status = BP_ERROR;
+        }
+        else
+        {
+            /* Set Addresses */
+            const bp_primary_block_t *pri = mpool_get_pri_block_logical(mpool_cast_primary(pblk));
+            if (route)
+            {
+                route->local_node          = (bp_ipn_t)pri->sourceID.ssp.ipn.node_number;
+                route->local_service       = (bp_ipn_t)pri->sourceID.ssp.ipn.service_number;
+                route->destination_node    = (bp_ipn_t)pri->destinationEID.ssp.ipn.node_number;
+                route->destination_service = (bp_ipn_t)pri->destinationEID.ssp.ipn.service_number;
+                route->report_node         = (bp_ipn_t)pri->reportEID.ssp.ipn.node_number;
+                route->report_service      = (bp_ipn_t)pri->reportEID.ssp.ipn.service_number;
+            }
+            mpool_return_bundle(v7_scratch_pool, pblk);
+        }
+    }
+    bplib_os_unlock(v7_scratch_lock);
+
+    return status;
+}
+
+/*--------------------------------------------------------------------------------------
+ * v7_display -
+ *-------------------------------------------------------------------------------------*/
+int v7_display(const void *bundle, int size, uint32_t *flags)
+{
+    mpool_cache_block_t           *pblk;
+    mpool_cache_block_t           *blk;
+    mpool_cache_canonical_block_t *ccb;
+    int                            status = BP_SUCCESS;
+
+    /* Check Parameters */
+    if (bundle == NULL || size < 1)
+    {
+        return BP_ERROR;
+    }
+
+    bplib_os_lock(v7_scratch_lock);
+    {
+        pblk = v7_decode(v7_scratch_pool, bundle, (size_t)size, false, flags);
+        if (pblk == NULL)
+        {
+            status = bplog(flags, BP_FLAG_FAILED_TO_PARSE, "Failed to decode bundle of size %d\n", size);
+        }
+        else
+        {
+            /* Display Primary Block */
+            const bp_primary_block_t *pri = mpool_get_pri_block_logical(mpool_cast_primary(pblk));
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "@@@@\n");
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Bundle of Size %d, Version %d\n", size, pri->version);
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Adminstrtive Record:           %s\n",
+                  pri->controlFlags.isAdminRecord ? "TRUE" : "FALSE");
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Fragmented:                    %s\n",
+                  pri->controlFlags.isFragment ? "TRUE" : "FALSE");
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Fragmentation Allowed:         %s\n",
+                  pri->controlFlags.mustNotFragment ? "FALSE" : "TRUE");
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "CRC Type:                      %d\n", (int)pri->crctype);
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Destination EID:               %lu.%lu\n",
+                  (unsigned long)pri->destinationEID.ssp.ipn.node_number,
+                  (unsigned long)pri->destinationEID.ssp.ipn.service_number);
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Source EID:                    %lu.%lu\n",
+                  (unsigned long)pri->sourceID.ssp.ipn.node_number,
+                  (unsigned long)pri->sourceID.ssp.ipn.service_number);
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Report To EID:                 %lu.%lu\n",
+                  (unsigned long)pri->reportEID.ssp.ipn.node_number,
+                  (unsigned long)pri->reportEID.ssp.ipn.service_number);
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Creation Timestamp:            %lu\n",
+                  (unsigned long)pri->creationTimeStamp.time);
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Creation Sequence:             %lu\n",
+                  (unsigned long)pri->creationTimeStamp.sequence_num);
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "Lifetime:                      %lu\n", (unsigned long)pri->lifetime);
+
+            /* Display Canonical Blocks */
+            blk = mpool_get_canonical_block_list(mpool_cast_primary(pblk));
+            while ((ccb = mpool_cast_canonical(blk = mpool_get_next_block(blk))) != NULL)
+            {
+                const bp_canonical_bundle_block_t *cb = &mpool_get_canonical_block_logical(ccb)->canonical_block;
+                bplog(NULL, BP_FLAG_DIAGNOSTIC, "Block Type %d, Number %d, CRC Type %d, Content Length %lu\n",
+                      (int)cb->blockType, (int)cb->blockNum, (int)cb->crctype,
+                      (unsigned long)mpool_get_canonical_block_encoded_content_length(ccb));
+            }
+            bplog(NULL, BP_FLAG_DIAGNOSTIC, "@@@@\n");
+
+            mpool_return_bundle(v7_scratch_pool, pblk);
+        }
+    }
+    bplib_os_unlock(v7_scratch_lock);
+
+    return status;
+}
+
+/*--------------------------------------------------------------------------------------
+ * v7_store -
+ *
+ *  encodes a bundle carrying the payload into the pool and queues it to be loaded;
+ *  fails rather than waits when the pool is exhausted
+ *-------------------------------------------------------------------------------------*/
+int v7_store(bp_bundle_t *bundle, const void *payload, size_t size, int timeout, uint32_t *flags)
+{
+    bp_v7channel_t              *v7 = (bp_v7channel_t *)bundle->blocks;
+    mpool_cache_block_t         *pblk;
+    mpool_cache_block_t         *cblk;
+    bp_primary_block_t          *pri;
+    bp_canonical_block_buffer_t *pay;
+    unsigned long                sysnow = 0;
+    size_t                       max_size;
+
+    (void)timeout;
+
+    /* Check Size */
+    max_size = v7->buffer_size;
+    if (bundle->attributes.max_length < (int)max_size)
+    {
+        max_size = (size_t)bundle->attributes.max_length;
+    }
+    if (size > max_size)
+    {
+        return bplog(flags, BP_FLAG_BUNDLE_TOO_LARGE, "Payload of %lu bytes exceeds maximum bundle length of %lu\n",
+                     (unsigned long)size, (unsigned long)max_size);
+    }
+
+    /* Allocate Blocks */
+    pblk = mpool_alloc_primary_block(v7->pool);
+    if (pblk == NULL)
+    {
+        return bplog(flags, BP_FLAG_STORE_FAILURE, "Bundle pool exhausted\n");
+    }
+    cblk = mpool_alloc_canonical_block(v7->pool);
+    if (cblk == NULL)
+    {
+        mpool_return_bundle(v7->pool, pblk);
+        return bplog(flags, BP_FLAG_STORE_FAILURE, "Bundle pool exhausted\n");
+    }
+
+    /* Build Primary Block */
+    pri                               = mpool_get_pri_block_logical(mpool_cast_primary(pblk));
+    pri->version                      = BP_V7_VERSION;
+    pri->crctype                      = bp_crctype_CRC32C;
+    pri->controlFlags.isAdminRecord   = bundle->attributes.admin_record;
+    pri->controlFlags.mustNotFragment = !bundle->attributes.allow_fragmentation;
+    v7_set_eid(&pri->destinationEID, bundle->route.destination_node, bundle->route.destination_service);
+    v7_set_eid(&pri->sourceID, bundle->route.local_node, bundle->route.local_service);
+    v7_set_eid(&pri->reportEID, bundle->route.report_node, bundle->route.report_service);
+    pri->lifetime = (bp_lifetime_t)bundle->attributes.lifetime * 1000;
+
+    /* Set Creation Time (milliseconds, zero when unknown) */
+    if (bplib_os_systime(&sysnow) == BP_ERROR)
+    {
+        bplog(flags, BP_FLAG_UNRELIABLE_TIME, "Unreliable time detected: %ld\n", sysnow);
+        sysnow = 0;
+    }
+    pri->creationTimeStamp.time = (bp_dtntime_t)sysnow * 1000;
+    bplib_os_lock(v7->lock);
+    {
+        pri->creationTimeStamp.sequence_num = v7->sequence++;
+    }
+    bplib_os_unlock(v7->lock);
+
+    /* Build Payload Block */
+    pay                            = mpool_get_canonical_block_logical(mpool_cast_canonical(cblk));
+    pay->canonical_block.blockType = bp_blocktype_payloadBlock;
+    pay->canonical_block.blockNum  = 1;
+    pay->canonical_block.crctype   = bp_crctype_CRC32C;
+    mpool_store_canonical_block(mpool_cast_primary(pblk), cblk);
+
+    /* Encode Bundle */
+    if (v7_block_encode_pri(v7->pool, mpool_cast_primary(pblk)) < 0 ||
+        v7_block_encode_pay(v7->pool, mpool_cast_canonical(cblk), payload, size) < 0)
+    {
+        mpool_return_bundle(v7->pool, pblk);
+        return bplog(flags, BP_FLAG_STORE_FAILURE, "Failed to encode bundle (pool exhausted)\n");
+    }
+
+    /* Check Encoded Size (with array framing) */
+    size_t bundle_size = mpool_sum_full_bundle_size(mpool_cast_primary(pblk)) + 2;
+    if (bundle_size > max_size)
+    {
+        mpool_return_bundle(v7->pool, pblk);
+        return bplog(flags, BP_FLAG_BUNDLE_TOO_LARGE, "Bundle of %lu bytes exceeds maximum length of %lu\n",
+                     (unsigned long)bundle_size, (unsigned long)max_size);
+    }
+
+    /* Queue Bundle */
+    mpool_store_primary_block_outgoing(v7->pool, pblk);
+    bplib_os_lock(v7->lock);
+    {
+        bplib_os_broadcast(v7->lock);
+    }
+    bplib_os_unlock(v7->lock);
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * v7_load -
+ *
+ *  copies the next queued bundle into a load buffer, which is lent out until the
+ *  bundle is acknowledged; the blocks go back to the pool as soon as it is copied
+ *-------------------------------------------------------------------------------------*/
+int v7_load(bp_bundle_t *bundle, void **data, size_t *size, int timeout, uint32_t *flags)
+{
+    bp_v7channel_t                *v7 = (bp_v7channel_t *)bundle->blocks;
+    mpool_cache_block_t           *pblk;
+    mpool_cache_block_t           *blk;
+    mpool_cache_canonical_block_t *ccb;
+    uint8_t                       *out;
+    size_t                         n = 0;
+    int                            slot;
+    int                            status;
+
+    /* Take Bundle */
+    status = v7_wait_bundle(bundle, mpool_take_next_outgoing_bundle, v7->load_busy, timeout, &pblk, &slot, flags);
+    if (status != BP_SUCCESS)
+    {
+        return status;
+    }
+
+    /* Copy Blocks (stored bundles were checked to fit) */
+    out      = &v7->buffers[slot * v7->buffer_size];
+    out[n++] = BP_V7_ARRAY_START;
+    n += mpool_copy_block_chain(mpool_get_pri_block_encoded_chunks(mpool_cast_primary(pblk)), &out[n],
+                                v7->buffer_size - n - 1, 0, (size_t)-1);
+    blk = mpool_get_canonical_block_list(mpool_cast_primary(pblk));
+    while ((ccb = mpool_cast_canonical(blk = mpool_get_next_block(blk))) != NULL)
+    {
+        n += mpool_copy_block_chain(mpool_get_canonical_block_encoded_chunks(ccb), &out[n], v7->buffer_size - n - 1,
+                                    0, (size_t)-1);
+    }
+    out[n++] = BP_V7_ARRAY_END;
+    mpool_return_bundle(v7->pool, pblk);
+
+    /* Return Bundle */
+    *data = out;
+    if (size)
+    {
+        *size = n;
+    }
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * v7_process -
+ *
+ *  decodes a received bundle into the pool and queues it to be accepted
+ *-------------------------------------------------------------------------------------*/
+int v7_process(bp_bundle_t *bundle, const void *data, size_t size, int timeout, uint32_t *flags)
+{
+    bp_v7channel_t           *v7 = (bp_v7channel_t *)bundle->blocks;
+    mpool_cache_block_t      *pblk;
+    const bp_primary_block_t *pri;
+
+    (void)timeout;
+
+    /* Check Size */
+    if (size > v7->buffer_size)
+    {
+        return bplog(flags, BP_FLAG_BUNDLE_TOO_LARGE, "Bundle of %lu bytes exceeds maximum length of %lu\n",
+                     (unsigned long)size, (unsigned long)v7->buffer_size);
+    }
+
+    /* Decode Bundle */
+    pblk = v7_decode(v7->pool, data, size, false, flags);
+    if (pblk == NULL)
+    {
+        return BP_ERROR;
+    }
+
+    /* Check Bundle */
+    pri = mpool_get_pri_block_logical(mpool_cast_primary(pblk));
+    if (pri->destinationEID.ssp.ipn.node_number != bundle->route.local_node ||
+        pri->destinationEID.ssp.ipn.service_number != bundle->route.local_service)
+    {
+        mpool_return_bundle(v7->pool, pblk);
+        return bplog(flags, BP_FLAG_ROUTE_NEEDED, "Bundle destined for %lu.%lu is not for this channel\n",
+                     (unsigned long)pri->destinationEID.ssp.ipn.node_number,
+                     (unsigned long)pri->destinationEID.ssp.ipn.service_number);
+    }
+    else if (v7_find_payload(mpool_cast_primary(pblk)) == NULL)
+    {
+        mpool_return_bundle(v7->pool, pblk);
+        return bplog(flags, BP_FLAG_FAILED_TO_PARSE, "Bundle has no payload block\n");
+    }
+
+    /* Queue Bundle */
+    mpool_store_primary_block_incoming(v7->pool, pblk);
+    bplib_os_lock(v7->lock);
+    {
+        bplib_os_broadcast(v7->lock);
+    }
+    bplib_os_unlock(v7->lock);
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * v7_accept -
+ *
+ *  copies the payload of the next received bundle into an accept buffer, which is
+ *  lent out until the payload is acknowledged
+ *-------------------------------------------------------------------------------------*/
+int v7_accept(bp_bundle_t *bundle, void **payload, size_t *size, int timeout, uint32_t *flags)
+{
+    bp_v7channel_t                *v7 = (bp_v7channel_t *)bundle->blocks;
+    mpool_cache_block_t           *pblk;
+    mpool_cache_canonical_block_t *ccb;
+    uint8_t                       *out;
+    size_t                         n;
+    int                            slot;
+    int                            status;
+
+    /* Take Bundle */
+    status = v7_wait_bundle(bundle, mpool_take_next_incoming_bundle, v7->accept_busy, timeout, &pblk, &slot, flags);
+    if (status != BP_SUCCESS)
+    {
+        return status;
+    }
+
+    /* Copy Payload (processed bundles were checked to have one that fits) */
+    ccb = v7_find_payload(mpool_cast_primary(pblk));
+    out = &v7->buffers[(BP_V7_NUM_BUFFERS + slot) * v7->buffer_size];
+    n   = mpool_copy_block_chain(mpool_get_canonical_block_encoded_chunks(ccb), out, v7->buffer_size,
+                                 mpool_get_canonical_block_encoded_content_offset(ccb),
+                                 mpool_get_canonical_block_encoded_content_length(ccb));
+    mpool_return_bundle(v7->pool, pblk);
+
+    /* Return Payload */
+    *payload = out;
+    if (size)
+    {
+        *size = n;
+    }
+
+    return BP_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------------------
+ * v7_ackbundle -
+ *-------------------------------------------------------------------------------------*/
+int v7_ackbundle(bp_bundle_t *bundle, const void *data)
+{
+    bp_v7channel_t *v7 = (bp_v7channel_t *)bundle->blocks;
+    return v7_return_buffer(v7, v7->load_busy, v7->buffers, data);
+}
+
+/*--------------------------------------------------------------------------------------
+ * v7_ackpayload -
+ *-------------------------------------------------------------------------------------*/
+int v7_ackpayload(bp_bundle_t *bundle, const void *payload)
+{
+    bp_v7channel_t *v7 = (bp_v7channel_t *)bundle->blocks;
+    return v7_return_buffer(v7, v7->accept_busy, &v7->buffers[BP_V7_NUM_BUFFERS * v7->buffer_size], payload);
+}
+
+/******************************************************************************
+ PROTOCOL ENGINE
+ ******************************************************************************/
+
+const bp_protocol_t v7_protocol = {.version           = BP_V7_VERSION,
+                                   .initialize        = v7_initialize,
+                                   .recognize         = v7_recognize,
+                                   .routeinfo         = v7_routeinfo,
+                                   .display           = v7_display,
+                                   .create            = v7_create,
+                                   .destroy           = v7_destroy,
+                                   .invalidate_bundle = v7_invalidate_bundle,
+                                   .is_expired        = v7_is_expired,
+                                   .store             = v7_store,
+                                   .load              = v7_load,
+                                   .process           = v7_process,
+                                   .accept            = v7_accept,
+                                   .ackbundle         = v7_ackbundle,
+                                   .ackpayload        = v7_ackpayload};
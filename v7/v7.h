@@ -0,0 +1,73 @@
+/*
+ * NASA Docket No. GSC-18,587-1 and identified as “The Bundle Protocol Core Flight
+ * System Application (BP) v6.5”
+ *
+ * Copyright © 2020 United States Government as represented by the Administrator of
+ * the National Aeronautics and Space Administration. All Rights Reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef V7_H
+#define V7_H
+
+/******************************************************************************
+ INCLUDES
+ ******************************************************************************/
+
+#include "bundle_types.h"
+
+/******************************************************************************
+ DEFINES
+ ******************************************************************************/
+
+#define BP_V7_VERSION 0x07
+
+/* Size of Each Channel's Bundle Pool (Compile-Time Option) */
+#ifndef BP_V7_POOL_SIZE
+#define BP_V7_POOL_SIZE (256 * 1024)
+#endif
+
+/* Number of Loaded Bundles and Accepted Payloads a Channel Can Have Outstanding (Compile-Time Option) */
+#ifndef BP_V7_NUM_BUFFERS
+#define BP_V7_NUM_BUFFERS 8
+#endif
+
+/* Size of the Pool Used to Decode Bundles for Route Information and Display (Compile-Time Option) */
+#ifndef BP_V7_SCRATCH_POOL_SIZE
+#define BP_V7_SCRATCH_POOL_SIZE (16 * 1024)
+#endif
+
+/******************************************************************************
+ EXPORTED FUNCTIONS
+ ******************************************************************************/
+
+int  v7_initialize(void);
+int  v7_create(bp_bundle_t *bundle, bp_route_t route, bp_attr_t attributes, int templates);
+int  v7_destroy(bp_bundle_t *bundle);
+int  v7_invalidate_bundle(bp_bundle_t *bundle);
+int  v7_is_expired(bp_bundle_t *bundle, unsigned long sysnow, unsigned long exprtime, bool unrelt);
+int  v7_routeinfo(const void *bundle, int size, bp_route_t *route);
+int  v7_display(const void *bundle, int size, uint32_t *flags);
+bool v7_recognize(const void *bundle, int size);
+int  v7_store(bp_bundle_t *bundle, const void *payload, size_t size, int timeout, uint32_t *flags);
+int  v7_load(bp_bundle_t *bundle, void **data, size_t *size, int timeout, uint32_t *flags);
+int  v7_process(bp_bundle_t *bundle, const void *data, size_t size, int timeout, uint32_t *flags);
+int  v7_accept(bp_bundle_t *bundle, void **payload, size_t *size, int timeout, uint32_t *flags);
+int  v7_ackbundle(bp_bundle_t *bundle, const void *data);
+int  v7_ackpayload(bp_bundle_t *bundle, const void *payload);
+
+/* Protocol Engine */
+extern const bp_protocol_t v7_protocol;
+
+#endif /* V7_H */
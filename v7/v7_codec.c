@@ -22,6 +22,8 @@
  INCLUDES
  ******************************************************************************/
 
+#include <limits.h>
+
 #include "bplib.h"
 #include "bplib_os.h"
 
@@ -29,6 +31,15 @@
 #include "v7_codec.h"
 #include "cbor.h"
 
+/* CBOR major types and markers read by the chunk stream decoder */
+#define V7_CBOR_MAJOR_UINT  0
+#define V7_CBOR_MAJOR_BYTES 2
+#define V7_CBOR_MAJOR_ARRAY 4
+#define V7_CBOR_BREAK       0xFF
+
+#define V7_STREAM_UNBOUNDED SIZE_MAX /* items left in an indefinite length container */
+#define V7_STREAM_MAX_LEAD  32       /* block bytes ahead of the CRC type, at most 29 for a canonical block */
+
 typedef struct
 {
     const bp_canonical_bundle_block_t *encode_block;
@@ -60,6 +71,30 @@ typedef struct v7_decode_state
     CborValue     *cbor;
 } v7_decode_state_t;
 
+/*
+ * Decode state for received blocks held in mpool encoded chunks (see v7_block_decode_pri_stream).
+ *
+ * TinyCBOR parses from one contiguous buffer, so this walks the CBOR in place through
+ * mpool_stream_read instead, which also runs the CRC over every byte as it goes.  Only the
+ * major types used by the bpv7 blocks are needed: unsigned integers, byte strings and arrays.
+ */
+typedef struct v7_stream_decode_state
+{
+    bool            error;
+    mpool_stream_t *mps;
+    size_t          remain; /* items left in the current container */
+    bool            crc_started;
+    size_t          lead_size; /* bytes read before the CRC type was known */
+    uint8_t         lead[V7_STREAM_MAX_LEAD];
+} v7_stream_decode_state_t;
+
+typedef struct v7_stream_canonical_info
+{
+    bp_canonical_block_buffer_t *logical;
+    size_t                       content_offset;
+    size_t                       content_size;
+} v7_stream_canonical_info_t;
+
 static const v7_bitmap_table_t V7_BUNDLE_CONTROL_FLAGS_BITMAP_TABLE[] = {
     {offsetof(bp_bundle_processing_control_flags_t, deletion_status_req), 0x40000},
     {offsetof(bp_bundle_processing_control_flags_t, delivery_status_req), 0x20000},
@@ -191,6 +226,29 @@ static void v7_decode_bp_canonical_block_buffer(v7_decode_state_t *dec, bp_canon
 static size_t v7_save_and_verify_block(mpool_t *pool, mpool_cache_block_t *head, const uint8_t *block_base,
                                        size_t block_size, bp_crctype_t crc_type, bp_crcval_t crc_check);
 
+/*
+ * Decoding helpers for blocks held in mpool encoded chunks.
+ *
+ * These mirror the flat buffer decoders above, but read the CBOR through the stream.  The CRC
+ * type is the third or fourth field of a block, so the bytes ahead of it are kept as the "lead"
+ * and run through the CRC once the type is known.  The CRC field itself is run through as
+ * zeros, as it was when the CRC was computed.
+ */
+typedef void (*v7_stream_decode_func_t)(v7_stream_decode_state_t *dec, void *arg);
+
+static void         v7_stream_read(v7_stream_decode_state_t *dec, void *data, size_t size);
+static bp_integer_t v7_stream_decode_head(v7_stream_decode_state_t *dec, uint8_t major_type, bool *indefinite);
+static void v7_stream_decode_container(v7_stream_decode_state_t *dec, v7_stream_decode_func_t func, void *arg);
+static int  v7_stream_decode_small_int(v7_stream_decode_state_t *dec);
+static void v7_stream_decode_bp_integer(v7_stream_decode_state_t *dec, bp_integer_t *v);
+static void v7_stream_decode_bitmap(v7_stream_decode_state_t *dec, uint8_t *v, const v7_bitmap_table_t *ptbl);
+static void v7_stream_decode_bp_crctype(v7_stream_decode_state_t *dec, bp_crctype_t *v);
+static void v7_stream_decode_crc(v7_stream_decode_state_t *dec, bp_crcval_t *v);
+static void v7_stream_decode_bp_endpointid_buffer(v7_stream_decode_state_t *dec, bp_endpointid_buffer_t *v);
+static void v7_stream_decode_bp_creation_timestamp(v7_stream_decode_state_t *dec, bp_creation_timestamp_t *v);
+static int  v7_stream_finish_block(v7_stream_decode_state_t *dec, mpool_cache_block_t *head, bp_crctype_t crc_type,
+                                   bp_crcval_t crc_check);
+
 /*
  * -----------------------------------------------------------------------------------
  * IMPLEMENTATION
@@ -1204,6 +1262,450 @@ int v7_block_decode_canonical(mpool_t *pool, mpool_cache_canonical_block_t *ccb,
     return result;
 }
 
+void v7_stream_read(v7_stream_decode_state_t *dec, void *data, size_t size)
+{
+    if (!dec->error)
+    {
+        if (mpool_stream_read(dec->mps, data, size) != size)
+        {
+            /* block runs past the end of the received data */
+            dec->error = true;
+        }
+        else if (!dec->crc_started)
+        {
+            if ((dec->lead_size + size) > sizeof(dec->lead))
+            {
+                dec->error = true;
+            }
+            else
+            {
+                memcpy(&dec->lead[dec->lead_size], data, size);
+                dec->lead_size += size;
+            }
+        }
+    }
+}
+
+bp_integer_t v7_stream_decode_head(v7_stream_decode_state_t *dec, uint8_t major_type, bool *indefinite)
+{
+    uint8_t      bytes[sizeof(bp_integer_t)];
+    uint8_t      initial_byte;
+    size_t       len;
+    size_t       i;
+    bp_integer_t val;
+
+    val = 0;
+    if (indefinite != NULL)
+    {
+        *indefinite = false;
+    }
+
+    if (!dec->error)
+    {
+        /* every head starts an item of the enclosing container */
+        if (dec->remain == 0)
+        {
+            dec->error = true;
+            return 0;
+        }
+        else if (dec->remain != V7_STREAM_UNBOUNDED)
+        {
+            --dec->remain;
+        }
+
+        v7_stream_read(dec, &initial_byte, 1);
+        if (!dec->error)
+        {
+            val = initial_byte & 0x1F;
+            if ((initial_byte >> 5) != major_type)
+            {
+                dec->error = true;
+            }
+            else if (val >= 24 && val < 28)
+            {
+                /* 1, 2, 4, or 8 additional bytes, big endian */
+                len = 1 << (val - 24);
+                val = 0;
+                v7_stream_read(dec, bytes, len);
+                for (i = 0; i < len; ++i)
+                {
+                    val <<= 8;
+                    val |= bytes[i];
+                }
+            }
+            else if (val == 31 && indefinite != NULL)
+            {
+                *indefinite = true;
+                val         = 0;
+            }
+            else if (val >= 24)
+            {
+                /* not well formed, or indefinite length where not supported */
+                dec->error = true;
+            }
+        }
+    }
+
+    return dec->error ? 0 : val;
+}
+
+void v7_stream_decode_container(v7_stream_decode_state_t *dec, v7_stream_decode_func_t func, void *arg)
+{
+    bp_integer_t entries;
+    size_t       parent_remain;
+    uint8_t      break_byte;
+    bool         indefinite;
+
+    entries = v7_stream_decode_head(dec, V7_CBOR_MAJOR_ARRAY, &indefinite);
+    if (!dec->error)
+    {
+        /* go into container */
+        parent_remain = dec->remain;
+        dec->remain   = indefinite ? V7_STREAM_UNBOUNDED : (size_t)entries;
+
+        /* call the handler impl */
+        func(dec, arg);
+
+        /* This should have consumed every item */
+        if (indefinite)
+        {
+            v7_stream_read(dec, &break_byte, 1);
+            if (!dec->error && break_byte != V7_CBOR_BREAK)
+            {
+                dec->error = true;
+            }
+        }
+        else if (dec->remain != 0)
+        {
+            dec->error = true;
+        }
+
+        /* return to parent scope */
+        dec->remain = parent_remain;
+    }
+}
+
+int v7_stream_decode_small_int(v7_stream_decode_state_t *dec)
+{
+    bp_integer_t val;
+
+    val = v7_stream_decode_head(dec, V7_CBOR_MAJOR_UINT, NULL);
+    if (val > INT_MAX)
+    {
+        dec->error = true;
+        val        = 0;
+    }
+
+    return (int)val;
+}
+
+void v7_stream_decode_bp_integer(v7_stream_decode_state_t *dec, bp_integer_t *v)
+{
+    *v = v7_stream_decode_head(dec, V7_CBOR_MAJOR_UINT, NULL);
+}
+
+void v7_stream_decode_bitmap(v7_stream_decode_state_t *dec, uint8_t *v, const v7_bitmap_table_t *ptbl)
+{
+    bp_integer_t value;
+
+    v7_stream_decode_bp_integer(dec, &value);
+    while (ptbl->mask != 0)
+    {
+        v[ptbl->offset] = (value & ptbl->mask) != 0;
+        ++ptbl;
+    }
+}
+
+void v7_stream_decode_bp_crctype(v7_stream_decode_state_t *dec, bp_crctype_t *v)
+{
+    *v = (bp_crctype_t)v7_stream_decode_small_int(dec);
+
+    if (!dec->error)
+    {
+        if (*v != bp_crctype_none && *v != bp_crctype_CRC16 && *v != bp_crctype_CRC32C)
+        {
+            /* do not know how to check */
+            dec->error = true;
+        }
+        else
+        {
+            /* the CRC covers the block from its start, including the lead read so far */
+            mpool_stream_restart_crc(dec->mps, *v);
+            mpool_stream_set_intermediate_crc(dec->mps,
+                                              bplib_crc_update(mpool_stream_get_crc_params(dec->mps),
+                                                               mpool_stream_get_intermediate_crc(dec->mps),
+                                                               dec->lead, dec->lead_size));
+            dec->crc_started = true;
+        }
+    }
+}
+
+void v7_stream_decode_crc(v7_stream_decode_state_t *dec, bp_crcval_t *v)
+{
+    static const uint8_t    ZERO_BYTES[4] = {0};
+    bplib_crc_parameters_t *crc_params;
+    bp_crcval_t             crc_val;
+    bp_crcval_t             crc_before;
+    uint8_t                 bytes[sizeof(ZERO_BYTES)];
+    size_t                  crc_len;
+    size_t                  i;
+
+    crc_val    = 0;
+    crc_params = mpool_stream_get_crc_params(dec->mps);
+    crc_len    = bplib_crc_get_width(crc_params) / 8;
+
+    if (v7_stream_decode_head(dec, V7_CBOR_MAJOR_BYTES, NULL) != crc_len || crc_len > sizeof(bytes))
+    {
+        dec->error = true;
+    }
+    else
+    {
+        /* being read pumps the actual CRC bytes in, so the value beforehand gets zeros instead */
+        crc_before = mpool_stream_get_intermediate_crc(dec->mps);
+        v7_stream_read(dec, bytes, crc_len);
+        mpool_stream_set_intermediate_crc(dec->mps, bplib_crc_update(crc_params, crc_before, ZERO_BYTES, crc_len));
+
+        /* Interpret the bytestring value as an integer */
+        for (i = 0; i < crc_len; ++i)
+        {
+            crc_val <<= 8;
+            crc_val |= bytes[i];
+        }
+    }
+
+    *v = crc_val;
+}
+
+static void v7_stream_decode_bp_ipn_uri_ssp_impl(v7_stream_decode_state_t *dec, void *arg)
+{
+    bp_ipn_uri_ssp_t *v = arg;
+
+    v7_stream_decode_bp_integer(dec, &v->node_number);
+    v7_stream_decode_bp_integer(dec, &v->service_number);
+}
+
+static void v7_stream_decode_bp_endpointid_buffer_impl(v7_stream_decode_state_t *dec, void *arg)
+{
+    bp_endpointid_buffer_t *v = arg;
+
+    v->scheme = v7_stream_decode_small_int(dec); /* always present, indicates which other field is valid */
+
+    switch (v->scheme)
+    {
+        case bp_endpointid_scheme_ipn:
+            v7_stream_decode_container(dec, v7_stream_decode_bp_ipn_uri_ssp_impl, &v->ssp.ipn);
+            break;
+
+        default:
+            /* do not know how to decode */
+            dec->error = true;
+            break;
+    }
+}
+
+void v7_stream_decode_bp_endpointid_buffer(v7_stream_decode_state_t *dec, bp_endpointid_buffer_t *v)
+{
+    v7_stream_decode_container(dec, v7_stream_decode_bp_endpointid_buffer_impl, v);
+}
+
+static void v7_stream_decode_bp_creation_timestamp_impl(v7_stream_decode_state_t *dec, void *arg)
+{
+    bp_creation_timestamp_t *v = arg;
+
+    v7_stream_decode_bp_integer(dec, &v->time);
+    v7_stream_decode_bp_integer(dec, &v->sequence_num);
+}
+
+void v7_stream_decode_bp_creation_timestamp(v7_stream_decode_state_t *dec, bp_creation_timestamp_t *v)
+{
+    v7_stream_decode_container(dec, v7_stream_decode_bp_creation_timestamp_impl, v);
+}
+
+static void v7_stream_decode_bp_primary_block_impl(v7_stream_decode_state_t *dec, void *arg)
+{
+    bp_primary_block_t *v = arg;
+
+    v->version = (uint8_t)v7_stream_decode_small_int(dec);
+    if (v->version != 7)
+    {
+        /* don't know how to decode the rest if not v7 */
+        dec->error = true;
+        return;
+    }
+
+    /* the other 7 fixed fields defined by BPv7 */
+    v7_stream_decode_bitmap(dec, (uint8_t *)&v->controlFlags, V7_BUNDLE_CONTROL_FLAGS_BITMAP_TABLE);
+    v7_stream_decode_bp_crctype(dec, &v->crctype);
+    v7_stream_decode_bp_endpointid_buffer(dec, &v->destinationEID);
+    v7_stream_decode_bp_endpointid_buffer(dec, &v->sourceID);
+    v7_stream_decode_bp_endpointid_buffer(dec, &v->reportEID);
+    v7_stream_decode_bp_creation_timestamp(dec, &v->creationTimeStamp);
+    v7_stream_decode_bp_integer(dec, &v->lifetime);
+
+    /* next fields depend on whether the flag is set */
+    if (v->controlFlags.isFragment)
+    {
+        v7_stream_decode_bp_integer(dec, &v->fragmentOffset);
+        v7_stream_decode_bp_integer(dec, &v->totalADUlength);
+    }
+    else
+    {
+        v->fragmentOffset = 0;
+        v->totalADUlength = 0;
+    }
+
+    /* Check the CRC if present. */
+    if (v->crctype != bp_crctype_none)
+    {
+        v7_stream_decode_crc(dec, &v->crcval);
+    }
+}
+
+static void v7_stream_decode_bp_canonical_block_impl(v7_stream_decode_state_t *dec, void *arg)
+{
+    v7_stream_canonical_info_t  *info = arg;
+    bp_canonical_block_buffer_t *v    = info->logical;
+    size_t                       content_end;
+    size_t                       parent_remain;
+
+    v->canonical_block.blockType = (bp_blocktype_t)v7_stream_decode_small_int(dec);
+    v->canonical_block.blockNum  = (bp_blocknum_t)v7_stream_decode_small_int(dec);
+    v7_stream_decode_bitmap(dec, (uint8_t *)&v->canonical_block.processingControlFlags,
+                            V7_BLOCK_PROCESSING_FLAGS_BITMAP_TABLE);
+    v7_stream_decode_bp_crctype(dec, &v->canonical_block.crctype);
+
+    /* The block content is a byte string, which is left in place */
+    info->content_size = v7_stream_decode_head(dec, V7_CBOR_MAJOR_BYTES, NULL);
+    if (dec->error)
+    {
+        return;
+    }
+    info->content_offset = mpool_stream_tell(dec->mps);
+    content_end          = info->content_offset + info->content_size;
+
+    /*
+     * Second stage decode - recognized non-payload extension blocks hold more CBOR, which
+     * is decoded on the way through, and any other content is only run through the CRC.
+     */
+    parent_remain = dec->remain;
+    dec->remain   = V7_STREAM_UNBOUNDED;
+    switch (v->canonical_block.blockType)
+    {
+        case bp_blocktype_previousNode:
+            v7_stream_decode_bp_endpointid_buffer(dec, &v->data.previous_node_block.nodeId);
+            break;
+        case bp_blocktype_bundleAge:
+            v7_stream_decode_bp_integer(dec, &v->data.age_block.age);
+            break;
+        case bp_blocktype_hopCount:
+            v7_stream_decode_bp_integer(dec, &v->data.hop_count_block.hopLimit);
+            v7_stream_decode_bp_integer(dec, &v->data.hop_count_block.hopCount);
+            break;
+        default:
+            mpool_stream_seek(dec->mps, content_end);
+            break;
+    }
+    dec->remain = parent_remain;
+
+    /* the content must have been consumed exactly */
+    if (!dec->error && mpool_stream_tell(dec->mps) != content_end)
+    {
+        dec->error = true;
+    }
+
+    /* Check the CRC if present. */
+    if (v->canonical_block.crctype != bp_crctype_none)
+    {
+        v7_stream_decode_crc(dec, &v->canonical_block.crcval);
+    }
+}
+
+int v7_stream_finish_block(v7_stream_decode_state_t *dec, mpool_cache_block_t *head, bp_crctype_t crc_type,
+                           bp_crcval_t crc_check)
+{
+    bplib_crc_parameters_t *crc_params;
+    size_t                  block_size;
+
+    if (dec->error)
+    {
+        return -1;
+    }
+
+    /* verify the CRC - every byte of the block has been run through it by now */
+    if (crc_type != bp_crctype_none)
+    {
+        crc_params = mpool_stream_get_crc_params(dec->mps);
+        if (bplib_crc_finalize(crc_params, mpool_stream_get_intermediate_crc(dec->mps)) != crc_check)
+        {
+            return -1;
+        }
+    }
+
+    /* hand the chunks holding the block over to it */
+    block_size = mpool_stream_detach(dec->mps, head);
+    if (block_size == 0 || block_size > INT_MAX)
+    {
+        return -1;
+    }
+
+    return (int)block_size;
+}
+
+int v7_block_decode_pri_stream(mpool_stream_t *mps, mpool_cache_primary_block_t *cpb)
+{
+    v7_stream_decode_state_t v7_state;
+    bp_primary_block_t      *pri;
+
+    pri = mpool_get_pri_block_logical(cpb);
+    memset(&v7_state, 0, sizeof(v7_state));
+
+    v7_state.mps    = mps;
+    v7_state.remain = 1;
+    mpool_stream_restart_crc(mps, bp_crctype_none);
+
+    /* must be at the start of the chunks (see mpool_stream_detach) */
+    if (mpool_stream_tell(mps) != 0)
+    {
+        v7_state.error = true;
+    }
+
+    v7_stream_decode_container(&v7_state, v7_stream_decode_bp_primary_block_impl, pri);
+
+    return v7_stream_finish_block(&v7_state, mpool_get_pri_block_encoded_chunks(cpb), pri->crctype, pri->crcval);
+}
+
+int v7_block_decode_canonical_stream(mpool_stream_t *mps, mpool_cache_canonical_block_t *ccb)
+{
+    v7_stream_decode_state_t   v7_state;
+    v7_stream_canonical_info_t info;
+    int                        result;
+
+    memset(&v7_state, 0, sizeof(v7_state));
+    memset(&info, 0, sizeof(info));
+
+    info.logical    = mpool_get_canonical_block_logical(ccb);
+    v7_state.mps    = mps;
+    v7_state.remain = 1;
+    mpool_stream_restart_crc(mps, bp_crctype_none);
+
+    /* must be at the start of the chunks (see mpool_stream_detach) */
+    if (mpool_stream_tell(mps) != 0)
+    {
+        v7_state.error = true;
+    }
+
+    v7_stream_decode_container(&v7_state, v7_stream_decode_bp_canonical_block_impl, &info);
+
+    result = v7_stream_finish_block(&v7_state, mpool_get_canonical_block_encoded_chunks(ccb),
+                                    info.logical->canonical_block.crctype, info.logical->canonical_block.crcval);
+    if (result > 0)
+    {
+        mpool_set_canonical_block_encoded_content_detail(ccb, info.content_offset, info.content_size);
+    }
+
+    return result;
+}
+
 int v7_block_encode_pri(mpool_t *pool, mpool_cache_primary_block_t *cpb)
 {
     v7_encode_state_t         v7_state;
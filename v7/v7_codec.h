@@ -38,6 +38,17 @@ int v7_block_decode_pri(mpool_t *pool, mpool_cache_primary_block_t *cpb, const v
 int v7_block_decode_canonical(mpool_t *pool, mpool_cache_canonical_block_t *ccb, const void *data_ptr,
                               size_t data_size);
 
+/*
+ * Zero-copy alternative - the received bundle is written once into the pool with mpool_stream_write,
+ * and read back with mpool_stream_turnaround.  Each call then decodes the next block directly from the
+ * chunks, checking its CRC on the way through, and moves the chunks over to the block (see
+ * mpool_stream_detach); the payload is never copied again.  Returns the encoded size of the block,
+ * or -1 if it could not be decoded or its CRC does not check, in which case the block is left on the
+ * stream and the bundle should be discarded with mpool_stream_close.
+ */
+int v7_block_decode_pri_stream(mpool_stream_t *mps, mpool_cache_primary_block_t *cpb);
+int v7_block_decode_canonical_stream(mpool_stream_t *mps, mpool_cache_canonical_block_t *ccb);
+
 /*
  * On the encode side of things, the block types are known ahead of time.  Encoding of a payload block is separate
  * because the data needs to be passed in, but for all other canonical block types all the information should already be
@@ -78,25 +78,39 @@ typedef union mpool_cache_any_buffer
     uint8_t                                max_content[BP_MPOOL_MAX_ENCODED_CHUNK_SIZE];
 } mpool_cache_any_buffer_t;
 
+typedef union mpool_cache_extent_buffer
+{
+    mpool_cache_block_t             link;
+    mpool_cache_encode_block_node_t encoded;
+    uint8_t                         max_content[BP_MPOOL_EXTENT_SIZE];
+} mpool_cache_extent_buffer_t;
+
 struct mpool
 {
     size_t                   num_bufs;
     size_t                   buffer_size;
     mpool_cache_block_t      free_blocks;
+    size_t                   num_extents;
+    mpool_cache_block_t      free_extents;
     mpool_cache_block_t      common_blocks;
     mpool_cache_block_t      outgoing_bundles;
     mpool_cache_block_t      incoming_bundles;
+    bp_handle_t              free_lock;     /* free_blocks and free_extents */
+    bp_handle_t              outgoing_lock; /* outgoing_bundles */
+    bp_handle_t              incoming_lock; /* incoming_bundles */
     mpool_cache_any_buffer_t first_buffer;
 };
 
-static void mpool_decr_refcount(mpool_t *pool, mpool_cache_block_t *cb);
+static void mpool_decr_refcount(mpool_magazine_t *mag, mpool_cache_block_t *cb);
 
 #define MPOOL_ENCODE_CHUNK_CAPACITY \
     (sizeof(mpool_cache_any_buffer_t) - offsetof(mpool_cache_encode_block_node_t, eblock.content_start))
+#define MPOOL_ENCODE_EXTENT_CAPACITY \
+    (sizeof(mpool_cache_extent_buffer_t) - offsetof(mpool_cache_encode_block_node_t, eblock.content_start))
 
 size_t mpool_get_encode_data_capacity(const mpool_cache_encode_block_t *ceb)
 {
-    return MPOOL_ENCODE_CHUNK_CAPACITY;
+    return ceb->capacity - ceb->encoded_offset;
 }
 
 void mpool_link_reset(mpool_cache_block_t *link, mpool_cache_blocktype_t type)
@@ -219,52 +233,142 @@ mpool_cache_encode_block_t *mpool_cast_encode_block(mpool_cache_block_t *cb)
     return NULL;
 }
 
-mpool_cache_block_t *mpool_get_next_outgoing_bundle(mpool_t *pool)
+static mpool_cache_block_t *mpool_peek_bundle(bp_handle_t lock, mpool_cache_block_t *list, bool take)
 {
-    mpool_cache_block_t *node = pool->outgoing_bundles.next;
+    mpool_cache_block_t *node;
 
-    /* All nodes in the outgoing list should have a linktype of primary.
-     * If not, then this means the list is empty */
-    if (node->type != mpool_cache_blocktype_primary)
+    bplib_os_lock(lock);
     {
-        return NULL;
+        node = list->next;
+
+        /* All nodes in the bundle lists should have a linktype of primary.
+         * If not, then this means the list is empty */
+        if (node->type != mpool_cache_blocktype_primary)
+        {
+            node = NULL;
+        }
+        else if (take)
+        {
+            mpool_extract_node(node);
+        }
     }
+    bplib_os_unlock(lock);
 
     return node;
 }
 
+mpool_cache_block_t *mpool_get_next_outgoing_bundle(mpool_t *pool)
+{
+    return mpool_peek_bundle(pool->outgoing_lock, &pool->outgoing_bundles, false);
+}
+
 mpool_cache_block_t *mpool_get_next_incoming_bundle(mpool_t *pool)
 {
-    mpool_cache_block_t *node = pool->incoming_bundles.next;
+    return mpool_peek_bundle(pool->incoming_lock, &pool->incoming_bundles, false);
+}
+
+mpool_cache_block_t *mpool_take_next_outgoing_bundle(mpool_t *pool)
+{
+    return mpool_peek_bundle(pool->outgoing_lock, &pool->outgoing_bundles, true);
+}
+
+mpool_cache_block_t *mpool_take_next_incoming_bundle(mpool_t *pool)
+{
+    return mpool_peek_bundle(pool->incoming_lock, &pool->incoming_bundles, true);
+}
+
+static mpool_cache_block_t *mpool_take_free_node(mpool_cache_block_t *free_list)
+{
+    mpool_cache_block_t *node = free_list->next;
 
-    /* All nodes in the incoming list should have a linktype of primary.
+    /* All nodes in the free list should have a linktype of undefined.
      * If not, then this means the list is empty */
-    if (node->type != mpool_cache_blocktype_primary)
+    if (node->type != mpool_cache_blocktype_undefined)
     {
         return NULL;
     }
 
+    mpool_extract_node(node);
+
     return node;
 }
 
-mpool_cache_block_t *mpool_alloc_primary_block(mpool_t *pool)
+static mpool_cache_block_t *mpool_take_shared_node(mpool_t *pool, mpool_cache_block_t *free_list)
+{
+    mpool_cache_block_t *node;
+
+    bplib_os_lock(pool->free_lock);
+    {
+        node = mpool_take_free_node(free_list);
+    }
+    bplib_os_unlock(pool->free_lock);
+
+    return node;
+}
+
+static mpool_cache_block_t *mpool_magazine_take_block(mpool_magazine_t *mag)
+{
+    mpool_t             *pool = mag->pool;
+    mpool_cache_block_t *node;
+    size_t               i;
+
+    /* refill an empty magazine with a batch of blocks under a single lock */
+    if (mag->num_blocks == 0)
+    {
+        bplib_os_lock(pool->free_lock);
+        {
+            for (i = 0; i < BP_MPOOL_MAGAZINE_BATCH; ++i)
+            {
+                node = mpool_take_free_node(&pool->free_blocks);
+                if (node == NULL)
+                {
+                    break;
+                }
+                mpool_insert_before(&mag->free_blocks, node);
+                ++mag->num_blocks;
+            }
+        }
+        bplib_os_unlock(pool->free_lock);
+    }
+
+    node = mpool_take_free_node(&mag->free_blocks);
+    if (node != NULL)
+    {
+        --mag->num_blocks;
+    }
+
+    return node;
+}
+
+static mpool_cache_block_t *mpool_magazine_take_extent(mpool_magazine_t *mag)
+{
+    mpool_cache_block_t *node;
+
+    /* extents are few, so they are only cached once returned and never taken in batches */
+    node = mpool_take_free_node(&mag->free_extents);
+    if (node == NULL)
+    {
+        node = mpool_take_shared_node(mag->pool, &mag->pool->free_extents);
+    }
+
+    return node;
+}
+
+static mpool_cache_block_t *mpool_setup_primary_block(mpool_cache_block_t *node)
 {
-    mpool_cache_block_t              *node = pool->free_blocks.next;
     mpool_cache_primary_block_node_t *cpbn;
 
-    /* All nodes in the free list should have a linktype of undefined.
-     * If not, then this means the list is empty */
-    if (node->type != mpool_cache_blocktype_undefined)
+    if (node == NULL)
     {
         return NULL;
     }
 
-    /* extract the node from the free list, and reconfigure it as a pri block */
-    mpool_extract_node(node);
-
+    /* reconfigure the free node as a pri block */
     node->type = mpool_cache_blocktype_primary;
     cpbn       = (mpool_cache_primary_block_node_t *)node;
 
+    /* the node may have held any type of block before, including the refcount */
+    cpbn->ref.count = 0;
     mpool_link_reset(&cpbn->pblock.cblock_list, mpool_cache_blocktype_head);
     mpool_link_reset(&cpbn->pblock.chunk_list, mpool_cache_blocktype_head);
 
@@ -274,24 +378,20 @@ mpool_cache_block_t *mpool_alloc_primary_block(mpool_t *pool)
     return node;
 }
 
-mpool_cache_block_t *mpool_alloc_canonical_block(mpool_t *pool)
+static mpool_cache_block_t *mpool_setup_canonical_block(mpool_cache_block_t *node)
 {
-    mpool_cache_block_t                *node = pool->free_blocks.next;
     mpool_cache_canonical_block_node_t *ccb;
 
-    /* All nodes in the free list should have a linktype of undefined.
-     * If not, then this means the list is empty */
-    if (node->type != mpool_cache_blocktype_undefined)
+    if (node == NULL)
     {
         return NULL;
     }
 
-    /* extract the node from the free list, and reconfigure it as a canonical block */
-    mpool_extract_node(node);
-
+    /* reconfigure the free node as a canonical block */
     node->type = mpool_cache_blocktype_canonical;
     ccb        = (mpool_cache_canonical_block_node_t *)node;
 
+    ccb->ref.count = 0;
     mpool_link_reset(&ccb->cblock.chunk_list, mpool_cache_blocktype_head);
 
     /* wipe the logical content to be sure no stale data exists */
@@ -301,25 +401,83 @@ mpool_cache_block_t *mpool_alloc_canonical_block(mpool_t *pool)
     return node;
 }
 
-mpool_cache_block_t *mpool_alloc_encode_block(mpool_t *pool)
+static mpool_cache_block_t *mpool_setup_encode_block(mpool_cache_block_t *node, size_t capacity)
 {
-    mpool_cache_block_t             *node = pool->free_blocks.next;
     mpool_cache_encode_block_node_t *ceb;
 
-    /* All nodes in the free list should have a linktype of undefined.
-     * If not, then this means the list is empty */
-    if (node->type != mpool_cache_blocktype_undefined)
+    if (node == NULL)
     {
         return NULL;
     }
 
-    /* extract the node from the free list, and reconfigure it as a canonical block */
-    mpool_extract_node(node);
-
+    /* reconfigure the free node as an encoded chunk */
     node->type = mpool_cache_blocktype_encoded_chunk;
     ceb        = (mpool_cache_encode_block_node_t *)node;
 
     ceb->eblock.encoded_length = 0;
+    ceb->eblock.encoded_offset = 0;
+    ceb->eblock.capacity       = capacity;
+
+    return node;
+}
+
+mpool_cache_block_t *mpool_alloc_primary_block(mpool_t *pool)
+{
+    return mpool_setup_primary_block(mpool_take_shared_node(pool, &pool->free_blocks));
+}
+
+mpool_cache_block_t *mpool_alloc_canonical_block(mpool_t *pool)
+{
+    return mpool_setup_canonical_block(mpool_take_shared_node(pool, &pool->free_blocks));
+}
+
+mpool_cache_block_t *mpool_alloc_encode_block(mpool_t *pool)
+{
+    return mpool_setup_encode_block(mpool_take_shared_node(pool, &pool->free_blocks), MPOOL_ENCODE_CHUNK_CAPACITY);
+}
+
+mpool_cache_block_t *mpool_alloc_encode_chunk(mpool_t *pool, size_t data_size)
+{
+    mpool_cache_block_t *node = NULL;
+
+    /* an extent for large data, falling back to standard chunks once they run out */
+    if (data_size >= BP_MPOOL_EXTENT_THRESHOLD && data_size > MPOOL_ENCODE_CHUNK_CAPACITY)
+    {
+        node = mpool_setup_encode_block(mpool_take_shared_node(pool, &pool->free_extents),
+                                        MPOOL_ENCODE_EXTENT_CAPACITY);
+    }
+
+    if (node == NULL)
+    {
+        node = mpool_alloc_encode_block(pool);
+    }
+
+    return node;
+}
+
+mpool_cache_block_t *mpool_magazine_alloc_primary_block(mpool_magazine_t *mag)
+{
+    return mpool_setup_primary_block(mpool_magazine_take_block(mag));
+}
+
+mpool_cache_block_t *mpool_magazine_alloc_canonical_block(mpool_magazine_t *mag)
+{
+    return mpool_setup_canonical_block(mpool_magazine_take_block(mag));
+}
+
+mpool_cache_block_t *mpool_magazine_alloc_encode_chunk(mpool_magazine_t *mag, size_t data_size)
+{
+    mpool_cache_block_t *node = NULL;
+
+    if (data_size >= BP_MPOOL_EXTENT_THRESHOLD && data_size > MPOOL_ENCODE_CHUNK_CAPACITY)
+    {
+        node = mpool_setup_encode_block(mpool_magazine_take_extent(mag), MPOOL_ENCODE_EXTENT_CAPACITY);
+    }
+
+    if (node == NULL)
+    {
+        node = mpool_setup_encode_block(mpool_magazine_take_block(mag), MPOOL_ENCODE_CHUNK_CAPACITY);
+    }
 
     return node;
 }
@@ -330,15 +488,33 @@ void mpool_append_encode_block(mpool_cache_block_t *head, mpool_cache_block_t *b
     mpool_insert_before(head, blk);
 }
 
-void mpool_return_single_encode_block(mpool_t *pool, mpool_cache_block_t *blk)
+/*
+ * Returned blocks are first collected on the free lists of a magazine - either the
+ * caller's own, or a local one which is handed back to the pool with a single lock
+ * once the whole return is done.
+ */
+static void mpool_recycle_node(mpool_magazine_t *mag, mpool_cache_block_t *blk)
 {
-    assert(blk->type == mpool_cache_blocktype_encoded_chunk);
+    bool is_extent;
+
+    is_extent = (blk->type == mpool_cache_blocktype_encoded_chunk &&
+                 ((mpool_cache_encode_block_node_t *)blk)->eblock.capacity > MPOOL_ENCODE_CHUNK_CAPACITY);
+
     mpool_extract_node(blk);
     blk->type = mpool_cache_blocktype_undefined;
-    mpool_insert_before(&pool->free_blocks, blk);
+
+    if (is_extent)
+    {
+        mpool_insert_before(&mag->free_extents, blk);
+    }
+    else
+    {
+        mpool_insert_before(&mag->free_blocks, blk);
+        ++mag->num_blocks;
+    }
 }
 
-void mpool_return_all_encode_blocks(mpool_t *pool, mpool_cache_block_t *list)
+static void mpool_recycle_encode_blocks(mpool_magazine_t *mag, mpool_cache_block_t *list)
 {
     mpool_cache_block_t *ptr;
 
@@ -353,15 +529,12 @@ void mpool_return_all_encode_blocks(mpool_t *pool, mpool_cache_block_t *list)
          * routine for encoded chunks.  Use mpool_decr_refcount() to collect ANY type of block.
          */
         assert(ptr->type == mpool_cache_blocktype_encoded_chunk);
-        ptr->type = mpool_cache_blocktype_undefined;
-        ptr       = ptr->next;
+        mpool_recycle_node(mag, ptr);
+        ptr = list->next;
     }
-
-    mpool_merge_listx(&pool->free_blocks, list);
-    mpool_extract_node(list);
 }
 
-void mpool_return_all_blocks_in_list(mpool_t *pool, mpool_cache_block_t *list)
+static void mpool_recycle_blocks_in_list(mpool_magazine_t *mag, mpool_cache_block_t *list)
 {
     mpool_cache_block_t *ptr;
 
@@ -370,15 +543,86 @@ void mpool_return_all_blocks_in_list(mpool_t *pool, mpool_cache_block_t *list)
     ptr = list->next;
     while (ptr->type != mpool_cache_blocktype_head)
     {
-        mpool_decr_refcount(pool, ptr);
+        mpool_decr_refcount(mag, ptr);
 
         /* whether it was a ref or direct block, this block can get freed */
-        ptr->type = mpool_cache_blocktype_undefined;
-        ptr       = ptr->next;
+        mpool_recycle_node(mag, ptr);
+        ptr = list->next;
+    }
+}
+
+/*
+ * Hand the free blocks of a magazine back to the pool, keeping up to "keep" standard blocks.
+ * Extents are always handed back, as there are too few of them to hold in a cache.
+ */
+static void mpool_magazine_trim(mpool_magazine_t *mag, size_t keep)
+{
+    mpool_t             *pool = mag->pool;
+    mpool_cache_block_t *node;
+
+    bplib_os_lock(pool->free_lock);
+    {
+        while (mag->num_blocks > keep)
+        {
+            node = mpool_take_free_node(&mag->free_blocks);
+            mpool_insert_before(&pool->free_blocks, node);
+            --mag->num_blocks;
+        }
+
+        mpool_merge_listx(&pool->free_extents, &mag->free_extents);
+        mpool_extract_node(&mag->free_extents);
+    }
+    bplib_os_unlock(pool->free_lock);
+}
+
+void mpool_magazine_init(mpool_magazine_t *mag, mpool_t *pool)
+{
+    mag->pool       = pool;
+    mag->num_blocks = 0;
+    mpool_link_reset(&mag->free_blocks, mpool_cache_blocktype_head);
+    mpool_link_reset(&mag->free_extents, mpool_cache_blocktype_head);
+}
+
+void mpool_magazine_flush(mpool_magazine_t *mag)
+{
+    mpool_magazine_trim(mag, 0);
+}
+
+static void mpool_magazine_settle(mpool_magazine_t *mag)
+{
+    /* keep a batch cached, but never let a magazine hoard the pool */
+    if (mag->num_blocks > (2 * BP_MPOOL_MAGAZINE_BATCH) || mag->free_extents.next != &mag->free_extents)
+    {
+        mpool_magazine_trim(mag, BP_MPOOL_MAGAZINE_BATCH);
     }
+}
 
-    mpool_merge_listx(&pool->free_blocks, list);
-    mpool_extract_node(list);
+void mpool_return_single_encode_block(mpool_t *pool, mpool_cache_block_t *blk)
+{
+    mpool_magazine_t recycle;
+
+    assert(blk->type == mpool_cache_blocktype_encoded_chunk);
+    mpool_magazine_init(&recycle, pool);
+    mpool_recycle_node(&recycle, blk);
+    mpool_magazine_flush(&recycle);
+}
+
+void mpool_return_all_encode_blocks(mpool_t *pool, mpool_cache_block_t *list)
+{
+    mpool_magazine_t recycle;
+
+    mpool_magazine_init(&recycle, pool);
+    mpool_recycle_encode_blocks(&recycle, list);
+    mpool_magazine_flush(&recycle);
+}
+
+void mpool_return_all_blocks_in_list(mpool_t *pool, mpool_cache_block_t *list)
+{
+    mpool_magazine_t recycle;
+
+    mpool_magazine_init(&recycle, pool);
+    mpool_recycle_blocks_in_list(&recycle, list);
+    mpool_magazine_flush(&recycle);
 }
 
 /*
@@ -388,7 +632,7 @@ void mpool_return_all_blocks_in_list(mpool_t *pool, mpool_cache_block_t *list)
  *
  * This has no effect if called on a non-canonical block
  */
-void mpool_decr_refcount(mpool_t *pool, mpool_cache_block_t *cb)
+void mpool_decr_refcount(mpool_magazine_t *mag, mpool_cache_block_t *cb)
 {
     mpool_cache_canonical_block_node_t *ccbn;
     mpool_cache_primary_block_node_t   *cpbn;
@@ -459,12 +703,12 @@ void mpool_decr_refcount(mpool_t *pool, mpool_cache_block_t *cb)
         /* Collect the content chunks too */
         if (cpbn != NULL)
         {
-            mpool_return_all_blocks_in_list(pool, &cpbn->pblock.cblock_list);
-            mpool_return_all_encode_blocks(pool, &cpbn->pblock.chunk_list);
+            mpool_recycle_blocks_in_list(mag, &cpbn->pblock.cblock_list);
+            mpool_recycle_encode_blocks(mag, &cpbn->pblock.chunk_list);
         }
         if (ccbn != NULL)
         {
-            mpool_return_all_encode_blocks(pool, &ccbn->cblock.chunk_list);
+            mpool_recycle_encode_blocks(mag, &ccbn->cblock.chunk_list);
         }
 
         /* ONLY if this was a ref node, delete the content here */
@@ -472,16 +716,42 @@ void mpool_decr_refcount(mpool_t *pool, mpool_cache_block_t *cb)
         if (pcontent != cb)
         {
             /* now reset this node and return it to the free block list */
-            mpool_extract_node(pcontent);
-            pcontent->type = mpool_cache_blocktype_undefined;
-            mpool_insert_before(&pool->free_blocks, pcontent);
+            mpool_recycle_node(mag, pcontent);
         }
     }
 }
 
 void mpool_return_block(mpool_t *pool, mpool_cache_block_t *cb)
 {
-    mpool_decr_refcount(pool, cb);
+    mpool_magazine_t recycle;
+
+    mpool_magazine_init(&recycle, pool);
+    mpool_decr_refcount(&recycle, cb);
+    mpool_magazine_flush(&recycle);
+}
+
+void mpool_return_bundle(mpool_t *pool, mpool_cache_block_t *cpb)
+{
+    mpool_magazine_t recycle;
+
+    /* a bundle off a queue is a direct primary block, so unlike above the node itself goes back too */
+    assert(cpb->type == mpool_cache_blocktype_primary);
+    mpool_magazine_init(&recycle, pool);
+    mpool_decr_refcount(&recycle, cpb);
+    mpool_recycle_node(&recycle, cpb);
+    mpool_magazine_flush(&recycle);
+}
+
+void mpool_magazine_return_block(mpool_magazine_t *mag, mpool_cache_block_t *cb)
+{
+    mpool_decr_refcount(mag, cb);
+    mpool_magazine_settle(mag);
+}
+
+void mpool_magazine_return_all_blocks_in_list(mpool_magazine_t *mag, mpool_cache_block_t *list)
+{
+    mpool_recycle_blocks_in_list(mag, list);
+    mpool_magazine_settle(mag);
 }
 
 size_t mpool_sum_encoded_size(mpool_cache_block_t *list)
@@ -560,7 +830,7 @@ size_t mpool_copy_block_chain(mpool_cache_block_t *list, void *out_ptr, size_t m
         }
         else
         {
-            src_ptr = &ceb->content_start;
+            src_ptr = mpool_get_encode_data_ptr(ceb);
             if (seek_left > 0)
             {
                 src_ptr += seek_left;
@@ -588,6 +858,151 @@ size_t mpool_copy_block_chain(mpool_cache_block_t *list, void *out_ptr, size_t m
     return max_out_size - remain_sz;
 }
 
+void mpool_chunk_index_init(mpool_chunk_index_t *idx, mpool_cache_block_t *list)
+{
+    assert(list->type == mpool_cache_blocktype_head);
+
+    memset(idx, 0, sizeof(*idx));
+    idx->list = list;
+}
+
+void mpool_chunk_index_invalidate(mpool_chunk_index_t *idx)
+{
+    idx->valid = false;
+}
+
+static void mpool_chunk_index_build(mpool_chunk_index_t *idx)
+{
+    mpool_cache_block_t        *blk;
+    mpool_cache_encode_block_t *ceb;
+    size_t                      num_chunks;
+    size_t                      stride;
+    size_t                      offset;
+
+    /* count the chunks first, so that a long chain is indexed evenly */
+    num_chunks = 0;
+    blk        = mpool_get_next_block(idx->list);
+    while (mpool_cast_encode_block(blk) != NULL)
+    {
+        ++num_chunks;
+        blk = mpool_get_next_block(blk);
+    }
+
+    stride = (num_chunks + BP_MPOOL_INDEX_ENTRIES - 1) / BP_MPOOL_INDEX_ENTRIES;
+    if (stride == 0)
+    {
+        stride = 1;
+    }
+
+    idx->num_entries = 0;
+    num_chunks       = 0;
+    offset           = 0;
+    blk              = mpool_get_next_block(idx->list);
+    while ((ceb = mpool_cast_encode_block(blk)) != NULL)
+    {
+        if ((num_chunks % stride) == 0)
+        {
+            idx->entry[idx->num_entries].blk    = blk;
+            idx->entry[idx->num_entries].offset = offset;
+            ++idx->num_entries;
+        }
+
+        offset += mpool_get_encode_data_actual_size(ceb);
+        ++num_chunks;
+        blk = mpool_get_next_block(blk);
+    }
+
+    idx->total_size = offset;
+    idx->valid      = true;
+}
+
+/*
+ * Find the chunk holding a position of the chain, and the position where that chunk starts.
+ * A position at (or beyond) the end of the chain gives the last chunk.  NULL if the chain is empty.
+ */
+static mpool_cache_block_t *mpool_chunk_index_find(mpool_chunk_index_t *idx, size_t position, size_t *chunk_start)
+{
+    mpool_cache_block_t        *blk;
+    mpool_cache_block_t        *next_blk;
+    mpool_cache_encode_block_t *ceb;
+    size_t                      offset;
+    size_t                      lo;
+    size_t                      hi;
+    size_t                      mid;
+
+    if (!idx->valid)
+    {
+        mpool_chunk_index_build(idx);
+    }
+
+    if (idx->num_entries == 0)
+    {
+        return NULL;
+    }
+
+    /* the last entry starting at or before the position */
+    lo = 0;
+    hi = idx->num_entries;
+    while ((hi - lo) > 1)
+    {
+        mid = lo + ((hi - lo) / 2);
+        if (idx->entry[mid].offset <= position)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    /* then walk the (at most stride) chunks after it */
+    blk    = idx->entry[lo].blk;
+    offset = idx->entry[lo].offset;
+    ceb    = mpool_cast_encode_block(blk);
+    while ((offset + mpool_get_encode_data_actual_size(ceb)) <= position)
+    {
+        next_blk = mpool_get_next_block(blk);
+        if (mpool_cast_encode_block(next_blk) == NULL)
+        {
+            break;
+        }
+        offset += mpool_get_encode_data_actual_size(ceb);
+        blk = next_blk;
+        ceb = mpool_cast_encode_block(blk);
+    }
+
+    *chunk_start = offset;
+    return blk;
+}
+
+size_t mpool_chunk_index_get_size(mpool_chunk_index_t *idx)
+{
+    if (!idx->valid)
+    {
+        mpool_chunk_index_build(idx);
+    }
+
+    return idx->total_size;
+}
+
+size_t mpool_chunk_index_copy(mpool_chunk_index_t *idx, void *out_ptr, size_t max_out_size, size_t seek_start,
+                              size_t max_count)
+{
+    mpool_cache_block_t *blk;
+    size_t               chunk_start;
+
+    blk = mpool_chunk_index_find(idx, seek_start, &chunk_start);
+    if (blk == NULL || seek_start >= idx->total_size)
+    {
+        return 0;
+    }
+
+    /* copying walks forward from the node given, so start it just before the chunk found */
+    return mpool_copy_block_chain(mpool_get_prev_block(blk), out_ptr, max_out_size, seek_start - chunk_start,
+                                  max_count);
+}
+
 #ifdef jphfix
 typedef void (*mpool_canonical_block_handler_t)(mpool_cache_canonical_block_t *, void *arg);
 
@@ -629,13 +1044,21 @@ void mpool_append_canonical_block(bp_primary_block_t *pri, bp_canonical_block_bu
 void mpool_store_primary_block_incoming(mpool_t *pool, mpool_cache_block_t *cpb)
 {
     assert(cpb->type == mpool_cache_blocktype_primary);
-    mpool_insert_before(&pool->incoming_bundles, cpb);
+    bplib_os_lock(pool->incoming_lock);
+    {
+        mpool_insert_before(&pool->incoming_bundles, cpb);
+    }
+    bplib_os_unlock(pool->incoming_lock);
 }
 
 void mpool_store_primary_block_outgoing(mpool_t *pool, mpool_cache_block_t *cpb)
 {
     assert(cpb->type == mpool_cache_blocktype_primary);
-    mpool_insert_before(&pool->outgoing_bundles, cpb);
+    bplib_os_lock(pool->outgoing_lock);
+    {
+        mpool_insert_before(&pool->outgoing_bundles, cpb);
+    }
+    bplib_os_unlock(pool->outgoing_lock);
 }
 
 void mpool_store_canonical_block(mpool_cache_primary_block_t *cpb, mpool_cache_block_t *blk)
@@ -666,6 +1089,16 @@ void mpool_store_canonical_block(mpool_cache_primary_block_t *cpb, mpool_cache_b
     }
 }
 
+static mpool_cache_block_t *mpool_stream_alloc_chunk(mpool_stream_t *mps, size_t data_size)
+{
+    if (mps->mag != NULL)
+    {
+        return mpool_magazine_alloc_encode_chunk(mps->mag, data_size);
+    }
+
+    return mpool_alloc_encode_chunk(mps->pool, data_size);
+}
+
 void mpool_start_stream_init(mpool_stream_t *mps, mpool_t *pool, mpool_stream_dir_t dir, bp_crctype_t crctype)
 {
     memset(mps, 0, sizeof(*mps));
@@ -676,6 +1109,11 @@ void mpool_start_stream_init(mpool_stream_t *mps, mpool_t *pool, mpool_stream_di
     mps->pool      = pool;
     mps->last_eblk = &mps->head;
 
+    mpool_stream_restart_crc(mps, crctype);
+}
+
+void mpool_stream_restart_crc(mpool_stream_t *mps, bp_crctype_t crctype)
+{
     switch (crctype)
     {
         case bp_crctype_CRC16:
@@ -692,6 +1130,94 @@ void mpool_start_stream_init(mpool_stream_t *mps, mpool_t *pool, mpool_stream_di
     mps->crcval = bplib_crc_initial_value(mps->crc_params);
 }
 
+void mpool_stream_turnaround(mpool_stream_t *mps)
+{
+    /* read back the chunks written so far, from the start */
+    mps->dir             = mpool_stream_dir_read;
+    mps->last_eblk       = &mps->head;
+    mps->curr_limit      = 0;
+    mps->curr_pos        = 0;
+    mps->stream_position = 0;
+    mps->crcval          = bplib_crc_initial_value(mps->crc_params);
+}
+
+size_t mpool_stream_detach(mpool_stream_t *mps, mpool_cache_block_t *head)
+{
+    mpool_cache_block_t        *blk;
+    mpool_cache_block_t        *split_blk;
+    mpool_cache_block_t        *last_blk;
+    mpool_cache_encode_block_t *curr_eblk;
+    mpool_cache_encode_block_t *split_eblk;
+    size_t                      rest_sz;
+    size_t                      result;
+
+    if (mps->dir != mpool_stream_dir_read || mps->stream_position == 0)
+    {
+        return 0;
+    }
+
+    /*
+     * The next block usually starts part way into the current chunk, so that chunk
+     * is split and whichever side is smaller is copied into a chunk of its own.  The
+     * read part of a chunk is moved off the front by advancing its offset, so a
+     * block which ends early in a large payload extent never copies the payload.
+     */
+    last_blk = mps->last_eblk;
+    rest_sz  = mps->curr_limit - mps->curr_pos;
+    if (rest_sz > 0)
+    {
+        curr_eblk = mpool_cast_encode_block(mps->last_eblk);
+        if (mps->curr_pos <= rest_sz)
+        {
+            split_blk = mpool_stream_alloc_chunk(mps, mps->curr_pos);
+        }
+        else
+        {
+            split_blk = mpool_stream_alloc_chunk(mps, rest_sz);
+        }
+        if (split_blk == NULL)
+        {
+            return 0;
+        }
+
+        split_eblk = mpool_cast_encode_block(split_blk);
+        if (mps->curr_pos <= rest_sz)
+        {
+            memcpy(mpool_get_encode_data_ptr(split_eblk), mpool_get_encode_data_ptr(curr_eblk), mps->curr_pos);
+            split_eblk->encoded_length = mps->curr_pos;
+            curr_eblk->encoded_offset += mps->curr_pos;
+            curr_eblk->encoded_length = rest_sz;
+            mpool_insert_before(mps->last_eblk, split_blk);
+            last_blk = split_blk;
+        }
+        else
+        {
+            memcpy(mpool_get_encode_data_ptr(split_eblk), mpool_get_encode_data_ptr(curr_eblk) + mps->curr_pos,
+                   rest_sz);
+            split_eblk->encoded_length = rest_sz;
+            curr_eblk->encoded_length  = mps->curr_pos;
+            mpool_insert_after(mps->last_eblk, split_blk);
+        }
+    }
+
+    /* move every chunk read so far, in order */
+    do
+    {
+        blk = mpool_get_next_block(&mps->head);
+        mpool_extract_node(blk);
+        mpool_append_encode_block(head, blk);
+    } while (blk != last_blk);
+
+    result = mps->stream_position;
+
+    mps->last_eblk       = &mps->head;
+    mps->curr_limit      = 0;
+    mps->curr_pos        = 0;
+    mps->stream_position = 0;
+
+    return result;
+}
+
 size_t mpool_stream_write(mpool_stream_t *mps, const void *data, size_t size)
 {
     mpool_cache_block_t        *next_block;
@@ -713,7 +1239,7 @@ size_t mpool_stream_write(mpool_stream_t *mps, const void *data, size_t size)
         /* If no block is ready, get one now */
         if (mps->curr_pos >= mps->curr_limit)
         {
-            next_block = mpool_alloc_encode_block(mps->pool);
+            next_block = mpool_stream_alloc_chunk(mps, remain_sz);
             if (next_block == NULL)
             {
                 break;
@@ -723,7 +1249,7 @@ size_t mpool_stream_write(mpool_stream_t *mps, const void *data, size_t size)
 
             mps->last_eblk  = next_block;
             mps->curr_pos   = 0;
-            mps->curr_limit = MPOOL_ENCODE_CHUNK_CAPACITY;
+            mps->curr_limit = mpool_get_encode_data_capacity(mpool_cast_encode_block(next_block));
         }
 
         curr_eblk = mpool_cast_encode_block(mps->last_eblk);
@@ -734,7 +1260,7 @@ size_t mpool_stream_write(mpool_stream_t *mps, const void *data, size_t size)
             chunk_sz = remain_sz;
         }
 
-        out_p = &curr_eblk->content_start + mps->curr_pos;
+        out_p = mpool_get_encode_data_ptr(curr_eblk) + mps->curr_pos;
         memcpy(out_p, chunk_p, chunk_sz);
         mps->crcval = bplib_crc_update(mps->crc_params, mps->crcval, out_p, chunk_sz);
 
@@ -774,7 +1300,7 @@ size_t mpool_stream_seek(mpool_stream_t *mps, size_t target_position)
             }
             else if (mps->dir == mpool_stream_dir_write)
             {
-                next_block = mpool_alloc_encode_block(mps->pool);
+                next_block = mpool_stream_alloc_chunk(mps, chunk_sz);
             }
             else
             {
@@ -817,12 +1343,12 @@ size_t mpool_stream_seek(mpool_stream_t *mps, size_t target_position)
          */
         if (mps->dir == mpool_stream_dir_write)
         {
-            memset(&curr_eblk->content_start + mps->curr_pos, 0, chunk_sz);
+            memset(mpool_get_encode_data_ptr(curr_eblk) + mps->curr_pos, 0, chunk_sz);
             curr_eblk->encoded_length += chunk_sz;
         }
 
-        mps->crcval =
-            bplib_crc_update(mps->crc_params, mps->crcval, &curr_eblk->content_start + mps->curr_pos, chunk_sz);
+        mps->crcval = bplib_crc_update(mps->crc_params, mps->crcval,
+                                       mpool_get_encode_data_ptr(curr_eblk) + mps->curr_pos, chunk_sz);
         mps->curr_pos += chunk_sz;
         mps->stream_position += chunk_sz;
     }
@@ -918,7 +1444,7 @@ size_t mpool_stream_read(mpool_stream_t *mps, void *data, size_t size)
             chunk_sz = remain_sz;
         }
 
-        in_p = &curr_eblk->content_start + mps->curr_pos;
+        in_p = mpool_get_encode_data_ptr(curr_eblk) + mps->curr_pos;
         memcpy(chunk_p, in_p, chunk_sz);
         mps->crcval = bplib_crc_update(mps->crc_params, mps->crcval, in_p, chunk_sz);
 
@@ -931,6 +1457,44 @@ size_t mpool_stream_read(mpool_stream_t *mps, void *data, size_t size)
     return (size - remain_sz);
 }
 
+size_t mpool_stream_seek_indexed(mpool_stream_t *mps, mpool_chunk_index_t *idx, size_t position)
+{
+    mpool_cache_block_t *blk;
+    size_t               chunk_start;
+
+    if (mps->dir != mpool_stream_dir_read)
+    {
+        return mps->stream_position;
+    }
+
+    blk = mpool_chunk_index_find(idx, position, &chunk_start);
+    if (blk == NULL)
+    {
+        /* empty chain, reading starts (and ends) at its head */
+        mps->last_eblk       = idx->list;
+        mps->curr_limit      = 0;
+        mps->curr_pos        = 0;
+        mps->stream_position = 0;
+    }
+    else
+    {
+        if (position > idx->total_size)
+        {
+            position = idx->total_size;
+        }
+
+        mps->last_eblk       = blk;
+        mps->curr_limit      = mpool_get_encode_data_actual_size(mpool_cast_encode_block(blk));
+        mps->curr_pos        = position - chunk_start;
+        mps->stream_position = position;
+    }
+
+    /* like seeking backwards, a jump invalidates any running CRC */
+    mps->crcval = bplib_crc_initial_value(mps->crc_params);
+
+    return mps->stream_position;
+}
+
 void mpool_stream_attach(mpool_stream_t *mps, mpool_cache_block_t *head)
 {
     mpool_merge_listx(head, &mps->head);
@@ -956,14 +1520,24 @@ bp_crcval_t mpool_stream_get_current_crc(const mpool_stream_t *mps)
 void mpool_stream_close(mpool_stream_t *mps)
 {
     /* discard anything that wasn't saved (will be a no-op if it was saved) */
-    mpool_return_all_encode_blocks(mps->pool, &mps->head);
+    if (mps->mag != NULL)
+    {
+        mpool_recycle_encode_blocks(mps->mag, &mps->head);
+        mpool_magazine_settle(mps->mag);
+    }
+    else
+    {
+        mpool_return_all_encode_blocks(mps->pool, &mps->head);
+    }
 }
 
 mpool_t *mpool_create(void *pool_mem, size_t pool_size)
 {
-    mpool_t                  *pool;
-    size_t                    remain;
-    mpool_cache_any_buffer_t *pchunk;
+    mpool_t                     *pool;
+    size_t                       remain;
+    mpool_cache_any_buffer_t    *pchunk;
+    mpool_cache_extent_buffer_t *pextent;
+    size_t                       i;
 
     /* this is just a sanity check, a pool that has only 1 block will not
      * be useful for anything, but it can at least be created */
@@ -979,16 +1553,32 @@ mpool_t *mpool_create(void *pool_mem, size_t pool_size)
 
     pool = pool_mem;
 
+    /* one lock for the free lists, and one for each bundle queue */
+    pool->free_lock     = bplib_os_createlock();
+    pool->outgoing_lock = bplib_os_createlock();
+    pool->incoming_lock = bplib_os_createlock();
+    if (!bp_handle_is_valid(pool->free_lock) || !bp_handle_is_valid(pool->outgoing_lock) ||
+        !bp_handle_is_valid(pool->incoming_lock))
+    {
+        mpool_destroy(pool);
+        return NULL;
+    }
+
     /* the block lists are circular, as this reduces
      * complexity of operations (never a null pointer) */
     pool->buffer_size = sizeof(mpool_cache_any_buffer_t);
     mpool_link_reset(&pool->free_blocks, mpool_cache_blocktype_head);
+    mpool_link_reset(&pool->free_extents, mpool_cache_blocktype_head);
     mpool_link_reset(&pool->outgoing_bundles, mpool_cache_blocktype_head);
     mpool_link_reset(&pool->incoming_bundles, mpool_cache_blocktype_head);
 
     pchunk = &pool->first_buffer;
     remain = pool_size - offsetof(mpool_t, first_buffer);
 
+    /* the extent share comes off the end of the pool, and the standard chunks fill the rest */
+    pool->num_extents = ((remain / 100) * BP_MPOOL_EXTENT_SHARE) / sizeof(mpool_cache_extent_buffer_t);
+    remain -= pool->num_extents * sizeof(mpool_cache_extent_buffer_t);
+
     while (remain >= sizeof(mpool_cache_any_buffer_t))
     {
         mpool_insert_before(&pool->free_blocks, &pchunk->link);
@@ -997,7 +1587,31 @@ mpool_t *mpool_create(void *pool_mem, size_t pool_size)
         ++pool->num_bufs;
     }
 
-    printf("%s(): created pool of size %zu, with %zu chunks\n", __func__, pool_size, pool->num_bufs);
+    pextent = (mpool_cache_extent_buffer_t *)pchunk;
+    for (i = 0; i < pool->num_extents; ++i)
+    {
+        mpool_insert_before(&pool->free_extents, &pextent->link);
+        ++pextent;
+    }
+
+    printf("%s(): created pool of size %zu, with %zu chunks and %zu extents\n", __func__, pool_size, pool->num_bufs,
+           pool->num_extents);
 
     return pool;
 }
+
+void mpool_destroy(mpool_t *pool)
+{
+    if (bp_handle_is_valid(pool->free_lock))
+    {
+        bplib_os_destroylock(pool->free_lock);
+    }
+    if (bp_handle_is_valid(pool->outgoing_lock))
+    {
+        bplib_os_destroylock(pool->outgoing_lock);
+    }
+    if (bp_handle_is_valid(pool->incoming_lock))
+    {
+        bplib_os_destroylock(pool->incoming_lock);
+    }
+}
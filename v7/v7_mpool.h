@@ -35,6 +35,47 @@
  */
 #define BP_MPOOL_MAX_ENCODED_CHUNK_SIZE 256
 
+/*
+ * Large encoded chunks ("extents") -
+ * Payloads and other large encoded data go into extents, so that a bundle is a handful of
+ * chunks rather than a chain of hundreds.  BP_MPOOL_EXTENT_SHARE is the percentage of the pool
+ * carved into extents of BP_MPOOL_EXTENT_SIZE bytes (0 for none), and an extent is used once
+ * the data still to be written reaches BP_MPOOL_EXTENT_THRESHOLD bytes.  Logical blocks, and
+ * data that would not fill enough of an extent, always use the standard chunks above.
+ */
+#ifndef BP_MPOOL_EXTENT_SIZE
+#define BP_MPOOL_EXTENT_SIZE 8192
+#endif
+
+#ifndef BP_MPOOL_EXTENT_SHARE
+#define BP_MPOOL_EXTENT_SHARE 50
+#endif
+
+#ifndef BP_MPOOL_EXTENT_THRESHOLD
+#define BP_MPOOL_EXTENT_THRESHOLD (BP_MPOOL_EXTENT_SIZE / 4)
+#endif
+
+/*
+ * Per-thread free block caches ("magazines") -
+ * The pool free lists and bundle queues are locked, so any thread may use the pool.  A thread
+ * which allocates and returns many blocks (e.g. a CLA receive thread) can also keep its own
+ * magazine of free blocks, refilled from the pool BP_MPOOL_MAGAZINE_BATCH blocks at a time and
+ * trimmed back to a batch when it holds more than twice that, so the pool lock is taken about
+ * once per batch rather than once per block.  A magazine must only be used by one thread.
+ */
+#ifndef BP_MPOOL_MAGAZINE_BATCH
+#define BP_MPOOL_MAGAZINE_BATCH 32
+#endif
+
+/*
+ * Number of entries in a chunk index (Compile-Time Option) -
+ * A chain with more chunks than this is indexed sparsely, every Nth chunk, so a
+ * lookup walks at most N chunks past the entry found.
+ */
+#ifndef BP_MPOOL_INDEX_ENTRIES
+#define BP_MPOOL_INDEX_ENTRIES 16
+#endif
+
 /*
  * The 3 basic types of blocks which are cacheable in the mpool
  */
@@ -64,6 +105,29 @@ struct mpool_cache_block
     struct mpool_cache_block *prev;
 };
 
+typedef struct mpool_magazine
+{
+    mpool_t            *pool;
+    size_t              num_blocks;
+    mpool_cache_block_t free_blocks;
+    mpool_cache_block_t free_extents;
+} mpool_magazine_t;
+
+typedef struct mpool_chunk_index_entry
+{
+    mpool_cache_block_t *blk;
+    size_t               offset; /* position of the first byte of blk in the chain */
+} mpool_chunk_index_entry_t;
+
+typedef struct mpool_chunk_index
+{
+    mpool_cache_block_t      *list;
+    bool                      valid;
+    size_t                    total_size;
+    size_t                    num_entries;
+    mpool_chunk_index_entry_t entry[BP_MPOOL_INDEX_ENTRIES];
+} mpool_chunk_index_t;
+
 typedef enum mpool_stream_dir
 {
     mpool_stream_dir_undefined,
@@ -75,6 +139,7 @@ typedef struct mpool_stream
 {
     mpool_stream_dir_t      dir;
     mpool_t                *pool;
+    mpool_magazine_t       *mag; /* optional, allocates and returns chunks through it if set */
     mpool_cache_block_t    *last_eblk;
     mpool_cache_block_t     head;
     size_t                  curr_pos;
@@ -115,6 +180,8 @@ typedef struct mpool_cache_canonical_block
 typedef struct mpool_cache_encode_block
 {
     size_t  encoded_length; /* actual length of content */
+    size_t  encoded_offset; /* start of content, non-zero once the front of a received chunk is moved off */
+    size_t  capacity;       /* size of the chunk class (standard chunk or extent) */
     uint8_t content_start;  /* variably sized, not using C99 flexible array member due to restrictions it causes */
 } mpool_cache_encode_block_t;
 
@@ -201,9 +268,14 @@ static inline bool mpool_is_any_content_node(mpool_cache_block_t *cb)
     return (cb->type > mpool_cache_blocktype_head);
 }
 
+static inline uint8_t *mpool_get_encode_data_ptr(mpool_cache_encode_block_t *ceb)
+{
+    return &ceb->content_start + ceb->encoded_offset;
+}
+
 static inline void *mpool_get_encode_base_ptr(mpool_cache_encode_block_t *ceb)
 {
-    return &ceb->content_start;
+    return mpool_get_encode_data_ptr(ceb);
 }
 
 static inline size_t mpool_get_encode_data_actual_size(const mpool_cache_encode_block_t *ceb)
@@ -229,16 +301,39 @@ mpool_cache_encode_block_t    *mpool_cast_encode_block(mpool_cache_block_t *cb);
 
 mpool_cache_block_t *mpool_get_next_outgoing_bundle(mpool_t *pool);
 mpool_cache_block_t *mpool_get_next_incoming_bundle(mpool_t *pool);
+mpool_cache_block_t *mpool_take_next_outgoing_bundle(mpool_t *pool);
+mpool_cache_block_t *mpool_take_next_incoming_bundle(mpool_t *pool);
 
 mpool_cache_block_t *mpool_alloc_primary_block(mpool_t *pool);
 mpool_cache_block_t *mpool_alloc_canonical_block(mpool_t *pool);
 mpool_cache_block_t *mpool_alloc_encode_block(mpool_t *pool);
+mpool_cache_block_t *mpool_alloc_encode_chunk(mpool_t *pool, size_t data_size);
+
+void                 mpool_magazine_init(mpool_magazine_t *mag, mpool_t *pool);
+void                 mpool_magazine_flush(mpool_magazine_t *mag);
+mpool_cache_block_t *mpool_magazine_alloc_primary_block(mpool_magazine_t *mag);
+mpool_cache_block_t *mpool_magazine_alloc_canonical_block(mpool_magazine_t *mag);
+mpool_cache_block_t *mpool_magazine_alloc_encode_chunk(mpool_magazine_t *mag, size_t data_size);
+void                 mpool_magazine_return_block(mpool_magazine_t *mag, mpool_cache_block_t *blk);
+void                 mpool_magazine_return_all_blocks_in_list(mpool_magazine_t *mag, mpool_cache_block_t *list);
 
 void   mpool_start_stream_init(mpool_stream_t *mps, mpool_t *pool, mpool_stream_dir_t dir, bp_crctype_t crctype);
 size_t mpool_stream_write(mpool_stream_t *mps, const void *data, size_t size);
 size_t mpool_stream_read(mpool_stream_t *mps, void *data, size_t size);
 size_t mpool_stream_seek(mpool_stream_t *mps, size_t position);
 void   mpool_stream_attach(mpool_stream_t *mps, mpool_cache_block_t *head);
+void   mpool_stream_restart_crc(mpool_stream_t *mps, bp_crctype_t crctype);
+
+/*
+ * Zero-copy reading of received data -
+ * After the data is written into a stream, mpool_stream_turnaround reads it back in place
+ * from the start.  mpool_stream_detach then moves the chunks read so far onto another list,
+ * e.g. the encoded chunks of the block just decoded from them, and the stream continues
+ * with the data after it.  Returns the number of bytes moved (0 if out of chunks).
+ */
+void   mpool_stream_turnaround(mpool_stream_t *mps);
+size_t mpool_stream_detach(mpool_stream_t *mps, mpool_cache_block_t *head);
+
 static inline bplib_crc_parameters_t *mpool_stream_get_crc_params(const mpool_stream_t *mps)
 {
     return mps->crc_params;
@@ -247,6 +342,14 @@ static inline bp_crcval_t mpool_stream_get_intermediate_crc(const mpool_stream_t
 {
     return mps->crcval;
 }
+static inline void mpool_stream_set_intermediate_crc(mpool_stream_t *mps, bp_crcval_t crcval)
+{
+    mps->crcval = crcval;
+}
+static inline void mpool_stream_set_magazine(mpool_stream_t *mps, mpool_magazine_t *mag)
+{
+    mps->mag = mag;
+}
 static inline size_t mpool_stream_tell(const mpool_stream_t *mps)
 {
     return mps->stream_position;
@@ -260,12 +363,30 @@ void mpool_store_primary_block_outgoing(mpool_t *pool, mpool_cache_block_t *cpb)
 void mpool_store_canonical_block(mpool_cache_primary_block_t *cpb, mpool_cache_block_t *ccb);
 
 void mpool_return_block(mpool_t *pool, mpool_cache_block_t *blk);
+void mpool_return_bundle(mpool_t *pool, mpool_cache_block_t *cpb);
+void mpool_return_all_blocks_in_list(mpool_t *pool, mpool_cache_block_t *list);
 
 size_t mpool_sum_encode_size(mpool_cache_block_t *list);
 size_t mpool_sum_full_bundle_size(mpool_cache_primary_block_t *cpb);
 size_t mpool_copy_block_chain(mpool_cache_block_t *list, void *out_ptr, size_t max_out_size, size_t seek_start,
                               size_t max_count);
 
+/*
+ * Random access to a chain of encoded chunks -
+ * The index holds the cumulative offset of the chunks in a chain (e.g. the encoded chunks of a
+ * stored bundle), built on first use, so a position is found with a binary search rather than
+ * by walking the chain from its start.  It must be invalidated whenever chunks are added to or
+ * removed from the chain.  mpool_stream_seek_indexed positions a read stream anywhere in the
+ * chain, which need not be the stream's own, and reading then continues from there in place.
+ */
+void   mpool_chunk_index_init(mpool_chunk_index_t *idx, mpool_cache_block_t *list);
+void   mpool_chunk_index_invalidate(mpool_chunk_index_t *idx);
+size_t mpool_chunk_index_get_size(mpool_chunk_index_t *idx);
+size_t mpool_chunk_index_copy(mpool_chunk_index_t *idx, void *out_ptr, size_t max_out_size, size_t seek_start,
+                              size_t max_count);
+size_t mpool_stream_seek_indexed(mpool_stream_t *mps, mpool_chunk_index_t *idx, size_t position);
+
 mpool_t *mpool_create(void *pool_mem, size_t pool_size);
+void     mpool_destroy(mpool_t *pool);
 
 #endif /* V7_MPOOL_H */